@@ -47,6 +47,8 @@ static Context *ctx;
 
 /* Options */
 static gboolean scan_flag;
+static gint scan_cached_int = -1;
+static gboolean start_background_scan_flag;
 static gboolean register_home_flag;
 static gchar *register_in_operator_str;
 static gboolean ussd_status_flag;
@@ -59,6 +61,14 @@ static GOptionEntry entries[] = {
       "Scan for available networks in a given modem.",
       NULL
     },
+    { "3gpp-scan-cached", 0, 0, G_OPTION_ARG_INT, &scan_cached_int,
+      "Get the results of the last network scan, if not older than the given number of seconds; otherwise scan again.",
+      "[MAX_AGE]"
+    },
+    { "3gpp-start-background-scan", 0, 0, G_OPTION_ARG_NONE, &start_background_scan_flag,
+      "Start a background scan for available networks in a given modem.",
+      NULL
+    },
     { "3gpp-register-home", 0, 0, G_OPTION_ARG_NONE, &register_home_flag,
       "Request a given modem to register in its home network",
       NULL
@@ -111,6 +121,8 @@ mmcli_modem_3gpp_options_enabled (void)
         return !!n_actions;
 
     n_actions = (scan_flag +
+                 (scan_cached_int >= 0) +
+                 start_background_scan_flag +
                  register_home_flag +
                  !!register_in_operator_str +
                  ussd_status_flag +
@@ -125,7 +137,7 @@ mmcli_modem_3gpp_options_enabled (void)
 
     /* Scanning networks takes really a long time, so we do it asynchronously
      * always to avoid DBus timeouts */
-    if (scan_flag)
+    if (scan_flag || scan_cached_int >= 0)
         mmcli_force_async_operation ();
 
     /* USSD initiate and respond will wait for URCs to get finished, so
@@ -264,6 +276,50 @@ scan_ready (MMModem3gpp  *modem_3gpp,
     mmcli_async_operation_done ();
 }
 
+static void
+scan_cached_ready (MMModem3gpp  *modem_3gpp,
+                   GAsyncResult *result,
+                   gpointer      nothing)
+{
+    GList *operation_result;
+    GError *error = NULL;
+    guint age = 0;
+
+    operation_result = mm_modem_3gpp_scan_cached_finish (modem_3gpp, result, &age, &error);
+    if (operation_result)
+        g_print ("\nResults from a scan %u seconds ago\n", age);
+    scan_process_reply (operation_result, error);
+
+    mmcli_async_operation_done ();
+}
+
+static void
+start_background_scan_process_reply (gboolean result,
+                                     const GError *error)
+{
+    if (!result) {
+        g_printerr ("error: couldn't start a background scan in the modem: '%s'\n",
+                    error ? error->message : "unknown error");
+        exit (EXIT_FAILURE);
+    }
+
+    g_print ("successfully started a background scan in the modem\n");
+}
+
+static void
+start_background_scan_ready (MMModem3gpp  *modem_3gpp,
+                             GAsyncResult *result,
+                             gpointer      nothing)
+{
+    gboolean operation_result;
+    GError *error = NULL;
+
+    operation_result = mm_modem_3gpp_start_background_scan_finish (modem_3gpp, result, &error);
+    start_background_scan_process_reply (operation_result, error);
+
+    mmcli_async_operation_done ();
+}
+
 static void
 register_process_reply (gboolean result,
                         const GError *error)
@@ -427,6 +483,27 @@ get_modem_ready (GObject      *source,
         return;
     }
 
+    /* Request to get cached scan results? */
+    if (scan_cached_int >= 0) {
+        g_debug ("Asynchronously getting cached scan results...");
+        mm_modem_3gpp_scan_cached (ctx->modem_3gpp,
+                                   (guint)scan_cached_int,
+                                   ctx->cancellable,
+                                   (GAsyncReadyCallback)scan_cached_ready,
+                                   NULL);
+        return;
+    }
+
+    /* Request to start a background scan? */
+    if (start_background_scan_flag) {
+        g_debug ("Asynchronously starting a background scan...");
+        mm_modem_3gpp_start_background_scan (ctx->modem_3gpp,
+                                             ctx->cancellable,
+                                             (GAsyncReadyCallback)start_background_scan_ready,
+                                             NULL);
+        return;
+    }
+
     /* Request to register the modem? */
     if (register_in_operator_str || register_home_flag) {
         g_debug ("Asynchronously registering the modem...");
@@ -517,13 +594,25 @@ mmcli_modem_3gpp_run_synchronous (GDBusConnection *connection)
 
     ensure_modem_3gpp ();
 
-    if (scan_flag)
+    if (scan_flag || scan_cached_int >= 0)
         g_assert_not_reached ();
     if (ussd_initiate_str)
         g_assert_not_reached ();
     if (ussd_respond_str)
         g_assert_not_reached ();
 
+    /* Request to start a background scan? */
+    if (start_background_scan_flag) {
+        gboolean result;
+
+        g_debug ("Synchronously starting a background scan...");
+        result = mm_modem_3gpp_start_background_scan_sync (ctx->modem_3gpp,
+                                                           NULL,
+                                                           &error);
+        start_background_scan_process_reply (result, error);
+        return;
+    }
+
     /* Request to register the modem? */
     if (register_in_operator_str || register_home_flag) {
         gboolean result;
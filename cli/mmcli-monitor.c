@@ -0,0 +1,890 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * mmcli -- Control modem status & access information from the command line
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#define _LIBMM_INSIDE_MMCLI
+#include "libmm-glib.h"
+
+#include "mmcli.h"
+
+#define DBUS_INTERFACE_PROPERTIES     "org.freedesktop.DBus.Properties"
+#define DBUS_INTERFACE_OBJECT_MANAGER "org.freedesktop.DBus.ObjectManager"
+
+/* Context */
+typedef struct {
+    GDBusConnection *connection;
+    GCancellable *cancellable;
+    guint signal_id;
+    guint watcher_id;
+    /* Owner modem of SIM, bearer and SMS objects, keyed by object path; "/"
+     * for objects known not to belong to any monitored modem */
+    GHashTable *owners;
+    /* Filters */
+    gchar **interfaces;
+    gchar **modems;
+} Context;
+static Context *ctx;
+
+/* Options */
+static gboolean monitor_flag;
+static gchar **monitor_interface_strv;
+static gchar **monitor_modem_strv;
+
+static GOptionEntry entries[] = {
+    { "monitor", 0, 0, G_OPTION_ARG_NONE, &monitor_flag,
+      "Monitor property changes and signals of all modems, printed as newline-delimited JSON",
+      NULL
+    },
+    { "monitor-interface", 0, 0, G_OPTION_ARG_STRING_ARRAY, &monitor_interface_strv,
+      "Only monitor the given interface (e.g. 'Modem3gpp'); may be given multiple times",
+      "[INTERFACE]"
+    },
+    { "monitor-modem", 0, 0, G_OPTION_ARG_STRING_ARRAY, &monitor_modem_strv,
+      "Only monitor the given modem and its SIM, bearer and SMS objects; may be given multiple times",
+      "[PATH|INDEX]"
+    },
+    { NULL }
+};
+
+GOptionGroup *
+mmcli_monitor_get_option_group (void)
+{
+    GOptionGroup *group;
+
+    group = g_option_group_new ("monitor",
+                                "Monitor options",
+                                "Show monitor options",
+                                NULL,
+                                NULL);
+    g_option_group_add_entries (group, entries);
+
+    return group;
+}
+
+gboolean
+mmcli_monitor_options_enabled (void)
+{
+    static gboolean checked = FALSE;
+
+    if (checked)
+        return monitor_flag;
+
+    if (!monitor_flag && (monitor_interface_strv || monitor_modem_strv)) {
+        g_printerr ("error: monitor filters given without --monitor\n");
+        exit (EXIT_FAILURE);
+    }
+
+    if (monitor_flag)
+        mmcli_force_async_operation ();
+
+    checked = TRUE;
+    return monitor_flag;
+}
+
+static void
+context_free (Context *ctx)
+{
+    if (!ctx)
+        return;
+
+    if (ctx->watcher_id)
+        g_bus_unwatch_name (ctx->watcher_id);
+    if (ctx->signal_id)
+        g_dbus_connection_signal_unsubscribe (ctx->connection, ctx->signal_id);
+    if (ctx->cancellable)
+        g_object_unref (ctx->cancellable);
+    if (ctx->connection)
+        g_object_unref (ctx->connection);
+    g_hash_table_destroy (ctx->owners);
+    g_strfreev (ctx->interfaces);
+    g_strfreev (ctx->modems);
+    g_free (ctx);
+}
+
+void
+mmcli_monitor_shutdown (void)
+{
+    context_free (ctx);
+}
+
+/*****************************************************************************/
+/* JSON output */
+
+static void
+append_json_string (GString *str,
+                    const gchar *value)
+{
+    const gchar *p;
+
+    g_string_append_c (str, '"');
+    for (p = value; *p; p++) {
+        switch (*p) {
+        case '"':
+            g_string_append (str, "\\\"");
+            break;
+        case '\\':
+            g_string_append (str, "\\\\");
+            break;
+        case '\n':
+            g_string_append (str, "\\n");
+            break;
+        case '\r':
+            g_string_append (str, "\\r");
+            break;
+        case '\t':
+            g_string_append (str, "\\t");
+            break;
+        default:
+            if ((guchar) *p < 0x20)
+                g_string_append_printf (str, "\\u%04x", (guint) *p);
+            else
+                g_string_append_c (str, *p);
+            break;
+        }
+    }
+    g_string_append_c (str, '"');
+}
+
+static void append_json_value (GString *str,
+                               GVariant *value);
+
+static void
+append_json_dictionary (GString *str,
+                        GVariant *value)
+{
+    GVariantIter iter;
+    GVariant *entry;
+    gboolean first = TRUE;
+
+    g_string_append_c (str, '{');
+    g_variant_iter_init (&iter, value);
+    while ((entry = g_variant_iter_next_value (&iter)) != NULL) {
+        GVariant *key;
+        GVariant *item;
+
+        key = g_variant_get_child_value (entry, 0);
+        item = g_variant_get_child_value (entry, 1);
+
+        if (!first)
+            g_string_append_c (str, ',');
+        first = FALSE;
+
+        /* JSON keys must be strings */
+        if (g_variant_is_of_type (key, G_VARIANT_TYPE_STRING) ||
+            g_variant_is_of_type (key, G_VARIANT_TYPE_OBJECT_PATH))
+            append_json_string (str, g_variant_get_string (key, NULL));
+        else {
+            gchar *printed;
+
+            printed = g_variant_print (key, FALSE);
+            append_json_string (str, printed);
+            g_free (printed);
+        }
+        g_string_append_c (str, ':');
+        append_json_value (str, item);
+
+        g_variant_unref (item);
+        g_variant_unref (key);
+        g_variant_unref (entry);
+    }
+    g_string_append_c (str, '}');
+}
+
+static void
+append_json_array (GString *str,
+                   GVariant *value)
+{
+    GVariantIter iter;
+    GVariant *item;
+    gboolean first = TRUE;
+
+    g_string_append_c (str, '[');
+    g_variant_iter_init (&iter, value);
+    while ((item = g_variant_iter_next_value (&iter)) != NULL) {
+        if (!first)
+            g_string_append_c (str, ',');
+        first = FALSE;
+        append_json_value (str, item);
+        g_variant_unref (item);
+    }
+    g_string_append_c (str, ']');
+}
+
+static void
+append_json_value (GString *str,
+                   GVariant *value)
+{
+    switch (g_variant_classify (value)) {
+    case G_VARIANT_CLASS_BOOLEAN:
+        g_string_append (str, g_variant_get_boolean (value) ? "true" : "false");
+        break;
+    case G_VARIANT_CLASS_BYTE:
+        g_string_append_printf (str, "%u", (guint) g_variant_get_byte (value));
+        break;
+    case G_VARIANT_CLASS_INT16:
+        g_string_append_printf (str, "%d", (gint) g_variant_get_int16 (value));
+        break;
+    case G_VARIANT_CLASS_UINT16:
+        g_string_append_printf (str, "%u", (guint) g_variant_get_uint16 (value));
+        break;
+    case G_VARIANT_CLASS_INT32:
+        g_string_append_printf (str, "%d", g_variant_get_int32 (value));
+        break;
+    case G_VARIANT_CLASS_UINT32:
+        g_string_append_printf (str, "%u", g_variant_get_uint32 (value));
+        break;
+    case G_VARIANT_CLASS_INT64:
+        g_string_append_printf (str, "%" G_GINT64_FORMAT, g_variant_get_int64 (value));
+        break;
+    case G_VARIANT_CLASS_UINT64:
+        g_string_append_printf (str, "%" G_GUINT64_FORMAT, g_variant_get_uint64 (value));
+        break;
+    case G_VARIANT_CLASS_HANDLE:
+        g_string_append_printf (str, "%d", g_variant_get_handle (value));
+        break;
+    case G_VARIANT_CLASS_DOUBLE: {
+        gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+        /* Locale-independent */
+        g_string_append (str, g_ascii_dtostr (buf, sizeof (buf), g_variant_get_double (value)));
+        break;
+    }
+    case G_VARIANT_CLASS_STRING:
+    case G_VARIANT_CLASS_OBJECT_PATH:
+    case G_VARIANT_CLASS_SIGNATURE:
+        append_json_string (str, g_variant_get_string (value, NULL));
+        break;
+    case G_VARIANT_CLASS_VARIANT: {
+        GVariant *child;
+
+        child = g_variant_get_variant (value);
+        append_json_value (str, child);
+        g_variant_unref (child);
+        break;
+    }
+    case G_VARIANT_CLASS_MAYBE: {
+        GVariant *child;
+
+        child = g_variant_get_maybe (value);
+        if (child) {
+            append_json_value (str, child);
+            g_variant_unref (child);
+        } else
+            g_string_append (str, "null");
+        break;
+    }
+    case G_VARIANT_CLASS_ARRAY:
+        if (g_variant_type_is_dict_entry (g_variant_type_element (g_variant_get_type (value))))
+            append_json_dictionary (str, value);
+        else
+            append_json_array (str, value);
+        break;
+    case G_VARIANT_CLASS_TUPLE:
+    case G_VARIANT_CLASS_DICT_ENTRY:
+        append_json_array (str, value);
+        break;
+    }
+}
+
+static GString *
+event_new (const gchar *event,
+           const gchar *path)
+{
+    GString *str;
+    gint64 now;
+
+    now = g_get_real_time ();
+
+    str = g_string_sized_new (256);
+    g_string_append_printf (str,
+                            "{\"timestamp\":%" G_GINT64_FORMAT ".%06u,\"event\":\"%s\"",
+                            now / G_USEC_PER_SEC,
+                            (guint) (now % G_USEC_PER_SEC),
+                            event);
+    if (path) {
+        g_string_append (str, ",\"path\":");
+        append_json_string (str, path);
+    }
+    return str;
+}
+
+static void
+event_print_and_free (GString *str)
+{
+    g_string_append (str, "}\n");
+    fputs (str->str, stdout);
+    /* Collectors usually read from a pipe, don't keep events buffered */
+    fflush (stdout);
+    g_string_free (str, TRUE);
+}
+
+/*****************************************************************************/
+/* Filters */
+
+static gboolean
+interface_matches (const gchar *interface)
+{
+    guint i;
+
+    if (!ctx->interfaces)
+        return TRUE;
+
+    for (i = 0; ctx->interfaces[i]; i++) {
+        /* Either the full name, or just the last component of it */
+        if (g_str_equal (interface, ctx->interfaces[i]) ||
+            (g_str_has_suffix (interface, ctx->interfaces[i]) &&
+             interface[strlen (interface) - strlen (ctx->interfaces[i]) - 1] == '.'))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static gboolean
+path_matches (const gchar *path)
+{
+    const gchar *owner;
+    guint i;
+
+    if (!ctx->modems)
+        return TRUE;
+
+    /* SIM, bearer and SMS objects match if their modem does */
+    owner = g_hash_table_lookup (ctx->owners, path);
+    if (owner)
+        path = owner;
+
+    for (i = 0; ctx->modems[i]; i++) {
+        if (g_str_equal (path, ctx->modems[i]))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void
+track_owners (const gchar *path,
+              const gchar *interface,
+              GVariant *properties)
+{
+    const gchar *sim_path;
+
+    if (!g_str_equal (interface, MM_DBUS_INTERFACE_MODEM))
+        return;
+
+    if (g_variant_lookup (properties, "Sim", "&o", &sim_path) &&
+        g_strcmp0 (sim_path, "/") != 0)
+        g_hash_table_replace (ctx->owners, g_strdup (sim_path), g_strdup (path));
+}
+
+/* Bearers and SMS objects aren't listed in any property, so their owners are
+ * found with the ListBearers() and List() methods of each monitored modem.
+ * Signals from objects created after that are held until the lists are
+ * loaded again, so that none gets lost. */
+
+typedef struct {
+    gchar *path;
+    gchar *interface;
+    gchar *signal_name;
+    GVariant *parameters;
+    guint n_pending;
+} DeferredSignal;
+
+typedef struct {
+    gchar *modem_path;
+    DeferredSignal *deferred;
+} ListOwnedContext;
+
+static void dispatch_signal (const gchar *path,
+                             const gchar *interface,
+                             const gchar *signal_name,
+                             GVariant *parameters);
+
+static void
+deferred_signal_free (DeferredSignal *deferred)
+{
+    g_free (deferred->path);
+    g_free (deferred->interface);
+    g_free (deferred->signal_name);
+    g_variant_unref (deferred->parameters);
+    g_slice_free (DeferredSignal, deferred);
+}
+
+static void
+deferred_signal_complete (DeferredSignal *deferred)
+{
+    if (--deferred->n_pending > 0)
+        return;
+
+    /* Still unknown once all lists are loaded, so not ours */
+    if (!g_hash_table_lookup (ctx->owners, deferred->path))
+        g_hash_table_insert (ctx->owners, g_strdup (deferred->path), g_strdup ("/"));
+
+    dispatch_signal (deferred->path,
+                     deferred->interface,
+                     deferred->signal_name,
+                     deferred->parameters);
+    deferred_signal_free (deferred);
+}
+
+static void
+list_owned_ready (GDBusConnection *connection,
+                  GAsyncResult *res,
+                  ListOwnedContext *list_ctx)
+{
+    GError *error = NULL;
+    GVariant *reply;
+
+    reply = g_dbus_connection_call_finish (connection, res, &error);
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        /* Cancelled on exit; ctx may be gone already */
+        g_error_free (error);
+        if (list_ctx->deferred && --list_ctx->deferred->n_pending == 0)
+            deferred_signal_free (list_ctx->deferred);
+        g_free (list_ctx->modem_path);
+        g_slice_free (ListOwnedContext, list_ctx);
+        return;
+    }
+
+    if (!reply) {
+        /* Modem gone, or without Messaging interface */
+        g_debug ("Couldn't list objects of modem '%s': '%s'",
+                 list_ctx->modem_path,
+                 error->message);
+        g_error_free (error);
+    } else {
+        GVariantIter *iter;
+        const gchar *path;
+
+        g_variant_get (reply, "(ao)", &iter);
+        while (g_variant_iter_next (iter, "&o", &path))
+            g_hash_table_replace (ctx->owners, g_strdup (path), g_strdup (list_ctx->modem_path));
+        g_variant_iter_free (iter);
+        g_variant_unref (reply);
+    }
+
+    if (list_ctx->deferred)
+        deferred_signal_complete (list_ctx->deferred);
+
+    g_free (list_ctx->modem_path);
+    g_slice_free (ListOwnedContext, list_ctx);
+}
+
+static void
+list_owned_objects (const gchar *modem_path,
+                    const gchar *interface,
+                    DeferredSignal *deferred)
+{
+    ListOwnedContext *list_ctx;
+
+    list_ctx = g_slice_new (ListOwnedContext);
+    list_ctx->modem_path = g_strdup (modem_path);
+    list_ctx->deferred = deferred;
+    if (deferred)
+        deferred->n_pending++;
+
+    g_dbus_connection_call (ctx->connection,
+                            MM_DBUS_SERVICE,
+                            modem_path,
+                            interface,
+                            (g_str_equal (interface, MM_DBUS_INTERFACE_MODEM) ?
+                             "ListBearers" :
+                             "List"),
+                            NULL,
+                            G_VARIANT_TYPE ("(ao)"),
+                            G_DBUS_CALL_FLAGS_NONE,
+                            -1,
+                            ctx->cancellable,
+                            (GAsyncReadyCallback)list_owned_ready,
+                            list_ctx);
+}
+
+static gboolean
+owner_unknown (const gchar *path)
+{
+    return (ctx->modems &&
+            (g_str_has_prefix (path, MM_DBUS_BEARER_PREFIX) ||
+             g_str_has_prefix (path, MM_DBUS_SMS_PREFIX)) &&
+            !g_hash_table_lookup (ctx->owners, path));
+}
+
+static void
+defer_signal (const gchar *path,
+              const gchar *interface,
+              const gchar *signal_name,
+              GVariant *parameters)
+{
+    DeferredSignal *deferred;
+    const gchar *list_interface;
+    guint i;
+
+    deferred = g_slice_new0 (DeferredSignal);
+    deferred->path = g_strdup (path);
+    deferred->interface = g_strdup (interface);
+    deferred->signal_name = g_strdup (signal_name);
+    deferred->parameters = g_variant_ref (parameters);
+
+    list_interface = (g_str_has_prefix (path, MM_DBUS_BEARER_PREFIX) ?
+                      MM_DBUS_INTERFACE_MODEM :
+                      MM_DBUS_INTERFACE_MODEM_MESSAGING);
+
+    /* Keep it alive until all the calls are issued */
+    deferred->n_pending = 1;
+    for (i = 0; ctx->modems[i]; i++)
+        list_owned_objects (ctx->modems[i], list_interface, deferred);
+    deferred_signal_complete (deferred);
+}
+
+/*****************************************************************************/
+/* Events */
+
+static void
+print_object_added (const gchar *path,
+                    GVariant *interfaces_and_properties)
+{
+    GString *str = NULL;
+    GVariantIter iter;
+    const gchar *interface;
+    GVariant *properties;
+
+    g_variant_iter_init (&iter, interfaces_and_properties);
+    while (g_variant_iter_next (&iter, "{&s@a{sv}}", &interface, &properties)) {
+        track_owners (path, interface, properties);
+
+        /* Load the bearers and SMS objects already in monitored modems */
+        if (ctx->modems &&
+            path_matches (path) &&
+            (g_str_equal (interface, MM_DBUS_INTERFACE_MODEM) ||
+             g_str_equal (interface, MM_DBUS_INTERFACE_MODEM_MESSAGING)))
+            list_owned_objects (path, interface, NULL);
+
+        if (path_matches (path) && interface_matches (interface)) {
+            if (!str) {
+                str = event_new ("object-added", path);
+                g_string_append (str, ",\"interfaces\":{");
+            } else
+                g_string_append_c (str, ',');
+            append_json_string (str, interface);
+            g_string_append_c (str, ':');
+            append_json_dictionary (str, properties);
+        }
+        g_variant_unref (properties);
+    }
+
+    if (str) {
+        g_string_append_c (str, '}');
+        event_print_and_free (str);
+    }
+}
+
+static void
+print_object_removed (const gchar *path,
+                      GVariant *interfaces)
+{
+    GString *str = NULL;
+    GVariantIter iter;
+    const gchar *interface;
+
+    if (path_matches (path)) {
+        g_variant_iter_init (&iter, interfaces);
+        while (g_variant_iter_next (&iter, "&s", &interface)) {
+            if (!interface_matches (interface))
+                continue;
+            if (!str) {
+                str = event_new ("object-removed", path);
+                g_string_append (str, ",\"interfaces\":[");
+            } else
+                g_string_append_c (str, ',');
+            append_json_string (str, interface);
+        }
+    }
+
+    if (str) {
+        g_string_append_c (str, ']');
+        event_print_and_free (str);
+    }
+
+    g_hash_table_remove (ctx->owners, path);
+}
+
+static void
+print_properties_changed (const gchar *path,
+                          GVariant *parameters)
+{
+    const gchar *interface;
+    GVariant *changed;
+    GVariant *invalidated;
+    GString *str;
+
+    g_variant_get (parameters, "(&s@a{sv}@as)", &interface, &changed, &invalidated);
+
+    track_owners (path, interface, changed);
+
+    if (path_matches (path) && interface_matches (interface)) {
+        str = event_new ("properties-changed", path);
+        g_string_append (str, ",\"interface\":");
+        append_json_string (str, interface);
+        g_string_append (str, ",\"properties\":");
+        append_json_dictionary (str, changed);
+        if (g_variant_n_children (invalidated) > 0) {
+            g_string_append (str, ",\"invalidated\":");
+            append_json_array (str, invalidated);
+        }
+        event_print_and_free (str);
+    }
+
+    g_variant_unref (changed);
+    g_variant_unref (invalidated);
+}
+
+static void
+print_signal (const gchar *path,
+              const gchar *interface,
+              const gchar *signal_name,
+              GVariant *parameters)
+{
+    GString *str;
+
+    /* New SMS objects belong to the modem emitting the signal */
+    if (g_str_equal (interface, MM_DBUS_INTERFACE_MODEM_MESSAGING) &&
+        g_str_equal (signal_name, "Added")) {
+        const gchar *sms_path;
+
+        g_variant_get_child (parameters, 0, "&o", &sms_path);
+        g_hash_table_replace (ctx->owners, g_strdup (sms_path), g_strdup (path));
+    }
+
+    if (path_matches (path) && interface_matches (interface)) {
+        str = event_new ("signal", path);
+        g_string_append (str, ",\"interface\":");
+        append_json_string (str, interface);
+        g_string_append (str, ",\"signal\":");
+        append_json_string (str, signal_name);
+        g_string_append (str, ",\"args\":");
+        append_json_array (str, parameters);
+        event_print_and_free (str);
+    }
+
+    if (g_str_equal (interface, MM_DBUS_INTERFACE_MODEM_MESSAGING) &&
+        g_str_equal (signal_name, "Deleted")) {
+        const gchar *sms_path;
+
+        g_variant_get_child (parameters, 0, "&o", &sms_path);
+        g_hash_table_remove (ctx->owners, sms_path);
+    }
+}
+
+static void
+dispatch_signal (const gchar *object_path,
+                 const gchar *interface_name,
+                 const gchar *signal_name,
+                 GVariant *parameters)
+{
+    if (g_str_equal (interface_name, DBUS_INTERFACE_PROPERTIES)) {
+        if (g_str_equal (signal_name, "PropertiesChanged") &&
+            g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(sa{sv}as)")))
+            print_properties_changed (object_path, parameters);
+        return;
+    }
+
+    if (g_str_equal (interface_name, DBUS_INTERFACE_OBJECT_MANAGER)) {
+        const gchar *path;
+        GVariant *child;
+
+        if (g_str_equal (signal_name, "InterfacesAdded") &&
+            g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(oa{sa{sv}})"))) {
+            g_variant_get (parameters, "(&o@a{sa{sv}})", &path, &child);
+            print_object_added (path, child);
+            g_variant_unref (child);
+        } else if (g_str_equal (signal_name, "InterfacesRemoved") &&
+                   g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(oas)"))) {
+            g_variant_get (parameters, "(&o@as)", &path, &child);
+            print_object_removed (path, child);
+            g_variant_unref (child);
+        }
+        return;
+    }
+
+    print_signal (object_path, interface_name, signal_name, parameters);
+}
+
+static void
+signal_received (GDBusConnection *connection,
+                 const gchar *sender_name,
+                 const gchar *object_path,
+                 const gchar *interface_name,
+                 const gchar *signal_name,
+                 GVariant *parameters,
+                 gpointer user_data)
+{
+    if (owner_unknown (object_path))
+        defer_signal (object_path, interface_name, signal_name, parameters);
+    else
+        dispatch_signal (object_path, interface_name, signal_name, parameters);
+}
+
+/*****************************************************************************/
+
+static void
+get_managed_objects_ready (GDBusConnection *connection,
+                           GAsyncResult *res)
+{
+    GError *error = NULL;
+    GVariant *reply;
+    GVariant *objects;
+    GVariantIter iter;
+    const gchar *path;
+    GVariant *interfaces_and_properties;
+
+    reply = g_dbus_connection_call_finish (connection, res, &error);
+    if (!reply) {
+        /* Cancelled on exit, or daemon gone; the name watcher will tell */
+        g_debug ("Couldn't get managed objects: '%s'", error->message);
+        g_error_free (error);
+        return;
+    }
+
+    /* Current objects are reported as if they were just added */
+    objects = g_variant_get_child_value (reply, 0);
+    g_variant_iter_init (&iter, objects);
+    while (g_variant_iter_next (&iter, "{&o@a{sa{sv}}}", &path, &interfaces_and_properties)) {
+        print_object_added (path, interfaces_and_properties);
+        g_variant_unref (interfaces_and_properties);
+    }
+    g_variant_unref (objects);
+    g_variant_unref (reply);
+}
+
+static void
+daemon_appeared (GDBusConnection *connection,
+                 const gchar *name,
+                 const gchar *name_owner,
+                 gpointer user_data)
+{
+    event_print_and_free (event_new ("daemon-appeared", NULL));
+
+    /* Signals are already subscribed, so nothing gets lost in between */
+    g_dbus_connection_call (connection,
+                            MM_DBUS_SERVICE,
+                            MM_DBUS_PATH,
+                            DBUS_INTERFACE_OBJECT_MANAGER,
+                            "GetManagedObjects",
+                            NULL,
+                            G_VARIANT_TYPE ("(a{oa{sa{sv}}})"),
+                            G_DBUS_CALL_FLAGS_NONE,
+                            -1,
+                            ctx->cancellable,
+                            (GAsyncReadyCallback)get_managed_objects_ready,
+                            NULL);
+}
+
+static void
+daemon_vanished (GDBusConnection *connection,
+                 const gchar *name,
+                 gpointer user_data)
+{
+    event_print_and_free (event_new ("daemon-vanished", NULL));
+    g_hash_table_remove_all (ctx->owners);
+}
+
+static void
+cancelled (GCancellable *cancellable)
+{
+    mmcli_async_operation_done ();
+}
+
+static gchar **
+build_modem_filter (gchar **path_or_index_strv)
+{
+    gchar **modems;
+    guint i;
+
+    if (!path_or_index_strv)
+        return NULL;
+
+    modems = g_new0 (gchar *, g_strv_length (path_or_index_strv) + 1);
+    for (i = 0; path_or_index_strv[i]; i++) {
+        /* Modem path may come in two ways: full DBus path or just modem index */
+        if (g_str_has_prefix (path_or_index_strv[i], MM_DBUS_MODEM_PREFIX))
+            modems[i] = g_strdup (path_or_index_strv[i]);
+        else if (g_ascii_isdigit (path_or_index_strv[i][0]))
+            modems[i] = g_strdup_printf (MM_DBUS_MODEM_PREFIX "/%s", path_or_index_strv[i]);
+        else {
+            g_printerr ("error: invalid path or index string specified: '%s'\n",
+                        path_or_index_strv[i]);
+            exit (EXIT_FAILURE);
+        }
+    }
+    return modems;
+}
+
+void
+mmcli_monitor_run_asynchronous (GDBusConnection *connection,
+                                GCancellable    *cancellable)
+{
+    /* Initialize context */
+    ctx = g_new0 (Context, 1);
+    ctx->connection = g_object_ref (connection);
+    if (cancellable)
+        ctx->cancellable = g_object_ref (cancellable);
+    ctx->owners = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    ctx->interfaces = g_strdupv (monitor_interface_strv);
+    ctx->modems = build_modem_filter (monitor_modem_strv);
+
+    /* A single match rule covers every signal emitted by the daemon */
+    ctx->signal_id = g_dbus_connection_signal_subscribe (connection,
+                                                         MM_DBUS_SERVICE,
+                                                         NULL, /* interface */
+                                                         NULL, /* member */
+                                                         NULL, /* path */
+                                                         NULL, /* arg0 */
+                                                         G_DBUS_SIGNAL_FLAGS_NONE,
+                                                         signal_received,
+                                                         NULL,
+                                                         NULL);
+
+    /* Initial objects get reported once the daemon is found */
+    ctx->watcher_id = g_bus_watch_name_on_connection (connection,
+                                                      MM_DBUS_SERVICE,
+                                                      G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                                      daemon_appeared,
+                                                      daemon_vanished,
+                                                      NULL,
+                                                      NULL);
+
+    /* If we get cancelled, operation done */
+    g_cancellable_connect (ctx->cancellable,
+                           G_CALLBACK (cancelled),
+                           NULL,
+                           NULL);
+}
+
+void
+mmcli_monitor_run_synchronous (GDBusConnection *connection)
+{
+    g_printerr ("error: monitoring cannot be done synchronously\n");
+    exit (EXIT_FAILURE);
+}
@@ -190,6 +190,8 @@ main (gint argc, gchar **argv)
     context = g_option_context_new ("- Control and monitor the ModemManager");
 	g_option_context_add_group (context,
 	                            mmcli_manager_get_option_group ());
+    g_option_context_add_group (context,
+                                mmcli_monitor_get_option_group ());
     g_option_context_add_group (context,
                                 mmcli_get_common_option_group ());
 	g_option_context_add_group (context,
@@ -255,6 +257,20 @@ main (gint argc, gchar **argv)
         else
             mmcli_manager_run_synchronous (connection);
     }
+    /* Monitor options? */
+    else if (mmcli_monitor_options_enabled ()) {
+        /* Ensure options from different groups are not enabled */
+        if (mmcli_modem_options_enabled ()) {
+            g_printerr ("error: cannot use monitor and modem options "
+                        "at the same time\n");
+            exit (EXIT_FAILURE);
+        }
+
+        if (async_flag)
+            mmcli_monitor_run_asynchronous (connection, cancellable);
+        else
+            mmcli_monitor_run_synchronous (connection);
+    }
     /* Sim options? */
     else if (mmcli_sim_options_enabled ()) {
         if (async_flag)
@@ -347,6 +363,8 @@ main (gint argc, gchar **argv)
 
     if (mmcli_manager_options_enabled ()) {
         mmcli_manager_shutdown ();
+    } else if (mmcli_monitor_options_enabled ()) {
+        mmcli_monitor_shutdown ();
     } else if (mmcli_modem_3gpp_options_enabled ()) {
         mmcli_modem_3gpp_shutdown ();
     } else if (mmcli_modem_cdma_options_enabled ()) {
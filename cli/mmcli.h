@@ -37,6 +37,14 @@ void          mmcli_manager_run_asynchronous (GDBusConnection *connection,
 void          mmcli_manager_run_synchronous  (GDBusConnection *connection);
 void          mmcli_manager_shutdown         (void);
 
+/* Monitor group */
+GOptionGroup *mmcli_monitor_get_option_group (void);
+gboolean      mmcli_monitor_options_enabled  (void);
+void          mmcli_monitor_run_asynchronous (GDBusConnection *connection,
+                                              GCancellable    *cancellable);
+void          mmcli_monitor_run_synchronous  (GDBusConnection *connection);
+void          mmcli_monitor_shutdown         (void);
+
 /* Modem group */
 GOptionGroup *mmcli_modem_get_option_group   (void);
 gboolean      mmcli_modem_options_enabled    (void);
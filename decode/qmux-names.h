@@ -0,0 +1,383 @@
+/* Generated by qmuxnames.py from qmiprotocol.py; do not edit */
+
+static const QmuxServiceName qmux_service_names[] = {
+	{ 0, "CTL" },
+	{ 1, "WDS" },
+	{ 2, "DMS" },
+	{ 3, "NAS" },
+	{ 4, "QOS" },
+	{ 5, "WMS" },
+	{ 6, "PDS" },
+	{ 7, "AUTH" },
+	{ 9, "VOICE" },
+	{ 224, "CAT" },
+	{ 225, "RMS" },
+	{ 226, "OMA" },
+};
+
+/* Sorted by service and command, for bsearch() */
+static const QmuxCmdName qmux_cmd_names[] = {
+	{ 0, 32, "SET_INSTANCE_ID" },
+	{ 0, 33, "GET_VERSION_INFO" },
+	{ 0, 34, "GET_CLIENT_ID" },
+	{ 0, 35, "RELEASE_CLIENT_ID" },
+	{ 0, 36, "REVOKE_CLIENT_ID_IND" },
+	{ 0, 37, "INVALID_CLIENT_ID" },
+	{ 0, 38, "SET_DATA_FORMAT" },
+	{ 0, 39, "SYNC" },
+	{ 0, 40, "SET_EVENT" },
+	{ 0, 41, "SET_POWER_SAVE_CFG" },
+	{ 0, 42, "SET_POWER_SAVE_MODE" },
+	{ 0, 43, "GET_POWER_SAVE_MODE" },
+	{ 1, 0, "RESET" },
+	{ 1, 1, "SET_EVENT" },
+	{ 1, 2, "ABORT" },
+	{ 1, 32, "START_NET" },
+	{ 1, 33, "STOP_NET" },
+	{ 1, 34, "GET_PKT_STATUS" },
+	{ 1, 35, "GET_RATES" },
+	{ 1, 36, "GET_STATISTICS" },
+	{ 1, 37, "G0_DORMANT" },
+	{ 1, 38, "G0_ACTIVE" },
+	{ 1, 39, "CREATE_PROFILE" },
+	{ 1, 40, "MODIFY_PROFILE" },
+	{ 1, 41, "DELETE_PROFILE" },
+	{ 1, 42, "GET_PROFILE_LIST" },
+	{ 1, 43, "GET_PROFILE" },
+	{ 1, 44, "GET_DEFAULTS" },
+	{ 1, 45, "GET_SETTINGS" },
+	{ 1, 46, "SET_MIP" },
+	{ 1, 47, "GET_MIP" },
+	{ 1, 48, "GET_DORMANCY" },
+	{ 1, 52, "GET_AUTOCONNECT" },
+	{ 1, 53, "GET_DURATION" },
+	{ 1, 54, "GET_MODEM_STATUS" },
+	{ 1, 55, "GET_DATA_BEARER" },
+	{ 1, 56, "GET_MODEM_INFO" },
+	{ 1, 60, "GET_ACTIVE_MIP" },
+	{ 1, 61, "SET_ACTIVE_MIP" },
+	{ 1, 62, "GET_MIP_PROFILE" },
+	{ 1, 63, "SET_MIP_PROFILE" },
+	{ 1, 64, "GET_MIP_PARAMS" },
+	{ 1, 65, "SET_MIP_PARAMS" },
+	{ 1, 66, "GET_LAST_MIP_STATUS" },
+	{ 1, 67, "GET_AAA_AUTH_STATUS" },
+	{ 1, 68, "GET_CUR_DATA_BEARER" },
+	{ 1, 69, "GET_CALL_LIST" },
+	{ 1, 70, "GET_CALL_ENTRY" },
+	{ 1, 71, "CLEAR_CALL_LIST" },
+	{ 1, 72, "GET_CALL_LIST_MAX" },
+	{ 1, 77, "SET_IP_FAMILY" },
+	{ 1, 81, "SET_AUTOCONNECT" },
+	{ 1, 82, "GET_DNS" },
+	{ 1, 83, "SET_DNS" },
+	{ 1, 84, "GET_PRE_DORMANCY" },
+	{ 1, 85, "SET_CAM_TIMER" },
+	{ 1, 86, "GET_CAM_TIMER" },
+	{ 1, 87, "SET_SCRM" },
+	{ 1, 88, "GET_SCRM" },
+	{ 1, 89, "SET_RDUD" },
+	{ 1, 90, "GET_RDUD" },
+	{ 1, 91, "GET_SIPMIP_CALL_TYPE" },
+	{ 1, 92, "SET_PM_PERIOD" },
+	{ 1, 93, "SET_FORCE_LONG_SLEEP" },
+	{ 1, 94, "GET_PM_PERIOD" },
+	{ 1, 95, "GET_CALL_THROTTLE" },
+	{ 1, 96, "GET_NSAPI" },
+	{ 1, 97, "SET_DUN_CTRL_PREF" },
+	{ 1, 98, "GET_DUN_CTRL_INFO" },
+	{ 1, 99, "SET_DUN_CTRL_EVENT" },
+	{ 1, 100, "PENDING_DUN_CTRL" },
+	{ 1, 105, "GET_DATA_SYS" },
+	{ 1, 106, "GET_LAST_DATA_STATUS" },
+	{ 1, 107, "GET_CURR_DATA_SYS" },
+	{ 1, 108, "GET_PDN_THROTTLE" },
+	{ 2, 0, "RESET" },
+	{ 2, 1, "SET_EVENT" },
+	{ 2, 32, "GET_CAPS" },
+	{ 2, 33, "GET_MANUFACTURER" },
+	{ 2, 34, "GET_MODEL_ID" },
+	{ 2, 35, "GET_REV_ID" },
+	{ 2, 36, "GET_NUMBER" },
+	{ 2, 37, "GET_IDS" },
+	{ 2, 38, "GET_POWER_STATE" },
+	{ 2, 39, "UIM_SET_PIN_PROT" },
+	{ 2, 40, "UIM_PIN_VERIFY" },
+	{ 2, 41, "UIM_PIN_UNBLOCK" },
+	{ 2, 42, "UIM_PIN_CHANGE" },
+	{ 2, 43, "UIM_GET_PIN_STATUS" },
+	{ 2, 44, "GET_MSM_ID" },
+	{ 2, 45, "GET_OPERTAING_MODE" },
+	{ 2, 46, "SET_OPERATING_MODE" },
+	{ 2, 47, "GET_TIME" },
+	{ 2, 48, "GET_PRL_VERSION" },
+	{ 2, 49, "GET_ACTIVATED_STATE" },
+	{ 2, 50, "ACTIVATE_AUTOMATIC" },
+	{ 2, 51, "ACTIVATE_MANUAL" },
+	{ 2, 52, "GET_USER_LOCK_STATE" },
+	{ 2, 53, "SET_USER_LOCK_STATE" },
+	{ 2, 54, "SET_USER_LOCK_CODE" },
+	{ 2, 55, "READ_USER_DATA" },
+	{ 2, 56, "WRITE_USER_DATA" },
+	{ 2, 57, "READ_ERI_FILE" },
+	{ 2, 58, "FACTORY_DEFAULTS" },
+	{ 2, 59, "VALIDATE_SPC" },
+	{ 2, 60, "UIM_GET_ICCID" },
+	{ 2, 61, "GET_FIRWARE_ID" },
+	{ 2, 62, "SET_FIRMWARE_ID" },
+	{ 2, 63, "GET_HOST_LOCK_ID" },
+	{ 2, 64, "UIM_GET_CK_STATUS" },
+	{ 2, 65, "UIM_SET_CK_PROT" },
+	{ 2, 66, "UIM_UNBLOCK_CK" },
+	{ 2, 67, "GET_IMSI" },
+	{ 2, 68, "UIM_GET_STATE" },
+	{ 2, 69, "GET_BAND_CAPS" },
+	{ 2, 70, "GET_FACTORY_ID" },
+	{ 2, 71, "GET_FIRMWARE_PREF" },
+	{ 2, 72, "SET_FIRMWARE_PREF" },
+	{ 2, 73, "LIST_FIRMWARE" },
+	{ 2, 74, "DELETE_FIRMWARE" },
+	{ 2, 75, "SET_TIME" },
+	{ 2, 76, "GET_FIRMWARE_INFO" },
+	{ 2, 77, "GET_ALT_NET_CFG" },
+	{ 2, 78, "SET_ALT_NET_CFG" },
+	{ 2, 79, "GET_IMG_DLOAD_MODE" },
+	{ 2, 80, "SET_IMG_DLOAD_MODE" },
+	{ 2, 81, "GET_SW_VERSION" },
+	{ 2, 82, "SET_SPC" },
+	{ 3, 0, "RESET" },
+	{ 3, 1, "ABORT" },
+	{ 3, 2, "SET_EVENT" },
+	{ 3, 3, "SET_REG_EVENT" },
+	{ 3, 32, "GET_RSSI" },
+	{ 3, 33, "SCAN_NETS" },
+	{ 3, 34, "REGISTER_NET" },
+	{ 3, 35, "ATTACH_DETACH" },
+	{ 3, 36, "GET_SS_INFO" },
+	{ 3, 37, "GET_HOME_INFO" },
+	{ 3, 38, "GET_NET_PREF_LIST" },
+	{ 3, 39, "SET_NET_PREF_LIST" },
+	{ 3, 40, "GET_NET_BAN_LIST" },
+	{ 3, 41, "SET_NET_BAN_LIST" },
+	{ 3, 42, "SET_TECH_PREF" },
+	{ 3, 43, "GET_TECH_PREF" },
+	{ 3, 44, "GET_ACCOLC" },
+	{ 3, 45, "SET_ACCOLC" },
+	{ 3, 46, "GET_SYSPREF" },
+	{ 3, 47, "GET_NET_PARAMS" },
+	{ 3, 48, "SET_NET_PARAMS" },
+	{ 3, 49, "GET_RF_INFO" },
+	{ 3, 50, "GET_AAA_AUTH_STATUS" },
+	{ 3, 51, "SET_SYS_SELECT_PREF" },
+	{ 3, 52, "GET_SYS_SELECT_PREF" },
+	{ 3, 55, "SET_DDTM_PREF" },
+	{ 3, 56, "GET_DDTM_PREF" },
+	{ 3, 59, "GET_PLMN_MODE" },
+	{ 3, 60, "PLMN_MODE_IND" },
+	{ 3, 68, "GET_PLMN_NAME" },
+	{ 3, 69, "BIND_SUBS" },
+	{ 3, 70, "MANAGED_ROAMING_IND" },
+	{ 3, 71, "DSB_PREF_IND" },
+	{ 3, 72, "SUBS_INFO_IND" },
+	{ 3, 73, "GET_MODE_PREF" },
+	{ 3, 75, "SET_DSB_PREF" },
+	{ 3, 76, "NETWORK_TIME_IND" },
+	{ 3, 77, "GET_SYSTEM_INFO" },
+	{ 3, 78, "SYSTEM_INFO_IND" },
+	{ 3, 79, "GET_SIGNAL_INFO" },
+	{ 3, 80, "CFG_SIGNAL_INFO" },
+	{ 3, 81, "SIGNAL_INFO_IND" },
+	{ 3, 82, "GET_ERROR_RATE" },
+	{ 3, 83, "ERROR_RATE_IND" },
+	{ 3, 84, "EVDO_SESSION_IND" },
+	{ 3, 85, "EVDO_UATI_IND" },
+	{ 3, 86, "GET_EVDO_SUBTYPE" },
+	{ 3, 87, "GET_EVDO_COLOR_CODE" },
+	{ 3, 88, "GET_ACQ_SYS_MODE" },
+	{ 3, 89, "SET_RX_DIVERSITY" },
+	{ 3, 90, "GET_RX_TX_INFO" },
+	{ 3, 91, "UPDATE_AKEY_EXT" },
+	{ 3, 92, "GET_DSB_PREF" },
+	{ 3, 93, "DETACH_LTE" },
+	{ 3, 94, "BLOCK_LTE_PLMN" },
+	{ 3, 95, "UNBLOCK_LTE_PLMN" },
+	{ 3, 96, "RESET_LTE_PLMN_BLK" },
+	{ 3, 97, "CUR_PLMN_NAME_IND" },
+	{ 3, 98, "CONFIG_EMBMS" },
+	{ 3, 99, "GET_EMBMS_STATUS" },
+	{ 3, 100, "EMBMS_STATUS_IND" },
+	{ 3, 101, "GET_CDMA_POS_INFO" },
+	{ 3, 102, "RF_BAND_INFO_IND" },
+	{ 5, 0, "RESET" },
+	{ 5, 1, "SET_EVENT" },
+	{ 5, 32, "RAW_SEND" },
+	{ 5, 33, "RAW_WRITE" },
+	{ 5, 34, "RAW_READ" },
+	{ 5, 35, "MODIFY_TAG" },
+	{ 5, 36, "DELETE" },
+	{ 5, 48, "GET_MSG_PROTOCOL" },
+	{ 5, 49, "GET_MSG_LIST" },
+	{ 5, 50, "SET_ROUTES" },
+	{ 5, 51, "GET_ROUTES" },
+	{ 5, 52, "GET_SMSC_ADDR" },
+	{ 5, 53, "SET_SMSC_ADDR" },
+	{ 5, 54, "GET_MSG_LIST_MAX" },
+	{ 5, 55, "SEND_ACK" },
+	{ 5, 56, "SET_RETRY_PERIOD" },
+	{ 5, 57, "SET_RETRY_INTERVAL" },
+	{ 5, 58, "SET_DC_DISCO_TIMER" },
+	{ 5, 59, "SET_MEMORY_STATUS" },
+	{ 5, 60, "SET_BC_ACTIVATION" },
+	{ 5, 61, "SET_BC_CONFIG" },
+	{ 5, 62, "GET_BC_CONFIG" },
+	{ 5, 63, "MEMORY_FULL_IND" },
+	{ 5, 64, "GET_DOMAIN_PREF" },
+	{ 5, 65, "SET_DOMAIN_PREF" },
+	{ 5, 66, "MEMORY_SEND" },
+	{ 5, 67, "GET_MSG_WAITING" },
+	{ 5, 68, "MSG_WAITING_IND" },
+	{ 5, 69, "SET_PRIMARY_CLIENT" },
+	{ 5, 70, "SMSC_ADDR_IND" },
+	{ 5, 71, "INDICATOR_REG" },
+	{ 5, 72, "GET_TRANSPORT_INFO" },
+	{ 5, 73, "TRANSPORT_INFO_IND" },
+	{ 5, 74, "GET_NW_REG_INFO" },
+	{ 5, 75, "NW_REG_INFO_IND" },
+	{ 5, 76, "BIND_SUBSCRIPTION" },
+	{ 5, 77, "GET_INDICATOR_REG" },
+	{ 5, 78, "GET_SMS_PARAMETERS" },
+	{ 5, 79, "SET_SMS_PARAMETERS" },
+	{ 5, 80, "CALL_STATUS_IND" },
+	{ 6, 0, "RESET" },
+	{ 6, 1, "SET_EVENT" },
+	{ 6, 32, "GET_STATE" },
+	{ 6, 33, "SET_STATE" },
+	{ 6, 34, "START_SESSION" },
+	{ 6, 35, "GET_SESSION_INFO" },
+	{ 6, 36, "FIX_POSITION" },
+	{ 6, 37, "END_SESSION" },
+	{ 6, 38, "GET_NMEA_CFG" },
+	{ 6, 39, "SET_NMEA_CFG" },
+	{ 6, 40, "INJECT_TIME" },
+	{ 6, 41, "GET_DEFAULTS" },
+	{ 6, 42, "SET_DEFAULTS" },
+	{ 6, 43, "GET_XTRA_PARAMS" },
+	{ 6, 44, "SET_XTRA_PARAMS" },
+	{ 6, 45, "FORCE_XTRA_DL" },
+	{ 6, 46, "GET_AGPS_CONFIG" },
+	{ 6, 47, "SET_AGPS_CONFIG" },
+	{ 6, 48, "GET_SVC_AUTOTRACK" },
+	{ 6, 49, "SET_SVC_AUTOTRACK" },
+	{ 6, 50, "GET_COM_AUTOTRACK" },
+	{ 6, 51, "SET_COM_AUTOTRACK" },
+	{ 6, 52, "RESET_DATA" },
+	{ 6, 53, "SINGLE_FIX" },
+	{ 6, 54, "GET_VERSION" },
+	{ 6, 55, "INJECT_XTRA" },
+	{ 6, 56, "INJECT_POSITION" },
+	{ 6, 57, "INJECT_WIFI" },
+	{ 6, 58, "GET_SBAS_CONFIG" },
+	{ 6, 59, "SET_SBAS_CONFIG" },
+	{ 6, 60, "SEND_NI_RESPONSE" },
+	{ 6, 61, "INJECT_ABS_TIME" },
+	{ 6, 62, "INJECT_EFS" },
+	{ 6, 63, "GET_DPO_CONFIG" },
+	{ 6, 64, "SET_DPO_CONFIG" },
+	{ 6, 65, "GET_ODP_CONFIG" },
+	{ 6, 66, "SET_ODP_CONFIG" },
+	{ 6, 67, "CANCEL_SINGLE_FIX" },
+	{ 6, 68, "GET_GPS_STATE" },
+	{ 6, 80, "GET_METHODS" },
+	{ 6, 81, "SET_METHODS" },
+	{ 6, 82, "INJECT_SENSOR" },
+	{ 6, 83, "INJECT_TIME_SYNC" },
+	{ 6, 84, "GET_SENSOR_CFG" },
+	{ 6, 85, "SET_SENSOR_CFG" },
+	{ 6, 86, "GET_NAV_CFG" },
+	{ 6, 87, "SET_NAV_CFG" },
+	{ 6, 90, "SET_WLAN_BLANK" },
+	{ 6, 91, "SET_LBS_SC_RPT" },
+	{ 6, 92, "SET_LBS_SC" },
+	{ 6, 93, "GET_LBS_ENCRYPT_CFG" },
+	{ 6, 94, "SET_LBS_UPDATE_RATE" },
+	{ 6, 95, "SET_CELLDB_CONTROL" },
+	{ 6, 96, "READY_IND" },
+	{ 7, 32, "START_EAP" },
+	{ 7, 33, "SEND_EAP" },
+	{ 7, 34, "EAP_RESULT_IND" },
+	{ 7, 35, "GET_EAP_KEYS" },
+	{ 7, 36, "END_EAP" },
+	{ 7, 37, "RUN_AKA" },
+	{ 7, 38, "AKA_RESULT_IND" },
+	{ 9, 3, "INDICATION_REG" },
+	{ 9, 32, "CALL_ORIGINATE" },
+	{ 9, 33, "CALL_END" },
+	{ 9, 34, "CALL_ANSWER" },
+	{ 9, 36, "GET_CALL_INFO" },
+	{ 9, 37, "OTASP_STATUS_IND" },
+	{ 9, 38, "INFO_REC_IND" },
+	{ 9, 39, "SEND_FLASH" },
+	{ 9, 40, "BURST_DTMF" },
+	{ 9, 41, "START_CONT_DTMF" },
+	{ 9, 42, "STOP_CONT_DTMF" },
+	{ 9, 43, "DTMF_IND" },
+	{ 9, 44, "SET_PRIVACY_PREF" },
+	{ 9, 45, "PRIVACY_IND" },
+	{ 9, 46, "ALL_STATUS_IND" },
+	{ 9, 47, "GET_ALL_STATUS" },
+	{ 9, 49, "MANAGE_CALLS" },
+	{ 9, 50, "SUPS_NOTIFICATION_IND" },
+	{ 9, 51, "SET_SUPS_SERVICE" },
+	{ 9, 52, "GET_CALL_WAITING" },
+	{ 9, 53, "GET_CALL_BARRING" },
+	{ 9, 54, "GET_CLIP" },
+	{ 9, 55, "GET_CLIR" },
+	{ 9, 56, "GET_CALL_FWDING" },
+	{ 9, 57, "SET_CALL_BARRING_PWD" },
+	{ 9, 58, "ORIG_USSD" },
+	{ 9, 59, "ANSWER_USSD" },
+	{ 9, 60, "CANCEL_USSD" },
+	{ 9, 61, "USSD_RELEASE_IND" },
+	{ 9, 62, "USSD_IND" },
+	{ 9, 63, "UUS_IND" },
+	{ 9, 64, "SET_CONFIG" },
+	{ 9, 65, "GET_CONFIG" },
+	{ 9, 66, "SUPS_IND" },
+	{ 9, 67, "ASYNC_ORIG_USSD" },
+	{ 9, 68, "BIND_SUBSCRIPTION" },
+	{ 9, 69, "ALS_SET_LINE_SW" },
+	{ 9, 70, "ALS_SELECT_LINE" },
+	{ 9, 71, "AOC_RESET_ACM" },
+	{ 9, 72, "AOC_SET_ACM_MAX" },
+	{ 9, 73, "AOC_GET_CM_INFO" },
+	{ 9, 74, "AOC_LOW_FUNDS_IND" },
+	{ 9, 75, "GET_COLP" },
+	{ 9, 76, "GET_COLR" },
+	{ 9, 77, "GET_CNAP" },
+	{ 9, 78, "MANAGE_IP_CALLS" },
+	{ 224, 0, "RESET" },
+	{ 224, 1, "SET_EVENT" },
+	{ 224, 32, "GET_STATE" },
+	{ 224, 33, "SEND_TERMINAL" },
+	{ 224, 34, "SEND_ENVELOPE" },
+	{ 224, 35, "GET_EVENT" },
+	{ 224, 36, "SEND_DECODED_TERMINAL" },
+	{ 224, 37, "SEND_DECODED_ENVELOPE" },
+	{ 224, 38, "EVENT_CONFIRMATION" },
+	{ 224, 39, "SCWS_OPEN_CHANNEL" },
+	{ 224, 40, "SCWS_CLOSE_CHANNEL" },
+	{ 224, 41, "SCWS_SEND_DATA" },
+	{ 224, 42, "SCWS_DATA_AVAILABLE" },
+	{ 224, 43, "SCWS_CHANNEL_STATUS" },
+	{ 225, 0, "RESET" },
+	{ 225, 32, "GET_SMS_WAKE" },
+	{ 225, 33, "SET_SMS_WAKE" },
+	{ 226, 0, "RESET" },
+	{ 226, 1, "SET_EVENT" },
+	{ 226, 32, "START_SESSION" },
+	{ 226, 33, "CANCEL_SESSION" },
+	{ 226, 34, "GET_SESSION_INFO" },
+	{ 226, 35, "SEND_SELECTION" },
+	{ 226, 36, "GET_FEATURES" },
+	{ 226, 37, "SET_FEATURES" },
+};
@@ -0,0 +1,37 @@
+#!/usr/bin/python
+# -*- Mode: python; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details:
+#
+# Copyright (C) 2012 Google, Inc.
+#
+# ---- Generates qmux-names.h for usbdecode from the qmiprotocol.py tables:
+#
+#   python qmuxnames.py > qmux-names.h
+
+from qmiprotocol import services
+
+print("/* Generated by qmuxnames.py from qmiprotocol.py; do not edit */")
+print("")
+print("static const QmuxServiceName qmux_service_names[] = {")
+for svc in sorted(services.keys()):
+    print("\t{ %d, \"%s\" }," % (svc, services[svc][0].upper()))
+print("};")
+print("")
+print("/* Sorted by service and command, for bsearch() */")
+print("static const QmuxCmdName qmux_cmd_names[] = {")
+for svc in sorted(services.keys()):
+    cmds = services[svc][1]
+    if not cmds:
+        continue
+    for cmd in sorted(cmds.keys()):
+        print("\t{ %d, %d, \"%s\" }," % (svc, cmd, cmds[cmd][0]))
+print("};")
@@ -0,0 +1,1061 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+/* Decodes QMUX, WMC and DM traffic in UsbSnoopy captures, like decode.py
+ * and analyze.py do, but fast enough for captures of day-long sessions: the
+ * capture is mapped and scanned once, and frames are decoded as soon as
+ * they are complete.  Besides dumping one line per message it keeps per
+ * command counts and request->response latencies.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <endian.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "libqcdm/src/hdlc.h"
+#include "libqcdm/src/dm-commands.h"
+#include "libwmc/src/protocol.h"
+
+typedef struct {
+	u_int8_t service;
+	const char *name;
+} QmuxServiceName;
+
+typedef struct {
+	u_int8_t service;
+	u_int16_t cmd;
+	const char *name;
+} QmuxCmdName;
+
+#include "qmux-names.h"
+
+/* Same values as defs.py */
+enum {
+	TO_UNKNOWN = 0,
+	TO_MODEM = 1,
+	TO_HOST = 2,
+};
+
+enum {
+	PROTO_NONE = 0,
+	PROTO_QMUX,
+	PROTO_WMC,
+	PROTO_DM,
+};
+
+static const char *proto_names[] = { "raw", "qmux", "wmc", "dm" };
+
+enum {
+	MSG_REQUEST,
+	MSG_RESPONSE,
+	MSG_INDICATION,
+};
+
+/* QMUX */
+#define QMUX_IFACE      0x01
+#define QMUX_SVC_CTL    0x00
+#define QMI_TP_RESPONSE 0x02
+#define QMI_TP_IND      0x04
+#define QMI_CTL_RESPONSE 0x01
+#define QMI_CTL_IND      0x02
+
+struct QmuxHdr {
+	u_int8_t iface;
+	u_int16_t len;
+	u_int8_t sender;
+	u_int8_t service;
+	u_int8_t cid;
+} __attribute__ ((packed));
+
+struct QmiCtlHdr {
+	u_int8_t flags;
+	u_int8_t txn;
+	u_int16_t msgid;
+	u_int16_t len;
+} __attribute__ ((packed));
+
+struct QmiHdr {
+	u_int8_t flags;
+	u_int16_t txn;
+	u_int16_t msgid;
+	u_int16_t len;
+} __attribute__ ((packed));
+
+#define WMC_MARKER 0xC8
+#define AT_WMC_PREFIX "AT*WMC="
+
+/* UsbSnoopy echoes the control SetupPacket of GET_ENCAPSULATED_RESPONSE */
+static const u_int8_t setup_packet[] = { 0xa1, 0x01, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00 };
+
+/******************************************************************/
+
+/* Keys are (protocol << 24 | service << 16 | command) */
+#define MAKE_KEY(proto, svc, cmd) (((u_int32_t) (proto) << 24) | ((u_int32_t) ((svc) & 0xFF) << 16) | ((cmd) & 0xFFFF))
+
+typedef struct {
+	u_int32_t key;
+	int used;
+	u_int64_t count[3];
+	u_int64_t bytes;
+	u_int64_t lat_count;
+	double lat_sum;
+	double lat_min;
+	double lat_max;
+} Stat;
+
+typedef struct {
+	u_int32_t key;
+	u_int16_t txn;
+	u_int8_t cid;
+	double ts;
+} Pending;
+
+/* Requests still waiting for a response; unanswered ones get evicted */
+#define MAX_PENDING 256
+
+/* Longest partial frame kept; anything longer is garbage or a wrong --transfer */
+#define MAX_STREAM (64 * 1024)
+
+typedef struct {
+	unsigned char *buf;
+	size_t len;
+	size_t alloc;
+} Buffer;
+
+typedef struct {
+	/* Options */
+	int control;
+	int transfer;
+	int dump;
+	int filter_proto;
+	int filter_service;
+	int filter_cmd;
+
+	/* Current URB being parsed */
+	int in_packet;
+	int direction;
+	int proto;
+	int in_data;
+	double ts;
+	Buffer data;
+
+	/* Partial HDLC frames, per direction, and how much of each was already
+	 * searched for a terminator */
+	Buffer stream[3];
+	size_t stream_scanned[3];
+	Buffer scratch;
+
+	Stat *stats;
+	size_t stats_size;
+	size_t n_stats;
+
+	Pending pending[MAX_PENDING];
+	size_t n_pending;
+
+	u_int64_t n_urbs;
+	u_int64_t n_frames;
+	u_int64_t n_bad;
+	u_int64_t n_unanswered;
+	double first_ts;
+	double last_ts;
+} Decoder;
+
+static void
+buffer_append (Buffer *b, const void *data, size_t len)
+{
+	if (b->len + len > b->alloc) {
+		size_t alloc = b->alloc ? b->alloc : 1024;
+
+		while (alloc < b->len + len)
+			alloc *= 2;
+		b->buf = realloc (b->buf, alloc);
+		if (!b->buf) {
+			fprintf (stderr, "E: out of memory\n");
+			exit (1);
+		}
+		b->alloc = alloc;
+	}
+	memcpy (b->buf + b->len, data, len);
+	b->len += len;
+}
+
+static void
+buffer_reserve (Buffer *b, size_t len)
+{
+	if (len > b->alloc) {
+		b->buf = realloc (b->buf, len);
+		if (!b->buf) {
+			fprintf (stderr, "E: out of memory\n");
+			exit (1);
+		}
+		b->alloc = len;
+	}
+}
+
+/******************************************************************/
+
+static const char *
+qmux_service_name (u_int8_t service)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof (qmux_service_names) / sizeof (qmux_service_names[0]); i++) {
+		if (qmux_service_names[i].service == service)
+			return qmux_service_names[i].name;
+	}
+	return NULL;
+}
+
+static int
+qmux_cmd_cmp (const void *a, const void *b)
+{
+	const QmuxCmdName *x = a, *y = b;
+
+	if (x->service != y->service)
+		return x->service - y->service;
+	return x->cmd - y->cmd;
+}
+
+static const char *
+qmux_cmd_name (u_int8_t service, u_int16_t cmd)
+{
+	QmuxCmdName key = { service, cmd, NULL };
+	const QmuxCmdName *found;
+
+	found = bsearch (&key, qmux_cmd_names,
+	                 sizeof (qmux_cmd_names) / sizeof (qmux_cmd_names[0]),
+	                 sizeof (qmux_cmd_names[0]), qmux_cmd_cmp);
+	return found ? found->name : NULL;
+}
+
+static const char *
+wmc_cmd_name (u_int8_t cmd)
+{
+	switch (cmd) {
+	case WMC_CMD_GET_GLOBAL_MODE:    return "GET_GLOBAL_MODE";
+	case WMC_CMD_SET_GLOBAL_MODE:    return "SET_GLOBAL_MODE";
+	case WMC_CMD_DEVICE_INFO:        return "DEVICE_INFO";
+	case WMC_CMD_CONNECTION_INFO:    return "CONNECTION_INFO";
+	case WMC_CMD_NET_INFO:           return "NET_INFO";
+	case WMC_CMD_INIT:               return "INIT";
+	case WMC_CMD_FIELD_TEST:         return "FIELD_TEST";
+	case WMC_CMD_SET_OPERATOR:       return "SET_OPERATOR";
+	case WMC_CMD_GET_FIRST_OPERATOR: return "GET_FIRST_OPERATOR";
+	case WMC_CMD_GET_NEXT_OPERATOR:  return "GET_NEXT_OPERATOR";
+	case WMC_CMD_GET_APN:            return "GET_APN";
+	default:                         return NULL;
+	}
+}
+
+static const char *
+dm_cmd_name (u_int8_t cmd)
+{
+	switch (cmd) {
+	case DIAG_CMD_VERSION_INFO: return "VERSION_INFO";
+	case DIAG_CMD_ESN:          return "ESN";
+	case DIAG_CMD_STATUS:       return "STATUS";
+	case DIAG_CMD_LOGMASK:      return "LOGMASK";
+	case DIAG_CMD_LOG:          return "LOG";
+	case DIAG_CMD_BAD_CMD:      return "BAD_CMD";
+	case DIAG_CMD_BAD_PARM:     return "BAD_PARM";
+	case DIAG_CMD_BAD_LEN:      return "BAD_LEN";
+	case DIAG_CMD_BAD_DEV:      return "BAD_DEV";
+	case DIAG_CMD_BAD_MODE:     return "BAD_MODE";
+	case DIAG_CMD_NV_READ:      return "NV_READ";
+	case DIAG_CMD_NV_WRITE:     return "NV_WRITE";
+	case DIAG_CMD_CONTROL:      return "CONTROL";
+	case DIAG_CMD_SW_VERSION:   return "SW_VERSION";
+	case DIAG_CMD_STATE:        return "STATE";
+	case DIAG_CMD_PILOT_SETS:   return "PILOT_SETS";
+	case DIAG_CMD_SPC:          return "SPC";
+	case DIAG_CMD_SUBSYS:       return "SUBSYS";
+	case DIAG_CMD_LOG_CONFIG:   return "LOG_CONFIG";
+	case DIAG_CMD_EXT_LOGMASK:  return "EXT_LOGMASK";
+	case DIAG_CMD_EVENT_REPORT: return "EVENT_REPORT";
+	default:                    return NULL;
+	}
+}
+
+/******************************************************************/
+
+static Stat *
+stat_lookup (Decoder *d, u_int32_t key)
+{
+	size_t i, mask;
+
+	/* Grow at 50% load */
+	if (d->n_stats * 2 >= d->stats_size) {
+		Stat *old = d->stats;
+		size_t old_size = d->stats_size;
+
+		d->stats_size = old_size ? old_size * 2 : 256;
+		d->stats = calloc (d->stats_size, sizeof (Stat));
+		if (!d->stats) {
+			fprintf (stderr, "E: out of memory\n");
+			exit (1);
+		}
+		mask = d->stats_size - 1;
+		for (i = 0; i < old_size; i++) {
+			size_t j;
+
+			if (!old[i].used)
+				continue;
+			for (j = (old[i].key * 2654435761u) & mask; d->stats[j].used; j = (j + 1) & mask);
+			d->stats[j] = old[i];
+		}
+		free (old);
+	}
+
+	mask = d->stats_size - 1;
+	for (i = (key * 2654435761u) & mask; d->stats[i].used; i = (i + 1) & mask) {
+		if (d->stats[i].key == key)
+			return &d->stats[i];
+	}
+
+	d->stats[i].used = 1;
+	d->stats[i].key = key;
+	d->n_stats++;
+	return &d->stats[i];
+}
+
+static void
+pending_add (Decoder *d, u_int32_t key, u_int8_t cid, u_int16_t txn)
+{
+	Pending *p;
+
+	if (d->n_pending == MAX_PENDING) {
+		size_t i, oldest = 0;
+
+		for (i = 1; i < d->n_pending; i++) {
+			if (d->pending[i].ts < d->pending[oldest].ts)
+				oldest = i;
+		}
+		d->pending[oldest] = d->pending[--d->n_pending];
+		d->n_unanswered++;
+	}
+
+	p = &d->pending[d->n_pending++];
+	p->key = key;
+	p->cid = cid;
+	p->txn = txn;
+	p->ts = d->ts;
+}
+
+/* Returns the latency in ms, or a negative value if no request matches;
+ * DM and WMC have no transaction IDs, so their oldest request wins */
+static double
+pending_take (Decoder *d, u_int32_t key, u_int8_t cid, u_int16_t txn)
+{
+	size_t i, found = d->n_pending;
+	double lat;
+
+	for (i = 0; i < d->n_pending; i++) {
+		if (d->pending[i].key == key &&
+		    d->pending[i].cid == cid &&
+		    d->pending[i].txn == txn &&
+		    (found == d->n_pending || d->pending[i].ts < d->pending[found].ts))
+			found = i;
+	}
+	if (found == d->n_pending)
+		return -1;
+
+	lat = d->ts - d->pending[found].ts;
+	d->pending[found] = d->pending[--d->n_pending];
+	return lat;
+}
+
+static int
+filtered (Decoder *d, int proto, int service, int cmd)
+{
+	if (d->filter_proto && d->filter_proto != proto)
+		return 1;
+	if (d->filter_service >= 0 && d->filter_service != service)
+		return 1;
+	if (d->filter_cmd >= 0 && d->filter_cmd != cmd)
+		return 1;
+	return 0;
+}
+
+static void
+message (Decoder *d,
+         int proto,
+         int service,
+         int cmd,
+         int type,
+         u_int8_t cid,
+         u_int16_t txn,
+         size_t len)
+{
+	static const char *types[] = { "req", "rsp", "ind" };
+	u_int32_t key = MAKE_KEY (proto, service, cmd);
+	double lat = -1;
+	Stat *s;
+
+	d->n_frames++;
+	if (d->ts >= 0) {
+		if (d->first_ts < 0)
+			d->first_ts = d->ts;
+		d->last_ts = d->ts;
+	}
+
+	if (type == MSG_REQUEST)
+		pending_add (d, key, cid, txn);
+	else if (type == MSG_RESPONSE)
+		lat = pending_take (d, key, cid, txn);
+
+	if (filtered (d, proto, service, cmd))
+		return;
+
+	s = stat_lookup (d, key);
+	s->count[type]++;
+	s->bytes += len;
+	if (lat >= 0 && d->ts >= 0) {
+		if (!s->lat_count || lat < s->lat_min)
+			s->lat_min = lat;
+		if (!s->lat_count || lat > s->lat_max)
+			s->lat_max = lat;
+		s->lat_sum += lat;
+		s->lat_count++;
+	}
+
+	if (d->dump) {
+		const char *svc = NULL, *name = NULL;
+
+		if (proto == PROTO_QMUX) {
+			svc = qmux_service_name (service);
+			name = qmux_cmd_name (service, cmd);
+		} else if (proto == PROTO_WMC)
+			name = wmc_cmd_name (cmd);
+		else if (proto == PROTO_DM)
+			name = dm_cmd_name (cmd);
+
+		printf ("%12.3f %c %-4s ", d->ts, d->direction == TO_MODEM ? '>' : '<', proto_names[proto]);
+		if (svc)
+			printf ("%-5s ", svc);
+		else
+			printf ("0x%02x  ", service);
+		printf ("0x%04x %-26s %s", cmd, name ? name : "?", types[type]);
+		if (proto == PROTO_QMUX)
+			printf (" cid=%u txn=%u", cid, txn);
+		printf (" len=%zu", len);
+		if (lat >= 0 && d->ts >= 0)
+			printf (" latency=%.0fms", lat);
+		printf ("\n");
+	}
+}
+
+/******************************************************************/
+
+static void
+decode_qmux (Decoder *d, const u_int8_t *data, size_t len)
+{
+	const struct QmuxHdr *qmux = (const struct QmuxHdr *) data;
+	u_int16_t msgid, txn;
+	int type;
+
+	if (len < sizeof (*qmux) || qmux->iface != QMUX_IFACE ||
+	    (size_t) le16toh (qmux->len) + 1 > len) {
+		d->n_bad++;
+		return;
+	}
+	len = le16toh (qmux->len) + 1;
+
+	if (qmux->service == QMUX_SVC_CTL) {
+		const struct QmiCtlHdr *qmi = (const struct QmiCtlHdr *) (data + sizeof (*qmux));
+
+		if (len < sizeof (*qmux) + sizeof (*qmi)) {
+			d->n_bad++;
+			return;
+		}
+		/* Besides the CTL service header being shorter, the flags are different */
+		type = (qmi->flags == QMI_CTL_RESPONSE ? MSG_RESPONSE :
+		        qmi->flags == QMI_CTL_IND ? MSG_INDICATION :
+		        MSG_REQUEST);
+		txn = qmi->txn;
+		msgid = le16toh (qmi->msgid);
+	} else {
+		const struct QmiHdr *qmi = (const struct QmiHdr *) (data + sizeof (*qmux));
+
+		if (len < sizeof (*qmux) + sizeof (*qmi)) {
+			d->n_bad++;
+			return;
+		}
+		type = (qmi->flags & QMI_TP_IND ? MSG_INDICATION :
+		        qmi->flags & QMI_TP_RESPONSE ? MSG_RESPONSE :
+		        MSG_REQUEST);
+		txn = le16toh (qmi->txn);
+		msgid = le16toh (qmi->msgid);
+	}
+
+	message (d, PROTO_QMUX, qmux->service, msgid, type, qmux->cid, txn, len);
+}
+
+/* 'frame' is unescaped, without the CRC */
+static void
+decode_hdlc_frame (Decoder *d, int proto, const u_int8_t *frame, size_t len)
+{
+	int type = d->direction == TO_MODEM ? MSG_REQUEST : MSG_RESPONSE;
+
+	if (proto == PROTO_WMC) {
+		if (len < 2 || frame[0] != WMC_MARKER) {
+			d->n_bad++;
+			return;
+		}
+		message (d, PROTO_WMC, 0, frame[1], type, 0, 0, len);
+		return;
+	}
+
+	/* DM: log packets, events and errors are never replies to a request */
+	if (frame[0] == DIAG_CMD_LOG || frame[0] == DIAG_CMD_EVENT_REPORT)
+		type = MSG_INDICATION;
+
+	/* Subsystem commands are told apart by their subsystem and command */
+	if (frame[0] == DIAG_CMD_SUBSYS && len >= 4)
+		message (d, PROTO_DM, frame[1], frame[2] | (frame[3] << 8), type, 0, 0, len);
+	else
+		message (d, PROTO_DM, 0, frame[0], type, 0, 0, len);
+}
+
+static void
+stream_frame (Decoder *d, int proto, const u_int8_t *frame, size_t len)
+{
+	hdlcbool escaping = FALSE;
+	size_t unescaped;
+
+	/* UML290 commands are sent as AT*WMC=<frame>\r */
+	if (len >= strlen (AT_WMC_PREFIX) && !memcmp (frame, AT_WMC_PREFIX, strlen (AT_WMC_PREFIX))) {
+		frame += strlen (AT_WMC_PREFIX);
+		len -= strlen (AT_WMC_PREFIX);
+	}
+
+	/* Leading control chars give empty frames */
+	if (!len)
+		return;
+
+	buffer_reserve (&d->scratch, len + 1);
+	unescaped = hdlc_unescape ((const char *) frame, len, (char *) d->scratch.buf, len + 1, &escaping);
+	if (unescaped < 3) {
+		d->n_bad++;
+		return;
+	}
+
+	/* DM frames carry a real CRC; WMC ones may not (UML290 uses a fake one) */
+	if (proto == PROTO_DM &&
+	    hdlc_crc16_update (HDLC_CRC16_INIT, (const char *) d->scratch.buf, unescaped) != HDLC_CRC16_GOOD) {
+		d->n_bad++;
+		return;
+	}
+
+	decode_hdlc_frame (d, proto, d->scratch.buf, unescaped - 2);
+}
+
+/* DM and WMC are byte streams; frames may span several URBs */
+static void
+stream_feed (Decoder *d, int proto, const u_int8_t *data, size_t len)
+{
+	Buffer *s = &d->stream[d->direction];
+	size_t start = 0, i;
+
+	buffer_append (s, data, len);
+
+	/* Only the new bytes can hold a terminator */
+	for (i = d->stream_scanned[d->direction]; i < s->len; i++) {
+		u_int8_t c = s->buf[i];
+
+		if (c == HDLC_CONTROL_CHAR ||
+		    (c == '\r' && i - start >= 2 && s->buf[start] == 'A' && s->buf[start + 1] == 'T')) {
+			stream_frame (d, proto, s->buf + start, i - start);
+			start = i + 1;
+		}
+	}
+
+	if (start) {
+		memmove (s->buf, s->buf + start, s->len - start);
+		s->len -= start;
+	}
+
+	if (s->len > MAX_STREAM) {
+		d->n_bad++;
+		s->len = 0;
+	}
+	d->stream_scanned[d->direction] = s->len;
+}
+
+static void
+urb_data (Decoder *d)
+{
+	const u_int8_t *data = d->data.buf;
+	size_t len = d->data.len;
+
+	d->n_urbs++;
+	if (!len || d->direction == TO_UNKNOWN)
+		return;
+
+	if (len == sizeof (setup_packet) && !memcmp (data, setup_packet, len))
+		return;
+
+	switch (d->proto) {
+	case PROTO_QMUX:
+		decode_qmux (d, data, len);
+		break;
+	case PROTO_WMC:
+	case PROTO_DM:
+		stream_feed (d, d->proto, data, len);
+		break;
+	default:
+		break;
+	}
+}
+
+/******************************************************************/
+/* UsbSnoopy text captures, as handled by decode.py and packet.py */
+
+static const signed char hex_values[256] = {
+	['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5,
+	['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+	['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+	['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+};
+
+/* Appends hex byte pairs, ignoring whitespace, until anything else */
+static void
+append_hex (Buffer *b, const char *p, const char *end)
+{
+	while (p < end) {
+		int hi, lo;
+		u_int8_t c;
+
+		if (*p == ' ' || *p == '\t') {
+			p++;
+			continue;
+		}
+		if (p + 1 >= end)
+			break;
+		hi = hex_values[(u_int8_t) p[0]];
+		lo = hex_values[(u_int8_t) p[1]];
+		if (!hi || !lo)
+			break;
+		c = ((hi - 1) << 4) | (lo - 1);
+		buffer_append (b, &c, 1);
+		p += 2;
+	}
+}
+
+static const char *
+find (const char *p, const char *end, const char *needle)
+{
+	return memmem (p, end - p, needle, strlen (needle));
+}
+
+static int
+starts_with (const char *p, const char *end, const char *prefix)
+{
+	size_t len = strlen (prefix);
+
+	return (size_t) (end - p) >= len && !memcmp (p, prefix, len);
+}
+
+static void
+text_packet_done (Decoder *d)
+{
+	if (d->in_packet && d->in_data)
+		urb_data (d);
+	d->in_packet = 0;
+	d->in_data = 0;
+}
+
+static void
+text_line (Decoder *d, const char *p, const char *end)
+{
+	const char *s;
+
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	while (end > p && (end[-1] == '\r' || end[-1] == ' '))
+		end--;
+	if (p == end)
+		return;
+
+	/* New URB: "[1234 ms]  >>>  URB 5 going down  >>>" */
+	if (*p == '[' || (s = find (p, end, "URB ")) != NULL) {
+		int direction = TO_UNKNOWN;
+
+		if (find (p, end, ">>>  URB "))
+			direction = TO_MODEM;
+		else if (find (p, end, "<<<  URB "))
+			direction = TO_HOST;
+		else if (*p != '[')
+			goto not_urb;
+
+		text_packet_done (d);
+		if (direction == TO_UNKNOWN)
+			return;
+
+		d->in_packet = 1;
+		d->direction = direction;
+		d->proto = PROTO_NONE;
+		d->ts = (*p == '[') ? strtod (p + 1, NULL) : -1;
+		return;
+	}
+
+not_urb:
+	if (!d->in_packet)
+		return;
+
+	if (*p == '-' && (s = find (p, end, "-- URB_FUNCTION_")) != NULL) {
+		if (find (s, end, "BULK_OR_INTERRUPT_TRANSFER"))
+			d->proto = d->transfer;
+		else if (find (s, end, "CONTROL_TRANSFER") || find (s, end, "CLASS_INTERFACE"))
+			d->proto = d->control;
+		else
+			d->proto = PROTO_NONE;
+		return;
+	}
+
+	if (starts_with (p, end, "TransferBufferMDL")) {
+		d->in_data = 1;
+		d->data.len = 0;
+		return;
+	}
+
+	if (starts_with (p, end, "UrbLink")) {
+		if (d->in_data) {
+			urb_data (d);
+			d->in_data = 0;
+		}
+		return;
+	}
+
+	/* "00000000: 01 0c 00 ..." */
+	if (d->in_data && d->proto != PROTO_NONE) {
+		s = memchr (p, ':', end - p);
+		if (s && s + 1 < end && s[1] == ' ')
+			append_hex (&d->data, s + 2, end);
+	}
+}
+
+static void
+parse_text (Decoder *d, const char *p, const char *end)
+{
+	while (p < end) {
+		const char *eol = memchr (p, '\n', end - p);
+
+		if (!eol)
+			eol = end;
+		text_line (d, p, eol);
+		p = eol + 1;
+	}
+	text_packet_done (d);
+}
+
+/******************************************************************/
+/* UsbSnoopy XML exports, as handled by analyze.py */
+
+static const char *
+xml_element (const char *p, const char *end, const char *name, const char **out_end)
+{
+	char open[64], close[64];
+	const char *s, *e;
+
+	snprintf (open, sizeof (open), "<%s>", name);
+	snprintf (close, sizeof (close), "</%s>", name);
+	s = find (p, end, open);
+	if (!s)
+		return NULL;
+	s += strlen (open);
+	e = find (s, end, close);
+	if (!e)
+		return NULL;
+	*out_end = e;
+	return s;
+}
+
+static void
+parse_xml (Decoder *d, const char *p, const char *end)
+{
+	for (;;) {
+		const char *payload, *payload_end, *s, *e;
+
+		payload = find (p, end, "<payload>");
+		if (!payload)
+			break;
+		payload_end = find (payload, end, "</payload>");
+		if (!payload_end)
+			break;
+		p = payload_end + strlen ("</payload>");
+
+		/* Only bulk transfers are exported with payloads */
+		s = xml_element (payload, payload_end, "function", &e);
+		if (s && !find (s, e, "BULK_OR_INTERRUPT_TRANSFER"))
+			continue;
+
+		s = xml_element (payload, payload_end, "timestamp", &e);
+		d->ts = s ? strtod (s, NULL) : -1;
+
+		d->data.len = 0;
+		s = xml_element (payload, payload_end, "payloadbytes", &e);
+		while (s && s < e) {
+			const char *eol = memchr (s, '\n', e - s);
+
+			if (!eol)
+				eol = e;
+			append_hex (&d->data, s, eol);
+			s = eol + 1;
+		}
+		if (!d->data.len)
+			continue;
+
+		/* Exports don't say which way data went; guess it like analyze.py */
+		if (d->data.len >= strlen (AT_WMC_PREFIX) &&
+		    !memcmp (d->data.buf, AT_WMC_PREFIX, strlen (AT_WMC_PREFIX)))
+			d->direction = TO_MODEM;
+		else if (d->data.buf[d->data.len - 1] == HDLC_CONTROL_CHAR)
+			d->direction = TO_HOST;
+		else
+			d->direction = TO_UNKNOWN;
+
+		d->proto = d->transfer;
+		urb_data (d);
+	}
+}
+
+/******************************************************************/
+
+static int
+stat_cmp (const void *a, const void *b)
+{
+	const Stat *x = a, *y = b;
+
+	return x->key < y->key ? -1 : x->key > y->key;
+}
+
+static void
+print_stats (Decoder *d)
+{
+	size_t i, n = 0;
+
+	/* Compact and sort the table; it isn't used afterwards */
+	for (i = 0; i < d->stats_size; i++) {
+		if (d->stats[i].used)
+			d->stats[n++] = d->stats[i];
+	}
+	qsort (d->stats, n, sizeof (Stat), stat_cmp);
+
+	printf ("\nURBs: %llu  frames: %llu  malformed: %llu  unanswered: %llu\n",
+	        (unsigned long long) d->n_urbs,
+	        (unsigned long long) d->n_frames,
+	        (unsigned long long) d->n_bad,
+	        (unsigned long long) (d->n_unanswered + d->n_pending));
+	if (d->first_ts >= 0)
+		printf ("span: %.3f s\n", (d->last_ts - d->first_ts) / 1000.0);
+
+	printf ("\n%-4s %-5s %-6s %-26s %8s %8s %8s %10s %9s %9s %9s\n",
+	        "prot", "svc", "cmd", "name", "req", "rsp", "ind", "bytes",
+	        "lat-min", "lat-avg", "lat-max");
+	for (i = 0; i < n; i++) {
+		const Stat *s = &d->stats[i];
+		int proto = s->key >> 24;
+		int service = (s->key >> 16) & 0xFF;
+		int cmd = s->key & 0xFFFF;
+		const char *svc = NULL, *name = NULL;
+		char svcbuf[8];
+
+		if (proto == PROTO_QMUX) {
+			svc = qmux_service_name (service);
+			name = qmux_cmd_name (service, cmd);
+		} else if (proto == PROTO_WMC)
+			name = wmc_cmd_name (cmd);
+		else if (proto == PROTO_DM)
+			name = dm_cmd_name (cmd);
+		if (!svc) {
+			snprintf (svcbuf, sizeof (svcbuf), "0x%02x", service);
+			svc = svcbuf;
+		}
+
+		printf ("%-4s %-5s 0x%04x %-26s %8llu %8llu %8llu %10llu",
+		        proto_names[proto], svc, cmd, name ? name : "?",
+		        (unsigned long long) s->count[MSG_REQUEST],
+		        (unsigned long long) s->count[MSG_RESPONSE],
+		        (unsigned long long) s->count[MSG_INDICATION],
+		        (unsigned long long) s->bytes);
+		if (s->lat_count)
+			printf (" %7.0fms %7.0fms %7.0fms",
+			        s->lat_min, s->lat_sum / s->lat_count, s->lat_max);
+		printf ("\n");
+	}
+}
+
+/******************************************************************/
+
+static int
+parse_proto (const char *str)
+{
+	int i;
+
+	for (i = 0; i < sizeof (proto_names) / sizeof (proto_names[0]); i++) {
+		if (!strcasecmp (str, proto_names[i]))
+			return i;
+	}
+	return -1;
+}
+
+static int
+parse_service (Decoder *d, const char *str)
+{
+	size_t i;
+	char *end = NULL;
+	int proto;
+
+	proto = parse_proto (str);
+	if (proto > PROTO_NONE) {
+		d->filter_proto = proto;
+		return 0;
+	}
+
+	for (i = 0; i < sizeof (qmux_service_names) / sizeof (qmux_service_names[0]); i++) {
+		if (!strcasecmp (str, qmux_service_names[i].name)) {
+			d->filter_proto = PROTO_QMUX;
+			d->filter_service = qmux_service_names[i].service;
+			return 0;
+		}
+	}
+
+	d->filter_service = strtol (str, &end, 0);
+	if (!end || *end || d->filter_service < 0 || d->filter_service > 0xFF)
+		return -1;
+	return 0;
+}
+
+static void
+usage (const char *prog)
+{
+	fprintf (stderr, "Usage: %s [options] <capture>\n\n", prog);
+	fprintf (stderr, "  --control=PROTO    protocol of control transfers (default: qmux)\n");
+	fprintf (stderr, "  --transfer=PROTO   protocol of bulk transfers (default: dm)\n");
+	fprintf (stderr, "                     PROTO is one of qmux, wmc, dm or raw\n");
+	fprintf (stderr, "  --service=SVC      only QMUX service SVC (name or number), or only\n");
+	fprintf (stderr, "                     one protocol (qmux, wmc or dm)\n");
+	fprintf (stderr, "  --command=CMD      only command/message CMD\n");
+	fprintf (stderr, "  --stats            only print statistics\n");
+	fprintf (stderr, "\nText captures and XML exports are both understood.\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+	static const struct option options[] = {
+		{ "control",  required_argument, NULL, 'c' },
+		{ "transfer", required_argument, NULL, 't' },
+		{ "service",  required_argument, NULL, 's' },
+		{ "command",  required_argument, NULL, 'm' },
+		{ "stats",    no_argument,       NULL, 'S' },
+		{ "help",     no_argument,       NULL, 'h' },
+		{ NULL }
+	};
+	Decoder d;
+	struct stat st;
+	const char *map, *p;
+	char *end;
+	int fd, opt;
+
+	memset (&d, 0, sizeof (d));
+	d.control = PROTO_QMUX;
+	d.transfer = PROTO_DM;
+	d.dump = 1;
+	d.filter_service = -1;
+	d.filter_cmd = -1;
+	d.first_ts = -1;
+
+	while ((opt = getopt_long (argc, argv, "h", options, NULL)) != -1) {
+		switch (opt) {
+		case 'c':
+			d.control = parse_proto (optarg);
+			break;
+		case 't':
+			d.transfer = parse_proto (optarg);
+			break;
+		case 's':
+			if (parse_service (&d, optarg) < 0) {
+				fprintf (stderr, "E: unknown service '%s'\n", optarg);
+				return 1;
+			}
+			break;
+		case 'm':
+			d.filter_cmd = strtol (optarg, &end, 0);
+			if (!end || *end) {
+				fprintf (stderr, "E: invalid command '%s'\n", optarg);
+				return 1;
+			}
+			break;
+		case 'S':
+			d.dump = 0;
+			break;
+		default:
+			usage (argv[0]);
+			return 1;
+		}
+	}
+
+	if (d.control < 0 || d.transfer < 0 || optind != argc - 1) {
+		usage (argv[0]);
+		return 1;
+	}
+
+	fd = open (argv[optind], O_RDONLY);
+	if (fd < 0 || fstat (fd, &st) < 0) {
+		fprintf (stderr, "E: couldn't open '%s'\n", argv[optind]);
+		return 1;
+	}
+	if (st.st_size == 0) {
+		close (fd);
+		return 0;
+	}
+
+	map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (map == MAP_FAILED) {
+		fprintf (stderr, "E: couldn't map '%s'\n", argv[optind]);
+		return 1;
+	}
+	madvise ((void *) map, st.st_size, MADV_SEQUENTIAL);
+
+	p = map;
+	while (p < map + st.st_size && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+		p++;
+	if (p < map + st.st_size && *p == '<')
+		parse_xml (&d, p, map + st.st_size);
+	else
+		parse_text (&d, p, map + st.st_size);
+
+	print_stats (&d);
+
+	munmap ((void *) map, st.st_size);
+	free (d.data.buf);
+	free (d.stream[TO_MODEM].buf);
+	free (d.stream[TO_HOST].buf);
+	free (d.scratch.buf);
+	free (d.stats);
+	return 0;
+}
@@ -569,6 +569,180 @@ mm_modem_3gpp_scan_sync (MMModem3gpp *self,
     return create_networks_list (result);
 }
 
+/**
+ * mm_modem_3gpp_scan_cached_finish:
+ * @self: A #MMModem3gpp.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_modem_3gpp_scan_cached().
+ * @age: (out) (allow-none): Return location for the age of the results, in seconds, or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with mm_modem_3gpp_scan_cached().
+ *
+ * Returns: a list of #MMModem3gppNetwork structs, or #NULL if @error is set. The returned value should be freed with g_list_free_full() using mm_modem_3gpp_network_free() as #GDestroyNotify function.
+ */
+GList *
+mm_modem_3gpp_scan_cached_finish (MMModem3gpp *self,
+                                  GAsyncResult *res,
+                                  guint *age,
+                                  GError **error)
+{
+    GVariant *result = NULL;
+    guint result_age = 0;
+    GList *list;
+
+    g_return_val_if_fail (MM_IS_MODEM_3GPP (self), NULL);
+
+    if (!mm_gdbus_modem3gpp_call_scan_cached_finish (MM_GDBUS_MODEM3GPP (self), &result, &result_age, res, error))
+        return NULL;
+
+    list = create_networks_list (result);
+    g_variant_unref (result);
+    if (age)
+        *age = result_age;
+    return list;
+}
+
+/**
+ * mm_modem_3gpp_scan_cached:
+ * @self: A #MMModem3gpp.
+ * @max_age: Maximum age of the results, in seconds.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously requests the results of the last scan of available 3GPP
+ * networks, if it finished less than @max_age seconds ago; otherwise a new scan
+ * is run. If a scan is already running, its results are given instead.
+ *
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call mm_modem_3gpp_scan_cached_finish() to get the result of the operation.
+ *
+ * See mm_modem_3gpp_scan_cached_sync() for the synchronous, blocking version of this method.
+ */
+void
+mm_modem_3gpp_scan_cached (MMModem3gpp *self,
+                           guint max_age,
+                           GCancellable *cancellable,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+    g_return_if_fail (MM_IS_MODEM_3GPP (self));
+
+    mm_gdbus_modem3gpp_call_scan_cached (MM_GDBUS_MODEM3GPP (self), max_age, cancellable, callback, user_data);
+}
+
+/**
+ * mm_modem_3gpp_scan_cached_sync:
+ * @self: A #MMModem3gpp.
+ * @max_age: Maximum age of the results, in seconds.
+ * @age: (out) (allow-none): Return location for the age of the results, in seconds, or %NULL.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously requests the results of the last scan of available 3GPP
+ * networks, if it finished less than @max_age seconds ago; otherwise a new scan
+ * is run. If a scan is already running, its results are given instead.
+ *
+ * The calling thread is blocked until a reply is received. See mm_modem_3gpp_scan_cached()
+ * for the asynchronous version of this method.
+ *
+ * Returns: a list of #MMModem3gppNetwork structs, or #NULL if @error is set. The returned value should be freed with g_list_free_full() using mm_modem_3gpp_network_free() as #GDestroyNotify function.
+ */
+GList *
+mm_modem_3gpp_scan_cached_sync (MMModem3gpp *self,
+                                guint max_age,
+                                guint *age,
+                                GCancellable *cancellable,
+                                GError **error)
+{
+    GVariant *result = NULL;
+    guint result_age = 0;
+    GList *list;
+
+    g_return_val_if_fail (MM_IS_MODEM_3GPP (self), NULL);
+
+    if (!mm_gdbus_modem3gpp_call_scan_cached_sync (MM_GDBUS_MODEM3GPP (self), max_age, &result, &result_age, cancellable, error))
+        return NULL;
+
+    list = create_networks_list (result);
+    g_variant_unref (result);
+    if (age)
+        *age = result_age;
+    return list;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_modem_3gpp_start_background_scan_finish:
+ * @self: A #MMModem3gpp.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_modem_3gpp_start_background_scan().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with mm_modem_3gpp_start_background_scan().
+ *
+ * Returns: %TRUE if the scan was started, %FALSE if @error is set.
+ */
+gboolean
+mm_modem_3gpp_start_background_scan_finish (MMModem3gpp *self,
+                                            GAsyncResult *res,
+                                            GError **error)
+{
+    g_return_val_if_fail (MM_IS_MODEM_3GPP (self), FALSE);
+
+    return mm_gdbus_modem3gpp_call_start_background_scan_finish (MM_GDBUS_MODEM3GPP (self), res, error);
+}
+
+/**
+ * mm_modem_3gpp_start_background_scan:
+ * @self: A #MMModem3gpp.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously requests to start a background scan of available 3GPP
+ * networks. The results can later be retrieved with mm_modem_3gpp_scan_cached().
+ *
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call mm_modem_3gpp_start_background_scan_finish() to get the result of the operation.
+ *
+ * See mm_modem_3gpp_start_background_scan_sync() for the synchronous, blocking version of this method.
+ */
+void
+mm_modem_3gpp_start_background_scan (MMModem3gpp *self,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+    g_return_if_fail (MM_IS_MODEM_3GPP (self));
+
+    mm_gdbus_modem3gpp_call_start_background_scan (MM_GDBUS_MODEM3GPP (self), cancellable, callback, user_data);
+}
+
+/**
+ * mm_modem_3gpp_start_background_scan_sync:
+ * @self: A #MMModem3gpp.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously requests to start a background scan of available 3GPP
+ * networks. The results can later be retrieved with mm_modem_3gpp_scan_cached_sync().
+ *
+ * The calling thread is blocked until a reply is received. See mm_modem_3gpp_start_background_scan()
+ * for the asynchronous version of this method.
+ *
+ * Returns: %TRUE if the scan was started, %FALSE if @error is set.
+ */
+gboolean
+mm_modem_3gpp_start_background_scan_sync (MMModem3gpp *self,
+                                          GCancellable *cancellable,
+                                          GError **error)
+{
+    g_return_val_if_fail (MM_IS_MODEM_3GPP (self), FALSE);
+
+    return mm_gdbus_modem3gpp_call_start_background_scan_sync (MM_GDBUS_MODEM3GPP (self), cancellable, error);
+}
+
 /*****************************************************************************/
 
 static void
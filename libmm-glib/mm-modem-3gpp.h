@@ -119,6 +119,32 @@ GList *mm_modem_3gpp_scan_sync   (MMModem3gpp *self,
                                   GCancellable *cancellable,
                                   GError **error);
 
+void   mm_modem_3gpp_scan_cached        (MMModem3gpp *self,
+                                         guint max_age,
+                                         GCancellable *cancellable,
+                                         GAsyncReadyCallback callback,
+                                         gpointer user_data);
+GList *mm_modem_3gpp_scan_cached_finish (MMModem3gpp *self,
+                                         GAsyncResult *res,
+                                         guint *age,
+                                         GError **error);
+GList *mm_modem_3gpp_scan_cached_sync   (MMModem3gpp *self,
+                                         guint max_age,
+                                         guint *age,
+                                         GCancellable *cancellable,
+                                         GError **error);
+
+void     mm_modem_3gpp_start_background_scan        (MMModem3gpp *self,
+                                                     GCancellable *cancellable,
+                                                     GAsyncReadyCallback callback,
+                                                     gpointer user_data);
+gboolean mm_modem_3gpp_start_background_scan_finish (MMModem3gpp *self,
+                                                     GAsyncResult *res,
+                                                     GError **error);
+gboolean mm_modem_3gpp_start_background_scan_sync   (MMModem3gpp *self,
+                                                     GCancellable *cancellable,
+                                                     GError **error);
+
 G_END_DECLS
 
 #endif /* _MM_MODEM_3GPP_H_ */
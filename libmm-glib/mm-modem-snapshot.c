@@ -0,0 +1,779 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libmm -- Access modem status & information from glib applications
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include "mm-modem-snapshot.h"
+
+/**
+ * SECTION: mm-modem-snapshot
+ * @title: MMModemSnapshot
+ * @short_description: Lightweight snapshot of the key properties of a modem
+ *
+ * The #MMModemSnapshot is an object exposing the most relevant properties of
+ * a modem, without the cost of a full #MMManager object manager client
+ * (which creates and keeps a proxy per interface of each modem, bearer, SIM
+ * and SMS object).
+ *
+ * The snapshots of all available modems are loaded with a single
+ * GetManagedObjects() call with mm_modem_snapshot_list() or
+ * mm_modem_snapshot_list_sync(), and only the properties of the interfaces
+ * requested by the caller are kept. Strings which are usually shared among
+ * many modems (manufacturer, model, revision, plugin, drivers) are interned,
+ * so that the per-modem memory cost stays small.
+ *
+ * Clients which need to keep the snapshots up to date can subscribe to the
+ * <literal>org.freedesktop.DBus.Properties.PropertiesChanged</literal> signal
+ * of just the interfaces they're interested in, and feed the changes to
+ * mm_modem_snapshot_update().
+ */
+
+G_DEFINE_TYPE (MMModemSnapshot, mm_modem_snapshot, G_TYPE_OBJECT);
+
+struct _MMModemSnapshotPrivate {
+    gchar *path;
+
+    /* Interfaces found in the object (interned) */
+    GPtrArray *interfaces;
+
+    /* Modem interface; interned strings */
+    const gchar *manufacturer;
+    const gchar *model;
+    const gchar *revision;
+    const gchar *plugin;
+    const gchar **drivers;
+    /* Modem interface; owned strings */
+    gchar *device;
+    gchar *equipment_identifier;
+    MMModemState state;
+    guint signal_quality;
+    gboolean signal_quality_recent;
+    MMModemAccessTechnology access_technologies;
+
+    /* 3GPP interface */
+    MMModem3gppRegistrationState registration_state_3gpp;
+    gchar *operator_code;
+    gchar *operator_name;
+
+    /* CDMA interface */
+    MMModemCdmaRegistrationState registration_state_cdma1x;
+    MMModemCdmaRegistrationState registration_state_evdo;
+};
+
+/*****************************************************************************/
+
+static const gchar *default_interfaces[] = {
+    MM_DBUS_INTERFACE_MODEM,
+    MM_DBUS_INTERFACE_MODEM_MODEM3GPP,
+    MM_DBUS_INTERFACE_MODEM_MODEMCDMA,
+    NULL
+};
+
+static const gchar *
+intern_non_empty (const gchar *str)
+{
+    return ((str && str[0]) ? g_intern_string (str) : NULL);
+}
+
+static gchar *
+dup_non_empty (const gchar *str)
+{
+    return ((str && str[0]) ? g_strdup (str) : NULL);
+}
+
+static void
+update_modem_property (MMModemSnapshot *self,
+                       const gchar *key,
+                       GVariant *value)
+{
+    MMModemSnapshotPrivate *priv = self->priv;
+
+    if (g_str_equal (key, "Manufacturer"))
+        priv->manufacturer = intern_non_empty (g_variant_get_string (value, NULL));
+    else if (g_str_equal (key, "Model"))
+        priv->model = intern_non_empty (g_variant_get_string (value, NULL));
+    else if (g_str_equal (key, "Revision"))
+        priv->revision = intern_non_empty (g_variant_get_string (value, NULL));
+    else if (g_str_equal (key, "Plugin"))
+        priv->plugin = intern_non_empty (g_variant_get_string (value, NULL));
+    else if (g_str_equal (key, "Drivers")) {
+        GVariantIter iter;
+        const gchar *driver;
+        guint i = 0;
+
+        g_free (priv->drivers);
+        priv->drivers = g_new0 (const gchar *, g_variant_n_children (value) + 1);
+        g_variant_iter_init (&iter, value);
+        while (g_variant_iter_next (&iter, "&s", &driver))
+            priv->drivers[i++] = g_intern_string (driver);
+    } else if (g_str_equal (key, "Device")) {
+        g_free (priv->device);
+        priv->device = dup_non_empty (g_variant_get_string (value, NULL));
+    } else if (g_str_equal (key, "EquipmentIdentifier")) {
+        g_free (priv->equipment_identifier);
+        priv->equipment_identifier = dup_non_empty (g_variant_get_string (value, NULL));
+    } else if (g_str_equal (key, "State"))
+        priv->state = (MMModemState) g_variant_get_int32 (value);
+    else if (g_str_equal (key, "SignalQuality"))
+        g_variant_get (value, "(ub)", &priv->signal_quality, &priv->signal_quality_recent);
+    else if (g_str_equal (key, "AccessTechnologies"))
+        priv->access_technologies = (MMModemAccessTechnology) g_variant_get_uint32 (value);
+}
+
+static void
+update_3gpp_property (MMModemSnapshot *self,
+                      const gchar *key,
+                      GVariant *value)
+{
+    MMModemSnapshotPrivate *priv = self->priv;
+
+    if (g_str_equal (key, "RegistrationState"))
+        priv->registration_state_3gpp = (MMModem3gppRegistrationState) g_variant_get_uint32 (value);
+    else if (g_str_equal (key, "OperatorCode")) {
+        g_free (priv->operator_code);
+        priv->operator_code = dup_non_empty (g_variant_get_string (value, NULL));
+    } else if (g_str_equal (key, "OperatorName")) {
+        g_free (priv->operator_name);
+        priv->operator_name = dup_non_empty (g_variant_get_string (value, NULL));
+    }
+}
+
+static void
+update_cdma_property (MMModemSnapshot *self,
+                      const gchar *key,
+                      GVariant *value)
+{
+    MMModemSnapshotPrivate *priv = self->priv;
+
+    if (g_str_equal (key, "Cdma1xRegistrationState"))
+        priv->registration_state_cdma1x = (MMModemCdmaRegistrationState) g_variant_get_uint32 (value);
+    else if (g_str_equal (key, "EvdoRegistrationState"))
+        priv->registration_state_evdo = (MMModemCdmaRegistrationState) g_variant_get_uint32 (value);
+}
+
+/**
+ * mm_modem_snapshot_update:
+ * @self: A #MMModemSnapshot.
+ * @interface: The D-Bus interface the properties belong to.
+ * @changed_properties: A #GVariant of type a{sv} with the properties to update,
+ *  e.g. as received in a <literal>PropertiesChanged</literal> signal.
+ *
+ * Updates the snapshot with the given property values. Properties of
+ * interfaces not tracked by the snapshot are ignored.
+ *
+ * Returns: %TRUE if @interface is tracked by @self, %FALSE otherwise.
+ */
+gboolean
+mm_modem_snapshot_update (MMModemSnapshot *self,
+                          const gchar *interface,
+                          GVariant *changed_properties)
+{
+    void (* update_property) (MMModemSnapshot *, const gchar *, GVariant *);
+    GVariantIter iter;
+    const gchar *key;
+    GVariant *value;
+
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), FALSE);
+    g_return_val_if_fail (interface != NULL, FALSE);
+    g_return_val_if_fail (changed_properties != NULL, FALSE);
+
+    if (!mm_modem_snapshot_has_interface (self, interface))
+        return FALSE;
+
+    if (g_str_equal (interface, MM_DBUS_INTERFACE_MODEM))
+        update_property = update_modem_property;
+    else if (g_str_equal (interface, MM_DBUS_INTERFACE_MODEM_MODEM3GPP))
+        update_property = update_3gpp_property;
+    else if (g_str_equal (interface, MM_DBUS_INTERFACE_MODEM_MODEMCDMA))
+        update_property = update_cdma_property;
+    else
+        /* Tracked but no properties kept */
+        return TRUE;
+
+    g_variant_iter_init (&iter, changed_properties);
+    while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+        update_property (self, key, value);
+        g_variant_unref (value);
+    }
+
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+static gboolean
+interface_requested (const gchar * const *interfaces,
+                     const gchar *interface)
+{
+    guint i;
+
+    for (i = 0; interfaces[i]; i++) {
+        if (g_str_equal (interfaces[i], interface))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static MMModemSnapshot *
+snapshot_new_from_object (const gchar *path,
+                          GVariant *interfaces_and_properties,
+                          const gchar * const *interfaces)
+{
+    MMModemSnapshot *self;
+    GVariantIter iter;
+    const gchar *interface;
+    GVariant *properties;
+
+    self = g_object_new (MM_TYPE_MODEM_SNAPSHOT, NULL);
+    self->priv->path = g_strdup (path);
+
+    g_variant_iter_init (&iter, interfaces_and_properties);
+    while (g_variant_iter_next (&iter, "{&s@a{sv}}", &interface, &properties)) {
+        if (interface_requested (interfaces, interface)) {
+            g_ptr_array_add (self->priv->interfaces, (gpointer) g_intern_string (interface));
+            mm_modem_snapshot_update (self, interface, properties);
+        }
+        g_variant_unref (properties);
+    }
+
+    return self;
+}
+
+static GList *
+snapshot_list_from_managed_objects (GVariant *reply,
+                                    const gchar * const *interfaces)
+{
+    GVariant *objects;
+    GVariantIter iter;
+    const gchar *path;
+    GVariant *interfaces_and_properties;
+    GList *list = NULL;
+
+    if (!interfaces)
+        interfaces = default_interfaces;
+
+    objects = g_variant_get_child_value (reply, 0);
+    g_variant_iter_init (&iter, objects);
+    while (g_variant_iter_next (&iter, "{&o@a{sa{sv}}}", &path, &interfaces_and_properties)) {
+        /* Only modem objects are listed; bearers, SIMs and SMS objects aren't
+         * exported through the ObjectManager */
+        if (g_str_has_prefix (path, MM_DBUS_MODEM_PREFIX))
+            list = g_list_prepend (list,
+                                   snapshot_new_from_object (path,
+                                                             interfaces_and_properties,
+                                                             interfaces));
+        g_variant_unref (interfaces_and_properties);
+    }
+    g_variant_unref (objects);
+
+    return g_list_reverse (list);
+}
+
+/**
+ * mm_modem_snapshot_list_finish:
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_modem_snapshot_list().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with mm_modem_snapshot_list().
+ *
+ * Returns: (transfer full) (element-type MMModemSnapshot): a list of #MMModemSnapshot objects, or %NULL if either no modems found or @error is set. The returned value should be freed with g_list_free_full() using g_object_unref() as #GDestroyNotify function.
+ */
+GList *
+mm_modem_snapshot_list_finish (GAsyncResult *res,
+                               GError **error)
+{
+    GList *list;
+
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return NULL;
+
+    list = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
+
+    /* The list we got, including the objects within, is owned by the async result;
+     * so we'll make sure we return a new list */
+    g_list_foreach (list, (GFunc)g_object_ref, NULL);
+    return g_list_copy (list);
+}
+
+typedef struct {
+    GSimpleAsyncResult *result;
+    gchar **interfaces;
+} ListContext;
+
+static void
+list_context_complete_and_free (ListContext *ctx)
+{
+    g_simple_async_result_complete (ctx->result);
+    g_object_unref (ctx->result);
+    g_strfreev (ctx->interfaces);
+    g_slice_free (ListContext, ctx);
+}
+
+static void
+snapshot_list_free (GList *list)
+{
+    g_list_free_full (list, (GDestroyNotify) g_object_unref);
+}
+
+static void
+get_managed_objects_ready (GDBusConnection *connection,
+                           GAsyncResult *res,
+                           ListContext *ctx)
+{
+    GError *error = NULL;
+    GVariant *reply;
+
+    reply = g_dbus_connection_call_finish (connection, res, &error);
+    if (!reply)
+        g_simple_async_result_take_error (ctx->result, error);
+    else {
+        g_simple_async_result_set_op_res_gpointer (
+            ctx->result,
+            snapshot_list_from_managed_objects (reply, (const gchar * const *) ctx->interfaces),
+            (GDestroyNotify) snapshot_list_free);
+        g_variant_unref (reply);
+    }
+
+    list_context_complete_and_free (ctx);
+}
+
+/**
+ * mm_modem_snapshot_list:
+ * @connection: A #GDBusConnection.
+ * @interfaces: (allow-none): %NULL-terminated array of D-Bus interface names to load, or %NULL to load the Modem, Modem3gpp and ModemCdma interfaces.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously loads a snapshot of all modems known to the daemon, in a
+ * single D-Bus call.
+ *
+ * When the operation is finished, @callback will be invoked in the
+ * <link linkend="g-main-context-push-thread-default">thread-default main loop</link>
+ * of the thread you are calling this method from. You can then call
+ * mm_modem_snapshot_list_finish() to get the result of the operation.
+ *
+ * See mm_modem_snapshot_list_sync() for the synchronous, blocking version of this method.
+ */
+void
+mm_modem_snapshot_list (GDBusConnection *connection,
+                        const gchar * const *interfaces,
+                        GCancellable *cancellable,
+                        GAsyncReadyCallback callback,
+                        gpointer user_data)
+{
+    ListContext *ctx;
+
+    g_return_if_fail (G_IS_DBUS_CONNECTION (connection));
+
+    ctx = g_slice_new0 (ListContext);
+    ctx->result = g_simple_async_result_new (NULL,
+                                             callback,
+                                             user_data,
+                                             mm_modem_snapshot_list);
+    ctx->interfaces = (interfaces ? g_strdupv ((gchar **) interfaces) : NULL);
+
+    g_dbus_connection_call (connection,
+                            MM_DBUS_SERVICE,
+                            MM_DBUS_PATH,
+                            "org.freedesktop.DBus.ObjectManager",
+                            "GetManagedObjects",
+                            NULL,
+                            G_VARIANT_TYPE ("(a{oa{sa{sv}}})"),
+                            G_DBUS_CALL_FLAGS_NONE,
+                            -1,
+                            cancellable,
+                            (GAsyncReadyCallback) get_managed_objects_ready,
+                            ctx);
+}
+
+/**
+ * mm_modem_snapshot_list_sync:
+ * @connection: A #GDBusConnection.
+ * @interfaces: (allow-none): %NULL-terminated array of D-Bus interface names to load, or %NULL to load the Modem, Modem3gpp and ModemCdma interfaces.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously loads a snapshot of all modems known to the daemon, in a
+ * single D-Bus call.
+ *
+ * The calling thread is blocked until a reply is received.
+ *
+ * See mm_modem_snapshot_list() for the asynchronous version of this method.
+ *
+ * Returns: (transfer full) (element-type MMModemSnapshot): a list of #MMModemSnapshot objects, or %NULL if either no modems found or @error is set. The returned value should be freed with g_list_free_full() using g_object_unref() as #GDestroyNotify function.
+ */
+GList *
+mm_modem_snapshot_list_sync (GDBusConnection *connection,
+                             const gchar * const *interfaces,
+                             GCancellable *cancellable,
+                             GError **error)
+{
+    GVariant *reply;
+    GList *list;
+
+    g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), NULL);
+
+    reply = g_dbus_connection_call_sync (connection,
+                                         MM_DBUS_SERVICE,
+                                         MM_DBUS_PATH,
+                                         "org.freedesktop.DBus.ObjectManager",
+                                         "GetManagedObjects",
+                                         NULL,
+                                         G_VARIANT_TYPE ("(a{oa{sa{sv}}})"),
+                                         G_DBUS_CALL_FLAGS_NONE,
+                                         -1,
+                                         cancellable,
+                                         error);
+    if (!reply)
+        return NULL;
+
+    list = snapshot_list_from_managed_objects (reply, interfaces);
+    g_variant_unref (reply);
+    return list;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_modem_snapshot_get_path:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the DBus path of the modem.
+ *
+ * Returns: (transfer none): The DBus path of the modem. Do not free the returned value, it is owned by @self.
+ */
+const gchar *
+mm_modem_snapshot_get_path (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), NULL);
+
+    return self->priv->path;
+}
+
+/**
+ * mm_modem_snapshot_has_interface:
+ * @self: A #MMModemSnapshot.
+ * @interface: A D-Bus interface name.
+ *
+ * Checks whether the modem implements the given interface, and it was
+ * requested when loading the snapshot.
+ *
+ * Returns: %TRUE if @interface is tracked by @self, %FALSE otherwise.
+ */
+gboolean
+mm_modem_snapshot_has_interface (MMModemSnapshot *self,
+                                 const gchar *interface)
+{
+    const gchar *interned;
+    guint i;
+
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), FALSE);
+
+    /* Interned strings can be compared by pointer */
+    interned = g_intern_string (interface);
+    for (i = 0; i < self->priv->interfaces->len; i++) {
+        if (g_ptr_array_index (self->priv->interfaces, i) == interned)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/**
+ * mm_modem_snapshot_get_manufacturer:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the equipment manufacturer.
+ *
+ * Returns: (transfer none): The manufacturer, or %NULL if none available. Do not free the returned value, it is owned by @self.
+ */
+const gchar *
+mm_modem_snapshot_get_manufacturer (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), NULL);
+
+    return self->priv->manufacturer;
+}
+
+/**
+ * mm_modem_snapshot_get_model:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the equipment model.
+ *
+ * Returns: (transfer none): The model, or %NULL if none available. Do not free the returned value, it is owned by @self.
+ */
+const gchar *
+mm_modem_snapshot_get_model (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), NULL);
+
+    return self->priv->model;
+}
+
+/**
+ * mm_modem_snapshot_get_revision:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the equipment revision.
+ *
+ * Returns: (transfer none): The revision, or %NULL if none available. Do not free the returned value, it is owned by @self.
+ */
+const gchar *
+mm_modem_snapshot_get_revision (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), NULL);
+
+    return self->priv->revision;
+}
+
+/**
+ * mm_modem_snapshot_get_plugin:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the name of the plugin handling the modem.
+ *
+ * Returns: (transfer none): The plugin name, or %NULL if none available. Do not free the returned value, it is owned by @self.
+ */
+const gchar *
+mm_modem_snapshot_get_plugin (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), NULL);
+
+    return self->priv->plugin;
+}
+
+/**
+ * mm_modem_snapshot_get_drivers:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the list of drivers handling the modem ports.
+ *
+ * Returns: (transfer none): A %NULL-terminated array of driver names, or %NULL if none available. Do not free the returned value, it is owned by @self.
+ */
+const gchar * const *
+mm_modem_snapshot_get_drivers (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), NULL);
+
+    return (const gchar * const *) self->priv->drivers;
+}
+
+/**
+ * mm_modem_snapshot_get_device:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the physical modem device reference.
+ *
+ * Returns: (transfer none): The device, or %NULL if none available. Do not free the returned value, it is owned by @self.
+ */
+const gchar *
+mm_modem_snapshot_get_device (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), NULL);
+
+    return self->priv->device;
+}
+
+/**
+ * mm_modem_snapshot_get_equipment_identifier:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the equipment identifier (IMEI, ESN or MEID).
+ *
+ * Returns: (transfer none): The equipment identifier, or %NULL if none available. Do not free the returned value, it is owned by @self.
+ */
+const gchar *
+mm_modem_snapshot_get_equipment_identifier (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), NULL);
+
+    return self->priv->equipment_identifier;
+}
+
+/**
+ * mm_modem_snapshot_get_state:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the state of the modem.
+ *
+ * Returns: A #MMModemState value.
+ */
+MMModemState
+mm_modem_snapshot_get_state (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), MM_MODEM_STATE_UNKNOWN);
+
+    return self->priv->state;
+}
+
+/**
+ * mm_modem_snapshot_get_signal_quality:
+ * @self: A #MMModemSnapshot.
+ * @recent: (out) (allow-none): Return location for the flag specifying if the signal quality value was recent or not.
+ *
+ * Gets the signal quality value in percent (0 - 100).
+ *
+ * Returns: The signal quality.
+ */
+guint
+mm_modem_snapshot_get_signal_quality (MMModemSnapshot *self,
+                                      gboolean *recent)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), 0);
+
+    if (recent)
+        *recent = self->priv->signal_quality_recent;
+    return self->priv->signal_quality;
+}
+
+/**
+ * mm_modem_snapshot_get_access_technologies:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the current network access technologies used by the modem.
+ *
+ * Returns: A bitmask of #MMModemAccessTechnology values.
+ */
+MMModemAccessTechnology
+mm_modem_snapshot_get_access_technologies (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN);
+
+    return self->priv->access_technologies;
+}
+
+/**
+ * mm_modem_snapshot_get_3gpp_registration_state:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the 3GPP registration state of the modem.
+ *
+ * Returns: A #MMModem3gppRegistrationState value.
+ */
+MMModem3gppRegistrationState
+mm_modem_snapshot_get_3gpp_registration_state (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), MM_MODEM_3GPP_REGISTRATION_STATE_UNKNOWN);
+
+    return self->priv->registration_state_3gpp;
+}
+
+/**
+ * mm_modem_snapshot_get_3gpp_operator_code:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the code of the operator to which the modem is connected.
+ *
+ * Returns: (transfer none): The operator code, or %NULL if none available. Do not free the returned value, it is owned by @self.
+ */
+const gchar *
+mm_modem_snapshot_get_3gpp_operator_code (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), NULL);
+
+    return self->priv->operator_code;
+}
+
+/**
+ * mm_modem_snapshot_get_3gpp_operator_name:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the name of the operator to which the modem is connected.
+ *
+ * Returns: (transfer none): The operator name, or %NULL if none available. Do not free the returned value, it is owned by @self.
+ */
+const gchar *
+mm_modem_snapshot_get_3gpp_operator_name (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), NULL);
+
+    return self->priv->operator_name;
+}
+
+/**
+ * mm_modem_snapshot_get_cdma1x_registration_state:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the CDMA1x registration state of the modem.
+ *
+ * Returns: A #MMModemCdmaRegistrationState value.
+ */
+MMModemCdmaRegistrationState
+mm_modem_snapshot_get_cdma1x_registration_state (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), MM_MODEM_CDMA_REGISTRATION_STATE_UNKNOWN);
+
+    return self->priv->registration_state_cdma1x;
+}
+
+/**
+ * mm_modem_snapshot_get_evdo_registration_state:
+ * @self: A #MMModemSnapshot.
+ *
+ * Gets the EV-DO registration state of the modem.
+ *
+ * Returns: A #MMModemCdmaRegistrationState value.
+ */
+MMModemCdmaRegistrationState
+mm_modem_snapshot_get_evdo_registration_state (MMModemSnapshot *self)
+{
+    g_return_val_if_fail (MM_IS_MODEM_SNAPSHOT (self), MM_MODEM_CDMA_REGISTRATION_STATE_UNKNOWN);
+
+    return self->priv->registration_state_evdo;
+}
+
+/*****************************************************************************/
+
+static void
+mm_modem_snapshot_init (MMModemSnapshot *self)
+{
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE ((self),
+                                              MM_TYPE_MODEM_SNAPSHOT,
+                                              MMModemSnapshotPrivate);
+    self->priv->interfaces = g_ptr_array_sized_new (3);
+    self->priv->state = MM_MODEM_STATE_UNKNOWN;
+}
+
+static void
+finalize (GObject *object)
+{
+    MMModemSnapshot *self = MM_MODEM_SNAPSHOT (object);
+
+    g_free (self->priv->path);
+    g_ptr_array_unref (self->priv->interfaces);
+    g_free (self->priv->drivers);
+    g_free (self->priv->device);
+    g_free (self->priv->equipment_identifier);
+    g_free (self->priv->operator_code);
+    g_free (self->priv->operator_name);
+
+    G_OBJECT_CLASS (mm_modem_snapshot_parent_class)->finalize (object);
+}
+
+static void
+mm_modem_snapshot_class_init (MMModemSnapshotClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MMModemSnapshotPrivate));
+
+    object_class->finalize = finalize;
+}
@@ -0,0 +1,106 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libmm -- Access modem status & information from glib applications
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#ifndef _MM_MODEM_SNAPSHOT_H_
+#define _MM_MODEM_SNAPSHOT_H_
+
+#if !defined (__LIBMM_GLIB_H_INSIDE__) && !defined (LIBMM_GLIB_COMPILATION)
+#error "Only <libmm-glib.h> can be included directly."
+#endif
+
+#include <ModemManager.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define MM_TYPE_MODEM_SNAPSHOT            (mm_modem_snapshot_get_type ())
+#define MM_MODEM_SNAPSHOT(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), MM_TYPE_MODEM_SNAPSHOT, MMModemSnapshot))
+#define MM_MODEM_SNAPSHOT_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  MM_TYPE_MODEM_SNAPSHOT, MMModemSnapshotClass))
+#define MM_IS_MODEM_SNAPSHOT(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), MM_TYPE_MODEM_SNAPSHOT))
+#define MM_IS_MODEM_SNAPSHOT_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  MM_TYPE_MODEM_SNAPSHOT))
+#define MM_MODEM_SNAPSHOT_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  MM_TYPE_MODEM_SNAPSHOT, MMModemSnapshotClass))
+
+typedef struct _MMModemSnapshot MMModemSnapshot;
+typedef struct _MMModemSnapshotClass MMModemSnapshotClass;
+typedef struct _MMModemSnapshotPrivate MMModemSnapshotPrivate;
+
+/**
+ * MMModemSnapshot:
+ *
+ * The #MMModemSnapshot structure contains private data and should only be accessed
+ * using the provided API.
+ */
+struct _MMModemSnapshot {
+    /*< private >*/
+    GObject parent;
+    MMModemSnapshotPrivate *priv;
+};
+
+struct _MMModemSnapshotClass {
+    /*< private >*/
+    GObjectClass parent;
+};
+
+GType mm_modem_snapshot_get_type (void);
+
+void   mm_modem_snapshot_list        (GDBusConnection      *connection,
+                                      const gchar * const  *interfaces,
+                                      GCancellable         *cancellable,
+                                      GAsyncReadyCallback   callback,
+                                      gpointer              user_data);
+GList *mm_modem_snapshot_list_finish (GAsyncResult         *res,
+                                      GError              **error);
+GList *mm_modem_snapshot_list_sync   (GDBusConnection      *connection,
+                                      const gchar * const  *interfaces,
+                                      GCancellable         *cancellable,
+                                      GError              **error);
+
+gboolean mm_modem_snapshot_update (MMModemSnapshot *self,
+                                   const gchar     *interface,
+                                   GVariant        *changed_properties);
+
+const gchar         *mm_modem_snapshot_get_path                 (MMModemSnapshot *self);
+gboolean             mm_modem_snapshot_has_interface            (MMModemSnapshot *self,
+                                                                 const gchar     *interface);
+
+const gchar         *mm_modem_snapshot_get_manufacturer         (MMModemSnapshot *self);
+const gchar         *mm_modem_snapshot_get_model                (MMModemSnapshot *self);
+const gchar         *mm_modem_snapshot_get_revision             (MMModemSnapshot *self);
+const gchar         *mm_modem_snapshot_get_plugin               (MMModemSnapshot *self);
+const gchar * const *mm_modem_snapshot_get_drivers              (MMModemSnapshot *self);
+const gchar         *mm_modem_snapshot_get_device               (MMModemSnapshot *self);
+const gchar         *mm_modem_snapshot_get_equipment_identifier (MMModemSnapshot *self);
+MMModemState         mm_modem_snapshot_get_state                (MMModemSnapshot *self);
+guint                mm_modem_snapshot_get_signal_quality       (MMModemSnapshot *self,
+                                                                 gboolean        *recent);
+MMModemAccessTechnology mm_modem_snapshot_get_access_technologies (MMModemSnapshot *self);
+
+MMModem3gppRegistrationState mm_modem_snapshot_get_3gpp_registration_state (MMModemSnapshot *self);
+const gchar         *mm_modem_snapshot_get_3gpp_operator_code   (MMModemSnapshot *self);
+const gchar         *mm_modem_snapshot_get_3gpp_operator_name   (MMModemSnapshot *self);
+
+MMModemCdmaRegistrationState mm_modem_snapshot_get_cdma1x_registration_state (MMModemSnapshot *self);
+MMModemCdmaRegistrationState mm_modem_snapshot_get_evdo_registration_state   (MMModemSnapshot *self);
+
+G_END_DECLS
+
+#endif /* _MM_MODEM_SNAPSHOT_H_ */
@@ -0,0 +1,252 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <libmm-glib.h>
+
+/* The daemon side is a peer-to-peer D-Bus server exporting just an
+ * ObjectManager with a fixed set of objects */
+
+static const gchar introspection_xml[] =
+    "<node>"
+    "  <interface name='org.freedesktop.DBus.ObjectManager'>"
+    "    <method name='GetManagedObjects'>"
+    "      <arg type='a{oa{sa{sv}}}' name='objects' direction='out'/>"
+    "    </method>"
+    "  </interface>"
+    "</node>";
+
+static GVariant *
+build_managed_objects (void)
+{
+    GVariantBuilder objects;
+    GVariantBuilder properties;
+    const gchar *drivers[] = { "option1", "cdc_wdm", NULL };
+
+    g_variant_builder_init (&objects, G_VARIANT_TYPE ("a{oa{sa{sv}}}"));
+
+    /* A 3GPP modem */
+    g_variant_builder_open (&objects, G_VARIANT_TYPE ("{oa{sa{sv}}}"));
+    g_variant_builder_add (&objects, "o", MM_DBUS_MODEM_PREFIX "/0");
+    g_variant_builder_open (&objects, G_VARIANT_TYPE ("a{sa{sv}}"));
+    g_variant_builder_init (&properties, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&properties, "{sv}", "Manufacturer", g_variant_new_string ("Acme"));
+    g_variant_builder_add (&properties, "{sv}", "Model", g_variant_new_string ("Rocket"));
+    g_variant_builder_add (&properties, "{sv}", "Drivers", g_variant_new_strv (drivers, -1));
+    g_variant_builder_add (&properties, "{sv}", "State", g_variant_new_int32 (MM_MODEM_STATE_REGISTERED));
+    g_variant_builder_add (&properties, "{sv}", "SignalQuality", g_variant_new ("(ub)", 75, TRUE));
+    g_variant_builder_add (&objects, "{sa{sv}}", MM_DBUS_INTERFACE_MODEM, &properties);
+    g_variant_builder_init (&properties, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&properties, "{sv}", "OperatorCode", g_variant_new_string ("310260"));
+    g_variant_builder_add (&objects, "{sa{sv}}", MM_DBUS_INTERFACE_MODEM_MODEM3GPP, &properties);
+    g_variant_builder_init (&properties, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&objects, "{sa{sv}}", MM_DBUS_INTERFACE_MODEM_SIMPLE, &properties);
+    g_variant_builder_close (&objects);
+    g_variant_builder_close (&objects);
+
+    /* Not a modem, must be skipped */
+    g_variant_builder_open (&objects, G_VARIANT_TYPE ("{oa{sa{sv}}}"));
+    g_variant_builder_add (&objects, "o", MM_DBUS_PATH "/SIM/0");
+    g_variant_builder_open (&objects, G_VARIANT_TYPE ("a{sa{sv}}"));
+    g_variant_builder_close (&objects);
+    g_variant_builder_close (&objects);
+
+    /* A second modem, with the same manufacturer */
+    g_variant_builder_open (&objects, G_VARIANT_TYPE ("{oa{sa{sv}}}"));
+    g_variant_builder_add (&objects, "o", MM_DBUS_MODEM_PREFIX "/1");
+    g_variant_builder_open (&objects, G_VARIANT_TYPE ("a{sa{sv}}"));
+    g_variant_builder_init (&properties, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&properties, "{sv}", "Manufacturer", g_variant_new_string ("Acme"));
+    g_variant_builder_add (&objects, "{sa{sv}}", MM_DBUS_INTERFACE_MODEM, &properties);
+    g_variant_builder_close (&objects);
+    g_variant_builder_close (&objects);
+
+    return g_variant_new ("(a{oa{sa{sv}}})", &objects);
+}
+
+static void
+handle_method_call (GDBusConnection *connection,
+                    const gchar *sender,
+                    const gchar *object_path,
+                    const gchar *interface_name,
+                    const gchar *method_name,
+                    GVariant *parameters,
+                    GDBusMethodInvocation *invocation,
+                    gpointer user_data)
+{
+    g_assert_cmpstr (method_name, ==, "GetManagedObjects");
+    g_dbus_method_invocation_return_value (invocation, build_managed_objects ());
+}
+
+static const GDBusInterfaceVTable interface_vtable = {
+    handle_method_call,
+    NULL,
+    NULL
+};
+
+static gboolean
+new_connection_cb (GDBusServer *server,
+                   GDBusConnection *connection,
+                   GDBusNodeInfo *introspection)
+{
+    GError *error = NULL;
+    guint id;
+
+    id = g_dbus_connection_register_object (connection,
+                                            MM_DBUS_PATH,
+                                            introspection->interfaces[0],
+                                            &interface_vtable,
+                                            NULL,
+                                            NULL,
+                                            &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (id, >, 0);
+
+    /* Keep the server side of the connection around */
+    g_object_ref (connection);
+    return TRUE;
+}
+
+typedef struct {
+    GMainLoop *loop;
+    GDBusConnection *connection;
+    GList *list;
+} TestContext;
+
+static void
+connection_ready (GObject *source,
+                  GAsyncResult *res,
+                  TestContext *ctx)
+{
+    GError *error = NULL;
+
+    ctx->connection = g_dbus_connection_new_for_address_finish (res, &error);
+    g_assert_no_error (error);
+    g_main_loop_quit (ctx->loop);
+}
+
+static void
+list_ready (GObject *source,
+            GAsyncResult *res,
+            TestContext *ctx)
+{
+    GError *error = NULL;
+
+    ctx->list = mm_modem_snapshot_list_finish (res, &error);
+    g_assert_no_error (error);
+    g_main_loop_quit (ctx->loop);
+}
+
+static void
+test_list (void)
+{
+    TestContext ctx = { NULL, NULL, NULL };
+    GDBusNodeInfo *introspection;
+    GDBusServer *server;
+    GError *error = NULL;
+    gchar *guid;
+    MMModemSnapshot *snapshot;
+    const gchar * const *drivers;
+    gboolean recent = FALSE;
+
+    introspection = g_dbus_node_info_new_for_xml (introspection_xml, &error);
+    g_assert_no_error (error);
+
+    guid = g_dbus_generate_guid ();
+    server = g_dbus_server_new_sync ("unix:tmpdir=/tmp",
+                                     G_DBUS_SERVER_FLAGS_NONE,
+                                     guid,
+                                     NULL,
+                                     NULL,
+                                     &error);
+    g_assert_no_error (error);
+    g_signal_connect (server,
+                      "new-connection",
+                      G_CALLBACK (new_connection_cb),
+                      introspection);
+    g_dbus_server_start (server);
+
+    ctx.loop = g_main_loop_new (NULL, FALSE);
+
+    /* Both ends live in this thread, so only the async API can be used */
+    g_dbus_connection_new_for_address (g_dbus_server_get_client_address (server),
+                                       G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                                       NULL,
+                                       NULL,
+                                       (GAsyncReadyCallback) connection_ready,
+                                       &ctx);
+    g_main_loop_run (ctx.loop);
+    g_assert (ctx.connection != NULL);
+
+    mm_modem_snapshot_list (ctx.connection,
+                            NULL,
+                            NULL,
+                            (GAsyncReadyCallback) list_ready,
+                            &ctx);
+    g_main_loop_run (ctx.loop);
+
+    /* The async result is gone by now; the list must still be ours */
+    g_assert_cmpuint (g_list_length (ctx.list), ==, 2);
+
+    snapshot = MM_MODEM_SNAPSHOT (ctx.list->data);
+    g_assert_cmpuint (G_OBJECT (snapshot)->ref_count, ==, 1);
+    g_assert_cmpstr (mm_modem_snapshot_get_path (snapshot), ==, MM_DBUS_MODEM_PREFIX "/0");
+    g_assert (mm_modem_snapshot_has_interface (snapshot, MM_DBUS_INTERFACE_MODEM));
+    g_assert (mm_modem_snapshot_has_interface (snapshot, MM_DBUS_INTERFACE_MODEM_MODEM3GPP));
+    g_assert (!mm_modem_snapshot_has_interface (snapshot, MM_DBUS_INTERFACE_MODEM_SIMPLE));
+    g_assert_cmpstr (mm_modem_snapshot_get_manufacturer (snapshot), ==, "Acme");
+    g_assert_cmpstr (mm_modem_snapshot_get_model (snapshot), ==, "Rocket");
+    g_assert (mm_modem_snapshot_get_revision (snapshot) == NULL);
+    drivers = mm_modem_snapshot_get_drivers (snapshot);
+    g_assert (drivers != NULL);
+    g_assert_cmpstr (drivers[0], ==, "option1");
+    g_assert_cmpstr (drivers[1], ==, "cdc_wdm");
+    g_assert (drivers[2] == NULL);
+    g_assert_cmpint (mm_modem_snapshot_get_state (snapshot), ==, MM_MODEM_STATE_REGISTERED);
+    g_assert_cmpuint (mm_modem_snapshot_get_signal_quality (snapshot, &recent), ==, 75);
+    g_assert (recent);
+    g_assert_cmpstr (mm_modem_snapshot_get_3gpp_operator_code (snapshot), ==, "310260");
+
+    snapshot = MM_MODEM_SNAPSHOT (ctx.list->next->data);
+    g_assert_cmpuint (G_OBJECT (snapshot)->ref_count, ==, 1);
+    g_assert_cmpstr (mm_modem_snapshot_get_path (snapshot), ==, MM_DBUS_MODEM_PREFIX "/1");
+    g_assert (!mm_modem_snapshot_has_interface (snapshot, MM_DBUS_INTERFACE_MODEM_MODEM3GPP));
+    /* Interned */
+    g_assert (mm_modem_snapshot_get_manufacturer (snapshot) ==
+              mm_modem_snapshot_get_manufacturer (MM_MODEM_SNAPSHOT (ctx.list->data)));
+
+    g_list_free_full (ctx.list, (GDestroyNotify) g_object_unref);
+
+    g_object_unref (ctx.connection);
+    g_dbus_server_stop (server);
+    g_object_unref (server);
+    g_main_loop_unref (ctx.loop);
+    g_dbus_node_info_unref (introspection);
+    g_free (guid);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/ModemSnapshot/list", test_list);
+
+    return g_test_run ();
+}
@@ -0,0 +1,658 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * Copyright (C) 2012 Google, Inc.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <limits.h>
+#include <poll.h>
+#include <time.h>
+
+#include "channel.h"
+#include "errors.h"
+#include "utils.h"
+#include "dm-commands.h"
+
+
+#define CHANNEL_READ_BUF_SIZE 16384
+#define CHANNEL_MATCH_MAX     4
+
+typedef struct QcdmChannelRequest QcdmChannelRequest;
+struct QcdmChannelRequest {
+    QcdmChannelRequest *prev;
+    QcdmChannelRequest *next;
+    int id;
+    char *command;        /* until moved to the write buffer */
+    size_t command_len;
+    char match[CHANNEL_MATCH_MAX];
+    size_t match_len;
+    u_int32_t timeout;
+    u_int64_t deadline;   /* 0 while still queued */
+    hdlcbool cancelled;   /* sent, so it still has to eat its response */
+    QcdmChannelResponseFn callback;
+    void *user_data;
+};
+
+struct QcdmChannel {
+    int fd;
+    hdlcbool failed;
+
+    QcdmChannelDecapsulateFn decapsulate;
+    void *decapsulate_data;
+
+    QcdmChannelUnsolicitedFn unsolicited;
+    void *unsolicited_data;
+
+    /* Outstanding requests in submission order */
+    QcdmChannelRequest *head;
+    QcdmChannelRequest *tail;
+    size_t pending;
+    size_t in_flight;
+    unsigned int max_in_flight;
+    int next_id;
+
+    /* Commands being written, back to back */
+    char *wbuf;
+    size_t wbuf_len;
+    size_t wbuf_alloc;
+    size_t wbuf_written;
+
+    char rbuf[CHANNEL_READ_BUF_SIZE];
+    size_t rbuf_len;
+    char frame[CHANNEL_READ_BUF_SIZE];
+};
+
+static u_int64_t
+now_msecs (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (u_int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static hdlcbool
+dm_decapsulate (const char *inbuf,
+                size_t inbuf_len,
+                char *outbuf,
+                size_t outbuf_len,
+                size_t *out_decap_len,
+                size_t *out_used,
+                hdlcbool *out_need_more,
+                void *user_data)
+{
+    return dm_decapsulate_buffer (inbuf, inbuf_len, outbuf, outbuf_len,
+                                  out_decap_len, out_used, out_need_more);
+}
+
+QcdmChannel *
+qcdm_channel_new_full (int fd,
+                       QcdmChannelDecapsulateFn decapsulate,
+                       void *decapsulate_data,
+                       int *out_error)
+{
+    QcdmChannel *channel;
+    int flags;
+
+    qcdm_return_val_if_fail (fd >= 0, NULL);
+    qcdm_return_val_if_fail (decapsulate != NULL, NULL);
+
+    errno = 0;
+    flags = fcntl (fd, F_GETFL);
+    if (flags < 0 || fcntl (fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        qcdm_err (0, "failed to make port non-blocking: %d", errno);
+        if (out_error)
+            *out_error = -QCDM_ERROR_SERIAL_CONFIG_FAILED;
+        return NULL;
+    }
+
+    channel = calloc (1, sizeof (QcdmChannel));
+    if (!channel) {
+        if (out_error)
+            *out_error = -QCDM_ERROR_PORT_IO_FAILED;
+        return NULL;
+    }
+    channel->fd = fd;
+    channel->decapsulate = decapsulate;
+    channel->decapsulate_data = decapsulate_data;
+    channel->next_id = 1;
+    return channel;
+}
+
+QcdmChannel *
+qcdm_channel_new (int fd, int *out_error)
+{
+    return qcdm_channel_new_full (fd, dm_decapsulate, NULL, out_error);
+}
+
+int
+qcdm_channel_get_fd (QcdmChannel *channel)
+{
+    qcdm_return_val_if_fail (channel != NULL, -1);
+
+    return channel->fd;
+}
+
+size_t
+qcdm_channel_get_pending (QcdmChannel *channel)
+{
+    qcdm_return_val_if_fail (channel != NULL, 0);
+
+    return channel->pending;
+}
+
+void
+qcdm_channel_set_max_in_flight (QcdmChannel *channel, unsigned int max)
+{
+    qcdm_return_if_fail (channel != NULL);
+
+    channel->max_in_flight = max;
+}
+
+void
+qcdm_channel_set_unsolicited_handler (QcdmChannel *channel,
+                                      QcdmChannelUnsolicitedFn callback,
+                                      void *user_data)
+{
+    qcdm_return_if_fail (channel != NULL);
+
+    channel->unsolicited = callback;
+    channel->unsolicited_data = user_data;
+}
+
+/* Unlinks the request and runs its callback; the list may be modified by the
+ * callback, so callers must not hold on to other requests across this.
+ */
+static void
+request_complete (QcdmChannel *channel,
+                  QcdmChannelRequest *req,
+                  int error,
+                  const char *response,
+                  size_t len)
+{
+    if (req->prev)
+        req->prev->next = req->next;
+    else
+        channel->head = req->next;
+    if (req->next)
+        req->next->prev = req->prev;
+    else
+        channel->tail = req->prev;
+    if (!req->cancelled)
+        channel->pending--;
+    if (req->deadline)
+        channel->in_flight--;
+
+    if (req->callback && !req->cancelled)
+        req->callback (channel, error, response, len, req->user_data);
+    free (req->command);
+    free (req);
+}
+
+static void
+fail_all (QcdmChannel *channel, int error)
+{
+    while (channel->head)
+        request_complete (channel, channel->head, error, NULL, 0);
+}
+
+/* Moves queued commands into the write buffer, as far as max_in_flight allows */
+static void
+start_requests (QcdmChannel *channel)
+{
+    QcdmChannelRequest *req;
+    u_int64_t now = 0;
+
+    for (req = channel->head; req; req = req->next) {
+        if (req->deadline)
+            continue;
+        if (channel->max_in_flight && channel->in_flight >= channel->max_in_flight)
+            break;
+
+        if (channel->wbuf_len + req->command_len > channel->wbuf_alloc) {
+            size_t alloc = channel->wbuf_alloc ? channel->wbuf_alloc : 512;
+            char *wbuf;
+
+            /* Compact before growing */
+            if (channel->wbuf_written) {
+                memmove (channel->wbuf,
+                         channel->wbuf + channel->wbuf_written,
+                         channel->wbuf_len - channel->wbuf_written);
+                channel->wbuf_len -= channel->wbuf_written;
+                channel->wbuf_written = 0;
+            }
+            while (alloc < channel->wbuf_len + req->command_len)
+                alloc *= 2;
+            if (alloc > channel->wbuf_alloc) {
+                wbuf = realloc (channel->wbuf, alloc);
+                if (!wbuf)
+                    break;
+                channel->wbuf = wbuf;
+                channel->wbuf_alloc = alloc;
+            }
+        }
+
+        memcpy (channel->wbuf + channel->wbuf_len, req->command, req->command_len);
+        channel->wbuf_len += req->command_len;
+        free (req->command);
+        req->command = NULL;
+
+        if (!now)
+            now = now_msecs ();
+        /* A deadline of 0 means "queued", so requests without a timeout get
+         * one far in the future instead */
+        req->deadline = req->timeout ? now + req->timeout : (u_int64_t) -1;
+        channel->in_flight++;
+    }
+}
+
+static hdlcbool
+flush_writes (QcdmChannel *channel)
+{
+    while (channel->wbuf_written < channel->wbuf_len) {
+        ssize_t written;
+
+        errno = 0;
+        written = write (channel->fd,
+                         channel->wbuf + channel->wbuf_written,
+                         channel->wbuf_len - channel->wbuf_written);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return TRUE;
+            qcdm_err (0, "failed to write to port: %d", errno);
+            return FALSE;
+        }
+        channel->wbuf_written += written;
+    }
+
+    channel->wbuf_written = channel->wbuf_len = 0;
+    return TRUE;
+}
+
+static void
+handle_frame (QcdmChannel *channel, const char *frame, size_t len)
+{
+    QcdmChannelRequest *req;
+    hdlcbool rejected = FALSE;
+
+    if (len == 0)
+        return;
+
+    /* Rejections echo the offending command after their own code */
+    if (channel->decapsulate == dm_decapsulate) {
+        switch ((u_int8_t) frame[0]) {
+        case DIAG_CMD_BAD_CMD:
+        case DIAG_CMD_BAD_PARM:
+        case DIAG_CMD_BAD_LEN:
+        case DIAG_CMD_BAD_DEV:
+        case DIAG_CMD_BAD_MODE:
+        case DIAG_CMD_BAD_SPC_MODE:
+            rejected = TRUE;
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (req = channel->head; req; req = req->next) {
+        if (!req->deadline)
+            break;  /* not sent yet; neither are the ones after it */
+
+        if (rejected) {
+            size_t n = req->match_len < len - 1 ? req->match_len : len - 1;
+
+            /* Short echo: blame the oldest request */
+            if (n == 0 || !memcmp (frame + 1, req->match, n))
+                break;
+        } else if (len >= req->match_len && !memcmp (frame, req->match, req->match_len))
+            break;
+    }
+
+    if (req && req->deadline) {
+        request_complete (channel, req, QCDM_SUCCESS, frame, len);
+        start_requests (channel);
+    } else if (channel->unsolicited)
+        channel->unsolicited (channel, frame, len, channel->unsolicited_data);
+}
+
+static hdlcbool
+read_frames (QcdmChannel *channel)
+{
+    for (;;) {
+        ssize_t bytes_read;
+        size_t pos = 0;
+
+        if (channel->rbuf_len == sizeof (channel->rbuf)) {
+            /* No frame end in a full buffer; it's garbage */
+            qcdm_warn (0, "dropping %zu bytes of unframed data", channel->rbuf_len);
+            channel->rbuf_len = 0;
+        }
+
+        errno = 0;
+        bytes_read = read (channel->fd,
+                           channel->rbuf + channel->rbuf_len,
+                           sizeof (channel->rbuf) - channel->rbuf_len);
+        if (bytes_read < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return TRUE;
+            qcdm_err (0, "failed to read from port: %d", errno);
+            return FALSE;
+        }
+        if (bytes_read == 0) {
+            qcdm_err (0, "port closed");
+            return FALSE;
+        }
+        channel->rbuf_len += bytes_read;
+
+        while (pos < channel->rbuf_len) {
+            size_t frame_len = 0, used = 0;
+            hdlcbool more = FALSE, success;
+
+            success = channel->decapsulate (channel->rbuf + pos,
+                                            channel->rbuf_len - pos,
+                                            channel->frame,
+                                            sizeof (channel->frame),
+                                            &frame_len,
+                                            &used,
+                                            &more,
+                                            channel->decapsulate_data);
+            if (success && more)
+                break;
+            pos += used;
+            if (success)
+                handle_frame (channel, channel->frame, frame_len);
+            else if (!used)
+                break;
+        }
+
+        if (pos) {
+            memmove (channel->rbuf, channel->rbuf + pos, channel->rbuf_len - pos);
+            channel->rbuf_len -= pos;
+        }
+    }
+}
+
+static void
+expire_requests (QcdmChannel *channel)
+{
+    u_int64_t now = now_msecs ();
+    QcdmChannelRequest *req;
+    hdlcbool expired;
+
+    do {
+        expired = FALSE;
+        for (req = channel->head; req && req->deadline; req = req->next) {
+            if (req->deadline <= now) {
+                request_complete (channel, req, -QCDM_ERROR_TIMEOUT, NULL, 0);
+                expired = TRUE;
+                break;
+            }
+        }
+    } while (expired);
+
+    start_requests (channel);
+}
+
+short
+qcdm_channel_get_events (QcdmChannel *channel)
+{
+    qcdm_return_val_if_fail (channel != NULL, 0);
+
+    if (channel->failed)
+        return 0;
+    return POLLIN | (channel->wbuf_len > channel->wbuf_written ? POLLOUT : 0);
+}
+
+int
+qcdm_channel_get_timeout (QcdmChannel *channel)
+{
+    QcdmChannelRequest *req;
+    u_int64_t next = (u_int64_t) -1, now;
+
+    qcdm_return_val_if_fail (channel != NULL, -1);
+
+    for (req = channel->head; req && req->deadline; req = req->next) {
+        if (req->deadline < next)
+            next = req->deadline;
+    }
+    if (next == (u_int64_t) -1)
+        return -1;
+
+    now = now_msecs ();
+    if (next <= now)
+        return 0;
+    return next - now > INT_MAX ? INT_MAX : (int) (next - now);
+}
+
+static void
+channel_fail (QcdmChannel *channel, int error)
+{
+    channel->failed = TRUE;
+    channel->wbuf_len = channel->wbuf_written = 0;
+    fail_all (channel, error);
+}
+
+int
+qcdm_channel_dispatch (QcdmChannel *channel, short revents)
+{
+    qcdm_return_val_if_fail (channel != NULL, -QCDM_ERROR_INVALID_ARGUMENTS);
+
+    if (channel->failed)
+        return -QCDM_ERROR_PORT_IO_FAILED;
+
+    if (revents & (POLLIN | POLLHUP | POLLERR)) {
+        if (!read_frames (channel)) {
+            channel_fail (channel, -QCDM_ERROR_PORT_IO_FAILED);
+            return -QCDM_ERROR_PORT_IO_FAILED;
+        }
+    }
+
+    if (revents & POLLNVAL) {
+        channel_fail (channel, -QCDM_ERROR_PORT_IO_FAILED);
+        return -QCDM_ERROR_PORT_IO_FAILED;
+    }
+
+    expire_requests (channel);
+
+    if (!flush_writes (channel)) {
+        channel_fail (channel, -QCDM_ERROR_PORT_IO_FAILED);
+        return -QCDM_ERROR_PORT_IO_FAILED;
+    }
+
+    return QCDM_SUCCESS;
+}
+
+int
+qcdm_channel_poll (QcdmChannel **channels,
+                   size_t n_channels,
+                   int max_wait_msecs)
+{
+    struct pollfd fds_static[8];
+    struct pollfd *fds = fds_static;
+    int timeout = max_wait_msecs;
+    size_t i, pending = 0;
+
+    qcdm_return_val_if_fail (channels != NULL || n_channels == 0, -QCDM_ERROR_INVALID_ARGUMENTS);
+
+    if (n_channels > sizeof (fds_static) / sizeof (fds_static[0])) {
+        fds = calloc (n_channels, sizeof (struct pollfd));
+        if (!fds)
+            return -QCDM_ERROR_PORT_IO_FAILED;
+    }
+
+    for (i = 0; i < n_channels; i++) {
+        int t = qcdm_channel_get_timeout (channels[i]);
+
+        fds[i].fd = channels[i]->failed ? -1 : channels[i]->fd;
+        fds[i].events = qcdm_channel_get_events (channels[i]);
+        fds[i].revents = 0;
+        if (t >= 0 && (timeout < 0 || t < timeout))
+            timeout = t;
+    }
+
+    if (poll (fds, n_channels, timeout) < 0 && errno != EINTR) {
+        qcdm_err (0, "poll() error: %d", errno);
+        if (fds != fds_static)
+            free (fds);
+        return -QCDM_ERROR_PORT_IO_FAILED;
+    }
+
+    for (i = 0; i < n_channels; i++) {
+        qcdm_channel_dispatch (channels[i], fds[i].revents);
+        pending += channels[i]->pending;
+    }
+
+    if (fds != fds_static)
+        free (fds);
+    return pending > INT_MAX ? INT_MAX : (int) pending;
+}
+
+/* The response to a DM command starts with the command code, plus the
+ * subsystem ID and subsystem command for DIAG_CMD_SUBSYS.
+ */
+static size_t
+dm_command_match (const char *command, size_t len, char *match)
+{
+    size_t i, n = 0, want = 1;
+    hdlcbool escaping = FALSE;
+
+    for (i = 0; i < len && n < want; i++) {
+        char c = command[i];
+
+        if (n == 0 && !escaping && c == (char) DIAG_CONTROL_CHAR)
+            continue;
+        if (escaping) {
+            c ^= HDLC_ESC_MASK;
+            escaping = FALSE;
+        } else if (c == (char) HDLC_ESC_CHAR) {
+            escaping = TRUE;
+            continue;
+        }
+
+        match[n++] = c;
+        if (n == 1 && (u_int8_t) c == DIAG_CMD_SUBSYS)
+            want = 4;
+    }
+
+    return n == want ? n : 0;
+}
+
+int
+qcdm_channel_submit (QcdmChannel *channel,
+                     const char *command,
+                     size_t len,
+                     const char *match,
+                     size_t match_len,
+                     u_int32_t timeout_msecs,
+                     QcdmChannelResponseFn callback,
+                     void *user_data)
+{
+    QcdmChannelRequest *req;
+
+    qcdm_return_val_if_fail (channel != NULL, -QCDM_ERROR_INVALID_ARGUMENTS);
+    qcdm_return_val_if_fail (command != NULL, -QCDM_ERROR_INVALID_ARGUMENTS);
+    qcdm_return_val_if_fail (len > 0, -QCDM_ERROR_INVALID_ARGUMENTS);
+    qcdm_return_val_if_fail (match_len <= CHANNEL_MATCH_MAX, -QCDM_ERROR_INVALID_ARGUMENTS);
+
+    if (channel->failed)
+        return -QCDM_ERROR_PORT_IO_FAILED;
+
+    req = calloc (1, sizeof (QcdmChannelRequest));
+    if (!req)
+        return -QCDM_ERROR_PORT_IO_FAILED;
+
+    if (match) {
+        memcpy (req->match, match, match_len);
+        req->match_len = match_len;
+    } else
+        req->match_len = dm_command_match (command, len, req->match);
+
+    if (req->match_len == 0) {
+        qcdm_warn (0, "failed: no response match for command");
+        free (req);
+        return -QCDM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    req->command = malloc (len);
+    if (!req->command) {
+        free (req);
+        return -QCDM_ERROR_PORT_IO_FAILED;
+    }
+    memcpy (req->command, command, len);
+    req->command_len = len;
+    req->timeout = timeout_msecs;
+    req->callback = callback;
+    req->user_data = user_data;
+    req->id = channel->next_id++;
+    if (channel->next_id <= 0)
+        channel->next_id = 1;
+
+    req->prev = channel->tail;
+    if (channel->tail)
+        channel->tail->next = req;
+    else
+        channel->head = req;
+    channel->tail = req;
+    channel->pending++;
+
+    start_requests (channel);
+    return req->id;
+}
+
+hdlcbool
+qcdm_channel_cancel (QcdmChannel *channel, int request_id)
+{
+    QcdmChannelRequest *req;
+
+    qcdm_return_val_if_fail (channel != NULL, FALSE);
+
+    for (req = channel->head; req; req = req->next) {
+        if (req->id != request_id || req->cancelled)
+            continue;
+
+        if (!req->deadline) {
+            request_complete (channel, req, -QCDM_ERROR_CANCELLED, NULL, 0);
+            return TRUE;
+        }
+
+        /* Already sent: keep it around so its response is not taken for the
+         * response to a later request with the same command */
+        req->cancelled = TRUE;
+        channel->pending--;
+        if (req->callback)
+            req->callback (channel, -QCDM_ERROR_CANCELLED, NULL, 0, req->user_data);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+void
+qcdm_channel_free (QcdmChannel *channel)
+{
+    qcdm_return_if_fail (channel != NULL);
+
+    channel->failed = TRUE;
+    fail_all (channel, -QCDM_ERROR_CANCELLED);
+    free (channel->wbuf);
+    free (channel);
+}
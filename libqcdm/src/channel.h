@@ -0,0 +1,136 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * Copyright (C) 2012 Google, Inc.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBQCDM_CHANNEL_H
+#define LIBQCDM_CHANNEL_H
+
+#include <sys/types.h>
+
+#include "hdlc.h"
+
+/* Non-blocking request channel.  A QcdmChannel owns the write queue and the
+ * receive buffer of one DM port and matches responses to outstanding requests
+ * by the leading bytes of the decapsulated response, so several requests can
+ * be in flight at once.  It never blocks and does not run an event loop of
+ * its own: callers poll qcdm_channel_get_fd() for the events given by
+ * qcdm_channel_get_events(), wait at most qcdm_channel_get_timeout() msecs,
+ * and then call qcdm_channel_dispatch().  qcdm_channel_poll() does all of that
+ * for a set of channels, for tools driving one or more ports from a single
+ * thread.  Callbacks may submit further requests but must not free the
+ * channel they are called from.
+ */
+
+typedef struct QcdmChannel QcdmChannel;
+
+/* 'error' is QCDM_SUCCESS with the decapsulated response, to be handed to the
+ * matching qcdm_cmd_*_result() function (which also reports DIAG_CMD_BAD_*
+ * rejections), or a negative QCDM_ERROR_* value with a NULL response on
+ * timeout, cancellation or I/O failure.
+ */
+typedef void (*QcdmChannelResponseFn) (QcdmChannel *channel,
+                                       int error,
+                                       const char *response,
+                                       size_t len,
+                                       void *user_data);
+
+/* Called for every frame that does not match an outstanding request, e.g.
+ * log packets and event reports.
+ */
+typedef void (*QcdmChannelUnsolicitedFn) (QcdmChannel *channel,
+                                          const char *frame,
+                                          size_t len,
+                                          void *user_data);
+
+/* Same contract as hdlc_decapsulate_buffer() */
+typedef hdlcbool (*QcdmChannelDecapsulateFn) (const char *inbuf,
+                                              size_t inbuf_len,
+                                              char *outbuf,
+                                              size_t outbuf_len,
+                                              size_t *out_decap_len,
+                                              size_t *out_used,
+                                              hdlcbool *out_need_more,
+                                              void *user_data);
+
+/* Puts 'fd' in non-blocking mode; the fd stays owned by the caller */
+QcdmChannel *qcdm_channel_new (int fd, int *out_error);
+
+/* For other HDLC dialects sharing the transport (e.g. libwmc) */
+QcdmChannel *qcdm_channel_new_full (int fd,
+                                    QcdmChannelDecapsulateFn decapsulate,
+                                    void *decapsulate_data,
+                                    int *out_error);
+
+/* Fails every outstanding request with -QCDM_ERROR_CANCELLED */
+void qcdm_channel_free (QcdmChannel *channel);
+
+int qcdm_channel_get_fd (QcdmChannel *channel);
+
+/* POLLIN, plus POLLOUT while there are queued writes */
+short qcdm_channel_get_events (QcdmChannel *channel);
+
+/* Msecs until the next request times out, or -1 if nothing is outstanding */
+int qcdm_channel_get_timeout (QcdmChannel *channel);
+
+/* Performs I/O for 'revents' (from poll()) and expires timed out requests.
+ * Returns QCDM_SUCCESS, or -QCDM_ERROR_PORT_IO_FAILED if the port failed, in
+ * which case all outstanding requests have been failed as well.
+ */
+int qcdm_channel_dispatch (QcdmChannel *channel, short revents);
+
+/* Polls and dispatches all 'channels' once, waiting at most 'max_wait_msecs'
+ * (-1 for no limit besides the requests' own timeouts).  Returns the number of
+ * requests still outstanding on all channels, or a negative error.
+ */
+int qcdm_channel_poll (QcdmChannel **channels,
+                       size_t n_channels,
+                       int max_wait_msecs);
+
+/* Limits how many requests are written before their responses arrive; 0
+ * (the default) means no limit.  Some firmwares drop commands when flooded.
+ */
+void qcdm_channel_set_max_in_flight (QcdmChannel *channel, unsigned int max);
+
+void qcdm_channel_set_unsolicited_handler (QcdmChannel *channel,
+                                           QcdmChannelUnsolicitedFn callback,
+                                           void *user_data);
+
+/* Queues an encapsulated command (e.g. from qcdm_cmd_version_info_new()).
+ * The response is the first unsolicited frame starting with the 'match_len'
+ * bytes of 'match'; when 'match' is NULL the DM command code (plus subsystem
+ * ID and command for DIAG_CMD_SUBSYS) is taken from the command itself.
+ * 'timeout_msecs' counts from when the command starts being written.  Returns
+ * a positive request ID for qcdm_channel_cancel(), or a negative error.
+ */
+int qcdm_channel_submit (QcdmChannel *channel,
+                         const char *command,
+                         size_t len,
+                         const char *match,
+                         size_t match_len,
+                         u_int32_t timeout_msecs,
+                         QcdmChannelResponseFn callback,
+                         void *user_data);
+
+/* Completes the request with -QCDM_ERROR_CANCELLED; if it was already sent,
+ * its response is still consumed when it arrives.  Returns FALSE if no such
+ * request is outstanding.
+ */
+hdlcbool qcdm_channel_cancel (QcdmChannel *channel, int request_id);
+
+/* Number of requests not yet completed */
+size_t qcdm_channel_get_pending (QcdmChannel *channel);
+
+#endif  /* LIBQCDM_CHANNEL_H */
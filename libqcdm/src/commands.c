@@ -1536,6 +1536,42 @@ qcdm_cmd_nw_subsys_modem_snapshot_cdma_result (const char *buf, size_t len, int
 
 /**********************************************************************/
 
+qcdmbool
+qcdm_cmd_log_packet_parse (const char *buf,
+                           size_t len,
+                           u_int16_t *out_log_code,
+                           u_int64_t *out_timestamp,
+                           const char **out_data,
+                           size_t *out_data_len)
+{
+    DMCmdLog *log = (DMCmdLog *) buf;
+    size_t log_len;
+
+    qcdm_return_val_if_fail (buf != NULL, FALSE);
+
+    if (len < sizeof (DMCmdLog) || log->code != DIAG_CMD_LOG)
+        return FALSE;
+
+    /* 'len' covers everything after itself, from the inner length on */
+    log_len = le16toh (log->len);
+    if (log_len + 4 > len || log_len < sizeof (DMCmdLog) - 4) {
+        qcdm_err (0, "DIAG_CMD_LOG packet malformed (length %zu, got %zu)", log_len, len);
+        return FALSE;
+    }
+
+    if (out_log_code)
+        *out_log_code = le16toh (log->log_code);
+    if (out_timestamp)
+        *out_timestamp = le64toh (log->timestamp);
+    if (out_data)
+        *out_data = (const char *) log->data;
+    if (out_data_len)
+        *out_data_len = log_len - (sizeof (DMCmdLog) - 4);
+    return TRUE;
+}
+
+/**********************************************************************/
+
 static size_t
 qcdm_cmd_log_config_new (char *buf,
                          size_t len,
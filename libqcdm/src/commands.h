@@ -553,6 +553,19 @@ QcdmResult *qcdm_cmd_event_report_result (const char *buf,
 
 /**********************************************************************/
 
+/* Log packets are sent unsolicited by the device for every log code enabled
+ * in the log mask.  Returns TRUE if 'buf' holds a valid log packet, pointing
+ * 'out_data' at its payload inside 'buf'.
+ */
+qcdmbool qcdm_cmd_log_packet_parse (const char *buf,
+                                    size_t len,
+                                    u_int16_t *out_log_code,
+                                    u_int64_t *out_timestamp,
+                                    const char **out_data,
+                                    size_t *out_data_len);
+
+/**********************************************************************/
+
 size_t qcdm_cmd_log_config_get_mask_new (char *buf,
                                          size_t len,
                                          u_int32_t equip_id);
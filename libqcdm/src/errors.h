@@ -53,6 +53,11 @@ enum {
     QCDM_ERROR_NV_ERROR_BAD_PARAMETER = 18,
     QCDM_ERROR_NV_ERROR_READ_ONLY = 19, /* NV location is read-only */
     QCDM_ERROR_RESPONSE_FAILED = 20,    /* command-specific failure */
+    QCDM_ERROR_CAPTURE_IO_FAILED = 21,  /* capture file read/write failed */
+    QCDM_ERROR_CAPTURE_MALFORMED = 22,  /* not a valid capture file */
+    QCDM_ERROR_TIMEOUT = 23,            /* no response in time */
+    QCDM_ERROR_CANCELLED = 24,          /* request cancelled before completion */
+    QCDM_ERROR_PORT_IO_FAILED = 25,     /* reading or writing the port failed */
 };
 
 #define qcdm_assert assert
@@ -0,0 +1,95 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * Copyright (C) 2012 Google, Inc.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBQCDM_HDLC_H
+#define LIBQCDM_HDLC_H
+
+#include <sys/types.h>
+
+/* Async HDLC-like framing shared by QCDM and WMC: frames are escaped so that
+ * the control character (0x7E) and the escape marker (0x7D) never show up in
+ * the frame, and end with a CRC-16/CCITT plus the control character.
+ */
+
+typedef u_int8_t hdlcbool;
+#ifndef TRUE
+#define TRUE ((u_int8_t) 1)
+#endif
+#ifndef FALSE
+#define FALSE ((u_int8_t) 0)
+#endif
+
+#define HDLC_CONTROL_CHAR 0x7E
+#define HDLC_ESC_CHAR     0x7D  /* Escape sequence 1st character value */
+#define HDLC_ESC_MASK     0x20  /* Escape sequence complement value */
+
+/* Seed for hdlc_crc16_update(), and value it gives when run over both the
+ * data and its (little-endian) CRC, if the CRC is correct */
+#define HDLC_CRC16_INIT   0xFFFF
+#define HDLC_CRC16_GOOD   0xF0B8
+
+u_int16_t hdlc_crc16_update (u_int16_t crc,
+                             const char *buffer,
+                             size_t len);
+
+u_int16_t hdlc_crc16 (const char *buffer,
+                      size_t len,
+                      u_int16_t seed);
+
+size_t hdlc_find_special (const char *buffer,
+                          size_t len,
+                          hdlcbool escape_all_ctrl);
+
+size_t hdlc_escape (const char *inbuf,
+                    size_t inbuf_len,
+                    hdlcbool escape_all_ctrl,
+                    char *outbuf,
+                    size_t outbuf_len);
+
+size_t hdlc_unescape (const char *inbuf,
+                      size_t inbuf_len,
+                      char *outbuf,
+                      size_t outbuf_len,
+                      hdlcbool *escaping);
+
+size_t hdlc_encapsulate_in_place (char *buffer,
+                                  size_t data_len,
+                                  size_t buffer_len,
+                                  u_int16_t crc_seed,
+                                  hdlcbool add_trailer,
+                                  hdlcbool escape_all_ctrl);
+
+size_t hdlc_encapsulate_buffer (char *inbuf,
+                                size_t cmd_len,
+                                size_t inbuf_len,
+                                u_int16_t crc_seed,
+                                hdlcbool add_trailer,
+                                hdlcbool escape_all_ctrl,
+                                char *outbuf,
+                                size_t outbuf_len);
+
+hdlcbool hdlc_decapsulate_buffer (const char *inbuf,
+                                  size_t inbuf_len,
+                                  hdlcbool check_known_crc,
+                                  u_int16_t known_crc,
+                                  char *outbuf,
+                                  size_t outbuf_len,
+                                  size_t *out_decap_len,
+                                  size_t *out_used,
+                                  hdlcbool *out_need_more);
+
+#endif  /* LIBQCDM_HDLC_H */
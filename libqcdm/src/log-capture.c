@@ -0,0 +1,597 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * Copyright (C) 2012 Google, Inc.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <endian.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include "log-capture.h"
+#include "errors.h"
+
+/* Big enough for the largest possible record plus a good batch of small ones */
+#define WRITE_BUF_SIZE (128 * 1024)
+#define MAX_PENDING_INDEX ((WRITE_BUF_SIZE / sizeof (QcdmCaptureRecord)) / QCDM_CAPTURE_INDEX_INTERVAL + 1)
+
+static u_int64_t
+now_usec (void)
+{
+    struct timeval tv;
+
+    gettimeofday (&tv, NULL);
+    return (u_int64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static char *
+index_path (const char *path)
+{
+    char *idx;
+
+    idx = malloc (strlen (path) + strlen (QCDM_CAPTURE_INDEX_SUFFIX) + 1);
+    if (idx) {
+        strcpy (idx, path);
+        strcat (idx, QCDM_CAPTURE_INDEX_SUFFIX);
+    }
+    return idx;
+}
+
+static int
+write_all (int fd, const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n;
+
+        n = write (fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            qcdm_err (0, "failed to write capture: %d", errno);
+            return -QCDM_ERROR_CAPTURE_IO_FAILED;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static qcdmbool
+header_valid (const QcdmCaptureHeader *header, size_t file_len)
+{
+    return (file_len >= sizeof (QcdmCaptureHeader) &&
+            memcmp (header->magic, QCDM_CAPTURE_MAGIC, sizeof (header->magic)) == 0 &&
+            le32toh (header->version) == QCDM_CAPTURE_VERSION &&
+            le32toh (header->header_len) >= sizeof (QcdmCaptureHeader) &&
+            le32toh (header->header_len) <= file_len);
+}
+
+/* Length of a record in the capture, or 0 if it doesn't fit in 'avail' */
+static size_t
+record_len (const char *buf, size_t avail)
+{
+    const QcdmCaptureRecord *rec = (const QcdmCaptureRecord *) buf;
+    size_t len;
+
+    if (avail < sizeof (QcdmCaptureRecord))
+        return 0;
+    len = QCDM_CAPTURE_ALIGN (sizeof (QcdmCaptureRecord) + le16toh (rec->len));
+    return len <= avail ? len : 0;
+}
+
+/*********************************************************/
+
+struct QcdmCaptureWriter {
+    int fd;
+    int index_fd;
+    u_int64_t start_time;
+
+    u_int64_t offset;      /* end of the data written to the file so far */
+    u_int64_t records;
+
+    char buf[WRITE_BUF_SIZE];
+    size_t buf_len;
+
+    QcdmCaptureIndexEntry pending[MAX_PENDING_INDEX];
+    u_int32_t n_pending;
+};
+
+/* Finds the end of the last complete record of an existing capture, using
+ * the index to skip most of it, and drops anything after it.
+ */
+static int
+writer_recover (QcdmCaptureWriter *w, size_t file_len)
+{
+    const QcdmCaptureHeader *header;
+    const char *map;
+    struct stat st;
+    u_int64_t offset, records = 0, n_entries = 0;
+    int err = 0;
+
+    map = mmap (NULL, file_len, PROT_READ, MAP_SHARED, w->fd, 0);
+    if (map == MAP_FAILED) {
+        qcdm_err (0, "failed to map capture: %d", errno);
+        return -QCDM_ERROR_CAPTURE_IO_FAILED;
+    }
+
+    header = (const QcdmCaptureHeader *) map;
+    if (!header_valid (header, file_len)) {
+        qcdm_err (0, "not a capture file");
+        err = -QCDM_ERROR_CAPTURE_MALFORMED;
+        goto out;
+    }
+    w->start_time = le64toh (header->start_time);
+    offset = le32toh (header->header_len);
+
+    /* Resume from the last usable index entry */
+    if (fstat (w->index_fd, &st) == 0) {
+        QcdmCaptureIndexEntry entry;
+
+        n_entries = st.st_size / sizeof (entry);
+        while (n_entries > 0) {
+            if (pread (w->index_fd, &entry, sizeof (entry), (n_entries - 1) * sizeof (entry)) == sizeof (entry) &&
+                le64toh (entry.offset) >= offset &&
+                le64toh (entry.offset) < file_len &&
+                record_len (map + le64toh (entry.offset), file_len - le64toh (entry.offset))) {
+                offset = le64toh (entry.offset);
+                records = le64toh (entry.record);
+                break;
+            }
+            n_entries--;
+        }
+    }
+
+    for (;;) {
+        size_t len = record_len (map + offset, file_len - offset);
+
+        if (!len)
+            break;
+        /* Index entries get written along with the record they point to */
+        if (records % QCDM_CAPTURE_INDEX_INTERVAL == 0 && records / QCDM_CAPTURE_INDEX_INTERVAL >= n_entries) {
+            QcdmCaptureIndexEntry entry;
+            const QcdmCaptureRecord *rec = (const QcdmCaptureRecord *) (map + offset);
+
+            entry.offset = htole64 (offset);
+            entry.record = htole64 (records);
+            entry.host_msec = rec->host_msec;
+            entry.reserved = 0;
+            if (pwrite (w->index_fd, &entry, sizeof (entry), n_entries * sizeof (entry)) == sizeof (entry))
+                n_entries++;
+        }
+        offset += len;
+        records++;
+    }
+
+    if (offset < file_len) {
+        qcdm_warn (0, "dropping %zu bytes of truncated capture data", (size_t) (file_len - offset));
+        if (ftruncate (w->fd, offset) < 0) {
+            err = -QCDM_ERROR_CAPTURE_IO_FAILED;
+            goto out;
+        }
+    }
+    if (ftruncate (w->index_fd, n_entries * sizeof (QcdmCaptureIndexEntry)) < 0 ||
+        lseek (w->index_fd, 0, SEEK_END) < 0 ||
+        lseek (w->fd, offset, SEEK_SET) < 0) {
+        err = -QCDM_ERROR_CAPTURE_IO_FAILED;
+        goto out;
+    }
+
+    w->offset = offset;
+    w->records = records;
+
+out:
+    munmap ((void *) map, file_len);
+    return err;
+}
+
+/**
+ * qcdm_capture_writer_open:
+ * @path: capture file to write
+ * @out_error: on failure, the error
+ *
+ * Opens @path for appending log packets, creating it and its index if they
+ * don't exist yet.
+ *
+ * Returns: the writer, or NULL on error.
+ */
+QcdmCaptureWriter *
+qcdm_capture_writer_open (const char *path, int *out_error)
+{
+    QcdmCaptureWriter *w;
+    struct stat st;
+    char *idx;
+    int err = -QCDM_ERROR_CAPTURE_IO_FAILED;
+
+    qcdm_return_val_if_fail (path != NULL, NULL);
+
+    w = calloc (1, sizeof (QcdmCaptureWriter));
+    if (!w)
+        goto error;
+    w->index_fd = -1;
+
+    w->fd = open (path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (w->fd < 0) {
+        qcdm_err (0, "failed to open capture '%s': %d", path, errno);
+        goto error;
+    }
+
+    idx = index_path (path);
+    if (idx) {
+        w->index_fd = open (idx, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        free (idx);
+    }
+    if (w->index_fd < 0) {
+        qcdm_err (0, "failed to open capture index for '%s': %d", path, errno);
+        goto error;
+    }
+
+    if (fstat (w->fd, &st) < 0)
+        goto error;
+
+    if (st.st_size > 0) {
+        err = writer_recover (w, st.st_size);
+        if (err < 0)
+            goto error;
+    } else {
+        QcdmCaptureHeader header;
+
+        memset (&header, 0, sizeof (header));
+        memcpy (header.magic, QCDM_CAPTURE_MAGIC, sizeof (header.magic));
+        header.version = htole32 (QCDM_CAPTURE_VERSION);
+        header.header_len = htole32 (sizeof (header));
+        w->start_time = now_usec ();
+        header.start_time = htole64 (w->start_time);
+
+        if (ftruncate (w->index_fd, 0) < 0)
+            goto error;
+        err = write_all (w->fd, (const char *) &header, sizeof (header));
+        if (err < 0)
+            goto error;
+        w->offset = sizeof (header);
+    }
+
+    return w;
+
+error:
+    if (out_error)
+        *out_error = err;
+    if (w) {
+        if (w->fd >= 0)
+            close (w->fd);
+        if (w->index_fd >= 0)
+            close (w->index_fd);
+        free (w);
+    }
+    return NULL;
+}
+
+int
+qcdm_capture_writer_flush (QcdmCaptureWriter *w)
+{
+    int err;
+
+    qcdm_return_val_if_fail (w != NULL, -QCDM_ERROR_INVALID_ARGUMENTS);
+
+    if (w->buf_len) {
+        err = write_all (w->fd, w->buf, w->buf_len);
+        if (err < 0)
+            return err;
+        w->offset += w->buf_len;
+        w->buf_len = 0;
+    }
+
+    /* Only index records already in the capture */
+    if (w->n_pending) {
+        err = write_all (w->index_fd,
+                         (const char *) w->pending,
+                         w->n_pending * sizeof (QcdmCaptureIndexEntry));
+        if (err < 0)
+            return err;
+        w->n_pending = 0;
+    }
+
+    return 0;
+}
+
+/**
+ * qcdm_capture_writer_add:
+ * @writer: the capture writer
+ * @log_code: log code of the packet
+ * @timestamp: modem timestamp of the packet
+ * @payload: log packet payload
+ * @len: size of @payload
+ *
+ * Appends a log packet to the capture.  Records are buffered; they are
+ * written out when the buffer fills up or on qcdm_capture_writer_flush().
+ *
+ * Returns: 0 on success, or a negative error.
+ */
+int
+qcdm_capture_writer_add (QcdmCaptureWriter *w,
+                         u_int16_t log_code,
+                         u_int64_t timestamp,
+                         const char *payload,
+                         size_t len)
+{
+    QcdmCaptureRecord *rec;
+    size_t reclen;
+    u_int64_t msec;
+    int err;
+
+    qcdm_return_val_if_fail (w != NULL, -QCDM_ERROR_INVALID_ARGUMENTS);
+    qcdm_return_val_if_fail (payload != NULL || len == 0, -QCDM_ERROR_INVALID_ARGUMENTS);
+    qcdm_return_val_if_fail (len <= 0xFFFF, -QCDM_ERROR_INVALID_ARGUMENTS);
+
+    reclen = QCDM_CAPTURE_ALIGN (sizeof (QcdmCaptureRecord) + len);
+    if (w->buf_len + reclen > sizeof (w->buf) || w->n_pending == MAX_PENDING_INDEX) {
+        err = qcdm_capture_writer_flush (w);
+        if (err < 0)
+            return err;
+    }
+
+    msec = (now_usec () - w->start_time) / 1000;
+
+    rec = (QcdmCaptureRecord *) (w->buf + w->buf_len);
+    rec->log_code = htole16 (log_code);
+    rec->len = htole16 (len);
+    rec->host_msec = htole32 (msec > 0xFFFFFFFF ? 0xFFFFFFFF : (u_int32_t) msec);
+    rec->timestamp = htole64 (timestamp);
+    if (len)
+        memcpy (rec->payload, payload, len);
+    memset (rec->payload + len, 0, reclen - sizeof (QcdmCaptureRecord) - len);
+
+    if (w->records % QCDM_CAPTURE_INDEX_INTERVAL == 0) {
+        QcdmCaptureIndexEntry *entry = &w->pending[w->n_pending++];
+
+        entry->offset = htole64 (w->offset + w->buf_len);
+        entry->record = htole64 (w->records);
+        entry->host_msec = rec->host_msec;
+        entry->reserved = 0;
+    }
+
+    w->buf_len += reclen;
+    w->records++;
+    return 0;
+}
+
+u_int64_t
+qcdm_capture_writer_get_records (QcdmCaptureWriter *w)
+{
+    qcdm_return_val_if_fail (w != NULL, 0);
+
+    return w->records;
+}
+
+void
+qcdm_capture_writer_close (QcdmCaptureWriter *w)
+{
+    qcdm_return_if_fail (w != NULL);
+
+    qcdm_capture_writer_flush (w);
+    close (w->fd);
+    close (w->index_fd);
+    memset (w, 0, sizeof (*w));
+    free (w);
+}
+
+/*********************************************************/
+
+struct QcdmCaptureReader {
+    const char *map;
+    size_t len;
+    size_t pos;
+    size_t first;
+
+    const QcdmCaptureIndexEntry *index;
+    size_t index_map_len;
+    size_t n_index;
+};
+
+static void
+reader_open_index (QcdmCaptureReader *r, const char *path)
+{
+    struct stat st;
+    char *idx;
+    void *map;
+    int fd;
+
+    idx = index_path (path);
+    if (!idx)
+        return;
+    fd = open (idx, O_RDONLY | O_CLOEXEC);
+    free (idx);
+    if (fd < 0)
+        return;
+
+    if (fstat (fd, &st) == 0 && st.st_size >= (off_t) sizeof (QcdmCaptureIndexEntry)) {
+        map = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            r->index = map;
+            r->index_map_len = st.st_size;
+            r->n_index = st.st_size / sizeof (QcdmCaptureIndexEntry);
+
+            /* Ignore entries past the end of the capture (e.g. still being
+             * written); any other inconsistency means a stale index */
+            while (r->n_index > 0 && le64toh (r->index[r->n_index - 1].offset) >= r->len)
+                r->n_index--;
+        }
+    }
+    close (fd);
+}
+
+/**
+ * qcdm_capture_reader_open:
+ * @path: capture file to read
+ * @out_error: on failure, the error
+ *
+ * Maps a capture and its index (if any) for reading.  Records appended
+ * after opening the capture are not seen.
+ *
+ * Returns: the reader, or NULL on error.
+ */
+QcdmCaptureReader *
+qcdm_capture_reader_open (const char *path, int *out_error)
+{
+    QcdmCaptureReader *r;
+    struct stat st;
+    void *map;
+    int fd, err = -QCDM_ERROR_CAPTURE_IO_FAILED;
+
+    qcdm_return_val_if_fail (path != NULL, NULL);
+
+    fd = open (path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        qcdm_err (0, "failed to open capture '%s': %d", path, errno);
+        goto error;
+    }
+
+    if (fstat (fd, &st) < 0 || st.st_size == 0) {
+        close (fd);
+        err = -QCDM_ERROR_CAPTURE_MALFORMED;
+        goto error;
+    }
+
+    map = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (map == MAP_FAILED) {
+        qcdm_err (0, "failed to map capture '%s': %d", path, errno);
+        goto error;
+    }
+
+    if (!header_valid (map, st.st_size)) {
+        qcdm_err (0, "'%s' is not a capture file", path);
+        munmap (map, st.st_size);
+        err = -QCDM_ERROR_CAPTURE_MALFORMED;
+        goto error;
+    }
+
+    /* Records are mostly walked from start to end */
+    madvise (map, st.st_size, MADV_SEQUENTIAL);
+
+    r = calloc (1, sizeof (QcdmCaptureReader));
+    if (!r) {
+        munmap (map, st.st_size);
+        goto error;
+    }
+    r->map = map;
+    r->len = st.st_size;
+    r->first = le32toh (((const QcdmCaptureHeader *) map)->header_len);
+    r->pos = r->first;
+
+    reader_open_index (r, path);
+    return r;
+
+error:
+    if (out_error)
+        *out_error = err;
+    return NULL;
+}
+
+const QcdmCaptureHeader *
+qcdm_capture_reader_get_header (QcdmCaptureReader *r)
+{
+    qcdm_return_val_if_fail (r != NULL, NULL);
+
+    return (const QcdmCaptureHeader *) r->map;
+}
+
+const QcdmCaptureRecord *
+qcdm_capture_reader_next (QcdmCaptureReader *r)
+{
+    const QcdmCaptureRecord *rec;
+    size_t len;
+
+    qcdm_return_val_if_fail (r != NULL, NULL);
+
+    len = record_len (r->map + r->pos, r->len - r->pos);
+    if (!len)
+        return NULL;
+
+    rec = (const QcdmCaptureRecord *) (r->map + r->pos);
+    r->pos += len;
+    return rec;
+}
+
+void
+qcdm_capture_reader_rewind (QcdmCaptureReader *r)
+{
+    qcdm_return_if_fail (r != NULL);
+
+    r->pos = r->first;
+}
+
+void
+qcdm_capture_reader_seek_time (QcdmCaptureReader *r, u_int32_t host_msec)
+{
+    size_t lo = 0, hi, pos;
+
+    qcdm_return_if_fail (r != NULL);
+
+    /* Last index entry before the requested time; records received in the
+     * same msec may be on either side of an entry with exactly that time */
+    pos = r->first;
+    hi = r->n_index;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (le32toh (r->index[mid].host_msec) < host_msec)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo > 0) {
+        u_int64_t offset = le64toh (r->index[lo - 1].offset);
+
+        if (offset >= r->first && record_len (r->map + offset, r->len - offset))
+            pos = offset;
+    }
+
+    /* And walk the remaining records */
+    for (;;) {
+        const QcdmCaptureRecord *rec = (const QcdmCaptureRecord *) (r->map + pos);
+        size_t len = record_len (r->map + pos, r->len - pos);
+
+        if (!len || le32toh (rec->host_msec) >= host_msec)
+            break;
+        pos += len;
+    }
+    r->pos = pos;
+}
+
+qcdmbool
+qcdm_capture_reader_has_index (QcdmCaptureReader *r)
+{
+    qcdm_return_val_if_fail (r != NULL, FALSE);
+
+    return r->n_index > 0;
+}
+
+void
+qcdm_capture_reader_close (QcdmCaptureReader *r)
+{
+    qcdm_return_if_fail (r != NULL);
+
+    munmap ((void *) r->map, r->len);
+    if (r->index)
+        munmap ((void *) r->index, r->index_map_len);
+    memset (r, 0, sizeof (*r));
+    free (r);
+}
@@ -0,0 +1,116 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * Copyright (C) 2012 Google, Inc.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBQCDM_LOG_CAPTURE_H
+#define LIBQCDM_LOG_CAPTURE_H
+
+#include <sys/types.h>
+
+#include "utils.h"
+
+/* Capture files hold QCDM log packets back to back, each preceded by a small
+ * record header, so that they can be appended to while logging and read back
+ * through mmap() without any parsing besides walking the records:
+ *
+ *   QcdmCaptureHeader
+ *   QcdmCaptureRecord + payload, padded to 8 bytes
+ *   QcdmCaptureRecord + payload, padded to 8 bytes
+ *   ...
+ *
+ * A sidecar index ("<capture>.idx") gets a QcdmCaptureIndexEntry every
+ * QCDM_CAPTURE_INDEX_INTERVAL records, so that readers can seek by time
+ * without walking the whole capture.  A truncated last record (e.g. after a
+ * crash) is ignored by readers and dropped when the capture is reopened for
+ * writing.  All fields are little-endian.
+ */
+
+#define QCDM_CAPTURE_MAGIC          "QCDMLOG\0"
+#define QCDM_CAPTURE_VERSION        1
+#define QCDM_CAPTURE_INDEX_SUFFIX   ".idx"
+#define QCDM_CAPTURE_INDEX_INTERVAL 1024
+
+#define QCDM_CAPTURE_ALIGN(n) (((n) + 7) & ~((size_t) 7))
+
+struct QcdmCaptureHeader {
+    char magic[8];
+    u_int32_t version;
+    u_int32_t header_len;
+    u_int64_t start_time;  /* host wall-clock time, usecs since the Epoch */
+    u_int64_t reserved;
+} __attribute__ ((packed));
+typedef struct QcdmCaptureHeader QcdmCaptureHeader;
+
+struct QcdmCaptureRecord {
+    u_int16_t log_code;
+    u_int16_t len;         /* payload length, without padding */
+    u_int32_t host_msec;   /* host receive time since start_time */
+    u_int64_t timestamp;   /* modem timestamp from the log packet */
+    u_int8_t payload[0];
+} __attribute__ ((packed));
+typedef struct QcdmCaptureRecord QcdmCaptureRecord;
+
+struct QcdmCaptureIndexEntry {
+    u_int64_t offset;      /* of the record, from the start of the capture */
+    u_int64_t record;      /* record number */
+    u_int32_t host_msec;
+    u_int32_t reserved;
+} __attribute__ ((packed));
+typedef struct QcdmCaptureIndexEntry QcdmCaptureIndexEntry;
+
+/* Writing */
+
+typedef struct QcdmCaptureWriter QcdmCaptureWriter;
+
+QcdmCaptureWriter *qcdm_capture_writer_open  (const char *path,
+                                              int *out_error);
+
+int                qcdm_capture_writer_add   (QcdmCaptureWriter *writer,
+                                              u_int16_t log_code,
+                                              u_int64_t timestamp,
+                                              const char *payload,
+                                              size_t len);
+
+int                qcdm_capture_writer_flush (QcdmCaptureWriter *writer);
+
+u_int64_t          qcdm_capture_writer_get_records (QcdmCaptureWriter *writer);
+
+void               qcdm_capture_writer_close (QcdmCaptureWriter *writer);
+
+/* Reading */
+
+typedef struct QcdmCaptureReader QcdmCaptureReader;
+
+QcdmCaptureReader *qcdm_capture_reader_open (const char *path,
+                                             int *out_error);
+
+const QcdmCaptureHeader *qcdm_capture_reader_get_header (QcdmCaptureReader *reader);
+
+/* Returns the next record, or NULL at the end of the capture */
+const QcdmCaptureRecord *qcdm_capture_reader_next (QcdmCaptureReader *reader);
+
+/* Positions the reader at the first record received at or after 'host_msec' */
+void               qcdm_capture_reader_seek_time (QcdmCaptureReader *reader,
+                                                  u_int32_t host_msec);
+
+void               qcdm_capture_reader_rewind (QcdmCaptureReader *reader);
+
+/* Whether a valid index was found next to the capture */
+qcdmbool           qcdm_capture_reader_has_index (QcdmCaptureReader *reader);
+
+void               qcdm_capture_reader_close (QcdmCaptureReader *reader);
+
+#endif  /* LIBQCDM_LOG_CAPTURE_H */
@@ -20,6 +20,10 @@
 
 #include "result.h"
 
+/* Keys are not copied and must be static strings, like the
+ * QCDM_CMD_*_ITEM_* constants.
+ */
+
 QcdmResult *qcdm_result_new (void);
 
 void qcdm_result_add_string (QcdmResult *result,
@@ -24,6 +24,23 @@
 
 /*********************************************************/
 
+/* Results are built once by the command parsers and then only read, so all
+ * values live inline in the result itself: a small fixed table of entries,
+ * plus a data area holding strings and arrays.  Most results thus take a
+ * single allocation; only unusually large ones (e.g. log config masks) spill
+ * into a separately allocated table or data area.
+ *
+ * Keys are never copied.  They are always the QCDM_CMD_*_ITEM_* string
+ * constants, so lookups compare key pointers first and only fall back to
+ * comparing the strings if that fails.
+ */
+
+#define INLINE_VALS 16
+#define INLINE_DATA 256
+
+/* Offsets into the data area are kept aligned for u16 arrays */
+#define DATA_ALIGN(n) (((n) + 7) & ~((size_t) 7))
+
 typedef struct Val Val;
 
 typedef enum {
@@ -36,163 +53,49 @@ typedef enum {
 } ValType;
 
 struct Val {
-    char *key;
+    const char *key;
     u_int8_t type;
+    u_int32_t array_len;
     union {
-        char *s;
         u_int8_t u8;
         u_int32_t u32;
-        u_int8_t *u8_array;
-        u_int16_t *u16_array;
+        size_t offset;  /* strings and arrays, in the data area */
     } u;
-    u_int32_t array_len;
-    Val *next;
 };
 
-static void
-val_free (Val *v)
-{
-    if (v->type == VAL_TYPE_STRING) {
-        if (v->u.s)
-            free (v->u.s);
-    } else if (v->type == VAL_TYPE_U8_ARRAY) {
-        if (v->u.u8_array);
-            free (v->u.u8_array);
-    } else if (v->type == VAL_TYPE_U16_ARRAY) {
-        if (v->u.u16_array);
-            free (v->u.u16_array);
-    }
-    free (v->key);
-    memset (v, 0, sizeof (*v));
-    free (v);
-}
-
-static Val *
-val_new_string (const char *key, const char *value)
-{
-    Val *v;
-
-    qcdm_return_val_if_fail (key != NULL, NULL);
-    qcdm_return_val_if_fail (key[0] != '\0', NULL);
-    qcdm_return_val_if_fail (value != NULL, NULL);
-
-    v = calloc (sizeof (Val), 1);
-    if (v == NULL)
-        return NULL;
-
-    v->key = strdup (key);
-    v->type = VAL_TYPE_STRING;
-    v->u.s = strdup (value);
-    return v;
-}
-
-static Val *
-val_new_u8 (const char *key, u_int8_t u)
-{
-    Val *v;
-
-    qcdm_return_val_if_fail (key != NULL, NULL);
-    qcdm_return_val_if_fail (key[0] != '\0', NULL);
-
-    v = calloc (sizeof (Val), 1);
-    if (v == NULL)
-        return NULL;
-
-    v->key = strdup (key);
-    v->type = VAL_TYPE_U8;
-    v->u.u8 = u;
-    return v;
-}
-
-static Val *
-val_new_u8_array (const char *key, const u_int8_t *array, size_t array_len)
-{
-    Val *v;
-
-    qcdm_return_val_if_fail (key != NULL, NULL);
-    qcdm_return_val_if_fail (key[0] != '\0', NULL);
-    qcdm_return_val_if_fail (array != NULL, NULL);
-    qcdm_return_val_if_fail (array_len > 0, NULL);
-
-    v = calloc (sizeof (Val), 1);
-    if (v == NULL)
-        return NULL;
-
-    v->key = strdup (key);
-    v->type = VAL_TYPE_U8_ARRAY;
-    v->u.u8_array = malloc (array_len);
-    if (v->u.u8_array == NULL) {
-        val_free (v);
-        return NULL;
-    }
-    memcpy (v->u.u8_array, array, array_len);
-    v->array_len = array_len;
-
-    return v;
-}
-
-static Val *
-val_new_u32 (const char *key, u_int32_t u)
-{
-    Val *v;
-
-    qcdm_return_val_if_fail (key != NULL, NULL);
-    qcdm_return_val_if_fail (key[0] != '\0', NULL);
-
-    v = calloc (sizeof (Val), 1);
-    if (v == NULL)
-        return NULL;
-
-    v->key = strdup (key);
-    v->type = VAL_TYPE_U32;
-    v->u.u32 = u;
-    return v;
-}
-
-static Val *
-val_new_u16_array (const char *key, const u_int16_t *array, size_t array_len)
-{
-    Val *v;
-    size_t sz;
+struct QcdmResult {
+    u_int32_t refcount;
 
-    qcdm_return_val_if_fail (key != NULL, NULL);
-    qcdm_return_val_if_fail (key[0] != '\0', NULL);
-    qcdm_return_val_if_fail (array != NULL, NULL);
-    qcdm_return_val_if_fail (array_len > 0, NULL);
+    Val *vals;
+    u_int32_t n_vals;
+    u_int32_t vals_size;
 
-    v = calloc (sizeof (Val), 1);
-    if (v == NULL)
-        return NULL;
-
-    v->key = strdup (key);
-    v->type = VAL_TYPE_U16_ARRAY;
-    sz = sizeof (u_int16_t) * array_len;
-    v->u.u16_array = malloc (sz);
-    if (v->u.u16_array == NULL) {
-        val_free (v);
-        return NULL;
-    }
-    memcpy (v->u.u16_array, array, sz);
-    v->array_len = array_len;
+    char *data;
+    size_t data_len;
+    size_t data_size;
 
-    return v;
-}
+    Val inline_vals[INLINE_VALS];
+    union {
+        char c[INLINE_DATA];
+        u_int64_t align;
+    } inline_data;
+};
 
 /*********************************************************/
 
-struct QcdmResult {
-    u_int32_t refcount;
-    Val *first;
-};
-
 QcdmResult *
 qcdm_result_new (void)
 {
     QcdmResult *r;
 
     r = calloc (sizeof (QcdmResult), 1);
-    if (r)
+    if (r) {
         r->refcount = 1;
+        r->vals = r->inline_vals;
+        r->vals_size = INLINE_VALS;
+        r->data = r->inline_data.c;
+        r->data_size = INLINE_DATA;
+    }
     return r;
 }
 
@@ -209,14 +112,10 @@ qcdm_result_ref (QcdmResult *r)
 static void
 qcdm_result_free (QcdmResult *r)
 {
-    Val *v, *n;
-
-    v = r->first;
-    while (v) {
-        n = v->next;
-        val_free (v);
-        v = n;
-    }
+    if (r->vals != r->inline_vals)
+        free (r->vals);
+    if (r->data != r->inline_data.c)
+        free (r->data);
     memset (r, 0, sizeof (*r));
     free (r);
 }
@@ -235,19 +134,114 @@ qcdm_result_unref (QcdmResult *r)
 static Val *
 find_val (QcdmResult *r, const char *key, ValType expected_type)
 {
-    Val *v, *n;
-
-    v = r->first;
-    while (v) {
-        n = v->next;
-        if (strcmp (v->key, key) == 0) {
-            /* Check type */
-            qcdm_return_val_if_fail (v->type == expected_type, NULL);
-            return v;
+    Val *v = NULL;
+    u_int32_t i;
+
+    /* Latest value added wins */
+    for (i = r->n_vals; i > 0; i--) {
+        if (r->vals[i - 1].key == key) {
+            v = &r->vals[i - 1];
+            break;
+        }
+    }
+
+    if (!v) {
+        for (i = r->n_vals; i > 0; i--) {
+            if (strcmp (r->vals[i - 1].key, key) == 0) {
+                v = &r->vals[i - 1];
+                break;
+            }
         }
-        v = n;
     }
-    return NULL;
+
+    if (v) {
+        /* Check type */
+        qcdm_return_val_if_fail (v->type == expected_type, NULL);
+    }
+    return v;
+}
+
+static Val *
+add_val (QcdmResult *r, const char *key, ValType type)
+{
+    Val *v;
+
+    qcdm_return_val_if_fail (key != NULL, NULL);
+    qcdm_return_val_if_fail (key[0] != '\0', NULL);
+
+    if (r->n_vals == r->vals_size) {
+        Val *vals;
+        u_int32_t size = r->vals_size * 2;
+
+        if (r->vals == r->inline_vals) {
+            vals = malloc (sizeof (Val) * size);
+            if (vals)
+                memcpy (vals, r->inline_vals, sizeof (Val) * r->n_vals);
+        } else
+            vals = realloc (r->vals, sizeof (Val) * size);
+        if (vals == NULL)
+            return NULL;
+
+        r->vals = vals;
+        r->vals_size = size;
+    }
+
+    v = &r->vals[r->n_vals++];
+    memset (v, 0, sizeof (*v));
+    v->key = key;
+    v->type = type;
+    return v;
+}
+
+/* Reserves space in the data area, returning its offset or -1 on failure */
+static ssize_t
+add_data (QcdmResult *r, const void *data, size_t len)
+{
+    size_t offset = DATA_ALIGN (r->data_len);
+
+    if (offset + len > r->data_size) {
+        char *d;
+        size_t size = r->data_size * 2;
+
+        while (size < offset + len)
+            size *= 2;
+
+        if (r->data == r->inline_data.c) {
+            d = malloc (size);
+            if (d)
+                memcpy (d, r->inline_data.c, r->data_len);
+        } else
+            d = realloc (r->data, size);
+        if (d == NULL)
+            return -1;
+
+        r->data = d;
+        r->data_size = size;
+    }
+
+    memcpy (r->data + offset, data, len);
+    r->data_len = offset + len;
+    return offset;
+}
+
+static void
+add_data_val (QcdmResult *r,
+              const char *key,
+              ValType type,
+              const void *data,
+              size_t len,
+              u_int32_t array_len)
+{
+    ssize_t offset;
+    Val *v;
+
+    offset = add_data (r, data, len);
+    qcdm_return_if_fail (offset >= 0);
+
+    v = add_val (r, key, type);
+    qcdm_return_if_fail (v != NULL);
+    v->u.offset = offset;
+    v->array_len = array_len;
 }
 
 void
@@ -255,17 +249,12 @@ qcdm_result_add_string (QcdmResult *r,
                        const char *key,
                        const char *str)
 {
-    Val *v;
-
     qcdm_return_if_fail (r != NULL);
     qcdm_return_if_fail (r->refcount > 0);
     qcdm_return_if_fail (key != NULL);
     qcdm_return_if_fail (str != NULL);
 
-    v = val_new_string (key, str);
-    qcdm_return_if_fail (v != NULL);
-    v->next = r->first;
-    r->first = v;
+    add_data_val (r, key, VAL_TYPE_STRING, str, strlen (str) + 1, 0);
 }
 
 int
@@ -285,7 +274,7 @@ qcdm_result_get_string (QcdmResult *r,
     if (v == NULL)
         return -QCDM_ERROR_VALUE_NOT_FOUND;
 
-    *out_val = v->u.s;
+    *out_val = r->data + v->u.offset;
     return 0;
 }
 
@@ -300,10 +289,9 @@ qcdm_result_add_u8 (QcdmResult *r,
     qcdm_return_if_fail (r->refcount > 0);
     qcdm_return_if_fail (key != NULL);
 
-    v = val_new_u8 (key, num);
+    v = add_val (r, key, VAL_TYPE_U8);
     qcdm_return_if_fail (v != NULL);
-    v->next = r->first;
-    r->first = v;
+    v->u.u8 = num;
 }
 
 int
@@ -332,18 +320,13 @@ qcdm_result_add_u8_array (QcdmResult *r,
                           const u_int8_t *array,
                           size_t array_len)
 {
-    Val *v;
-
     qcdm_return_if_fail (r != NULL);
     qcdm_return_if_fail (r->refcount > 0);
     qcdm_return_if_fail (key != NULL);
     qcdm_return_if_fail (array != NULL);
-    qcdm_return_if_fail (array_len >= 0);
+    qcdm_return_if_fail (array_len > 0);
 
-    v = val_new_u8_array (key, array, array_len);
-    qcdm_return_if_fail (v != NULL);
-    v->next = r->first;
-    r->first = v;
+    add_data_val (r, key, VAL_TYPE_U8_ARRAY, array, array_len, array_len);
 }
 
 int
@@ -364,7 +347,7 @@ qcdm_result_get_u8_array (QcdmResult *r,
     if (v == NULL)
         return -QCDM_ERROR_VALUE_NOT_FOUND;
 
-    *out_val = v->u.u8_array;
+    *out_val = (const u_int8_t *) (r->data + v->u.offset);
     *out_len = v->array_len;
     return 0;
 }
@@ -380,10 +363,9 @@ qcdm_result_add_u32 (QcdmResult *r,
     qcdm_return_if_fail (r->refcount > 0);
     qcdm_return_if_fail (key != NULL);
 
-    v = val_new_u32 (key, num);
+    v = add_val (r, key, VAL_TYPE_U32);
     qcdm_return_if_fail (v != NULL);
-    v->next = r->first;
-    r->first = v;
+    v->u.u32 = num;
 }
 
 int
@@ -412,18 +394,13 @@ qcdm_result_add_u16_array (QcdmResult *r,
                            const u_int16_t *array,
                            size_t array_len)
 {
-    Val *v;
-
     qcdm_return_if_fail (r != NULL);
     qcdm_return_if_fail (r->refcount > 0);
     qcdm_return_if_fail (key != NULL);
     qcdm_return_if_fail (array != NULL);
-    qcdm_return_if_fail (array_len >= 0);
+    qcdm_return_if_fail (array_len > 0);
 
-    v = val_new_u16_array (key, array, array_len);
-    qcdm_return_if_fail (v != NULL);
-    v->next = r->first;
-    r->first = v;
+    add_data_val (r, key, VAL_TYPE_U16_ARRAY, array, sizeof (u_int16_t) * array_len, array_len);
 }
 
 int
@@ -444,7 +421,7 @@ qcdm_result_get_u16_array (QcdmResult *r,
     if (v == NULL)
         return -QCDM_ERROR_VALUE_NOT_FOUND;
 
-    *out_val = v->u.u16_array;
+    *out_val = (const u_int16_t *) (r->data + v->u.offset);
     *out_len = v->array_len;
     return 0;
 }
@@ -21,6 +21,8 @@
 #include <config.h>
 #include <sys/types.h>
 
+#include "hdlc.h"
+
 typedef u_int8_t qcdmbool;
 #ifndef TRUE
 #define TRUE ((u_int8_t) 1)
@@ -29,11 +31,21 @@ typedef u_int8_t qcdmbool;
 #define FALSE ((u_int8_t) 0)
 #endif
 
-#define DIAG_CONTROL_CHAR 0x7E
+#define DIAG_CONTROL_CHAR HDLC_CONTROL_CHAR
 #define DIAG_TRAILER_LEN  3
 
+#define DIAG_ESC_CHAR     HDLC_ESC_CHAR   /* Escape sequence 1st character value */
+#define DIAG_ESC_MASK     HDLC_ESC_MASK   /* Escape sequence complement value */
+
+/* Seed for dm_crc16_update(), and value it gives when run over both the
+ * data and its (little-endian) CRC, if the CRC is correct */
+#define DM_CRC16_INIT     HDLC_CRC16_INIT
+#define DM_CRC16_GOOD     HDLC_CRC16_GOOD
+
 u_int16_t dm_crc16 (const char *buffer, size_t len);
 
+u_int16_t dm_crc16_update (u_int16_t crc, const char *buffer, size_t len);
+
 size_t dm_escape (const char *inbuf,
                   size_t inbuf_len,
                   char *outbuf,
@@ -0,0 +1,202 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * Copyright (C) 2012 Google, Inc.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <endian.h>
+
+#include "test-qcdm-capture.h"
+#include "commands.h"
+#include "log-capture.h"
+#include "log-items.h"
+
+static const char log_packet[] = {
+    0x10, 0x00, 0x0d, 0x00, 0x0d, 0x00, 0x25, 0x41, 0x0b, 0x2c, 0x37, 0x3e,
+    0xd4, 0xb3, 0xd8, 0x00, 0x03
+};
+
+void
+test_capture_log_packet (void *f, void *data)
+{
+    u_int16_t log_code = 0;
+    u_int64_t timestamp = 0;
+    const char *payload = NULL;
+    size_t len = 0;
+
+    g_assert (qcdm_cmd_log_packet_parse (log_packet, sizeof (log_packet),
+                                         &log_code, &timestamp, &payload, &len));
+    g_assert_cmpint (log_code, ==, DM_LOG_ITEM_WCDMA_RRC_STATE);
+    g_assert_cmpint (timestamp, ==, G_GUINT64_CONSTANT (0x00d8b3d43e372c0b));
+    g_assert_cmpint (len, ==, 1);
+    g_assert_cmpint (payload[0], ==, DM_LOG_ITEM_WCDMA_RRC_STATE_CELL_DCH);
+
+    /* Truncated */
+    g_assert (!qcdm_cmd_log_packet_parse (log_packet, sizeof (log_packet) - 2,
+                                          NULL, NULL, NULL, NULL));
+}
+
+static char *
+capture_path (char **out_dir)
+{
+    *out_dir = g_dir_make_tmp ("test-qcdm-XXXXXX", NULL);
+    g_assert (*out_dir);
+    return g_build_filename (*out_dir, "capture", NULL);
+}
+
+static void
+capture_remove (char *dir, char *path)
+{
+    char *idx;
+
+    idx = g_strconcat (path, QCDM_CAPTURE_INDEX_SUFFIX, NULL);
+    g_unlink (idx);
+    g_unlink (path);
+    g_rmdir (dir);
+    g_free (idx);
+    g_free (path);
+    g_free (dir);
+}
+
+static void
+make_payload (guint n, char *buf, size_t *out_len)
+{
+    size_t i;
+
+    *out_len = n % 61;
+    for (i = 0; i < *out_len; i++)
+        buf[i] = n + i;
+}
+
+static void
+check_records (QcdmCaptureReader *reader, guint first, guint last)
+{
+    const QcdmCaptureRecord *rec;
+    char expected[64];
+    size_t len;
+    guint n;
+
+    for (n = first; n < last; n++) {
+        rec = qcdm_capture_reader_next (reader);
+        g_assert (rec);
+        make_payload (n, expected, &len);
+        g_assert_cmpint (le16toh (rec->log_code), ==, 0x1000 + n % 100);
+        g_assert_cmpint (le64toh (rec->timestamp), ==, n);
+        g_assert_cmpint (le16toh (rec->len), ==, len);
+        g_assert (memcmp (rec->payload, expected, len) == 0);
+    }
+    g_assert (qcdm_capture_reader_next (reader) == NULL);
+}
+
+static void
+add_records (QcdmCaptureWriter *writer, guint first, guint last)
+{
+    char payload[64];
+    size_t len;
+    guint n;
+
+    for (n = first; n < last; n++) {
+        make_payload (n, payload, &len);
+        g_assert_cmpint (qcdm_capture_writer_add (writer, 0x1000 + n % 100, n, payload, len), ==, 0);
+    }
+}
+
+void
+test_capture_write_read (void *f, void *data)
+{
+    QcdmCaptureWriter *writer;
+    QcdmCaptureReader *reader;
+    char *dir, *path;
+    int err = 0;
+
+    path = capture_path (&dir);
+
+    writer = qcdm_capture_writer_open (path, &err);
+    g_assert (writer);
+    add_records (writer, 0, 5000);
+    g_assert_cmpint (qcdm_capture_writer_get_records (writer), ==, 5000);
+    qcdm_capture_writer_close (writer);
+
+    /* Appending keeps the existing records */
+    writer = qcdm_capture_writer_open (path, &err);
+    g_assert (writer);
+    g_assert_cmpint (qcdm_capture_writer_get_records (writer), ==, 5000);
+    add_records (writer, 5000, 6000);
+    qcdm_capture_writer_close (writer);
+
+    reader = qcdm_capture_reader_open (path, &err);
+    g_assert (reader);
+    g_assert (qcdm_capture_reader_has_index (reader));
+    check_records (reader, 0, 6000);
+
+    /* Everything was received within the same test run */
+    qcdm_capture_reader_seek_time (reader, 0);
+    check_records (reader, 0, 6000);
+    qcdm_capture_reader_seek_time (reader, G_MAXUINT32);
+    g_assert (qcdm_capture_reader_next (reader) == NULL);
+
+    qcdm_capture_reader_close (reader);
+    capture_remove (dir, path);
+}
+
+void
+test_capture_recover (void *f, void *data)
+{
+    QcdmCaptureWriter *writer;
+    QcdmCaptureReader *reader;
+    char *dir, *path, *idx;
+    FILE *file;
+    int err = 0;
+
+    path = capture_path (&dir);
+
+    writer = qcdm_capture_writer_open (path, &err);
+    g_assert (writer);
+    add_records (writer, 0, 2000);
+    qcdm_capture_writer_close (writer);
+
+    /* A partially written record, and a lost index */
+    file = fopen (path, "a");
+    g_assert (file);
+    fwrite ("\x01\x10\x20\x00\x00", 1, 5, file);
+    fclose (file);
+    idx = g_strconcat (path, QCDM_CAPTURE_INDEX_SUFFIX, NULL);
+    g_unlink (idx);
+    g_free (idx);
+
+    /* Readers skip the partial record */
+    reader = qcdm_capture_reader_open (path, &err);
+    g_assert (reader);
+    g_assert (!qcdm_capture_reader_has_index (reader));
+    check_records (reader, 0, 2000);
+    qcdm_capture_reader_close (reader);
+
+    /* Writers drop it, and rebuild the index */
+    writer = qcdm_capture_writer_open (path, &err);
+    g_assert (writer);
+    g_assert_cmpint (qcdm_capture_writer_get_records (writer), ==, 2000);
+    add_records (writer, 2000, 2100);
+    qcdm_capture_writer_close (writer);
+
+    reader = qcdm_capture_reader_open (path, &err);
+    g_assert (reader);
+    g_assert (qcdm_capture_reader_has_index (reader));
+    check_records (reader, 0, 2100);
+    qcdm_capture_reader_close (reader);
+
+    capture_remove (dir, path);
+}
@@ -0,0 +1,260 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * Copyright (C) 2012 Google, Inc.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "test-qcdm-channel.h"
+#include "channel.h"
+#include "commands.h"
+#include "dm-commands.h"
+#include "errors.h"
+#include "utils.h"
+
+typedef struct {
+    int error;
+    char response[64];
+    size_t len;
+    guint order;
+} Reply;
+
+typedef struct {
+    guint completed;
+    guint unsolicited;
+} Counters;
+
+static Counters counters;
+
+static void
+reply_cb (QcdmChannel *channel,
+          int error,
+          const char *response,
+          size_t len,
+          void *user_data)
+{
+    Reply *reply = user_data;
+
+    g_assert (reply->order == 0);
+    reply->order = ++counters.completed;
+    reply->error = error;
+    if (response) {
+        g_assert (len <= sizeof (reply->response));
+        memcpy (reply->response, response, len);
+        reply->len = len;
+    }
+}
+
+static void
+unsolicited_cb (QcdmChannel *channel,
+                const char *frame,
+                size_t len,
+                void *user_data)
+{
+    counters.unsolicited++;
+}
+
+/* Reads one command from the device side of the socket pair */
+static size_t
+device_read_command (int fd, char *cmd, size_t cmd_len)
+{
+    static char buf[512];
+    static size_t buf_len = 0;
+
+    for (;;) {
+        size_t decap_len = 0, used = 0;
+        qcdmbool more = FALSE;
+        ssize_t n;
+
+        if (buf_len) {
+            g_assert (dm_decapsulate_buffer (buf, buf_len, cmd, cmd_len,
+                                             &decap_len, &used, &more));
+            if (!more) {
+                memmove (buf, buf + used, buf_len - used);
+                buf_len -= used;
+                return decap_len;
+            }
+        }
+
+        n = read (fd, buf + buf_len, sizeof (buf) - buf_len);
+        g_assert (n > 0);
+        buf_len += n;
+    }
+}
+
+static void
+device_write_reply (int fd, const char *reply, size_t reply_len)
+{
+    char raw[64], frame[128];
+    size_t len;
+
+    memcpy (raw, reply, reply_len);
+    len = dm_encapsulate_buffer (raw, reply_len, sizeof (raw), frame, sizeof (frame));
+    g_assert (len > 0);
+    g_assert_cmpint (write (fd, frame, len), ==, (ssize_t) len);
+}
+
+static void
+run_until_idle (QcdmChannel *channel)
+{
+    int loops = 0;
+
+    while (qcdm_channel_poll (&channel, 1, 50) > 0)
+        g_assert (++loops < 100);
+}
+
+void
+test_channel_pipelining (void *f, void *data)
+{
+    QcdmChannel *channel;
+    Reply replies[3];
+    char cmds[3][64], buf[128];
+    size_t cmd_lens[3];
+    int fds[2], err = QCDM_SUCCESS, i;
+    static const char log_packet[] = { 0x10, 0x00, 0x0d, 0x00, 0x0d, 0x00, 0x25, 0x41,
+                                       0x0b, 0x2c, 0x37, 0x3e, 0xd4, 0xb3, 0xd8, 0x00, 0x03 };
+
+    memset (&counters, 0, sizeof (counters));
+    memset (replies, 0, sizeof (replies));
+    g_assert (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    channel = qcdm_channel_new (fds[0], &err);
+    g_assert (channel);
+    g_assert_cmpint (err, ==, QCDM_SUCCESS);
+    qcdm_channel_set_unsolicited_handler (channel, unsolicited_cb, NULL);
+
+    /* Three different commands in flight at once, one of them a subsystem
+     * command that must be matched on more than its command code */
+    g_assert (qcdm_channel_submit (channel, buf, qcdm_cmd_version_info_new (buf, sizeof (buf)),
+                                   NULL, 0, 1000, reply_cb, &replies[0]) > 0);
+    g_assert (qcdm_channel_submit (channel, buf, qcdm_cmd_esn_new (buf, sizeof (buf)),
+                                   NULL, 0, 1000, reply_cb, &replies[1]) > 0);
+    g_assert (qcdm_channel_submit (channel, buf, qcdm_cmd_cm_subsys_state_info_new (buf, sizeof (buf)),
+                                   NULL, 0, 1000, reply_cb, &replies[2]) > 0);
+    g_assert_cmpint (qcdm_channel_get_pending (channel), ==, 3);
+
+    /* Flush the writes */
+    qcdm_channel_poll (&channel, 1, 0);
+    for (i = 0; i < 3; i++)
+        cmd_lens[i] = device_read_command (fds[1], cmds[i], sizeof (cmds[i]));
+    g_assert_cmpint ((u_int8_t) cmds[0][0], ==, DIAG_CMD_VERSION_INFO);
+    g_assert_cmpint ((u_int8_t) cmds[1][0], ==, DIAG_CMD_ESN);
+    g_assert_cmpint ((u_int8_t) cmds[2][0], ==, DIAG_CMD_SUBSYS);
+
+    /* Answer out of order, with a log packet and a subsystem response for
+     * some other subsystem mixed in */
+    memcpy (buf, cmds[2], 4);
+    buf[1]++;
+    device_write_reply (fds[1], buf, 6);
+    memcpy (buf, cmds[2], 4);
+    buf[4] = 0x42;
+    device_write_reply (fds[1], buf, 5);
+    device_write_reply (fds[1], log_packet, sizeof (log_packet));
+    device_write_reply (fds[1], cmds[1], 1);
+    /* Rejection echoes the command after the DIAG_CMD_BAD_* code */
+    buf[0] = DIAG_CMD_BAD_CMD;
+    memcpy (buf + 1, cmds[0], cmd_lens[0]);
+    device_write_reply (fds[1], buf, cmd_lens[0] + 1);
+
+    run_until_idle (channel);
+
+    g_assert_cmpint (counters.unsolicited, ==, 2);
+    g_assert_cmpint (replies[2].order, ==, 1);
+    g_assert_cmpint (replies[2].error, ==, QCDM_SUCCESS);
+    g_assert_cmpint (replies[2].len, ==, 5);
+    g_assert_cmpint (replies[2].response[4], ==, 0x42);
+    g_assert_cmpint (replies[1].order, ==, 2);
+    g_assert_cmpint ((u_int8_t) replies[1].response[0], ==, DIAG_CMD_ESN);
+    g_assert_cmpint (replies[0].order, ==, 3);
+    g_assert_cmpint (replies[0].error, ==, QCDM_SUCCESS);
+    g_assert_cmpint ((u_int8_t) replies[0].response[0], ==, DIAG_CMD_BAD_CMD);
+    g_assert (qcdm_cmd_version_info_result (replies[0].response, replies[0].len, &err) == NULL);
+    g_assert_cmpint (err, ==, -QCDM_ERROR_RESPONSE_BAD_COMMAND);
+
+    qcdm_channel_free (channel);
+    close (fds[0]);
+    close (fds[1]);
+}
+
+void
+test_channel_timeout_cancel (void *f, void *data)
+{
+    QcdmChannel *channel;
+    Reply replies[4];
+    char buf[128], cmd[64];
+    int fds[2], id, i;
+
+    memset (&counters, 0, sizeof (counters));
+    memset (replies, 0, sizeof (replies));
+    g_assert (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    channel = qcdm_channel_new (fds[0], NULL);
+    g_assert (channel);
+    qcdm_channel_set_max_in_flight (channel, 2);
+
+    /* Sent, then cancelled: its late response must not complete the next
+     * request for the same command */
+    id = qcdm_channel_submit (channel, buf, qcdm_cmd_esn_new (buf, sizeof (buf)),
+                              NULL, 0, 5000, reply_cb, &replies[0]);
+    g_assert (id > 0);
+    g_assert (qcdm_channel_submit (channel, buf, qcdm_cmd_esn_new (buf, sizeof (buf)),
+                                   NULL, 0, 5000, reply_cb, &replies[1]) > 0);
+    /* Held back by max_in_flight until one of the above completes */
+    g_assert (qcdm_channel_submit (channel, buf, qcdm_cmd_version_info_new (buf, sizeof (buf)),
+                                   NULL, 0, 200, reply_cb, &replies[2]) > 0);
+    g_assert (qcdm_channel_cancel (channel, id));
+    g_assert (!qcdm_channel_cancel (channel, id));
+    g_assert_cmpint (replies[0].order, ==, 1);
+    g_assert_cmpint (replies[0].error, ==, -QCDM_ERROR_CANCELLED);
+    g_assert_cmpint (qcdm_channel_get_pending (channel), ==, 2);
+
+    qcdm_channel_poll (&channel, 1, 0);
+    for (i = 0; i < 2; i++) {
+        device_read_command (fds[1], cmd, sizeof (cmd));
+        g_assert_cmpint ((u_int8_t) cmd[0], ==, DIAG_CMD_ESN);
+    }
+
+    device_write_reply (fds[1], cmd, 1);
+    qcdm_channel_poll (&channel, 1, 50);
+    g_assert_cmpint (replies[1].order, ==, 0);
+
+    /* The tombstone is gone, so the version info request is sent now */
+    device_read_command (fds[1], cmd, sizeof (cmd));
+    g_assert_cmpint ((u_int8_t) cmd[0], ==, DIAG_CMD_VERSION_INFO);
+
+    device_write_reply (fds[1], "\x01", 1);
+    qcdm_channel_poll (&channel, 1, 1000);
+    g_assert_cmpint (replies[1].order, ==, 2);
+    g_assert_cmpint (replies[1].error, ==, QCDM_SUCCESS);
+
+    /* Nobody answers the version info request */
+    g_assert_cmpint (replies[2].order, ==, 0);
+    while (qcdm_channel_get_pending (channel))
+        qcdm_channel_poll (&channel, 1, 1000);
+    g_assert_cmpint (replies[2].order, ==, 3);
+    g_assert_cmpint (replies[2].error, ==, -QCDM_ERROR_TIMEOUT);
+
+    /* Outstanding requests are cancelled when the channel goes away */
+    g_assert (qcdm_channel_submit (channel, buf, qcdm_cmd_esn_new (buf, sizeof (buf)),
+                                   NULL, 0, 0, reply_cb, &replies[3]) > 0);
+    qcdm_channel_free (channel);
+    g_assert_cmpint (replies[3].error, ==, -QCDM_ERROR_CANCELLED);
+
+    close (fds[0]);
+    close (fds[1]);
+}
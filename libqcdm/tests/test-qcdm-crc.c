@@ -63,3 +63,90 @@ test_crc16_1 (void *f, void *data)
     g_assert (crc == expected);
 }
 
+
+/* Byte-at-a-time reference, as the CRC was computed before slice-by-8 */
+static guint16
+reference_crc16_update (guint16 crc, const char *buf, gsize len)
+{
+    static guint16 table[256];
+    static gboolean ready = FALSE;
+    guint n, k;
+
+    if (!ready) {
+        for (n = 0; n < 256; n++) {
+            guint16 c = n;
+
+            for (k = 0; k < 8; k++)
+                c = (c & 1) ? (c >> 1) ^ 0x8408 : (c >> 1);
+            table[n] = c;
+        }
+        ready = TRUE;
+    }
+
+    while (len--)
+        crc = table[(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+void
+test_crc16_slices (void *f, void *data)
+{
+    char buf[300];
+    gsize offset, len;
+    guint i;
+
+    for (i = 0; i < sizeof (buf); i++)
+        buf[i] = g_random_int ();
+
+    /* Every length and alignment around the 8-byte slices */
+    for (offset = 0; offset < 8; offset++) {
+        for (len = 0; len + offset <= sizeof (buf); len++) {
+            g_assert_cmpuint (dm_crc16_update (DM_CRC16_INIT, buf + offset, len), ==,
+                              reference_crc16_update (DM_CRC16_INIT, buf + offset, len));
+        }
+    }
+
+    /* CRC over data plus its CRC gives the fixed residue */
+    len = sizeof (buf) - 2;
+    i = dm_crc16 (buf, len);
+    buf[len] = i & 0xFF;
+    buf[len + 1] = (i >> 8) & 0xFF;
+    g_assert_cmpuint (dm_crc16_update (DM_CRC16_INIT, buf, sizeof (buf)), ==, DM_CRC16_GOOD);
+}
+
+void
+test_crc16_benchmark (void *f, void *data)
+{
+    const gsize size = 1024 * 1024;
+    const guint rounds = 100;
+    GTimer *timer;
+    char *buf;
+    gdouble t_ref, t_new;
+    guint16 crc_ref = 0, crc_new = 0;
+    guint i;
+
+    if (!g_test_perf ())
+        return;
+
+    buf = g_malloc (size);
+    for (i = 0; i < size; i++)
+        buf[i] = g_random_int ();
+
+    timer = g_timer_new ();
+    for (i = 0; i < rounds; i++)
+        crc_ref ^= reference_crc16_update (DM_CRC16_INIT, buf, size);
+    t_ref = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < rounds; i++)
+        crc_new ^= dm_crc16_update (DM_CRC16_INIT, buf, size);
+    t_new = g_timer_elapsed (timer, NULL);
+
+    g_assert_cmpuint (crc_ref, ==, crc_new);
+    g_test_minimized_result (t_new, "crc16: %.0f MB/s (byte-at-a-time: %.0f MB/s)",
+                             (rounds * size) / t_new / 1e6,
+                             (rounds * size) / t_ref / 1e6);
+
+    g_timer_destroy (timer);
+    g_free (buf);
+}
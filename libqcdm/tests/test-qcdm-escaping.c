@@ -122,3 +122,141 @@ test_escape_unescape (void *f, void *data)
     g_assert (memcmp (unescaped, data1, unlen) == 0);
 }
 
+
+static void
+random_frame (char *buf, gsize len, guint special_every)
+{
+    gsize i;
+
+    for (i = 0; i < len; i++) {
+        if (special_every && g_random_int_range (0, special_every) == 0)
+            buf[i] = g_random_boolean () ? DIAG_CONTROL_CHAR : DIAG_ESC_CHAR;
+        else
+            buf[i] = g_random_int_range (0, 0x7D);
+    }
+}
+
+void
+test_escape_in_place (void *f, void *data)
+{
+    char src[600];
+    char copy[610];
+    char inplace[1300];
+    char outbuf[1300];
+    gsize len, enc_len, inplace_len;
+    guint i;
+
+    for (i = 0; i < 500; i++) {
+        len = g_random_int_range (1, sizeof (src));
+        random_frame (src, len, i % 4 ? 1 << (i % 4) : 0);
+
+        /* Same result as escaping into a separate buffer */
+        memcpy (copy, src, len);
+        enc_len = dm_encapsulate_buffer (copy, len, sizeof (copy), outbuf, sizeof (outbuf));
+        g_assert (enc_len > 0);
+
+        memcpy (inplace, src, len);
+        inplace_len = hdlc_encapsulate_in_place (inplace, len, sizeof (inplace),
+                                                 DM_CRC16_INIT, TRUE, FALSE);
+        g_assert_cmpuint (inplace_len, ==, enc_len);
+        g_assert (memcmp (inplace, outbuf, enc_len) == 0);
+
+        /* And fails cleanly when the buffer is one byte short */
+        memcpy (inplace, src, len);
+        g_assert_cmpuint (hdlc_encapsulate_in_place (inplace, len, enc_len - 1,
+                                                     DM_CRC16_INIT, TRUE, FALSE), ==, 0);
+    }
+}
+
+/* Byte-at-a-time references, as escaping was done before the vector scan */
+static gsize
+reference_escape (const char *inbuf, gsize inbuf_len, char *outbuf)
+{
+    char *dst = outbuf;
+
+    while (inbuf_len--) {
+        if (*inbuf == DIAG_CONTROL_CHAR || *inbuf == DIAG_ESC_CHAR) {
+            *dst++ = DIAG_ESC_CHAR;
+            *dst++ = *inbuf ^ DIAG_ESC_MASK;
+        } else
+            *dst++ = *inbuf;
+        inbuf++;
+    }
+    return dst - outbuf;
+}
+
+static gsize
+reference_unescape (const char *inbuf, gsize inbuf_len, char *outbuf)
+{
+    gboolean escaping = FALSE;
+    gsize i, outsize = 0;
+
+    for (i = 0; i < inbuf_len; i++) {
+        if (escaping) {
+            outbuf[outsize++] = inbuf[i] ^ DIAG_ESC_MASK;
+            escaping = FALSE;
+        } else if (inbuf[i] == DIAG_ESC_CHAR)
+            escaping = TRUE;
+        else
+            outbuf[outsize++] = inbuf[i];
+    }
+    return outsize;
+}
+
+void
+test_escape_benchmark (void *f, void *data)
+{
+    const gsize size = 1024 * 1024;
+    const guint rounds = 100;
+    GTimer *timer;
+    char *src, *escaped, *unescaped;
+    gsize esc_len = 0, unesc_len = 0;
+    gdouble t_ref, t_new;
+    qcdmbool escaping;
+    guint i;
+
+    if (!g_test_perf ())
+        return;
+
+    /* Mostly plain data, as in typical log and NV responses */
+    src = g_malloc (size);
+    escaped = g_malloc (size * 2 + 1);
+    unescaped = g_malloc (size * 2 + 1);
+    random_frame (src, size, 200);
+
+    timer = g_timer_new ();
+    for (i = 0; i < rounds; i++)
+        esc_len = reference_escape (src, size, escaped);
+    t_ref = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < rounds; i++)
+        g_assert_cmpuint (dm_escape (src, size, escaped, size * 2 + 1), ==, esc_len);
+    t_new = g_timer_elapsed (timer, NULL);
+
+    g_test_minimized_result (t_new, "escape: %.0f MB/s (byte-at-a-time: %.0f MB/s)",
+                             (rounds * size) / t_new / 1e6,
+                             (rounds * size) / t_ref / 1e6);
+
+    g_timer_start (timer);
+    for (i = 0; i < rounds; i++)
+        unesc_len = reference_unescape (escaped, esc_len, unescaped);
+    t_ref = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < rounds; i++) {
+        escaping = FALSE;
+        g_assert_cmpuint (dm_unescape (escaped, esc_len, unescaped, size * 2 + 1, &escaping), ==, unesc_len);
+    }
+    t_new = g_timer_elapsed (timer, NULL);
+
+    g_assert (memcmp (unescaped, src, size) == 0);
+    g_test_minimized_result (t_new, "unescape: %.0f MB/s (byte-at-a-time: %.0f MB/s)",
+                             (rounds * esc_len) / t_new / 1e6,
+                             (rounds * esc_len) / t_ref / 1e6);
+
+    g_timer_destroy (timer);
+    g_free (src);
+    g_free (escaped);
+    g_free (unescaped);
+}
@@ -21,6 +21,7 @@
 #include "test-qcdm-result.h"
 #include "result.h"
 #include "result-private.h"
+#include "errors.h"
 
 #define TEST_TAG "test"
 
@@ -85,3 +86,49 @@ test_result_uint8_array (void *f, void *data)
     g_assert_cmpint (memcmp (tmp, array, tmp_len), ==, 0);
 }
 
+
+void
+test_result_many (void *f, void *data)
+{
+    static const char *keys[] = {
+        "k00", "k01", "k02", "k03", "k04", "k05", "k06", "k07", "k08", "k09",
+        "k10", "k11", "k12", "k13", "k14", "k15", "k16", "k17", "k18", "k19",
+        "k20", "k21", "k22", "k23", "k24", "k25", "k26", "k27", "k28", "k29"
+    };
+    u_int16_t array[300];
+    const u_int16_t *tmp_array = NULL;
+    const char *tmp_str = NULL;
+    char key[4];
+    size_t tmp_len = 0;
+    guint32 tmp = 0;
+    QcdmResult *result;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (array); i++)
+        array[i] = i * 3;
+
+    /* More values and data than fit inline in the result */
+    result = qcdm_result_new ();
+    qcdm_result_add_string (result, "str", "foobarblahblahblah");
+    for (i = 0; i < G_N_ELEMENTS (keys); i++)
+        qcdm_result_add_u32 (result, keys[i], i);
+    qcdm_result_add_u16_array (result, "array", array, G_N_ELEMENTS (array));
+
+    for (i = 0; i < G_N_ELEMENTS (keys); i++) {
+        /* Key lookups by a different pointer with the same contents */
+        memcpy (key, keys[i], sizeof (key));
+        g_assert_cmpint (qcdm_result_get_u32 (result, key, &tmp), ==, 0);
+        g_assert_cmpint (tmp, ==, i);
+    }
+
+    g_assert_cmpint (qcdm_result_get_string (result, "str", &tmp_str), ==, 0);
+    g_assert_cmpstr (tmp_str, ==, "foobarblahblahblah");
+
+    g_assert_cmpint (qcdm_result_get_u16_array (result, "array", &tmp_array, &tmp_len), ==, 0);
+    g_assert_cmpint (tmp_len, ==, G_N_ELEMENTS (array));
+    g_assert_cmpint (memcmp (tmp_array, array, sizeof (array)), ==, 0);
+
+    g_assert_cmpint (qcdm_result_get_u32 (result, "missing", &tmp), ==, -QCDM_ERROR_VALUE_NOT_FOUND);
+
+    qcdm_result_unref (result);
+}
@@ -23,6 +23,8 @@
 #include "test-qcdm-com.h"
 #include "test-qcdm-result.h"
 #include "test-qcdm-utils.h"
+#include "test-qcdm-capture.h"
+#include "test-qcdm-channel.h"
 
 typedef struct {
     gpointer com_data;
@@ -84,9 +86,11 @@ int main (int argc, char **argv)
 
     g_test_suite_add (suite, TESTCASE (test_crc16_1, NULL));
     g_test_suite_add (suite, TESTCASE (test_crc16_2, NULL));
+    g_test_suite_add (suite, TESTCASE (test_crc16_slices, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape1, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape2, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape_unescape, NULL));
+    g_test_suite_add (suite, TESTCASE (test_escape_in_place, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_decapsulate_buffer, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_encapsulate_buffer, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_decapsulate_sierra_cns, NULL));
@@ -94,6 +98,16 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_result_uint32, NULL));
     g_test_suite_add (suite, TESTCASE (test_result_uint8, NULL));
     g_test_suite_add (suite, TESTCASE (test_result_uint8_array, NULL));
+    g_test_suite_add (suite, TESTCASE (test_result_many, NULL));
+    g_test_suite_add (suite, TESTCASE (test_capture_log_packet, NULL));
+    g_test_suite_add (suite, TESTCASE (test_capture_write_read, NULL));
+    g_test_suite_add (suite, TESTCASE (test_capture_recover, NULL));
+    g_test_suite_add (suite, TESTCASE (test_channel_pipelining, NULL));
+    g_test_suite_add (suite, TESTCASE (test_channel_timeout_cancel, NULL));
+
+    /* Benchmarks, only run with -m perf */
+    g_test_suite_add (suite, TESTCASE (test_crc16_benchmark, NULL));
+    g_test_suite_add (suite, TESTCASE (test_escape_benchmark, NULL));
 
     /* Live tests */
     if (port) {
@@ -19,9 +19,14 @@
 #include <termios.h>
 #include <fcntl.h>
 #include <string.h>
+#include <stdlib.h>
 
 #include "com.h"
 #include "errors.h"
+#include "protocol.h"
+
+/* libqcdm's own errors.h, shadowed by ours in the include path */
+#include "../../libqcdm/src/errors.h"
 
 int
 wmc_port_setup (int fd)
@@ -54,3 +59,127 @@ wmc_port_setup (int fd)
     return 0;
 }
 
+
+static wmcbool
+channel_decapsulate (const char *inbuf,
+                     size_t inbuf_len,
+                     char *outbuf,
+                     size_t outbuf_len,
+                     size_t *out_decap_len,
+                     size_t *out_used,
+                     wmcbool *out_need_more,
+                     void *user_data)
+{
+    return wmc_decapsulate (inbuf, inbuf_len, outbuf, outbuf_len,
+                            out_decap_len, out_used, out_need_more,
+                            user_data ? TRUE : FALSE);
+}
+
+/* QcdmChannel reports libqcdm errors; callers of the WMC channel only ever
+ * see WMC ones */
+static int
+channel_error_to_wmc (int error)
+{
+    switch (error) {
+    case QCDM_SUCCESS:
+        return WMC_SUCCESS;
+    case -QCDM_ERROR_INVALID_ARGUMENTS:
+        return -WMC_ERROR_INVALID_ARGUMENTS;
+    case -QCDM_ERROR_SERIAL_CONFIG_FAILED:
+        return -WMC_ERROR_SERIAL_CONFIG_FAILED;
+    case -QCDM_ERROR_TIMEOUT:
+        return -WMC_ERROR_TIMEOUT;
+    case -QCDM_ERROR_CANCELLED:
+        return -WMC_ERROR_CANCELLED;
+    case -QCDM_ERROR_PORT_IO_FAILED:
+    default:
+        return -WMC_ERROR_PORT_IO_FAILED;
+    }
+}
+
+QcdmChannel *
+wmc_channel_new (int fd, wmcbool uml290, int *out_error)
+{
+    QcdmChannel *channel;
+    int error = QCDM_SUCCESS;
+
+    channel = qcdm_channel_new_full (fd,
+                                     channel_decapsulate,
+                                     uml290 ? (void *) 1 : NULL,
+                                     &error);
+    if (out_error)
+        *out_error = channel_error_to_wmc (error);
+    return channel;
+}
+
+typedef struct {
+    WmcChannelResponseFn callback;
+    void *user_data;
+} ChannelRequest;
+
+static void
+channel_request_done (QcdmChannel *channel,
+                      int error,
+                      const char *response,
+                      size_t len,
+                      void *user_data)
+{
+    ChannelRequest *req = user_data;
+
+    req->callback (channel, channel_error_to_wmc (error), response, len, req->user_data);
+    free (req);
+}
+
+#define AT_WMC_PREFIX "AT*WMC="
+
+int
+wmc_channel_submit (QcdmChannel *channel,
+                    const char *command,
+                    size_t len,
+                    u_int32_t timeout_msecs,
+                    WmcChannelResponseFn callback,
+                    void *user_data)
+{
+    ChannelRequest *req;
+    char match[2];
+    size_t i = 0, n = 0;
+    wmcbool escaping = FALSE;
+    int id;
+
+    wmc_return_val_if_fail (channel != NULL, -WMC_ERROR_INVALID_ARGUMENTS);
+    wmc_return_val_if_fail (command != NULL, -WMC_ERROR_INVALID_ARGUMENTS);
+    wmc_return_val_if_fail (callback != NULL, -WMC_ERROR_INVALID_ARGUMENTS);
+
+    /* Responses echo the marker and the command byte */
+    if (len > strlen (AT_WMC_PREFIX) && !memcmp (command, AT_WMC_PREFIX, strlen (AT_WMC_PREFIX)))
+        i = strlen (AT_WMC_PREFIX);
+    for (; i < len && n < sizeof (match); i++) {
+        char c = command[i];
+
+        if (escaping) {
+            c ^= HDLC_ESC_MASK;
+            escaping = FALSE;
+        } else if (c == (char) HDLC_ESC_CHAR) {
+            escaping = TRUE;
+            continue;
+        }
+        match[n++] = c;
+    }
+    wmc_return_val_if_fail (n == sizeof (match), -WMC_ERROR_INVALID_ARGUMENTS);
+    wmc_return_val_if_fail ((u_int8_t) match[0] == WMC_CMD_MARKER, -WMC_ERROR_INVALID_ARGUMENTS);
+
+    req = malloc (sizeof (ChannelRequest));
+    if (!req)
+        return -WMC_ERROR_PORT_IO_FAILED;
+    req->callback = callback;
+    req->user_data = user_data;
+
+    id = qcdm_channel_submit (channel, command, len, match, sizeof (match),
+                              timeout_msecs, channel_request_done, req);
+    if (id < 0) {
+        /* Not queued, so the callback won't run */
+        free (req);
+        return channel_error_to_wmc (id);
+    }
+    return id;
+}
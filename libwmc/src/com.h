@@ -18,6 +18,38 @@
 #ifndef LIBWMC_COM_H
 #define LIBWMC_COM_H
 
+#include "utils.h"
+#include "channel.h"
+
 int wmc_port_setup (int fd);
 
+/* Non-blocking WMC requests, pipelined over libqcdm's QcdmChannel; responses
+ * are matched on the WMC command and passed to the callback decapsulated,
+ * ready for the wmc_cmd_*_result() functions.  The channel is driven with
+ * the qcdm_channel_*() functions, which report libqcdm errors; everything
+ * reported through the functions below uses WMC_ERROR_* values.
+ */
+QcdmChannel *wmc_channel_new (int fd, wmcbool uml290, int *out_error);
+
+/* 'error' is WMC_SUCCESS with the decapsulated response, or a negative
+ * WMC_ERROR_* value with a NULL response on timeout, cancellation or I/O
+ * failure.
+ */
+typedef void (*WmcChannelResponseFn) (QcdmChannel *channel,
+                                      int error,
+                                      const char *response,
+                                      size_t len,
+                                      void *user_data);
+
+/* 'command' is a command from wmc_cmd_*_new(), already passed through
+ * wmc_encapsulate() with the same 'uml290' setting as the channel.
+ * Returns a positive request ID for qcdm_channel_cancel(), or a negative error.
+ */
+int wmc_channel_submit (QcdmChannel *channel,
+                        const char *command,
+                        size_t len,
+                        u_int32_t timeout_msecs,
+                        WmcChannelResponseFn callback,
+                        void *user_data);
+
 #endif  /* LIBWMC_COM_H */
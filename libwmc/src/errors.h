@@ -38,6 +38,9 @@ enum {
     WMC_ERROR_VALUE_NOT_FOUND = 3,
     WMC_ERROR_RESPONSE_UNEXPECTED = 4,
     WMC_ERROR_RESPONSE_BAD_LENGTH = 5,
+    WMC_ERROR_TIMEOUT = 6,                /* no response in time */
+    WMC_ERROR_CANCELLED = 7,              /* request cancelled before completion */
+    WMC_ERROR_PORT_IO_FAILED = 8,         /* reading or writing the port failed */
 };
 
 #define wmc_assert assert
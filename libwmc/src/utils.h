@@ -20,6 +20,8 @@
 
 #include <sys/types.h>
 
+#include "hdlc.h"
+
 typedef u_int8_t wmcbool;
 #ifndef TRUE
 #define TRUE ((u_int8_t) 1)
@@ -28,44 +30,13 @@ typedef u_int8_t wmcbool;
 #define FALSE ((u_int8_t) 0)
 #endif
 
-#define DIAG_CONTROL_CHAR 0x7E
+#define DIAG_CONTROL_CHAR HDLC_CONTROL_CHAR
 #define DIAG_TRAILER_LEN  3
 
 /* Utility and testcase functions */
 
 u_int16_t wmc_crc16 (const char *buffer, size_t len, u_int16_t seed);
 
-size_t hdlc_escape (const char *inbuf,
-                    size_t inbuf_len,
-                    wmcbool escape_all_ctrl,
-                    char *outbuf,
-                    size_t outbuf_len);
-
-size_t hdlc_unescape (const char *inbuf,
-                      size_t inbuf_len,
-                      char *outbuf,
-                      size_t outbuf_len,
-                      wmcbool *escaping);
-
-size_t hdlc_encapsulate_buffer (char *inbuf,
-                                size_t cmd_len,
-                                size_t inbuf_len,
-                                u_int16_t crc_seed,
-                                wmcbool add_trailer,
-                                wmcbool escape_all_ctrl,
-                                char *outbuf,
-                                size_t outbuf_len);
-
-wmcbool hdlc_decapsulate_buffer (const char *inbuf,
-                                 size_t inbuf_len,
-                                 wmcbool check_known_crc,
-                                 u_int16_t known_crc,
-                                 char *outbuf,
-                                 size_t outbuf_len,
-                                 size_t *out_decap_len,
-                                 size_t *out_used,
-                                 wmcbool *out_need_more);
-
 /* Functions for actual communication */
 
 size_t wmc_encapsulate (char *inbuf,
@@ -0,0 +1,207 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * Copyright (C) 2012 Google, Inc.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of version 2 of the GNU General Public
+ * License as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "test-wmc-channel.h"
+#include "com.h"
+#include "commands.h"
+#include "errors.h"
+#include "protocol.h"
+#include "utils.h"
+
+typedef struct {
+    int error;
+    char response[64];
+    size_t len;
+    guint order;
+} Reply;
+
+static guint completed;
+
+static void
+reply_cb (QcdmChannel *channel,
+          int error,
+          const char *response,
+          size_t len,
+          void *user_data)
+{
+    Reply *reply = user_data;
+
+    g_assert (reply->order == 0);
+    reply->order = ++completed;
+    reply->error = error;
+    if (response) {
+        g_assert (len <= sizeof (reply->response));
+        memcpy (reply->response, response, len);
+        reply->len = len;
+    }
+}
+
+static int
+submit (QcdmChannel *channel,
+        size_t (*command_new) (char *buf, size_t buflen),
+        u_int32_t timeout_msecs,
+        Reply *reply)
+{
+    char raw[64], cmd[128];
+    size_t len;
+
+    len = command_new (raw, sizeof (raw));
+    g_assert (len > 0);
+    len = wmc_encapsulate (raw, len, sizeof (raw), cmd, sizeof (cmd), FALSE);
+    g_assert (len > 0);
+    return wmc_channel_submit (channel, cmd, len, timeout_msecs, reply_cb, reply);
+}
+
+/* Reads one command from the device side of the socket pair */
+static size_t
+device_read_command (int fd, char *cmd, size_t cmd_len)
+{
+    static char buf[512];
+    static size_t buf_len = 0;
+
+    for (;;) {
+        size_t decap_len = 0, used = 0;
+        wmcbool more = FALSE;
+        ssize_t n;
+
+        if (buf_len) {
+            g_assert (wmc_decapsulate (buf, buf_len, cmd, cmd_len,
+                                       &decap_len, &used, &more, FALSE));
+            if (!more) {
+                memmove (buf, buf + used, buf_len - used);
+                buf_len -= used;
+                return decap_len;
+            }
+        }
+
+        n = read (fd, buf + buf_len, sizeof (buf) - buf_len);
+        g_assert (n > 0);
+        buf_len += n;
+    }
+}
+
+static void
+device_write_reply (int fd, const char *reply, size_t reply_len)
+{
+    char raw[64], frame[128];
+    size_t len;
+
+    memcpy (raw, reply, reply_len);
+    len = wmc_encapsulate (raw, reply_len, sizeof (raw), frame, sizeof (frame), FALSE);
+    g_assert (len > 0);
+    g_assert_cmpint (write (fd, frame, len), ==, (ssize_t) len);
+}
+
+void
+test_channel_match (void *f, void *data)
+{
+    QcdmChannel *channel;
+    Reply replies[2];
+    char cmds[2][64];
+    int fds[2], err = -1, i;
+    static const char mode_reply[] = { (char) WMC_CMD_MARKER, WMC_CMD_GET_GLOBAL_MODE, 0x00, 0x05 };
+    static const char info_reply[] = { (char) WMC_CMD_MARKER, WMC_CMD_DEVICE_INFO, 0x01, 0x02, 0x03 };
+
+    completed = 0;
+    memset (replies, 0, sizeof (replies));
+    g_assert (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    channel = wmc_channel_new (fds[0], FALSE, &err);
+    g_assert (channel);
+    g_assert_cmpint (err, ==, WMC_SUCCESS);
+
+    g_assert (submit (channel, wmc_cmd_device_info_new, 1000, &replies[0]) > 0);
+    g_assert (submit (channel, wmc_cmd_get_global_mode_new, 1000, &replies[1]) > 0);
+
+    /* Flush the writes */
+    qcdm_channel_poll (&channel, 1, 0);
+    for (i = 0; i < 2; i++) {
+        device_read_command (fds[1], cmds[i], sizeof (cmds[i]));
+        g_assert_cmpint ((u_int8_t) cmds[i][0], ==, WMC_CMD_MARKER);
+    }
+    g_assert_cmpint ((u_int8_t) cmds[0][1], ==, WMC_CMD_DEVICE_INFO);
+    g_assert_cmpint ((u_int8_t) cmds[1][1], ==, WMC_CMD_GET_GLOBAL_MODE);
+
+    /* Answered out of order; matched on the command byte */
+    device_write_reply (fds[1], mode_reply, sizeof (mode_reply));
+    device_write_reply (fds[1], info_reply, sizeof (info_reply));
+    while (qcdm_channel_get_pending (channel))
+        g_assert (qcdm_channel_poll (&channel, 1, 1000) >= 0);
+
+    g_assert_cmpint (replies[1].order, ==, 1);
+    g_assert_cmpint (replies[1].error, ==, WMC_SUCCESS);
+    g_assert_cmpint (replies[1].len, ==, sizeof (mode_reply));
+    g_assert (memcmp (replies[1].response, mode_reply, sizeof (mode_reply)) == 0);
+    g_assert_cmpint (replies[0].order, ==, 2);
+    g_assert_cmpint (replies[0].error, ==, WMC_SUCCESS);
+    g_assert_cmpint (replies[0].len, ==, sizeof (info_reply));
+    g_assert (memcmp (replies[0].response, info_reply, sizeof (info_reply)) == 0);
+
+    qcdm_channel_free (channel);
+    close (fds[0]);
+    close (fds[1]);
+}
+
+void
+test_channel_errors (void *f, void *data)
+{
+    QcdmChannel *channel;
+    Reply replies[3];
+    char cmd[64];
+    int fds[2], id;
+    static const char not_wmc[] = { 0x01, 0x02, 0x03, 0x7E };
+
+    completed = 0;
+    memset (replies, 0, sizeof (replies));
+    g_assert (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    channel = wmc_channel_new (fds[0], FALSE, NULL);
+    g_assert (channel);
+
+    /* Only WMC commands can be matched */
+    g_assert_cmpint (wmc_channel_submit (channel, not_wmc, sizeof (not_wmc), 1000, reply_cb, &replies[0]),
+                     ==, -WMC_ERROR_INVALID_ARGUMENTS);
+
+    /* Errors from the channel are reported as WMC errors, not libqcdm ones */
+    id = submit (channel, wmc_cmd_device_info_new, 5000, &replies[0]);
+    g_assert (id > 0);
+    g_assert (qcdm_channel_cancel (channel, id));
+    g_assert_cmpint (replies[0].order, ==, 1);
+    g_assert_cmpint (replies[0].error, ==, -WMC_ERROR_CANCELLED);
+
+    g_assert (submit (channel, wmc_cmd_get_global_mode_new, 100, &replies[1]) > 0);
+    qcdm_channel_poll (&channel, 1, 0);
+    device_read_command (fds[1], cmd, sizeof (cmd));
+    while (qcdm_channel_get_pending (channel))
+        qcdm_channel_poll (&channel, 1, 1000);
+    g_assert_cmpint (replies[1].order, ==, 2);
+    g_assert_cmpint (replies[1].error, ==, -WMC_ERROR_TIMEOUT);
+
+    /* Outstanding requests are cancelled when the channel goes away */
+    g_assert (submit (channel, wmc_cmd_device_info_new, 0, &replies[2]) > 0);
+    qcdm_channel_free (channel);
+    g_assert_cmpint (replies[2].order, ==, 3);
+    g_assert_cmpint (replies[2].error, ==, -WMC_ERROR_CANCELLED);
+
+    close (fds[0]);
+    close (fds[1]);
+}
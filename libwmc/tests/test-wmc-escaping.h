@@ -23,6 +23,8 @@ void test_escape2 (void *f, void *data);
 void test_escape_ctrl (void *f, void *data);
 void test_escape_unescape (void *f, void *data);
 void test_escape_unescape_ctrl (void *f, void *data);
+void test_escape_ctrl_random (void *f, void *data);
+void test_escape_ctrl_benchmark (void *f, void *data);
 
 #endif  /* TEST_WMC_ESCAPING_H */
 
@@ -22,6 +22,7 @@
 #include "test-wmc-escaping.h"
 #include "test-wmc-utils.h"
 #include "test-wmc-com.h"
+#include "test-wmc-channel.h"
 
 typedef struct {
     gpointer com_data;
@@ -91,11 +92,17 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_escape_ctrl, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape_unescape, NULL));
     g_test_suite_add (suite, TESTCASE (test_escape_unescape_ctrl, NULL));
+    g_test_suite_add (suite, TESTCASE (test_escape_ctrl_random, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_decapsulate_basic_buffer, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_encapsulate_basic_buffer, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_decapsulate_sierra_cns, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_decapsulate_uml290_wmc1, NULL));
     g_test_suite_add (suite, TESTCASE (test_utils_decapsulate_pc5740_wmc1, NULL));
+    g_test_suite_add (suite, TESTCASE (test_channel_match, NULL));
+    g_test_suite_add (suite, TESTCASE (test_channel_errors, NULL));
+
+    /* Benchmarks, only run with -m perf */
+    g_test_suite_add (suite, TESTCASE (test_escape_ctrl_benchmark, NULL));
 
     /* Live tests */
     if (port) {
@@ -50,15 +50,21 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", NULL };
+static const guint16 vendor_ids[] = { 0x16d5, 0 };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = "AnyDATA",
+    .subsystems = subsystems,
+    .vendor_ids = vendor_ids,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", NULL };
-    static const guint16 vendor_ids[] = { 0x16d5, 0 };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_ANYDATA,
-                      MM_PLUGIN_NAME,               "AnyDATA",
+                      MM_PLUGIN_NAME,               mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_VENDOR_IDS, vendor_ids,
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
@@ -27,6 +27,7 @@
 #include "mm-modem-helpers.h"
 #include "mm-serial-parsers.h"
 #include "mm-log.h"
+#include "mm-regex-cache.h"
 #include "mm-errors-types.h"
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
@@ -351,9 +352,9 @@ smong_query_ready (MMBroadbandModemCinterion *self,
      * 0776  1  -      -   214   03  2    00      01
      * OK
      */
-    regex = g_regex_new (".*GPRS Monitor\\r\\n"
-                         "BCCH\\s*G.*\\r\\n"
-                         "(\\d*)\\s*(\\d*)\\s*", 0, 0, NULL);
+    regex = mm_regex_cache_get (".*GPRS Monitor\\r\\n"
+                                "BCCH\\s*G.*\\r\\n"
+                                "(\\d*)\\s*(\\d*)\\s*", 0, 0, NULL);
     if (g_regex_match_full (regex, response, strlen (response), 0, 0, &match_info, NULL)) {
         gchar *gprs_status;
         MMModemAccessTechnology act;
@@ -453,7 +454,7 @@ sind_query_ready (MMBroadbandModemCinterion *self,
      * ^SIND: signal,1,99
      * ...
      */
-    regex = g_regex_new ("\\r\\n\\^SIND:\\s*psinfo,\\s*(\\d*),\\s*(\\d*)", 0, 0, NULL);
+    regex = mm_regex_cache_get ("\\r\\n\\^SIND:\\s*psinfo,\\s*(\\d*),\\s*(\\d*)", 0, 0, NULL);
     if (g_regex_match_full (regex, response, strlen (response), 0, 0, &match_info, NULL)) {
         MMModemAccessTechnology act;
         gchar *ind_value;
@@ -730,7 +731,7 @@ get_2g_band_ready (MMBroadbandModemCinterion *self,
      * Note that "0031" is a UCS2-encoded string, as we configured UCS2 as
      * character set to use.
      */
-    regex = g_regex_new ("\\^SCFG:\\s*\"Radio/Band\",\\s*\"(.*)\",\\s*\"(.*)\"", 0, 0, NULL);
+    regex = mm_regex_cache_get ("\\^SCFG:\\s*\"Radio/Band\",\\s*\"(.*)\",\\s*\"(.*)\"", 0, 0, NULL);
     g_assert (regex != NULL);
 
     if (g_regex_match_full (regex, response, strlen (response), 0, 0, &match_info, NULL)) {
@@ -811,7 +812,7 @@ get_3g_band_ready (MMBroadbandModemCinterion *self,
      *
      * Note that in this case, the <rba> replied is a number, not a string.
      */
-    regex = g_regex_new ("\\^SCFG:\\s*\"Radio/Band\",\\s*(\\d*)", 0, 0, NULL);
+    regex = mm_regex_cache_get ("\\^SCFG:\\s*\"Radio/Band\",\\s*(\\d*)", 0, 0, NULL);
     g_assert (regex != NULL);
 
     if (g_regex_match_full (regex, response, strlen (response), 0, 0, &match_info, NULL)) {
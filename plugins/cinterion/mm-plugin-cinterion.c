@@ -54,16 +54,23 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", NULL };
+static const gchar *vendor_strings[] = { "cinterion", "siemens", NULL };
+static const guint16 vendor_ids[] = { 0x1e2d, 0x0681, 0 };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name           = "Cinterion",
+    .subsystems     = subsystems,
+    .vendor_ids     = vendor_ids,
+    .vendor_strings = vendor_strings,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", NULL };
-    static const gchar *vendor_strings[] = { "cinterion", "siemens", NULL };
-    static const guint16 vendor_ids[] = { 0x1e2d, 0x0681, 0 };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_CINTERION,
-                      MM_PLUGIN_NAME,                   "Cinterion",
+                      MM_PLUGIN_NAME,                   mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS,     subsystems,
                       MM_PLUGIN_ALLOWED_VENDOR_STRINGS, vendor_strings,
                       MM_PLUGIN_ALLOWED_VENDOR_IDS,     vendor_ids,
@@ -73,14 +73,19 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", "net", "usb", NULL };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = MM_PLUGIN_GENERIC_NAME,
+    .subsystems = subsystems,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", "net", "usb", NULL };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_GENERIC,
-                      MM_PLUGIN_NAME,               MM_PLUGIN_GENERIC_NAME,
+                      MM_PLUGIN_NAME,               mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
                       MM_PLUGIN_ALLOWED_QCDM,       TRUE,
@@ -64,15 +64,21 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", "net", "usb", NULL };
+static const gchar *drivers[] = { "qcserial", NULL };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = "Gobi",
+    .subsystems = subsystems,
+    .drivers    = drivers,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", "net", "usb", NULL };
-    static const gchar *drivers[] = { "qcserial", NULL };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_GOBI,
-                      MM_PLUGIN_NAME,               "Gobi",
+                      MM_PLUGIN_NAME,               mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_DRIVERS,    drivers,
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
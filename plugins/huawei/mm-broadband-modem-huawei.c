@@ -33,6 +33,7 @@
 #include "mm-log.h"
 #include "mm-errors-types.h"
 #include "mm-modem-helpers.h"
+#include "mm-regex-cache.h"
 #include "mm-base-modem-at.h"
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
@@ -107,7 +108,7 @@ sysinfo_parse (const char *reply,
     GError *match_error = NULL;
 
     /* Can't just use \d here since sometimes you get "^SYSINFO:2,1,0,3,1,,3" */
-    r = g_regex_new ("\\^SYSINFO:\\s*(\\d+),(\\d+),(\\d+),(\\d+),(\\d+),?(\\d*),?(\\d*)$", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\^SYSINFO:\\s*(\\d+),(\\d+),(\\d+),(\\d+),(\\d+),?(\\d*),?(\\d*)$", 0, 0, NULL);
     g_assert (r != NULL);
 
     matched = g_regex_match_full (r, reply, -1, 0, 0, &match_info, &match_error);
@@ -294,8 +295,8 @@ load_unlock_retries_finish (MMIfaceModem *self,
     if (!result)
         return NULL;
 
-    r = g_regex_new ("\\^CPIN:\\s*([^,]+),[^,]*,(\\d+),(\\d+),(\\d+),(\\d+)",
-                     G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_cache_get ("\\^CPIN:\\s*([^,]+),[^,]*,(\\d+),(\\d+),(\\d+),(\\d+)",
+                            G_REGEX_UNGREEDY, 0, NULL);
     g_assert (r != NULL);
 
     if (!g_regex_match_full (r, result, strlen (result), 0, 0, &match_info, error)) {
@@ -2000,7 +2001,7 @@ modem_time_load_network_time_finish (MMIfaceModemTime *self,
         return NULL;
 
     /* Already in ISO-8601 format, but verify just to be sure */
-    r = g_regex_new ("\\^TIME:\\s*(\\d+)/(\\d+)/(\\d+)\\s*(\\d+):(\\d+):(\\d*)$", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\^TIME:\\s*(\\d+)/(\\d+)/(\\d+)\\s*(\\d+):(\\d+):(\\d*)$", 0, 0, NULL);
     g_assert (r != NULL);
 
     if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
@@ -2180,31 +2181,31 @@ mm_broadband_modem_huawei_init (MMBroadbandModemHuawei *self)
                                               MM_TYPE_BROADBAND_MODEM_HUAWEI,
                                               MMBroadbandModemHuaweiPrivate);
     /* Prepare regular expressions to setup */
-    self->priv->rssi_regex = g_regex_new ("\\r\\n\\^RSSI:(\\d+)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->rssilvl_regex = g_regex_new ("\\r\\n\\^RSSILVL:(\\d+)\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->hrssilvl_regex = g_regex_new ("\\r\\n\\^HRSSILVL:(\\d+)\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->rssi_regex = mm_regex_cache_get ("\\r\\n\\^RSSI:(\\d+)\\r\\n",
+                                                  G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->rssilvl_regex = mm_regex_cache_get ("\\r\\n\\^RSSILVL:(\\d+)\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->hrssilvl_regex = mm_regex_cache_get ("\\r\\n\\^HRSSILVL:(\\d+)\\r\\n",
+                                                     G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
 
     /* 3GPP: <cr><lf>^MODE:5<cr><lf>
      * CDMA: <cr><lf>^MODE: 2<cr><cr><lf>
      */
-    self->priv->mode_regex = g_regex_new ("\\r\\n\\^MODE:\\s*(\\d*),?(\\d*)\\r+\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-
-    self->priv->dsflowrpt_regex = g_regex_new ("\\r\\n\\^DSFLOWRPT:(.+)\\r\\n",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->boot_regex = g_regex_new ("\\r\\n\\^BOOT:.+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->csnr_regex = g_regex_new ("\\r\\n\\^CSNR:.+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->simst_regex = g_regex_new ("\\r\\n\\^SIMST:.+\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->srvst_regex = g_regex_new ("\\r\\n\\^SRVST:.+\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->stin_regex = g_regex_new ("\\r\\n\\^STIN:.+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->mode_regex = mm_regex_cache_get ("\\r\\n\\^MODE:\\s*(\\d*),?(\\d*)\\r+\\n",
+                                                 G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+
+    self->priv->dsflowrpt_regex = mm_regex_cache_get ("\\r\\n\\^DSFLOWRPT:(.+)\\r\\n",
+                                                      G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->boot_regex = mm_regex_cache_get ("\\r\\n\\^BOOT:.+\\r\\n",
+                                                 G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->csnr_regex = mm_regex_cache_get ("\\r\\n\\^CSNR:.+\\r\\n",
+                                                 G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->simst_regex = mm_regex_cache_get ("\\r\\n\\^SIMST:.+\\r\\n",
+                                                  G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->srvst_regex = mm_regex_cache_get ("\\r\\n\\^SRVST:.+\\r\\n",
+                                                  G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->stin_regex = mm_regex_cache_get ("\\r\\n\\^STIN:.+\\r\\n",
+                                                 G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
 
     self->priv->ndisdup_support = NDISDUP_SUPPORT_UNKNOWN;
 }
@@ -489,11 +489,18 @@ grab_port (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", "net", "usb", NULL };
+static const guint16 vendor_ids[] = { 0x12d1, 0 };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = "Huawei",
+    .subsystems = subsystems,
+    .vendor_ids = vendor_ids,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", "net", "usb", NULL };
-    static const guint16 vendor_ids[] = { 0x12d1, 0 };
     static const MMAsyncMethod custom_init = {
         .async  = G_CALLBACK (huawei_custom_init),
         .finish = G_CALLBACK (huawei_custom_init_finish),
@@ -501,7 +508,7 @@ mm_plugin_create (void)
 
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_HUAWEI,
-                      MM_PLUGIN_NAME,               "Huawei",
+                      MM_PLUGIN_NAME,               mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_VENDOR_IDS, vendor_ids,
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
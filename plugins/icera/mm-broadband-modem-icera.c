@@ -27,6 +27,7 @@
 #include "mm-serial-parsers.h"
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
+#include "mm-regex-cache.h"
 #include "mm-errors-types.h"
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
@@ -975,9 +976,9 @@ parse_bands (const gchar *response, guint32 *out_len)
      *   ...
      * with 1 and 0 indicating whether the particular band is enabled or not.
      */
-    r = g_regex_new ("^\"(\\w+)\": (\\d)",
-                     G_REGEX_MULTILINE, G_REGEX_MATCH_NEWLINE_ANY,
-                     NULL);
+    r = mm_regex_cache_get ("^\"(\\w+)\": (\\d)",
+                            G_REGEX_MULTILINE, G_REGEX_MATCH_NEWLINE_ANY,
+                            NULL);
     g_assert (r != NULL);
 
     g_regex_match (r, response, 0, &info);
@@ -1640,12 +1641,12 @@ mm_broadband_modem_icera_init (MMBroadbandModemIcera *self)
                                               MM_TYPE_BROADBAND_MODEM_ICERA,
                                               MMBroadbandModemIceraPrivate);
 
-    self->priv->nwstate_regex = g_regex_new ("%NWSTATE:\\s*(-?\\d+),(\\d+),([^,]*),([^,]*),(\\d+)",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->pacsp_regex = g_regex_new ("\\r\\n\\+PACSP(\\d)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ipdpact_regex = g_regex_new ("\\r\\n%IPDPACT:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->nwstate_regex = mm_regex_cache_get ("%NWSTATE:\\s*(-?\\d+),(\\d+),([^,]*),([^,]*),(\\d+)",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->pacsp_regex = mm_regex_cache_get ("\\r\\n\\+PACSP(\\d)\\r\\n",
+                                                  G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->ipdpact_regex = mm_regex_cache_get ("\\r\\n%IPDPACT:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
 
     self->priv->default_ip_method = MM_BEARER_IP_METHOD_STATIC;
     self->priv->last_act = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
@@ -54,19 +54,27 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", NULL };
+static const guint16 vendor_ids[] = { 0x1edd, 0 };
+static const gchar *vendor_strings[] = { "iridium", NULL };
+/* Also support motorola-branded Iridium modems */
+static const mm_str_pair product_strings[] = {{"motorola", "satellite" },
+                                              { NULL, NULL }};
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name            = "Iridium",
+    .subsystems      = subsystems,
+    .vendor_ids      = vendor_ids,
+    .vendor_strings  = vendor_strings,
+    .product_strings = product_strings,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", NULL };
-    static const guint16 vendor_ids[] = { 0x1edd, 0 };
-    static const gchar *vendor_strings[] = { "iridium", NULL };
-    /* Also support motorola-branded Iridium modems */
-    static const mm_str_pair product_strings[] = {{"motorola", "satellite" },
-                                                  { NULL, NULL }};
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_IRIDIUM,
-                      MM_PLUGIN_NAME,                    "Iridium",
+                      MM_PLUGIN_NAME,                    mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS,      subsystems,
                       MM_PLUGIN_ALLOWED_VENDOR_STRINGS,  vendor_strings,
                       MM_PLUGIN_ALLOWED_PRODUCT_STRINGS, product_strings,
@@ -235,19 +235,27 @@ grab_port (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", NULL };
+/* Vendors: Longcheer and TAMobile */
+static const guint16 vendor_ids[] = { 0x1c9e, 0x1bbb, 0 };
+/* Some TAMobile devices are different chipsets and should be handled
+ * by other plugins, so only handle LONGCHEER tagged devices here.
+ */
+static const gchar *udev_tags[] = {
+    "ID_MM_LONGCHEER_TAGGED",
+    NULL
+};
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = "Longcheer",
+    .subsystems = subsystems,
+    .vendor_ids = vendor_ids,
+    .udev_tags  = udev_tags,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", NULL };
-    /* Vendors: Longcheer and TAMobile */
-    static const guint16 vendor_ids[] = { 0x1c9e, 0x1bbb, 0 };
-    /* Some TAMobile devices are different chipsets and should be handled
-     * by other plugins, so only handle LONGCHEER tagged devices here.
-     */
-    static const gchar *udev_tags[] = {
-        "ID_MM_LONGCHEER_TAGGED",
-        NULL
-    };
     static const MMAsyncMethod custom_init = {
         .async  = G_CALLBACK (longcheer_custom_init),
         .finish = G_CALLBACK (longcheer_custom_init_finish),
@@ -255,7 +263,7 @@ mm_plugin_create (void)
 
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_LONGCHEER,
-                      MM_PLUGIN_NAME,               "Longcheer",
+                      MM_PLUGIN_NAME,               mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_VENDOR_IDS, vendor_ids,
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
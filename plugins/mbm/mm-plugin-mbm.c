@@ -52,18 +52,24 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", "net", NULL };
+static const gchar *udev_tags[] = {
+    "ID_MM_ERICSSON_MBM",
+    NULL
+};
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = "Ericsson MBM",
+    .subsystems = subsystems,
+    .udev_tags  = udev_tags,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", "net", NULL };
-    static const gchar *udev_tags[] = {
-        "ID_MM_ERICSSON_MBM",
-        NULL
-    };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_MBM,
-                      MM_PLUGIN_NAME,               "Ericsson MBM",
+                      MM_PLUGIN_NAME,               mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_UDEV_TAGS,  udev_tags,
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
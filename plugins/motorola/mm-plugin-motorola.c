@@ -50,19 +50,25 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", NULL };
+static const mm_uint16_pair product_ids[] = {
+    { 0x22b8, 0x3802 }, /* C330/C350L/C450/EZX GSM Phone */
+    { 0x22b8, 0x4902 }, /* Triplet GSM Phone */
+    { 0, 0 }
+};
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name        = "Motorola",
+    .subsystems  = subsystems,
+    .product_ids = product_ids,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", NULL };
-    static const mm_uint16_pair product_ids[] = {
-        { 0x22b8, 0x3802 }, /* C330/C350L/C450/EZX GSM Phone */
-        { 0x22b8, 0x4902 }, /* Triplet GSM Phone */
-        { 0, 0 }
-    };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_MOTOROLA,
-                      MM_PLUGIN_NAME,                "Motorola",
+                      MM_PLUGIN_NAME,                mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS,  subsystems,
                       MM_PLUGIN_ALLOWED_PRODUCT_IDS, product_ids,
                       MM_PLUGIN_ALLOWED_AT,          TRUE,
@@ -86,15 +86,21 @@ grab_port (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", "net", NULL };
+static const guint16 vendor_ids[] = { 0x0421, 0 };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = "Nokia (Icera)",
+    .subsystems = subsystems,
+    .vendor_ids = vendor_ids,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", "net", NULL };
-    static const guint16 vendor_ids[] = { 0x0421, 0 };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_NOKIA_ICERA,
-                      MM_PLUGIN_NAME,               "Nokia (Icera)",
+                      MM_PLUGIN_NAME,               mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_VENDOR_IDS, vendor_ids,
                       MM_PLUGIN_CUSTOM_AT_PROBE,    custom_at_probe,
@@ -60,16 +60,23 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", NULL };
+static const guint16 vendor_ids[] = { 0x0421, 0 };
+static const gchar *vendor_strings[] = { "nokia", NULL };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name           = "Nokia",
+    .subsystems     = subsystems,
+    .vendor_ids     = vendor_ids,
+    .vendor_strings = vendor_strings,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", NULL };
-    static const guint16 vendor_ids[] = { 0x0421, 0 };
-    static const gchar *vendor_strings[] = { "nokia", NULL };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_NOKIA,
-                      MM_PLUGIN_NAME,                   "Nokia",
+                      MM_PLUGIN_NAME,                   mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS,     subsystems,
                       MM_PLUGIN_ALLOWED_VENDOR_IDS,     vendor_ids,
                       MM_PLUGIN_ALLOWED_VENDOR_STRINGS, vendor_strings,
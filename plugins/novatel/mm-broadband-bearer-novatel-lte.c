@@ -30,6 +30,7 @@
 #include "mm-base-modem-at.h"
 #include "mm-broadband-bearer-novatel-lte.h"
 #include "mm-log.h"
+#include "mm-timer-wheel.h"
 #include "mm-modem-helpers.h"
 
 #define CONNECTION_CHECK_TIMEOUT_SEC 5
@@ -155,7 +156,7 @@ poll_connection_ready (MMBaseModem *modem,
 
     if (is_qmistatus_disconnected (result)) {
         mm_bearer_report_disconnection (MM_BEARER (bearer));
-        g_source_remove (bearer->priv->connection_poller);
+        mm_timer_wheel_remove (bearer->priv->connection_poller);
         bearer->priv->connection_poller = 0;
     }
 }
@@ -204,9 +205,10 @@ connect_3gpp_qmistatus_ready (MMBaseModem *modem,
         MMBearerIpConfig *config;
 
         mm_dbg("Connected");
-        ctx->self->priv->connection_poller = g_timeout_add_seconds (CONNECTION_CHECK_TIMEOUT_SEC,
-                                                                    (GSourceFunc)poll_connection,
-                                                                    ctx->self);
+        ctx->self->priv->connection_poller = mm_timer_wheel_add_seconds (CONNECTION_CHECK_TIMEOUT_SEC,
+                                                                         MM_TIMER_WHEEL_PERIODIC_COALESCE_SEC,
+                                                                         (GSourceFunc)poll_connection,
+                                                                         ctx->self);
         config = mm_bearer_ip_config_new ();
         mm_bearer_ip_config_set_method (config, MM_BEARER_IP_METHOD_DHCP);
         g_simple_async_result_set_op_res_gpointer (ctx->result,
@@ -473,7 +475,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
     MMBroadbandBearerNovatelLte *bearer = MM_BROADBAND_BEARER_NOVATEL_LTE (self);
 
     if (bearer->priv->connection_poller) {
-        g_source_remove (bearer->priv->connection_poller);
+        mm_timer_wheel_remove (bearer->priv->connection_poller);
         bearer->priv->connection_poller = 0;
     }
 
@@ -545,7 +547,7 @@ finalize (GObject *object)
     MMBroadbandBearerNovatelLte *self = MM_BROADBAND_BEARER_NOVATEL_LTE (object);
 
     if (self->priv->connection_poller)
-        g_source_remove (self->priv->connection_poller);
+        mm_timer_wheel_remove (self->priv->connection_poller);
 
     G_OBJECT_CLASS (mm_broadband_bearer_novatel_lte_parent_class)->finalize (object);
 }
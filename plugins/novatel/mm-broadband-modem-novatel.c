@@ -35,6 +35,7 @@
 #include "libqcdm/src/commands.h"
 #include "libqcdm/src/result.h"
 #include "mm-log.h"
+#include "mm-regex-cache.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_messaging_init (MMIfaceModemMessaging *iface);
@@ -96,7 +97,7 @@ nwrat_query_ready (MMBaseModem *self,
     }
 
     /* Parse response */
-    r = g_regex_new ("\\$NWRAT:\\s*(\\d),(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_cache_get ("\\$NWRAT:\\s*(\\d),(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
     g_assert (r != NULL);
 
     if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &error)) {
@@ -51,16 +51,22 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", "net", NULL };
+static const mm_uint16_pair products[] = { { 0x1410, 0x9010 }, /* Novatel E362 */
+                                           {0, 0} };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name        = "Novatel LTE",
+    .subsystems  = subsystems,
+    .product_ids = products,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", "net", NULL };
-    static const mm_uint16_pair products[] = { { 0x1410, 0x9010 }, /* Novatel E362 */
-                                               {0, 0} };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_NOVATEL_LTE,
-                      MM_PLUGIN_NAME,                "Novatel LTE",
+                      MM_PLUGIN_NAME,                mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS,  subsystems,
                       MM_PLUGIN_ALLOWED_PRODUCT_IDS, products,
                       MM_PLUGIN_ALLOWED_SINGLE_AT,   TRUE,
@@ -52,20 +52,28 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", NULL };
+static const guint16 vendors[] = { 0x1410, /* Novatel */
+                                   0x413c, /* Dell */
+                                   0 };
+static const mm_uint16_pair forbidden_products[] = { { 0x1410, 0x9010 }, /* Novatel E362 */
+                                                     {0, 0} };
+static const gchar *drivers[] = { "option1", "option", NULL };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name                  = "Novatel",
+    .subsystems            = subsystems,
+    .drivers               = drivers,
+    .vendor_ids            = vendors,
+    .forbidden_product_ids = forbidden_products,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", NULL };
-    static const guint16 vendors[] = { 0x1410, /* Novatel */
-                                       0x413c, /* Dell */
-                                       0 };
-    static const mm_uint16_pair forbidden_products[] = { { 0x1410, 0x9010 }, /* Novatel E362 */
-                                                         {0, 0} };
-    static const gchar *drivers[] = { "option1", "option", NULL };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_NOVATEL,
-                      MM_PLUGIN_NAME,                  "Novatel",
+                      MM_PLUGIN_NAME,                  mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS,    subsystems,
                       MM_PLUGIN_ALLOWED_DRIVERS,       drivers,
                       MM_PLUGIN_ALLOWED_VENDOR_IDS,    vendors,
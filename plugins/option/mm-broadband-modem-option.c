@@ -26,6 +26,7 @@
 #include "ModemManager.h"
 #include "mm-modem-helpers.h"
 #include "mm-log.h"
+#include "mm-regex-cache.h"
 #include "mm-errors-types.h"
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
@@ -302,7 +303,7 @@ parse_ossys_response (const gchar *response,
     gboolean success = FALSE;
 
     p = mm_strip_tag (response, "_OSSYS:");
-    r = g_regex_new ("(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_cache_get ("(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match (r, p, 0, &match_info);
@@ -382,7 +383,7 @@ parse_octi_response (const gchar *response,
     gboolean success = FALSE;
 
     p = mm_strip_tag (response, "_OCTI:");
-    r = g_regex_new ("(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_cache_get ("(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
     g_assert (r != NULL);
 
     g_regex_match (r, p, 0, &match_info);
@@ -1104,16 +1105,16 @@ mm_broadband_modem_option_init (MMBroadbandModemOption *self)
     self->priv->after_power_up_wait_id = 0;
 
     /* Prepare regular expressions to setup */
-    self->priv->_ossysi_regex = g_regex_new ("\\r\\n_OSSYSI:\\s*(\\d+)\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->_octi_regex = g_regex_new ("\\r\\n_OCTI:\\s*(\\d+)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->_ouwcti_regex = g_regex_new ("\\r\\n_OUWCTI:\\s*(\\d+)\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->_osigq_regex = g_regex_new ("\\r\\n_OSIGQ:\\s*(\\d+),(\\d)\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ignore_regex = g_regex_new ("\\r\\n\\+PACSP0\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->_ossysi_regex = mm_regex_cache_get ("\\r\\n_OSSYSI:\\s*(\\d+)\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->_octi_regex = mm_regex_cache_get ("\\r\\n_OCTI:\\s*(\\d+)\\r\\n",
+                                                  G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->_ouwcti_regex = mm_regex_cache_get ("\\r\\n_OUWCTI:\\s*(\\d+)\\r\\n",
+                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->_osigq_regex = mm_regex_cache_get ("\\r\\n_OSIGQ:\\s*(\\d+),(\\d)\\r\\n",
+                                                   G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->ignore_regex = mm_regex_cache_get ("\\r\\n\\+PACSP0\\r\\n",
+                                                   G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
 }
 
 static void
@@ -169,11 +169,18 @@ grab_port (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", "net", NULL };
+static const gchar *drivers[] = { "hso", NULL };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = "Option High-Speed",
+    .subsystems = subsystems,
+    .drivers    = drivers,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", "net", NULL };
-    static const gchar *drivers[] = { "hso", NULL };
     static const MMAsyncMethod custom_init = {
         .async  = G_CALLBACK (hso_custom_init),
         .finish = G_CALLBACK (hso_custom_init_finish),
@@ -181,7 +188,7 @@ mm_plugin_create (void)
 
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_HSO,
-                      MM_PLUGIN_NAME,               "Option High-Speed",
+                      MM_PLUGIN_NAME,               mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_DRIVERS,    drivers,
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
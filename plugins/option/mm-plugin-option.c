@@ -87,19 +87,27 @@ grab_port (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", NULL };
+static const guint16 vendor_ids[] = { 0x0af0, 0 }; /* Option USB devices */
+static const mm_uint16_pair product_ids[] = { { 0x1931, 0x000c }, /* Nozomi CardBus devices */
+                                              { 0, 0 }
+};
+static const gchar *drivers[] = { "option1", "option", "nozomi", NULL };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name        = "Option",
+    .subsystems  = subsystems,
+    .drivers     = drivers,
+    .vendor_ids  = vendor_ids,
+    .product_ids = product_ids,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", NULL };
-    static const guint16 vendor_ids[] = { 0x0af0, 0 }; /* Option USB devices */
-    static const mm_uint16_pair product_ids[] = { { 0x1931, 0x000c }, /* Nozomi CardBus devices */
-                                                  { 0, 0 }
-    };
-    static const gchar *drivers[] = { "option1", "option", "nozomi", NULL };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_OPTION,
-                      MM_PLUGIN_NAME,                "Option",
+                      MM_PLUGIN_NAME,                mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS,  subsystems,
                       MM_PLUGIN_ALLOWED_DRIVERS,     drivers,
                       MM_PLUGIN_ALLOWED_VENDOR_IDS,  vendor_ids,
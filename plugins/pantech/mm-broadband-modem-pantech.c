@@ -27,6 +27,7 @@
 #include "mm-errors-types.h"
 #include "mm-broadband-modem-pantech.h"
 #include "mm-sim-pantech.h"
+#include "mm-wmc-serial-port.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 
@@ -91,6 +92,25 @@ modem_after_sim_unlock (MMIfaceModem *self,
     g_timeout_add_seconds (5, (GSourceFunc)after_sim_unlock_wait_cb, result);
 }
 
+/*****************************************************************************/
+/* Setup ports (Broadband modem class) */
+
+#define UML290_PRODUCT_ID 0x3718
+
+static void
+setup_ports (MMBroadbandModem *self)
+{
+    MMWmcSerialPort *wmc;
+
+    /* Call parent's setup ports first always */
+    MM_BROADBAND_MODEM_CLASS (mm_broadband_modem_pantech_parent_class)->setup_ports (self);
+
+    /* The UML290 wants WMC frames wrapped in AT*WMC= */
+    wmc = mm_base_modem_peek_port_wmc (MM_BASE_MODEM (self));
+    if (wmc && mm_base_modem_get_product_id (MM_BASE_MODEM (self)) == UML290_PRODUCT_ID)
+        g_object_set (wmc, MM_WMC_SERIAL_PORT_UML290, TRUE, NULL);
+}
+
 /*****************************************************************************/
 
 MMBroadbandModemPantech *
@@ -128,4 +148,7 @@ iface_modem_init (MMIfaceModem *iface)
 static void
 mm_broadband_modem_pantech_class_init (MMBroadbandModemPantechClass *klass)
 {
+    MMBroadbandModemClass *broadband_modem_class = MM_BROADBAND_MODEM_CLASS (klass);
+
+    broadband_modem_class->setup_ports = setup_ports;
 }
@@ -72,6 +72,16 @@ grab_port (MMPlugin *self,
 
     ptype = mm_port_probe_get_port_type (probe);
 
+    /* Ports tagged by udev as WMC ports are used for fast binary status
+     * queries instead of AT or QCDM */
+    if (g_udev_device_get_property_as_boolean (mm_port_probe_peek_port (probe),
+                                               "ID_MM_PANTECH_PORT_TYPE_WMC")) {
+        mm_dbg ("(%s/%s) Port flagged as WMC",
+                mm_port_probe_get_port_subsys (probe),
+                mm_port_probe_get_port_name (probe));
+        ptype = MM_PORT_TYPE_WMC;
+    }
+
     /* Always prefer the ttyACM port as PRIMARY AT port */
     if (ptype == MM_PORT_TYPE_AT &&
         g_str_has_prefix (mm_port_probe_get_port_name (probe), "ttyACM")) {
@@ -88,15 +98,21 @@ grab_port (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", "net", "usb", NULL };
+static const guint16 vendor_ids[] = { 0x106c, 0 };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = "Pantech",
+    .subsystems = subsystems,
+    .vendor_ids = vendor_ids,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", "net", "usb", NULL };
-    static const guint16 vendor_ids[] = { 0x106c, 0 };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_PANTECH,
-                      MM_PLUGIN_NAME, "Pantech",
+                      MM_PLUGIN_NAME, mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_VENDOR_IDS, vendor_ids,
                       MM_PLUGIN_ALLOWED_AT, TRUE,
@@ -52,16 +52,23 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", "net", NULL };
+static const mm_uint16_pair products[] = { { 0x04e8, 0x6872 },
+                                           { 0x04e8, 0x6906 },
+                                           { 0, 0 } };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name        = "Samsung",
+    .subsystems  = subsystems,
+    .product_ids = products,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", "net", NULL };
-    static const mm_uint16_pair products[] = { { 0x04e8, 0x6872 },
-                                               { 0x04e8, 0x6906 },
-                                               { 0, 0 } };
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_SAMSUNG,
-                      MM_PLUGIN_NAME,                "Samsung",
+                      MM_PLUGIN_NAME,                mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS,  subsystems,
                       MM_PLUGIN_ALLOWED_PRODUCT_IDS, products,
                       MM_PLUGIN_ALLOWED_AT,          TRUE,
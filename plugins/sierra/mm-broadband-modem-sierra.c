@@ -28,6 +28,7 @@
 #include "mm-base-modem-at.h"
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
+#include "mm-regex-cache.h"
 #include "mm-errors-types.h"
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
@@ -496,7 +497,7 @@ selrat_query_ready (MMBaseModem *self,
     }
 
     /* Example response: !SELRAT: 03, UMTS 3G Preferred */
-    r = g_regex_new ("!SELRAT:\\s*(\\d+).*$", 0, 0, NULL);
+    r = mm_regex_cache_get ("!SELRAT:\\s*(\\d+).*$", 0, 0, NULL);
     g_assert (r != NULL);
 
     if (g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &error)) {
@@ -1197,7 +1198,7 @@ parse_time (const gchar *response,
     guint year, month, day, hour, minute, second;
     gchar *result = NULL;
 
-    r = g_regex_new (regex, 0, 0, NULL);
+    r = mm_regex_cache_get (regex, 0, 0, NULL);
     g_assert (r != NULL);
 
     if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
@@ -259,11 +259,18 @@ grab_port (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", "net", "usb", NULL };
+static const gchar *drivers[] = { "sierra", "sierra_net", NULL };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = "Sierra",
+    .subsystems = subsystems,
+    .drivers    = drivers,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", "net", "usb", NULL };
-    static const gchar *drivers[] = { "sierra", "sierra_net", NULL };
     static const MMAsyncMethod custom_init = {
         .async  = G_CALLBACK (sierra_custom_init),
         .finish = G_CALLBACK (sierra_custom_init_finish),
@@ -271,7 +278,7 @@ mm_plugin_create (void)
 
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_SIERRA,
-                      MM_PLUGIN_NAME,               "Sierra",
+                      MM_PLUGIN_NAME,               mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_DRIVERS,    drivers,
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
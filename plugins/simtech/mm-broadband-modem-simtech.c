@@ -29,6 +29,7 @@
 #include "ModemManager.h"
 #include "mm-modem-helpers.h"
 #include "mm-log.h"
+#include "mm-regex-cache.h"
 #include "mm-base-modem-at.h"
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
@@ -94,8 +95,8 @@ set_unsolicited_events_handlers (MMBroadbandModemSimtech *self,
     ports[0] = mm_base_modem_peek_port_primary (MM_BASE_MODEM (self));
     ports[1] = mm_base_modem_peek_port_secondary (MM_BASE_MODEM (self));
 
-    regex = g_regex_new ("\\r\\n\\+CNSMOD:\\s*(\\d)\\r\\n",
-                         G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    regex = mm_regex_cache_get ("\\r\\n\\+CNSMOD:\\s*(\\d)\\r\\n",
+                                G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
 
     /* Enable unsolicited events in given port */
     for (i = 0; i < 2; i++) {
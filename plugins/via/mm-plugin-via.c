@@ -52,17 +52,23 @@ create_modem (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", NULL };
+static const mm_str_pair product_strings[] = { { "via",    "cbp7" },
+                                               { "fusion", "2770p" },
+                                               { NULL,     NULL } };
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name            = "Via CBP7",
+    .subsystems      = subsystems,
+    .product_strings = product_strings,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", NULL };
-    static const mm_str_pair product_strings[] = { { "via",    "cbp7" },
-                                                   { "fusion", "2770p" },
-                                                   { NULL,     NULL } };
-
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_VIA,
-                      MM_PLUGIN_NAME,                    "Via CBP7",
+                      MM_PLUGIN_NAME,                    mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS,      subsystems,
                       MM_PLUGIN_ALLOWED_PRODUCT_STRINGS, product_strings,
                       MM_PLUGIN_ALLOWED_AT,              TRUE,
@@ -30,6 +30,7 @@
 #include "mm-log.h"
 #include "mm-serial-parsers.h"
 #include "mm-modem-helpers.h"
+#include "mm-regex-cache.h"
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
 #include "mm-base-modem-at.h"
@@ -230,7 +231,7 @@ wwsm_read_ready (MMBaseModem *self,
      *   +WWSM: 2,1  (2G preferred)
      *   +WWSM: 2,2  (3G preferred)
      */
-    r = g_regex_new ("\\r\\n\\+WWSM: ([0-2])(,([0-2]))?.*$", 0, 0, NULL);
+    r = mm_regex_cache_get ("\\r\\n\\+WWSM: ([0-2])(,([0-2]))?.*$", 0, 0, NULL);
     g_assert (r != NULL);
 
     if (g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, NULL)) {
@@ -1106,9 +1107,9 @@ setup_ports (MMBroadbandModem *self)
 
     /* AT+CPIN? replies will never have an OK appended */
     parser = mm_serial_parser_v1_new ();
-    regex = g_regex_new ("\\r\\n\\+CPIN: .*\\r\\n",
-                         G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                         0, NULL);
+    regex = mm_regex_cache_get ("\\r\\n\\+CPIN: .*\\r\\n",
+                                G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                                0, NULL);
     mm_serial_parser_v1_set_custom_regex (parser, regex, NULL);
     g_regex_unref (regex);
 
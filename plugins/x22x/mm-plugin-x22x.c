@@ -234,17 +234,25 @@ grab_port (MMPlugin *self,
 
 /*****************************************************************************/
 
+static const gchar *subsystems[] = { "tty", NULL };
+/* Vendors: X22x and TAMobile */
+static const guint16 vendor_ids[] = { 0x1bbb, 0 };
+/* Only handle X22X tagged devices here. */
+static const gchar *udev_tags[] = {
+    "ID_MM_X22X_TAGGED",
+    NULL
+};
+
+G_MODULE_EXPORT const MMPluginManifest mm_plugin_manifest = {
+    .name       = "X22X",
+    .subsystems = subsystems,
+    .vendor_ids = vendor_ids,
+    .udev_tags  = udev_tags,
+};
+
 G_MODULE_EXPORT MMPlugin *
 mm_plugin_create (void)
 {
-    static const gchar *subsystems[] = { "tty", NULL };
-    /* Vendors: X22x and TAMobile */
-    static const guint16 vendor_ids[] = { 0x1bbb, 0 };
-    /* Only handle X22X tagged devices here. */
-    static const gchar *udev_tags[] = {
-        "ID_MM_X22X_TAGGED",
-        NULL
-    };
     static const MMAsyncMethod custom_init = {
         .async  = G_CALLBACK (x22x_custom_init),
         .finish = G_CALLBACK (x22x_custom_init_finish),
@@ -252,7 +260,7 @@ mm_plugin_create (void)
 
     return MM_PLUGIN (
         g_object_new (MM_TYPE_PLUGIN_X22X,
-                      MM_PLUGIN_NAME,               "X22X",
+                      MM_PLUGIN_NAME,               mm_plugin_manifest.name,
                       MM_PLUGIN_ALLOWED_SUBSYSTEMS, subsystems,
                       MM_PLUGIN_ALLOWED_VENDOR_IDS, vendor_ids,
                       MM_PLUGIN_ALLOWED_AT,         TRUE,
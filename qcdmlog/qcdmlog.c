@@ -0,0 +1,357 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+/* Summarises and dumps QCDM log captures written by ModemManager's
+ * --qcdm-log-dir option.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <time.h>
+#include <endian.h>
+
+#include "libqcdm/src/utils.h"
+#include "libqcdm/src/errors.h"
+#include "libqcdm/src/log-items.h"
+#include "libqcdm/src/log-capture.h"
+
+static const struct {
+	u_int16_t code;
+	const char *name;
+} log_names[] = {
+	{ DM_LOG_ITEM_CDMA_ACCESS_CHANNEL_MSG,         "CDMA access channel msg" },
+	{ DM_LOG_ITEM_CDMA_REV_CHANNEL_TRAFFIC_MSG,    "CDMA rev traffic msg" },
+	{ DM_LOG_ITEM_CDMA_SYNC_CHANNEL_MSG,           "CDMA sync channel msg" },
+	{ DM_LOG_ITEM_CDMA_PAGING_CHANNEL_MSG,         "CDMA paging channel msg" },
+	{ DM_LOG_ITEM_CDMA_FWD_CHANNEL_TRAFFIC_MSG,    "CDMA fwd traffic msg" },
+	{ DM_LOG_ITEM_CDMA_FWD_LINK_VOCODER_PACKET,    "CDMA fwd vocoder packet" },
+	{ DM_LOG_ITEM_CDMA_REV_LINK_VOCODER_PACKET,    "CDMA rev vocoder packet" },
+	{ DM_LOG_ITEM_CDMA_MARKOV_STATS,               "CDMA markov stats" },
+	{ DM_LOG_ITEM_CDMA_REVERSE_POWER_CONTROL,      "CDMA reverse power control" },
+	{ DM_LOG_ITEM_CDMA_SERVICE_CONFIG,             "CDMA service config" },
+	{ DM_LOG_ITEM_EVDO_HANDOFF_STATE,              "EVDO handoff state" },
+	{ DM_LOG_ITEM_EVDO_ACTIVE_PILOT_SET,           "EVDO active pilot set" },
+	{ DM_LOG_ITEM_EVDO_REV_LINK_PACKET_SUMMARY,    "EVDO rev link packet summary" },
+	{ DM_LOG_ITEM_EVDO_REV_TRAFFIC_RATE_COUNT,     "EVDO rev traffic rate count" },
+	{ DM_LOG_ITEM_EVDO_REV_POWER_CONTROL,          "EVDO rev power control" },
+	{ DM_LOG_ITEM_EVDO_ARQ_EFFECTIVE_RECEIVE_RATE, "EVDO ARQ effective rx rate" },
+	{ DM_LOG_ITEM_EVDO_AIR_LINK_SUMMARY,           "EVDO air link summary" },
+	{ DM_LOG_ITEM_EVDO_POWER,                      "EVDO power" },
+	{ DM_LOG_ITEM_EVDO_FWD_LINK_PACKET_SNAPSHOT,   "EVDO fwd link packet snapshot" },
+	{ DM_LOG_ITEM_EVDO_ACCESS_ATTEMPT,             "EVDO access attempt" },
+	{ DM_LOG_ITEM_EVDO_REV_ACTIVITY_BITS_BUFFER,   "EVDO rev activity bits" },
+	{ DM_LOG_ITEM_EVDO_PILOT_SETS,                 "EVDO pilot sets" },
+	{ DM_LOG_ITEM_EVDO_STATE_INFO,                 "EVDO state info" },
+	{ DM_LOG_ITEM_EVDO_SECTOR_INFO,                "EVDO sector info" },
+	{ DM_LOG_ITEM_EVDO_PILOT_SETS_V2,              "EVDO pilot sets v2" },
+	{ DM_LOG_ITEM_WCDMA_TA_FINGER_INFO,            "WCDMA TA finger info" },
+	{ DM_LOG_ITEM_WCDMA_AGC_INFO,                  "WCDMA AGC info" },
+	{ DM_LOG_ITEM_WCDMA_RRC_STATE,                 "WCDMA RRC state" },
+	{ DM_LOG_ITEM_WCDMA_CELL_ID,                   "WCDMA cell ID" },
+	{ DM_LOG_ITEM_GSM_BURST_METRICS,               "GSM burst metrics" },
+	{ DM_LOG_ITEM_GSM_BCCH_MESSAGE,                "GSM BCCH message" },
+};
+
+static const char *
+log_name (u_int16_t code)
+{
+	int i;
+
+	for (i = 0; i < sizeof (log_names) / sizeof (log_names[0]); i++) {
+		if (log_names[i].code == code)
+			return log_names[i].name;
+	}
+	return "unknown";
+}
+
+static const char *rrc_states[] = {
+	"disconnected", "connecting", "CELL_FACH", "CELL_DCH", "CELL_PCH", "URA_PCH"
+};
+
+/* Prints the interesting bits of the log items we know about */
+static void
+decode_payload (u_int16_t code, const u_int8_t *data, size_t len)
+{
+	switch (code) {
+	case DM_LOG_ITEM_WCDMA_RRC_STATE: {
+		const DMLogItemWcdmaRrcState *s = (const DMLogItemWcdmaRrcState *) data;
+
+		if (len < sizeof (*s))
+			break;
+		if (s->rrc_state < sizeof (rrc_states) / sizeof (rrc_states[0]))
+			printf (" state=%s", rrc_states[s->rrc_state]);
+		else
+			printf (" state=%u", s->rrc_state);
+		return;
+	}
+	case DM_LOG_ITEM_WCDMA_CELL_ID: {
+		const DMLogItemWcdmaCellId *c = (const DMLogItemWcdmaCellId *) data;
+
+		if (len < sizeof (*c))
+			break;
+		printf (" cell-id=%u", le32toh (c->cellid));
+		return;
+	}
+	case DM_LOG_ITEM_WCDMA_AGC_INFO: {
+		const DMLogItemWcdmaAgcInfo *a = (const DMLogItemWcdmaAgcInfo *) data;
+
+		if (len < sizeof (*a))
+			break;
+		printf (" rx-agc=%d", (int16_t) le16toh (a->rx_agc));
+		if (a->agc_info & 0x10)
+			printf (" tx-agc=%d", (int16_t) le16toh (a->tx_agc));
+		return;
+	}
+	case DM_LOG_ITEM_GSM_BCCH_MESSAGE: {
+		const DMLogItemGsmBcchMessage *b = (const DMLogItemGsmBcchMessage *) data;
+		u_int16_t arfcn;
+
+		if (len < sizeof (*b))
+			break;
+		arfcn = le16toh (b->bcch_arfcn);
+		printf (" band=%u arfcn=%u bsic=%u cell-id=%u",
+		        arfcn >> 12, arfcn & 0x0FFF,
+		        le16toh (b->bsic), le16toh (b->cell_id));
+		return;
+	}
+	case DM_LOG_ITEM_GSM_BURST_METRICS: {
+		const DMLogItemGsmBurstMetrics *m = (const DMLogItemGsmBurstMetrics *) data;
+		int i;
+
+		if (len < sizeof (*m))
+			break;
+		printf (" channel=%u", m->channel);
+		for (i = 0; i < 4; i++)
+			printf (" [arfcn=%u rssi=%u snr=%u]",
+			        le16toh (m->metrics[i].arfcn),
+			        le32toh (m->metrics[i].rssi),
+			        le16toh (m->metrics[i].snr));
+		return;
+	}
+	default:
+		break;
+	}
+
+	/* Anything else is shown raw, up to a reasonable length */
+	if (len) {
+		size_t i;
+
+		printf (" ");
+		for (i = 0; i < len && i < 32; i++)
+			printf ("%02x", data[i]);
+		if (i < len)
+			printf ("...");
+	}
+}
+
+/******************************************************************/
+
+typedef struct {
+	u_int64_t count;
+	u_int64_t bytes;
+} CodeStats;
+
+static int
+summary (const char *path)
+{
+	QcdmCaptureReader *reader;
+	const QcdmCaptureHeader *header;
+	const QcdmCaptureRecord *rec;
+	CodeStats *stats;
+	u_int64_t records = 0, bytes = 0;
+	u_int32_t first = 0, last = 0;
+	double span;
+	time_t start;
+	char started[64];
+	int err = 0, code;
+
+	reader = qcdm_capture_reader_open (path, &err);
+	if (!reader) {
+		fprintf (stderr, "E: couldn't open capture '%s': %d\n", path, err);
+		return 1;
+	}
+
+	/* One slot per possible log code keeps the walk free of lookups */
+	stats = calloc (0x10000, sizeof (CodeStats));
+	if (!stats) {
+		qcdm_capture_reader_close (reader);
+		return 1;
+	}
+
+	while ((rec = qcdm_capture_reader_next (reader)) != NULL) {
+		CodeStats *s = &stats[le16toh (rec->log_code)];
+
+		if (records == 0)
+			first = le32toh (rec->host_msec);
+		last = le32toh (rec->host_msec);
+		s->count++;
+		s->bytes += le16toh (rec->len);
+		records++;
+		bytes += le16toh (rec->len);
+	}
+
+	header = qcdm_capture_reader_get_header (reader);
+	start = le64toh (header->start_time) / 1000000;
+	strftime (started, sizeof (started), "%Y-%m-%d %H:%M:%S", localtime (&start));
+	span = (last - first) / 1000.0;
+
+	printf ("%s\n", path);
+	printf ("  started:  %s\n", started);
+	printf ("  records:  %llu (%llu payload bytes)\n",
+	        (unsigned long long) records, (unsigned long long) bytes);
+	printf ("  span:     %.3f s (%.3f s to %.3f s)\n", span, first / 1000.0, last / 1000.0);
+	printf ("  index:    %s\n", qcdm_capture_reader_has_index (reader) ? "yes" : "no");
+
+	if (records) {
+		printf ("\n  %-6s  %-30s %10s %12s %10s\n", "code", "name", "count", "bytes", "rate/s");
+		for (code = 0; code < 0x10000; code++) {
+			if (!stats[code].count)
+				continue;
+			printf ("  0x%04x  %-30s %10llu %12llu %10.2f\n",
+			        code, log_name (code),
+			        (unsigned long long) stats[code].count,
+			        (unsigned long long) stats[code].bytes,
+			        span > 0 ? stats[code].count / span : 0.0);
+		}
+	}
+
+	free (stats);
+	qcdm_capture_reader_close (reader);
+	return 0;
+}
+
+static int
+dump (const char *path,
+      const u_int16_t *codes,
+      size_t n_codes,
+      double from,
+      double to)
+{
+	QcdmCaptureReader *reader;
+	const QcdmCaptureRecord *rec;
+	int err = 0;
+
+	reader = qcdm_capture_reader_open (path, &err);
+	if (!reader) {
+		fprintf (stderr, "E: couldn't open capture '%s': %d\n", path, err);
+		return 1;
+	}
+
+	if (from > 0)
+		qcdm_capture_reader_seek_time (reader, (u_int32_t) (from * 1000));
+
+	while ((rec = qcdm_capture_reader_next (reader)) != NULL) {
+		u_int16_t code = le16toh (rec->log_code);
+		u_int32_t msec = le32toh (rec->host_msec);
+
+		if (to >= 0 && msec > to * 1000)
+			break;
+
+		if (n_codes) {
+			size_t i;
+
+			for (i = 0; i < n_codes && codes[i] != code; i++);
+			if (i == n_codes)
+				continue;
+		}
+
+		printf ("%10.3f  0x%04x  %-30s %5u", msec / 1000.0, code, log_name (code), le16toh (rec->len));
+		decode_payload (code, rec->payload, le16toh (rec->len));
+		printf ("\n");
+	}
+
+	qcdm_capture_reader_close (reader);
+	return 0;
+}
+
+/******************************************************************/
+
+static void
+usage (const char *prog)
+{
+	fprintf (stderr, "Usage: %s summary <capture> [<capture> ...]\n", prog);
+	fprintf (stderr, "       %s dump [-c <code>]... [-f <secs>] [-t <secs>] <capture>\n\n", prog);
+	fprintf (stderr, "  -c, --code=CODE   only dump this log code (hex); may be repeated\n");
+	fprintf (stderr, "  -f, --from=SECS   start at this time since the capture started\n");
+	fprintf (stderr, "  -t, --to=SECS     stop at this time since the capture started\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+	static const struct option options[] = {
+		{ "code", required_argument, NULL, 'c' },
+		{ "from", required_argument, NULL, 'f' },
+		{ "to",   required_argument, NULL, 't' },
+		{ NULL }
+	};
+	u_int16_t codes[64];
+	size_t n_codes = 0;
+	double from = 0, to = -1;
+	int opt, ret = 0;
+
+	if (argc < 3) {
+		usage (argv[0]);
+		return 1;
+	}
+
+	if (!strcmp (argv[1], "summary")) {
+		int i;
+
+		for (i = 2; i < argc; i++)
+			ret |= summary (argv[i]);
+		return ret;
+	}
+
+	if (strcmp (argv[1], "dump")) {
+		usage (argv[0]);
+		return 1;
+	}
+
+	optind = 2;
+	while ((opt = getopt_long (argc, argv, "c:f:t:", options, NULL)) != -1) {
+		switch (opt) {
+		case 'c':
+			if (n_codes == sizeof (codes) / sizeof (codes[0])) {
+				fprintf (stderr, "E: too many log codes\n");
+				return 1;
+			}
+			codes[n_codes++] = strtoul (optarg, NULL, 16);
+			break;
+		case 'f':
+			from = strtod (optarg, NULL);
+			break;
+		case 't':
+			to = strtod (optarg, NULL);
+			break;
+		default:
+			usage (argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind != argc - 1) {
+		usage (argv[0]);
+		return 1;
+	}
+
+	return dump (argv[optind], codes, n_codes, from, to);
+}
+
@@ -20,6 +20,8 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
 
 #include <gio/gio.h>
 
@@ -28,6 +30,8 @@
 #include "mm-manager.h"
 #include "mm-log.h"
 #include "mm-context.h"
+#include "mm-trace.h"
+#include "mm-timer-wheel.h"
 
 #if !defined(MM_DIST_VERSION)
 # define MM_DIST_VERSION VERSION
@@ -39,11 +43,21 @@
 static GMainLoop *loop;
 static MMManager *manager;
 
+/* Wakes up the main loop to write the timeline; only write() is safe to
+ * call from the signal handler */
+static int trace_pipe[2] = { -1, -1 };
+
 static void
 mm_signal_handler (int signo)
 {
     if (signo == SIGUSR1)
         mm_log_usr1 ();
+    else if (signo == SIGUSR2 && trace_pipe[1] >= 0) {
+        /* If the pipe is full, a write is already pending */
+        ssize_t ignored = write (trace_pipe[1], "", 1);
+
+        (void) ignored;
+    }
 	else if (signo == SIGINT || signo == SIGTERM) {
 		mm_info ("Caught signal %d, shutting down...", signo);
         if (loop)
@@ -64,10 +78,64 @@ setup_signals (void)
     action.sa_mask = mask;
     action.sa_flags = 0;
     sigaction (SIGUSR1, &action, NULL);
+    sigaction (SIGUSR2, &action, NULL);
     sigaction (SIGTERM, &action, NULL);
     sigaction (SIGINT, &action, NULL);
 }
 
+static void
+trace_write (void)
+{
+    GError *error = NULL;
+    const gchar *path;
+
+    path = mm_context_get_trace_file ();
+    if (!path)
+        return;
+
+    if (!mm_trace_write (path, &error)) {
+        mm_warn ("Couldn't write trace to '%s': %s", path, error->message);
+        g_error_free (error);
+        return;
+    }
+
+    mm_info ("Trace written to '%s'", path);
+}
+
+static gboolean
+trace_pipe_cb (GIOChannel *channel,
+               GIOCondition condition,
+               gpointer user_data)
+{
+    gchar buffer[16];
+
+    /* Several signals may have been received meanwhile */
+    if (read (trace_pipe[0], buffer, sizeof (buffer)) > 0)
+        trace_write ();
+    return TRUE;
+}
+
+static void
+setup_trace (void)
+{
+    GIOChannel *channel;
+
+    mm_trace_init (MM_TRACE_DEFAULT_MAX_EVENTS);
+
+    if (!mm_context_get_trace_file ())
+        return;
+
+    if (pipe (trace_pipe) < 0) {
+        mm_warn ("Couldn't setup trace writing on SIGUSR2: %s", strerror (errno));
+        return;
+    }
+    fcntl (trace_pipe[1], F_SETFL, O_NONBLOCK);
+
+    channel = g_io_channel_unix_new (trace_pipe[0]);
+    g_io_add_watch (channel, G_IO_IN, trace_pipe_cb, NULL);
+    g_io_channel_unref (channel);
+}
+
 static void
 bus_acquired_cb (GDBusConnection *connection,
                  const gchar *name,
@@ -139,6 +207,9 @@ main (int argc, char *argv[])
         exit (1);
     }
 
+    if (mm_context_get_trace ())
+        setup_trace ();
+
     setup_signals ();
 
     mm_info ("ModemManager (version " MM_DIST_VERSION ") starting...");
@@ -192,6 +263,19 @@ main (int argc, char *argv[])
 
     g_bus_unown_name (name_id);
 
+    {
+        guint64 n_wakeups;
+        guint64 n_dispatched;
+
+        mm_timer_wheel_get_stats (NULL, &n_wakeups, &n_dispatched);
+        mm_dbg ("Timer wheel dispatched %" G_GUINT64_FORMAT " timers in %" G_GUINT64_FORMAT " wakeups",
+                n_dispatched, n_wakeups);
+    }
+    mm_timer_wheel_shutdown ();
+
+    trace_write ();
+    mm_trace_shutdown ();
+
     mm_info ("ModemManager is shut down");
 
     mm_log_shutdown ();
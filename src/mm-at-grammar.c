@@ -0,0 +1,485 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <string.h>
+
+#include "mm-at-grammar.h"
+
+static inline gboolean
+is_space (gchar c)
+{
+    return (c == ' ' || c == '\t');
+}
+
+static inline gboolean
+is_line_end (gchar c)
+{
+    return (c == '\r' || c == '\n' || c == '\0');
+}
+
+static void
+skip_spaces (MMAtCursor *cursor)
+{
+    while (cursor->p < cursor->end && is_space (*cursor->p))
+        cursor->p++;
+}
+
+/* Both take the position right after the opening character */
+static const gchar *
+find_quote_end (const gchar *p,
+                const gchar *end)
+{
+    return memchr (p, '"', end - p);
+}
+
+static const gchar *
+find_group_end (const gchar *p,
+                const gchar *end)
+{
+    guint depth = 1;
+
+    for (; p < end; p++) {
+        if (*p == '"') {
+            p = find_quote_end (p + 1, end);
+            if (!p)
+                return NULL;
+        } else if (*p == '(')
+            depth++;
+        else if (*p == ')' && --depth == 0)
+            return p;
+    }
+
+    return NULL;
+}
+
+/*****************************************************************************/
+/* Values */
+
+static gboolean
+parse_uint (MMAtCursor *cursor,
+            guint *out)
+{
+    const gchar *p = cursor->p;
+    gboolean quoted;
+    guint64 value = 0;
+
+    quoted = (p < cursor->end && *p == '"');
+    if (quoted)
+        p++;
+
+    if (p >= cursor->end || !g_ascii_isdigit (*p))
+        return FALSE;
+
+    while (p < cursor->end && g_ascii_isdigit (*p)) {
+        value = value * 10 + (*p - '0');
+        if (value > G_MAXUINT)
+            return FALSE;
+        p++;
+    }
+
+    if (quoted) {
+        if (p >= cursor->end || *p != '"')
+            return FALSE;
+        p++;
+    }
+
+    *out = (guint) value;
+    cursor->p = p;
+    return TRUE;
+}
+
+static gboolean
+parse_string (MMAtCursor *cursor,
+              MMAtSpan *out)
+{
+    const gchar *start;
+    const gchar *stop;
+
+    if (cursor->p < cursor->end && *cursor->p == '"') {
+        start = cursor->p + 1;
+        stop = find_quote_end (start, cursor->end);
+        if (!stop)
+            return FALSE;
+        cursor->p = stop + 1;
+    } else {
+        start = stop = cursor->p;
+        while (stop < cursor->end &&
+               *stop != ',' &&
+               *stop != ')' &&
+               !is_line_end (*stop))
+            stop++;
+        cursor->p = stop;
+    }
+
+    /* Quoted or not, surrounding whitespace is never meaningful */
+    while (start < stop && is_space (*start))
+        start++;
+    while (stop > start && is_space (stop[-1]))
+        stop--;
+
+    out->str = start;
+    out->len = stop - start;
+    return TRUE;
+}
+
+static gboolean
+parse_range (MMAtCursor *cursor,
+             MMAtRange *out)
+{
+    MMAtCursor c = *cursor;
+    MMAtRange range;
+    gboolean grouped;
+    guint value;
+
+    grouped = (c.p < c.end && *c.p == '(');
+    if (grouped) {
+        c.p++;
+        skip_spaces (&c);
+    }
+
+    if (!parse_uint (&c, &value))
+        return FALSE;
+    range.min = range.max = value;
+
+    /* Inside parenthesis both "0-5" and "0,1,3" are allowed; outside, a comma
+     * is the field separator */
+    for (;;) {
+        skip_spaces (&c);
+        if (c.p >= c.end || !(*c.p == '-' || (grouped && *c.p == ',')))
+            break;
+        c.p++;
+        skip_spaces (&c);
+        if (!parse_uint (&c, &value))
+            return FALSE;
+        range.min = MIN (range.min, value);
+        range.max = MAX (range.max, value);
+    }
+
+    if (grouped) {
+        if (c.p >= c.end || *c.p != ')')
+            return FALSE;
+        c.p++;
+    }
+
+    *out = range;
+    *cursor = c;
+    return TRUE;
+}
+
+static gboolean
+parse_list (MMAtCursor *cursor,
+            MMAtSpan *out)
+{
+    const gchar *stop;
+
+    if (cursor->p >= cursor->end || *cursor->p != '(')
+        return FALSE;
+
+    stop = find_group_end (cursor->p + 1, cursor->end);
+    if (!stop)
+        return FALSE;
+
+    out->str = cursor->p + 1;
+    out->len = stop - out->str;
+    cursor->p = stop + 1;
+    return TRUE;
+}
+
+static gboolean
+parse_one (MMAtCursor *cursor,
+           MMAtFieldType type,
+           gpointer value)
+{
+    MMAtSpan skipped;
+
+    switch (type) {
+    case MM_AT_FIELD_UINT:
+        return parse_uint (cursor, (guint *) value);
+    case MM_AT_FIELD_STRING:
+        return parse_string (cursor, (MMAtSpan *) value);
+    case MM_AT_FIELD_RANGE:
+        return parse_range (cursor, (MMAtRange *) value);
+    case MM_AT_FIELD_LIST:
+        return parse_list (cursor, (MMAtSpan *) value);
+    case MM_AT_FIELD_SKIP:
+        if (cursor->p < cursor->end && *cursor->p == '(')
+            return parse_list (cursor, &skipped);
+        return parse_string (cursor, &skipped);
+    }
+
+    g_assert_not_reached ();
+    return FALSE;
+}
+
+/*****************************************************************************/
+
+void
+mm_at_cursor_init (MMAtCursor *cursor,
+                   const gchar *str,
+                   gssize len)
+{
+    g_return_if_fail (cursor != NULL);
+
+    if (!str) {
+        str = "";
+        len = 0;
+    } else if (len < 0)
+        len = strlen (str);
+
+    cursor->p = str;
+    cursor->end = str + len;
+}
+
+gboolean
+mm_at_cursor_find (MMAtCursor *cursor,
+                   const gchar *prefix)
+{
+    gsize prefix_len;
+    const gchar *p;
+
+    g_return_val_if_fail (prefix != NULL && prefix[0] != '\0', FALSE);
+
+    prefix_len = strlen (prefix);
+    p = cursor->p;
+    while ((gsize) (cursor->end - p) >= prefix_len) {
+        p = memchr (p, prefix[0], cursor->end - p);
+        if (!p || (gsize) (cursor->end - p) < prefix_len)
+            break;
+        if (memcmp (p, prefix, prefix_len) == 0) {
+            cursor->p = p + prefix_len;
+            return TRUE;
+        }
+        p++;
+    }
+
+    cursor->p = cursor->end;
+    return FALSE;
+}
+
+gboolean
+mm_at_cursor_at_end (MMAtCursor *cursor)
+{
+    skip_spaces (cursor);
+    return (cursor->p >= cursor->end ||
+            *cursor->p == ')' ||
+            is_line_end (*cursor->p));
+}
+
+gboolean
+mm_at_cursor_parse_value (MMAtCursor *cursor,
+                          MMAtFieldType type,
+                          gpointer value)
+{
+    MMAtCursor c;
+
+    g_return_val_if_fail (value != NULL || type == MM_AT_FIELD_SKIP, FALSE);
+
+    if (mm_at_cursor_at_end (cursor))
+        return FALSE;
+
+    c = *cursor;
+    if (!parse_one (&c, type, value))
+        return FALSE;
+
+    /* A value must be followed by a separator or by the end of the
+     * line/group; anything else means it wasn't of the expected type */
+    if (!mm_at_cursor_at_end (&c)) {
+        if (*c.p != ',')
+            return FALSE;
+        c.p++;
+    }
+
+    *cursor = c;
+    return TRUE;
+}
+
+static guint
+parse_fields_from (MMAtCursor *cursor,
+                   const MMAtGrammar *grammar,
+                   guint first,
+                   gpointer out)
+{
+    guint i;
+
+    for (i = first; i < grammar->n_fields; i++) {
+        const MMAtField *field = &grammar->fields[i];
+
+        if (!mm_at_cursor_parse_value (cursor,
+                                       field->type,
+                                       (field->type == MM_AT_FIELD_SKIP ?
+                                        NULL :
+                                        G_STRUCT_MEMBER_P (out, field->offset))))
+            break;
+    }
+
+    return i;
+}
+
+guint
+mm_at_cursor_parse_fields (MMAtCursor *cursor,
+                           const MMAtGrammar *grammar,
+                           gpointer out)
+{
+    g_return_val_if_fail (grammar != NULL, 0);
+    g_return_val_if_fail (out != NULL, 0);
+
+    return parse_fields_from (cursor, grammar, 0, out);
+}
+
+gboolean
+mm_at_cursor_next_group (MMAtCursor *cursor,
+                         MMAtCursor *group)
+{
+    const gchar *p;
+    const gchar *stop;
+
+    for (p = cursor->p; p < cursor->end; p++) {
+        if (*p == '"') {
+            p = find_quote_end (p + 1, cursor->end);
+            if (!p)
+                return FALSE;
+        } else if (*p == '(')
+            break;
+    }
+    if (p >= cursor->end)
+        return FALSE;
+
+    /* An unterminated group runs until the end */
+    stop = find_group_end (p + 1, cursor->end);
+    group->p = p + 1;
+    group->end = stop ? stop : cursor->end;
+    cursor->p = stop ? stop + 1 : cursor->end;
+    return TRUE;
+}
+
+/* Quirk: some modems close a tuple too early, and give the remaining fields
+ * before a stray parenthesis, e.g. the Sony-Ericsson TM-506:
+ *
+ *   +COPS: (2,"","T-Mobile","31026",0),(1,"AT&T","AT&T","310410"),0)
+ */
+static guint
+parse_stray_fields (MMAtCursor *cursor,
+                    const MMAtGrammar *grammar,
+                    guint n_fields,
+                    gpointer out)
+{
+    MMAtCursor rest = *cursor;
+    const gchar *p;
+
+    skip_spaces (&rest);
+    if (rest.p >= rest.end || *rest.p != ',')
+        return n_fields;
+
+    /* Only if the stray ')' comes before the next tuple */
+    for (p = rest.p + 1; p < rest.end; p++) {
+        if (*p == '"') {
+            p = find_quote_end (p + 1, rest.end);
+            if (!p)
+                return n_fields;
+        } else if (*p == '(' || is_line_end (*p))
+            return n_fields;
+        else if (*p == ')')
+            break;
+    }
+    if (p >= rest.end)
+        return n_fields;
+
+    rest.p++;
+    rest.end = p;
+    n_fields = parse_fields_from (&rest, grammar, n_fields, out);
+    cursor->p = p + 1;
+    return n_fields;
+}
+
+void
+mm_at_cursor_foreach_tuple (MMAtCursor *cursor,
+                            const MMAtGrammar *grammar,
+                            gpointer out,
+                            MMAtTupleFn callback,
+                            gpointer user_data)
+{
+    MMAtCursor group;
+
+    g_return_if_fail (grammar != NULL);
+    g_return_if_fail (out != NULL);
+    g_return_if_fail (callback != NULL);
+
+    while (mm_at_cursor_next_group (cursor, &group)) {
+        guint n_fields;
+
+        memset (out, 0, grammar->struct_size);
+        n_fields = parse_fields_from (&group, grammar, 0, out);
+        if (n_fields < grammar->n_fields && mm_at_cursor_at_end (&group))
+            n_fields = parse_stray_fields (cursor, grammar, n_fields, out);
+
+        if (!callback (out, n_fields, user_data))
+            break;
+    }
+}
+
+void
+mm_at_cursor_foreach_line (MMAtCursor *cursor,
+                           const gchar *prefix,
+                           const MMAtGrammar *grammar,
+                           gpointer out,
+                           MMAtTupleFn callback,
+                           gpointer user_data)
+{
+    g_return_if_fail (grammar != NULL);
+    g_return_if_fail (out != NULL);
+    g_return_if_fail (callback != NULL);
+
+    while (mm_at_cursor_find (cursor, prefix)) {
+        guint n_fields;
+
+        memset (out, 0, grammar->struct_size);
+        n_fields = parse_fields_from (cursor, grammar, 0, out);
+
+        if (!callback (out, n_fields, user_data))
+            break;
+    }
+}
+
+/*****************************************************************************/
+
+gboolean
+mm_at_span_equal (const MMAtSpan *span,
+                  const gchar *str)
+{
+    gsize len;
+
+    len = strlen (str);
+    return (span->len == len && (!len || memcmp (span->str, str, len) == 0));
+}
+
+gboolean
+mm_at_span_copy (const MMAtSpan *span,
+                 gchar *buffer,
+                 gsize buffer_len)
+{
+    if (span->len >= buffer_len)
+        return FALSE;
+
+    if (span->len)
+        memcpy (buffer, span->str, span->len);
+    buffer[span->len] = '\0';
+    return TRUE;
+}
+
+gchar *
+mm_at_span_dup (const MMAtSpan *span)
+{
+    return (span->len ? g_strndup (span->str, span->len) : NULL);
+}
@@ -0,0 +1,134 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#ifndef MM_AT_GRAMMAR_H
+#define MM_AT_GRAMMAR_H
+
+#include <glib.h>
+
+/* Table-driven parser for the usual 27.007 response shapes: comma separated
+ * fields, lists of parenthesised tuples, ranges and quoted strings.
+ *
+ * A grammar is a table of fields, each one with a type and the offset of
+ * the value in a caller-provided struct.  Nothing is allocated while
+ * parsing: strings are returned as spans pointing into the reply, so
+ * callers only copy what they end up keeping.
+ */
+
+/* A piece of the reply; not NUL-terminated */
+typedef struct {
+    const gchar *str;
+    gsize len;
+} MMAtSpan;
+
+typedef struct {
+    guint min;
+    guint max;
+} MMAtRange;
+
+typedef enum {
+    MM_AT_FIELD_UINT,   /* Decimal number, as guint */
+    MM_AT_FIELD_STRING, /* Quoted or bare string, as MMAtSpan; may be empty */
+    MM_AT_FIELD_RANGE,  /* "(0-5)", "(0,1,3)" or "0-5", as MMAtRange */
+    MM_AT_FIELD_LIST,   /* "(...)", as MMAtSpan of the contents */
+    MM_AT_FIELD_SKIP    /* Any of the above, ignored */
+} MMAtFieldType;
+
+typedef struct {
+    MMAtFieldType type;
+    gsize offset;
+} MMAtField;
+
+#define MM_AT_FIELD(type, struct_type, member) \
+    { type, G_STRUCT_OFFSET (struct_type, member) }
+#define MM_AT_FIELD_SKIPPED \
+    { MM_AT_FIELD_SKIP, 0 }
+
+typedef struct {
+    const MMAtField *fields;
+    guint n_fields;
+    gsize struct_size;
+} MMAtGrammar;
+
+#define MM_AT_GRAMMAR(fields, struct_type) \
+    { fields, G_N_ELEMENTS (fields), sizeof (struct_type) }
+
+/* Position within the reply being parsed */
+typedef struct {
+    const gchar *p;
+    const gchar *end;
+} MMAtCursor;
+
+void     mm_at_cursor_init        (MMAtCursor *cursor,
+                                   const gchar *str,
+                                   gssize len);
+
+/* Moves the cursor right after the next occurrence of 'prefix' */
+gboolean mm_at_cursor_find        (MMAtCursor *cursor,
+                                   const gchar *prefix);
+
+/* Whether there are no more fields before the end of the line or group */
+gboolean mm_at_cursor_at_end      (MMAtCursor *cursor);
+
+/* Parses a single value and the separator after it */
+gboolean mm_at_cursor_parse_value (MMAtCursor *cursor,
+                                   MMAtFieldType type,
+                                   gpointer value);
+
+/* Parses fields into 'out' following the grammar, stopping at the first one
+ * which doesn't match its type; returns how many were parsed */
+guint    mm_at_cursor_parse_fields (MMAtCursor *cursor,
+                                    const MMAtGrammar *grammar,
+                                    gpointer out);
+
+/* Sets 'group' to the contents of the next parenthesised group, and moves
+ * the cursor past it */
+gboolean mm_at_cursor_next_group  (MMAtCursor *cursor,
+                                   MMAtCursor *group);
+
+/* Called for each tuple or line with the number of fields parsed into
+ * 'out'; return FALSE to stop */
+typedef gboolean (* MMAtTupleFn) (gpointer out,
+                                  guint n_fields,
+                                  gpointer user_data);
+
+/* Parses each parenthesised tuple, e.g. +COPS: (...),(...),...
+ * 'out' must be at least grammar->struct_size bytes, and is cleared before
+ * each tuple. */
+void     mm_at_cursor_foreach_tuple (MMAtCursor *cursor,
+                                     const MMAtGrammar *grammar,
+                                     gpointer out,
+                                     MMAtTupleFn callback,
+                                     gpointer user_data);
+
+/* Parses the fields after each occurrence of 'prefix', e.g. one +CGDCONT:
+ * line after the other */
+void     mm_at_cursor_foreach_line  (MMAtCursor *cursor,
+                                     const gchar *prefix,
+                                     const MMAtGrammar *grammar,
+                                     gpointer out,
+                                     MMAtTupleFn callback,
+                                     gpointer user_data);
+
+/* Span helpers */
+gboolean mm_at_span_equal (const MMAtSpan *span,
+                           const gchar *str);
+gboolean mm_at_span_copy  (const MMAtSpan *span,
+                           gchar *buffer,
+                           gsize buffer_len);
+/* Returns NULL for empty spans */
+gchar   *mm_at_span_dup   (const MMAtSpan *span);
+
+#endif /* MM_AT_GRAMMAR_H */
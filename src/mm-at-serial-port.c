@@ -362,6 +362,37 @@ mm_at_serial_port_queue_command_cached (MMAtSerialPort *self,
                                          user_data);
 }
 
+void
+mm_at_serial_port_queue_command_full (MMAtSerialPort *self,
+                                      const char *command,
+                                      guint32 timeout_seconds,
+                                      gboolean is_raw,
+                                      gboolean cached,
+                                      MMSerialPortPriority priority,
+                                      GCancellable *cancellable,
+                                      MMAtSerialResponseFn callback,
+                                      gpointer user_data)
+{
+    GByteArray *buf;
+
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (MM_IS_AT_SERIAL_PORT (self));
+    g_return_if_fail (command != NULL);
+
+    buf = at_command_to_byte_array (command, is_raw);
+    g_return_if_fail (buf != NULL);
+
+    mm_serial_port_queue_command_full (MM_SERIAL_PORT (self),
+                                       buf,
+                                       TRUE,
+                                       cached,
+                                       priority,
+                                       timeout_seconds,
+                                       cancellable,
+                                       (MMSerialResponseFn) callback,
+                                       user_data);
+}
+
 static void
 debug_log (MMSerialPort *port, const char *prefix, const char *buf, gsize len)
 {
@@ -415,6 +446,72 @@ mm_at_serial_port_get_flags (MMAtSerialPort *self)
     return MM_AT_SERIAL_PORT_GET_PRIVATE (self)->flags;
 }
 
+/*****************************************************************************/
+/* Balancing commands across ports */
+
+/* Commands which change the setup of the port they are sent to, whose reply
+ * (prompts, URCs) comes back in that same port, or whose reply depends on
+ * per-port settings other than echo and error reporting (charset, SMS format
+ * and storage). These always go to the same port, so that the setup stays
+ * consistent with the commands relying on it. */
+static const gchar *port_bound_commands[] = {
+    "E", "V", "Q", "S", "Z", "&", "\\",   /* Port settings */
+    "D", "H", "O", "A", "+CGDATA",    /* Calls and data mode */
+    "+IFC", "+IPR", "+ICF",
+    "+CMEE", "+CSCS", "+CRC",
+    "+CNMI", "+CMER", "+CREG=", "+CGREG=", "+CEREG=", "+CTZR", "^CURC",
+    "+CUSD",                          /* Replies come as URCs */
+    "+CMG", "+CMSS", "+CPMS", "+CNMA", "+CSCA", /* SMS format and storage */
+    "+COPS", "+CNUM", "+CPB",         /* Strings in the port charset */
+    NULL
+};
+
+gboolean
+mm_at_serial_port_command_is_port_bound (const gchar *command)
+{
+    guint i;
+
+    g_return_val_if_fail (command != NULL, TRUE);
+
+    if (g_ascii_strncasecmp (command, "AT", 2) == 0)
+        command += 2;
+
+    for (i = 0; port_bound_commands[i]; i++) {
+        if (g_ascii_strncasecmp (command,
+                                 port_bound_commands[i],
+                                 strlen (port_bound_commands[i])) == 0)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+MMAtSerialPort *
+mm_at_serial_port_peek_least_busy (MMAtSerialPort **ports,
+                                   guint n_ports)
+{
+    MMAtSerialPort *best = NULL;
+    guint best_length = G_MAXUINT;
+    guint i;
+
+    for (i = 0; i < n_ports; i++) {
+        guint length;
+
+        if (!ports[i] ||
+            mm_port_get_connected (MM_PORT (ports[i])) ||
+            !mm_serial_port_is_open (MM_SERIAL_PORT (ports[i])))
+            continue;
+
+        length = mm_serial_port_get_queue_length (MM_SERIAL_PORT (ports[i]));
+        if (length < best_length) {
+            best = ports[i];
+            best_length = length;
+        }
+    }
+
+    return best;
+}
+
 /*****************************************************************************/
 
 MMAtSerialPort *
@@ -468,6 +565,23 @@ get_property (GObject *object, guint prop_id,
     }
 }
 
+static gsize
+get_memory_usage (MMSerialPort *self)
+{
+    MMAtSerialPortPrivate *priv = MM_AT_SERIAL_PORT_GET_PRIVATE (self);
+    gsize usage;
+
+    usage = MM_SERIAL_PORT_CLASS (mm_at_serial_port_parent_class)->get_memory_usage (self);
+    usage += sizeof (MMAtSerialPortPrivate);
+
+    /* Regexes are shared through the regex cache, so only the handlers
+     * themselves are owned by the port */
+    usage += (g_slist_length (priv->unsolicited_msg_handlers) *
+              (sizeof (MMAtUnsolicitedMsgHandler) + sizeof (GSList)));
+
+    return usage;
+}
+
 static void
 finalize (GObject *object)
 {
@@ -509,6 +623,7 @@ mm_at_serial_port_class_init (MMAtSerialPortClass *klass)
     port_class->parse_response = parse_response;
     port_class->handle_response = handle_response;
     port_class->debug_log = debug_log;
+    port_class->get_memory_usage = get_memory_usage;
 
     g_object_class_install_property
         (object_class, PROP_REMOVE_ECHO,
@@ -106,6 +106,16 @@ void     mm_at_serial_port_queue_command_cached (MMAtSerialPort *self,
                                                  MMAtSerialResponseFn callback,
                                                  gpointer user_data);
 
+void     mm_at_serial_port_queue_command_full (MMAtSerialPort *self,
+                                               const char *command,
+                                               guint32 timeout_seconds,
+                                               gboolean is_raw,
+                                               gboolean cached,
+                                               MMSerialPortPriority priority,
+                                               GCancellable *cancellable,
+                                               MMAtSerialResponseFn callback,
+                                               gpointer user_data);
+
 /*
  * Convert a string into a quoted and escaped string. Returns a new
  * allocated string. Follows ITU V.250 5.4.2.2 "String constants".
@@ -120,4 +130,13 @@ void     mm_at_serial_port_set_flags (MMAtSerialPort *self,
 
 MMAtPortFlag mm_at_serial_port_get_flags (MMAtSerialPort *self);
 
+/* Whether the command must go to the same port as the rest of the commands
+ * modifying or relying on the port setup */
+gboolean mm_at_serial_port_command_is_port_bound (const gchar *command);
+
+/* Open, non-connected port with less commands pending, the first one
+ * winning ties; NULL entries are skipped */
+MMAtSerialPort *mm_at_serial_port_peek_least_busy (MMAtSerialPort **ports,
+                                                   guint n_ports);
+
 #endif /* MM_AT_SERIAL_PORT_H */
@@ -13,6 +13,8 @@
  * Copyright (C) 2011 Aleksander Morgado <aleksander@gnu.org>
  */
 
+#include <string.h>
+
 #include <glib.h>
 #include <glib-object.h>
 
@@ -77,6 +79,58 @@ modem_cancellable_cancelled (GCancellable *modem_cancellable,
     g_cancellable_cancel (user_cancellable);
 }
 
+/*****************************************************************************/
+/* AT port selection */
+
+static gboolean
+sequence_is_port_bound (const MMBaseModemAtCommand *sequence)
+{
+    for (; sequence->command; sequence++) {
+        if (mm_at_serial_port_command_is_port_bound (sequence->command))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+static MMAtSerialPort *
+peek_least_busy_at_port (MMBaseModem *self,
+                         GError **error)
+{
+    MMAtSerialPort *ports[2];
+    MMAtSerialPort *best;
+
+    /* Primary first, so that it keeps getting all commands while idle. The
+     * secondary only joins once it got the same setup as the primary. */
+    ports[0] = mm_base_modem_peek_port_primary (self);
+    ports[1] = (mm_base_modem_get_secondary_balanced (self) ?
+                mm_base_modem_peek_port_secondary (self) :
+                NULL);
+
+    best = mm_at_serial_port_peek_least_busy (ports, G_N_ELEMENTS (ports));
+    if (best)
+        return best;
+
+    /* No port open yet */
+    return mm_base_modem_peek_best_at_port (self, error);
+}
+
+/* Independent commands go to the AT port with less commands pending */
+static MMAtSerialPort *
+select_at_port (MMBaseModem *self,
+                const gchar *command,
+                const MMBaseModemAtCommand *sequence,
+                gboolean is_raw,
+                GError **error)
+{
+    if (is_raw ||
+        (command && mm_at_serial_port_command_is_port_bound (command)) ||
+        (sequence && sequence_is_port_bound (sequence)))
+        return mm_base_modem_peek_best_at_port (self, error);
+
+    return peek_least_busy_at_port (self, error);
+}
+
 /*****************************************************************************/
 /* AT sequence handling */
 
@@ -93,6 +147,7 @@ typedef struct {
     gpointer response_processor_context;
     GDestroyNotify response_processor_context_free;
     GVariant *result;
+    MMSerialPortPriority priority;
 } AtSequenceContext;
 
 static void
@@ -196,24 +251,16 @@ at_sequence_parse_response (MMAtSerialPort *port,
         ctx->current++;
         if (ctx->current->command) {
             /* Schedule the next command in the probing group */
-            if (ctx->current->allow_cached)
-                mm_at_serial_port_queue_command_cached (
-                    ctx->port,
-                    ctx->current->command,
-                    ctx->current->timeout,
-                    FALSE,
-                    ctx->cancellable,
-                    (MMAtSerialResponseFn)at_sequence_parse_response,
-                    ctx);
-            else
-                mm_at_serial_port_queue_command (
-                    ctx->port,
-                    ctx->current->command,
-                    ctx->current->timeout,
-                    FALSE,
-                    ctx->cancellable,
-                    (MMAtSerialResponseFn)at_sequence_parse_response,
-                    ctx);
+            mm_at_serial_port_queue_command_full (
+                ctx->port,
+                ctx->current->command,
+                ctx->current->timeout,
+                FALSE,
+                ctx->current->allow_cached,
+                ctx->priority,
+                ctx->cancellable,
+                (MMAtSerialResponseFn)at_sequence_parse_response,
+                ctx);
             return;
         }
 
@@ -241,15 +288,16 @@ at_sequence_parse_response (MMAtSerialPort *port,
     g_object_unref (simple);
 }
 
-void
-mm_base_modem_at_sequence_full (MMBaseModem *self,
-                                MMAtSerialPort *port,
-                                const MMBaseModemAtCommand *sequence,
-                                gpointer response_processor_context,
-                                GDestroyNotify response_processor_context_free,
-                                GCancellable *cancellable,
-                                GAsyncReadyCallback callback,
-                                gpointer user_data)
+static void
+at_sequence_run (MMBaseModem *self,
+                 MMAtSerialPort *port,
+                 const MMBaseModemAtCommand *sequence,
+                 gpointer response_processor_context,
+                 GDestroyNotify response_processor_context_free,
+                 MMSerialPortPriority priority,
+                 GCancellable *cancellable,
+                 GAsyncReadyCallback callback,
+                 gpointer user_data)
 {
     AtSequenceContext *ctx;
 
@@ -268,6 +316,7 @@ mm_base_modem_at_sequence_full (MMBaseModem *self,
     ctx->current = ctx->sequence = sequence;
     ctx->response_processor_context = response_processor_context;
     ctx->response_processor_context_free = response_processor_context_free;
+    ctx->priority = priority;
 
     /* Setup cancellables */
     ctx->modem_cancellable = mm_base_modem_get_cancellable (self);
@@ -286,16 +335,59 @@ mm_base_modem_at_sequence_full (MMBaseModem *self,
     }
 
     /* Go on with the first one in the sequence */
-    mm_at_serial_port_queue_command (
+    mm_at_serial_port_queue_command_full (
         ctx->port,
         ctx->current->command,
         ctx->current->timeout,
         FALSE,
+        FALSE,
+        ctx->priority,
         ctx->cancellable,
         (MMAtSerialResponseFn)at_sequence_parse_response,
         ctx);
 }
 
+void
+mm_base_modem_at_sequence_full (MMBaseModem *self,
+                                MMAtSerialPort *port,
+                                const MMBaseModemAtCommand *sequence,
+                                gpointer response_processor_context,
+                                GDestroyNotify response_processor_context_free,
+                                GCancellable *cancellable,
+                                GAsyncReadyCallback callback,
+                                gpointer user_data)
+{
+    at_sequence_run (self,
+                     port,
+                     sequence,
+                     response_processor_context,
+                     response_processor_context_free,
+                     MM_SERIAL_PORT_PRIORITY_INTERACTIVE,
+                     cancellable,
+                     callback,
+                     user_data);
+}
+
+void
+mm_base_modem_at_sequence_background (MMBaseModem *self,
+                                      MMAtSerialPort *port,
+                                      const MMBaseModemAtCommand *sequence,
+                                      gpointer response_processor_context,
+                                      GDestroyNotify response_processor_context_free,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
+{
+    at_sequence_run (self,
+                     port,
+                     sequence,
+                     response_processor_context,
+                     response_processor_context_free,
+                     MM_SERIAL_PORT_PRIORITY_BACKGROUND,
+                     NULL,
+                     callback,
+                     user_data);
+}
+
 GVariant *
 mm_base_modem_at_sequence_finish (MMBaseModem *self,
                                   GAsyncResult *res,
@@ -321,7 +413,7 @@ mm_base_modem_at_sequence (MMBaseModem *self,
     GError *error = NULL;
 
     /* No port given, so we'll try to guess which is best */
-    port = mm_base_modem_peek_best_at_port (self, &error);
+    port = select_at_port (self, NULL, sequence, FALSE, &error);
     if (!port) {
         g_assert (error != NULL);
         g_simple_async_report_take_gerror_in_idle (G_OBJECT (self),
@@ -491,16 +583,17 @@ at_command_parse_response (MMAtSerialPort *port,
     at_command_context_free (ctx);
 }
 
-void
-mm_base_modem_at_command_full (MMBaseModem *self,
-                               MMAtSerialPort *port,
-                               const gchar *command,
-                               guint timeout,
-                               gboolean allow_cached,
-                               gboolean is_raw,
-                               GCancellable *cancellable,
-                               GAsyncReadyCallback callback,
-                               gpointer user_data)
+static void
+at_command_run (MMBaseModem *self,
+                MMAtSerialPort *port,
+                const gchar *command,
+                guint timeout,
+                gboolean allow_cached,
+                gboolean is_raw,
+                MMSerialPortPriority priority,
+                GCancellable *cancellable,
+                GAsyncReadyCallback callback,
+                gpointer user_data)
 {
     AtCommandContext *ctx;
 
@@ -533,24 +626,75 @@ mm_base_modem_at_command_full (MMBaseModem *self,
     }
 
     /* Go on with the command */
-    if (allow_cached)
-        mm_at_serial_port_queue_command_cached (
-            port,
-            command,
-            timeout,
-            is_raw,
-            ctx->cancellable,
-            (MMAtSerialResponseFn)at_command_parse_response,
-            ctx);
-    else
-        mm_at_serial_port_queue_command (
-            port,
-            command,
-            timeout,
-            is_raw,
-            ctx->cancellable,
-            (MMAtSerialResponseFn)at_command_parse_response,
-            ctx);
+    mm_at_serial_port_queue_command_full (
+        port,
+        command,
+        timeout,
+        is_raw,
+        allow_cached,
+        priority,
+        ctx->cancellable,
+        (MMAtSerialResponseFn)at_command_parse_response,
+        ctx);
+}
+
+void
+mm_base_modem_at_command_full (MMBaseModem *self,
+                               MMAtSerialPort *port,
+                               const gchar *command,
+                               guint timeout,
+                               gboolean allow_cached,
+                               gboolean is_raw,
+                               GCancellable *cancellable,
+                               GAsyncReadyCallback callback,
+                               gpointer user_data)
+{
+    at_command_run (self,
+                    port,
+                    command,
+                    timeout,
+                    allow_cached,
+                    is_raw,
+                    MM_SERIAL_PORT_PRIORITY_INTERACTIVE,
+                    cancellable,
+                    callback,
+                    user_data);
+}
+
+void
+mm_base_modem_at_command_background (MMBaseModem *self,
+                                     MMAtSerialPort *port,
+                                     const gchar *command,
+                                     guint timeout,
+                                     gboolean allow_cached,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+    /* No port given, so we'll try to guess which is best */
+    if (!port) {
+        GError *error = NULL;
+
+        port = select_at_port (self, command, NULL, FALSE, &error);
+        if (!port) {
+            g_assert (error != NULL);
+            g_simple_async_report_take_gerror_in_idle (G_OBJECT (self),
+                                                       callback,
+                                                       user_data,
+                                                       error);
+            return;
+        }
+    }
+
+    at_command_run (self,
+                    port,
+                    command,
+                    timeout,
+                    allow_cached,
+                    FALSE,
+                    MM_SERIAL_PORT_PRIORITY_BACKGROUND,
+                    NULL,
+                    callback,
+                    user_data);
 }
 
 const gchar *
@@ -574,7 +718,7 @@ _at_command (MMBaseModem *self,
     GError *error = NULL;
 
     /* No port given, so we'll try to guess which is best */
-    port = mm_base_modem_peek_best_at_port (self, &error);
+    port = select_at_port (self, command, NULL, is_raw, &error);
     if (!port) {
         g_assert (error != NULL);
         g_simple_async_report_take_gerror_in_idle (G_OBJECT (self),
@@ -64,7 +64,8 @@ typedef struct {
 } MMBaseModemAtCommand;
 
 /* Generic AT sequence handling, using the best AT port available and without
- * explicit cancellations. */
+ * explicit cancellations. As with mm_base_modem_at_command(), sequences which
+ * don't change the port setup may be sent to the secondary port. */
 void     mm_base_modem_at_sequence         (MMBaseModem *self,
                                             const MMBaseModemAtCommand *sequence,
                                             gpointer response_processor_context,
@@ -91,6 +92,17 @@ GVariant *mm_base_modem_at_sequence_full_finish (MMBaseModem *self,
                                                  gpointer *response_processor_context,
                                                  GError **error);
 
+/* AT sequence queued at background priority, for periodic polls; identical
+ * commands already pending are answered together. Finish with
+ * mm_base_modem_at_sequence_full_finish(). */
+void     mm_base_modem_at_sequence_background   (MMBaseModem *self,
+                                                 MMAtSerialPort *port,
+                                                 const MMBaseModemAtCommand *sequence,
+                                                 gpointer response_processor_context,
+                                                 GDestroyNotify response_processor_context_free,
+                                                 GAsyncReadyCallback callback,
+                                                 gpointer user_data);
+
 /* Common helper response processors */
 
 /* Every string received as response, will be set as result */
@@ -131,7 +143,8 @@ gboolean mm_base_modem_response_processor_continue_on_error (MMBaseModem *self,
                                                              GError **result_error);
 
 /* Generic AT command handling, using the best AT port available and without
- * explicit cancellations. */
+ * explicit cancellations. Commands which don't change the port setup may be
+ * sent to the secondary port if the primary one is busy. */
 void mm_base_modem_at_command                (MMBaseModem *self,
                                               const gchar *command,
                                               guint timeout,
@@ -164,4 +177,14 @@ const gchar *mm_base_modem_at_command_full_finish (MMBaseModem *self,
                                                    GAsyncResult *res,
                                                    GError **error);
 
+/* AT command queued at background priority, for periodic polls; uses the
+ * best AT port if none given. Finish with mm_base_modem_at_command_finish(). */
+void mm_base_modem_at_command_background          (MMBaseModem *self,
+                                                   MMAtSerialPort *port,
+                                                   const gchar *command,
+                                                   guint timeout,
+                                                   gboolean allow_cached,
+                                                   GAsyncReadyCallback callback,
+                                                   gpointer user_data);
+
 #endif /* MM_BASE_MODEM_AT_H */
@@ -30,6 +30,7 @@
 #include "mm-base-modem.h"
 
 #include "mm-log.h"
+#include "mm-context.h"
 #include "mm-serial-enums-types.h"
 #include "mm-serial-parsers.h"
 #include "mm-modem-helpers.h"
@@ -80,8 +81,13 @@ struct _MMBaseModemPrivate {
     MMAtSerialPort *primary;
     MMAtSerialPort *secondary;
     MMQcdmSerialPort *qcdm;
+    MMWmcSerialPort *wmc;
     GList *data;
 
+    /* Whether the secondary port got the same setup as the primary and can
+     * therefore take balanced commands */
+    gboolean secondary_balanced;
+
     /* GPS-enabled modems will have an AT port for control, and a raw serial
      * port to receive all GPS traces */
     MMAtSerialPort *gps_control;
@@ -199,6 +205,9 @@ mm_base_modem_grab_port (MMBaseModem *self,
         if (ptype == MM_PORT_TYPE_QCDM)
             /* QCDM port */
             port = MM_PORT (mm_qcdm_serial_port_new (name));
+        else if (ptype == MM_PORT_TYPE_WMC)
+            /* WMC port */
+            port = MM_PORT (mm_wmc_serial_port_new (name));
         else if (ptype == MM_PORT_TYPE_AT) {
             /* AT port */
             port = MM_PORT (mm_at_serial_port_new (name));
@@ -224,6 +233,18 @@ mm_base_modem_grab_port (MMBaseModem *self,
             return FALSE;
         }
 
+        /* Optionally read from the port in a worker thread */
+        if (mm_context_get_serial_io_threads ())
+            g_object_set (port,
+                          MM_SERIAL_PORT_IO_THREAD, TRUE,
+                          NULL);
+
+        /* Optionally keep per-port buffers small */
+        if (mm_context_get_low_memory ())
+            g_object_set (port,
+                          MM_SERIAL_PORT_LOW_MEMORY, TRUE,
+                          NULL);
+
         /* For serial ports, enable port timeout checks */
         g_signal_connect (port,
                           "timed-out",
@@ -318,6 +339,9 @@ mm_base_modem_release_port (MMBaseModem *self,
     if (port == (MMPort *)self->priv->qcdm)
         g_clear_object (&self->priv->qcdm);
 
+    if (port == (MMPort *)self->priv->wmc)
+        g_clear_object (&self->priv->wmc);
+
     if (port == (MMPort *)self->priv->gps_control)
         g_clear_object (&self->priv->gps_control);
 
@@ -499,6 +523,23 @@ mm_base_modem_peek_port_secondary (MMBaseModem *self)
     return self->priv->secondary;
 }
 
+gboolean
+mm_base_modem_get_secondary_balanced (MMBaseModem *self)
+{
+    g_return_val_if_fail (MM_IS_BASE_MODEM (self), FALSE);
+
+    return (self->priv->secondary && self->priv->secondary_balanced);
+}
+
+void
+mm_base_modem_set_secondary_balanced (MMBaseModem *self,
+                                      gboolean balanced)
+{
+    g_return_if_fail (MM_IS_BASE_MODEM (self));
+
+    self->priv->secondary_balanced = balanced;
+}
+
 MMQcdmSerialPort *
 mm_base_modem_get_port_qcdm (MMBaseModem *self)
 {
@@ -515,6 +556,22 @@ mm_base_modem_peek_port_qcdm (MMBaseModem *self)
     return self->priv->qcdm;
 }
 
+MMWmcSerialPort *
+mm_base_modem_get_port_wmc (MMBaseModem *self)
+{
+    g_return_val_if_fail (MM_IS_BASE_MODEM (self), NULL);
+
+    return (self->priv->wmc ? g_object_ref (self->priv->wmc) : NULL);
+}
+
+MMWmcSerialPort *
+mm_base_modem_peek_port_wmc (MMBaseModem *self)
+{
+    g_return_val_if_fail (MM_IS_BASE_MODEM (self), NULL);
+
+    return self->priv->wmc;
+}
+
 MMAtSerialPort *
 mm_base_modem_get_port_gps_control (MMBaseModem *self)
 {
@@ -847,6 +904,7 @@ mm_base_modem_organize_ports (MMBaseModem *self,
     MMAtSerialPort *secondary = NULL;
     MMAtSerialPort *backup_secondary = NULL;
     MMQcdmSerialPort *qcdm = NULL;
+    MMWmcSerialPort *wmc = NULL;
     MMAtSerialPort *gps_control = NULL;
     MMGpsSerialPort *gps = NULL;
     MMPort *data_primary = NULL;
@@ -912,6 +970,12 @@ mm_base_modem_organize_ports (MMBaseModem *self,
                 qcdm = MM_QCDM_SERIAL_PORT (candidate);
             break;
 
+        case MM_PORT_TYPE_WMC:
+            g_assert (MM_IS_WMC_SERIAL_PORT (candidate));
+            if (!wmc)
+                wmc = MM_WMC_SERIAL_PORT (candidate);
+            break;
+
         case MM_PORT_TYPE_NET:
             /* Net device (if any) is the preferred data port */
             if (!data_primary || MM_IS_AT_SERIAL_PORT (data_primary))
@@ -1005,6 +1069,7 @@ mm_base_modem_organize_ports (MMBaseModem *self,
     for (l = data; l; l = g_list_next (l))
         log_port (self, MM_PORT (l->data),  "data (secondary)");
     log_port (self, MM_PORT (qcdm),         "qcdm");
+    log_port (self, MM_PORT (wmc),          "wmc");
     log_port (self, MM_PORT (gps_control),  "gps (control)");
     log_port (self, MM_PORT (gps),          "gps (nmea)");
 #if defined WITH_QMI
@@ -1017,6 +1082,7 @@ mm_base_modem_organize_ports (MMBaseModem *self,
     self->priv->primary = g_object_ref (primary);
     self->priv->secondary = (secondary ? g_object_ref (secondary) : NULL);
     self->priv->qcdm = (qcdm ? g_object_ref (qcdm) : NULL);
+    self->priv->wmc = (wmc ? g_object_ref (wmc) : NULL);
     self->priv->gps_control = (gps_control ? g_object_ref (gps_control) : NULL);
     self->priv->gps = (gps ? g_object_ref (gps) : NULL);
 
@@ -1132,6 +1198,123 @@ mm_base_modem_get_product_id (MMBaseModem *self)
     return self->priv->product_id;
 }
 
+void
+mm_base_modem_setup_step_scheduler (MMBaseModem *self,
+                                    MMStepScheduler *scheduler)
+{
+    guint n_at = 0;
+
+    g_return_if_fail (MM_IS_BASE_MODEM (self));
+
+    /* Commands are balanced across the open primary port and the secondary
+     * port, but the secondary only joins once it got the same setup as the
+     * primary, which happens when enabling. Counting ports which aren't in
+     * the balancer would let steps queue up in the primary thinking they
+     * run concurrently. */
+    if (self->priv->primary && mm_serial_port_is_open (MM_SERIAL_PORT (self->priv->primary)))
+        n_at++;
+    if (mm_base_modem_get_secondary_balanced (self) &&
+        mm_serial_port_is_open (MM_SERIAL_PORT (self->priv->secondary)))
+        n_at++;
+    mm_step_scheduler_set_port_slots (scheduler, MM_STEP_PORT_AT, n_at);
+    mm_step_scheduler_set_port_slots (scheduler, MM_STEP_PORT_QCDM, self->priv->qcdm ? 1 : 0);
+#if defined WITH_QMI
+    mm_step_scheduler_set_port_slots (scheduler, MM_STEP_PORT_QMI, g_list_length (self->priv->qmi));
+#endif
+
+    mm_step_scheduler_set_trace_track (scheduler, self->priv->device);
+}
+
+/*****************************************************************************/
+/* Memory accounting */
+
+static gsize
+port_get_memory_usage (MMPort *port)
+{
+    GTypeQuery query;
+
+    if (MM_IS_SERIAL_PORT (port))
+        return mm_serial_port_get_memory_usage (MM_SERIAL_PORT (port));
+
+    g_type_query (G_OBJECT_TYPE (port), &query);
+    return query.instance_size;
+}
+
+static gsize
+interface_get_memory_usage (GDBusInterfaceSkeleton *skeleton)
+{
+    GDBusInterfaceInfo *info;
+    GVariant *properties;
+    GTypeQuery query;
+    gsize usage;
+    guint i;
+
+    g_type_query (G_OBJECT_TYPE (skeleton), &query);
+    usage = query.instance_size;
+
+    /* Property values are kept as GValues; the serialized size of the
+     * properties is a good enough estimate of what they hold */
+    info = g_dbus_interface_skeleton_get_info (skeleton);
+    for (i = 0; info->properties && info->properties[i]; i++)
+        usage += sizeof (GValue);
+
+    properties = g_dbus_interface_skeleton_get_properties (skeleton);
+    usage += g_variant_get_size (properties);
+    g_variant_unref (properties);
+
+    return usage;
+}
+
+GVariant *
+mm_base_modem_get_memory_report (MMBaseModem *self)
+{
+    GVariantBuilder builder;
+    GVariantBuilder ports;
+    GVariantBuilder interfaces;
+    GHashTableIter iter;
+    gpointer value;
+    GList *list;
+    GList *l;
+    GTypeQuery query;
+    guint64 usage;
+    guint64 total;
+
+    g_return_val_if_fail (MM_IS_BASE_MODEM (self), NULL);
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+
+    g_type_query (G_OBJECT_TYPE (self), &query);
+    total = query.instance_size + sizeof (MMBaseModemPrivate);
+    g_variant_builder_add (&builder, "{sv}", "object", g_variant_new_uint64 (total));
+
+    g_variant_builder_init (&ports, G_VARIANT_TYPE ("a{st}"));
+    g_hash_table_iter_init (&iter, self->priv->ports);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        usage = port_get_memory_usage (MM_PORT (value));
+        g_variant_builder_add (&ports, "{st}", mm_port_get_device (MM_PORT (value)), usage);
+        total += usage;
+    }
+    g_variant_builder_add (&builder, "{sv}", "ports", g_variant_builder_end (&ports));
+
+    g_variant_builder_init (&interfaces, G_VARIANT_TYPE ("a{st}"));
+    list = g_dbus_object_get_interfaces (G_DBUS_OBJECT (self));
+    for (l = list; l; l = g_list_next (l)) {
+        GDBusInterfaceSkeleton *skeleton = l->data;
+
+        usage = interface_get_memory_usage (skeleton);
+        g_variant_builder_add (&interfaces, "{st}",
+                               g_dbus_interface_skeleton_get_info (skeleton)->name,
+                               usage);
+        total += usage;
+    }
+    g_list_free_full (list, (GDestroyNotify)g_object_unref);
+    g_variant_builder_add (&builder, "{sv}", "interfaces", g_variant_builder_end (&interfaces));
+
+    g_variant_builder_add (&builder, "{sv}", "total", g_variant_new_uint64 (total));
+
+    return g_variant_builder_end (&builder);
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -1306,6 +1489,7 @@ dispose (GObject *object)
     g_list_free_full (self->priv->data, g_object_unref);
     self->priv->data = NULL;
     g_clear_object (&self->priv->qcdm);
+    g_clear_object (&self->priv->wmc);
     g_clear_object (&self->priv->gps_control);
     g_clear_object (&self->priv->gps);
 #if defined WITH_QMI
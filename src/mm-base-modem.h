@@ -29,7 +29,9 @@
 #include "mm-port.h"
 #include "mm-at-serial-port.h"
 #include "mm-qcdm-serial-port.h"
+#include "mm-wmc-serial-port.h"
 #include "mm-gps-serial-port.h"
+#include "mm-step-scheduler.h"
 
 #if defined WITH_QMI
 #include "mm-qmi-port.h"
@@ -120,6 +122,7 @@ gboolean  mm_base_modem_organize_ports (MMBaseModem *self,
 MMAtSerialPort   *mm_base_modem_peek_port_primary      (MMBaseModem *self);
 MMAtSerialPort   *mm_base_modem_peek_port_secondary    (MMBaseModem *self);
 MMQcdmSerialPort *mm_base_modem_peek_port_qcdm         (MMBaseModem *self);
+MMWmcSerialPort  *mm_base_modem_peek_port_wmc          (MMBaseModem *self);
 MMAtSerialPort   *mm_base_modem_peek_port_gps_control  (MMBaseModem *self);
 MMGpsSerialPort  *mm_base_modem_peek_port_gps          (MMBaseModem *self);
 #if defined WITH_QMI
@@ -130,9 +133,15 @@ MMAtSerialPort   *mm_base_modem_peek_best_at_port      (MMBaseModem *self, GErro
 MMPort           *mm_base_modem_peek_best_data_port    (MMBaseModem *self);
 GList            *mm_base_modem_peek_data_ports        (MMBaseModem *self);
 
+/* Set once the secondary port runs with the same setup as the primary one */
+gboolean mm_base_modem_get_secondary_balanced (MMBaseModem *self);
+void     mm_base_modem_set_secondary_balanced (MMBaseModem *self,
+                                               gboolean balanced);
+
 MMAtSerialPort   *mm_base_modem_get_port_primary      (MMBaseModem *self);
 MMAtSerialPort   *mm_base_modem_get_port_secondary    (MMBaseModem *self);
 MMQcdmSerialPort *mm_base_modem_get_port_qcdm         (MMBaseModem *self);
+MMWmcSerialPort  *mm_base_modem_get_port_wmc          (MMBaseModem *self);
 MMAtSerialPort   *mm_base_modem_get_port_gps_control  (MMBaseModem *self);
 MMGpsSerialPort  *mm_base_modem_get_port_gps          (MMBaseModem *self);
 #if defined WITH_QMI
@@ -158,6 +167,17 @@ const gchar  *mm_base_modem_get_plugin  (MMBaseModem *self);
 guint mm_base_modem_get_vendor_id  (MMBaseModem *self);
 guint mm_base_modem_get_product_id (MMBaseModem *self);
 
+/* Estimated memory used by the modem object, its ports and its D-Bus
+ * interfaces, in bytes, as a dictionary with "object" (t), "ports" (a{st}),
+ * "interfaces" (a{st}) and "total" (t) keys. Contexts attached to the modem
+ * as object data are not accounted. */
+GVariant *mm_base_modem_get_memory_report (MMBaseModem *self);
+
+/* Lets the scheduler run as many steps at once as the modem has ports of
+ * each kind */
+void mm_base_modem_setup_step_scheduler (MMBaseModem *self,
+                                         MMStepScheduler *scheduler);
+
 GCancellable *mm_base_modem_peek_cancellable (MMBaseModem *self);
 GCancellable *mm_base_modem_get_cancellable  (MMBaseModem *self);
 
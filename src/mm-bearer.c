@@ -34,6 +34,7 @@
 #include "mm-base-modem-at.h"
 #include "mm-base-modem.h"
 #include "mm-log.h"
+#include "mm-trace.h"
 #include "mm-modem-helpers.h"
 
 /* We require up to 20s to get a proper IP when using PPP */
@@ -77,6 +78,9 @@ struct _MMBearerPrivate {
     GCancellable *connect_cancellable;
     /* handler id for the disconnect + cancel connect request */
     gulong disconnect_signal_handler;
+    /* Start of the ongoing connection/disconnection, when tracing */
+    gint64 connect_trace_start;
+    gint64 disconnect_trace_start;
 
     /*-- 3GPP specific --*/
     /* Reason if 3GPP connection is forbidden */
@@ -387,6 +391,8 @@ connect_ready (MMBearer *self,
         mm_dbg ("Couldn't connect bearer '%s': '%s'",
                 self->priv->path,
                 error->message);
+        mm_trace_span ("bearer", self->priv->path, self->priv->connect_trace_start,
+                       "connect", error->message);
         if (g_error_matches (error,
                              MM_CORE_ERROR,
                              MM_CORE_ERROR_CANCELLED)) {
@@ -400,6 +406,8 @@ connect_ready (MMBearer *self,
     /* Handle cancellations detected after successful connection */
     else if (g_cancellable_is_cancelled (self->priv->connect_cancellable)) {
         mm_dbg ("Connected bearer '%s', but need to disconnect", self->priv->path);
+        mm_trace_span ("bearer", self->priv->path, self->priv->connect_trace_start,
+                       "connect", "cancelled");
 
         g_clear_object (&data);
         g_clear_object (&ipv4_config);
@@ -414,6 +422,8 @@ connect_ready (MMBearer *self,
     }
     else {
         mm_dbg ("Connected bearer '%s'", self->priv->path);
+        mm_trace_span ("bearer", self->priv->path, self->priv->connect_trace_start,
+                       "connect", NULL);
 
         /* Update bearer and interface status */
         bearer_update_status_connected (self,
@@ -519,6 +529,7 @@ mm_bearer_connect (MMBearer *self,
     /* Connecting! */
     mm_dbg ("Connecting bearer '%s'", self->priv->path);
     self->priv->connect_cancellable = g_cancellable_new ();
+    self->priv->connect_trace_start = mm_trace_begin ();
     bearer_update_status (self, MM_BEARER_STATUS_CONNECTING);
     MM_BEARER_GET_CLASS (self)->connect (
         self,
@@ -616,11 +627,15 @@ disconnect_ready (MMBearer *self,
 
     if (!MM_BEARER_GET_CLASS (self)->disconnect_finish (self, res, &error)) {
         mm_dbg ("Couldn't disconnect bearer '%s'", self->priv->path);
+        mm_trace_span ("bearer", self->priv->path, self->priv->disconnect_trace_start,
+                       "disconnect", error->message);
         bearer_update_status (self, MM_BEARER_STATUS_CONNECTED);
         g_simple_async_result_take_error (simple, error);
     }
     else {
         mm_dbg ("Disconnected bearer '%s'", self->priv->path);
+        mm_trace_span ("bearer", self->priv->path, self->priv->disconnect_trace_start,
+                       "disconnect", NULL);
         bearer_update_status (self, MM_BEARER_STATUS_DISCONNECTED);
         g_simple_async_result_set_op_res_gboolean (simple, TRUE);
     }
@@ -710,6 +725,7 @@ mm_bearer_disconnect (MMBearer *self,
     }
 
     /* Disconnecting! */
+    self->priv->disconnect_trace_start = mm_trace_begin ();
     bearer_update_status (self, MM_BEARER_STATUS_DISCONNECTING);
     MM_BEARER_GET_CLASS (self)->disconnect (
         self,
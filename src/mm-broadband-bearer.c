@@ -33,6 +33,7 @@
 #include "mm-base-modem-at.h"
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
+#include "mm-regex-cache.h"
 #include "mm-serial-enums-types.h"
 
 static void async_initable_iface_init (GAsyncInitableIface *iface);
@@ -811,9 +812,9 @@ parse_cid_range (MMBaseModem *modem,
         return TRUE;
     }
 
-    r = g_regex_new ("\\+CGDCONT:\\s*\\((\\d+)-(\\d+)\\),\\(?\"(\\S+)\"",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                     0, &inner_error);
+    r = mm_regex_cache_get ("\\+CGDCONT:\\s*\\((\\d+)-(\\d+)\\),\\(?\"(\\S+)\"",
+                            G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
+                            0, &inner_error);
     if (r) {
         g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
         cid = 0;
@@ -2987,6 +2987,44 @@ get_3gpp_access_technology (GArray *array,
     return MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
 }
 
+static GList *
+nas_network_scan_output_get_networks (QmiMessageNasNetworkScanOutput *output)
+{
+    GList *scan_result = NULL;
+    GArray *info_array = NULL;
+
+    if (qmi_message_nas_network_scan_output_get_network_information (output, &info_array, NULL)) {
+        GArray *rat_array = NULL;
+        gboolean *rat_array_used_flags = NULL;
+        guint i;
+
+        /* Get optional RAT array */
+        qmi_message_nas_network_scan_output_get_radio_access_technology (output, &rat_array, NULL);
+        if (rat_array)
+            rat_array_used_flags = g_new0 (gboolean, rat_array->len);
+
+        for (i = 0; i < info_array->len; i++) {
+            QmiMessageNasNetworkScanOutputNetworkInformationElement *info_element;
+            MM3gppNetworkInfo *info;
+
+            info_element = &g_array_index (info_array, QmiMessageNasNetworkScanOutputNetworkInformationElement, i);
+
+            info = get_3gpp_network_info (info_element);
+            if (rat_array)
+                info->access_tech = get_3gpp_access_technology (rat_array,
+                                                                rat_array_used_flags,
+                                                                info_element->mcc,
+                                                                info_element->mnc);
+
+            scan_result = g_list_append (scan_result, info);
+        }
+
+        g_free (rat_array_used_flags);
+    }
+
+    return scan_result;
+}
+
 static void
 nas_network_scan_ready (QmiClientNas *client,
                         GAsyncResult *res,
@@ -3003,41 +3041,11 @@ nas_network_scan_ready (QmiClientNas *client,
         g_prefix_error (&error, "Couldn't scan networks: ");
         g_simple_async_result_take_error (simple, error);
     } else {
-        GList *scan_result = NULL;
-        GArray *info_array = NULL;
-
-        if (qmi_message_nas_network_scan_output_get_network_information (output, &info_array, NULL)) {
-            GArray *rat_array = NULL;
-            gboolean *rat_array_used_flags = NULL;
-            guint i;
-
-            /* Get optional RAT array */
-            qmi_message_nas_network_scan_output_get_radio_access_technology (output, &rat_array, NULL);
-            if (rat_array)
-                rat_array_used_flags = g_new0 (gboolean, rat_array->len);
-
-            for (i = 0; i < info_array->len; i++) {
-                QmiMessageNasNetworkScanOutputNetworkInformationElement *info_element;
-                MM3gppNetworkInfo *info;
-
-                info_element = &g_array_index (info_array, QmiMessageNasNetworkScanOutputNetworkInformationElement, i);
-
-                info = get_3gpp_network_info (info_element);
-                if (rat_array)
-                    info->access_tech = get_3gpp_access_technology (rat_array,
-                                                                    rat_array_used_flags,
-                                                                    info_element->mcc,
-                                                                    info_element->mnc);
-
-                scan_result = g_list_append (scan_result, info);
-            }
-
-            g_free (rat_array_used_flags);
-        }
-
         /* We *require* a callback in the async method, as we're not setting a
          * GDestroyNotify callback */
-        g_simple_async_result_set_op_res_gpointer (simple, scan_result, NULL);
+        g_simple_async_result_set_op_res_gpointer (simple,
+                                                   nas_network_scan_output_get_networks (output),
+                                                   NULL);
     }
 
     if (output)
@@ -3079,6 +3087,120 @@ modem_3gpp_scan_networks (MMIfaceModem3gpp *self,
                                  result);
 }
 
+/*****************************************************************************/
+/* Scan networks step by step (3GPP interface) */
+
+/* Background scans look for one access technology at a time, so that each
+ * request is shorter and the networks found so far can be reported */
+static const QmiNasNetworkScanType scan_networks_steps[] = {
+    QMI_NAS_NETWORK_SCAN_TYPE_GSM,
+    QMI_NAS_NETWORK_SCAN_TYPE_UMTS,
+    QMI_NAS_NETWORK_SCAN_TYPE_LTE
+};
+
+typedef struct {
+    GList *networks;
+    gboolean more;
+} ScanNetworksStepResult;
+
+static void
+scan_networks_step_result_free (ScanNetworksStepResult *step_result)
+{
+    mm_3gpp_network_info_list_free (step_result->networks);
+    g_slice_free (ScanNetworksStepResult, step_result);
+}
+
+static GList *
+modem_3gpp_scan_networks_step_finish (MMIfaceModem3gpp *self,
+                                      GAsyncResult *res,
+                                      gboolean *more,
+                                      GError **error)
+{
+    ScanNetworksStepResult *step_result;
+    GList *networks;
+
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return NULL;
+
+    step_result = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
+    *more = step_result->more;
+    networks = step_result->networks;
+    step_result->networks = NULL;
+    return networks;
+}
+
+static void
+nas_network_scan_step_ready (QmiClientNas *client,
+                             GAsyncResult *res,
+                             GSimpleAsyncResult *simple)
+{
+    QmiMessageNasNetworkScanOutput *output = NULL;
+    GError *error = NULL;
+
+    output = qmi_client_nas_network_scan_finish (client, res, &error);
+    if (!output) {
+        g_prefix_error (&error, "QMI operation failed: ");
+        g_simple_async_result_take_error (simple, error);
+    } else if (!qmi_message_nas_network_scan_output_get_result (output, &error)) {
+        g_prefix_error (&error, "Couldn't scan networks: ");
+        g_simple_async_result_take_error (simple, error);
+    } else {
+        ScanNetworksStepResult *step_result;
+
+        step_result = g_simple_async_result_get_op_res_gpointer (simple);
+        step_result->networks = nas_network_scan_output_get_networks (output);
+    }
+
+    if (output)
+        qmi_message_nas_network_scan_output_unref (output);
+
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+}
+
+static void
+modem_3gpp_scan_networks_step (MMIfaceModem3gpp *self,
+                               guint step,
+                               GAsyncReadyCallback callback,
+                               gpointer user_data)
+{
+    GSimpleAsyncResult *result;
+    QmiMessageNasNetworkScanInput *input;
+    ScanNetworksStepResult *step_result;
+    QmiClient *client = NULL;
+
+    g_assert (callback != NULL);
+    g_assert (step < G_N_ELEMENTS (scan_networks_steps));
+
+    if (!ensure_qmi_client (MM_BROADBAND_MODEM_QMI (self),
+                            QMI_SERVICE_NAS, &client,
+                            callback, user_data))
+        return;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        modem_3gpp_scan_networks_step);
+
+    step_result = g_slice_new0 (ScanNetworksStepResult);
+    step_result->more = (step + 1 < G_N_ELEMENTS (scan_networks_steps));
+    g_simple_async_result_set_op_res_gpointer (result,
+                                               step_result,
+                                               (GDestroyNotify)scan_networks_step_result_free);
+
+    input = qmi_message_nas_network_scan_input_new ();
+    qmi_message_nas_network_scan_input_set_network_type (input, scan_networks_steps[step], NULL);
+
+    mm_dbg ("Scanning networks (step %u)...", step);
+    qmi_client_nas_network_scan (QMI_CLIENT_NAS (client),
+                                 input,
+                                 100,
+                                 NULL,
+                                 (GAsyncReadyCallback)nas_network_scan_step_ready,
+                                 result);
+    qmi_message_nas_network_scan_input_unref (input);
+}
+
 /*****************************************************************************/
 /* Load operator name (3GPP interface) */
 
@@ -7539,6 +7661,8 @@ iface_modem_3gpp_init (MMIfaceModem3gpp *iface)
     /* Other actions */
     iface->scan_networks = modem_3gpp_scan_networks;
     iface->scan_networks_finish = modem_3gpp_scan_networks_finish;
+    iface->scan_networks_step = modem_3gpp_scan_networks_step;
+    iface->scan_networks_step_finish = modem_3gpp_scan_networks_step_finish;
     iface->register_in_network = modem_3gpp_register_in_network;
     iface->register_in_network_finish = modem_3gpp_register_in_network_finish;
     iface->run_registration_checks = modem_3gpp_run_registration_checks;
@@ -43,10 +43,17 @@
 #include "mm-sim.h"
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
+#include "mm-regex-cache.h"
 #include "mm-error-helpers.h"
 #include "mm-qcdm-serial-port.h"
+#include "mm-qcdm-log-capture.h"
+#include "mm-wmc-serial-port.h"
+#include "mm-timer-wheel.h"
+#include "mm-context.h"
+#include "mm-trace.h"
 #include "libqcdm/src/errors.h"
 #include "libqcdm/src/commands.h"
+#include "libwmc/src/commands.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_3gpp_init (MMIfaceModem3gpp *iface);
@@ -102,10 +109,16 @@ enum {
 #define CIND_INDICATOR_IS_VALID(u) (u != CIND_INDICATOR_INVALID)
 
 typedef struct _PortsContext PortsContext;
+typedef struct _QcdmSnapshot QcdmSnapshot;
+typedef struct _QcdmSnapshotContext QcdmSnapshotContext;
 
 struct _MMBroadbandModemPrivate {
     /* Broadband modem specific implementation */
     PortsContext *enabled_ports_ctx;
+    MMQcdmLogCapture *qcdm_log_capture;
+    /* Last QCDM status snapshot, and the one being loaded if any */
+    QcdmSnapshot *qcdm_snapshot;
+    QcdmSnapshotContext *qcdm_snapshot_ctx;
 
     /*<--- Modem interface --->*/
     /* Properties */
@@ -129,8 +142,6 @@ struct _MMBroadbandModemPrivate {
     MMModem3gppRegistrationState modem_3gpp_registration_state;
     gboolean modem_3gpp_cs_network_supported;
     gboolean modem_3gpp_ps_network_supported;
-    /* Implementation helpers */
-    GPtrArray *modem_3gpp_registration_regex;
 
     /*<--- Modem 3GPP USSD interface --->*/
     /* Properties */
@@ -1424,6 +1435,375 @@ modem_load_supported_modes (MMIfaceModem *self,
     load_supported_modes_step (ctx);
 }
 
+/*****************************************************************************/
+/* QCDM status snapshot */
+
+/* Signal quality and access technology checks run together, so items loaded
+ * this recently are reused instead of querying the modem again. */
+#define QCDM_SNAPSHOT_MAX_AGE_USEC (MM_TIMER_WHEEL_PERIODIC_COALESCE_SEC * G_USEC_PER_SEC)
+
+typedef enum {
+    QCDM_SNAPSHOT_PILOT_SETS, /* CDMA modems */
+    QCDM_SNAPSHOT_CM,         /* CDMA modems */
+    QCDM_SNAPSHOT_HDR,        /* CDMA modems */
+    QCDM_SNAPSHOT_GSM,        /* 3GPP modems */
+    QCDM_SNAPSHOT_WCDMA,      /* 3GPP modems */
+    QCDM_SNAPSHOT_LAST
+} QcdmSnapshotItem;
+
+#define QCDM_SNAPSHOT_ITEM(item) (1 << (item))
+
+struct _QcdmSnapshot {
+    /* QCDM_SNAPSHOT_ITEM() mask of the items loaded successfully, and when */
+    guint valid;
+    gint64 timestamp[QCDM_SNAPSHOT_LAST];
+
+    /* Pilot sets */
+    guint32 num_active;
+    gfloat best_db;
+
+    /* CM and HDR subsystems */
+    guint32 cm_opmode;
+    guint32 cm_sysmode;
+    gboolean hybrid;
+    gboolean evdo_open;
+
+    /* GSM and WCDMA subsystems */
+    guint8 gsm_opmode;
+    guint8 gsm_sysmode;
+    gboolean wcdma_open;
+};
+
+struct _QcdmSnapshotContext {
+    MMBroadbandModem *self;
+    /* Items being loaded */
+    guint items;
+    guint pending;
+    GList *waiters;
+};
+
+static const QcdmSnapshot *
+qcdm_snapshot_load_finish (MMBroadbandModem *self,
+                           GAsyncResult *res)
+{
+    return g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
+}
+
+static void
+qcdm_snapshot_complete (GSimpleAsyncResult *result,
+                        const QcdmSnapshot *snapshot)
+{
+    g_simple_async_result_set_op_res_gpointer (result,
+                                               g_memdup (snapshot, sizeof (*snapshot)),
+                                               g_free);
+    g_simple_async_result_complete (result);
+    g_object_unref (result);
+}
+
+/* Failed items are flagged as not valid, so that they are retried right away
+ * instead of being served from the snapshot */
+static void
+qcdm_snapshot_item_loaded (QcdmSnapshotContext *ctx,
+                           QcdmSnapshotItem item,
+                           gboolean success)
+{
+    QcdmSnapshot *snapshot = ctx->self->priv->qcdm_snapshot;
+
+    if (success) {
+        snapshot->valid |= QCDM_SNAPSHOT_ITEM (item);
+        snapshot->timestamp[item] = g_get_monotonic_time ();
+    } else
+        snapshot->valid &= ~QCDM_SNAPSHOT_ITEM (item);
+}
+
+static void
+qcdm_snapshot_request_done (QcdmSnapshotContext *ctx)
+{
+    GList *l;
+
+    g_assert (ctx->pending > 0);
+    if (--ctx->pending > 0)
+        return;
+
+    ctx->self->priv->qcdm_snapshot_ctx = NULL;
+
+    for (l = ctx->waiters; l; l = g_list_next (l))
+        qcdm_snapshot_complete (G_SIMPLE_ASYNC_RESULT (l->data),
+                                ctx->self->priv->qcdm_snapshot);
+    g_list_free (ctx->waiters);
+    g_object_unref (ctx->self);
+    g_free (ctx);
+}
+
+static void
+qcdm_snapshot_pilot_sets_ready (MMQcdmSerialPort *port,
+                                GByteArray *response,
+                                GError *error,
+                                QcdmSnapshotContext *ctx)
+{
+    QcdmSnapshot *snapshot = ctx->self->priv->qcdm_snapshot;
+    QcdmResult *result = NULL;
+    guint32 i;
+
+    if (!error)
+        result = qcdm_cmd_pilot_sets_result ((const gchar *) response->data,
+                                             response->len,
+                                             NULL);
+    if (result) {
+        snapshot->num_active = 0;
+        snapshot->best_db = -28;
+        qcdm_cmd_pilot_sets_result_get_num (result,
+                                            QCDM_CMD_PILOT_SETS_TYPE_ACTIVE,
+                                            &snapshot->num_active);
+        for (i = 0; i < snapshot->num_active; i++) {
+            guint32 pn_offset = 0, ecio = 0;
+            gfloat db = 0;
+
+            qcdm_cmd_pilot_sets_result_get_pilot (result,
+                                                  QCDM_CMD_PILOT_SETS_TYPE_ACTIVE,
+                                                  i,
+                                                  &pn_offset,
+                                                  &ecio,
+                                                  &db);
+            snapshot->best_db = MAX (db, snapshot->best_db);
+        }
+        qcdm_result_unref (result);
+    }
+
+    qcdm_snapshot_item_loaded (ctx, QCDM_SNAPSHOT_PILOT_SETS, !!result);
+    qcdm_snapshot_request_done (ctx);
+}
+
+static void
+qcdm_snapshot_cm_ready (MMQcdmSerialPort *port,
+                        GByteArray *response,
+                        GError *error,
+                        QcdmSnapshotContext *ctx)
+{
+    QcdmSnapshot *snapshot = ctx->self->priv->qcdm_snapshot;
+    QcdmResult *result = NULL;
+    guint32 hybrid = 0;
+
+    if (!error)
+        result = qcdm_cmd_cm_subsys_state_info_result ((const gchar *) response->data,
+                                                       response->len,
+                                                       NULL);
+    if (result) {
+        qcdm_result_get_u32 (result, QCDM_CMD_CM_SUBSYS_STATE_INFO_ITEM_OPERATING_MODE, &snapshot->cm_opmode);
+        qcdm_result_get_u32 (result, QCDM_CMD_CM_SUBSYS_STATE_INFO_ITEM_SYSTEM_MODE, &snapshot->cm_sysmode);
+        qcdm_result_get_u32 (result, QCDM_CMD_CM_SUBSYS_STATE_INFO_ITEM_HYBRID_PREF, &hybrid);
+        qcdm_result_unref (result);
+        snapshot->hybrid = !!hybrid;
+    }
+
+    qcdm_snapshot_item_loaded (ctx, QCDM_SNAPSHOT_CM, !!result);
+    qcdm_snapshot_request_done (ctx);
+}
+
+static void
+qcdm_snapshot_hdr_ready (MMQcdmSerialPort *port,
+                         GByteArray *response,
+                         GError *error,
+                         QcdmSnapshotContext *ctx)
+{
+    QcdmSnapshot *snapshot = ctx->self->priv->qcdm_snapshot;
+    QcdmResult *result = NULL;
+    guint8 session = 0;
+    guint8 almp = 0;
+
+    /* Not open unless told otherwise */
+    snapshot->evdo_open = FALSE;
+
+    if (!error)
+        result = qcdm_cmd_hdr_subsys_state_info_result ((const gchar *) response->data,
+                                                        response->len,
+                                                        NULL);
+    if (result) {
+        qcdm_result_get_u8 (result, QCDM_CMD_HDR_SUBSYS_STATE_INFO_ITEM_SESSION_STATE, &session);
+        qcdm_result_get_u8 (result, QCDM_CMD_HDR_SUBSYS_STATE_INFO_ITEM_ALMP_STATE, &almp);
+        qcdm_result_unref (result);
+
+        if (session == QCDM_CMD_HDR_SUBSYS_STATE_INFO_SESSION_STATE_OPEN &&
+            (almp == QCDM_CMD_HDR_SUBSYS_STATE_INFO_ALMP_STATE_IDLE ||
+             almp == QCDM_CMD_HDR_SUBSYS_STATE_INFO_ALMP_STATE_CONNECTED))
+            snapshot->evdo_open = TRUE;
+    }
+
+    qcdm_snapshot_item_loaded (ctx, QCDM_SNAPSHOT_HDR, !!result);
+    qcdm_snapshot_request_done (ctx);
+}
+
+static void
+qcdm_snapshot_gsm_ready (MMQcdmSerialPort *port,
+                         GByteArray *response,
+                         GError *error,
+                         QcdmSnapshotContext *ctx)
+{
+    QcdmSnapshot *snapshot = ctx->self->priv->qcdm_snapshot;
+    QcdmResult *result = NULL;
+
+    if (!error)
+        result = qcdm_cmd_gsm_subsys_state_info_result ((const gchar *) response->data,
+                                                        response->len,
+                                                        NULL);
+    if (result) {
+        qcdm_result_get_u8 (result, QCDM_CMD_GSM_SUBSYS_STATE_INFO_ITEM_CM_OP_MODE, &snapshot->gsm_opmode);
+        qcdm_result_get_u8 (result, QCDM_CMD_GSM_SUBSYS_STATE_INFO_ITEM_CM_SYS_MODE, &snapshot->gsm_sysmode);
+        qcdm_result_unref (result);
+    }
+
+    qcdm_snapshot_item_loaded (ctx, QCDM_SNAPSHOT_GSM, !!result);
+    qcdm_snapshot_request_done (ctx);
+}
+
+static void
+qcdm_snapshot_wcdma_ready (MMQcdmSerialPort *port,
+                           GByteArray *response,
+                           GError *error,
+                           QcdmSnapshotContext *ctx)
+{
+    QcdmSnapshot *snapshot = ctx->self->priv->qcdm_snapshot;
+    QcdmResult *result = NULL;
+    guint8 l1 = 0;
+
+    /* Not open unless told otherwise */
+    snapshot->wcdma_open = FALSE;
+
+    if (!error)
+        result = qcdm_cmd_wcdma_subsys_state_info_result ((const gchar *) response->data,
+                                                          response->len,
+                                                          NULL);
+    if (result) {
+        qcdm_result_get_u8 (result, QCDM_CMD_WCDMA_SUBSYS_STATE_INFO_ITEM_L1_STATE, &l1);
+        qcdm_result_unref (result);
+
+        if (l1 == QCDM_WCDMA_L1_STATE_PCH ||
+            l1 == QCDM_WCDMA_L1_STATE_FACH ||
+            l1 == QCDM_WCDMA_L1_STATE_DCH)
+            snapshot->wcdma_open = TRUE;
+    }
+
+    qcdm_snapshot_item_loaded (ctx, QCDM_SNAPSHOT_WCDMA, !!result);
+    qcdm_snapshot_request_done (ctx);
+}
+
+typedef gsize (* QcdmCommandNewFn) (char *buf, gsize len);
+
+static const struct {
+    QcdmCommandNewFn command_new;
+    MMQcdmSerialResponseFn callback;
+} qcdm_snapshot_requests[QCDM_SNAPSHOT_LAST] = {
+    { qcdm_cmd_pilot_sets_new,              (MMQcdmSerialResponseFn) qcdm_snapshot_pilot_sets_ready },
+    { qcdm_cmd_cm_subsys_state_info_new,    (MMQcdmSerialResponseFn) qcdm_snapshot_cm_ready },
+    { qcdm_cmd_hdr_subsys_state_info_new,   (MMQcdmSerialResponseFn) qcdm_snapshot_hdr_ready },
+    { qcdm_cmd_gsm_subsys_state_info_new,   (MMQcdmSerialResponseFn) qcdm_snapshot_gsm_ready },
+    { qcdm_cmd_wcdma_subsys_state_info_new, (MMQcdmSerialResponseFn) qcdm_snapshot_wcdma_ready },
+};
+
+static void
+qcdm_snapshot_queue (QcdmSnapshotContext *ctx,
+                     MMQcdmSerialPort *port,
+                     guint items)
+{
+    guint i;
+
+    for (i = 0; i < QCDM_SNAPSHOT_LAST; i++) {
+        GByteArray *cmd;
+
+        if (!(items & QCDM_SNAPSHOT_ITEM (i)) ||
+            (ctx->items & QCDM_SNAPSHOT_ITEM (i)))
+            continue;
+
+        cmd = g_byte_array_sized_new (50);
+        cmd->len = qcdm_snapshot_requests[i].command_new ((char *) cmd->data, 50);
+        g_assert (cmd->len);
+
+        ctx->items |= QCDM_SNAPSHOT_ITEM (i);
+        ctx->pending++;
+        mm_qcdm_serial_port_queue_command (port, cmd, 3, NULL, qcdm_snapshot_requests[i].callback, ctx);
+    }
+}
+
+/* Items which may be loaded given the capabilities of the modem */
+static guint
+qcdm_snapshot_supported_items (MMBroadbandModem *self)
+{
+    guint items = 0;
+
+    if (mm_iface_modem_is_3gpp (MM_IFACE_MODEM (self)))
+        items |= (QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_GSM) |
+                  QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_WCDMA));
+    if (mm_iface_modem_is_cdma (MM_IFACE_MODEM (self)))
+        items |= (QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_PILOT_SETS) |
+                  QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_CM) |
+                  QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_HDR));
+    return items;
+}
+
+/* Loads the given QCDM_SNAPSHOT_ITEM() mask of items, reusing those loaded
+ * recently enough. All requests are queued at once so that the port sends
+ * each one as soon as the previous reply arrives, and concurrent loads share
+ * the same set of requests. Items not supported by the modem are never
+ * loaded, and are left not valid in the snapshot.
+ */
+static void
+qcdm_snapshot_load (MMBroadbandModem *self,
+                    MMQcdmSerialPort *port,
+                    guint items,
+                    GAsyncReadyCallback callback,
+                    gpointer user_data)
+{
+    GSimpleAsyncResult *result;
+    QcdmSnapshotContext *ctx;
+    gint64 now;
+    guint i;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        qcdm_snapshot_load);
+
+    if (!self->priv->qcdm_snapshot)
+        self->priv->qcdm_snapshot = g_new0 (QcdmSnapshot, 1);
+
+    /* Skip the items which are recent enough */
+    items &= qcdm_snapshot_supported_items (self);
+    now = g_get_monotonic_time ();
+    for (i = 0; i < QCDM_SNAPSHOT_LAST; i++) {
+        if ((self->priv->qcdm_snapshot->valid & QCDM_SNAPSHOT_ITEM (i)) &&
+            (now - self->priv->qcdm_snapshot->timestamp[i]) < QCDM_SNAPSHOT_MAX_AGE_USEC)
+            items &= ~QCDM_SNAPSHOT_ITEM (i);
+    }
+
+    /* Already loading; add whatever is missing and wait for it */
+    ctx = self->priv->qcdm_snapshot_ctx;
+    if (ctx) {
+        ctx->waiters = g_list_append (ctx->waiters, result);
+        qcdm_snapshot_queue (ctx, port, items);
+        return;
+    }
+
+    if (!items) {
+        g_simple_async_result_set_op_res_gpointer (result,
+                                                   g_memdup (self->priv->qcdm_snapshot,
+                                                             sizeof (QcdmSnapshot)),
+                                                   g_free);
+        g_simple_async_result_complete_in_idle (result);
+        g_object_unref (result);
+        return;
+    }
+
+    ctx = g_new0 (QcdmSnapshotContext, 1);
+    ctx->self = g_object_ref (self);
+    ctx->waiters = g_list_append (NULL, result);
+    self->priv->qcdm_snapshot_ctx = ctx;
+
+    /* Hold a request back so the context can't complete while queueing */
+    ctx->pending = 1;
+    qcdm_snapshot_queue (ctx, port, items);
+    qcdm_snapshot_request_done (ctx);
+}
+
 /*****************************************************************************/
 /* Signal quality loading (Modem interface) */
 
@@ -1518,13 +1898,13 @@ static const MMBaseModemAtCommand signal_quality_csq_sequence[] = {
 static void
 signal_quality_csq (SignalQualityContext *ctx)
 {
-    mm_base_modem_at_sequence_full (
+    /* Periodic poll; let user requests go first */
+    mm_base_modem_at_sequence_background (
         MM_BASE_MODEM (ctx->self),
         MM_AT_SERIAL_PORT (ctx->port),
         signal_quality_csq_sequence,
         NULL, /* response_processor_context */
         NULL, /* response_processor_context_free */
-        NULL, /* cancellable */
         (GAsyncReadyCallback)signal_quality_csq_ready,
         ctx);
 }
@@ -1613,64 +1993,35 @@ try_csq:
 static void
 signal_quality_cind (SignalQualityContext *ctx)
 {
-    mm_base_modem_at_command_full (MM_BASE_MODEM (ctx->self),
-                                   MM_AT_SERIAL_PORT (ctx->port),
-                                   "+CIND?",
-                                   3,
-                                   FALSE,
-                                   FALSE, /* raw */
-                                   NULL, /* cancellable */
-                                   (GAsyncReadyCallback)signal_quality_cind_ready,
-                                   ctx);
+    mm_base_modem_at_command_background (MM_BASE_MODEM (ctx->self),
+                                         MM_AT_SERIAL_PORT (ctx->port),
+                                         "+CIND?",
+                                         3,
+                                         FALSE,
+                                         (GAsyncReadyCallback)signal_quality_cind_ready,
+                                         ctx);
 }
 
 static void
-signal_quality_qcdm_ready (MMQcdmSerialPort *port,
-                           GByteArray *response,
-                           GError *error,
+signal_quality_qcdm_ready (MMBroadbandModem *self,
+                           GAsyncResult *res,
                            SignalQualityContext *ctx)
 {
-    QcdmResult *result;
-    guint32 num = 0, quality = 0, i;
-    gfloat best_db = -28;
-    gint err = QCDM_SUCCESS;
+    const QcdmSnapshot *snapshot;
+    guint32 quality = 0;
+    gfloat best_db;
 
-    if (error) {
-        g_simple_async_result_set_from_error (ctx->result, error);
-        signal_quality_context_complete_and_free (ctx);
-        return;
-    }
-
-    /* Parse the response */
-    result = qcdm_cmd_pilot_sets_result ((const gchar *) response->data,
-                                         response->len,
-                                         &err);
-    if (!result) {
+    snapshot = qcdm_snapshot_load_finish (self, res);
+    if (!(snapshot->valid & QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_PILOT_SETS))) {
         g_simple_async_result_set_error (ctx->result,
                                          MM_CORE_ERROR,
                                          MM_CORE_ERROR_FAILED,
-                                         "Failed to parse pilot sets command result: %d",
-                                         err);
+                                         "Couldn't load pilot sets");
         signal_quality_context_complete_and_free (ctx);
         return;
     }
 
-    qcdm_cmd_pilot_sets_result_get_num (result, QCDM_CMD_PILOT_SETS_TYPE_ACTIVE, &num);
-    for (i = 0; i < num; i++) {
-        guint32 pn_offset = 0, ecio = 0;
-        gfloat db = 0;
-
-        qcdm_cmd_pilot_sets_result_get_pilot (result,
-                                              QCDM_CMD_PILOT_SETS_TYPE_ACTIVE,
-                                              i,
-                                              &pn_offset,
-                                              &ecio,
-                                              &db);
-        best_db = MAX (db, best_db);
-    }
-    qcdm_result_unref (result);
-
-    if (num > 0) {
+    if (snapshot->num_active > 0) {
         #define BEST_ECIO 3
         #define WORST_ECIO 25
 
@@ -1678,7 +2029,7 @@ signal_quality_qcdm_ready (MMQcdmSerialPort *port,
          * really only care about -3 to -25 dB though, since that's about what
          * you'll see in real-world usage.
          */
-        best_db = CLAMP (ABS (best_db), BEST_ECIO, WORST_ECIO) - BEST_ECIO;
+        best_db = CLAMP (ABS (snapshot->best_db), BEST_ECIO, WORST_ECIO) - BEST_ECIO;
         quality = (guint32) (100 - (best_db * 100 / (WORST_ECIO - BEST_ECIO)));
     }
 
@@ -1691,41 +2042,23 @@ signal_quality_qcdm_ready (MMQcdmSerialPort *port,
 static void
 signal_quality_qcdm (SignalQualityContext *ctx)
 {
-    GByteArray *pilot_sets;
-
     /* Use CDMA1x pilot EC/IO if we can */
-    pilot_sets = g_byte_array_sized_new (25);
-    pilot_sets->len = qcdm_cmd_pilot_sets_new ((char *) pilot_sets->data, 25);
-    g_assert (pilot_sets->len);
-
-    mm_qcdm_serial_port_queue_command (MM_QCDM_SERIAL_PORT (ctx->port),
-                                       pilot_sets,
-                                       3,
-                                       NULL,
-                                       (MMQcdmSerialResponseFn)signal_quality_qcdm_ready,
-                                       ctx);
+    qcdm_snapshot_load (ctx->self,
+                        MM_QCDM_SERIAL_PORT (ctx->port),
+                        QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_PILOT_SETS),
+                        (GAsyncReadyCallback)signal_quality_qcdm_ready,
+                        ctx);
 }
 
 static void
-modem_load_signal_quality (MMIfaceModem *self,
-                           GAsyncReadyCallback callback,
-                           gpointer user_data)
+signal_quality_at_or_qcdm (SignalQualityContext *ctx)
 {
-    SignalQualityContext *ctx;
     GError *error = NULL;
 
-    mm_dbg ("loading signal quality...");
-    ctx = g_new0 (SignalQualityContext, 1);
-    ctx->self = g_object_ref (self);
-    ctx->result = g_simple_async_result_new (G_OBJECT (self),
-                                             callback,
-                                             user_data,
-                                             modem_load_signal_quality);
-
     /* Check whether we can get a non-connected AT port */
-    ctx->port = (MMSerialPort *)mm_base_modem_get_best_at_port (MM_BASE_MODEM (self), &error);
+    ctx->port = (MMSerialPort *)mm_base_modem_get_best_at_port (MM_BASE_MODEM (ctx->self), &error);
     if (ctx->port) {
-        if (MM_BROADBAND_MODEM (self)->priv->modem_cind_supported)
+        if (MM_BROADBAND_MODEM (ctx->self)->priv->modem_cind_supported)
             signal_quality_cind (ctx);
         else
             signal_quality_csq (ctx);
@@ -1733,7 +2066,7 @@ modem_load_signal_quality (MMIfaceModem *self,
     }
 
     /* If no best AT port available (all connected), try with QCDM ports */
-    ctx->port = (MMSerialPort *)mm_base_modem_get_port_qcdm (MM_BASE_MODEM (self));
+    ctx->port = (MMSerialPort *)mm_base_modem_get_port_qcdm (MM_BASE_MODEM (ctx->self));
     if (ctx->port) {
         g_error_free (error);
         signal_quality_qcdm (ctx);
@@ -1745,6 +2078,115 @@ modem_load_signal_quality (MMIfaceModem *self,
     signal_quality_context_complete_and_free (ctx);
 }
 
+static void
+signal_quality_wmc_ready (MMWmcSerialPort *port,
+                          GByteArray *response,
+                          GError *error,
+                          SignalQualityContext *ctx)
+{
+    WmcResult *result;
+    guint8 service = WMC_NETWORK_SERVICE_NONE;
+    guint8 dbm = 0;
+    guint quality;
+
+    if (error) {
+        mm_dbg ("Couldn't load signal quality via WMC: '%s'", error->message);
+        goto fallback;
+    }
+
+    result = wmc_cmd_network_info_result ((const gchar *) response->data, response->len);
+    if (!result) {
+        mm_dbg ("Failed to parse WMC network info result");
+        goto fallback;
+    }
+
+    wmc_result_get_u8 (result, WMC_CMD_NETWORK_INFO_ITEM_SERVICE, &service);
+    switch (service) {
+    case WMC_NETWORK_SERVICE_LTE:
+        wmc_result_get_u8 (result, WMC_CMD_NETWORK_INFO_ITEM_LTE_DBM, &dbm);
+        break;
+    case WMC_NETWORK_SERVICE_EVDO_0:
+    case WMC_NETWORK_SERVICE_EVDO_A:
+    case WMC_NETWORK_SERVICE_EVDO_A_EHRPD:
+    case WMC_NETWORK_SERVICE_UMTS:
+    case WMC_NETWORK_SERVICE_HSDPA:
+    case WMC_NETWORK_SERVICE_HSUPA:
+    case WMC_NETWORK_SERVICE_HSPA:
+        wmc_result_get_u8 (result, WMC_CMD_NETWORK_INFO_ITEM_3G_DBM, &dbm);
+        break;
+    case WMC_NETWORK_SERVICE_NONE:
+        break;
+    default:
+        wmc_result_get_u8 (result, WMC_CMD_NETWORK_INFO_ITEM_2G_DBM, &dbm);
+        break;
+    }
+    wmc_result_unref (result);
+
+    /* dBm values are given as magnitudes, 0 meaning no signal */
+    if (dbm == 0)
+        quality = 0;
+    else {
+        #define BEST_DBM 51
+        #define WORST_DBM 113
+
+        quality = CLAMP (dbm, BEST_DBM, WORST_DBM) - BEST_DBM;
+        quality = 100 - (quality * 100 / (WORST_DBM - BEST_DBM));
+    }
+
+    g_simple_async_result_set_op_res_gpointer (ctx->result,
+                                               GUINT_TO_POINTER (quality),
+                                               NULL);
+    signal_quality_context_complete_and_free (ctx);
+    return;
+
+fallback:
+    g_clear_object (&ctx->port);
+    signal_quality_at_or_qcdm (ctx);
+}
+
+static void
+signal_quality_wmc (SignalQualityContext *ctx)
+{
+    GByteArray *cmd;
+
+    cmd = g_byte_array_sized_new (10);
+    cmd->len = wmc_cmd_network_info_new ((char *) cmd->data, 10);
+    g_assert (cmd->len);
+
+    mm_wmc_serial_port_queue_command (MM_WMC_SERIAL_PORT (ctx->port),
+                                      cmd,
+                                      3,
+                                      NULL,
+                                      (MMWmcSerialResponseFn)signal_quality_wmc_ready,
+                                      ctx);
+}
+
+static void
+modem_load_signal_quality (MMIfaceModem *self,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+    SignalQualityContext *ctx;
+
+    mm_dbg ("loading signal quality...");
+    ctx = g_new0 (SignalQualityContext, 1);
+    ctx->self = g_object_ref (self);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             modem_load_signal_quality);
+
+    /* A single WMC request gives the signal strength of the current access
+     * technology, without touching any AT port */
+    ctx->port = (MMSerialPort *)mm_base_modem_get_port_wmc (MM_BASE_MODEM (self));
+    if (ctx->port) {
+        signal_quality_wmc (ctx);
+        return;
+    }
+
+    signal_quality_at_or_qcdm (ctx);
+}
+
 /*****************************************************************************/
 /* Load access technology (Modem interface) */
 
@@ -1777,6 +2219,7 @@ typedef struct {
     MMBroadbandModem *self;
     GSimpleAsyncResult *result;
     MMQcdmSerialPort *port;
+    MMWmcSerialPort *wmc;
 
     guint32 opmode;
     guint32 sysmode;
@@ -1787,6 +2230,9 @@ typedef struct {
 
     MMModemAccessTechnology fallback_act;
     guint fallback_mask;
+
+    MMModemAccessTechnology wmc_act;
+    guint wmc_mask;
 } AccessTechContext;
 
 static void
@@ -1796,6 +2242,13 @@ access_tech_context_complete_and_free (AccessTechContext *ctx, gboolean idle)
     MMModemAccessTechnology act = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
     guint mask = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
 
+    if (ctx->wmc_mask) {
+        mm_dbg ("WMC access technology: 0x%08x", ctx->wmc_act);
+        act = ctx->wmc_act;
+        mask = ctx->wmc_mask;
+        goto done;
+    }
+
     if (ctx->fallback_mask) {
         mm_dbg ("Fallback access technology: 0x%08x", ctx->fallback_act);
         act = ctx->fallback_act;
@@ -1858,178 +2311,48 @@ done:
     g_object_unref (ctx->self);
     if (ctx->port)
         g_object_unref (ctx->port);
+    if (ctx->wmc)
+        g_object_unref (ctx->wmc);
     g_free (ctx);
 }
 
 static void
-access_tech_qcdm_wcdma_ready (MMQcdmSerialPort *port,
-                              GByteArray *response,
-                              GError *error,
-                              AccessTechContext *ctx)
-{
-    QcdmResult *result;
-    gint err = QCDM_SUCCESS;
-    guint8 l1;
-
-    if (error) {
-        g_simple_async_result_set_from_error (ctx->result, error);
-        access_tech_context_complete_and_free (ctx, FALSE);
-        return;
-    }
-
-    /* Parse the response */
-    result = qcdm_cmd_wcdma_subsys_state_info_result ((const gchar *) response->data,
-                                                      response->len,
-                                                      &err);
-    if (result) {
-        qcdm_result_get_u8 (result, QCDM_CMD_WCDMA_SUBSYS_STATE_INFO_ITEM_L1_STATE, &l1);
-        qcdm_result_unref (result);
-
-        if (l1 == QCDM_WCDMA_L1_STATE_PCH ||
-            l1 == QCDM_WCDMA_L1_STATE_FACH ||
-            l1 == QCDM_WCDMA_L1_STATE_DCH)
-            ctx->wcdma_open = TRUE;
-    }
-
-    access_tech_context_complete_and_free (ctx, FALSE);
-}
-
-static void
-access_tech_qcdm_gsm_ready (MMQcdmSerialPort *port,
-                            GByteArray *response,
-                            GError *error,
-                            AccessTechContext *ctx)
-{
-    GByteArray *cmd;
-    QcdmResult *result;
-    gint err = QCDM_SUCCESS;
-    guint8 opmode = 0;
-    guint8 sysmode = 0;
-
-    if (error) {
-        g_simple_async_result_set_from_error (ctx->result, error);
-        access_tech_context_complete_and_free (ctx, FALSE);
-        return;
-    }
-
-    /* Parse the response */
-    result = qcdm_cmd_gsm_subsys_state_info_result ((const gchar *) response->data,
-                                                    response->len,
-                                                    &err);
-    if (!result) {
-        g_simple_async_result_set_error (ctx->result,
-                                         MM_CORE_ERROR,
-                                         MM_CORE_ERROR_FAILED,
-                                         "Failed to parse GSM subsys command result: %d",
-                                         err);
-        access_tech_context_complete_and_free (ctx, FALSE);
-        return;
-    }
-
-    qcdm_result_get_u8 (result, QCDM_CMD_GSM_SUBSYS_STATE_INFO_ITEM_CM_OP_MODE, &opmode);
-    qcdm_result_get_u8 (result, QCDM_CMD_GSM_SUBSYS_STATE_INFO_ITEM_CM_SYS_MODE, &sysmode);
-    qcdm_result_unref (result);
-
-    ctx->opmode = opmode;
-    ctx->sysmode = sysmode;
-
-    /* WCDMA subsystem state */
-    cmd = g_byte_array_sized_new (50);
-    cmd->len = qcdm_cmd_wcdma_subsys_state_info_new ((char *) cmd->data, 50);
-    g_assert (cmd->len);
-
-    mm_qcdm_serial_port_queue_command (port,
-                                       cmd,
-                                       3,
-                                       NULL,
-                                       (MMQcdmSerialResponseFn) access_tech_qcdm_wcdma_ready,
-                                       ctx);
-}
-
-static void
-access_tech_qcdm_hdr_ready (MMQcdmSerialPort *port,
-                            GByteArray *response,
-                            GError *error,
-                            AccessTechContext *ctx)
-{
-    QcdmResult *result;
-    gint err = QCDM_SUCCESS;
-    guint8 session = 0;
-    guint8 almp = 0;
-
-    if (error) {
-        g_simple_async_result_set_from_error (ctx->result, error);
-        access_tech_context_complete_and_free (ctx, FALSE);
-        return;
-    }
-
-    /* Parse the response */
-    result = qcdm_cmd_hdr_subsys_state_info_result ((const gchar *) response->data,
-                                                    response->len,
-                                                    &err);
-    if (result) {
-        qcdm_result_get_u8 (result, QCDM_CMD_HDR_SUBSYS_STATE_INFO_ITEM_SESSION_STATE, &session);
-        qcdm_result_get_u8 (result, QCDM_CMD_HDR_SUBSYS_STATE_INFO_ITEM_ALMP_STATE, &almp);
-        qcdm_result_unref (result);
-
-        if (session == QCDM_CMD_HDR_SUBSYS_STATE_INFO_SESSION_STATE_OPEN &&
-            (almp == QCDM_CMD_HDR_SUBSYS_STATE_INFO_ALMP_STATE_IDLE ||
-             almp == QCDM_CMD_HDR_SUBSYS_STATE_INFO_ALMP_STATE_CONNECTED))
-            ctx->evdo_open = TRUE;
-    }
-
-    access_tech_context_complete_and_free (ctx, FALSE);
-}
-
-static void
-access_tech_qcdm_cdma_ready (MMQcdmSerialPort *port,
-                             GByteArray *response,
-                             GError *error,
-                             AccessTechContext *ctx)
+access_tech_qcdm_snapshot_ready (MMBroadbandModem *self,
+                                 GAsyncResult *res,
+                                 AccessTechContext *ctx)
 {
-    GByteArray *cmd;
-    QcdmResult *result;
-    gint err = QCDM_SUCCESS;
-    guint32 hybrid;
+    const QcdmSnapshot *snapshot;
 
-    if (error) {
-        g_simple_async_result_set_from_error (ctx->result, error);
-        access_tech_context_complete_and_free (ctx, FALSE);
-        return;
-    }
+    snapshot = qcdm_snapshot_load_finish (self, res);
 
-    /* Parse the response */
-    result = qcdm_cmd_cm_subsys_state_info_result ((const gchar *) response->data,
-                                                   response->len,
-                                                   &err);
-    if (!result) {
-        g_simple_async_result_set_error (ctx->result,
-                                         MM_CORE_ERROR,
-                                         MM_CORE_ERROR_FAILED,
-                                         "Failed to parse CM subsys command result: %d",
-                                         err);
-        access_tech_context_complete_and_free (ctx, FALSE);
-        return;
+    if (mm_iface_modem_is_3gpp (MM_IFACE_MODEM (self))) {
+        if (!(snapshot->valid & QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_GSM))) {
+            g_simple_async_result_set_error (ctx->result,
+                                             MM_CORE_ERROR,
+                                             MM_CORE_ERROR_FAILED,
+                                             "Couldn't load GSM subsys state");
+            access_tech_context_complete_and_free (ctx, FALSE);
+            return;
+        }
+        ctx->opmode = snapshot->gsm_opmode;
+        ctx->sysmode = snapshot->gsm_sysmode;
+        ctx->wcdma_open = snapshot->wcdma_open;
+    } else {
+        if (!(snapshot->valid & QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_CM))) {
+            g_simple_async_result_set_error (ctx->result,
+                                             MM_CORE_ERROR,
+                                             MM_CORE_ERROR_FAILED,
+                                             "Couldn't load CM subsys state");
+            access_tech_context_complete_and_free (ctx, FALSE);
+            return;
+        }
+        ctx->opmode = snapshot->cm_opmode;
+        ctx->sysmode = snapshot->cm_sysmode;
+        ctx->hybrid = snapshot->hybrid;
+        ctx->evdo_open = snapshot->evdo_open;
     }
 
-    qcdm_result_get_u32 (result, QCDM_CMD_CM_SUBSYS_STATE_INFO_ITEM_OPERATING_MODE, &ctx->opmode);
-    qcdm_result_get_u32 (result, QCDM_CMD_CM_SUBSYS_STATE_INFO_ITEM_SYSTEM_MODE, &ctx->sysmode);
-    qcdm_result_get_u32 (result, QCDM_CMD_CM_SUBSYS_STATE_INFO_ITEM_HYBRID_PREF, &hybrid);
-    qcdm_result_unref (result);
-
-    ctx->hybrid = !!hybrid;
-
-    /* HDR subsystem state */
-    cmd = g_byte_array_sized_new (50);
-    cmd->len = qcdm_cmd_hdr_subsys_state_info_new ((char *) cmd->data, 50);
-    g_assert (cmd->len);
-
-    mm_qcdm_serial_port_queue_command (port,
-                                       cmd,
-                                       3,
-                                       NULL,
-                                       (MMQcdmSerialResponseFn) access_tech_qcdm_hdr_ready,
-                                       ctx);
+    access_tech_context_complete_and_free (ctx, FALSE);
 }
 
 static void
@@ -2061,28 +2384,17 @@ access_tech_from_cdma_registration_state (MMBroadbandModem *self,
 }
 
 static void
-modem_load_access_technologies (MMIfaceModem *self,
-                                GAsyncReadyCallback callback,
-                                gpointer user_data)
+access_tech_qcdm (AccessTechContext *ctx)
 {
-    AccessTechContext *ctx;
-    GByteArray *cmd;
-
     mm_dbg ("loading access technologies via QCDM...");
 
     /* For modems where only QCDM provides detailed information, try to
      * get access technologies via the various QCDM subsystems or from
      * registration state
      */
-    ctx = g_new0 (AccessTechContext, 1);
-    ctx->self = g_object_ref (self);
-    ctx->port = mm_base_modem_get_port_qcdm (MM_BASE_MODEM (self));
-    ctx->result = g_simple_async_result_new (G_OBJECT (self),
-                                             callback,
-                                             user_data,
-                                             modem_load_access_technologies);
+    ctx->port = mm_base_modem_get_port_qcdm (MM_BASE_MODEM (ctx->self));
 
-    if (!mm_iface_modem_is_cdma (self) && !ctx->port) {
+    if (!mm_iface_modem_is_cdma (MM_IFACE_MODEM (ctx->self)) && !ctx->port) {
         g_simple_async_result_set_error (ctx->result,
                                          MM_CORE_ERROR,
                                          MM_CORE_ERROR_UNSUPPORTED,
@@ -2092,37 +2404,129 @@ modem_load_access_technologies (MMIfaceModem *self,
         return;
     }
 
-    if (mm_iface_modem_is_3gpp (self)) {
-        cmd = g_byte_array_sized_new (50);
-        cmd->len = qcdm_cmd_gsm_subsys_state_info_new ((char *) cmd->data, 50);
+    /* If we don't have a QCDM port but the modem is CDMA-only, then
+     * guess access technologies from the registration information.
+     */
+    if (!ctx->port) {
+        access_tech_from_cdma_registration_state (ctx->self, ctx);
+        return;
+    }
+
+    qcdm_snapshot_load (ctx->self,
+                        ctx->port,
+                        (mm_iface_modem_is_3gpp (MM_IFACE_MODEM (ctx->self)) ?
+                         (QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_GSM) |
+                          QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_WCDMA)) :
+                         (QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_CM) |
+                          QCDM_SNAPSHOT_ITEM (QCDM_SNAPSHOT_HDR))),
+                        (GAsyncReadyCallback) access_tech_qcdm_snapshot_ready,
+                        ctx);
+}
+
+static void
+access_tech_wmc_ready (MMWmcSerialPort *port,
+                       GByteArray *response,
+                       GError *error,
+                       AccessTechContext *ctx)
+{
+    WmcResult *result;
+    guint8 service = WMC_NETWORK_SERVICE_NONE;
+
+    if (error) {
+        mm_dbg ("Couldn't load access technologies via WMC: '%s'", error->message);
+        access_tech_qcdm (ctx);
+        return;
+    }
+
+    result = wmc_cmd_network_info_result ((const gchar *) response->data, response->len);
+    if (!result) {
+        mm_dbg ("Failed to parse WMC network info result");
+        access_tech_qcdm (ctx);
+        return;
+    }
+
+    wmc_result_get_u8 (result, WMC_CMD_NETWORK_INFO_ITEM_SERVICE, &service);
+    wmc_result_unref (result);
+
+    switch (service) {
+    case WMC_NETWORK_SERVICE_IS95A:
+    case WMC_NETWORK_SERVICE_IS95B:
+    case WMC_NETWORK_SERVICE_1XRTT:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_1XRTT;
+        break;
+    case WMC_NETWORK_SERVICE_EVDO_0:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_EVDO0;
+        break;
+    case WMC_NETWORK_SERVICE_EVDO_A:
+    case WMC_NETWORK_SERVICE_EVDO_A_EHRPD:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_EVDOA;
+        break;
+    case WMC_NETWORK_SERVICE_GSM:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_GSM;
+        break;
+    case WMC_NETWORK_SERVICE_GPRS:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_GPRS;
+        break;
+    case WMC_NETWORK_SERVICE_EDGE:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_EDGE;
+        break;
+    case WMC_NETWORK_SERVICE_UMTS:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_UMTS;
+        break;
+    case WMC_NETWORK_SERVICE_HSDPA:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_HSDPA;
+        break;
+    case WMC_NETWORK_SERVICE_HSUPA:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_HSUPA;
+        break;
+    case WMC_NETWORK_SERVICE_HSPA:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_HSPA;
+        break;
+    case WMC_NETWORK_SERVICE_LTE:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_LTE;
+        break;
+    default:
+        ctx->wmc_act = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
+        break;
+    }
+    ctx->wmc_mask = MM_MODEM_ACCESS_TECHNOLOGY_ANY;
+
+    access_tech_context_complete_and_free (ctx, FALSE);
+}
+
+static void
+modem_load_access_technologies (MMIfaceModem *self,
+                                GAsyncReadyCallback callback,
+                                gpointer user_data)
+{
+    AccessTechContext *ctx;
+    GByteArray *cmd;
+
+    ctx = g_new0 (AccessTechContext, 1);
+    ctx->self = g_object_ref (self);
+    ctx->wmc = mm_base_modem_get_port_wmc (MM_BASE_MODEM (self));
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             modem_load_access_technologies);
+
+    /* WMC reports the exact access technology in a single request */
+    if (ctx->wmc) {
+        mm_dbg ("loading access technologies via WMC...");
+        cmd = g_byte_array_sized_new (10);
+        cmd->len = wmc_cmd_network_info_new ((char *) cmd->data, 10);
         g_assert (cmd->len);
 
-        mm_qcdm_serial_port_queue_command (ctx->port,
-                                           cmd,
-                                           3,
-                                           NULL,
-                                           (MMQcdmSerialResponseFn) access_tech_qcdm_gsm_ready,
-                                           ctx);
-    } else if (mm_iface_modem_is_cdma (self)) {
-        /* If we don't have a QCDM port but the modem is CDMA-only, then
-         * guess access technologies from the registration information.
-         */
-        if (!ctx->port)
-            access_tech_from_cdma_registration_state (MM_BROADBAND_MODEM (self), ctx);
-        else {
-            cmd = g_byte_array_sized_new (50);
-            cmd->len = qcdm_cmd_cm_subsys_state_info_new ((char *) cmd->data, 50);
-            g_assert (cmd->len);
+        mm_wmc_serial_port_queue_command (ctx->wmc,
+                                          cmd,
+                                          3,
+                                          NULL,
+                                          (MMWmcSerialResponseFn) access_tech_wmc_ready,
+                                          ctx);
+        return;
+    }
 
-            mm_qcdm_serial_port_queue_command (ctx->port,
-                                               cmd,
-                                               3,
-                                               NULL,
-                                               (MMQcdmSerialResponseFn) access_tech_qcdm_cdma_ready,
-                                               ctx);
-        }
-    } else
-        g_assert_not_reached ();
+    access_tech_qcdm (ctx);
 }
 
 /*****************************************************************************/
@@ -3522,8 +3926,6 @@ registration_status_check_ready (MMBroadbandModem *self,
 {
     const gchar *response;
     GError *error = NULL;
-    GMatchInfo *match_info;
-    guint i;
     gboolean parsed;
     gboolean cgreg;
     MMModem3gppRegistrationState state;
@@ -3556,47 +3958,18 @@ registration_status_check_ready (MMBroadbandModem *self,
         return;
     }
 
-    /* Try to match the response */
-    for (i = 0;
-         i < self->priv->modem_3gpp_registration_regex->len;
-         i++) {
-        if (g_regex_match ((GRegex *)g_ptr_array_index (
-                               self->priv->modem_3gpp_registration_regex, i),
-                           response,
-                           0,
-                           &match_info))
-            break;
-        g_match_info_free (match_info);
-        match_info = NULL;
-    }
-
-    if (!match_info) {
-        error = g_error_new (MM_CORE_ERROR,
-                             MM_CORE_ERROR_FAILED,
-                             "Unknown registration status response: '%s'",
-                             response);
-        if (ctx->running_cs)
-            ctx->cs_error = error;
-        else
-            ctx->ps_error = error;
-
-        run_registration_checks_context_step (ctx);
-        return;
-    }
-
     cgreg = FALSE;
     state = MM_MODEM_3GPP_REGISTRATION_STATE_UNKNOWN;
     act = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
     lac = 0;
     cid = 0;
-    parsed = mm_3gpp_parse_creg_response (match_info,
-                                          &state,
-                                          &lac,
-                                          &cid,
-                                          &act,
-                                          &cgreg,
-                                          &error);
-    g_match_info_free (match_info);
+    parsed = mm_3gpp_parse_creg_reply (response,
+                                       &state,
+                                       &lac,
+                                       &cid,
+                                       &act,
+                                       &cgreg,
+                                       &error);
 
     if (!parsed) {
         if (!error)
@@ -5578,8 +5951,8 @@ sms_text_part_list_ready (MMBroadbandModem *self,
     }
 
     /* +CMGL: <index>,<stat>,<oa/da>,[alpha],<scts><CR><LF><data><CR><LF> */
-    r = g_regex_new ("\\+CMGL:\\s*(\\d+)\\s*,\\s*([^,]*),\\s*([^,]*),\\s*([^,]*),\\s*([^\\r\\n]*)\\r\\n([^\\r\\n]*)",
-                     0, 0, NULL);
+    r = mm_regex_cache_get ("\\+CMGL:\\s*(\\d+)\\s*,\\s*([^,]*),\\s*([^,]*),\\s*([^,]*),\\s*([^\\r\\n]*)\\r\\n([^\\r\\n]*)",
+                            0, 0, NULL);
     g_assert (r);
 
     if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, NULL)) {
@@ -5769,16 +6142,17 @@ list_parts_lock_storages_ready (MMBroadbandModem *self,
 
     /* Get SMS parts from ALL types.
      * Different command to be used if we are on Text or PDU mode */
-    mm_base_modem_at_command (MM_BASE_MODEM (self),
-                              (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
-                               "+CMGL=4" :
-                               "+CMGL=\"ALL\""),
-                              20,
-                              FALSE,
-                              (GAsyncReadyCallback) (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
-                                                     sms_pdu_part_list_ready :
-                                                     sms_text_part_list_ready),
-                              ctx);
+    mm_base_modem_at_command_background (MM_BASE_MODEM (self),
+                                         NULL, /* best port */
+                                         (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
+                                          "+CMGL=4" :
+                                          "+CMGL=\"ALL\""),
+                                         20,
+                                         FALSE,
+                                         (GAsyncReadyCallback) (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
+                                                                sms_pdu_part_list_ready :
+                                                                sms_text_part_list_ready),
+                                         ctx);
 }
 
 static void
@@ -6201,7 +6575,7 @@ css_query_ready (MMIfaceModemCdma *self,
         GMatchInfo *match_info;
 
         /* Format is "<band_class>,<band>,<sid>" */
-        r = g_regex_new ("\\s*([^,]*?)\\s*,\\s*([^,]*?)\\s*,\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        r = mm_regex_cache_get ("\\s*([^,]*?)\\s*,\\s*([^,]*?)\\s*,\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
         if (!r) {
             g_simple_async_result_set_error (
                 ctx->result,
@@ -7025,47 +7399,240 @@ modem_location_load_capabilities (MMIfaceModemLocation *self,
 }
 
 /*****************************************************************************/
-/* Enable location gathering (Location interface) */
+/* Enable location gathering (Location interface) */
+
+static gboolean
+enable_location_gathering_finish (MMIfaceModemLocation *self,
+                                  GAsyncResult *res,
+                                  GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+enable_location_gathering (MMIfaceModemLocation *self,
+                           MMModemLocationSource source,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+    GSimpleAsyncResult *result;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        enable_location_gathering);
+
+    /* 3GPP modems need to re-run registration checks when enabling the 3GPP
+     * location source, so that we get up to date LAC/CI location information.
+     * Note that we don't care for when the registration checks get finished.
+     */
+    if (source == MM_MODEM_LOCATION_SOURCE_3GPP_LAC_CI &&
+        mm_iface_modem_is_3gpp (MM_IFACE_MODEM (self))) {
+        /* Reload registration to get LAC/CI */
+        mm_iface_modem_3gpp_run_registration_checks (MM_IFACE_MODEM_3GPP (self), NULL, NULL);
+        /* Reload operator to get MCC/MNC */
+        if (MM_BROADBAND_MODEM (self)->priv->modem_3gpp_registration_state == MM_MODEM_3GPP_REGISTRATION_STATE_HOME ||
+            MM_BROADBAND_MODEM (self)->priv->modem_3gpp_registration_state == MM_MODEM_3GPP_REGISTRATION_STATE_ROAMING)
+            mm_iface_modem_3gpp_reload_current_operator (MM_IFACE_MODEM_3GPP (self), NULL, NULL);
+    }
+
+    /* Done we are */
+    g_simple_async_result_set_op_res_gboolean (result, TRUE);
+    g_simple_async_result_complete_in_idle (result);
+    g_object_unref (result);
+}
+
+/*****************************************************************************/
+/* Check support (Time interface) */
+
+static gboolean
+modem_time_check_support_finish (MMIfaceModemTime *self,
+                                 GAsyncResult *res,
+                                 GError **error)
+{
+    return !!mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, error);
+}
+
+static void
+modem_time_check_support (MMIfaceModemTime *self,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
+{
+    /* Only network timezone reporting is generic */
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              "+CTZR=?",
+                              3,
+                              TRUE,
+                              callback,
+                              user_data);
+}
+
+/*****************************************************************************/
+/* Setup/cleanup network timezone unsolicited events (Time interface) */
+
+static gboolean
+modem_time_setup_cleanup_unsolicited_events_finish (MMIfaceModemTime *self,
+                                                    GAsyncResult *res,
+                                                    GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+ctz_received (MMAtSerialPort *port,
+              GMatchInfo *info,
+              MMBroadbandModem *self)
+{
+    MMNetworkTimezone *tz;
+    GError *error = NULL;
+    gchar *str;
+    gint offset;
+    gint dst_offset;
+
+    str = g_match_info_fetch (info, 1);
+    if (!mm_3gpp_parse_ctzv_ctze (str, &offset, &dst_offset, &error)) {
+        mm_dbg ("Couldn't process network timezone report: %s", error->message);
+        g_error_free (error);
+        g_free (str);
+        return;
+    }
+    g_free (str);
+
+    mm_dbg ("Got network timezone report: offset %d, DST offset %d", offset, dst_offset);
+
+    tz = mm_network_timezone_new ();
+    mm_network_timezone_set_offset (tz, offset);
+    if (dst_offset >= 0)
+        mm_network_timezone_set_dst_offset (tz, dst_offset);
+    mm_iface_modem_time_update_network_timezone (MM_IFACE_MODEM_TIME (self), tz);
+    g_object_unref (tz);
+}
+
+static void
+set_time_unsolicited_events_handlers (MMIfaceModemTime *self,
+                                      gboolean enable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
+{
+    GSimpleAsyncResult *result;
+    MMAtSerialPort *ports[2];
+    GRegex *ctz_regex;
+    guint i;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        set_time_unsolicited_events_handlers);
+
+    ctz_regex = mm_3gpp_ctz_regex_get ();
+    ports[0] = mm_base_modem_peek_port_primary (MM_BASE_MODEM (self));
+    ports[1] = mm_base_modem_peek_port_secondary (MM_BASE_MODEM (self));
+
+    /* Enable unsolicited events in given port */
+    for (i = 0; i < 2; i++) {
+        if (!ports[i])
+            continue;
+
+        /* Set/unset unsolicited CTZV/CTZE event handler */
+        mm_dbg ("(%s) %s time unsolicited events handlers",
+                mm_port_get_device (MM_PORT (ports[i])),
+                enable ? "Setting" : "Removing");
+        mm_at_serial_port_add_unsolicited_msg_handler (
+            ports[i],
+            ctz_regex,
+            enable ? (MMAtSerialUnsolicitedMsgFn) ctz_received : NULL,
+            enable ? self : NULL,
+            NULL);
+    }
+
+    g_regex_unref (ctz_regex);
+    g_simple_async_result_set_op_res_gboolean (result, TRUE);
+    g_simple_async_result_complete_in_idle (result);
+    g_object_unref (result);
+}
+
+static void
+modem_time_setup_unsolicited_events (MMIfaceModemTime *self,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+    set_time_unsolicited_events_handlers (self, TRUE, callback, user_data);
+}
+
+static void
+modem_time_cleanup_unsolicited_events (MMIfaceModemTime *self,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+    set_time_unsolicited_events_handlers (self, FALSE, callback, user_data);
+}
+
+/*****************************************************************************/
+/* Enable/Disable network timezone reporting (Time interface) */
 
 static gboolean
-enable_location_gathering_finish (MMIfaceModemLocation *self,
-                                  GAsyncResult *res,
-                                  GError **error)
+modem_time_enable_unsolicited_events_finish (MMIfaceModemTime *self,
+                                             GAsyncResult *res,
+                                             GError **error)
 {
-    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+    GError *inner_error = NULL;
+
+    mm_base_modem_at_sequence_finish (MM_BASE_MODEM (self), res, NULL, &inner_error);
+    if (inner_error) {
+        g_propagate_error (error, inner_error);
+        return FALSE;
+    }
+
+    return TRUE;
 }
 
+static const MMBaseModemAtCommand ctzr_enable_sequence[] = {
+    /* +CTZE, with DST; otherwise +CTZV */
+    { "+CTZR=2", 3, FALSE, mm_base_modem_response_processor_continue_on_error },
+    { "+CTZR=1", 3, FALSE, mm_base_modem_response_processor_no_result },
+    { NULL }
+};
+
 static void
-enable_location_gathering (MMIfaceModemLocation *self,
-                           MMModemLocationSource source,
-                           GAsyncReadyCallback callback,
-                           gpointer user_data)
+modem_time_enable_unsolicited_events (MMIfaceModemTime *self,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
 {
-    GSimpleAsyncResult *result;
+    mm_base_modem_at_sequence (MM_BASE_MODEM (self),
+                               ctzr_enable_sequence,
+                               NULL, /* response_processor_context */
+                               NULL, /* response_processor_context_free */
+                               callback,
+                               user_data);
+}
 
-    result = g_simple_async_result_new (G_OBJECT (self),
-                                        callback,
-                                        user_data,
-                                        enable_location_gathering);
+static gboolean
+modem_time_disable_unsolicited_events_finish (MMIfaceModemTime *self,
+                                              GAsyncResult *res,
+                                              GError **error)
+{
+    GError *inner_error = NULL;
 
-    /* 3GPP modems need to re-run registration checks when enabling the 3GPP
-     * location source, so that we get up to date LAC/CI location information.
-     * Note that we don't care for when the registration checks get finished.
-     */
-    if (source == MM_MODEM_LOCATION_SOURCE_3GPP_LAC_CI &&
-        mm_iface_modem_is_3gpp (MM_IFACE_MODEM (self))) {
-        /* Reload registration to get LAC/CI */
-        mm_iface_modem_3gpp_run_registration_checks (MM_IFACE_MODEM_3GPP (self), NULL, NULL);
-        /* Reload operator to get MCC/MNC */
-        if (MM_BROADBAND_MODEM (self)->priv->modem_3gpp_registration_state == MM_MODEM_3GPP_REGISTRATION_STATE_HOME ||
-            MM_BROADBAND_MODEM (self)->priv->modem_3gpp_registration_state == MM_MODEM_3GPP_REGISTRATION_STATE_ROAMING)
-            mm_iface_modem_3gpp_reload_current_operator (MM_IFACE_MODEM_3GPP (self), NULL, NULL);
+    /* Not critical; the reports may not have been enabled in the first place */
+    if (!mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &inner_error)) {
+        mm_dbg ("Couldn't disable network timezone reporting: '%s'", inner_error->message);
+        g_error_free (inner_error);
     }
 
-    /* Done we are */
-    g_simple_async_result_set_op_res_gboolean (result, TRUE);
-    g_simple_async_result_complete_in_idle (result);
-    g_object_unref (result);
+    return TRUE;
+}
+
+static void
+modem_time_disable_unsolicited_events (MMIfaceModemTime *self,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              "+CTZR=0",
+                              3,
+                              FALSE,
+                              callback,
+                              user_data);
 }
 
 /*****************************************************************************/
@@ -7140,6 +7707,20 @@ setup_ports (MMBroadbandModem *self)
                                                        NULL);
     }
     g_regex_unref (regex);
+
+    /* Set up CTZV/CTZE unsolicited message handler, with NULL callback */
+    regex = mm_3gpp_ctz_regex_get ();
+    for (i = 0; i < 2; i++) {
+        if (!ports[i])
+            continue;
+
+        mm_at_serial_port_add_unsolicited_msg_handler (MM_AT_SERIAL_PORT (ports[i]),
+                                                       regex,
+                                                       NULL,
+                                                       NULL,
+                                                       NULL);
+    }
+    g_regex_unref (regex);
 }
 
 /*****************************************************************************/
@@ -7154,6 +7735,8 @@ struct _PortsContext {
     gboolean secondary_open;
     MMQcdmSerialPort *qcdm;
     gboolean qcdm_open;
+    MMWmcSerialPort *wmc;
+    gboolean wmc_open;
 };
 
 static PortsContext *
@@ -7182,6 +7765,11 @@ ports_context_unref (PortsContext *ctx)
                 mm_serial_port_close (MM_SERIAL_PORT (ctx->qcdm));
             g_object_unref (ctx->qcdm);
         }
+        if (ctx->wmc) {
+            if (ctx->wmc_open)
+                mm_serial_port_close (MM_SERIAL_PORT (ctx->wmc));
+            g_object_unref (ctx->wmc);
+        }
         g_free (ctx);
     }
 }
@@ -7305,6 +7893,7 @@ static gboolean
 disabling_stopped (MMBroadbandModem *self,
                    GError **error)
 {
+    mm_base_modem_set_secondary_balanced (MM_BASE_MODEM (self), FALSE);
     if (self->priv->enabled_ports_ctx) {
         ports_context_unref (self->priv->enabled_ports_ctx);
         self->priv->enabled_ports_ctx = NULL;
@@ -7364,6 +7953,8 @@ open_ports_enabling (MMBroadbandModem *self,
     /* Open secondary (optional) */
     ctx->secondary = mm_base_modem_get_port_secondary (MM_BASE_MODEM (self));
     if (ctx->secondary) {
+        /* Until it gets setup, the secondary port is not balanced */
+        mm_base_modem_set_secondary_balanced (MM_BASE_MODEM (self), FALSE);
         if (!mm_serial_port_open (MM_SERIAL_PORT (ctx->secondary), error)) {
             g_prefix_error (error, "Couldn't open secondary port: ");
             return FALSE;
@@ -7381,9 +7972,52 @@ open_ports_enabling (MMBroadbandModem *self,
         ctx->qcdm_open = TRUE;
     }
 
+    /* Open wmc (optional); it only speeds up status queries, so don't fail
+     * enabling if it cannot be opened */
+    ctx->wmc = mm_base_modem_get_port_wmc (MM_BASE_MODEM (self));
+    if (ctx->wmc) {
+        GError *wmc_error = NULL;
+
+        if (!mm_serial_port_open (MM_SERIAL_PORT (ctx->wmc), &wmc_error)) {
+            mm_warn ("Couldn't open WMC port: %s", wmc_error->message);
+            g_error_free (wmc_error);
+        } else
+            ctx->wmc_open = TRUE;
+    }
+
     return TRUE;
 }
 
+/* Same port setup as the one the primary gets during initialization; charset
+ * and SMS setup are not needed as the commands relying on them are always
+ * sent to the primary port. */
+static const MMBaseModemAtCommand secondary_setup_sequence[] = {
+    { "E0 V1",   3, FALSE, NULL },
+    { "+CMEE=1", 3, FALSE, NULL },
+    { NULL }
+};
+
+static void
+secondary_setup_ready (MMBaseModem *self,
+                       GAsyncResult *res,
+                       EnablingStartedContext *ctx)
+{
+    GError *error = NULL;
+
+    mm_base_modem_at_sequence_full_finish (self, res, NULL, &error);
+    if (error) {
+        /* Not fatal; the secondary port just won't take balanced commands */
+        mm_dbg ("Couldn't setup secondary port, won't balance commands: '%s'",
+                error->message);
+        g_error_free (error);
+    } else
+        mm_base_modem_set_secondary_balanced (self, TRUE);
+
+    ctx->self->priv->enabled_ports_ctx = ports_context_ref (ctx->ports);
+    g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+    enabling_started_context_complete_and_free (ctx);
+}
+
 static void
 enabling_flash_done (MMSerialPort *port,
                      GError *error,
@@ -7392,11 +8026,25 @@ enabling_flash_done (MMSerialPort *port,
     if (error) {
         g_prefix_error (&error, "Primary port flashing failed: ");
         g_simple_async_result_set_from_error (ctx->result, error);
-    } else {
-        ctx->self->priv->enabled_ports_ctx = ports_context_ref (ctx->ports);
-        g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+        enabling_started_context_complete_and_free (ctx);
+        return;
     }
 
+    /* Setup the secondary port before letting it take balanced commands */
+    if (ctx->ports->secondary) {
+        mm_base_modem_at_sequence_full (MM_BASE_MODEM (ctx->self),
+                                        ctx->ports->secondary,
+                                        secondary_setup_sequence,
+                                        NULL, /* response_processor_context */
+                                        NULL, /* response_processor_context_free */
+                                        NULL, /* cancellable */
+                                        (GAsyncReadyCallback)secondary_setup_ready,
+                                        ctx);
+        return;
+    }
+
+    ctx->self->priv->enabled_ports_ctx = ports_context_ref (ctx->ports);
+    g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
     enabling_started_context_complete_and_free (ctx);
 }
 
@@ -7460,6 +8108,8 @@ typedef struct {
     DisablingStep step;
     MMModemState previous_state;
     gboolean disabled;
+    gint64 trace_start;
+    gint64 step_trace_start;
 } DisablingContext;
 
 static void disabling_step (DisablingContext *ctx);
@@ -7469,6 +8119,12 @@ disabling_context_complete_and_free (DisablingContext *ctx)
 {
     GError *error = NULL;
 
+    mm_trace_span ("modem",
+                   mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   ctx->trace_start,
+                   "disable",
+                   ctx->disabled ? "disabled" : "failed");
+
     g_simple_async_result_complete_in_idle (ctx->result);
 
     if (MM_BROADBAND_MODEM_GET_CLASS (ctx->self)->disabling_stopped &&
@@ -7527,10 +8183,17 @@ disable_finish (MMBaseModem *self,
                           DisablingContext *ctx)                        \
     {                                                                   \
         GError *error = NULL;                                           \
+        gboolean disabled;                                              \
                                                                         \
-        if (!mm_##NAME##_disable_finish (TYPE (self),                   \
-                                         result,                        \
-                                         &error)) {                     \
+        disabled = mm_##NAME##_disable_finish (TYPE (self),             \
+                                               result,                  \
+                                               &error);                 \
+        mm_trace_span ("modem",                                         \
+                       mm_base_modem_get_device (MM_BASE_MODEM (self)), \
+                       ctx->step_trace_start,                           \
+                       "disable " #NAME,                                \
+                       error ? error->message : NULL);                  \
+        if (!disabled) {                                                \
             if (FATAL_ERRORS) {                                         \
                 g_simple_async_result_take_error (G_SIMPLE_ASYNC_RESULT (ctx->result), error); \
                 disabling_context_complete_and_free (ctx);              \
@@ -7615,6 +8278,29 @@ disabling_wait_for_final_state_ready (MMIfaceModem *self,
     disabling_step (ctx);
 }
 
+static void
+qcdm_log_capture_start (MMBroadbandModem *self)
+{
+    MMQcdmSerialPort *qcdm;
+    GError *error = NULL;
+
+    if (self->priv->qcdm_log_capture || !mm_context_get_qcdm_log_dir ())
+        return;
+
+    qcdm = mm_base_modem_peek_port_qcdm (MM_BASE_MODEM (self));
+    if (!qcdm)
+        return;
+
+    self->priv->qcdm_log_capture = mm_qcdm_log_capture_new (qcdm,
+                                                            mm_context_get_qcdm_log_dir (),
+                                                            mm_context_get_qcdm_log_codes (),
+                                                            &error);
+    if (!self->priv->qcdm_log_capture) {
+        mm_warn ("Couldn't start QCDM log capture: %s", error->message);
+        g_error_free (error);
+    }
+}
+
 static void
 disabling_step (DisablingContext *ctx)
 {
@@ -7622,9 +8308,12 @@ disabling_step (DisablingContext *ctx)
     if (disabling_context_complete_and_free_if_cancelled (ctx))
         return;
 
+    ctx->step_trace_start = mm_trace_begin ();
+
     switch (ctx->step) {
     case DISABLING_STEP_FIRST:
         mm_info ("Modem disabling...");
+        g_clear_object (&ctx->self->priv->qcdm_log_capture);
         /* Fall down to next step */
         ctx->step++;
 
@@ -7768,6 +8457,7 @@ disable (MMBaseModem *self,
     ctx->result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, disable);
     ctx->cancellable = (cancellable ? g_object_ref (cancellable) : NULL);
     ctx->step = DISABLING_STEP_FIRST;
+    ctx->trace_start = mm_trace_begin ();
 
     disabling_step (ctx);
 }
@@ -7798,6 +8488,8 @@ typedef struct {
     EnablingStep step;
     MMModemState previous_state;
     gboolean enabled;
+    gint64 trace_start;
+    gint64 step_trace_start;
 } EnablingContext;
 
 static void enabling_step (EnablingContext *ctx);
@@ -7805,6 +8497,12 @@ static void enabling_step (EnablingContext *ctx);
 static void
 enabling_context_complete_and_free (EnablingContext *ctx)
 {
+    mm_trace_span ("modem",
+                   mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   ctx->trace_start,
+                   "enable",
+                   ctx->enabled ? "enabled" : "failed");
+
     g_simple_async_result_complete_in_idle (ctx->result);
     g_object_unref (ctx->result);
 
@@ -7859,10 +8557,17 @@ enable_finish (MMBaseModem *self,
                          EnablingContext *ctx)                          \
     {                                                                   \
         GError *error = NULL;                                           \
+        gboolean enabled;                                               \
                                                                         \
-        if (!mm_##NAME##_enable_finish (TYPE (self),                    \
-                                        result,                         \
-                                        &error)) {                      \
+        enabled = mm_##NAME##_enable_finish (TYPE (self),               \
+                                             result,                    \
+                                             &error);                   \
+        mm_trace_span ("modem",                                         \
+                       mm_base_modem_get_device (MM_BASE_MODEM (self)), \
+                       ctx->step_trace_start,                           \
+                       "enable " #NAME,                                 \
+                       error ? error->message : NULL);                  \
+        if (!enabled) {                                                 \
             if (FATAL_ERRORS) {                                         \
                 g_simple_async_result_take_error (G_SIMPLE_ASYNC_RESULT (ctx->result), error); \
                 enabling_context_complete_and_free (ctx);               \
@@ -7944,6 +8649,8 @@ enabling_step (EnablingContext *ctx)
     if (enabling_context_complete_and_free_if_cancelled (ctx))
         return;
 
+    ctx->step_trace_start = mm_trace_begin ();
+
     switch (ctx->step) {
     case ENABLING_STEP_FIRST:
         mm_info ("Modem enabling...");
@@ -8067,6 +8774,7 @@ enabling_step (EnablingContext *ctx)
 
     case ENABLING_STEP_LAST:
         mm_info ("Modem fully enabled...");
+        qcdm_log_capture_start (ctx->self);
         ctx->enabled = TRUE;
         /* All enabled without errors! */
         g_simple_async_result_set_op_res_gboolean (G_SIMPLE_ASYNC_RESULT (ctx->result), TRUE);
@@ -8118,6 +8826,7 @@ enable (MMBaseModem *self,
         ctx->result = result;
         ctx->cancellable = g_object_ref (cancellable);
         ctx->step = ENABLING_STEP_FIRST;
+        ctx->trace_start = mm_trace_begin ();
         enabling_step (ctx);
         return;
     }
@@ -8161,24 +8870,30 @@ typedef enum {
     INITIALIZE_STEP_STARTED,
     INITIALIZE_STEP_SETUP_SIMPLE_STATUS,
     INITIALIZE_STEP_IFACE_MODEM,
-    INITIALIZE_STEP_IFACE_3GPP,
-    INITIALIZE_STEP_IFACE_3GPP_USSD,
-    INITIALIZE_STEP_IFACE_CDMA,
-    INITIALIZE_STEP_IFACE_CONTACTS,
-    INITIALIZE_STEP_IFACE_LOCATION,
-    INITIALIZE_STEP_IFACE_MESSAGING,
-    INITIALIZE_STEP_IFACE_TIME,
+    INITIALIZE_STEP_IFACES,
     INITIALIZE_STEP_IFACE_FIRMWARE,
     INITIALIZE_STEP_IFACE_SIMPLE,
     INITIALIZE_STEP_LAST,
 } InitializeStep;
 
+/* Interfaces initialized concurrently once the Modem interface is ready */
+typedef enum {
+    INITIALIZE_IFACE_STEP_3GPP,
+    INITIALIZE_IFACE_STEP_3GPP_USSD,
+    INITIALIZE_IFACE_STEP_CDMA,
+    INITIALIZE_IFACE_STEP_LOCATION,
+    INITIALIZE_IFACE_STEP_MESSAGING,
+    INITIALIZE_IFACE_STEP_TIME,
+} InitializeIfaceStep;
+
 typedef struct {
     MMBroadbandModem *self;
     GCancellable *cancellable;
     GSimpleAsyncResult *result;
     InitializeStep step;
     gpointer ports_ctx;
+    MMStepScheduler *ifaces;
+    gint64 start_time;
 } InitializeContext;
 
 static void initialize_step (InitializeContext *ctx);
@@ -8188,6 +8903,12 @@ initialize_context_complete_and_free (InitializeContext *ctx)
 {
     GError *error = NULL;
 
+    mm_trace_span ("modem",
+                   mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   ctx->start_time,
+                   "initialize",
+                   mm_modem_state_get_string (ctx->self->priv->modem_state));
+
     g_simple_async_result_complete_in_idle (ctx->result);
 
     if (ctx->ports_ctx &&
@@ -8305,7 +9026,7 @@ iface_modem_initialize_ready (MMBroadbandModem *self,
 }
 
 #undef INTERFACE_INIT_READY_FN
-#define INTERFACE_INIT_READY_FN(NAME,TYPE,FATAL_ERRORS)                 \
+#define INTERFACE_INIT_READY_FN(NAME,TYPE,FATAL_ERRORS,STEP)            \
     static void                                                         \
     NAME##_initialize_ready (MMBroadbandModem *self,                    \
                              GAsyncResult *result,                      \
@@ -8324,34 +9045,174 @@ iface_modem_initialize_ready (MMBroadbandModem *self,
                                              MM_MODEM_STATE_FAILED,     \
                                              MM_MODEM_STATE_CHANGE_REASON_UNKNOWN); \
                                                                         \
-                /* Just jump to the last step */                        \
-                ctx->step = INITIALIZE_STEP_LAST;                       \
-                initialize_step (ctx);                                  \
-                return;                                                 \
+                /* Don't launch any other interface */                  \
+                mm_step_scheduler_abort (ctx->ifaces);                  \
+            } else {                                                    \
+                mm_dbg ("Couldn't initialize interface: '%s'",          \
+                        error->message);                                \
+                /* Just shutdown this interface */                      \
+                mm_##NAME##_shutdown (TYPE (self));                     \
+                g_error_free (error);                                   \
             }                                                           \
-                                                                        \
-            mm_dbg ("Couldn't initialize interface: '%s'",              \
-                    error->message);                                    \
-            /* Just shutdown this interface */                          \
-            mm_##NAME##_shutdown (TYPE (self));                         \
-            g_error_free (error);                                       \
         } else {                                                        \
             /* bind simple properties */                                \
             mm_##NAME##_bind_simple_status (TYPE (self), self->priv->modem_simple_status); \
         }                                                               \
                                                                         \
-        /* Go on to next step */                                        \
-        ctx->step++;                                                    \
-        initialize_step (ctx);                                          \
+        mm_step_scheduler_step_done (ctx->ifaces, STEP);                \
+    }
+
+INTERFACE_INIT_READY_FN (iface_modem_3gpp,      MM_IFACE_MODEM_3GPP,      TRUE,  INITIALIZE_IFACE_STEP_3GPP)
+INTERFACE_INIT_READY_FN (iface_modem_3gpp_ussd, MM_IFACE_MODEM_3GPP_USSD, FALSE, INITIALIZE_IFACE_STEP_3GPP_USSD)
+INTERFACE_INIT_READY_FN (iface_modem_cdma,      MM_IFACE_MODEM_CDMA,      TRUE,  INITIALIZE_IFACE_STEP_CDMA)
+INTERFACE_INIT_READY_FN (iface_modem_location,  MM_IFACE_MODEM_LOCATION,  FALSE, INITIALIZE_IFACE_STEP_LOCATION)
+INTERFACE_INIT_READY_FN (iface_modem_messaging, MM_IFACE_MODEM_MESSAGING, FALSE, INITIALIZE_IFACE_STEP_MESSAGING)
+INTERFACE_INIT_READY_FN (iface_modem_time,      MM_IFACE_MODEM_TIME,      FALSE, INITIALIZE_IFACE_STEP_TIME)
+
+static void
+initialize_iface_3gpp (MMStepScheduler *scheduler,
+                       guint step,
+                       InitializeContext *ctx)
+{
+    if (!mm_iface_modem_is_3gpp (MM_IFACE_MODEM (ctx->self))) {
+        mm_step_scheduler_step_done (scheduler, step);
+        return;
+    }
+
+    /* Initialize the 3GPP interface */
+    mm_iface_modem_3gpp_initialize (MM_IFACE_MODEM_3GPP (ctx->self),
+                                    ctx->cancellable,
+                                    (GAsyncReadyCallback)iface_modem_3gpp_initialize_ready,
+                                    ctx);
+}
+
+static void
+initialize_iface_3gpp_ussd (MMStepScheduler *scheduler,
+                            guint step,
+                            InitializeContext *ctx)
+{
+    if (!mm_iface_modem_is_3gpp (MM_IFACE_MODEM (ctx->self))) {
+        mm_step_scheduler_step_done (scheduler, step);
+        return;
+    }
+
+    /* Initialize the 3GPP/USSD interface */
+    mm_iface_modem_3gpp_ussd_initialize (MM_IFACE_MODEM_3GPP_USSD (ctx->self),
+                                         (GAsyncReadyCallback)iface_modem_3gpp_ussd_initialize_ready,
+                                         ctx);
+}
+
+static void
+initialize_iface_cdma (MMStepScheduler *scheduler,
+                       guint step,
+                       InitializeContext *ctx)
+{
+    if (!mm_iface_modem_is_cdma (MM_IFACE_MODEM (ctx->self))) {
+        mm_step_scheduler_step_done (scheduler, step);
+        return;
+    }
+
+    /* Initialize the CDMA interface */
+    mm_iface_modem_cdma_initialize (MM_IFACE_MODEM_CDMA (ctx->self),
+                                    ctx->cancellable,
+                                    (GAsyncReadyCallback)iface_modem_cdma_initialize_ready,
+                                    ctx);
+}
+
+static void
+initialize_iface_location (MMStepScheduler *scheduler,
+                           guint step,
+                           InitializeContext *ctx)
+{
+    /* Initialize the Location interface */
+    mm_iface_modem_location_initialize (MM_IFACE_MODEM_LOCATION (ctx->self),
+                                        ctx->cancellable,
+                                        (GAsyncReadyCallback)iface_modem_location_initialize_ready,
+                                        ctx);
+}
+
+static void
+initialize_iface_messaging (MMStepScheduler *scheduler,
+                            guint step,
+                            InitializeContext *ctx)
+{
+    /* Initialize the Messaging interface */
+    mm_iface_modem_messaging_initialize (MM_IFACE_MODEM_MESSAGING (ctx->self),
+                                         ctx->cancellable,
+                                         (GAsyncReadyCallback)iface_modem_messaging_initialize_ready,
+                                         ctx);
+}
+
+static void
+initialize_iface_time (MMStepScheduler *scheduler,
+                       guint step,
+                       InitializeContext *ctx)
+{
+    /* Initialize the Time interface */
+    mm_iface_modem_time_initialize (MM_IFACE_MODEM_TIME (ctx->self),
+                                    ctx->cancellable,
+                                    (GAsyncReadyCallback)iface_modem_time_initialize_ready,
+                                    ctx);
+}
+
+#define STEP_RUN(NAME) ((MMStepRunFn)initialize_iface_##NAME)
+#define DEP(STEP) MM_STEP (INITIALIZE_IFACE_STEP_##STEP)
+
+/* Same order as InitializeIfaceStep. USSD, Location and Messaging rely on
+ * what the 3GPP and CDMA interfaces set up; Time is independent. */
+static const MMStepInfo initialize_iface_steps[] = {
+    { "3GPP",      STEP_RUN (3gpp),      0,                      MM_STEP_PORT_AT },
+    { "3GPP/USSD", STEP_RUN (3gpp_ussd), DEP (3GPP),             MM_STEP_PORT_AT },
+    { "CDMA",      STEP_RUN (cdma),      0,                      MM_STEP_PORT_AT },
+    { "Location",  STEP_RUN (location),  DEP (3GPP) | DEP (CDMA), MM_STEP_PORT_AT },
+    { "Messaging", STEP_RUN (messaging), DEP (3GPP) | DEP (CDMA), MM_STEP_PORT_AT },
+    { "Time",      STEP_RUN (time),      0,                      MM_STEP_PORT_AT },
+};
+
+#undef STEP_RUN
+#undef DEP
+
+static void
+initialize_ifaces_done (MMStepScheduler *scheduler,
+                        InitializeContext *ctx)
+{
+    gboolean aborted;
+
+    aborted = mm_step_scheduler_is_aborted (scheduler);
+    mm_step_scheduler_free (ctx->ifaces);
+    ctx->ifaces = NULL;
+
+    /* On fatal errors, just jump to the last step; cancellation is handled
+     * in the next one */
+    if (aborted && ctx->self->priv->modem_state == MM_MODEM_STATE_FAILED)
+        ctx->step = INITIALIZE_STEP_LAST;
+    else
+        ctx->step++;
+    initialize_step (ctx);
+}
+
+static void
+iface_modem_firmware_initialize_ready (MMBroadbandModem *self,
+                                       GAsyncResult *result,
+                                       InitializeContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_iface_modem_firmware_initialize_finish (MM_IFACE_MODEM_FIRMWARE (self), result, &error)) {
+        mm_dbg ("Couldn't initialize interface: '%s'",
+                error->message);
+        /* Just shutdown this interface */
+        mm_iface_modem_firmware_shutdown (MM_IFACE_MODEM_FIRMWARE (self));
+        g_error_free (error);
+    } else {
+        /* bind simple properties */
+        mm_iface_modem_firmware_bind_simple_status (MM_IFACE_MODEM_FIRMWARE (self), self->priv->modem_simple_status);
     }
 
-INTERFACE_INIT_READY_FN (iface_modem_3gpp,      MM_IFACE_MODEM_3GPP,      TRUE)
-INTERFACE_INIT_READY_FN (iface_modem_3gpp_ussd, MM_IFACE_MODEM_3GPP_USSD, FALSE)
-INTERFACE_INIT_READY_FN (iface_modem_cdma,      MM_IFACE_MODEM_CDMA,      TRUE)
-INTERFACE_INIT_READY_FN (iface_modem_location,  MM_IFACE_MODEM_LOCATION,  FALSE)
-INTERFACE_INIT_READY_FN (iface_modem_messaging, MM_IFACE_MODEM_MESSAGING, FALSE)
-INTERFACE_INIT_READY_FN (iface_modem_time,      MM_IFACE_MODEM_TIME,      FALSE)
-INTERFACE_INIT_READY_FN (iface_modem_firmware,  MM_IFACE_MODEM_FIRMWARE,  FALSE)
+    /* Go on to next step */
+    ctx->step++;
+    initialize_step (ctx);
+}
 
 static void
 initialize_step (InitializeContext *ctx)
@@ -8400,68 +9261,17 @@ initialize_step (InitializeContext *ctx)
                                    ctx);
         return;
 
-    case INITIALIZE_STEP_IFACE_3GPP:
-        if (mm_iface_modem_is_3gpp (MM_IFACE_MODEM (ctx->self))) {
-            /* Initialize the 3GPP interface */
-            mm_iface_modem_3gpp_initialize (MM_IFACE_MODEM_3GPP (ctx->self),
-                                            ctx->cancellable,
-                                            (GAsyncReadyCallback)iface_modem_3gpp_initialize_ready,
-                                            ctx);
-            return;
-        }
-
-        /* Fall down to next step */
-        ctx->step++;
-
-    case INITIALIZE_STEP_IFACE_3GPP_USSD:
-        if (mm_iface_modem_is_3gpp (MM_IFACE_MODEM (ctx->self))) {
-            /* Initialize the 3GPP/USSD interface */
-            mm_iface_modem_3gpp_ussd_initialize (MM_IFACE_MODEM_3GPP_USSD (ctx->self),
-                                                 (GAsyncReadyCallback)iface_modem_3gpp_ussd_initialize_ready,
-                                                 ctx);
-            return;
-        }
-        /* Fall down to next step */
-        ctx->step++;
-
-    case INITIALIZE_STEP_IFACE_CDMA:
-        if (mm_iface_modem_is_cdma (MM_IFACE_MODEM (ctx->self))) {
-            /* Initialize the CDMA interface */
-            mm_iface_modem_cdma_initialize (MM_IFACE_MODEM_CDMA (ctx->self),
-                                            ctx->cancellable,
-                                            (GAsyncReadyCallback)iface_modem_cdma_initialize_ready,
-                                            ctx);
-            return;
-        }
-        /* Fall down to next step */
-        ctx->step++;
-
-    case INITIALIZE_STEP_IFACE_CONTACTS:
-        /* Fall down to next step */
-        ctx->step++;
-
-    case INITIALIZE_STEP_IFACE_LOCATION:
-        /* Initialize the Location interface */
-        mm_iface_modem_location_initialize (MM_IFACE_MODEM_LOCATION (ctx->self),
-                                            ctx->cancellable,
-                                            (GAsyncReadyCallback)iface_modem_location_initialize_ready,
-                                            ctx);
-        return;
-
-    case INITIALIZE_STEP_IFACE_MESSAGING:
-        /* Initialize the Messaging interface */
-        mm_iface_modem_messaging_initialize (MM_IFACE_MODEM_MESSAGING (ctx->self),
-                                             ctx->cancellable,
-                                             (GAsyncReadyCallback)iface_modem_messaging_initialize_ready,
+    case INITIALIZE_STEP_IFACES:
+        /* Initialize the remaining interfaces, concurrently where possible */
+        ctx->ifaces = mm_step_scheduler_new ("interfaces",
+                                             initialize_iface_steps,
+                                             G_N_ELEMENTS (initialize_iface_steps),
                                              ctx);
-        return;
-
-    case INITIALIZE_STEP_IFACE_TIME:
-        /* Initialize the Time interface */
-        mm_iface_modem_time_initialize (MM_IFACE_MODEM_TIME (ctx->self),
-                                        ctx->cancellable,
-                                        (GAsyncReadyCallback)iface_modem_time_initialize_ready,
-                                        ctx);
+        mm_base_modem_setup_step_scheduler (MM_BASE_MODEM (ctx->self), ctx->ifaces);
+        mm_step_scheduler_run (ctx->ifaces,
+                               ctx->cancellable,
+                               (MMStepSchedulerDoneFn)initialize_ifaces_done,
+                               ctx);
         return;
 
     case INITIALIZE_STEP_IFACE_FIRMWARE:
@@ -8521,7 +9331,8 @@ initialize_step (InitializeContext *ctx)
             return;
         }
 
-        mm_info ("Modem fully initialized");
+        mm_info ("Modem fully initialized in %.2fs",
+                 (g_get_monotonic_time () - ctx->start_time) / (gdouble) G_USEC_PER_SEC);
 
         /* All initialized without errors!
          * Set as disabled (a.k.a. initialized) */
@@ -8567,6 +9378,7 @@ initialize (MMBaseModem *self,
         ctx->cancellable = g_object_ref (cancellable);
         ctx->result = result;
         ctx->step = INITIALIZE_STEP_FIRST;
+        ctx->start_time = g_get_monotonic_time ();
 
         /* Set as being initialized, even if we were locked before */
         mm_iface_modem_update_state (MM_IFACE_MODEM (self),
@@ -8855,7 +9667,6 @@ mm_broadband_modem_init (MMBroadbandModem *self)
                                               MM_TYPE_BROADBAND_MODEM,
                                               MMBroadbandModemPrivate);
     self->priv->modem_state = MM_MODEM_STATE_UNKNOWN;
-    self->priv->modem_3gpp_registration_regex = mm_3gpp_creg_regex_get (TRUE);
     self->priv->modem_current_charset = MM_MODEM_CHARSET_UNKNOWN;
     self->priv->modem_3gpp_registration_state = MM_MODEM_3GPP_REGISTRATION_STATE_UNKNOWN;
     self->priv->modem_3gpp_cs_network_supported = TRUE;
@@ -8877,8 +9688,7 @@ finalize (GObject *object)
     if (self->priv->enabled_ports_ctx)
         ports_context_unref (self->priv->enabled_ports_ctx);
 
-    if (self->priv->modem_3gpp_registration_regex)
-        mm_3gpp_creg_regex_destroy (self->priv->modem_3gpp_registration_regex);
+    g_free (self->priv->qcdm_snapshot);
 
     G_OBJECT_CLASS (mm_broadband_modem_parent_class)->finalize (object);
 }
@@ -8888,6 +9698,8 @@ dispose (GObject *object)
 {
     MMBroadbandModem *self = MM_BROADBAND_MODEM (object);
 
+    g_clear_object (&self->priv->qcdm_log_capture);
+
     if (self->priv->modem_dbus_skeleton) {
         mm_iface_modem_shutdown (MM_IFACE_MODEM (object));
         g_clear_object (&self->priv->modem_dbus_skeleton);
@@ -9122,6 +9934,16 @@ iface_modem_messaging_init (MMIfaceModemMessaging *iface)
 static void
 iface_modem_time_init (MMIfaceModemTime *iface)
 {
+    iface->check_support = modem_time_check_support;
+    iface->check_support_finish = modem_time_check_support_finish;
+    iface->setup_unsolicited_events = modem_time_setup_unsolicited_events;
+    iface->setup_unsolicited_events_finish = modem_time_setup_cleanup_unsolicited_events_finish;
+    iface->cleanup_unsolicited_events = modem_time_cleanup_unsolicited_events;
+    iface->cleanup_unsolicited_events_finish = modem_time_setup_cleanup_unsolicited_events_finish;
+    iface->enable_unsolicited_events = modem_time_enable_unsolicited_events;
+    iface->enable_unsolicited_events_finish = modem_time_enable_unsolicited_events_finish;
+    iface->disable_unsolicited_events = modem_time_disable_unsolicited_events;
+    iface->disable_unsolicited_events_finish = modem_time_disable_unsolicited_events_finish;
 }
 
 static void
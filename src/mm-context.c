@@ -23,6 +23,12 @@ static const gchar *log_level;
 static const gchar *log_file;
 static gboolean show_ts;
 static gboolean rel_ts;
+static gboolean serial_io_threads;
+static gboolean low_memory;
+static const gchar *qcdm_log_dir;
+static const gchar *qcdm_log_codes;
+static gboolean trace;
+static const gchar *trace_file;
 
 static const GOptionEntry entries[] = {
     { "debug", 0, 0, G_OPTION_ARG_NONE, &debug, "Run with extended debugging capabilities", NULL },
@@ -30,6 +36,12 @@ static const GOptionEntry entries[] = {
     { "log-file", 0, 0, G_OPTION_ARG_STRING, &log_file, "Path to log file", NULL },
     { "timestamps", 0, 0, G_OPTION_ARG_NONE, &show_ts, "Show timestamps in log output", NULL },
     { "relative-timestamps", 0, 0, G_OPTION_ARG_NONE, &rel_ts, "Use relative timestamps (from MM start)", NULL },
+    { "serial-io-threads", 0, 0, G_OPTION_ARG_NONE, &serial_io_threads, "Read from each serial port in its own worker thread", NULL },
+    { "low-memory", 0, 0, G_OPTION_ARG_NONE, &low_memory, "Trade some speed for a smaller memory footprint per modem", NULL },
+    { "qcdm-log-dir", 0, 0, G_OPTION_ARG_FILENAME, &qcdm_log_dir, "Capture QCDM log packets of enabled modems into this directory", "PATH" },
+    { "qcdm-log-codes", 0, 0, G_OPTION_ARG_STRING, &qcdm_log_codes, "QCDM log codes to capture, as comma-separated hex values", "CODES" },
+    { "trace", 0, 0, G_OPTION_ARG_NONE, &trace, "Record a timeline of modem operations, in the Chrome trace format", NULL },
+    { "trace-file", 0, 0, G_OPTION_ARG_FILENAME, &trace_file, "Write the timeline to this file on SIGUSR2 and on exit; implies --trace", "PATH" },
     { NULL }
 };
 
@@ -63,6 +75,42 @@ mm_context_get_relative_timestamps (void)
     return rel_ts;
 }
 
+gboolean
+mm_context_get_serial_io_threads (void)
+{
+    return serial_io_threads;
+}
+
+gboolean
+mm_context_get_low_memory (void)
+{
+    return low_memory;
+}
+
+const gchar *
+mm_context_get_qcdm_log_dir (void)
+{
+    return qcdm_log_dir;
+}
+
+const gchar *
+mm_context_get_qcdm_log_codes (void)
+{
+    return qcdm_log_codes;
+}
+
+gboolean
+mm_context_get_trace (void)
+{
+    return trace;
+}
+
+const gchar *
+mm_context_get_trace_file (void)
+{
+    return trace_file;
+}
+
 void
 mm_context_init (gint argc,
                  gchar **argv)
@@ -88,4 +136,7 @@ mm_context_init (gint argc,
         if (!show_ts && !rel_ts)
             show_ts = TRUE;
     }
+
+    if (trace_file)
+        trace = TRUE;
 }
@@ -26,5 +26,11 @@ const gchar *mm_context_get_log_level           (void);
 const gchar *mm_context_get_log_file            (void);
 gboolean     mm_context_get_timestamps          (void);
 gboolean     mm_context_get_relative_timestamps (void);
+gboolean     mm_context_get_serial_io_threads   (void);
+gboolean     mm_context_get_low_memory          (void);
+const gchar *mm_context_get_qcdm_log_dir        (void);
+const gchar *mm_context_get_qcdm_log_codes      (void);
+gboolean     mm_context_get_trace               (void);
+const gchar *mm_context_get_trace_file          (void);
 
 #endif /* MM_CONTEXT_H */
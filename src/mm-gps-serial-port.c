@@ -20,6 +20,7 @@
 
 #include "mm-gps-serial-port.h"
 #include "mm-log.h"
+#include "mm-regex-cache.h"
 
 G_DEFINE_TYPE (MMGpsSerialPort, mm_gps_serial_port, MM_TYPE_SERIAL_PORT)
 
@@ -183,10 +184,10 @@ mm_gps_serial_port_init (MMGpsSerialPort *self)
 
     /* We'll assume that all traces start with the dollar sign and end with \r\n */
     self->priv->known_traces_regex =
-        g_regex_new ("\\$.*\\r\\n",
-                     G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                     0,
-                     NULL);
+        mm_regex_cache_get ("\\$.*\\r\\n",
+                            G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                            0,
+                            NULL);
 }
 
 static void
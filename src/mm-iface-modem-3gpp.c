@@ -23,10 +23,12 @@
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-location.h"
 #include "mm-iface-modem-3gpp.h"
+#include "mm-scan-cache.h"
 #include "mm-base-modem.h"
 #include "mm-modem-helpers.h"
 #include "mm-error-helpers.h"
 #include "mm-log.h"
+#include "mm-timer-wheel.h"
 
 #define REGISTRATION_CHECK_TIMEOUT_SEC 30
 
@@ -34,9 +36,11 @@
 
 #define REGISTRATION_STATE_CONTEXT_TAG    "3gpp-registration-state-context-tag"
 #define REGISTRATION_CHECK_CONTEXT_TAG    "3gpp-registration-check-context-tag"
+#define SCAN_CONTEXT_TAG                  "3gpp-scan-context-tag"
 
 static GQuark registration_state_context_quark;
 static GQuark registration_check_context_quark;
+static GQuark scan_context_quark;
 
 /*****************************************************************************/
 
@@ -533,11 +537,25 @@ handle_register (MmGdbusModem3gpp *skeleton,
 }
 
 /*****************************************************************************/
+/* Network scans
+ *
+ * Scans may take minutes, so the results of the last complete scan are kept
+ * around, and requests arriving while a scan is running wait for it instead
+ * of launching another one.
+ */
+
+typedef enum {
+    SCAN_REQUEST_SCAN,
+    SCAN_REQUEST_SCAN_CACHED,
+    SCAN_REQUEST_BACKGROUND
+} ScanRequest;
 
 typedef struct {
     MmGdbusModem3gpp *skeleton;
     GDBusMethodInvocation *invocation;
     MMIfaceModem3gpp *self;
+    ScanRequest request;
+    guint max_age;
 } HandleScanContext;
 
 static void
@@ -549,6 +567,50 @@ handle_scan_context_free (HandleScanContext *ctx)
     g_free (ctx);
 }
 
+typedef struct {
+    /* Last results, and requests waiting for the running scan */
+    MMScanCache *cache;
+    /* Running scan, when done in steps */
+    guint step;
+    guint step_id;
+    GList *networks;
+} ScanContext;
+
+static void
+scan_context_free (ScanContext *ctx)
+{
+    if (ctx->step_id)
+        g_source_remove (ctx->step_id);
+    mm_scan_cache_free (ctx->cache);
+    mm_3gpp_network_info_list_free (ctx->networks);
+    g_slice_free (ScanContext, ctx);
+}
+
+static ScanContext *
+get_scan_context (MMIfaceModem3gpp *self)
+{
+    ScanContext *ctx;
+
+    if (G_UNLIKELY (!scan_context_quark))
+        scan_context_quark = (g_quark_from_static_string (
+                                  SCAN_CONTEXT_TAG));
+
+    ctx = g_object_get_qdata (G_OBJECT (self), scan_context_quark);
+    if (!ctx) {
+        /* Create context and keep it as object data */
+        ctx = g_slice_new0 (ScanContext);
+        ctx->cache = mm_scan_cache_new ();
+
+        g_object_set_qdata_full (
+            G_OBJECT (self),
+            scan_context_quark,
+            ctx,
+            (GDestroyNotify)scan_context_free);
+    }
+
+    return ctx;
+}
+
 static GVariant *
 scan_networks_build_result (GList *info_list)
 {
@@ -582,32 +644,227 @@ scan_networks_build_result (GList *info_list)
         g_variant_builder_close (&builder);
     }
 
-    return g_variant_ref (g_variant_builder_end (&builder));
+    return g_variant_ref_sink (g_variant_builder_end (&builder));
 }
 
 static void
-handle_scan_ready (MMIfaceModem3gpp *self,
-                   GAsyncResult *res,
-                   HandleScanContext *ctx)
+scan_emit_results (MMIfaceModem3gpp *self,
+                   GVariant *results,
+                   gboolean complete)
+{
+    MmGdbusModem3gpp *skeleton = NULL;
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_3GPP_DBUS_SKELETON, &skeleton,
+                  NULL);
+    if (!skeleton)
+        return;
+
+    mm_gdbus_modem3gpp_emit_scan_results (skeleton, results, complete);
+    g_object_unref (skeleton);
+}
+
+static void
+handle_scan_complete (HandleScanContext *ctx,
+                      GVariant *results,
+                      guint age)
+{
+    switch (ctx->request) {
+    case SCAN_REQUEST_SCAN:
+        mm_gdbus_modem3gpp_complete_scan (ctx->skeleton,
+                                          ctx->invocation,
+                                          results);
+        break;
+    case SCAN_REQUEST_SCAN_CACHED:
+        mm_gdbus_modem3gpp_complete_scan_cached (ctx->skeleton,
+                                                 ctx->invocation,
+                                                 results,
+                                                 age);
+        break;
+    case SCAN_REQUEST_BACKGROUND:
+        g_assert_not_reached ();
+    }
+}
+
+static void
+scan_complete (MMIfaceModem3gpp *self,
+               GList *networks,
+               const GError *error)
+{
+    ScanContext *ctx;
+    GVariant *result = NULL;
+    GList *waiting;
+    GList *l;
+
+    ctx = get_scan_context (self);
+    ctx->step = 0;
+
+    if (!error) {
+        result = scan_networks_build_result (networks);
+        scan_emit_results (self, result, TRUE);
+    } else
+        mm_dbg ("Couldn't scan networks: '%s'", error->message);
+
+    waiting = mm_scan_cache_complete (ctx->cache, result, g_get_monotonic_time ());
+    for (l = waiting; l; l = g_list_next (l)) {
+        HandleScanContext *handle_ctx = l->data;
+
+        if (error)
+            g_dbus_method_invocation_return_gerror (handle_ctx->invocation, error);
+        else
+            handle_scan_complete (handle_ctx, result, 0);
+        handle_scan_context_free (handle_ctx);
+    }
+    g_list_free (waiting);
+
+    if (result)
+        g_variant_unref (result);
+}
+
+static void
+scan_networks_ready (MMIfaceModem3gpp *self,
+                     GAsyncResult *res)
 {
     GError *error = NULL;
     GList *info_list;
 
     info_list = MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_finish (self, res, &error);
+    scan_complete (self, info_list, error);
+    mm_3gpp_network_info_list_free (info_list);
     if (error)
-        g_dbus_method_invocation_take_error (ctx->invocation, error);
-    else {
-        GVariant *dict_array;
+        g_error_free (error);
+}
 
-        dict_array = scan_networks_build_result (info_list);
-        mm_gdbus_modem3gpp_complete_scan (ctx->skeleton,
-                                          ctx->invocation,
-                                          dict_array);
-        g_variant_unref (dict_array);
+static void scan_networks_run_step (MMIfaceModem3gpp *self);
+
+static gboolean
+scan_networks_step_cb (MMIfaceModem3gpp *self)
+{
+    get_scan_context (self)->step_id = 0;
+    scan_networks_run_step (self);
+    return FALSE;
+}
+
+static void
+scan_networks_step_ready (MMIfaceModem3gpp *self,
+                          GAsyncResult *res)
+{
+    ScanContext *ctx;
+    GError *error = NULL;
+    GList *info_list;
+    gboolean more = FALSE;
+
+    ctx = get_scan_context (self);
+    info_list = MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_step_finish (self, res, &more, &error);
+    if (error) {
+        mm_dbg ("Couldn't scan networks (step %u): '%s'", ctx->step, error->message);
+
+        /* If nothing was found yet, try with a single full scan */
+        if (!ctx->networks &&
+            MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks &&
+            MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_finish) {
+            g_error_free (error);
+            MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks (
+                self,
+                (GAsyncReadyCallback)scan_networks_ready,
+                NULL);
+            return;
+        }
+
+        /* Otherwise, report what we have */
+        if (ctx->networks)
+            g_clear_error (&error);
+        more = FALSE;
+    }
+
+    /* Report the networks found in this step right away */
+    if (info_list) {
+        GVariant *partial;
+
+        partial = scan_networks_build_result (info_list);
+        scan_emit_results (self, partial, FALSE);
+        g_variant_unref (partial);
+        ctx->networks = g_list_concat (ctx->networks, info_list);
     }
 
+    if (more) {
+        ctx->step++;
+        /* Let any other pending work go first in background scans */
+        if (mm_scan_cache_is_background (ctx->cache))
+            ctx->step_id = g_idle_add_full (G_PRIORITY_LOW,
+                                            (GSourceFunc)scan_networks_step_cb,
+                                            self,
+                                            NULL);
+        else
+            scan_networks_run_step (self);
+        return;
+    }
+
+    info_list = ctx->networks;
+    ctx->networks = NULL;
+    scan_complete (self, info_list, error);
     mm_3gpp_network_info_list_free (info_list);
-    handle_scan_context_free (ctx);
+    if (error)
+        g_error_free (error);
+}
+
+static void
+scan_networks_run_step (MMIfaceModem3gpp *self)
+{
+    MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_step (
+        self,
+        get_scan_context (self)->step,
+        (GAsyncReadyCallback)scan_networks_step_ready,
+        NULL);
+}
+
+/* Asks for a scan on behalf of 'request' (a HandleScanContext, or NULL
+ * for background scans) */
+static void
+scan_start (MMIfaceModem3gpp *self,
+            gboolean background,
+            HandleScanContext *request)
+{
+    ScanContext *ctx;
+
+    ctx = get_scan_context (self);
+    switch (mm_scan_cache_start (ctx->cache, background, request)) {
+    case MM_SCAN_CACHE_START_NEW:
+        break;
+    case MM_SCAN_CACHE_START_PROMOTED:
+        /* Someone is waiting for the results, so stop yielding */
+        if (ctx->step_id) {
+            g_source_remove (ctx->step_id);
+            ctx->step_id = 0;
+            scan_networks_run_step (self);
+        }
+        return;
+    case MM_SCAN_CACHE_START_JOINED:
+        return;
+    }
+
+    ctx->step = 0;
+
+    /* Background scans go step by step when the modem supports it */
+    if (MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_step &&
+        MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_step_finish &&
+        (background ||
+         !MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks ||
+         !MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_finish)) {
+        scan_networks_run_step (self);
+        return;
+    }
+
+    MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks (
+        self,
+        (GAsyncReadyCallback)scan_networks_ready,
+        NULL);
+}
+
+static void
+scan_results_clear (MMIfaceModem3gpp *self)
+{
+    mm_scan_cache_clear (get_scan_context (self)->cache);
 }
 
 static void
@@ -625,8 +882,10 @@ handle_scan_auth_ready (MMBaseModem *self,
     }
 
     /* If scanning is not implemented, report an error */
-    if (!MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks ||
-        !MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_finish) {
+    if ((!MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks ||
+         !MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_finish) &&
+        (!MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_step ||
+         !MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_step_finish)) {
         g_dbus_method_invocation_return_error (ctx->invocation,
                                                MM_CORE_ERROR,
                                                MM_CORE_ERROR_UNSUPPORTED,
@@ -670,21 +929,48 @@ handle_scan_auth_ready (MMBaseModem *self,
     case MM_MODEM_STATE_REGISTERED:
     case MM_MODEM_STATE_DISCONNECTING:
     case MM_MODEM_STATE_CONNECTING:
-    case MM_MODEM_STATE_CONNECTED:
-        MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks (
-            MM_IFACE_MODEM_3GPP (self),
-            (GAsyncReadyCallback)handle_scan_ready,
-            ctx);
+    case MM_MODEM_STATE_CONNECTED: {
+        ScanContext *scan_ctx;
+
+        scan_ctx = get_scan_context (MM_IFACE_MODEM_3GPP (self));
+
+        if (ctx->request == SCAN_REQUEST_BACKGROUND) {
+            scan_start (MM_IFACE_MODEM_3GPP (self), TRUE, NULL);
+            mm_gdbus_modem3gpp_complete_start_background_scan (ctx->skeleton,
+                                                               ctx->invocation);
+            break;
+        }
+
+        /* Reply right away if the cached results are recent enough */
+        if (ctx->request == SCAN_REQUEST_SCAN_CACHED) {
+            GVariant *result;
+            guint age = 0;
+
+            result = mm_scan_cache_peek (scan_ctx->cache,
+                                         ctx->max_age,
+                                         g_get_monotonic_time (),
+                                         &age);
+            if (result) {
+                handle_scan_complete (ctx, result, age);
+                break;
+            }
+        }
+
+        /* Wait for the running scan, or launch a new one */
+        scan_start (MM_IFACE_MODEM_3GPP (self), FALSE, ctx);
         return;
     }
+    }
 
     handle_scan_context_free (ctx);
 }
 
-static gboolean
-handle_scan (MmGdbusModem3gpp *skeleton,
-             GDBusMethodInvocation *invocation,
-             MMIfaceModem3gpp *self)
+static void
+handle_scan_request (MmGdbusModem3gpp *skeleton,
+                     GDBusMethodInvocation *invocation,
+                     MMIfaceModem3gpp *self,
+                     ScanRequest request,
+                     guint max_age)
 {
     HandleScanContext *ctx;
 
@@ -692,15 +978,43 @@ handle_scan (MmGdbusModem3gpp *skeleton,
     ctx->skeleton = g_object_ref (skeleton);
     ctx->invocation = g_object_ref (invocation);
     ctx->self = g_object_ref (self);
+    ctx->request = request;
+    ctx->max_age = max_age;
 
     mm_base_modem_authorize (MM_BASE_MODEM (self),
                              invocation,
                              MM_AUTHORIZATION_DEVICE_CONTROL,
                              (GAsyncReadyCallback)handle_scan_auth_ready,
                              ctx);
+}
+
+static gboolean
+handle_scan (MmGdbusModem3gpp *skeleton,
+             GDBusMethodInvocation *invocation,
+             MMIfaceModem3gpp *self)
+{
+    handle_scan_request (skeleton, invocation, self, SCAN_REQUEST_SCAN, 0);
+    return TRUE;
+}
+
+static gboolean
+handle_scan_cached (MmGdbusModem3gpp *skeleton,
+                    GDBusMethodInvocation *invocation,
+                    guint max_age,
+                    MMIfaceModem3gpp *self)
+{
+    handle_scan_request (skeleton, invocation, self, SCAN_REQUEST_SCAN_CACHED, max_age);
     return TRUE;
 }
 
+static gboolean
+handle_start_background_scan (MmGdbusModem3gpp *skeleton,
+                              GDBusMethodInvocation *invocation,
+                              MMIfaceModem3gpp *self)
+{
+    handle_scan_request (skeleton, invocation, self, SCAN_REQUEST_BACKGROUND, 0);
+    return TRUE;
+}
 /*****************************************************************************/
 
 gboolean
@@ -1128,7 +1442,7 @@ static void
 registration_check_context_free (RegistrationCheckContext *ctx)
 {
     if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+        mm_timer_wheel_remove (ctx->timeout_source);
     g_free (ctx);
 }
 
@@ -1201,9 +1515,10 @@ periodic_registration_check_enable (MMIfaceModem3gpp *self)
     /* Create context and keep it as object data */
     mm_dbg ("Periodic 3GPP registration checks enabled");
     ctx = g_new0 (RegistrationCheckContext, 1);
-    ctx->timeout_source = g_timeout_add_seconds (REGISTRATION_CHECK_TIMEOUT_SEC,
-                                                 (GSourceFunc)periodic_registration_check,
-                                                 self);
+    ctx->timeout_source = mm_timer_wheel_add_seconds (REGISTRATION_CHECK_TIMEOUT_SEC,
+                                                      MM_TIMER_WHEEL_PERIODIC_COALESCE_SEC,
+                                                      (GSourceFunc)periodic_registration_check,
+                                                      self);
     g_object_set_qdata_full (G_OBJECT (self),
                              registration_check_context_quark,
                              ctx,
@@ -1223,6 +1538,7 @@ typedef enum {
     DISABLING_STEP_CLEANUP_UNSOLICITED_EVENTS,
     DISABLING_STEP_DISABLE_UNSOLICITED_EVENTS,
     DISABLING_STEP_REGISTRATION_STATE,
+    DISABLING_STEP_SCAN_RESULTS,
     DISABLING_STEP_LAST
 } DisablingStep;
 
@@ -1360,6 +1676,12 @@ interface_disabling_step (DisablingContext *ctx)
         /* Fall down to next step */
         ctx->step++;
 
+    case DISABLING_STEP_SCAN_RESULTS:
+        /* Networks found while enabled may be gone by the next enabling */
+        scan_results_clear (ctx->self);
+        /* Fall down to next step */
+        ctx->step++;
+
     case DISABLING_STEP_LAST:
         /* We are done without errors! */
         g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
@@ -1857,6 +2179,14 @@ interface_initialization_step (InitializationContext *ctx)
                           "handle-scan",
                           G_CALLBACK (handle_scan),
                           ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-scan-cached",
+                          G_CALLBACK (handle_scan_cached),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-start-background-scan",
+                          G_CALLBACK (handle_start_background_scan),
+                          ctx->self);
 
 
         /* Finally, export the new interface */
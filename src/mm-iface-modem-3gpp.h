@@ -178,6 +178,19 @@ struct _MMIfaceModem3gpp {
     GList * (*scan_networks_finish) (MMIfaceModem3gpp *self,
                                      GAsyncResult *res,
                                      GError **error);
+
+    /* Scan networks in several shorter steps (e.g. one per access
+     * technology), used for background scans. Expect a GList of
+     * MMModem3gppNetworkInfo with the networks found in the given step, and
+     * 'more' set if there are steps left */
+    void (* scan_networks_step) (MMIfaceModem3gpp *self,
+                                 guint step,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data);
+    GList * (*scan_networks_step_finish) (MMIfaceModem3gpp *self,
+                                          GAsyncResult *res,
+                                          gboolean *more,
+                                          GError **error);
 };
 
 GType mm_iface_modem_3gpp_get_type (void);
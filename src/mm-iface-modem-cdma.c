@@ -24,6 +24,7 @@
 #include "mm-base-modem.h"
 #include "mm-modem-helpers.h"
 #include "mm-log.h"
+#include "mm-timer-wheel.h"
 
 #define REGISTRATION_CHECK_TIMEOUT_SEC 30
 
@@ -1092,7 +1093,7 @@ static void
 registration_check_context_free (RegistrationCheckContext *ctx)
 {
     if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+        mm_timer_wheel_remove (ctx->timeout_source);
     g_free (ctx);
 }
 
@@ -1165,9 +1166,10 @@ periodic_registration_check_enable (MMIfaceModemCdma *self)
     /* Create context and keep it as object data */
     mm_dbg ("Periodic CDMA registration checks enabled");
     ctx = g_new0 (RegistrationCheckContext, 1);
-    ctx->timeout_source = g_timeout_add_seconds (REGISTRATION_CHECK_TIMEOUT_SEC,
-                                                 (GSourceFunc)periodic_registration_check,
-                                                 self);
+    ctx->timeout_source = mm_timer_wheel_add_seconds (REGISTRATION_CHECK_TIMEOUT_SEC,
+                                                      MM_TIMER_WHEEL_PERIODIC_COALESCE_SEC,
+                                                      (GSourceFunc)periodic_registration_check,
+                                                      self);
     g_object_set_qdata_full (G_OBJECT (self),
                              registration_check_context_quark,
                              ctx,
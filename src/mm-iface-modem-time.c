@@ -384,6 +384,27 @@ mm_iface_modem_time_update_network_time (MMIfaceModemTime *self,
     g_object_unref (skeleton);
 }
 
+void
+mm_iface_modem_time_update_network_timezone (MMIfaceModemTime *self,
+                                             MMNetworkTimezone *tz)
+{
+    GCancellable *cancellable = NULL;
+
+    update_network_timezone_dictionary (self, tz);
+
+    /* Reported by the modem itself, so no need to keep on polling */
+    if (G_LIKELY (network_timezone_cancellable_quark))
+        cancellable = g_object_get_qdata (G_OBJECT (self),
+                                          network_timezone_cancellable_quark);
+    if (cancellable) {
+        mm_dbg ("Network timezone reported, stopping network timezone polling");
+        g_cancellable_cancel (cancellable);
+        g_object_set_qdata (G_OBJECT (self),
+                            network_timezone_cancellable_quark,
+                            NULL);
+    }
+}
+
 /*****************************************************************************/
 
 typedef struct _DisablingContext DisablingContext;
@@ -561,9 +582,9 @@ static void interface_enabling_step (EnablingContext *ctx);
 
 typedef enum {
     ENABLING_STEP_FIRST,
-    ENABLING_STEP_SETUP_NETWORK_TIMEZONE_RETRIEVAL,
     ENABLING_STEP_SETUP_UNSOLICITED_EVENTS,
     ENABLING_STEP_ENABLE_UNSOLICITED_EVENTS,
+    ENABLING_STEP_SETUP_NETWORK_TIMEZONE_RETRIEVAL,
     ENABLING_STEP_LAST
 } EnablingStep;
 
@@ -573,6 +594,7 @@ struct _EnablingContext {
     GSimpleAsyncResult *result;
     GCancellable *cancellable;
     MmGdbusModemTime *skeleton;
+    gboolean unsolicited_events_enabled;
 };
 
 static void
@@ -618,7 +640,10 @@ update_network_timezone_ready (MMIfaceModemTime *self,
     if (!update_network_timezone_finish (self, res, &error)) {
         if (!g_error_matches (error,
                               MM_CORE_ERROR,
-                              MM_CORE_ERROR_UNSUPPORTED))
+                              MM_CORE_ERROR_UNSUPPORTED) &&
+            !g_error_matches (error,
+                              MM_CORE_ERROR,
+                              MM_CORE_ERROR_CANCELLED))
             mm_dbg ("Couldn't update network timezone: '%s'", error->message);
         g_error_free (error);
     }
@@ -659,7 +684,8 @@ enable_unsolicited_events_ready (MMIfaceModemTime *self,
     if (!MM_IFACE_MODEM_TIME_GET_INTERFACE (self)->enable_unsolicited_events_finish (self, res, &error)) {
         mm_dbg ("Couldn't enable unsolicited events: '%s'", error->message);
         g_error_free (error);
-    }
+    } else
+        ctx->unsolicited_events_enabled = TRUE;
 
     /* Go on with next step */
     ctx->step++;
@@ -678,32 +704,6 @@ interface_enabling_step (EnablingContext *ctx)
         /* Fall down to next step */
         ctx->step++;
 
-    case ENABLING_STEP_SETUP_NETWORK_TIMEZONE_RETRIEVAL: {
-        GCancellable *cancellable;
-
-        /* We'll create a cancellable which is valid as long as we're updating
-         * network timezone, and we set it as context */
-        cancellable = g_cancellable_new ();
-        if (G_UNLIKELY (!network_timezone_cancellable_quark))
-            network_timezone_cancellable_quark = (g_quark_from_static_string (
-                                                      NETWORK_TIMEZONE_CANCELLABLE_TAG));
-        g_object_set_qdata_full (G_OBJECT (ctx->self),
-                                 network_timezone_cancellable_quark,
-                                 cancellable,
-                                 (GDestroyNotify)g_object_unref);
-
-        update_network_timezone (ctx->self,
-                                 cancellable,
-                                 (GAsyncReadyCallback)update_network_timezone_ready,
-                                 NULL);
-
-        /* NOTE!!!! We'll leave the timezone network update operation
-         * running, we don't wait for it to finish */
-
-        /* Fall down to next step */
-        ctx->step++;
-    }
-
     case ENABLING_STEP_SETUP_UNSOLICITED_EVENTS:
         /* Allow setting up unsolicited events */
         if (MM_IFACE_MODEM_TIME_GET_INTERFACE (ctx->self)->setup_unsolicited_events &&
@@ -730,6 +730,37 @@ interface_enabling_step (EnablingContext *ctx)
         /* Fall down to next step */
         ctx->step++;
 
+    case ENABLING_STEP_SETUP_NETWORK_TIMEZONE_RETRIEVAL:
+        /* Modems reporting the network timezone with unsolicited events
+         * don't need to be polled for it */
+        if (ctx->unsolicited_events_enabled)
+            mm_dbg ("Network timezone reported by the modem, not polling");
+        else {
+            GCancellable *cancellable;
+
+            /* We'll create a cancellable which is valid as long as we're updating
+             * network timezone, and we set it as context */
+            cancellable = g_cancellable_new ();
+            if (G_UNLIKELY (!network_timezone_cancellable_quark))
+                network_timezone_cancellable_quark = (g_quark_from_static_string (
+                                                          NETWORK_TIMEZONE_CANCELLABLE_TAG));
+            g_object_set_qdata_full (G_OBJECT (ctx->self),
+                                     network_timezone_cancellable_quark,
+                                     cancellable,
+                                     (GDestroyNotify)g_object_unref);
+
+            update_network_timezone (ctx->self,
+                                     cancellable,
+                                     (GAsyncReadyCallback)update_network_timezone_ready,
+                                     NULL);
+
+            /* NOTE!!!! We'll leave the timezone network update operation
+             * running, we don't wait for it to finish */
+        }
+
+        /* Fall down to next step */
+        ctx->step++;
+
     case ENABLING_STEP_LAST:
         /* We are done without errors! */
         g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
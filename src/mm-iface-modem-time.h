@@ -73,7 +73,9 @@ struct _MMIfaceModemTime {
                                                    GAsyncResult *res,
                                                    GError **error);
 
-    /* Asynchronous enabling unsolicited events */
+    /* Asynchronous enabling unsolicited events. If these report network
+     * timezone changes, the network timezone isn't polled after enabling
+     * succeeds. */
     void (* enable_unsolicited_events) (MMIfaceModemTime *self,
                                         GAsyncReadyCallback callback,
                                         gpointer user_data);
@@ -130,4 +132,9 @@ void mm_iface_modem_time_bind_simple_status (MMIfaceModemTime *self,
 void mm_iface_modem_time_update_network_time (MMIfaceModemTime *self,
                                               const gchar *network_time);
 
+/* Implementations of the unsolicited events handling should call this method
+ * to notify about the updated timezone; polling stops if running */
+void mm_iface_modem_time_update_network_timezone (MMIfaceModemTime *self,
+                                                  MMNetworkTimezone *tz);
+
 #endif /* MM_IFACE_MODEM_TIME_H */
@@ -25,6 +25,7 @@
 #include "mm-sim.h"
 #include "mm-bearer-list.h"
 #include "mm-log.h"
+#include "mm-timer-wheel.h"
 #include "mm-context.h"
 
 #define SIGNAL_QUALITY_RECENT_TIMEOUT_SEC        60
@@ -740,7 +741,7 @@ static void
 access_technologies_check_context_free (AccessTechnologiesCheckContext *ctx)
 {
     if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+        mm_timer_wheel_remove (ctx->timeout_source);
     g_free (ctx);
 }
 
@@ -839,9 +840,10 @@ periodic_access_technologies_check_enable (MMIfaceModem *self)
     /* Create context and keep it as object data */
     mm_dbg ("Periodic access technology checks enabled");
     ctx = g_new0 (AccessTechnologiesCheckContext, 1);
-    ctx->timeout_source = g_timeout_add_seconds (ACCESS_TECHNOLOGIES_CHECK_TIMEOUT_SEC,
-                                                 (GSourceFunc)periodic_access_technologies_check,
-                                                 self);
+    ctx->timeout_source = mm_timer_wheel_add_seconds (ACCESS_TECHNOLOGIES_CHECK_TIMEOUT_SEC,
+                                                      MM_TIMER_WHEEL_PERIODIC_COALESCE_SEC,
+                                                      (GSourceFunc)periodic_access_technologies_check,
+                                                      self);
     g_object_set_qdata_full (G_OBJECT (self),
                              access_technologies_check_context_quark,
                              ctx,
@@ -862,7 +864,7 @@ static void
 signal_quality_update_context_free (SignalQualityUpdateContext *ctx)
 {
     if (ctx->recent_timeout_source)
-        g_source_remove (ctx->recent_timeout_source);
+        mm_timer_wheel_remove (ctx->recent_timeout_source);
     g_free (ctx);
 }
 
@@ -973,14 +975,15 @@ update_signal_quality (MMIfaceModem *self,
 
     /* Remove any previous expiration refresh timeout */
     if (ctx->recent_timeout_source) {
-        g_source_remove (ctx->recent_timeout_source);
+        mm_timer_wheel_remove (ctx->recent_timeout_source);
         ctx->recent_timeout_source = 0;
     }
 
     /* If we got a new expirable value, setup new timeout */
     if (expire)
-        ctx->recent_timeout_source = (g_timeout_add_seconds (
+        ctx->recent_timeout_source = (mm_timer_wheel_add_seconds (
                                           SIGNAL_QUALITY_RECENT_TIMEOUT_SEC,
+                                          MM_TIMER_WHEEL_PERIODIC_COALESCE_SEC,
                                           (GSourceFunc)expire_signal_quality,
                                           self));
 
@@ -1007,7 +1010,7 @@ static void
 signal_quality_check_context_free (SignalQualityCheckContext *ctx)
 {
     if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+        mm_timer_wheel_remove (ctx->timeout_source);
     g_free (ctx);
 }
 
@@ -1040,10 +1043,11 @@ signal_quality_check_ready (MMIfaceModem *self,
             ctx->interval = SIGNAL_QUALITY_CHECK_TIMEOUT_SEC;
             if (ctx->timeout_source) {
                 mm_dbg ("Periodic signal quality checks rescheduled (interval = %ds)", ctx->interval);
-                g_source_remove(ctx->timeout_source);
-                ctx->timeout_source = g_timeout_add_seconds (ctx->interval,
-                                                             (GSourceFunc)periodic_signal_quality_check,
-                                                             self);
+                mm_timer_wheel_remove (ctx->timeout_source);
+                ctx->timeout_source = mm_timer_wheel_add_seconds (ctx->interval,
+                                                                  MM_TIMER_WHEEL_PERIODIC_COALESCE_SEC,
+                                                                  (GSourceFunc)periodic_signal_quality_check,
+                                                                  self);
             }
         }
         ctx->running = FALSE;
@@ -1121,9 +1125,10 @@ periodic_signal_quality_check_enable (MMIfaceModem *self)
     ctx->interval = SIGNAL_QUALITY_INITIAL_CHECK_TIMEOUT_SEC;
     ctx->initial_retries = 5;
     mm_dbg ("Periodic signal quality checks enabled (interval = %ds)", ctx->interval);
-    ctx->timeout_source = g_timeout_add_seconds (ctx->interval,
-                                                 (GSourceFunc)periodic_signal_quality_check,
-                                                 self);
+    ctx->timeout_source = mm_timer_wheel_add_seconds (ctx->interval,
+                                                      MM_TIMER_WHEEL_COALESCE_NONE,
+                                                      (GSourceFunc)periodic_signal_quality_check,
+                                                      self);
     g_object_set_qdata_full (G_OBJECT (self),
                              signal_quality_check_context_quark,
                              ctx,
@@ -3390,10 +3395,9 @@ mm_iface_modem_enable (MMIfaceModem *self,
 /* MODEM INITIALIZATION */
 
 typedef struct _InitializationContext InitializationContext;
-static void interface_initialization_step (InitializationContext *ctx);
 
+/* Independent loaders run concurrently, see initialization_steps[] */
 typedef enum {
-    INITIALIZATION_STEP_FIRST,
     INITIALIZATION_STEP_CURRENT_CAPABILITIES,
     INITIALIZATION_STEP_MODEM_CAPABILITIES,
     INITIALIZATION_STEP_BEARERS,
@@ -3407,13 +3411,12 @@ typedef enum {
     INITIALIZATION_STEP_POWER_STATE,
     INITIALIZATION_STEP_UNLOCK_REQUIRED,
     INITIALIZATION_STEP_SIM,
-    INITIALIZATION_STEP_OWN_NUMBERS,
-    INITIALIZATION_STEP_LAST
+    INITIALIZATION_STEP_OWN_NUMBERS
 } InitializationStep;
 
 struct _InitializationContext {
     MMIfaceModem *self;
-    InitializationStep step;
+    MMStepScheduler *scheduler;
     GSimpleAsyncResult *result;
     GCancellable *cancellable;
     MmGdbusModem *skeleton;
@@ -3425,6 +3428,7 @@ initialization_context_complete_and_free (InitializationContext *ctx)
 {
     g_assert (ctx->fatal_error == NULL);
     g_simple_async_result_complete_in_idle (ctx->result);
+    mm_step_scheduler_free (ctx->scheduler);
     g_object_unref (ctx->cancellable);
     g_object_unref (ctx->self);
     g_object_unref (ctx->result);
@@ -3432,22 +3436,20 @@ initialization_context_complete_and_free (InitializationContext *ctx)
     g_free (ctx);
 }
 
-static gboolean
-initialization_context_complete_and_free_if_cancelled (InitializationContext *ctx)
+/* Stops launching new steps; loaders already running still finish */
+static void
+initialization_context_set_fatal_error (InitializationContext *ctx,
+                                        GError *error)
 {
-    if (!g_cancellable_is_cancelled (ctx->cancellable))
-        return FALSE;
-
-    g_simple_async_result_set_error (ctx->result,
-                                     MM_CORE_ERROR,
-                                     MM_CORE_ERROR_CANCELLED,
-                                     "Interface initialization cancelled");
-    initialization_context_complete_and_free (ctx);
-    return TRUE;
+    if (!ctx->fatal_error)
+        ctx->fatal_error = error;
+    else
+        g_error_free (error);
+    mm_step_scheduler_abort (ctx->scheduler);
 }
 
 #undef STR_REPLY_READY_FN
-#define STR_REPLY_READY_FN(NAME,DISPLAY)                                \
+#define STR_REPLY_READY_FN(NAME,DISPLAY,STEP)                           \
     static void                                                         \
     load_##NAME##_ready (MMIfaceModem *self,                            \
                          GAsyncResult *res,                             \
@@ -3465,13 +3467,11 @@ initialization_context_complete_and_free_if_cancelled (InitializationContext *ct
             g_error_free (error);                                       \
         }                                                               \
                                                                         \
-        /* Go on to next step */                                        \
-        ctx->step++;                                                    \
-        interface_initialization_step (ctx);                            \
+        mm_step_scheduler_step_done (ctx->scheduler, STEP);             \
     }
 
 #undef UINT_REPLY_READY_FN
-#define UINT_REPLY_READY_FN(NAME,DISPLAY,FATAL)                         \
+#define UINT_REPLY_READY_FN(NAME,DISPLAY,FATAL,STEP)                    \
     static void                                                         \
     load_##NAME##_ready (MMIfaceModem *self,                            \
                          GAsyncResult *res,                             \
@@ -3485,31 +3485,24 @@ initialization_context_complete_and_free_if_cancelled (InitializationContext *ct
                                                                         \
         if (error) {                                                    \
             if (FATAL) {                                                \
-                g_propagate_error (&ctx->fatal_error, error);           \
-                g_prefix_error (&ctx->fatal_error, "couldn't load %s: ", DISPLAY); \
-                /* Jump to the last step */                             \
-                ctx->step = INITIALIZATION_STEP_LAST;                   \
+                g_prefix_error (&error, "couldn't load %s: ", DISPLAY); \
+                initialization_context_set_fatal_error (ctx, error);    \
             } else {                                                    \
                 mm_warn ("couldn't load %s: '%s'", DISPLAY, error->message); \
                 g_error_free (error);                                   \
-                /* Go on to next step */                                \
-                ctx->step++;                                            \
             }                                                           \
-        } else {                                                        \
-            /* Go on to next step */                                    \
-            ctx->step++;                                                \
         }                                                               \
                                                                         \
-        interface_initialization_step (ctx);                            \
+        mm_step_scheduler_step_done (ctx->scheduler, STEP);             \
     }
 
-UINT_REPLY_READY_FN (current_capabilities, "Current Capabilities", TRUE)
-UINT_REPLY_READY_FN (modem_capabilities, "Modem Capabilities", FALSE)
-STR_REPLY_READY_FN (manufacturer, "Manufacturer")
-STR_REPLY_READY_FN (model, "Model")
-STR_REPLY_READY_FN (revision, "Revision")
-STR_REPLY_READY_FN (equipment_identifier, "Equipment Identifier")
-STR_REPLY_READY_FN (device_identifier, "Device Identifier")
+UINT_REPLY_READY_FN (current_capabilities, "Current Capabilities", TRUE, INITIALIZATION_STEP_CURRENT_CAPABILITIES)
+UINT_REPLY_READY_FN (modem_capabilities, "Modem Capabilities", FALSE, INITIALIZATION_STEP_MODEM_CAPABILITIES)
+STR_REPLY_READY_FN (manufacturer, "Manufacturer", INITIALIZATION_STEP_MANUFACTURER)
+STR_REPLY_READY_FN (model, "Model", INITIALIZATION_STEP_MODEL)
+STR_REPLY_READY_FN (revision, "Revision", INITIALIZATION_STEP_REVISION)
+STR_REPLY_READY_FN (equipment_identifier, "Equipment Identifier", INITIALIZATION_STEP_EQUIPMENT_ID)
+STR_REPLY_READY_FN (device_identifier, "Device Identifier", INITIALIZATION_STEP_DEVICE_ID)
 
 static void
 load_own_numbers_ready (MMIfaceModem *self,
@@ -3530,9 +3523,7 @@ load_own_numbers_ready (MMIfaceModem *self,
         g_strfreev (str_list);
     }
 
-    /* Go on to next step */
-    ctx->step++;
-    interface_initialization_step (ctx);
+    mm_step_scheduler_step_done (ctx->scheduler, INITIALIZATION_STEP_OWN_NUMBERS);
 }
 
 static void
@@ -3555,9 +3546,7 @@ load_supported_modes_ready (MMIfaceModem *self,
         g_error_free (error);
     }
 
-    /* Go on to next step */
-    ctx->step++;
-    interface_initialization_step (ctx);
+    mm_step_scheduler_step_done (ctx->scheduler, INITIALIZATION_STEP_SUPPORTED_MODES);
 }
 
 static void
@@ -3581,30 +3570,26 @@ load_supported_bands_ready (MMIfaceModem *self,
         g_error_free (error);
     }
 
-    /* Go on to next step */
-    ctx->step++;
-    interface_initialization_step (ctx);
+    mm_step_scheduler_step_done (ctx->scheduler, INITIALIZATION_STEP_SUPPORTED_BANDS);
 }
 
-UINT_REPLY_READY_FN (power_state, "Power State", FALSE)
+UINT_REPLY_READY_FN (power_state, "Power State", FALSE, INITIALIZATION_STEP_POWER_STATE)
 
 static void
 modem_update_lock_info_ready (MMIfaceModem *self,
                               GAsyncResult *res,
                               InitializationContext *ctx)
 {
+    GError *error = NULL;
+
     /* NOTE: we already propagated the lock state, no need to do it again */
-    mm_iface_modem_update_lock_info_finish (self, res, &ctx->fatal_error);
-    if (ctx->fatal_error) {
-        g_prefix_error (&ctx->fatal_error,
-                        "Couldn't check unlock status: ");
-        /* Jump to the last step */
-        ctx->step = INITIALIZATION_STEP_LAST;
-    } else
-        /* Go on to next step */
-        ctx->step++;
+    mm_iface_modem_update_lock_info_finish (self, res, &error);
+    if (error) {
+        g_prefix_error (&error, "Couldn't check unlock status: ");
+        initialization_context_set_fatal_error (ctx, error);
+    }
 
-    interface_initialization_step (ctx);
+    mm_step_scheduler_step_done (ctx->scheduler, INITIALIZATION_STEP_UNLOCK_REQUIRED);
 }
 
 static void
@@ -3618,8 +3603,8 @@ sim_new_ready (GAsyncInitable *initable,
     sim = MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->create_sim_finish (ctx->self, res, &error);
     if (error) {
         mm_warn ("couldn't create SIM: '%s'", error->message);
-        g_simple_async_result_take_error (ctx->result, error);
-        initialization_context_complete_and_free (ctx);
+        initialization_context_set_fatal_error (ctx, error);
+        mm_step_scheduler_step_done (ctx->scheduler, INITIALIZATION_STEP_SIM);
         return;
     }
 
@@ -3636,9 +3621,7 @@ sim_new_ready (GAsyncInitable *initable,
         g_object_unref (sim);
     }
 
-    /* Go on to next step */
-    ctx->step++;
-    interface_initialization_step (ctx);
+    mm_step_scheduler_step_done (ctx->scheduler, INITIALIZATION_STEP_SIM);
 }
 
 static void
@@ -3654,410 +3637,433 @@ sim_reinit_ready (MMSim *sim,
         g_clear_error (&error);
     }
 
-    /* Go on to next step */
-    ctx->step++;
-    interface_initialization_step (ctx);
+    mm_step_scheduler_step_done (ctx->scheduler, INITIALIZATION_STEP_SIM);
 }
 
 static void
-interface_initialization_step (InitializationContext *ctx)
+initialization_load_port_info (InitializationContext *ctx)
 {
-    /* Don't run new steps if we're cancelled */
-    if (initialization_context_complete_and_free_if_cancelled (ctx))
-        return;
+    /* Load device if not done before */
+    if (!mm_gdbus_modem_get_device (ctx->skeleton)) {
+        gchar *device;
 
-    switch (ctx->step) {
-    case INITIALIZATION_STEP_FIRST:
-        /* Load device if not done before */
-        if (!mm_gdbus_modem_get_device (ctx->skeleton)) {
-            gchar *device;
-
-            g_object_get (ctx->self,
-                          MM_BASE_MODEM_DEVICE, &device,
-                          NULL);
-            mm_gdbus_modem_set_device (ctx->skeleton, device);
-            g_free (device);
-        }
-        /* Load driver if not done before */
-        if (!mm_gdbus_modem_get_drivers (ctx->skeleton)) {
-            gchar **drivers;
-
-            g_object_get (ctx->self,
-                          MM_BASE_MODEM_DRIVERS, &drivers,
-                          NULL);
-            mm_gdbus_modem_set_drivers (ctx->skeleton, (const gchar * const *)drivers);
-            g_strfreev (drivers);
-        }
-        /* Load plugin if not done before */
-        if (!mm_gdbus_modem_get_plugin (ctx->skeleton)) {
-            gchar *plugin;
-
-            g_object_get (ctx->self,
-                          MM_BASE_MODEM_PLUGIN, &plugin,
-                          NULL);
-            mm_gdbus_modem_set_plugin (ctx->skeleton, plugin);
-            g_free (plugin);
-        }
-        /* Load primary port if not done before */
-        if (!mm_gdbus_modem_get_primary_port (ctx->skeleton)) {
-            MMPort *primary;
+        g_object_get (ctx->self,
+                      MM_BASE_MODEM_DEVICE, &device,
+                      NULL);
+        mm_gdbus_modem_set_device (ctx->skeleton, device);
+        g_free (device);
+    }
+    /* Load driver if not done before */
+    if (!mm_gdbus_modem_get_drivers (ctx->skeleton)) {
+        gchar **drivers;
+
+        g_object_get (ctx->self,
+                      MM_BASE_MODEM_DRIVERS, &drivers,
+                      NULL);
+        mm_gdbus_modem_set_drivers (ctx->skeleton, (const gchar * const *)drivers);
+        g_strfreev (drivers);
+    }
+    /* Load plugin if not done before */
+    if (!mm_gdbus_modem_get_plugin (ctx->skeleton)) {
+        gchar *plugin;
+
+        g_object_get (ctx->self,
+                      MM_BASE_MODEM_PLUGIN, &plugin,
+                      NULL);
+        mm_gdbus_modem_set_plugin (ctx->skeleton, plugin);
+        g_free (plugin);
+    }
+    /* Load primary port if not done before */
+    if (!mm_gdbus_modem_get_primary_port (ctx->skeleton)) {
+        MMPort *primary;
 
 #if defined WITH_QMI
-            primary = MM_PORT (mm_base_modem_peek_port_qmi (MM_BASE_MODEM (ctx->self)));
-            if (!primary)
-                primary = MM_PORT (mm_base_modem_peek_port_primary (MM_BASE_MODEM (ctx->self)));
-#else
+        primary = MM_PORT (mm_base_modem_peek_port_qmi (MM_BASE_MODEM (ctx->self)));
+        if (!primary)
             primary = MM_PORT (mm_base_modem_peek_port_primary (MM_BASE_MODEM (ctx->self)));
+#else
+        primary = MM_PORT (mm_base_modem_peek_port_primary (MM_BASE_MODEM (ctx->self)));
 #endif
 
-            g_assert (primary != NULL);
-            mm_gdbus_modem_set_primary_port (ctx->skeleton, mm_port_get_device (primary));
-        }
-        /* Fall down to next step */
-        ctx->step++;
+        g_assert (primary != NULL);
+        mm_gdbus_modem_set_primary_port (ctx->skeleton, mm_port_get_device (primary));
+    }
+}
 
-    case INITIALIZATION_STEP_CURRENT_CAPABILITIES:
-        /* Current capabilities may change during runtime, i.e. if new firmware reloaded; but we'll
-         * try to handle that by making sure the capabilities are cleared when the new firmware is
-         * reloaded. So if we're asked to re-initialize, if we already have current capabilities loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_current_capabilities (ctx->skeleton) == MM_MODEM_CAPABILITY_NONE &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_current_capabilities &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_current_capabilities_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_current_capabilities (
-                ctx->self,
-                (GAsyncReadyCallback)load_current_capabilities_ready,
-                ctx);
-            return;
-        }
-        /* Fall down to next step */
-        ctx->step++;
+static void
+initialization_step_current_capabilities (MMStepScheduler *scheduler,
+                                          guint step,
+                                          InitializationContext *ctx)
+{
+    /* Current capabilities may change during runtime, i.e. if new firmware reloaded; but we'll
+     * try to handle that by making sure the capabilities are cleared when the new firmware is
+     * reloaded. So if we're asked to re-initialize, if we already have current capabilities loaded,
+     * don't try to load them again. */
+    if (mm_gdbus_modem_get_current_capabilities (ctx->skeleton) == MM_MODEM_CAPABILITY_NONE &&
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_current_capabilities &&
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_current_capabilities_finish) {
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_current_capabilities (
+            ctx->self,
+            (GAsyncReadyCallback)load_current_capabilities_ready,
+            ctx);
+        return;
+    }
 
-    case INITIALIZATION_STEP_MODEM_CAPABILITIES:
-        /* Modem capabilities are meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_modem_capabilities (ctx->skeleton) == MM_MODEM_CAPABILITY_NONE &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_modem_capabilities &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_modem_capabilities_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_modem_capabilities (
-                ctx->self,
-                (GAsyncReadyCallback)load_modem_capabilities_ready,
-                ctx);
-            return;
-        }
-       /* If no specific way of getting modem capabilities, assume they are
-        * equal to the current capabilities */
-        mm_gdbus_modem_set_modem_capabilities (
-            ctx->skeleton,
-            mm_gdbus_modem_get_current_capabilities (ctx->skeleton));
-        /* Fall down to next step */
-        ctx->step++;
+    mm_step_scheduler_step_done (scheduler, step);
+}
+
+static void
+initialization_step_modem_capabilities (MMStepScheduler *scheduler,
+                                        guint step,
+                                        InitializationContext *ctx)
+{
+    /* Modem capabilities are meant to be loaded only once during the whole
+     * lifetime of the modem. Therefore, if we already have them loaded,
+     * don't try to load them again. */
+    if (mm_gdbus_modem_get_modem_capabilities (ctx->skeleton) == MM_MODEM_CAPABILITY_NONE &&
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_modem_capabilities &&
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_modem_capabilities_finish) {
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_modem_capabilities (
+            ctx->self,
+            (GAsyncReadyCallback)load_modem_capabilities_ready,
+            ctx);
+        return;
+    }
 
-    case INITIALIZATION_STEP_BEARERS: {
-        MMBearerList *list = NULL;
+    /* If no specific way of getting modem capabilities, assume they are
+     * equal to the current capabilities */
+    mm_gdbus_modem_set_modem_capabilities (
+        ctx->skeleton,
+        mm_gdbus_modem_get_current_capabilities (ctx->skeleton));
+    mm_step_scheduler_step_done (scheduler, step);
+}
 
-        /* Bearers setup is meant to be loaded only once during the whole
-         * lifetime of the modem. The list may have been created by the object
-         * implementing the interface; if so use it. */
-        g_object_get (ctx->self,
-                      MM_IFACE_MODEM_BEARER_LIST, &list,
+static void
+initialization_step_bearers (MMStepScheduler *scheduler,
+                             guint step,
+                             InitializationContext *ctx)
+{
+    MMBearerList *list = NULL;
+
+    /* Bearers setup is meant to be loaded only once during the whole
+     * lifetime of the modem. The list may have been created by the object
+     * implementing the interface; if so use it. */
+    g_object_get (ctx->self,
+                  MM_IFACE_MODEM_BEARER_LIST, &list,
+                  NULL);
+
+    if (!list) {
+        guint n;
+
+        /* The maximum number of available/connected modems is guessed from
+         * the size of the data ports list. */
+        n = g_list_length (mm_base_modem_peek_data_ports (MM_BASE_MODEM (ctx->self)));
+        mm_dbg ("Modem allows up to %u bearers", n);
+
+        /* Create new default list */
+        list = mm_bearer_list_new (n, n);
+        g_object_set (ctx->self,
+                      MM_IFACE_MODEM_BEARER_LIST, list,
                       NULL);
+    }
 
-        if (!list) {
-            guint n;
+    if (mm_gdbus_modem_get_max_bearers (ctx->skeleton) == 0)
+        mm_gdbus_modem_set_max_bearers (
+            ctx->skeleton,
+            mm_bearer_list_get_max (list));
+    if (mm_gdbus_modem_get_max_active_bearers (ctx->skeleton) == 0)
+        mm_gdbus_modem_set_max_active_bearers (
+            ctx->skeleton,
+            mm_bearer_list_get_max_active (list));
+    g_object_unref (list);
 
-            /* The maximum number of available/connected modems is guessed from
-             * the size of the data ports list. */
-            n = g_list_length (mm_base_modem_peek_data_ports (MM_BASE_MODEM (ctx->self)));
-            mm_dbg ("Modem allows up to %u bearers", n);
+    mm_step_scheduler_step_done (scheduler, step);
+}
 
-            /* Create new default list */
-            list = mm_bearer_list_new (n, n);
-            g_object_set (ctx->self,
-                          MM_IFACE_MODEM_BEARER_LIST, list,
-                          NULL);
-        }
+/* Strings which are meant to be loaded only once during the whole lifetime
+ * of the modem. Therefore, if we already have them loaded, don't try to load
+ * them again. */
+#undef STR_LOAD_STEP_FN
+#define STR_LOAD_STEP_FN(NAME)                                          \
+    static void                                                         \
+    initialization_step_##NAME (MMStepScheduler *scheduler,             \
+                                guint step,                             \
+                                InitializationContext *ctx)             \
+    {                                                                   \
+        if (mm_gdbus_modem_get_##NAME (ctx->skeleton) == NULL &&        \
+            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_##NAME &&    \
+            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_##NAME##_finish) { \
+            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_##NAME (     \
+                ctx->self,                                              \
+                (GAsyncReadyCallback)load_##NAME##_ready,               \
+                ctx);                                                   \
+            return;                                                     \
+        }                                                               \
+                                                                        \
+        mm_step_scheduler_step_done (scheduler, step);                  \
+    }
 
-        if (mm_gdbus_modem_get_max_bearers (ctx->skeleton) == 0)
-            mm_gdbus_modem_set_max_bearers (
-                ctx->skeleton,
-                mm_bearer_list_get_max (list));
-        if (mm_gdbus_modem_get_max_active_bearers (ctx->skeleton) == 0)
-            mm_gdbus_modem_set_max_active_bearers (
-                ctx->skeleton,
-                mm_bearer_list_get_max_active (list));
-        g_object_unref (list);
+STR_LOAD_STEP_FN (manufacturer)
+STR_LOAD_STEP_FN (model)
+STR_LOAD_STEP_FN (revision)
+STR_LOAD_STEP_FN (equipment_identifier)
+STR_LOAD_STEP_FN (device_identifier)
 
-        /* Fall down to next step */
-        ctx->step++;
+static void
+initialization_step_supported_modes (MMStepScheduler *scheduler,
+                                     guint step,
+                                     InitializationContext *ctx)
+{
+    g_assert (MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_modes != NULL);
+    g_assert (MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_modes_finish != NULL);
+
+    /* Supported modes are meant to be loaded only once during the whole
+     * lifetime of the modem. Therefore, if we already have them loaded,
+     * don't try to load them again. */
+    if (mm_gdbus_modem_get_supported_modes (ctx->skeleton) == MM_MODEM_MODE_NONE) {
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_modes (
+            ctx->self,
+            (GAsyncReadyCallback)load_supported_modes_ready,
+            ctx);
+        return;
     }
 
-    case INITIALIZATION_STEP_MANUFACTURER:
-        /* Manufacturer is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_manufacturer (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_manufacturer &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_manufacturer_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_manufacturer (
-                ctx->self,
-                (GAsyncReadyCallback)load_manufacturer_ready,
-                ctx);
-            return;
-        }
-        /* Fall down to next step */
-        ctx->step++;
+    mm_step_scheduler_step_done (scheduler, step);
+}
 
-    case INITIALIZATION_STEP_MODEL:
-        /* Model is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_model (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_model &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_model_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_model (
-                ctx->self,
-                (GAsyncReadyCallback)load_model_ready,
-                ctx);
-            return;
-        }
-        /* Fall down to next step */
-        ctx->step++;
+static void
+initialization_step_supported_bands (MMStepScheduler *scheduler,
+                                     guint step,
+                                     InitializationContext *ctx)
+{
+    GArray *supported_bands;
 
-    case INITIALIZATION_STEP_REVISION:
-        /* Revision is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_revision (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_revision &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_revision_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_revision (
-                ctx->self,
-                (GAsyncReadyCallback)load_revision_ready,
-                ctx);
-            return;
-        }
-        /* Fall down to next step */
-        ctx->step++;
+    supported_bands = (mm_common_bands_variant_to_garray (
+                           mm_gdbus_modem_get_supported_bands (ctx->skeleton)));
 
-    case INITIALIZATION_STEP_EQUIPMENT_ID:
-        /* Equipment ID is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_equipment_identifier (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_equipment_identifier &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_equipment_identifier_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_equipment_identifier (
+    /* Supported bands are meant to be loaded only once during the whole
+     * lifetime of the modem. Therefore, if we already have them loaded,
+     * don't try to load them again. */
+    if (supported_bands->len == 0 ||
+        g_array_index (supported_bands, MMModemBand, 0)  == MM_MODEM_BAND_UNKNOWN) {
+        if (MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_bands &&
+            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_bands_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_bands (
                 ctx->self,
-                (GAsyncReadyCallback)load_equipment_identifier_ready,
+                (GAsyncReadyCallback)load_supported_bands_ready,
                 ctx);
+            g_array_unref (supported_bands);
             return;
         }
-        /* Fall down to next step */
-        ctx->step++;
 
-    case INITIALIZATION_STEP_DEVICE_ID:
-        /* Device ID is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_device_identifier (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_device_identifier &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_device_identifier_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_device_identifier (
-                ctx->self,
-                (GAsyncReadyCallback)load_device_identifier_ready,
-                ctx);
-            return;
-        }
-        /* Fall down to next step */
-        ctx->step++;
+        /* Loading supported bands not implemented, default to UNKNOWN */
+        mm_gdbus_modem_set_supported_bands (ctx->skeleton, mm_common_build_bands_unknown ());
+        mm_gdbus_modem_set_bands (ctx->skeleton, mm_common_build_bands_unknown ());
+    }
+    g_array_unref (supported_bands);
 
-    case INITIALIZATION_STEP_SUPPORTED_MODES:
-        g_assert (MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_modes != NULL);
-        g_assert (MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_modes_finish != NULL);
+    mm_step_scheduler_step_done (scheduler, step);
+}
 
-        /* Supported modes are meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_supported_modes (ctx->skeleton) == MM_MODEM_MODE_NONE) {
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_modes (
+static void
+initialization_step_power_state (MMStepScheduler *scheduler,
+                                 guint step,
+                                 InitializationContext *ctx)
+{
+    /* Initial power state is meant to be loaded only once. Therefore, if we
+     * already have it loaded, don't try to load it again. */
+    if (mm_gdbus_modem_get_power_state (ctx->skeleton) == MM_MODEM_POWER_STATE_UNKNOWN) {
+        if (MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_power_state &&
+            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_power_state_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_power_state (
                 ctx->self,
-                (GAsyncReadyCallback)load_supported_modes_ready,
+                (GAsyncReadyCallback)load_power_state_ready,
                 ctx);
             return;
         }
-        /* Fall down to next step */
-        ctx->step++;
-
-    case INITIALIZATION_STEP_SUPPORTED_BANDS: {
-        GArray *supported_bands;
-
-        supported_bands = (mm_common_bands_variant_to_garray (
-                               mm_gdbus_modem_get_supported_bands (ctx->skeleton)));
 
-        /* Supported bands are meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (supported_bands->len == 0 ||
-            g_array_index (supported_bands, MMModemBand, 0)  == MM_MODEM_BAND_UNKNOWN) {
-            if (MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_bands &&
-                MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_bands_finish) {
-                MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_supported_bands (
-                    ctx->self,
-                    (GAsyncReadyCallback)load_supported_bands_ready,
-                    ctx);
-                g_array_unref (supported_bands);
-                return;
-            }
+        /* We don't know how to load current power state; assume ON */
+        mm_gdbus_modem_set_power_state (ctx->skeleton, MM_MODEM_POWER_STATE_ON);
+    }
 
-            /* Loading supported bands not implemented, default to UNKNOWN */
-            mm_gdbus_modem_set_supported_bands (ctx->skeleton, mm_common_build_bands_unknown ());
-            mm_gdbus_modem_set_bands (ctx->skeleton, mm_common_build_bands_unknown ());
-        }
-        g_array_unref (supported_bands);
+    mm_step_scheduler_step_done (scheduler, step);
+}
 
-        /* Fall down to next step */
-        ctx->step++;
+static void
+initialization_step_unlock_required (MMStepScheduler *scheduler,
+                                     guint step,
+                                     InitializationContext *ctx)
+{
+    /* Only check unlock required if we were previously not unlocked */
+    if (mm_gdbus_modem_get_unlock_required (ctx->skeleton) != MM_MODEM_LOCK_NONE) {
+        mm_iface_modem_update_lock_info (ctx->self,
+                                         MM_MODEM_LOCK_UNKNOWN, /* ask */
+                                         (GAsyncReadyCallback)modem_update_lock_info_ready,
+                                         ctx);
+        return;
     }
 
-    case INITIALIZATION_STEP_POWER_STATE:
-        /* Initial power state is meant to be loaded only once. Therefore, if we
-         * already have it loaded, don't try to load it again. */
-        if (mm_gdbus_modem_get_power_state (ctx->skeleton) == MM_MODEM_POWER_STATE_UNKNOWN) {
-            if (MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_power_state &&
-                MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_power_state_finish) {
-                MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_power_state (
-                    ctx->self,
-                    (GAsyncReadyCallback)load_power_state_ready,
-                    ctx);
-                return;
-            }
+    mm_step_scheduler_step_done (scheduler, step);
+}
 
-            /* We don't know how to load current power state; assume ON */
-            mm_gdbus_modem_set_power_state (ctx->skeleton, MM_MODEM_POWER_STATE_ON);
-        }
-        /* Fall down to next step */
-        ctx->step++;
+static void
+initialization_step_sim (MMStepScheduler *scheduler,
+                         guint step,
+                         InitializationContext *ctx)
+{
+    /* If the modem doesn't need any SIM, skip */
+    if (MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->create_sim &&
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->create_sim_finish) {
+        MMSim *sim = NULL;
 
-    case INITIALIZATION_STEP_UNLOCK_REQUIRED:
-        /* Only check unlock required if we were previously not unlocked */
-        if (mm_gdbus_modem_get_unlock_required (ctx->skeleton) != MM_MODEM_LOCK_NONE) {
-            mm_iface_modem_update_lock_info (ctx->self,
-                                             MM_MODEM_LOCK_UNKNOWN, /* ask */
-                                             (GAsyncReadyCallback)modem_update_lock_info_ready,
-                                             ctx);
+        g_object_get (ctx->self,
+                      MM_IFACE_MODEM_SIM, &sim,
+                      NULL);
+        if (!sim) {
+            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->create_sim (
+                MM_IFACE_MODEM (ctx->self),
+                (GAsyncReadyCallback)sim_new_ready,
+                ctx);
             return;
         }
-        /* Fall down to next step */
-        ctx->step++;
 
-    case INITIALIZATION_STEP_SIM:
-        /* If the modem doesn't need any SIM, skip */
-        if (MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->create_sim &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->create_sim_finish) {
-            MMSim *sim = NULL;
-
-            g_object_get (ctx->self,
-                          MM_IFACE_MODEM_SIM, &sim,
-                          NULL);
-            if (!sim) {
-                MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->create_sim (
-                    MM_IFACE_MODEM (ctx->self),
-                    (GAsyncReadyCallback)sim_new_ready,
-                    ctx);
-                return;
-            }
+        /* If already available the sim object, relaunch initialization.
+         * This will try to load any missing property value that couldn't be
+         * retrieved before due to having the SIM locked. */
+        mm_sim_initialize (sim,
+                           NULL, /* TODO: cancellable */
+                           (GAsyncReadyCallback)sim_reinit_ready,
+                           ctx);
+        g_object_unref (sim);
+        return;
+    }
 
-            /* If already available the sim object, relaunch initialization.
-             * This will try to load any missing property value that couldn't be
-             * retrieved before due to having the SIM locked. */
-            mm_sim_initialize (sim,
-                               NULL, /* TODO: cancellable */
-                               (GAsyncReadyCallback)sim_reinit_ready,
-                               ctx);
-            g_object_unref (sim);
-            return;
-        }
-        /* Fall down to next step */
-        ctx->step++;
+    mm_step_scheduler_step_done (scheduler, step);
+}
 
-    case INITIALIZATION_STEP_OWN_NUMBERS:
-        /* Own numbers is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_own_numbers (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_own_numbers &&
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_own_numbers_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_own_numbers (
-                ctx->self,
-                (GAsyncReadyCallback)load_own_numbers_ready,
-                ctx);
-            return;
-        }
-        /* Fall down to next step */
-        ctx->step++;
+static void
+initialization_step_own_numbers (MMStepScheduler *scheduler,
+                                 guint step,
+                                 InitializationContext *ctx)
+{
+    /* Own numbers is meant to be loaded only once during the whole
+     * lifetime of the modem. Therefore, if we already have them loaded,
+     * don't try to load them again. */
+    if (mm_gdbus_modem_get_own_numbers (ctx->skeleton) == NULL &&
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_own_numbers &&
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_own_numbers_finish) {
+        MM_IFACE_MODEM_GET_INTERFACE (ctx->self)->load_own_numbers (
+            ctx->self,
+            (GAsyncReadyCallback)load_own_numbers_ready,
+            ctx);
+        return;
+    }
 
-    case INITIALIZATION_STEP_LAST:
-        if (ctx->fatal_error) {
-            g_simple_async_result_take_error (ctx->result, ctx->fatal_error);
-            ctx->fatal_error = NULL;
-        } else {
-            /* We are done without errors!
-             * Handle method invocations */
-            g_signal_connect (ctx->skeleton,
-                              "handle-create-bearer",
-                              G_CALLBACK (handle_create_bearer),
-                              ctx->self);
-            g_signal_connect (ctx->skeleton,
-                              "handle-command",
-                              G_CALLBACK (handle_command),
-                              ctx->self);
-            g_signal_connect (ctx->skeleton,
-                              "handle-delete-bearer",
-                              G_CALLBACK (handle_delete_bearer),
-                              ctx->self);
-            g_signal_connect (ctx->skeleton,
-                              "handle-list-bearers",
-                              G_CALLBACK (handle_list_bearers),
-                              ctx->self);
-            g_signal_connect (ctx->skeleton,
-                              "handle-enable",
-                              G_CALLBACK (handle_enable),
-                              ctx->self);
-            g_signal_connect (ctx->skeleton,
-                              "handle-set-power-state",
-                              G_CALLBACK (handle_set_power_state),
-                              ctx->self);
-            g_signal_connect (ctx->skeleton,
-                              "handle-reset",
-                              G_CALLBACK (handle_reset),
-                              ctx->self);
-            g_signal_connect (ctx->skeleton,
-                              "handle-factory-reset",
-                              G_CALLBACK (handle_factory_reset),
-                              ctx->self);
-            g_signal_connect (ctx->skeleton,
-                              "handle-set-bands",
-                              G_CALLBACK (handle_set_bands),
-                              ctx->self);
-            g_signal_connect (ctx->skeleton,
-                              "handle-set-allowed-modes",
-                              G_CALLBACK (handle_set_allowed_modes),
-                              ctx->self);
-            g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
-        }
+    mm_step_scheduler_step_done (scheduler, step);
+}
+
+#define STEP_RUN(NAME) ((MMStepRunFn)initialization_step_##NAME)
+#define DEP(STEP) MM_STEP (INITIALIZATION_STEP_##STEP)
+
+/* Same order as InitializationStep. Loaders which need to know whether the
+ * modem is 3GPP or CDMA depend on the current capabilities; the device
+ * identifier is built from the other identification strings, and anything
+ * reading from the SIM needs it unlocked. */
+static const MMStepInfo initialization_steps[] = {
+    { "current capabilities", STEP_RUN (current_capabilities), 0,                              MM_STEP_PORT_AT   },
+    { "modem capabilities",   STEP_RUN (modem_capabilities),   DEP (CURRENT_CAPABILITIES),     MM_STEP_PORT_AT   },
+    { "bearers",              STEP_RUN (bearers),              0,                              MM_STEP_PORT_NONE },
+    { "manufacturer",         STEP_RUN (manufacturer),         0,                              MM_STEP_PORT_AT   },
+    { "model",                STEP_RUN (model),                0,                              MM_STEP_PORT_AT   },
+    { "revision",             STEP_RUN (revision),             0,                              MM_STEP_PORT_AT   },
+    { "equipment identifier", STEP_RUN (equipment_identifier), DEP (CURRENT_CAPABILITIES),     MM_STEP_PORT_AT   },
+    { "device identifier",    STEP_RUN (device_identifier),    (DEP (MANUFACTURER) |
+                                                                DEP (MODEL) |
+                                                                DEP (REVISION) |
+                                                                DEP (EQUIPMENT_ID)),           MM_STEP_PORT_AT   },
+    { "supported modes",      STEP_RUN (supported_modes),      DEP (CURRENT_CAPABILITIES),     MM_STEP_PORT_AT   },
+    { "supported bands",      STEP_RUN (supported_bands),      DEP (CURRENT_CAPABILITIES),     MM_STEP_PORT_AT   },
+    { "power state",          STEP_RUN (power_state),          DEP (CURRENT_CAPABILITIES),     MM_STEP_PORT_AT   },
+    { "unlock required",      STEP_RUN (unlock_required),      DEP (CURRENT_CAPABILITIES),     MM_STEP_PORT_AT   },
+    { "SIM",                  STEP_RUN (sim),                  DEP (UNLOCK_REQUIRED),          MM_STEP_PORT_AT   },
+    { "own numbers",          STEP_RUN (own_numbers),          DEP (UNLOCK_REQUIRED) | DEP (SIM), MM_STEP_PORT_AT },
+};
+
+#undef STEP_RUN
+#undef DEP
 
-        /* Finally, export the new interface, even if we got errors, but only if not
-         * done already */
-        if (!mm_gdbus_object_peek_modem (MM_GDBUS_OBJECT (ctx->self)))
-            mm_gdbus_object_skeleton_set_modem (MM_GDBUS_OBJECT_SKELETON (ctx->self),
-                                                MM_GDBUS_MODEM (ctx->skeleton));
+static void
+initialization_done (MMStepScheduler *scheduler,
+                     InitializationContext *ctx)
+{
+    if (g_cancellable_is_cancelled (ctx->cancellable)) {
+        g_clear_error (&ctx->fatal_error);
+        g_simple_async_result_set_error (ctx->result,
+                                         MM_CORE_ERROR,
+                                         MM_CORE_ERROR_CANCELLED,
+                                         "Interface initialization cancelled");
         initialization_context_complete_and_free (ctx);
         return;
     }
 
-    g_assert_not_reached ();
+    mm_dbg ("Modem interface loaded in %.3fs",
+            mm_step_scheduler_get_elapsed (scheduler));
+
+    if (ctx->fatal_error) {
+        g_simple_async_result_take_error (ctx->result, ctx->fatal_error);
+        ctx->fatal_error = NULL;
+    } else {
+        /* We are done without errors!
+         * Handle method invocations */
+        g_signal_connect (ctx->skeleton,
+                          "handle-create-bearer",
+                          G_CALLBACK (handle_create_bearer),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-command",
+                          G_CALLBACK (handle_command),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-delete-bearer",
+                          G_CALLBACK (handle_delete_bearer),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-list-bearers",
+                          G_CALLBACK (handle_list_bearers),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-enable",
+                          G_CALLBACK (handle_enable),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-set-power-state",
+                          G_CALLBACK (handle_set_power_state),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-reset",
+                          G_CALLBACK (handle_reset),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-factory-reset",
+                          G_CALLBACK (handle_factory_reset),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-set-bands",
+                          G_CALLBACK (handle_set_bands),
+                          ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-set-allowed-modes",
+                          G_CALLBACK (handle_set_allowed_modes),
+                          ctx->self);
+        g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+    }
+
+    /* Finally, export the new interface, even if we got errors, but only if not
+     * done already */
+    if (!mm_gdbus_object_peek_modem (MM_GDBUS_OBJECT (ctx->self)))
+        mm_gdbus_object_skeleton_set_modem (MM_GDBUS_OBJECT_SKELETON (ctx->self),
+                                            MM_GDBUS_MODEM (ctx->skeleton));
+    initialization_context_complete_and_free (ctx);
 }
 
 gboolean
@@ -4128,10 +4134,23 @@ mm_iface_modem_initialize (MMIfaceModem *self,
                                              callback,
                                              user_data,
                                              mm_iface_modem_initialize);
-    ctx->step = INITIALIZATION_STEP_FIRST;
     ctx->skeleton = skeleton;
+    ctx->scheduler = mm_step_scheduler_new ("modem interface",
+                                            initialization_steps,
+                                            G_N_ELEMENTS (initialization_steps),
+                                            ctx);
+    mm_base_modem_setup_step_scheduler (MM_BASE_MODEM (self), ctx->scheduler);
+#if defined WITH_QMI
+    /* Modems with a QMI port implement all these loaders over QMI */
+    if (mm_base_modem_peek_port_qmi (MM_BASE_MODEM (self)))
+        mm_step_scheduler_remap_port (ctx->scheduler, MM_STEP_PORT_AT, MM_STEP_PORT_QMI);
+#endif
 
-    interface_initialization_step (ctx);
+    initialization_load_port_info (ctx);
+    mm_step_scheduler_run (ctx->scheduler,
+                           ctx->cancellable,
+                           (MMStepSchedulerDoneFn)initialization_done,
+                           ctx);
 }
 
 void
@@ -23,15 +23,22 @@
 #include <gudev/gudev.h>
 
 #include <ModemManager.h>
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
 #include <mm-errors-types.h>
 #include <mm-gdbus-manager.h>
 
 #include "mm-manager.h"
 #include "mm-device.h"
+#include "mm-base-modem.h"
+#include "mm-context.h"
+#include "mm-iface-modem-simple.h"
 #include "mm-plugin-manager.h"
 #include "mm-auth.h"
 #include "mm-plugin.h"
 #include "mm-log.h"
+#include "mm-trace.h"
+#include "mm-status-history.h"
 
 static void initable_iface_init (GInitableIface *iface);
 
@@ -59,6 +66,14 @@ struct _MMManagerPrivate {
     GHashTable *devices;
     /* The Object Manager server */
     GDBusObjectManagerServer *object_manager;
+
+    /* Status of the exported modems, keyed by object path */
+    GHashTable *status_entries;
+    /* Generations of the status changes and removals */
+    MMStatusHistory *status_history;
+
+    /* Filter recording method calls in the timeline, when tracing */
+    guint trace_filter_id;
 };
 
 /*****************************************************************************/
@@ -630,6 +645,368 @@ handle_scan_devices (MmGdbusOrgFreedesktopModemManager1 *manager,
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Bulk status of the exported modems */
+
+/* Version of the snapshot format given in GetStatusSnapshot() and
+ * GetStatusChanges() */
+#define STATUS_SNAPSHOT_VERSION 1
+
+/* Maximum number of removed modems remembered for GetStatusChanges() */
+#define STATUS_REMOVED_MAX 64
+
+typedef struct {
+    MMManager *self;
+    gchar *path;
+    MMSimpleStatus *status;
+    gulong notify_id;
+    /* Cached status dictionary, built on demand */
+    GVariant *dictionary;
+} StatusEntry;
+
+static void
+status_entry_free (StatusEntry *entry)
+{
+    if (entry->notify_id)
+        g_signal_handler_disconnect (entry->status, entry->notify_id);
+    if (entry->dictionary)
+        g_variant_unref (entry->dictionary);
+    g_object_unref (entry->status);
+    g_free (entry->path);
+    g_slice_free (StatusEntry, entry);
+}
+
+static GVariant *
+status_entry_peek_dictionary (StatusEntry *entry)
+{
+    if (!entry->dictionary)
+        entry->dictionary = g_variant_ref_sink (mm_simple_status_get_dictionary (entry->status));
+    return entry->dictionary;
+}
+
+static void
+status_changed (MMSimpleStatus *status,
+                GParamSpec *pspec,
+                StatusEntry *entry)
+{
+    if (entry->dictionary) {
+        g_variant_unref (entry->dictionary);
+        entry->dictionary = NULL;
+    }
+    mm_status_history_update (entry->self->priv->status_history, entry->path);
+}
+
+static void
+status_object_added (GDBusObjectManager *object_manager,
+                     GDBusObject *object,
+                     MMManager *self)
+{
+    MMSimpleStatus *status = NULL;
+    StatusEntry *entry;
+
+    if (!MM_IS_IFACE_MODEM_SIMPLE (object))
+        return;
+
+    g_object_get (object,
+                  MM_IFACE_MODEM_SIMPLE_STATUS, &status,
+                  NULL);
+    if (!status)
+        return;
+
+    entry = g_slice_new0 (StatusEntry);
+    entry->self = self;
+    entry->path = g_strdup (g_dbus_object_get_object_path (object));
+    entry->status = status;
+    entry->notify_id = g_signal_connect (status,
+                                         "notify",
+                                         G_CALLBACK (status_changed),
+                                         entry);
+
+    mm_status_history_update (self->priv->status_history, entry->path);
+    g_hash_table_replace (self->priv->status_entries, entry->path, entry);
+}
+
+static void
+status_object_removed (GDBusObjectManager *object_manager,
+                       GDBusObject *object,
+                       MMManager *self)
+{
+    const gchar *path;
+
+    path = g_dbus_object_get_object_path (object);
+    if (!g_hash_table_remove (self->priv->status_entries, path))
+        return;
+
+    mm_status_history_remove (self->priv->status_history, path);
+}
+
+/* All modems if @paths is NULL */
+static GVariant *
+build_status_dictionary (MMManager *self,
+                         GPtrArray *paths)
+{
+    GVariantBuilder builder;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{oa{sv}}"));
+
+    if (!paths) {
+        GHashTableIter iter;
+        gpointer value;
+
+        g_hash_table_iter_init (&iter, self->priv->status_entries);
+        while (g_hash_table_iter_next (&iter, NULL, &value)) {
+            StatusEntry *entry = value;
+
+            g_variant_builder_add (&builder,
+                                   "{o@a{sv}}",
+                                   entry->path,
+                                   status_entry_peek_dictionary (entry));
+        }
+    } else {
+        guint i;
+
+        for (i = 0; i < paths->len; i++) {
+            StatusEntry *entry;
+
+            entry = g_hash_table_lookup (self->priv->status_entries,
+                                         g_ptr_array_index (paths, i));
+            if (entry)
+                g_variant_builder_add (&builder,
+                                       "{o@a{sv}}",
+                                       entry->path,
+                                       status_entry_peek_dictionary (entry));
+        }
+    }
+
+    return g_variant_builder_end (&builder);
+}
+
+static gboolean
+handle_get_status_snapshot (MmGdbusOrgFreedesktopModemManager1 *manager,
+                            GDBusMethodInvocation *invocation)
+{
+    MMManager *self = MM_MANAGER (manager);
+
+    mm_gdbus_org_freedesktop_modem_manager1_complete_get_status_snapshot (
+        manager,
+        invocation,
+        STATUS_SNAPSHOT_VERSION,
+        mm_status_history_get_generation (self->priv->status_history),
+        build_status_dictionary (self, NULL));
+    return TRUE;
+}
+
+static gboolean
+handle_get_status_changes (MmGdbusOrgFreedesktopModemManager1 *manager,
+                           GDBusMethodInvocation *invocation,
+                           guint64 since)
+{
+    MMManager *self = MM_MANAGER (manager);
+    GPtrArray *changed;
+    GPtrArray *removed;
+    GVariantBuilder removed_builder;
+    gboolean complete;
+    guint i;
+
+    /* Unknown generation (e.g. daemon restarted) or changes no longer
+     * tracked: give the whole list */
+    complete = mm_status_history_get_changes (self->priv->status_history,
+                                              since,
+                                              &changed,
+                                              &removed);
+
+    g_variant_builder_init (&removed_builder, G_VARIANT_TYPE ("ao"));
+    for (i = 0; i < removed->len; i++)
+        g_variant_builder_add (&removed_builder, "o", g_ptr_array_index (removed, i));
+
+    mm_gdbus_org_freedesktop_modem_manager1_complete_get_status_changes (
+        manager,
+        invocation,
+        STATUS_SNAPSHOT_VERSION,
+        mm_status_history_get_generation (self->priv->status_history),
+        complete,
+        build_status_dictionary (self, changed),
+        g_variant_builder_end (&removed_builder));
+
+    g_ptr_array_unref (changed);
+    g_ptr_array_unref (removed);
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Memory report, only available in debug mode */
+
+static gboolean
+handle_get_memory_report (MmGdbusOrgFreedesktopModemManager1 *manager,
+                          GDBusMethodInvocation *invocation)
+{
+    MMManager *self = MM_MANAGER (manager);
+    GVariantBuilder builder;
+    GList *objects;
+    GList *l;
+
+    if (!mm_context_get_debug ()) {
+        g_dbus_method_invocation_return_error (invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_UNSUPPORTED,
+                                               "Memory reports are only available in debug mode");
+        return TRUE;
+    }
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{oa{sv}}"));
+    objects = g_dbus_object_manager_get_objects (G_DBUS_OBJECT_MANAGER (self->priv->object_manager));
+    for (l = objects; l; l = g_list_next (l)) {
+        if (!MM_IS_BASE_MODEM (l->data))
+            continue;
+
+        g_variant_builder_add (&builder,
+                               "{o@a{sv}}",
+                               g_dbus_object_get_object_path (G_DBUS_OBJECT (l->data)),
+                               mm_base_modem_get_memory_report (MM_BASE_MODEM (l->data)));
+    }
+    g_list_free_full (objects, (GDestroyNotify)g_object_unref);
+
+    mm_gdbus_org_freedesktop_modem_manager1_complete_get_memory_report (
+        manager,
+        invocation,
+        g_variant_builder_end (&builder));
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Timeline of the daemon, only available when tracing */
+
+static gboolean
+handle_get_trace (MmGdbusOrgFreedesktopModemManager1 *manager,
+                  GDBusMethodInvocation *invocation)
+{
+    gchar *trace;
+
+    if (!mm_trace_enabled ()) {
+        g_dbus_method_invocation_return_error (invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_UNSUPPORTED,
+                                               "Tracing is only available when running with --trace");
+        return TRUE;
+    }
+
+    trace = mm_trace_to_json ();
+    mm_gdbus_org_freedesktop_modem_manager1_complete_get_trace (manager, invocation, trace);
+    g_free (trace);
+    return TRUE;
+}
+
+typedef struct {
+    gint64 start;
+    gchar *name;
+    gchar *path;
+    guint lane;
+} TracedCall;
+
+static void
+traced_call_free (TracedCall *call)
+{
+    g_free (call->name);
+    g_free (call->path);
+    g_slice_free (TracedCall, call);
+}
+
+/* Method calls being handled, keyed by sender and serial. Only used from the
+ * GDBus worker thread, and kept around for the whole lifetime of the process
+ * as the filter may still run after being removed. */
+static GHashTable *traced_calls;
+/* Calls handled at the same time are traced in separate lanes; the last one
+ * is shared by whatever doesn't fit, so lanes are counted, not just flagged */
+#define TRACED_LANES 64
+static guint traced_lanes[TRACED_LANES];
+
+static void
+traced_call_release_lane (TracedCall *call)
+{
+    g_warn_if_fail (traced_lanes[call->lane] > 0);
+    traced_lanes[call->lane]--;
+}
+
+static GDBusMessage *
+trace_filter (GDBusConnection *connection,
+              GDBusMessage *message,
+              gboolean incoming,
+              gpointer user_data)
+{
+    TracedCall *call;
+    gchar *key;
+
+    if (G_UNLIKELY (!traced_calls))
+        traced_calls = g_hash_table_new_full (g_str_hash,
+                                              g_str_equal,
+                                              g_free,
+                                              (GDestroyNotify)traced_call_free);
+
+    if (incoming) {
+        const gchar *interface;
+        TracedCall *previous;
+
+        if (g_dbus_message_get_message_type (message) != G_DBUS_MESSAGE_TYPE_METHOD_CALL ||
+            g_dbus_message_get_flags (message) & G_DBUS_MESSAGE_FLAGS_NO_REPLY_EXPECTED)
+            return message;
+
+        interface = g_dbus_message_get_interface (message);
+        if (interface && g_str_has_prefix (interface, MM_DBUS_SERVICE "."))
+            interface += strlen (MM_DBUS_SERVICE ".");
+
+        call = g_slice_new0 (TracedCall);
+        call->start = mm_trace_begin ();
+        call->name = g_strdup_printf ("%s%s%s",
+                                      interface ? interface : "",
+                                      interface ? "." : "",
+                                      g_dbus_message_get_member (message));
+        call->path = g_strdup (g_dbus_message_get_path (message));
+        while (call->lane < TRACED_LANES - 1 && traced_lanes[call->lane])
+            call->lane++;
+        traced_lanes[call->lane]++;
+
+        key = g_strdup_printf ("%s:%u",
+                               g_dbus_message_get_sender (message),
+                               g_dbus_message_get_serial (message));
+        /* A reused serial means the previous call never got a reply */
+        previous = g_hash_table_lookup (traced_calls, key);
+        if (previous)
+            traced_call_release_lane (previous);
+        g_hash_table_replace (traced_calls, key, call);
+        return message;
+    }
+
+    if (g_dbus_message_get_message_type (message) != G_DBUS_MESSAGE_TYPE_METHOD_RETURN &&
+        g_dbus_message_get_message_type (message) != G_DBUS_MESSAGE_TYPE_ERROR)
+        return message;
+
+    key = g_strdup_printf ("%s:%u",
+                           g_dbus_message_get_destination (message),
+                           g_dbus_message_get_reply_serial (message));
+    call = g_hash_table_lookup (traced_calls, key);
+    if (call) {
+        gchar *track;
+        gchar *detail;
+
+        track = g_strdup_printf ("D-Bus #%u", call->lane);
+        detail = g_strdup_printf ("%s%s%s",
+                                  call->path ? call->path : "",
+                                  g_dbus_message_get_error_name (message) ? ": " : "",
+                                  g_dbus_message_get_error_name (message) ? g_dbus_message_get_error_name (message) : "");
+        mm_trace_span ("dbus", track, call->start, call->name, detail);
+        g_free (detail);
+        g_free (track);
+
+        traced_call_release_lane (call);
+        g_hash_table_remove (traced_calls, key);
+    }
+    g_free (key);
+
+    return message;
+}
+
+/*****************************************************************************/
+
 MMManager *
 mm_manager_new (GDBusConnection *connection,
                 GError **error)
@@ -706,6 +1083,21 @@ mm_manager_init (MMManager *manager)
     /* Setup Object Manager Server */
     priv->object_manager = g_dbus_object_manager_server_new (MM_DBUS_PATH);
 
+    /* Track status of the exported modems */
+    priv->status_entries = g_hash_table_new_full (g_str_hash,
+                                                  g_str_equal,
+                                                  NULL,
+                                                  (GDestroyNotify)status_entry_free);
+    priv->status_history = mm_status_history_new (0, STATUS_REMOVED_MAX);
+    g_signal_connect (priv->object_manager,
+                      "object-added",
+                      G_CALLBACK (status_object_added),
+                      manager);
+    g_signal_connect (priv->object_manager,
+                      "object-removed",
+                      G_CALLBACK (status_object_removed),
+                      manager);
+
     /* Enable processing of input DBus messages */
     g_signal_connect (manager,
                       "handle-set-logging",
@@ -715,6 +1107,22 @@ mm_manager_init (MMManager *manager)
                       "handle-scan-devices",
                       G_CALLBACK (handle_scan_devices),
                       NULL);
+    g_signal_connect (manager,
+                      "handle-get-status-snapshot",
+                      G_CALLBACK (handle_get_status_snapshot),
+                      NULL);
+    g_signal_connect (manager,
+                      "handle-get-status-changes",
+                      G_CALLBACK (handle_get_status_changes),
+                      NULL);
+    g_signal_connect (manager,
+                      "handle-get-memory-report",
+                      G_CALLBACK (handle_get_memory_report),
+                      NULL);
+    g_signal_connect (manager,
+                      "handle-get-trace",
+                      G_CALLBACK (handle_get_trace),
+                      NULL);
 }
 
 static gboolean
@@ -740,6 +1148,13 @@ initable_init (GInitable *initable,
     g_dbus_object_manager_server_set_connection (priv->object_manager,
                                                  priv->connection);
 
+    /* Record how long method calls take to be handled */
+    if (mm_trace_enabled ())
+        priv->trace_filter_id = g_dbus_connection_add_filter (priv->connection,
+                                                              trace_filter,
+                                                              NULL,
+                                                              NULL);
+
     /* All good */
     return TRUE;
 }
@@ -757,11 +1172,20 @@ finalize (GObject *object)
     if (priv->plugin_manager)
         g_object_unref (priv->plugin_manager);
 
-    if (priv->object_manager)
+    if (priv->object_manager) {
+        g_signal_handlers_disconnect_by_func (priv->object_manager, status_object_added, object);
+        g_signal_handlers_disconnect_by_func (priv->object_manager, status_object_removed, object);
         g_object_unref (priv->object_manager);
+    }
+
+    g_hash_table_destroy (priv->status_entries);
+    mm_status_history_free (priv->status_history);
 
-    if (priv->connection)
+    if (priv->connection) {
+        if (priv->trace_filter_id)
+            g_dbus_connection_remove_filter (priv->connection, priv->trace_filter_id);
         g_object_unref (priv->connection);
+    }
 
     if (priv->authp)
         g_object_unref (priv->authp);
@@ -30,6 +30,8 @@
 
 #include "mm-modem-helpers.h"
 #include "mm-log.h"
+#include "mm-regex-cache.h"
+#include "mm-at-grammar.h"
 
 /*****************************************************************************/
 
@@ -215,98 +217,23 @@ mm_filter_current_bands (const GArray *supported_bands,
 
 /*****************************************************************************/
 
-/* +CREG: <stat>                      (GSM 07.07 CREG=1 unsolicited) */
-#define CREG1 "\\+(CREG|CGREG):\\s*0*([0-9])"
-
-/* +CREG: <n>,<stat>                  (GSM 07.07 CREG=1 solicited) */
-#define CREG2 "\\+(CREG|CGREG):\\s*0*([0-9]),\\s*0*([0-9])"
-
-/* +CREG: <stat>,<lac>,<ci>           (GSM 07.07 CREG=2 unsolicited) */
-#define CREG3 "\\+(CREG|CGREG):\\s*0*([0-9]),\\s*([^,\\s]*)\\s*,\\s*([^,\\s]*)"
-
-/* +CREG: <n>,<stat>,<lac>,<ci>       (GSM 07.07 solicited and some CREG=2 unsolicited) */
-#define CREG4 "\\+(CREG|CGREG):\\s*0*([0-9]),\\s*0*([0-9])\\s*,\\s*([^,]*)\\s*,\\s*([^,\\s]*)"
-
-/* +CREG: <stat>,<lac>,<ci>,<AcT>     (ETSI 27.007 CREG=2 unsolicited) */
-#define CREG5 "\\+(CREG|CGREG):\\s*0*([0-9])\\s*,\\s*([^,\\s]*)\\s*,\\s*([^,\\s]*)\\s*,\\s*0*([0-9])"
-
-/* +CREG: <n>,<stat>,<lac>,<ci>,<AcT> (ETSI 27.007 solicited and some CREG=2 unsolicited) */
-#define CREG6 "\\+(CREG|CGREG):\\s*0*([0-9]),\\s*0*([0-9])\\s*,\\s*([^,\\s]*)\\s*,\\s*([^,\\s]*)\\s*,\\s*0*([0-9])"
-
-/* +CREG: <n>,<stat>,<lac>,<ci>,<AcT?>,<something> (Samsung Wave S8500) */
-/* '<CR><LF>+CREG: 2,1,000B,2816, B, C2816<CR><LF><CR><LF>OK<CR><LF>' */
-#define CREG7 "\\+(CREG|CGREG):\\s*0*([0-9]),\\s*0*([0-9])\\s*,\\s*([^,\\s]*)\\s*,\\s*([^,\\s]*)\\s*,\\s*([^,\\s]*)\\s*,\\s*[^,\\s]*"
-
-/* +CREG: <stat>,<lac>,<ci>,<AcT>,<RAC> (ETSI 27.007 v9.20 CREG=2 unsolicited with RAC) */
-#define CREG8 "\\+(CREG|CGREG):\\s*0*([0-9])\\s*,\\s*([^,\\s]*)\\s*,\\s*([^,\\s]*)\\s*,\\s*0*([0-9])\\s*,\\s*([^,\\s]*)"
+/* Registration responses and unsolicited messages come in many shapes
+ * (+CREG: <stat>, +CREG: <n>,<stat>, +CREG: <stat>,<lac>,<ci>,<AcT>,...),
+ * so the regex only finds the line and mm_3gpp_creg_tokenize() takes it
+ * apart.
+ */
+#define CREG "\\+(CREG|CGREG|CEREG):\\s*[0-9][^\\r\\n]*"
 
 GPtrArray *
 mm_3gpp_creg_regex_get (gboolean solicited)
 {
-    GPtrArray *array = g_ptr_array_sized_new (7);
+    GPtrArray *array = g_ptr_array_sized_new (1);
     GRegex *regex;
 
-    /* #1 */
-    if (solicited)
-        regex = g_regex_new (CREG1 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    else
-        regex = g_regex_new ("\\r\\n" CREG1 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    g_assert (regex);
-    g_ptr_array_add (array, regex);
-
-    /* #2 */
-    if (solicited)
-        regex = g_regex_new (CREG2 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    else
-        regex = g_regex_new ("\\r\\n" CREG2 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    g_assert (regex);
-    g_ptr_array_add (array, regex);
-
-    /* #3 */
-    if (solicited)
-        regex = g_regex_new (CREG3 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    else
-        regex = g_regex_new ("\\r\\n" CREG3 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    g_assert (regex);
-    g_ptr_array_add (array, regex);
-
-    /* #4 */
     if (solicited)
-        regex = g_regex_new (CREG4 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get (CREG "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     else
-        regex = g_regex_new ("\\r\\n" CREG4 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    g_assert (regex);
-    g_ptr_array_add (array, regex);
-
-    /* #5 */
-    if (solicited)
-        regex = g_regex_new (CREG5 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    else
-        regex = g_regex_new ("\\r\\n" CREG5 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    g_assert (regex);
-    g_ptr_array_add (array, regex);
-
-    /* #6 */
-    if (solicited)
-        regex = g_regex_new (CREG6 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    else
-        regex = g_regex_new ("\\r\\n" CREG6 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    g_assert (regex);
-    g_ptr_array_add (array, regex);
-
-    /* #7 */
-    if (solicited)
-        regex = g_regex_new (CREG7 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    else
-        regex = g_regex_new ("\\r\\n" CREG7 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    g_assert (regex);
-    g_ptr_array_add (array, regex);
-
-    /* #8 */
-    if (solicited)
-        regex = g_regex_new (CREG8 "$", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    else
-        regex = g_regex_new ("\\r\\n" CREG8 "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        regex = mm_regex_cache_get ("\\r\\n" CREG "\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     g_assert (regex);
     g_ptr_array_add (array, regex);
 
@@ -325,10 +252,10 @@ mm_3gpp_creg_regex_destroy (GPtrArray *array)
 GRegex *
 mm_3gpp_ciev_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CIEV: (.*),(\\d)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CIEV: (.*),(\\d)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 /*************************************************************************/
@@ -336,10 +263,10 @@ mm_3gpp_ciev_regex_get (void)
 GRegex *
 mm_3gpp_cusd_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CUSD:\\s*(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CUSD:\\s*(.*)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 /*************************************************************************/
@@ -347,10 +274,10 @@ mm_3gpp_cusd_regex_get (void)
 GRegex *
 mm_3gpp_cmti_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CMTI: \"(\\S+)\",(\\d+)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CMTI: \"(\\S+)\",(\\d+)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 GRegex *
@@ -359,10 +286,25 @@ mm_3gpp_cds_regex_get (void)
     /* Example:
      * <CR><LF>+CDS: 24<CR><LF>07914356060013F10659098136395339F6219011707193802190117071938030<CR><LF>
      */
-    return g_regex_new ("\\r\\n\\+CDS:\\s*(\\d+)\\r\\n(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_cache_get ("\\r\\n\\+CDS:\\s*(\\d+)\\r\\n(.*)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
+}
+
+/*************************************************************************/
+
+GRegex *
+mm_3gpp_ctz_regex_get (void)
+{
+    /* Examples:
+     * <CR><LF>+CTZV: -20<CR><LF>
+     * <CR><LF>+CTZE: "+04",1,"2012/09/19,10:51:49"<CR><LF>
+     */
+    return mm_regex_cache_get ("\\r\\n(\\+CTZ[VE]:.*)\\r\\n",
+                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                               0,
+                               NULL);
 }
 
 /*************************************************************************/
@@ -409,182 +351,165 @@ get_mm_access_tech_from_etsi_access_tech (guint act)
 }
 
 static MMModem3gppNetworkAvailability
-parse_network_status (const gchar *str)
+parse_network_status (guint status)
 {
     /* Expecting a value between '0' and '3' inclusive */
-    if (!str ||
-        strlen (str) != 1 ||
-        str[0] < '0' ||
-        str[0] > '3') {
-        mm_warn ("Cannot parse network status: '%s'", str);
+    if (status > 3) {
+        mm_warn ("Cannot parse network status: '%u'", status);
         return MM_MODEM_3GPP_NETWORK_AVAILABILITY_UNKNOWN;
     }
 
-    return (MMModem3gppNetworkAvailability) (str[0] - '0');
+    return (MMModem3gppNetworkAvailability) status;
 }
 
 static MMModemAccessTechnology
-parse_access_tech (const gchar *str)
+parse_access_tech (guint act)
 {
     /* Recognized access technologies are between '0' and '7' inclusive... */
-    if (!str ||
-        strlen (str) != 1 ||
-        str[0] < '0' ||
-        str[0] > '7') {
-        mm_warn ("Cannot parse access tech: '%s'", str);
+    if (act > 7) {
+        mm_warn ("Cannot parse access tech: '%u'", act);
         return MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
     }
 
-    return get_mm_access_tech_from_etsi_access_tech (str[0] - '0');
+    return get_mm_access_tech_from_etsi_access_tech (act);
+}
+
+typedef struct {
+    guint status;
+    MMAtSpan operator_long;
+    MMAtSpan operator_short;
+    MMAtSpan operator_code;
+    guint access_tech;
+} CopsTuple;
+
+static const MMAtField cops_fields[] = {
+    MM_AT_FIELD (MM_AT_FIELD_UINT,   CopsTuple, status),
+    MM_AT_FIELD (MM_AT_FIELD_STRING, CopsTuple, operator_long),
+    MM_AT_FIELD (MM_AT_FIELD_STRING, CopsTuple, operator_short),
+    MM_AT_FIELD (MM_AT_FIELD_STRING, CopsTuple, operator_code),
+    MM_AT_FIELD (MM_AT_FIELD_UINT,   CopsTuple, access_tech)
+};
+
+static const MMAtGrammar cops_grammar = MM_AT_GRAMMAR (cops_fields, CopsTuple);
+
+/* Without access technology, i.e. pre-UMTS format */
+#define COPS_FIELDS_PRE_UMTS (G_N_ELEMENTS (cops_fields) - 1)
+
+typedef struct {
+    gboolean umts_format;
+    GList *info_list;
+} CopsContext;
+
+static gboolean
+cops_tuple_check_format (CopsTuple *tuple,
+                         guint n_fields,
+                         CopsContext *ctx)
+{
+    if (n_fields == G_N_ELEMENTS (cops_fields)) {
+        ctx->umts_format = TRUE;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean
+cops_tuple_add (CopsTuple *tuple,
+                guint n_fields,
+                CopsContext *ctx)
+{
+    MM3gppNetworkInfo *info;
+    gchar *access_tech_str;
+    gsize i;
+
+    if (n_fields < (ctx->umts_format ?
+                    G_N_ELEMENTS (cops_fields) :
+                    COPS_FIELDS_PRE_UMTS))
+        return TRUE;
+
+    /* If the operator number isn't valid (ie, at least 5 digits),
+     * ignore the scan result; it's probably the parameter stuff at the
+     * end of the +COPS response.
+     */
+    if (tuple->operator_code.len < 5)
+        return TRUE;
+    for (i = 0; i < tuple->operator_code.len; i++) {
+        if (!isdigit (tuple->operator_code.str[i]) && tuple->operator_code.str[i] != '-')
+            return TRUE;
+    }
+
+    info = g_new0 (MM3gppNetworkInfo, 1);
+    info->status = parse_network_status (tuple->status);
+    info->operator_long = mm_at_span_dup (&tuple->operator_long);
+    info->operator_short = mm_at_span_dup (&tuple->operator_short);
+    info->operator_code = mm_at_span_dup (&tuple->operator_code);
+    /* Only try for access technology with UMTS-format matches.
+     * If none give, assume GSM */
+    info->access_tech = (ctx->umts_format ?
+                         parse_access_tech (tuple->access_tech) :
+                         MM_MODEM_ACCESS_TECHNOLOGY_GSM);
+
+    access_tech_str = mm_modem_access_technology_build_string_from_mask (info->access_tech);
+    mm_dbg ("Found network '%s' ('%s','%s'); availability: %s, access tech: %s",
+            info->operator_code,
+            info->operator_short ? info->operator_short : "no short name",
+            info->operator_long ? info->operator_long : "no long name",
+            mm_modem_3gpp_network_availability_get_string (info->status),
+            access_tech_str);
+    g_free (access_tech_str);
+
+    ctx->info_list = g_list_prepend (ctx->info_list, info);
+    return TRUE;
 }
 
 GList *
 mm_3gpp_parse_cops_test_response (const gchar *reply,
                                   GError **error)
 {
-    GRegex *r;
-    GList *info_list = NULL;
-    GMatchInfo *match_info;
-    gboolean umts_format = TRUE;
-    GError *inner_error = NULL;
+    MMAtCursor cursor;
+    MMAtCursor start;
+    CopsTuple tuple;
+    CopsContext ctx = { FALSE, NULL };
 
     g_return_val_if_fail (reply != NULL, NULL);
     if (error)
         g_return_val_if_fail (*error == NULL, NULL);
 
-    if (!strstr (reply, "+COPS: ")) {
+    mm_at_cursor_init (&cursor, reply, -1);
+    if (!mm_at_cursor_find (&cursor, "+COPS: ")) {
         g_set_error_literal (error,
                              MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
                              "Could not parse scan results.");
         return NULL;
     }
 
-    reply = strstr (reply, "+COPS: ") + 7;
-
     /* Cell access technology (GSM, UTRAN, etc) got added later and not all
-     * modems implement it.  Some modesm have quirks that make it hard to
-     * use one regular experession for matching both pre-UMTS and UMTS
-     * responses.  So try UMTS-format first and fall back to pre-UMTS if
-     * we get no UMTS-formst matches.
-     */
-
-    /* Quirk: Sony-Ericsson TM-506 sometimes includes a stray ')' like so,
-     *        which is what makes it hard to match both pre-UMTS and UMTS in
-     *        the same regex:
+     * modems implement it.  If any tuple comes with it, only take the ones
+     * which do (UMTS format); otherwise, take all and assume GSM (pre-UMTS
+     * format).
      *
-     *       +COPS: (2,"","T-Mobile","31026",0),(1,"AT&T","AT&T","310410"),0)
+     * Ex: Motorola C-series (BUSlink SCWi275u) like so:
+     *
+     *       +COPS: (2,"T-Mobile","","310260"),(0,"Cingular Wireless","","310410")
+     *
+     * Quirk: Some Nokia phones (N80) don't send the quotes for empty values:
+     *
+     *       +COPS: (2,"T - Mobile",,"31026"),(1,"Einstein PCS",,"31064"),(1,"Cingular",,"31041"),,(0,1,3),(0,2)
      */
-
-    r = g_regex_new ("\\((\\d),([^,\\)]*),([^,\\)]*),([^,\\)]*)[\\)]?,(\\d)\\)", G_REGEX_UNGREEDY, 0, &inner_error);
-    if (inner_error) {
-        mm_err ("Invalid regular expression: %s", inner_error->message);
-        g_error_free (inner_error);
-        g_set_error_literal (error,
-                             MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
-                             "Could not parse scan results");
-        return NULL;
-    }
-
-    /* If we didn't get any hits, try the pre-UMTS format match */
-    if (!g_regex_match (r, reply, 0, &match_info)) {
-        g_regex_unref (r);
-        g_match_info_free (match_info);
-        match_info = NULL;
-
-        /* Pre-UMTS format doesn't include the cell access technology after
-         * the numeric operator element.
-         *
-         * Ex: Motorola C-series (BUSlink SCWi275u) like so:
-         *
-         *       +COPS: (2,"T-Mobile","","310260"),(0,"Cingular Wireless","","310410")
-         */
-
-        /* Quirk: Some Nokia phones (N80) don't send the quotes for empty values:
-         *
-         *       +COPS: (2,"T - Mobile",,"31026"),(1,"Einstein PCS",,"31064"),(1,"Cingular",,"31041"),,(0,1,3),(0,2)
-         */
-
-        r = g_regex_new ("\\((\\d),([^,\\)]*),([^,\\)]*),([^\\)]*)\\)", G_REGEX_UNGREEDY, 0, &inner_error);
-        if (inner_error) {
-            mm_err ("Invalid regular expression: %s", inner_error->message);
-            g_error_free (inner_error);
-            g_set_error_literal (error,
-                                 MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
-                                 "Could not parse scan results");
-            return NULL;
-        }
-
-        g_regex_match (r, reply, 0, &match_info);
-        umts_format = FALSE;
-    }
-
-    /* Parse the results */
-    while (g_match_info_matches (match_info)) {
-        MM3gppNetworkInfo *info;
-        gchar *tmp;
-        gboolean valid = FALSE;
-
-        info = g_new0 (MM3gppNetworkInfo, 1);
-
-        tmp = mm_get_string_unquoted_from_match_info (match_info, 1);
-        info->status = parse_network_status (tmp);
-        g_free (tmp);
-
-        info->operator_long = mm_get_string_unquoted_from_match_info (match_info, 2);
-        info->operator_short = mm_get_string_unquoted_from_match_info (match_info, 3);
-        info->operator_code = mm_get_string_unquoted_from_match_info (match_info, 4);
-
-        /* Only try for access technology with UMTS-format matches.
-         * If none give, assume GSM */
-        tmp = (umts_format ?
-               mm_get_string_unquoted_from_match_info (match_info, 5) :
-               NULL);
-        info->access_tech = (tmp ?
-                             parse_access_tech (tmp) :
-                             MM_MODEM_ACCESS_TECHNOLOGY_GSM);
-        g_free (tmp);
-
-        /* If the operator number isn't valid (ie, at least 5 digits),
-         * ignore the scan result; it's probably the parameter stuff at the
-         * end of the +COPS response.  The regex will sometimes catch this
-         * but there's no good way to ignore it.
-         */
-        if (info->operator_code && (strlen (info->operator_code) >= 5)) {
-            valid = TRUE;
-            tmp = info->operator_code;
-            while (*tmp) {
-                if (!isdigit (*tmp) && (*tmp != '-')) {
-                    valid = FALSE;
-                    break;
-                }
-                tmp++;
-            }
-        }
-
-        if (valid) {
-            gchar *access_tech_str;
-
-            access_tech_str = mm_modem_access_technology_build_string_from_mask (info->access_tech);
-            mm_dbg ("Found network '%s' ('%s','%s'); availability: %s, access tech: %s",
-                    info->operator_code,
-                    info->operator_short ? info->operator_short : "no short name",
-                    info->operator_long ? info->operator_long : "no long name",
-                    mm_modem_3gpp_network_availability_get_string (info->status),
-                    access_tech_str);
-            g_free (access_tech_str);
-
-            info_list = g_list_prepend (info_list, info);
-        }
-        else
-            mm_3gpp_network_info_free (info);
-
-        g_match_info_next (match_info, NULL);
-    }
-
-    g_match_info_free (match_info);
-    g_regex_unref (r);
-
-    return info_list;
+    start = cursor;
+    mm_at_cursor_foreach_tuple (&cursor,
+                                &cops_grammar,
+                                &tuple,
+                                (MMAtTupleFn) cops_tuple_check_format,
+                                &ctx);
+
+    cursor = start;
+    mm_at_cursor_foreach_tuple (&cursor,
+                                &cops_grammar,
+                                &tuple,
+                                (MMAtTupleFn) cops_tuple_add,
+                                &ctx);
+
+    return ctx.info_list;
 }
 
 /*************************************************************************/
@@ -609,66 +534,68 @@ mm_3gpp_pdp_context_cmp (MM3gppPdpContext *a,
     return (a->cid - b->cid);
 }
 
+typedef struct {
+    guint cid;
+    MMAtSpan pdp_type;
+    MMAtSpan apn;
+} CgdcontLine;
+
+static const MMAtField cgdcont_fields[] = {
+    MM_AT_FIELD (MM_AT_FIELD_UINT,   CgdcontLine, cid),
+    MM_AT_FIELD (MM_AT_FIELD_STRING, CgdcontLine, pdp_type),
+    MM_AT_FIELD (MM_AT_FIELD_STRING, CgdcontLine, apn)
+};
+
+static const MMAtGrammar cgdcont_grammar = MM_AT_GRAMMAR (cgdcont_fields, CgdcontLine);
+
+static gboolean
+cgdcont_line_add (CgdcontLine *line,
+                  guint n_fields,
+                  GList **list)
+{
+    gchar pdp_type[16];
+    MMBearerIpFamily ip_family = MM_BEARER_IP_FAMILY_UNKNOWN;
+    MM3gppPdpContext *pdp;
+
+    if (n_fields < G_N_ELEMENTS (cgdcont_fields))
+        return TRUE;
+
+    if (mm_at_span_copy (&line->pdp_type, pdp_type, sizeof (pdp_type)))
+        ip_family = mm_3gpp_get_ip_family_from_pdp_type (pdp_type);
+    if (ip_family == MM_BEARER_IP_FAMILY_UNKNOWN) {
+        mm_dbg ("Ignoring PDP context type: '%.*s'",
+                (gint) line->pdp_type.len, line->pdp_type.str);
+        return TRUE;
+    }
+
+    pdp = g_slice_new0 (MM3gppPdpContext);
+    pdp->cid = line->cid;
+    pdp->pdp_type = ip_family;
+    pdp->apn = mm_at_span_dup (&line->apn);
+
+    *list = g_list_prepend (*list, pdp);
+    return TRUE;
+}
+
 GList *
 mm_3gpp_parse_cgdcont_read_response (const gchar *reply,
                                      GError **error)
 {
-    GError *inner_error = NULL;
-    GRegex *r;
-    GMatchInfo *match_info;
-    GList *list;
+    MMAtCursor cursor;
+    CgdcontLine line;
+    GList *list = NULL;
 
     if (!reply[0])
         /* No APNs configured, all done */
         return NULL;
 
-    list = NULL;
-    r = g_regex_new ("\\+CGDCONT:\\s*(\\d+)\\s*,([^,\\)]*),([^,\\)]*),([^,\\)]*)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                     0, &inner_error);
-    if (r) {
-        g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &inner_error);
-
-        while (!inner_error &&
-               g_match_info_matches (match_info)) {
-            gchar *str;
-            MMBearerIpFamily ip_family;
-
-            str = mm_get_string_unquoted_from_match_info (match_info, 2);
-            ip_family = mm_3gpp_get_ip_family_from_pdp_type (str);
-            if (ip_family == MM_BEARER_IP_FAMILY_UNKNOWN)
-                mm_dbg ("Ignoring PDP context type: '%s'", str);
-            else {
-                MM3gppPdpContext *pdp;
-
-                pdp = g_slice_new0 (MM3gppPdpContext);
-                if (!mm_get_uint_from_match_info (match_info, 1, &pdp->cid)) {
-                    inner_error = g_error_new (MM_CORE_ERROR,
-                                               MM_CORE_ERROR_FAILED,
-                                               "Couldn't parse CID from reply: '%s'",
-                                               reply);
-                    break;
-                }
-                pdp->pdp_type = ip_family;
-                pdp->apn = mm_get_string_unquoted_from_match_info (match_info, 3);
-
-                list = g_list_prepend (list, pdp);
-            }
-
-            g_free (str);
-            g_match_info_next (match_info, &inner_error);
-        }
-
-        g_match_info_free (match_info);
-        g_regex_unref (r);
-    }
-
-    if (inner_error) {
-        mm_3gpp_pdp_context_list_free (list);
-        g_propagate_error (error, inner_error);
-        g_prefix_error (error, "Couldn't properly parse list of PDP contexts. ");
-        return NULL;
-    }
+    mm_at_cursor_init (&cursor, reply, -1);
+    mm_at_cursor_foreach_line (&cursor,
+                               "+CGDCONT:",
+                               &cgdcont_grammar,
+                               &line,
+                               (MMAtTupleFn) cgdcont_line_add,
+                               &list);
 
     list = g_list_sort (list, (GCompareFunc)mm_3gpp_pdp_context_cmp);
 
@@ -677,43 +604,259 @@ mm_3gpp_parse_cgdcont_read_response (const gchar *reply,
 
 /*************************************************************************/
 
-static gulong
-parse_uint (char *str, int base, glong nmin, glong nmax, gboolean *valid)
+typedef struct {
+    const gchar *str;
+    gsize len;
+} CregToken;
+
+/* <n>,<stat>,<lac>,<ci>,<AcT>,<rac> is the longest layout we care about;
+ * anything after that (e.g. reject causes) is ignored */
+#define CREG_MAX_TOKENS 6
+
+static gboolean
+creg_token_is_digits (const CregToken *token)
 {
-    gulong ret = 0;
-    gchar *endquote;
+    gsize i;
 
-    *valid = FALSE;
-    if (!str)
-        return 0;
+    if (!token->len)
+        return FALSE;
+    for (i = 0; i < token->len; i++) {
+        if (!g_ascii_isdigit (token->str[i]))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean
+creg_token_is_stat (const CregToken *token)
+{
+    gsize i = 0;
+
+    /* A <stat> will always be a single digit, without quotes, but may come
+     * with leading zeros (e.g. Iridium's '+CREG:002,001,...') */
+    if (!creg_token_is_digits (token))
+        return FALSE;
+    while (i < token->len - 1 && token->str[i] == '0')
+        i++;
+    return (token->len - i == 1);
+}
+
+static gboolean
+creg_token_to_ulong (const CregToken *token,
+                     guint base,
+                     gulong nmin,
+                     gulong nmax,
+                     gulong *out)
+{
+    gchar buf[16];
+    const gchar *str = token->str;
+    const gchar *endquote;
+    gsize len = token->len;
+    gulong value;
 
     /* Strip quotes */
-    if (str[0] == '"')
+    if (len && str[0] == '"') {
         str++;
-    endquote = strchr (str, '"');
+        len--;
+    }
+    endquote = memchr (str, '"', len);
     if (endquote)
-        *endquote = '\0';
+        len = endquote - str;
 
-    if (strlen (str)) {
-        ret = strtol (str, NULL, base);
-        if ((nmin == nmax) || (ret >= nmin && ret <= nmax))
-            *valid = TRUE;
+    if (!len || len >= sizeof (buf))
+        return FALSE;
+
+    memcpy (buf, str, len);
+    buf[len] = '\0';
+    value = strtoul (buf, NULL, base);
+    if (value < nmin || value > nmax)
+        return FALSE;
+
+    *out = value;
+    return TRUE;
+}
+
+gboolean
+mm_3gpp_creg_tokenize (const gchar *str,
+                       gssize len,
+                       MM3gppCregFields *fields)
+{
+    CregToken tokens[CREG_MAX_TOKENS];
+    const gchar *p;
+    const gchar *end;
+    const gchar *start;
+    guint n_tokens = 0;
+    gint in = -1, istat, ilac = -1, ici = -1, iact = -1, irac = -1;
+    gulong value;
+
+    g_return_val_if_fail (str != NULL, FALSE);
+    g_return_val_if_fail (fields != NULL, FALSE);
+
+    if (len < 0)
+        len = strlen (str);
+    end = str + len;
+
+    memset (fields, 0, sizeof (MM3gppCregFields));
+    fields->n = -1;
+    fields->act = -1;
+    fields->rac = -1;
+
+    /* Find the +CREG:, +CGREG: or +CEREG: prefix */
+    for (p = str; p < end; p++) {
+        if (p[0] != '+')
+            continue;
+        if (end - p >= 6 && memcmp (p, "+CREG:", 6) == 0) {
+            p += 6;
+            break;
+        }
+        if (end - p >= 7 && memcmp (p, "+CGREG:", 7) == 0) {
+            fields->cgreg = TRUE;
+            p += 7;
+            break;
+        }
+        if (end - p >= 7 && memcmp (p, "+CEREG:", 7) == 0) {
+            fields->cgreg = TRUE;
+            fields->cereg = TRUE;
+            p += 7;
+            break;
+        }
+    }
+    if (p >= end)
+        return FALSE;
+
+    /* Split the rest of the line in comma separated, trimmed, tokens */
+    for (start = p; ; p++) {
+        if (p < end && *p != ',' && *p != '\r' && *p != '\n')
+            continue;
+
+        if (n_tokens < CREG_MAX_TOKENS) {
+            const gchar *token_end = p;
+
+            while (start < token_end && g_ascii_isspace (*start))
+                start++;
+            while (token_end > start && g_ascii_isspace (token_end[-1]))
+                token_end--;
+            tokens[n_tokens].str = start;
+            tokens[n_tokens].len = token_end - start;
+        }
+        n_tokens++;
+
+        if (p == end || *p != ',')
+            break;
+        start = p + 1;
+    }
+
+    /* Normally the number of tokens could be used to determine what each
+     * one is, but there is overlap once the LAC and CI are given.
+     */
+    switch (n_tokens) {
+    case 1:
+        /* CREG=1: +CREG: <stat> */
+        istat = 0;
+        break;
+    case 2:
+        /* Solicited response: +CREG: <n>,<stat> */
+        in = 0;
+        istat = 1;
+        break;
+    case 3:
+        /* CREG=2 (GSM 07.07): +CREG: <stat>,<lac>,<ci> */
+        istat = 0;
+        ilac = 1;
+        ici = 2;
+        break;
+    default:
+        /* CREG=2 (ETSI 27.007):            +CREG: <stat>,<lac>,<ci>,<AcT>
+         * CREG=2 (unsolicited with RAC):   +CREG: <stat>,<lac>,<ci>,<AcT>,<RAC>
+         * CREG=2 (solicited):              +CREG: <n>,<stat>,<lac>,<ci>[,<AcT>]
+         * CREG=2 (Samsung Wave S8500):     +CREG: <n>,<stat>,<lac>,<ci>,<AcT?>,<something>
+         *
+         * Check if the second item is the LAC to distinguish the cases.
+         */
+        if (!creg_token_is_stat (&tokens[1])) {
+            istat = 0;
+            ilac = 1;
+            ici = 2;
+            iact = 3;
+            if (n_tokens > 4)
+                irac = 4;
+        } else {
+            in = 0;
+            istat = 1;
+            ilac = 2;
+            ici = 3;
+            if (n_tokens > 4)
+                iact = 4;
+            if (n_tokens > 5)
+                irac = 5;
+        }
+        break;
     }
-    return *valid ? (guint) ret : 0;
+
+    /* Status is the only mandatory item, <n> must be a number if given */
+    if (!creg_token_is_digits (&tokens[istat]) ||
+        !creg_token_to_ulong (&tokens[istat], 10, 0, G_MAXINT, &value) ||
+        (in >= 0 && !creg_token_is_digits (&tokens[in])))
+        return FALSE;
+    fields->stat = (gint) value;
+
+    if (in >= 0 && creg_token_to_ulong (&tokens[in], 10, 0, G_MAXINT, &value))
+        fields->n = (gint) value;
+
+    /* FIXME: some phones apparently swap the LAC bytes (LG, SonyEricsson,
+     * Sagem).  Need to handle that.
+     */
+    if (ilac >= 0)
+        creg_token_to_ulong (&tokens[ilac], 16, 1, 0xFFFF, &fields->lac);
+
+    if (ici >= 0)
+        creg_token_to_ulong (&tokens[ici], 16, 1, 0x0FFFFFFE, &fields->ci);
+
+    if (iact >= 0 && creg_token_to_ulong (&tokens[iact], 10, 0, 7, &value))
+        fields->act = (gint) value;
+
+    if (irac >= 0 && creg_token_to_ulong (&tokens[irac], 16, 0, 0xFF, &value))
+        fields->rac = (gint) value;
+
+    return TRUE;
 }
 
 static gboolean
-item_is_lac_not_stat (GMatchInfo *info, guint32 item)
+creg_fields_parse (const MM3gppCregFields *fields,
+                   MMModem3gppRegistrationState *out_reg_state,
+                   gulong *out_lac,
+                   gulong *out_ci,
+                   MMModemAccessTechnology *out_act,
+                   gboolean *out_cgreg,
+                   GError **error)
 {
-    gchar *str;
-    gboolean is_lac = FALSE;
+    g_return_val_if_fail (out_reg_state != NULL, FALSE);
+    g_return_val_if_fail (out_lac != NULL, FALSE);
+    g_return_val_if_fail (out_ci != NULL, FALSE);
+    g_return_val_if_fail (out_act != NULL, FALSE);
+    g_return_val_if_fail (out_cgreg != NULL, FALSE);
 
-    /* A <stat> will always be a single digit, without quotes */
-    str = g_match_info_fetch (info, item);
-    g_assert (str);
-    is_lac = (strchr (str, '"') || strlen (str) > 1);
-    g_free (str);
-    return is_lac;
+    /* 'roaming' is the last valid state */
+    if (fields->stat > MM_MODEM_3GPP_REGISTRATION_STATE_ROAMING) {
+        g_set_error (error,
+                     MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Registration State '%d' is unknown",
+                     fields->stat);
+        return FALSE;
+    }
+
+    if (fields->cgreg)
+        *out_cgreg = TRUE;
+
+    *out_reg_state = (MMModem3gppRegistrationState) fields->stat;
+    if (fields->stat != MM_MODEM_3GPP_REGISTRATION_STATE_UNKNOWN) {
+        /* Don't fill in lac/ci/act if the device's state is unknown */
+        *out_lac = fields->lac;
+        *out_ci = fields->ci;
+
+        *out_act = get_mm_access_tech_from_etsi_access_tech (fields->act);
+    }
+    return TRUE;
 }
 
 gboolean
@@ -725,126 +868,58 @@ mm_3gpp_parse_creg_response (GMatchInfo *info,
                              gboolean *out_cgreg,
                              GError **error)
 {
-    gboolean success = FALSE, foo;
-    gint n_matches, act = -1;
-    gulong stat = 0, lac = 0, ci = 0;
-    guint istat = 0, ilac = 0, ici = 0, iact = 0;
-    gchar *str;
+    MM3gppCregFields fields;
+    gint start = 0, end = 0;
 
     g_return_val_if_fail (info != NULL, FALSE);
-    g_return_val_if_fail (out_reg_state != NULL, FALSE);
-    g_return_val_if_fail (out_lac != NULL, FALSE);
-    g_return_val_if_fail (out_ci != NULL, FALSE);
-    g_return_val_if_fail (out_act != NULL, FALSE);
-    g_return_val_if_fail (out_cgreg != NULL, FALSE);
-
-    str = g_match_info_fetch (info, 1);
-    if (str && strstr (str, "CGREG"))
-        *out_cgreg = TRUE;
-    g_free (str);
 
-    /* Normally the number of matches could be used to determine what each
-     * item is, but we have overlap in one case.
-     */
-    n_matches = g_match_info_get_match_count (info);
-    if (n_matches == 3) {
-        /* CREG=1: +CREG: <stat> */
-        istat = 2;
-    } else if (n_matches == 4) {
-        /* Solicited response: +CREG: <n>,<stat> */
-        istat = 3;
-    } else if (n_matches == 5) {
-        /* CREG=2 (GSM 07.07): +CREG: <stat>,<lac>,<ci> */
-        istat = 2;
-        ilac = 3;
-        ici = 4;
-    } else if (n_matches == 6) {
-        /* CREG=2 (ETSI 27.007): +CREG: <stat>,<lac>,<ci>,<AcT>
-         * CREG=2 (non-standard): +CREG: <n>,<stat>,<lac>,<ci>
-         */
-
-        /* Check if the third item is the LAC to distinguish the two cases */
-        if (item_is_lac_not_stat (info, 3)) {
-            istat = 2;
-            ilac = 3;
-            ici = 4;
-            iact = 5;
-        } else {
-            istat = 3;
-            ilac = 4;
-            ici = 5;
-        }
-    } else if (n_matches == 7) {
-        /* CREG=2 (solicited):            +CREG: <n>,<stat>,<lac>,<ci>,<AcT>
-         * CREG=2 (unsolicited with RAC): +CREG: <stat>,<lac>,<ci>,<AcT>,<RAC>
-         */
-
-        /* Check if the third item is the LAC to distinguish the two cases */
-        if (item_is_lac_not_stat (info, 3)) {
-            istat = 2;
-            ilac = 3;
-            ici = 4;
-            iact = 5;
-        } else {
-            istat = 3;
-            ilac = 4;
-            ici = 5;
-            iact = 6;
-        }
-     }
-
-    /* Status */
-    str = g_match_info_fetch (info, istat);
-    stat = parse_uint (str, 10, 0, 5, &success);
-    g_free (str);
-    if (!success) {
+    if (!g_match_info_fetch_pos (info, 0, &start, &end) ||
+        !mm_3gpp_creg_tokenize (g_match_info_get_string (info) + start,
+                                end - start,
+                                &fields)) {
         g_set_error_literal (error,
                              MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
                              "Could not parse the registration status response");
         return FALSE;
     }
 
-    /* Location Area Code */
-    if (ilac) {
-        /* FIXME: some phones apparently swap the LAC bytes (LG, SonyEricsson,
-         * Sagem).  Need to handle that.
-         */
-        str = g_match_info_fetch (info, ilac);
-        lac = parse_uint (str, 16, 1, 0xFFFF, &foo);
-        g_free (str);
-    }
+    return creg_fields_parse (&fields,
+                              out_reg_state,
+                              out_lac,
+                              out_ci,
+                              out_act,
+                              out_cgreg,
+                              error);
+}
 
-    /* Cell ID */
-    if (ici) {
-        str = g_match_info_fetch (info, ici);
-        ci = parse_uint (str, 16, 1, 0x0FFFFFFE, &foo);
-        g_free (str);
-    }
+gboolean
+mm_3gpp_parse_creg_reply (const gchar *reply,
+                          MMModem3gppRegistrationState *out_reg_state,
+                          gulong *out_lac,
+                          gulong *out_ci,
+                          MMModemAccessTechnology *out_act,
+                          gboolean *out_cgreg,
+                          GError **error)
+{
+    MM3gppCregFields fields;
 
-    /* Access Technology */
-    if (iact) {
-        str = g_match_info_fetch (info, iact);
-        act = (gint) parse_uint (str, 10, 0, 7, &foo);
-        g_free (str);
-        if (!foo)
-            act = -1;
-    }
+    g_return_val_if_fail (reply != NULL, FALSE);
 
-    /* 'roaming' is the last valid state */
-    if (stat > MM_MODEM_3GPP_REGISTRATION_STATE_ROAMING) {
-        mm_warn ("Registration State '%lu' is unknown", stat);
-        stat = MM_MODEM_3GPP_REGISTRATION_STATE_UNKNOWN;
+    if (!mm_3gpp_creg_tokenize (reply, -1, &fields)) {
+        g_set_error (error,
+                     MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Unknown registration status response: '%s'",
+                     reply);
+        return FALSE;
     }
 
-    *out_reg_state = (MMModem3gppRegistrationState) stat;
-    if (stat != MM_MODEM_3GPP_REGISTRATION_STATE_UNKNOWN) {
-        /* Don't fill in lac/ci/act if the device's state is unknown */
-        *out_lac = lac;
-        *out_ci = ci;
-
-        *out_act = get_mm_access_tech_from_etsi_access_tech (act);
-    }
-    return TRUE;
+    return creg_fields_parse (&fields,
+                              out_reg_state,
+                              out_lac,
+                              out_ci,
+                              out_act,
+                              out_cgreg,
+                              error);
 }
 
 /*************************************************************************/
@@ -857,69 +932,51 @@ mm_3gpp_parse_cmgf_test_response (const gchar *reply,
                                   gboolean *sms_text_supported,
                                   GError **error)
 {
-    GRegex *r;
-    GMatchInfo *match_info;
-    gchar *s;
-    guint32 min = -1, max = -1;
+    MMAtCursor cursor;
+    MMAtRange range;
+    guint mode;
 
     /* Strip whitespace and response tag */
-    if (g_str_has_prefix (reply, CMGF_TAG))
-        reply += strlen (CMGF_TAG);
-    while (isspace (*reply))
-        reply++;
+    mm_at_cursor_init (&cursor, mm_strip_tag (reply, CMGF_TAG), -1);
 
-    r = g_regex_new ("\\(?\\s*(\\d+)\\s*[-,]?\\s*(\\d+)?\\s*\\)?", 0, 0, error);
-    if (!r)
-        return FALSE;
-
-    if (!g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, NULL)) {
+    /* Usually a range, "(0-1)" or "(0,1)", but some modems skip the
+     * parenthesis */
+    if (!mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_RANGE, &range)) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_FAILED,
                      "Failed to parse CMGF query result '%s'",
                      reply);
-        g_match_info_free (match_info);
-        g_regex_unref (r);
         return FALSE;
     }
-
-    s = g_match_info_fetch (match_info, 1);
-    if (s)
-        min = atoi (s);
-    g_free (s);
-
-    s = g_match_info_fetch (match_info, 2);
-    if (s)
-        max = atoi (s);
-    g_free (s);
+    while (mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_UINT, &mode))
+        range.max = MAX (range.max, mode);
 
     /* CMGF=0 for PDU mode */
-    *sms_pdu_supported = (min == 0);
+    *sms_pdu_supported = (range.min == 0);
 
     /* CMGF=1 for Text mode */
-    *sms_text_supported = (max >= 1);
+    *sms_text_supported = (range.max >= 1);
 
-    g_match_info_free (match_info);
-    g_regex_unref (r);
     return TRUE;
 }
 
 /*************************************************************************/
 
 static MMSmsStorage
-storage_from_str (const gchar *str)
+storage_from_span (const MMAtSpan *span)
 {
-    if (g_str_equal (str, "SM"))
+    if (mm_at_span_equal (span, "SM"))
         return MM_SMS_STORAGE_SM;
-    if (g_str_equal (str, "ME"))
+    if (mm_at_span_equal (span, "ME"))
         return MM_SMS_STORAGE_ME;
-    if (g_str_equal (str, "MT"))
+    if (mm_at_span_equal (span, "MT"))
         return MM_SMS_STORAGE_MT;
-    if (g_str_equal (str, "SR"))
+    if (mm_at_span_equal (span, "SR"))
         return MM_SMS_STORAGE_SR;
-    if (g_str_equal (str, "BM"))
+    if (mm_at_span_equal (span, "BM"))
         return MM_SMS_STORAGE_BM;
-    if (g_str_equal (str, "TA"))
+    if (mm_at_span_equal (span, "TA"))
         return MM_SMS_STORAGE_TA;
     return MM_SMS_STORAGE_UNKNOWN;
 }
@@ -930,9 +987,8 @@ mm_3gpp_parse_cpms_test_response (const gchar *reply,
                                   GArray **mem2,
                                   GArray **mem3)
 {
-    GRegex *r;
-    gchar **split;
-    guint i;
+    MMAtCursor cursor;
+    MMAtCursor group;
 
     g_assert (mem1 != NULL);
     g_assert (mem2 != NULL);
@@ -941,53 +997,32 @@ mm_3gpp_parse_cpms_test_response (const gchar *reply,
     /*
      * +CPMS: ("SM","ME"),("SM","ME"),("SM","ME")
      */
-    split = g_strsplit_set (mm_strip_tag (reply, "+CPMS:"), "()", -1);
-    if (!split)
-        return FALSE;
-
-    r = g_regex_new ("\\s*\"([^,\\)]+)\"\\s*", 0, 0, NULL);
-    g_assert (r);
-
-    for (i = 0; split[i]; i++) {
-        GMatchInfo *match_info;
+    mm_at_cursor_init (&cursor, mm_strip_tag (reply, "+CPMS:"), -1);
 
-        /* Got a range group to match */
-        if (g_regex_match_full (r, split[i], strlen (split[i]), 0, 0, &match_info, NULL)) {
-            GArray *array = NULL;
+    while (*mem3 == NULL && mm_at_cursor_next_group (&cursor, &group)) {
+        GArray *array = NULL;
+        MMAtSpan span;
 
-            while (g_match_info_matches (match_info)) {
-                gchar *str;
+        while (mm_at_cursor_parse_value (&group, MM_AT_FIELD_STRING, &span)) {
+            MMSmsStorage storage;
 
-                str = g_match_info_fetch (match_info, 1);
-                if (str) {
-                    MMSmsStorage storage;
-
-                    if (!array)
-                        array = g_array_new (FALSE, FALSE, sizeof (MMSmsStorage));
-
-                    storage = storage_from_str (str);
-                    g_array_append_val (array, storage);
-                    g_free (str);
-                }
-
-                g_match_info_next (match_info, NULL);
-            }
+            if (!array)
+                array = g_array_new (FALSE, FALSE, sizeof (MMSmsStorage));
 
-            if (!*mem1)
-                *mem1 = array;
-            else if (!*mem2)
-                *mem2 = array;
-            else if (!*mem3)
-                *mem3 = array;
+            storage = storage_from_span (&span);
+            g_array_append_val (array, storage);
         }
-        g_match_info_free (match_info);
 
-        if (*mem3 != NULL)
-            break; /* once we got the last group, exit... */
-    }
+        if (!array)
+            continue;
 
-    g_strfreev (split);
-    g_regex_unref (r);
+        if (!*mem1)
+            *mem1 = array;
+        else if (!*mem2)
+            *mem2 = array;
+        else
+            *mem3 = array;
+    }
 
     g_warn_if_fail (*mem1 != NULL);
     g_warn_if_fail (*mem2 != NULL);
@@ -1003,9 +1038,9 @@ mm_3gpp_parse_cscs_test_response (const gchar *reply,
                                   MMModemCharset *out_charsets)
 {
     MMModemCharset charsets = MM_MODEM_CHARSET_UNKNOWN;
-    GRegex *r;
-    GMatchInfo *match_info;
-    gchar *p, *str;
+    MMAtCursor cursor;
+    MMAtSpan span;
+    const gchar *p;
     gboolean success = FALSE;
 
     g_return_val_if_fail (reply != NULL, FALSE);
@@ -1027,22 +1062,14 @@ mm_3gpp_parse_cscs_test_response (const gchar *reply,
     }
 
     /* Now parse each charset */
-    r = g_regex_new ("\\s*([^,\\)]+)\\s*", 0, 0, NULL);
-    if (!r)
-        return FALSE;
-
-    if (g_regex_match_full (r, p, strlen (p), 0, 0, &match_info, NULL)) {
-        while (g_match_info_matches (match_info)) {
-            str = g_match_info_fetch (match_info, 1);
-            charsets |= mm_modem_charset_from_string (str);
-            g_free (str);
+    mm_at_cursor_init (&cursor, p, -1);
+    while (mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_STRING, &span)) {
+        gchar charset[32];
 
-            g_match_info_next (match_info, NULL);
-            success = TRUE;
-        }
+        if (mm_at_span_copy (&span, charset, sizeof (charset)))
+            charsets |= mm_modem_charset_from_string (charset);
+        success = TRUE;
     }
-    g_match_info_free (match_info);
-    g_regex_unref (r);
 
     if (success)
         *out_charsets = charsets;
@@ -1056,8 +1083,9 @@ gboolean
 mm_3gpp_parse_clck_test_response (const gchar *reply,
                                   MMModem3gppFacility *out_facilities)
 {
-    GRegex *r;
-    GMatchInfo *match_info;
+    MMAtCursor cursor;
+    MMAtCursor group;
+    MMAtSpan span;
 
     g_return_val_if_fail (reply != NULL, FALSE);
     g_return_val_if_fail (out_facilities != NULL, FALSE);
@@ -1066,28 +1094,18 @@ mm_3gpp_parse_clck_test_response (const gchar *reply,
      *
      * +CLCK: ("SC","AO","AI","PN")
      */
-    reply = mm_strip_tag (reply, "+CLCK:");
+    mm_at_cursor_init (&cursor, mm_strip_tag (reply, "+CLCK:"), -1);
+    if (!mm_at_cursor_next_group (&cursor, &group))
+        group = cursor;
 
     /* Now parse each facility */
-    r = g_regex_new ("\\s*\"([^,\\)]+)\"\\s*", 0, 0, NULL);
-    g_assert (r != NULL);
-
     *out_facilities = MM_MODEM_3GPP_FACILITY_NONE;
-    if (g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, NULL)) {
-        while (g_match_info_matches (match_info)) {
-            gchar *str;
-
-            str = g_match_info_fetch (match_info, 1);
-            if (str) {
-                *out_facilities |= mm_3gpp_acronym_to_facility (str);
-                g_free (str);
-            }
+    while (mm_at_cursor_parse_value (&group, MM_AT_FIELD_STRING, &span)) {
+        gchar acronym[8];
 
-            g_match_info_next (match_info, NULL);
-        }
+        if (mm_at_span_copy (&span, acronym, sizeof (acronym)))
+            *out_facilities |= mm_3gpp_acronym_to_facility (acronym);
     }
-    g_match_info_free (match_info);
-    g_regex_unref (r);
 
     return (*out_facilities != MM_MODEM_3GPP_FACILITY_NONE);
 }
@@ -1098,80 +1116,132 @@ gboolean
 mm_3gpp_parse_clck_write_response (const gchar *reply,
                                    gboolean *enabled)
 {
-    GRegex *r;
-    GMatchInfo *match_info;
-    gboolean success = FALSE;
+    MMAtCursor cursor;
+    guint status;
 
     g_return_val_if_fail (reply != NULL, FALSE);
     g_return_val_if_fail (enabled != NULL, FALSE);
 
-    reply = mm_strip_tag (reply, "+CLCK:");
+    /* +CLCK: <status>[,<class1>[...]] */
+    mm_at_cursor_init (&cursor, mm_strip_tag (reply, "+CLCK:"), -1);
+    if (!mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_UINT, &status) ||
+        status > 1)
+        return FALSE;
 
-    r = g_regex_new ("\\s*([01])\\s*", 0, 0, NULL);
-    g_assert (r != NULL);
+    *enabled = (status == 1);
+    return TRUE;
+}
 
-    if (g_regex_match (r, reply, 0, &match_info)) {
-        gchar *str;
+/*************************************************************************/
 
-        str = g_match_info_fetch (match_info, 1);
-        if (str) {
-            /* We're trying to match either '0' or '1',
-             * so we don't expect any other thing */
-            if (*str == '0')
-                *enabled = FALSE;
-            else if (*str == '1')
-                *enabled = TRUE;
-            else
-                g_assert_not_reached ();
+typedef struct {
+    MMAtSpan alpha;
+    MMAtSpan number;
+    guint type;
+} CnumLine;
+
+static const MMAtField cnum_fields[] = {
+    MM_AT_FIELD (MM_AT_FIELD_STRING, CnumLine, alpha),
+    MM_AT_FIELD (MM_AT_FIELD_STRING, CnumLine, number),
+    MM_AT_FIELD (MM_AT_FIELD_UINT,   CnumLine, type)
+};
 
-            g_free (str);
-            success = TRUE;
-        }
-    }
-    g_match_info_free (match_info);
-    g_regex_unref (r);
+static const MMAtGrammar cnum_grammar = MM_AT_GRAMMAR (cnum_fields, CnumLine);
 
-    return success;
-}
+static gboolean
+cnum_line_add (CnumLine *line,
+               guint n_fields,
+               GArray **array)
+{
+    gchar *number;
 
-/*************************************************************************/
+    if (n_fields < G_N_ELEMENTS (cnum_fields) || !line->number.len)
+        return TRUE;
+
+    if (!*array)
+        *array = g_array_new (TRUE, TRUE, sizeof (gchar *));
+    number = mm_at_span_dup (&line->number);
+    g_array_append_val (*array, number);
+    return TRUE;
+}
 
 GStrv
 mm_3gpp_parse_cnum_exec_response (const gchar *reply,
                                   GError **error)
 {
     GArray *array = NULL;
-    GRegex *r;
-    GMatchInfo *match_info;
+    MMAtCursor cursor;
+    CnumLine line;
 
     /* Empty strings also return NULL list */
     if (!reply || !reply[0])
         return NULL;
 
-    r = g_regex_new ("\\+CNUM:\\s*((\"([^\"]|(\\\"))*\")|([^,]*)),\"(?<num>\\S+)\",\\d",
-                     G_REGEX_UNGREEDY, 0, NULL);
-    g_assert (r != NULL);
+    /* +CNUM: [<alpha>],<number>,<type> */
+    mm_at_cursor_init (&cursor, reply, -1);
+    mm_at_cursor_foreach_line (&cursor,
+                               "+CNUM:",
+                               &cnum_grammar,
+                               &line,
+                               (MMAtTupleFn) cnum_line_add,
+                               &array);
 
-    g_regex_match (r, reply, 0, &match_info);
-    while (g_match_info_matches (match_info)) {
-        gchar *number;
-
-        number = g_match_info_fetch_named (match_info, "num");
+    return (array ? (GStrv) g_array_free (array, FALSE) : NULL);
+}
 
-        if (number && number[0]) {
-            if (!array)
-                array = g_array_new (TRUE, TRUE, sizeof (gchar *));
-            g_array_append_val (array, number);
-        } else
-            g_free (number);
+/*************************************************************************/
 
-        g_match_info_next (match_info, NULL);
+gboolean
+mm_3gpp_parse_ctzv_ctze (const gchar *str,
+                         gint *out_offset,
+                         gint *out_dst_offset,
+                         GError **error)
+{
+    MMAtCursor cursor;
+    MMAtSpan span;
+    gchar buffer[8];
+    gchar *end;
+    gboolean ctze;
+    glong tz;
+    guint dst = 0;
+
+    /* +CTZV: <tz>
+     * +CTZE: <tz>,<dst>[,<time>]
+     */
+    mm_at_cursor_init (&cursor, str, -1);
+    ctze = mm_at_cursor_find (&cursor, "+CTZE:");
+    if (!ctze) {
+        mm_at_cursor_init (&cursor, str, -1);
+        if (!mm_at_cursor_find (&cursor, "+CTZV:"))
+            goto fail;
     }
 
-    g_match_info_free (match_info);
-    g_regex_unref (r);
+    /* Quarters of an hour, DST included; quoted or not, signed or not */
+    if (!mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_STRING, &span) ||
+        !mm_at_span_copy (&span, buffer, sizeof (buffer)))
+        goto fail;
+    tz = strtol (buffer, &end, 10);
+    if (end == buffer || *end != '\0' || tz < -48 || tz > 56)
+        goto fail;
+
+    /* Daylight saving time adjustment, in hours */
+    if (ctze &&
+        (!mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_UINT, &dst) || dst > 2))
+        goto fail;
+
+    if (out_offset)
+        *out_offset = tz * 15;
+    if (out_dst_offset)
+        *out_dst_offset = (ctze ? (gint)dst * 60 : -1);
+    return TRUE;
 
-    return (array ? (GStrv) g_array_free (array, FALSE) : NULL);
+fail:
+    g_set_error (error,
+                 MM_CORE_ERROR,
+                 MM_CORE_ERROR_FAILED,
+                 "Couldn't parse network timezone report '%s'",
+                 str);
+    return FALSE;
 }
 
 /*************************************************************************/
@@ -1184,22 +1254,21 @@ struct MM3gppCindResponse {
 };
 
 static MM3gppCindResponse *
-cind_response_new (const gchar *desc, guint idx, gint min, gint max)
+cind_response_new (const MMAtSpan *desc, guint idx, gint min, gint max)
 {
     MM3gppCindResponse *r;
     gchar *p;
+    gsize i;
 
     g_return_val_if_fail (desc != NULL, NULL);
-    g_return_val_if_fail (idx >= 0, NULL);
 
     r = g_malloc0 (sizeof (MM3gppCindResponse));
 
     /* Strip quotes */
-    r->desc = p = g_malloc0 (strlen (desc) + 1);
-    while (*desc) {
-        if (*desc != '"' && !isspace (*desc))
-            *p++ = tolower (*desc);
-        desc++;
+    r->desc = p = g_malloc0 (desc->len + 1);
+    for (i = 0; i < desc->len; i++) {
+        if (desc->str[i] != '"' && !isspace (desc->str[i]))
+            *p++ = tolower (desc->str[i]);
     }
 
     r->idx = idx;
@@ -1252,14 +1321,46 @@ mm_3gpp_cind_response_get_max (MM3gppCindResponse *r)
 
 #define CIND_TAG "+CIND:"
 
+typedef struct {
+    MMAtSpan desc;
+    MMAtRange range;
+} CindTuple;
+
+static const MMAtField cind_fields[] = {
+    MM_AT_FIELD (MM_AT_FIELD_STRING, CindTuple, desc),
+    MM_AT_FIELD (MM_AT_FIELD_RANGE,  CindTuple, range)
+};
+
+static const MMAtGrammar cind_grammar = MM_AT_GRAMMAR (cind_fields, CindTuple);
+
+typedef struct {
+    GHashTable *hash;
+    guint idx;
+} CindContext;
+
+static gboolean
+cind_tuple_add (CindTuple *tuple,
+                guint n_fields,
+                CindContext *ctx)
+{
+    MM3gppCindResponse *resp;
+
+    if (n_fields < G_N_ELEMENTS (cind_fields))
+        return TRUE;
+
+    resp = cind_response_new (&tuple->desc, ctx->idx++, tuple->range.min, tuple->range.max);
+    if (resp)
+        g_hash_table_insert (ctx->hash, g_strdup (resp->desc), resp);
+    return TRUE;
+}
+
 GHashTable *
 mm_3gpp_parse_cind_test_response (const gchar *reply,
                                   GError **error)
 {
-    GHashTable *hash;
-    GRegex *r;
-    GMatchInfo *match_info;
-    guint idx = 1;
+    MMAtCursor cursor;
+    CindContext ctx;
+    CindTuple tuple;
 
     g_return_val_if_fail (reply != NULL, NULL);
 
@@ -1269,45 +1370,18 @@ mm_3gpp_parse_cind_test_response (const gchar *reply,
     while (isspace (*reply))
         reply++;
 
-    r = g_regex_new ("\\(([^,]*),\\((\\d+)[-,](\\d+).*\\)", G_REGEX_UNGREEDY, 0, NULL);
-    if (!r) {
-        g_set_error_literal (error,
-                             MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
-                             "Could not parse scan results.");
-        return NULL;
-    }
-
-    hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) cind_response_free);
-
-    if (g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, NULL)) {
-        while (g_match_info_matches (match_info)) {
-            MM3gppCindResponse *resp;
-            gchar *desc, *tmp;
-            gint min = 0, max = 0;
-
-            desc = g_match_info_fetch (match_info, 1);
+    /* +CIND: ("service",(0-1)),("call",(0,1)),... */
+    ctx.hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) cind_response_free);
+    ctx.idx = 1;
 
-            tmp = g_match_info_fetch (match_info, 2);
-            min = atoi (tmp);
-            g_free (tmp);
+    mm_at_cursor_init (&cursor, reply, -1);
+    mm_at_cursor_foreach_tuple (&cursor,
+                                &cind_grammar,
+                                &tuple,
+                                (MMAtTupleFn) cind_tuple_add,
+                                &ctx);
 
-            tmp = g_match_info_fetch (match_info, 3);
-            max = atoi (tmp);
-            g_free (tmp);
-
-            resp = cind_response_new (desc, idx++, min, max);
-            if (resp)
-                g_hash_table_insert (hash, g_strdup (resp->desc), resp);
-
-            g_free (desc);
-
-            g_match_info_next (match_info, NULL);
-        }
-    }
-    g_match_info_free (match_info);
-    g_regex_unref (r);
-
-    return hash;
+    return ctx.hash;
 }
 
 /*************************************************************************/
@@ -1316,11 +1390,10 @@ GByteArray *
 mm_3gpp_parse_cind_read_response (const gchar *reply,
                                   GError **error)
 {
-    GByteArray *array = NULL;
-    GRegex *r = NULL;
-    GMatchInfo *match_info;
-    GError *inner_error = NULL;
+    GByteArray *array;
+    MMAtCursor cursor;
     guint8 t;
+    guint val;
 
     g_return_val_if_fail (reply != NULL, NULL);
 
@@ -1332,18 +1405,16 @@ mm_3gpp_parse_cind_read_response (const gchar *reply,
     }
 
     reply = mm_strip_tag (reply, CIND_TAG);
+    mm_at_cursor_init (&cursor, reply, -1);
 
-    r = g_regex_new ("(\\d+)[^0-9]+", G_REGEX_UNGREEDY, 0, NULL);
-    g_assert (r != NULL);
-
-    if (!g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, NULL)) {
+    if (mm_at_cursor_at_end (&cursor)) {
         g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
                      "Could not parse the +CIND response '%s': didn't match",
                      reply);
-        goto done;
+        return NULL;
     }
 
-    array = g_byte_array_sized_new (g_match_info_get_match_count (match_info));
+    array = g_byte_array_sized_new (16);
 
     /* Add a zero element so callers can use 1-based indexes returned by
      * mm_3gpp_cind_response_get_index().
@@ -1351,35 +1422,19 @@ mm_3gpp_parse_cind_read_response (const gchar *reply,
     t = 0;
     g_byte_array_append (array, &t, 1);
 
-    while (!inner_error &&
-           g_match_info_matches (match_info)) {
-        gchar *str;
-        guint val = 0;
-
-        str = g_match_info_fetch (match_info, 1);
-        if (mm_get_uint_from_str (str, &val) && val < 255) {
-            t = (guint8) val;
-            g_byte_array_append (array, &t, 1);
-        } else {
-            inner_error = g_error_new (MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
-                                       "Could not parse the +CIND response: invalid index '%s'",
-                                       str);
+    while (!mm_at_cursor_at_end (&cursor)) {
+        if (!mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_UINT, &val) || val >= 255) {
+            g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                         "Could not parse the +CIND response '%s': invalid index",
+                         reply);
+            g_byte_array_unref (array);
+            return NULL;
         }
 
-        g_free (str);
-        g_match_info_next (match_info, NULL);
+        t = (guint8) val;
+        g_byte_array_append (array, &t, 1);
     }
 
-    if (inner_error) {
-        g_propagate_error (error, inner_error);
-        g_byte_array_unref (array);
-        array = NULL;
-    }
-
-done:
-    g_match_info_free (match_info);
-    g_regex_unref (r);
-
     return array;
 }
 
@@ -1497,7 +1552,7 @@ mm_3gpp_parse_operator (const gchar *reply,
 		GMatchInfo *match_info;
 
 		reply += 7;
-		r = g_regex_new ("(\\d),(\\d),\"(.+)\"", G_REGEX_UNGREEDY, 0, NULL);
+		r = mm_regex_cache_get ("(\\d),(\\d),\"(.+)\"", G_REGEX_UNGREEDY, 0, NULL);
 		if (!r)
             return NULL;
 
@@ -1904,59 +1959,46 @@ mm_cdma_parse_crm_test_response (const gchar *reply,
                                  MMModemCdmaRmProtocol *max,
                                  GError **error)
 {
-    gboolean result = FALSE;
-    GRegex *r;
-
+    MMAtCursor cursor;
+    MMAtRange range;
 
     /* Expected reply format is:
      *   ---> AT+CRM=?
      *   <--- +CRM: (0-2)
      */
+    mm_at_cursor_init (&cursor, reply, -1);
+    if (!mm_at_cursor_find (&cursor, "+CRM:") ||
+        !mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_RANGE, &range)) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Couldn't parse CRM range: '%s'",
+                     reply);
+        return FALSE;
+    }
 
-    r = g_regex_new ("\\+CRM:\\s*\\((\\d+)-(\\d+)\\)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                     0, error);
-    if (r) {
-        GMatchInfo *match_info = NULL;
-
-        if (g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, error)) {
-            gchar *aux;
-            guint min_val = 0;
-            guint max_val = 0;
-
-            aux = g_match_info_fetch (match_info, 1);
-            min_val = (guint) atoi (aux);
-            g_free (aux);
-
-            aux = g_match_info_fetch (match_info, 2);
-            max_val = (guint) atoi (aux);
-            g_free (aux);
-
-            if (min_val == 0 ||
-                max_val == 0 ||
-                min_val >= max_val) {
-                g_set_error (error,
-                             MM_CORE_ERROR,
-                             MM_CORE_ERROR_FAILED,
-                             "Couldn't parse CRM range: "
-                             "Unexpected range of RM protocols (%u,%u)",
-                             min_val,
-                             max_val);
-            } else {
-                *min = mm_cdma_get_rm_protocol_from_index (min_val, error);
-                if (*min != MM_MODEM_CDMA_RM_PROTOCOL_UNKNOWN) {
-                    *max = mm_cdma_get_rm_protocol_from_index (max_val, error);
-                    if (*max != MM_MODEM_CDMA_RM_PROTOCOL_UNKNOWN)
-                        result = TRUE;
-                }
-            }
-        }
-
-        g_match_info_free (match_info);
-        g_regex_unref (r);
+    if (range.min == 0 ||
+        range.max == 0 ||
+        range.min >= range.max) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Couldn't parse CRM range: "
+                     "Unexpected range of RM protocols (%u,%u)",
+                     range.min,
+                     range.max);
+        return FALSE;
     }
 
-    return result;
+    *min = mm_cdma_get_rm_protocol_from_index (range.min, error);
+    if (*min == MM_MODEM_CDMA_RM_PROTOCOL_UNKNOWN)
+        return FALSE;
+
+    *max = mm_cdma_get_rm_protocol_from_index (range.max, error);
+    if (*max == MM_MODEM_CDMA_RM_PROTOCOL_UNKNOWN)
+        return FALSE;
+
+    return TRUE;
 }
 
 /*************************************************************************/
@@ -75,6 +75,7 @@ GRegex    *mm_3gpp_ciev_regex_get (void);
 GRegex    *mm_3gpp_cusd_regex_get (void);
 GRegex    *mm_3gpp_cmti_regex_get (void);
 GRegex    *mm_3gpp_cds_regex_get (void);
+GRegex    *mm_3gpp_ctz_regex_get (void); /* +CTZV and +CTZE */
 
 
 /* AT+COPS=? (network scan) response parser */
@@ -99,7 +100,23 @@ void mm_3gpp_pdp_context_list_free (GList *pdp_list);
 GList *mm_3gpp_parse_cgdcont_read_response (const gchar *reply,
                                             GError **error);
 
-/* CREG/CGREG response/unsolicited message parser */
+/* CREG/CGREG/CEREG tokenizer: finds the first registration message in the
+ * given string and splits its fields in a single pass */
+typedef struct {
+    gboolean cgreg; /* +CGREG or +CEREG, i.e. packet-switched domain */
+    gboolean cereg; /* +CEREG; the TAC is given in 'lac' */
+    gint n;         /* -1 if not given */
+    gint stat;
+    gulong lac;     /* 0 if not given or invalid */
+    gulong ci;      /* 0 if not given or invalid */
+    gint act;       /* ETSI <AcT>, -1 if not given */
+    gint rac;       /* -1 if not given */
+} MM3gppCregFields;
+gboolean mm_3gpp_creg_tokenize (const gchar *str,
+                                gssize len,
+                                MM3gppCregFields *fields);
+
+/* CREG/CGREG/CEREG response/unsolicited message parser */
 gboolean mm_3gpp_parse_creg_response (GMatchInfo *info,
                                       MMModem3gppRegistrationState *out_reg_state,
                                       gulong *out_lac,
@@ -107,6 +124,13 @@ gboolean mm_3gpp_parse_creg_response (GMatchInfo *info,
                                       MMModemAccessTechnology *out_act,
                                       gboolean *out_cgreg,
                                       GError **error);
+gboolean mm_3gpp_parse_creg_reply    (const gchar *reply,
+                                      MMModem3gppRegistrationState *out_reg_state,
+                                      gulong *out_lac,
+                                      gulong *out_ci,
+                                      MMModemAccessTechnology *out_act,
+                                      gboolean *out_cgreg,
+                                      GError **error);
 
 /* AT+CMGF=? (SMS message format) response parser */
 gboolean mm_3gpp_parse_cmgf_test_response (const gchar *reply,
@@ -136,6 +160,13 @@ gboolean mm_3gpp_parse_clck_write_response (const gchar *reply,
 GStrv mm_3gpp_parse_cnum_exec_response (const gchar *reply,
                                         GError **error);
 
+/* +CTZV/+CTZE (network timezone) unsolicited message parser. Offsets are
+ * given in minutes; +CTZV doesn't report DST, so 'out_dst_offset' is -1 */
+gboolean mm_3gpp_parse_ctzv_ctze (const gchar *str,
+                                  gint *out_offset,
+                                  gint *out_dst_offset,
+                                  GError **error);
+
 /* AT+CIND=? (Supported indicators) response parser */
 typedef struct MM3gppCindResponse MM3gppCindResponse;
 GHashTable  *mm_3gpp_parse_cind_test_response    (const gchar *reply,
@@ -41,11 +41,27 @@ G_DEFINE_TYPE_EXTENDED (MMPluginManager, mm_plugin_manager, G_TYPE_OBJECT, 0,
                         G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
                                                initable_iface_init));
 
+/* A plugin module found in the plugin directory. Modules exporting a manifest
+ * are only loaded once a port matches one of their filters. */
+typedef struct {
+    gchar *path;
+    gchar *name;
+    MMPlugin *plugin;
+    gboolean broken;
+} PluginEntry;
+
 struct _MMPluginManagerPrivate {
-    /* This list contains all plugins except for the generic one, order is not
-     * important. It is loaded once when the program starts, and the list is NOT
-     * expected to change after that.*/
-    GList *plugins;
+    /* This array contains all plugins except for the generic one, in the order
+     * they were found. It is built once when the program starts, and it is NOT
+     * expected to change after that. */
+    GPtrArray *entries;
+    /* Vendor ID, driver and udev tag to the list of entries which may support
+     * a port matching them */
+    GHashTable *vendor_index;
+    GHashTable *driver_index;
+    GHashTable *udev_tag_index;
+    /* Entries which cannot be indexed, and are tried on every port */
+    GList *wildcard;
     /* Last, the generic plugin. */
     MMPlugin *generic;
 };
@@ -453,6 +469,30 @@ port_probe_context_step (PortProbeContext *port_probe_ctx)
                              port_probe_ctx);
 }
 
+static MMPlugin *load_plugin (const gchar *path);
+
+static MMPlugin *
+plugin_entry_get_plugin (PluginEntry *entry)
+{
+    if (!entry->plugin && !entry->broken) {
+        entry->plugin = load_plugin (entry->path);
+        if (entry->plugin)
+            mm_info ("Loaded plugin '%s'", mm_plugin_get_name (entry->plugin));
+        else
+            entry->broken = TRUE;
+    }
+
+    return entry->plugin;
+}
+
+static void
+add_candidates (GHashTable *candidates,
+                GList *entries)
+{
+    for (; entries; entries = g_list_next (entries))
+        g_hash_table_insert (candidates, entries->data, entries->data);
+}
+
 static GList *
 build_plugins_list (MMPluginManager *self,
                     MMDevice *device,
@@ -460,23 +500,57 @@ build_plugins_list (MMPluginManager *self,
 {
     GList *list = NULL;
     GList *l;
+    GHashTable *candidates;
+    GHashTableIter iter;
+    gpointer key;
+    const gchar **drivers;
     gboolean supported_found = FALSE;
+    guint i;
+
+    /* Only the plugins whose filters may match this port are worth loading */
+    candidates = g_hash_table_new (g_direct_hash, g_direct_equal);
+    add_candidates (candidates, self->priv->wildcard);
+    add_candidates (candidates,
+                    g_hash_table_lookup (self->priv->vendor_index,
+                                         GUINT_TO_POINTER (mm_device_get_vendor (device))));
+    /* Virtual ports are matched with the 'virtual' driver */
+    add_candidates (candidates,
+                    g_hash_table_lookup (self->priv->driver_index, "virtual"));
+    drivers = mm_device_get_drivers (device);
+    for (i = 0; drivers && drivers[i]; i++)
+        add_candidates (candidates,
+                        g_hash_table_lookup (self->priv->driver_index, drivers[i]));
+    g_hash_table_iter_init (&iter, self->priv->udev_tag_index);
+    while (g_hash_table_iter_next (&iter, &key, (gpointer *)&l)) {
+        if (g_udev_device_get_property_as_boolean (port, (const gchar *)key))
+            add_candidates (candidates, l);
+    }
 
-    for (l = self->priv->plugins; l && !supported_found; l = g_list_next (l)) {
+    for (i = 0; i < self->priv->entries->len && !supported_found; i++) {
+        PluginEntry *entry;
+        MMPlugin *plugin;
         MMPluginSupportsHint hint;
 
-        hint = mm_plugin_discard_port_early (MM_PLUGIN (l->data), device, port);
+        entry = g_ptr_array_index (self->priv->entries, i);
+        if (!g_hash_table_lookup (candidates, entry))
+            continue;
+
+        plugin = plugin_entry_get_plugin (entry);
+        if (!plugin)
+            continue;
+
+        hint = mm_plugin_discard_port_early (plugin, device, port);
         switch (hint) {
         case MM_PLUGIN_SUPPORTS_HINT_UNSUPPORTED:
             /* Fully discard */
             break;
         case MM_PLUGIN_SUPPORTS_HINT_MAYBE:
             /* Maybe supported, add to tail of list */
-            list = g_list_append (list, g_object_ref (l->data));
+            list = g_list_append (list, g_object_ref (plugin));
             break;
         case MM_PLUGIN_SUPPORTS_HINT_LIKELY:
             /* Likely supported, add to head of list */
-            list = g_list_prepend (list, g_object_ref (l->data));
+            list = g_list_prepend (list, g_object_ref (plugin));
             break;
         case MM_PLUGIN_SUPPORTS_HINT_SUPPORTED:
             /* Really supported, clean existing list and add it alone */
@@ -484,7 +558,7 @@ build_plugins_list (MMPluginManager *self,
                 g_list_free_full (list, (GDestroyNotify)g_object_unref);
                 list = NULL;
             }
-            list = g_list_prepend (list, g_object_ref (l->data));
+            list = g_list_prepend (list, g_object_ref (plugin));
             /* This will end the loop as well */
             supported_found = TRUE;
             break;
@@ -493,6 +567,8 @@ build_plugins_list (MMPluginManager *self,
         }
     }
 
+    g_hash_table_unref (candidates);
+
     /* Add the generic plugin at the end of the list */
     if (self->priv->generic)
         list = g_list_append (list, g_object_ref (self->priv->generic));
@@ -606,47 +682,64 @@ mm_plugin_manager_find_device_support (MMPluginManager *self,
 
 /*****************************************************************************/
 
-static MMPlugin *
-load_plugin (const gchar *path)
+static GModule *
+open_plugin_module (const gchar *path,
+                    const gchar *path_display)
 {
-    MMPlugin *plugin = NULL;
     GModule *module;
-    MMPluginCreateFunc plugin_create_func;
     gint *major_plugin_version;
     gint *minor_plugin_version;
-    gchar *path_display;
-
-    /* Get printable UTF-8 string of the path */
-    path_display = g_filename_display_name (path);
 
     module = g_module_open (path, G_MODULE_BIND_LAZY);
     if (!module) {
         g_warning ("Could not load plugin '%s': %s", path_display, g_module_error ());
-        goto out;
+        return NULL;
     }
 
     if (!g_module_symbol (module, "mm_plugin_major_version", (gpointer *) &major_plugin_version)) {
         g_warning ("Could not load plugin '%s': Missing major version info", path_display);
-        goto out;
+        goto error;
     }
 
     if (*major_plugin_version != MM_PLUGIN_MAJOR_VERSION) {
         g_warning ("Could not load plugin '%s': Plugin major version %d, %d is required",
                    path_display, *major_plugin_version, MM_PLUGIN_MAJOR_VERSION);
-        goto out;
+        goto error;
     }
 
     if (!g_module_symbol (module, "mm_plugin_minor_version", (gpointer *) &minor_plugin_version)) {
         g_warning ("Could not load plugin '%s': Missing minor version info", path_display);
-        goto out;
+        goto error;
     }
 
     if (*minor_plugin_version != MM_PLUGIN_MINOR_VERSION) {
         g_warning ("Could not load plugin '%s': Plugin minor version %d, %d is required",
                    path_display, *minor_plugin_version, MM_PLUGIN_MINOR_VERSION);
-        goto out;
+        goto error;
     }
 
+    return module;
+
+error:
+    g_module_close (module);
+    return NULL;
+}
+
+static MMPlugin *
+load_plugin (const gchar *path)
+{
+    MMPlugin *plugin = NULL;
+    GModule *module;
+    MMPluginCreateFunc plugin_create_func;
+    gchar *path_display;
+
+    /* Get printable UTF-8 string of the path */
+    path_display = g_filename_display_name (path);
+
+    module = open_plugin_module (path, path_display);
+    if (!module)
+        goto out;
+
     if (!g_module_symbol (module, "mm_plugin_create", (gpointer *) &plugin_create_func)) {
         g_warning ("Could not load plugin '%s': %s", path_display, g_module_error ());
         goto out;
@@ -667,6 +760,144 @@ out:
     return plugin;
 }
 
+static void
+plugin_entry_free (PluginEntry *entry)
+{
+    if (entry->plugin)
+        g_object_unref (entry->plugin);
+    g_free (entry->name);
+    g_free (entry->path);
+    g_slice_free (PluginEntry, entry);
+}
+
+static void
+index_entry (GHashTable *index,
+             gpointer key,
+             gboolean copy_key,
+             PluginEntry *entry)
+{
+    gpointer orig_key;
+    GList *list = NULL;
+
+    /* The list is owned by the table, so steal it while updating it */
+    if (g_hash_table_lookup_extended (index, key, &orig_key, (gpointer *)&list))
+        g_hash_table_steal (index, key);
+    else
+        orig_key = copy_key ? g_strdup (key) : key;
+
+    if (!g_list_find (list, entry))
+        list = g_list_append (list, entry);
+    g_hash_table_insert (index, orig_key, list);
+}
+
+static void
+index_plugin (MMPluginManager *self,
+              PluginEntry *entry,
+              const MMPluginManifest *manifest)
+{
+    guint i;
+
+    /* Vendor and product IDs are only enough when the plugin doesn't also
+     * accept ports by vendor or product strings */
+    if ((manifest->vendor_ids || manifest->product_ids) &&
+        !manifest->vendor_strings &&
+        !manifest->product_strings &&
+        !manifest->forbidden_product_strings) {
+        /* When both are given both must match, so the vendor IDs suffice */
+        if (manifest->vendor_ids) {
+            for (i = 0; manifest->vendor_ids[i]; i++)
+                index_entry (self->priv->vendor_index,
+                             GUINT_TO_POINTER (manifest->vendor_ids[i]),
+                             FALSE,
+                             entry);
+        } else {
+            for (i = 0; manifest->product_ids[i].l; i++)
+                index_entry (self->priv->vendor_index,
+                             GUINT_TO_POINTER (manifest->product_ids[i].l),
+                             FALSE,
+                             entry);
+        }
+        return;
+    }
+
+    if (manifest->drivers) {
+        for (i = 0; manifest->drivers[i]; i++)
+            index_entry (self->priv->driver_index,
+                         (gpointer)manifest->drivers[i],
+                         TRUE,
+                         entry);
+        return;
+    }
+
+    if (manifest->udev_tags) {
+        for (i = 0; manifest->udev_tags[i]; i++)
+            index_entry (self->priv->udev_tag_index,
+                         (gpointer)manifest->udev_tags[i],
+                         TRUE,
+                         entry);
+        return;
+    }
+
+    /* Nothing to index by, e.g. only subsystem or forbidden driver filters */
+    self->priv->wildcard = g_list_append (self->priv->wildcard, entry);
+}
+
+static void
+add_plugin_entry (MMPluginManager *self,
+                  const gchar *path)
+{
+    PluginEntry *entry;
+    GModule *module;
+    const MMPluginManifest *manifest = NULL;
+    MMPlugin *plugin;
+    gchar *path_display;
+
+    /* Get printable UTF-8 string of the path */
+    path_display = g_filename_display_name (path);
+    module = open_plugin_module (path, path_display);
+    g_free (path_display);
+    if (!module)
+        return;
+
+    if (g_module_symbol (module, "mm_plugin_manifest", (gpointer *) &manifest) &&
+        manifest->name &&
+        !g_str_equal (manifest->name, MM_PLUGIN_GENERIC_NAME)) {
+        /* Index the plugin and unload the module until a port needs it; all
+         * the manifest contents used as keys are copied */
+        entry = g_slice_new0 (PluginEntry);
+        entry->path = g_strdup (path);
+        entry->name = g_strdup (manifest->name);
+        g_ptr_array_add (self->priv->entries, entry);
+        index_plugin (self, entry, manifest);
+        g_module_close (module);
+
+        mm_dbg ("Found plugin '%s'", entry->name);
+        return;
+    }
+
+    /* The generic plugin, and plugins without manifest, are loaded right away */
+    g_module_close (module);
+    plugin = load_plugin (path);
+    if (!plugin)
+        return;
+
+    mm_info ("Loaded plugin '%s'", mm_plugin_get_name (plugin));
+
+    if (g_str_equal (mm_plugin_get_name (plugin), MM_PLUGIN_GENERIC_NAME)) {
+        /* Generic plugin */
+        self->priv->generic = plugin;
+        return;
+    }
+
+    /* Vendor specific plugin, tried on every port */
+    entry = g_slice_new0 (PluginEntry);
+    entry->path = g_strdup (path);
+    entry->name = g_strdup (mm_plugin_get_name (plugin));
+    entry->plugin = plugin;
+    g_ptr_array_add (self->priv->entries, entry);
+    self->priv->wildcard = g_list_append (self->priv->wildcard, entry);
+}
+
 static gboolean
 load_plugins (MMPluginManager *self,
               GError **error)
@@ -699,26 +930,13 @@ load_plugins (MMPluginManager *self,
 
     while ((fname = g_dir_read_name (dir)) != NULL) {
         gchar *path;
-        MMPlugin *plugin;
 
         if (!g_str_has_suffix (fname, G_MODULE_SUFFIX))
             continue;
 
         path = g_module_build_path (PLUGINDIR, fname);
-        plugin = load_plugin (path);
+        add_plugin_entry (self, path);
         g_free (path);
-
-        if (!plugin)
-            continue;
-
-        mm_info ("Loaded plugin '%s'", mm_plugin_get_name (plugin));
-
-        if (g_str_equal (mm_plugin_get_name (plugin), MM_PLUGIN_GENERIC_NAME))
-            /* Generic plugin */
-            self->priv->generic = plugin;
-        else
-            /* Vendor specific plugin */
-            self->priv->plugins = g_list_append (self->priv->plugins, plugin);
     }
 
     /* Check the generic plugin once all looped */
@@ -726,7 +944,7 @@ load_plugins (MMPluginManager *self,
         mm_warn ("Generic plugin not loaded");
 
     /* Treat as error if we don't find any plugin */
-    if (!self->priv->plugins && !self->priv->generic) {
+    if (!self->priv->entries->len && !self->priv->generic) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_NO_PLUGINS,
@@ -735,8 +953,9 @@ load_plugins (MMPluginManager *self,
         goto out;
     }
 
-    mm_info ("Successfully loaded %u plugins",
-             g_list_length (self->priv->plugins) + !!self->priv->generic);
+    mm_info ("Successfully found %u plugins (%u loaded on demand)",
+             self->priv->entries->len + !!self->priv->generic,
+             self->priv->entries->len - g_list_length (self->priv->wildcard));
 
 out:
     if (dir)
@@ -744,7 +963,7 @@ out:
     g_free (plugindir_display);
 
     /* Return TRUE if at least one plugin found */
-    return (self->priv->plugins || self->priv->generic);
+    return (self->priv->entries->len || self->priv->generic);
 }
 
 MMPluginManager *
@@ -763,6 +982,20 @@ mm_plugin_manager_init (MMPluginManager *manager)
     manager->priv = G_TYPE_INSTANCE_GET_PRIVATE (manager,
                                                  MM_TYPE_PLUGIN_MANAGER,
                                                  MMPluginManagerPrivate);
+
+    manager->priv->entries = g_ptr_array_new_with_free_func ((GDestroyNotify)plugin_entry_free);
+    manager->priv->vendor_index = g_hash_table_new_full (g_direct_hash,
+                                                         g_direct_equal,
+                                                         NULL,
+                                                         (GDestroyNotify)g_list_free);
+    manager->priv->driver_index = g_hash_table_new_full (g_str_hash,
+                                                         g_str_equal,
+                                                         g_free,
+                                                         (GDestroyNotify)g_list_free);
+    manager->priv->udev_tag_index = g_hash_table_new_full (g_str_hash,
+                                                           g_str_equal,
+                                                           g_free,
+                                                           (GDestroyNotify)g_list_free);
 }
 
 static gboolean
@@ -779,10 +1012,27 @@ dispose (GObject *object)
 {
     MMPluginManager *self = MM_PLUGIN_MANAGER (object);
 
-    /* Cleanup list of plugins */
-    if (self->priv->plugins) {
-        g_list_free_full (self->priv->plugins, (GDestroyNotify)g_object_unref);
-        self->priv->plugins = NULL;
+    /* Cleanup list of plugins; the indexes point to the entries, so they go
+     * first */
+    if (self->priv->vendor_index) {
+        g_hash_table_unref (self->priv->vendor_index);
+        self->priv->vendor_index = NULL;
+    }
+    if (self->priv->driver_index) {
+        g_hash_table_unref (self->priv->driver_index);
+        self->priv->driver_index = NULL;
+    }
+    if (self->priv->udev_tag_index) {
+        g_hash_table_unref (self->priv->udev_tag_index);
+        self->priv->udev_tag_index = NULL;
+    }
+    if (self->priv->wildcard) {
+        g_list_free (self->priv->wildcard);
+        self->priv->wildcard = NULL;
+    }
+    if (self->priv->entries) {
+        g_ptr_array_unref (self->priv->entries);
+        self->priv->entries = NULL;
     }
     g_clear_object (&self->priv->generic);
 
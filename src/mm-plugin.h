@@ -26,6 +26,7 @@
 #include "mm-port.h"
 #include "mm-port-probe.h"
 #include "mm-device.h"
+#include "mm-private-boxed-types.h"
 
 #define MM_PLUGIN_GENERIC_NAME "Generic"
 #define MM_PLUGIN_MAJOR_VERSION 4
@@ -80,6 +81,25 @@ typedef struct _MMPluginPrivate MMPluginPrivate;
 
 typedef MMPlugin *(*MMPluginCreateFunc) (void);
 
+/* Filters of a plugin which can be checked without creating it. Plugin
+ * modules export them as 'mm_plugin_manifest', so that the plugin manager
+ * can index them at startup and only load the module once a port may need
+ * it. The arrays are the same ones given to the plugin properties; unused
+ * filters are left NULL. */
+typedef struct {
+    const gchar *name;
+    const gchar **subsystems;
+    const gchar **drivers;
+    const gchar **forbidden_drivers;
+    const guint16 *vendor_ids;
+    const mm_uint16_pair *product_ids;
+    const mm_uint16_pair *forbidden_product_ids;
+    const gchar **vendor_strings;
+    const mm_str_pair *product_strings;
+    const mm_str_pair *forbidden_product_strings;
+    const gchar **udev_tags;
+} MMPluginManifest;
+
 struct _MMPlugin {
     GObject parent;
     MMPluginPrivate *priv;
@@ -26,6 +26,7 @@
 
 #include "mm-port-probe.h"
 #include "mm-log.h"
+#include "mm-trace.h"
 #include "mm-at-serial-port.h"
 #include "mm-serial-port.h"
 #include "mm-serial-parsers.h"
@@ -72,6 +73,7 @@ typedef struct {
     GCancellable *cancellable;
     guint32 flags;
     guint source_id;
+    gint64 trace_start;
 
     /* ---- Serial probing specific context ---- */
 
@@ -316,6 +318,21 @@ port_probe_run_task_complete (PortProbeRunTask *task,
         task->buffer_full_id = 0;
     }
 
+    if (task->trace_start) {
+        MMPortProbe *self;
+        gchar *probed;
+
+        self = MM_PORT_PROBE (g_async_result_get_source_object (G_ASYNC_RESULT (task->result)));
+        probed = mm_port_probe_flag_build_string_from_mask (task->flags);
+        mm_trace_span ("probe",
+                       g_udev_device_get_name (self->priv->port),
+                       task->trace_start,
+                       error ? "probing failed" : "probing",
+                       probed);
+        g_free (probed);
+        g_object_unref (self);
+    }
+
     if (error)
         g_simple_async_result_take_error (task->result, error);
     else
@@ -1146,6 +1163,7 @@ mm_port_probe_run (MMPortProbe *self,
 
     /* Setup internal cancellable */
     task->cancellable = g_cancellable_new ();
+    task->trace_start = mm_trace_begin ();
 
     probe_list_str = mm_port_probe_flag_build_string_from_mask (task->flags);
     mm_info ("(%s/%s) launching port probing: '%s'",
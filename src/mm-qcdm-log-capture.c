@@ -0,0 +1,365 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <ModemManager.h>
+#include <mm-errors-types.h>
+
+#include "mm-qcdm-log-capture.h"
+#include "mm-log.h"
+#include "libqcdm/src/commands.h"
+#include "libqcdm/src/errors.h"
+#include "libqcdm/src/log-items.h"
+#include "libqcdm/src/log-capture.h"
+
+G_DEFINE_TYPE (MMQcdmLogCapture, mm_qcdm_log_capture, G_TYPE_OBJECT);
+
+/* Log codes are 0xEIII, with E the equipment ID */
+#define N_EQUIP_IDS 16
+#define FLUSH_TIMEOUT_SECS 5
+
+static const guint16 default_log_codes[] = {
+    DM_LOG_ITEM_CDMA_REVERSE_POWER_CONTROL,
+    DM_LOG_ITEM_EVDO_AIR_LINK_SUMMARY,
+    DM_LOG_ITEM_EVDO_POWER,
+    DM_LOG_ITEM_EVDO_PILOT_SETS_V2,
+    DM_LOG_ITEM_WCDMA_AGC_INFO,
+    DM_LOG_ITEM_WCDMA_RRC_STATE,
+    DM_LOG_ITEM_WCDMA_CELL_ID,
+    DM_LOG_ITEM_GSM_BURST_METRICS,
+    DM_LOG_ITEM_GSM_BCCH_MESSAGE,
+    0
+};
+
+struct _MMQcdmLogCapturePrivate {
+    MMQcdmSerialPort *port;
+    gchar *path;
+    QcdmCaptureWriter *writer;
+    guint flush_id;
+    gboolean write_failed;
+
+    /* 0-terminated log codes enabled, per equipment ID */
+    GArray *log_codes[N_EQUIP_IDS];
+};
+
+/*****************************************************************************/
+
+static void
+log_packet_received (MMQcdmSerialPort *port,
+                     guint16 log_code,
+                     guint64 timestamp,
+                     const guint8 *data,
+                     gsize len,
+                     MMQcdmLogCapture *self)
+{
+    int err;
+
+    if (self->priv->write_failed)
+        return;
+
+    err = qcdm_capture_writer_add (self->priv->writer,
+                                   log_code,
+                                   timestamp,
+                                   (const char *) data,
+                                   len);
+    if (err < 0) {
+        mm_warn ("(%s) couldn't write QCDM log packet: %d; capture stopped",
+                 self->priv->path, err);
+        self->priv->write_failed = TRUE;
+    }
+}
+
+static gboolean
+flush_cb (MMQcdmLogCapture *self)
+{
+    if (!self->priv->write_failed &&
+        qcdm_capture_writer_flush (self->priv->writer) < 0) {
+        mm_warn ("(%s) couldn't flush QCDM log capture; capture stopped",
+                 self->priv->path);
+        self->priv->write_failed = TRUE;
+    }
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+static void
+log_config_ready (MMQcdmSerialPort *port,
+                  GByteArray *response,
+                  GError *error,
+                  gpointer user_data)
+{
+    QcdmResult *result;
+    gint err = QCDM_SUCCESS;
+    guint equip_id = GPOINTER_TO_UINT (user_data);
+
+    if (error) {
+        mm_dbg ("Couldn't set QCDM log mask for equipment ID %u: %s",
+                equip_id, error->message);
+        return;
+    }
+
+    result = qcdm_cmd_log_config_set_mask_result ((const gchar *) response->data,
+                                                  response->len,
+                                                  &err);
+    if (!result) {
+        mm_dbg ("Couldn't set QCDM log mask for equipment ID %u: %d",
+                equip_id, err);
+        return;
+    }
+    qcdm_result_unref (result);
+}
+
+/* 'log_codes' may be NULL to disable all log codes of the equipment ID */
+static void
+set_log_mask (MMQcdmSerialPort *port,
+              guint equip_id,
+              GArray *log_codes)
+{
+    GByteArray *cmd;
+
+    cmd = g_byte_array_sized_new (600);
+    cmd->len = qcdm_cmd_log_config_set_mask_new ((char *) cmd->data,
+                                                 600,
+                                                 equip_id,
+                                                 log_codes ? (u_int16_t *) log_codes->data : NULL);
+    if (!cmd->len) {
+        g_byte_array_unref (cmd);
+        return;
+    }
+
+    /* The callback mustn't use the capture, which may be gone by then */
+    mm_qcdm_serial_port_queue_command (port,
+                                       cmd,
+                                       3,
+                                       NULL,
+                                       log_config_ready,
+                                       GUINT_TO_POINTER (equip_id));
+}
+
+static gboolean
+parse_log_codes (MMQcdmLogCapture *self,
+                 const gchar *str,
+                 GError **error)
+{
+    GArray *codes;
+    guint i;
+
+    codes = g_array_new (FALSE, FALSE, sizeof (guint16));
+    if (!str)
+        g_array_append_vals (codes, default_log_codes, G_N_ELEMENTS (default_log_codes) - 1);
+    else {
+        gchar **split;
+
+        split = g_strsplit (str, ",", -1);
+        for (i = 0; split[i]; i++) {
+            gchar *end = NULL;
+            guint64 code;
+            guint16 code16;
+
+            g_strstrip (split[i]);
+            if (!split[i][0])
+                continue;
+
+            code = g_ascii_strtoull (split[i], &end, 16);
+            if (!end || *end || code == 0 || code > 0xFFFF) {
+                g_set_error (error,
+                             MM_CORE_ERROR,
+                             MM_CORE_ERROR_INVALID_ARGS,
+                             "Invalid QCDM log code '%s'",
+                             split[i]);
+                g_strfreev (split);
+                g_array_unref (codes);
+                return FALSE;
+            }
+            code16 = code;
+            g_array_append_val (codes, code16);
+        }
+        g_strfreev (split);
+    }
+
+    for (i = 0; i < codes->len; i++) {
+        guint16 code = g_array_index (codes, guint16, i);
+        guint equip_id = code >> 12;
+
+        if (!self->priv->log_codes[equip_id])
+            self->priv->log_codes[equip_id] = g_array_new (TRUE, TRUE, sizeof (guint16));
+        g_array_append_val (self->priv->log_codes[equip_id], code);
+    }
+    g_array_unref (codes);
+
+    for (i = 0; i < N_EQUIP_IDS; i++) {
+        if (self->priv->log_codes[i])
+            return TRUE;
+    }
+
+    g_set_error_literal (error,
+                         MM_CORE_ERROR,
+                         MM_CORE_ERROR_INVALID_ARGS,
+                         "No QCDM log codes given");
+    return FALSE;
+}
+
+MMQcdmLogCapture *
+mm_qcdm_log_capture_new (MMQcdmSerialPort *port,
+                         const gchar *directory,
+                         const gchar *log_codes,
+                         GError **error)
+{
+    MMQcdmLogCapture *self;
+    gchar *filename;
+    guint i;
+    int err = 0;
+
+    g_return_val_if_fail (MM_IS_QCDM_SERIAL_PORT (port), NULL);
+    g_return_val_if_fail (directory != NULL, NULL);
+
+    self = g_object_new (MM_TYPE_QCDM_LOG_CAPTURE, NULL);
+
+    if (!parse_log_codes (self, log_codes, error)) {
+        g_object_unref (self);
+        return NULL;
+    }
+
+    /* Captures of the same port get appended to */
+    filename = g_strdup_printf ("%s.qcdm", mm_port_get_device (MM_PORT (port)));
+    self->priv->path = g_build_filename (directory, filename, NULL);
+    g_free (filename);
+
+    self->priv->writer = qcdm_capture_writer_open (self->priv->path, &err);
+    if (!self->priv->writer) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Couldn't open QCDM log capture '%s': %d",
+                     self->priv->path, err);
+        g_object_unref (self);
+        return NULL;
+    }
+
+    if (!mm_serial_port_open (MM_SERIAL_PORT (port), error)) {
+        g_object_unref (self);
+        return NULL;
+    }
+    self->priv->port = g_object_ref (port);
+
+    mm_qcdm_serial_port_set_log_handler (port,
+                                         (MMQcdmSerialLogFn)log_packet_received,
+                                         self,
+                                         NULL);
+    for (i = 0; i < N_EQUIP_IDS; i++) {
+        if (self->priv->log_codes[i])
+            set_log_mask (port, i, self->priv->log_codes[i]);
+    }
+
+    self->priv->flush_id = g_timeout_add_seconds (FLUSH_TIMEOUT_SECS,
+                                                  (GSourceFunc)flush_cb,
+                                                  self);
+
+    mm_info ("(%s) capturing QCDM log packets into '%s'",
+             mm_port_get_device (MM_PORT (port)),
+             self->priv->path);
+    return self;
+}
+
+const gchar *
+mm_qcdm_log_capture_get_path (MMQcdmLogCapture *self)
+{
+    g_return_val_if_fail (MM_IS_QCDM_LOG_CAPTURE (self), NULL);
+
+    return self->priv->path;
+}
+
+guint64
+mm_qcdm_log_capture_get_records (MMQcdmLogCapture *self)
+{
+    g_return_val_if_fail (MM_IS_QCDM_LOG_CAPTURE (self), 0);
+
+    return (self->priv->writer ?
+            qcdm_capture_writer_get_records (self->priv->writer) :
+            0);
+}
+
+/*****************************************************************************/
+
+static void
+mm_qcdm_log_capture_init (MMQcdmLogCapture *self)
+{
+    /* Initialize private data */
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE ((self),
+                                              MM_TYPE_QCDM_LOG_CAPTURE,
+                                              MMQcdmLogCapturePrivate);
+}
+
+static void
+dispose (GObject *object)
+{
+    MMQcdmLogCapture *self = MM_QCDM_LOG_CAPTURE (object);
+    guint i;
+
+    if (self->priv->flush_id) {
+        g_source_remove (self->priv->flush_id);
+        self->priv->flush_id = 0;
+    }
+
+    if (self->priv->port) {
+        mm_qcdm_serial_port_set_log_handler (self->priv->port, NULL, NULL, NULL);
+        for (i = 0; i < N_EQUIP_IDS; i++) {
+            if (self->priv->log_codes[i])
+                set_log_mask (self->priv->port, i, NULL);
+        }
+        mm_serial_port_close (MM_SERIAL_PORT (self->priv->port));
+        g_clear_object (&self->priv->port);
+    }
+
+    if (self->priv->writer) {
+        mm_dbg ("(%s) QCDM log capture closed with %" G_GUINT64_FORMAT " records",
+                self->priv->path,
+                qcdm_capture_writer_get_records (self->priv->writer));
+        qcdm_capture_writer_close (self->priv->writer);
+        self->priv->writer = NULL;
+    }
+
+    G_OBJECT_CLASS (mm_qcdm_log_capture_parent_class)->dispose (object);
+}
+
+static void
+finalize (GObject *object)
+{
+    MMQcdmLogCapture *self = MM_QCDM_LOG_CAPTURE (object);
+    guint i;
+
+    for (i = 0; i < N_EQUIP_IDS; i++) {
+        if (self->priv->log_codes[i])
+            g_array_unref (self->priv->log_codes[i]);
+    }
+    g_free (self->priv->path);
+
+    G_OBJECT_CLASS (mm_qcdm_log_capture_parent_class)->finalize (object);
+}
+
+static void
+mm_qcdm_log_capture_class_init (MMQcdmLogCaptureClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MMQcdmLogCapturePrivate));
+
+    /* Virtual methods */
+    object_class->dispose = dispose;
+    object_class->finalize = finalize;
+}
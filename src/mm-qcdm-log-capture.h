@@ -0,0 +1,58 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#ifndef MM_QCDM_LOG_CAPTURE_H
+#define MM_QCDM_LOG_CAPTURE_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "mm-qcdm-serial-port.h"
+
+#define MM_TYPE_QCDM_LOG_CAPTURE            (mm_qcdm_log_capture_get_type ())
+#define MM_QCDM_LOG_CAPTURE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), MM_TYPE_QCDM_LOG_CAPTURE, MMQcdmLogCapture))
+#define MM_QCDM_LOG_CAPTURE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  MM_TYPE_QCDM_LOG_CAPTURE, MMQcdmLogCaptureClass))
+#define MM_IS_QCDM_LOG_CAPTURE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), MM_TYPE_QCDM_LOG_CAPTURE))
+#define MM_IS_QCDM_LOG_CAPTURE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  MM_TYPE_QCDM_LOG_CAPTURE))
+#define MM_QCDM_LOG_CAPTURE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  MM_TYPE_QCDM_LOG_CAPTURE, MMQcdmLogCaptureClass))
+
+typedef struct _MMQcdmLogCapture MMQcdmLogCapture;
+typedef struct _MMQcdmLogCaptureClass MMQcdmLogCaptureClass;
+typedef struct _MMQcdmLogCapturePrivate MMQcdmLogCapturePrivate;
+
+struct _MMQcdmLogCapture {
+    GObject parent;
+    MMQcdmLogCapturePrivate *priv;
+};
+
+struct _MMQcdmLogCaptureClass {
+    GObjectClass parent;
+};
+
+GType mm_qcdm_log_capture_get_type (void);
+
+/* Enables the given log codes (a comma-separated list of hex codes, or NULL
+ * for a default set of RF-related ones) on the port, and appends every log
+ * packet received to a capture file in 'directory'.  Logging is disabled
+ * again when the object is disposed. */
+MMQcdmLogCapture *mm_qcdm_log_capture_new (MMQcdmSerialPort *port,
+                                           const gchar *directory,
+                                           const gchar *log_codes,
+                                           GError **error);
+
+const gchar *mm_qcdm_log_capture_get_path    (MMQcdmLogCapture *self);
+guint64      mm_qcdm_log_capture_get_records (MMQcdmLogCapture *self);
+
+#endif /* MM_QCDM_LOG_CAPTURE_H */
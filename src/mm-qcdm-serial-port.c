@@ -25,7 +25,10 @@
 #include "mm-qcdm-serial-port.h"
 #include "libqcdm/src/com.h"
 #include "libqcdm/src/utils.h"
+#include "libqcdm/src/hdlc.h"
 #include "libqcdm/src/errors.h"
+#include "libqcdm/src/commands.h"
+#include "libqcdm/src/dm-commands.h"
 #include "mm-log.h"
 
 G_DEFINE_TYPE (MMQcdmSerialPort, mm_qcdm_serial_port, MM_TYPE_SERIAL_PORT)
@@ -33,43 +36,172 @@ G_DEFINE_TYPE (MMQcdmSerialPort, mm_qcdm_serial_port, MM_TYPE_SERIAL_PORT)
 #define MM_QCDM_SERIAL_PORT_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), MM_TYPE_QCDM_SERIAL_PORT, MMQcdmSerialPortPrivate))
 
 typedef struct {
-    gboolean foo;
+    /* Unescaped contents of the frame being received, including its CRC;
+     * reused for every frame */
+    GByteArray *frame;
+    /* Bytes of the port response buffer already fed to the deframer */
+    guint scanned;
+    /* Running CRC of the unescaped frame contents */
+    guint16 crc;
+    /* Last byte seen was the escape char */
+    gboolean escaping;
+    /* Set once a whole frame is available, with the offset in the response
+     * buffer just past its trailing control char */
+    gboolean complete;
+    guint frame_end;
+
+    /* Handler for log packets sent by the modem on its own */
+    MMQcdmSerialLogFn log_fn;
+    gpointer log_data;
+    GDestroyNotify log_notify;
 } MMQcdmSerialPortPrivate;
 
+#define MIN_FRAME_SIZE 3
 
 /*****************************************************************************/
 
+static void
+deframer_reset (MMQcdmSerialPortPrivate *priv)
+{
+    priv->frame->len = 0;
+    priv->scanned = 0;
+    priv->crc = DM_CRC16_INIT;
+    priv->escaping = FALSE;
+    priv->complete = FALSE;
+    priv->frame_end = 0;
+}
+
+static void
+deframer_restart_frame (MMQcdmSerialPortPrivate *priv)
+{
+    priv->frame->len = 0;
+    priv->crc = DM_CRC16_INIT;
+    priv->escaping = FALSE;
+}
+
+/* Feeds the deframer with the data in the response buffer not yet seen,
+ * unescaping and CRC-ing it in a single pass.  Returns TRUE once a whole
+ * frame is available.
+ *
+ * The frames found will usually be of one of these kinds: (1) a QCDM frame
+ * starting with data and terminated by 0x7E, (2) a QCDM frame starting with
+ * 0x7E and ending with 0x7E, and (3) a non-QCDM frame that still uses HDLC
+ * framing (like Sierra CnS) that starts and ends with 0x7E.  Control chars
+ * found before enough data for a valid frame are just skipped.
+ */
 static gboolean
-find_qcdm_start (GByteArray *response, gsize *start)
+deframer_feed (MMQcdmSerialPortPrivate *priv,
+               GByteArray *response)
 {
-    int i, last = -1;
-
-    /* Look for 3 bytes and a QCDM frame marker, ie enough data for a valid
-     * frame.  There will usually be three cases here; (1) a QCDM frame
-     * starting with data and terminated by 0x7E, and (2) a QCDM frame starting
-     * with 0x7E and ending with 0x7E, and (3) a non-QCDM frame that still
-     * uses HDLC framing (like Sierra CnS) that starts and ends with 0x7E.
-     */
-    for (i = 0; i < response->len; i++) {
-        if (response->data[i] == 0x7E) {
-            if (i > last + 3) {
-                /* Got a full QCDM frame; 3 non-0x7E bytes and a terminator */
-                if (start)
-                    *start = last + 1;
-                return TRUE;
+    const guint8 *p;
+    const guint8 *end;
+
+    /* Response buffer changed under us; start over */
+    if (response->len < priv->scanned ||
+        (priv->complete && priv->frame_end > response->len))
+        deframer_reset (priv);
+
+    if (priv->complete)
+        return TRUE;
+
+    p = response->data + priv->scanned;
+    end = response->data + response->len;
+    while (p < end) {
+        const guint8 *run;
+
+        if (*p == DIAG_CONTROL_CHAR) {
+            p++;
+            if (priv->frame->len >= MIN_FRAME_SIZE && !priv->escaping) {
+                priv->complete = TRUE;
+                priv->frame_end = p - response->data;
+                break;
             }
+            /* Too short to be a frame; treat as a separator */
+            deframer_restart_frame (priv);
+            continue;
+        }
+
+        if (priv->escaping) {
+            guint8 c = *p++ ^ DIAG_ESC_MASK;
 
-            /* Save position of the last QCDM frame marker */
-            last = i;
+            priv->escaping = FALSE;
+            priv->crc = dm_crc16_update (priv->crc, (const char *) &c, 1);
+            g_byte_array_append (priv->frame, &c, 1);
+            continue;
         }
+
+        if (*p == DIAG_ESC_CHAR) {
+            priv->escaping = TRUE;
+            p++;
+            continue;
+        }
+
+        /* Copy and CRC whole runs of bytes needing no unescaping at once */
+        run = p;
+        p += hdlc_find_special ((const char *) p, end - p, FALSE);
+        priv->crc = dm_crc16_update (priv->crc, (const char *) run, p - run);
+        g_byte_array_append (priv->frame, run, p - run);
+    }
+
+    priv->scanned = p - response->data;
+    return priv->complete;
+}
+
+/* Log packets arrive whenever the modem likes once logging is enabled, so
+ * they get pulled out of the response buffer before they can be mistaken
+ * for the reply to a queued command.
+ */
+static void
+parse_unsolicited (MMSerialPort *port, GByteArray *response)
+{
+    MMQcdmSerialPortPrivate *priv = MM_QCDM_SERIAL_PORT_GET_PRIVATE (port);
+
+    if (!priv->log_fn)
+        return;
+
+    while (deframer_feed (priv, response)) {
+        u_int16_t log_code;
+        u_int64_t timestamp;
+        const char *data;
+        size_t data_len;
+
+        if (priv->crc != DM_CRC16_GOOD ||
+            priv->frame->data[0] != DIAG_CMD_LOG ||
+            !qcdm_cmd_log_packet_parse ((const char *) priv->frame->data,
+                                        priv->frame->len - 2,
+                                        &log_code,
+                                        &timestamp,
+                                        &data,
+                                        &data_len))
+            break;
+
+        priv->log_fn (MM_QCDM_SERIAL_PORT (port),
+                      log_code,
+                      timestamp,
+                      (const guint8 *) data,
+                      data_len,
+                      priv->log_data);
+
+        g_byte_array_remove_range (response, 0, priv->frame_end);
+        deframer_reset (priv);
+
+        /* The handler may have removed itself */
+        if (!priv->log_fn)
+            break;
     }
-    return FALSE;
 }
 
 static gboolean
 parse_response (MMSerialPort *port, GByteArray *response, GError **error)
 {
-    return find_qcdm_start (response, NULL);
+    return deframer_feed (MM_QCDM_SERIAL_PORT_GET_PRIVATE (port), response);
+}
+
+static void
+response_flushed (MMSerialPort *port)
+{
+    /* What was scanned so far is gone or moved */
+    deframer_reset (MM_QCDM_SERIAL_PORT_GET_PRIVATE (port));
 }
 
 static gsize
@@ -79,51 +211,39 @@ handle_response (MMSerialPort *port,
                  GCallback callback,
                  gpointer callback_data)
 {
+    MMQcdmSerialPortPrivate *priv = MM_QCDM_SERIAL_PORT_GET_PRIVATE (port);
     MMQcdmSerialResponseFn response_callback = (MMQcdmSerialResponseFn) callback;
     GByteArray *unescaped = NULL;
     GError *dm_error = NULL;
     gsize used = 0;
-    gsize start = 0;
-    gboolean success = FALSE;
-    qcdmbool more = FALSE;
-    gsize unescaped_len = 0;
 
     if (error)
         goto callback;
 
-    /* Get the offset into the buffer of where the QCDM frame starts */
-    if (!find_qcdm_start (response, &start)) {
+    /* Responses not coming through parse_response() (e.g. cached replies)
+     * need to be fully scanned */
+    if (!priv->complete)
+        deframer_reset (priv);
+
+    if (!deframer_feed (priv, response)) {
         g_set_error_literal (&dm_error,
                              MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
                              "Failed to parse QCDM packet.");
         /* Discard the unparsable data */
         used = response->len;
-        goto callback;
-    }
-
-    /* FIXME: don't munge around with byte array internals */
-    unescaped = g_byte_array_sized_new (1024);
-    success = dm_decapsulate_buffer ((const char *) (response->data + start),
-                                     response->len - start,
-                                     (char *) unescaped->data,
-                                     1024,
-                                     &unescaped_len,
-                                     &used,
-                                     &more);
-    if (!success) {
-        g_set_error_literal (&dm_error,
-                             MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
-                             "Failed to unescape QCDM packet.");
-        g_byte_array_free (unescaped, TRUE);
-        unescaped = NULL;
-    } else if (more) {
-        /* Need more data; we shouldn't have gotten here since the parse
-         * function checks for the end-of-frame marker, but whatever.
-         */
-        return 0;
     } else {
-        /* Successfully decapsulated the DM command */
-        unescaped->len = (guint) unescaped_len;
+        used = priv->frame_end;
+        /* Running the CRC over the packet and its own CRC gives a known value */
+        if (priv->crc != DM_CRC16_GOOD)
+            g_set_error_literal (&dm_error,
+                                 MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                                 "Failed to unescape QCDM packet.");
+        else {
+            /* Successfully decapsulated the DM command; the callback gets the
+             * reused frame buffer, without the CRC */
+            unescaped = priv->frame;
+            unescaped->len -= 2;
+        }
     }
 
 callback:
@@ -132,11 +252,12 @@ callback:
                        dm_error ? dm_error : error,
                        callback_data);
 
-    if (unescaped)
-        g_byte_array_free (unescaped, TRUE);
+    /* Consumed data is removed from the response buffer once we return */
+    if (used)
+        deframer_reset (priv);
     g_clear_error (&dm_error);
 
-    return start + used;
+    return used;
 }
 
 /*****************************************************************************/
@@ -185,6 +306,26 @@ mm_qcdm_serial_port_queue_command_cached (MMQcdmSerialPort *self,
                                          user_data);
 }
 
+void
+mm_qcdm_serial_port_set_log_handler (MMQcdmSerialPort *self,
+                                     MMQcdmSerialLogFn callback,
+                                     gpointer user_data,
+                                     GDestroyNotify notify)
+{
+    MMQcdmSerialPortPrivate *priv;
+
+    g_return_if_fail (MM_IS_QCDM_SERIAL_PORT (self));
+
+    priv = MM_QCDM_SERIAL_PORT_GET_PRIVATE (self);
+
+    if (priv->log_notify)
+        priv->log_notify (priv->log_data);
+
+    priv->log_fn = callback;
+    priv->log_data = user_data;
+    priv->log_notify = notify;
+}
+
 static void
 debug_log (MMSerialPort *port, const char *prefix, const char *buf, gsize len)
 {
@@ -251,11 +392,21 @@ mm_qcdm_serial_port_new_fd (int fd)
 static void
 mm_qcdm_serial_port_init (MMQcdmSerialPort *self)
 {
+    MMQcdmSerialPortPrivate *priv = MM_QCDM_SERIAL_PORT_GET_PRIVATE (self);
+
+    priv->frame = g_byte_array_sized_new (1024);
+    deframer_reset (priv);
 }
 
 static void
 finalize (GObject *object)
 {
+    MMQcdmSerialPortPrivate *priv = MM_QCDM_SERIAL_PORT_GET_PRIVATE (object);
+
+    if (priv->log_notify)
+        priv->log_notify (priv->log_data);
+    g_byte_array_unref (priv->frame);
+
     G_OBJECT_CLASS (mm_qcdm_serial_port_parent_class)->finalize (object);
 }
 
@@ -270,8 +421,10 @@ mm_qcdm_serial_port_class_init (MMQcdmSerialPortClass *klass)
     /* Virtual methods */
     object_class->finalize = finalize;
 
+    port_class->parse_unsolicited = parse_unsolicited;
     port_class->parse_response = parse_response;
     port_class->handle_response = handle_response;
+    port_class->response_flushed = response_flushed;
     port_class->config_fd = config_fd;
     port_class->debug_log = debug_log;
 }
@@ -37,6 +37,14 @@ typedef void (*MMQcdmSerialResponseFn)     (MMQcdmSerialPort *port,
                                             GError *error,
                                             gpointer user_data);
 
+/* Called for every log packet received while a handler is set */
+typedef void (*MMQcdmSerialLogFn)          (MMQcdmSerialPort *port,
+                                            guint16 log_code,
+                                            guint64 timestamp,
+                                            const guint8 *data,
+                                            gsize len,
+                                            gpointer user_data);
+
 struct _MMQcdmSerialPort {
     MMSerialPort parent;
 };
@@ -65,4 +73,9 @@ void     mm_qcdm_serial_port_queue_command_cached (MMQcdmSerialPort *self,
                                                    MMQcdmSerialResponseFn callback,
                                                    gpointer user_data);
 
+void     mm_qcdm_serial_port_set_log_handler (MMQcdmSerialPort *self,
+                                              MMQcdmSerialLogFn callback,
+                                              gpointer user_data,
+                                              GDestroyNotify notify);
+
 #endif /* MM_QCDM_SERIAL_PORT_H */
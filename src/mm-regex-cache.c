@@ -0,0 +1,72 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include "mm-regex-cache.h"
+
+G_LOCK_DEFINE_STATIC (cache);
+static GHashTable *cache;
+
+GRegex *
+mm_regex_cache_get (const gchar *pattern,
+                    GRegexCompileFlags compile_options,
+                    GRegexMatchFlags match_options,
+                    GError **error)
+{
+    GRegex *regex;
+    gchar *key;
+
+    g_return_val_if_fail (pattern != NULL, NULL);
+
+    /* Compiled once, so always worth studying */
+    compile_options |= G_REGEX_OPTIMIZE;
+
+    key = g_strdup_printf ("%x:%x:%s", compile_options, match_options, pattern);
+
+    G_LOCK (cache);
+
+    if (G_UNLIKELY (!cache))
+        cache = g_hash_table_new_full (g_str_hash,
+                                       g_str_equal,
+                                       g_free,
+                                       (GDestroyNotify) g_regex_unref);
+
+    regex = g_hash_table_lookup (cache, key);
+    if (regex) {
+        g_free (key);
+        regex = g_regex_ref (regex);
+    } else {
+        regex = g_regex_new (pattern, compile_options, match_options, error);
+        if (regex)
+            g_hash_table_insert (cache, key, g_regex_ref (regex));
+        else
+            g_free (key);
+    }
+
+    G_UNLOCK (cache);
+
+    return regex;
+}
+
+guint
+mm_regex_cache_get_size (void)
+{
+    guint size;
+
+    G_LOCK (cache);
+    size = cache ? g_hash_table_size (cache) : 0;
+    G_UNLOCK (cache);
+
+    return size;
+}
@@ -0,0 +1,40 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#ifndef MM_REGEX_CACHE_H
+#define MM_REGEX_CACHE_H
+
+#include <glib.h>
+
+/* Process-wide registry of compiled regular expressions, keyed by pattern
+ * and flags.  A pattern is compiled (and studied, as if G_REGEX_OPTIMIZE was
+ * given) the first time it is requested; later requests, from any port or
+ * modem, just get a new reference to the same GRegex.
+ *
+ * mm_regex_cache_get() is a drop-in replacement for g_regex_new(): the
+ * returned reference must be released with g_regex_unref().  Only use it
+ * with patterns from a bounded set (e.g. string literals), as entries are
+ * kept for the lifetime of the process.
+ */
+
+GRegex *mm_regex_cache_get (const gchar *pattern,
+                            GRegexCompileFlags compile_options,
+                            GRegexMatchFlags match_options,
+                            GError **error);
+
+/* Number of distinct compiled patterns currently held */
+guint   mm_regex_cache_get_size (void);
+
+#endif /* MM_REGEX_CACHE_H */
@@ -0,0 +1,148 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include "mm-scan-cache.h"
+
+struct _MMScanCache {
+    /* Results of the last complete scan, and when it finished */
+    GVariant *result;
+    gint64 result_time;
+    /* Running scan */
+    gboolean running;
+    gboolean background;
+    /* Requests waiting for the running scan */
+    GList *waiting;
+};
+
+MMScanCache *
+mm_scan_cache_new (void)
+{
+    return g_slice_new0 (MMScanCache);
+}
+
+void
+mm_scan_cache_free (MMScanCache *self)
+{
+    g_return_if_fail (self != NULL);
+
+    g_warn_if_fail (self->waiting == NULL);
+    g_list_free (self->waiting);
+    if (self->result)
+        g_variant_unref (self->result);
+    g_slice_free (MMScanCache, self);
+}
+
+GVariant *
+mm_scan_cache_peek (MMScanCache *self,
+                    guint max_age,
+                    gint64 now,
+                    guint *age)
+{
+    gint64 elapsed;
+
+    g_return_val_if_fail (self != NULL, NULL);
+
+    /* A running scan will have newer results */
+    if (!self->result || self->running)
+        return NULL;
+
+    elapsed = (now - self->result_time) / G_USEC_PER_SEC;
+    if (elapsed < 0 || elapsed > max_age)
+        return NULL;
+
+    if (age)
+        *age = (guint) elapsed;
+    return self->result;
+}
+
+MMScanCacheStart
+mm_scan_cache_start (MMScanCache *self,
+                     gboolean background,
+                     gpointer request)
+{
+    MMScanCacheStart start;
+
+    g_return_val_if_fail (self != NULL, MM_SCAN_CACHE_START_JOINED);
+
+    if (request)
+        self->waiting = g_list_append (self->waiting, request);
+
+    if (!self->running) {
+        self->running = TRUE;
+        self->background = background;
+        return MM_SCAN_CACHE_START_NEW;
+    }
+
+    start = MM_SCAN_CACHE_START_JOINED;
+    /* Someone is waiting for the results, so stop yielding */
+    if (!background && self->background) {
+        self->background = FALSE;
+        start = MM_SCAN_CACHE_START_PROMOTED;
+    }
+    return start;
+}
+
+gboolean
+mm_scan_cache_is_running (MMScanCache *self)
+{
+    g_return_val_if_fail (self != NULL, FALSE);
+
+    return self->running;
+}
+
+gboolean
+mm_scan_cache_is_background (MMScanCache *self)
+{
+    g_return_val_if_fail (self != NULL, FALSE);
+
+    return self->running && self->background;
+}
+
+GList *
+mm_scan_cache_complete (MMScanCache *self,
+                        GVariant *result,
+                        gint64 now)
+{
+    GList *waiting;
+
+    g_return_val_if_fail (self != NULL, NULL);
+    g_warn_if_fail (self->running);
+
+    self->running = FALSE;
+    self->background = FALSE;
+
+    if (result) {
+        if (self->result)
+            g_variant_unref (self->result);
+        self->result = g_variant_ref (result);
+        self->result_time = now;
+    }
+
+    /* Requests arriving from now on need a new scan */
+    waiting = self->waiting;
+    self->waiting = NULL;
+    return waiting;
+}
+
+void
+mm_scan_cache_clear (MMScanCache *self)
+{
+    g_return_if_fail (self != NULL);
+
+    if (self->result) {
+        g_variant_unref (self->result);
+        self->result = NULL;
+    }
+}
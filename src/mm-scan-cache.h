@@ -0,0 +1,67 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#ifndef MM_SCAN_CACHE_H
+#define MM_SCAN_CACHE_H
+
+#include <glib.h>
+
+/* Keeps the results of the last complete network scan, with the time it
+ * finished, and the requests waiting for the scan currently running, so
+ * that requests arriving during a scan share it instead of launching
+ * another one.
+ *
+ * Times are monotonic, in microseconds, as given by g_get_monotonic_time().
+ */
+
+typedef struct _MMScanCache MMScanCache;
+
+typedef enum {
+    MM_SCAN_CACHE_START_NEW,      /* No scan running; caller must launch one */
+    MM_SCAN_CACHE_START_JOINED,   /* Waits for the scan already running */
+    MM_SCAN_CACHE_START_PROMOTED  /* Joined a background scan, which should
+                                   * stop yielding to other work */
+} MMScanCacheStart;
+
+MMScanCache *mm_scan_cache_new  (void);
+void         mm_scan_cache_free (MMScanCache *self);
+
+/* Results of the last scan, if one finished at most @max_age seconds before
+ * @now and no other is running; NULL otherwise. */
+GVariant *mm_scan_cache_peek        (MMScanCache *self,
+                                     guint max_age,
+                                     gint64 now,
+                                     guint *age);
+
+/* Asks for a scan. A non-NULL @request is handed back by
+ * mm_scan_cache_complete() once the scan finishes. */
+MMScanCacheStart mm_scan_cache_start (MMScanCache *self,
+                                      gboolean background,
+                                      gpointer request);
+
+gboolean  mm_scan_cache_is_running    (MMScanCache *self);
+gboolean  mm_scan_cache_is_background (MMScanCache *self);
+
+/* The running scan finished at @now, with the given results or NULL on
+ * error, which keeps the previous ones. Returns the list of requests which
+ * were waiting for it, in arrival order; the list is owned by the caller. */
+GList    *mm_scan_cache_complete      (MMScanCache *self,
+                                       GVariant *result,
+                                       gint64 now);
+
+/* The cached results no longer apply */
+void      mm_scan_cache_clear         (MMScanCache *self);
+
+#endif /* MM_SCAN_CACHE_H */
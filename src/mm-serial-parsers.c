@@ -20,6 +20,7 @@
 #include "mm-error-helpers.h"
 #include "mm-serial-parsers.h"
 #include "mm-log.h"
+#include "mm-regex-cache.h"
 
 /* Clean up the response by removing control characters like <CR><LF> etc */
 static void
@@ -104,16 +105,16 @@ mm_serial_parser_v1_new (void)
 
     parser = g_slice_new (MMSerialParserV1);
 
-    parser->regex_ok = g_regex_new ("\\r\\nOK(\\r\\n)+$", flags, 0, NULL);
-    parser->regex_connect = g_regex_new ("\\r\\nCONNECT.*\\r\\n", flags, 0, NULL);
-    parser->regex_sms = g_regex_new ("\\r\\n>\\s*$", flags, 0, NULL);
-    parser->regex_cme_error = g_regex_new ("\\r\\n\\+CME ERROR:\\s*(\\d+)\\r\\n$", flags, 0, NULL);
-    parser->regex_cms_error = g_regex_new ("\\r\\n\\+CMS ERROR:\\s*(\\d+)\\r\\n$", flags, 0, NULL);
-    parser->regex_cme_error_str = g_regex_new ("\\r\\n\\+CME ERROR:\\s*([^\\n\\r]+)\\r\\n$", flags, 0, NULL);
-    parser->regex_cms_error_str = g_regex_new ("\\r\\n\\+CMS ERROR:\\s*([^\\n\\r]+)\\r\\n$", flags, 0, NULL);
-    parser->regex_ezx_error = g_regex_new ("\\r\\n\\MODEM ERROR:\\s*(\\d+)\\r\\n$", flags, 0, NULL);
-    parser->regex_unknown_error = g_regex_new ("\\r\\n(ERROR)|(COMMAND NOT SUPPORT)\\r\\n$", flags, 0, NULL);
-    parser->regex_connect_failed = g_regex_new ("\\r\\n(NO CARRIER)|(BUSY)|(NO ANSWER)|(NO DIALTONE)\\r\\n$", flags, 0, NULL);
+    parser->regex_ok = mm_regex_cache_get ("\\r\\nOK(\\r\\n)+$", flags, 0, NULL);
+    parser->regex_connect = mm_regex_cache_get ("\\r\\nCONNECT.*\\r\\n", flags, 0, NULL);
+    parser->regex_sms = mm_regex_cache_get ("\\r\\n>\\s*$", flags, 0, NULL);
+    parser->regex_cme_error = mm_regex_cache_get ("\\r\\n\\+CME ERROR:\\s*(\\d+)\\r\\n$", flags, 0, NULL);
+    parser->regex_cms_error = mm_regex_cache_get ("\\r\\n\\+CMS ERROR:\\s*(\\d+)\\r\\n$", flags, 0, NULL);
+    parser->regex_cme_error_str = mm_regex_cache_get ("\\r\\n\\+CME ERROR:\\s*([^\\n\\r]+)\\r\\n$", flags, 0, NULL);
+    parser->regex_cms_error_str = mm_regex_cache_get ("\\r\\n\\+CMS ERROR:\\s*([^\\n\\r]+)\\r\\n$", flags, 0, NULL);
+    parser->regex_ezx_error = mm_regex_cache_get ("\\r\\n\\MODEM ERROR:\\s*(\\d+)\\r\\n$", flags, 0, NULL);
+    parser->regex_unknown_error = mm_regex_cache_get ("\\r\\n(ERROR)|(COMMAND NOT SUPPORT)\\r\\n$", flags, 0, NULL);
+    parser->regex_connect_failed = mm_regex_cache_get ("\\r\\n(NO CARRIER)|(BUSY)|(NO ANSWER)|(NO DIALTONE)\\r\\n$", flags, 0, NULL);
 
     parser->regex_custom_successful = NULL;
     parser->regex_custom_error = NULL;
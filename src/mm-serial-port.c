@@ -33,6 +33,8 @@
 
 #include "mm-serial-port.h"
 #include "mm-log.h"
+#include "mm-timer-wheel.h"
+#include "mm-trace.h"
 
 static gboolean mm_serial_port_queue_process (gpointer data);
 static void mm_serial_port_close_force (MMSerialPort *self);
@@ -50,6 +52,9 @@ enum {
     PROP_SPEW_CONTROL,
     PROP_RTS_CTS,
     PROP_FLASH_OK,
+    PROP_IO_THREAD,
+    PROP_LOW_MEMORY,
+    PROP_AGING_PERIOD,
 
     LAST_PROP
 };
@@ -66,6 +71,24 @@ static guint signals[LAST_SIGNAL] = { 0 };
 
 #define SERIAL_BUF_SIZE 2048
 
+/* Initial size of the response buffer. In low-memory mode the buffer starts
+ * smaller, and is shrunk back whenever the port goes idle after a long
+ * response made it grow. */
+#define RESPONSE_BUF_SIZE            500
+#define RESPONSE_BUF_SIZE_LOW_MEMORY 64
+
+/* Worker I/O threads need the GLib >= 2.32 threading API */
+#if GLIB_CHECK_VERSION (2,32,0)
+#define WITH_IO_THREAD 1
+#endif
+
+#if defined WITH_IO_THREAD
+static void io_thread_resume_dispatch (MMSerialPort *self);
+static void io_thread_write (MMSerialPort *self,
+                             const guint8 *data,
+                             gsize len);
+#endif
+
 #define MM_SERIAL_PORT_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), MM_TYPE_SERIAL_PORT, MMSerialPortPrivate))
 
 typedef struct {
@@ -76,6 +99,10 @@ typedef struct {
     GIOChannel *channel;
     GQueue *queue;
     GByteArray *response;
+    /* Estimated allocated size of 'response' */
+    guint response_alloc;
+    gboolean low_memory;
+    guint64 aging_period;
 
     struct termios old_t;
 
@@ -99,6 +126,26 @@ typedef struct {
 
     guint flash_id;
     guint connected_id;
+
+    /* Optional worker thread reading from the port in its own context */
+    gboolean io_thread_enabled;
+#if defined WITH_IO_THREAD
+    GThread *io_thread;
+    GMainContext *io_context;
+    GMainLoop *io_loop;
+    GSource *io_watch;
+    GMutex io_lock;
+    GCond io_cond;
+    /* Protected by io_lock */
+    GByteArray *io_pending;
+    GSource *io_dispatch;
+    gboolean io_hangup;
+    gboolean io_paused;
+    gboolean io_synced;
+    /* Requests handed over to the worker, main context only */
+    gpointer io_write_job;
+    gpointer io_flash_job;
+#endif
 } MMSerialPortPrivate;
 
 typedef struct {
@@ -112,8 +159,19 @@ typedef struct {
     guint32 timeout;
     gboolean cached;
     GCancellable *cancellable;
+    MMSerialPortPriority priority;
+    gint64 queued_time;
+    /* When the command was first written; only set when tracing */
+    gint64 sent_time;
+    /* Callbacks of identical background commands merged into this one */
+    GSList *merged;
 } MMQueueData;
 
+typedef struct {
+    GCallback callback;
+    gpointer user_data;
+} MMQueueCallback;
+
 #if 0
 static const char *
 baud_to_string (int baud)
@@ -427,14 +485,15 @@ serial_debug (MMSerialPort *self, const char *prefix, const char *buf, gsize len
         MM_SERIAL_PORT_GET_CLASS (self)->debug_log (self, prefix, buf, len);
 }
 
+/* Gives the next chunk of the command to write */
 static gboolean
-mm_serial_port_process_command (MMSerialPort *self,
-                                MMQueueData *info,
-                                GError **error)
+command_next_chunk (MMSerialPort *self,
+                    MMQueueData *info,
+                    const guint8 **chunk,
+                    gsize *chunk_len,
+                    GError **error)
 {
     MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
-    const guint8 *p;
-    int status, expected_status, send_len;
 
     if (priv->fd < 0) {
         g_set_error_literal (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
@@ -451,27 +510,38 @@ mm_serial_port_process_command (MMSerialPort *self,
     /* Only print command the first time */
     if (info->started == FALSE) {
         info->started = TRUE;
+        info->sent_time = mm_trace_begin ();
         serial_debug (self, "-->", (const char *) info->command->data, info->command->len);
     }
 
     if (priv->send_delay == 0) {
         /* Send the whole command in one write */
-        send_len = expected_status = info->command->len;
-        p = info->command->data;
+        *chunk_len = info->command->len - info->idx;
+        *chunk = &info->command->data[info->idx];
     } else {
         /* Send just one byte of the command */
-        send_len = expected_status = 1;
-        p = &info->command->data[info->idx];
+        *chunk_len = 1;
+        *chunk = &info->command->data[info->idx];
     }
 
-    /* Send a single byte of the command */
-    errno = 0;
-    status = write (priv->fd, p, send_len);
+    return TRUE;
+}
+
+/* Accounts for the result of writing a chunk of the command */
+static gboolean
+command_chunk_written (MMSerialPort *self,
+                       MMQueueData *info,
+                       int status,
+                       int errsv,
+                       GError **error)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+
     if (status > 0)
         info->idx += status;
     else {
         /* Error or no bytes written */
-        if (errno == EAGAIN || status == 0) {
+        if (errsv == EAGAIN || status == 0) {
             info->eagain_count--;
             if (info->eagain_count <= 0) {
                 /* If we reach the limit of EAGAIN errors, treat as a timeout error. */
@@ -479,12 +549,12 @@ mm_serial_port_process_command (MMSerialPort *self,
                 g_signal_emit (self, signals[TIMED_OUT], 0, priv->n_consecutive_timeouts);
 
                 g_set_error (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
-                             "Sending command failed: '%s'", strerror (errno));
+                             "Sending command failed: '%s'", strerror (errsv));
                 return FALSE;
             }
         } else {
             g_set_error (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
-                         "Sending command failed: '%s'", strerror (errno));
+                         "Sending command failed: '%s'", strerror (errsv));
             return FALSE;
         }
     }
@@ -495,6 +565,24 @@ mm_serial_port_process_command (MMSerialPort *self,
     return TRUE;
 }
 
+static gboolean
+mm_serial_port_process_command (MMSerialPort *self,
+                                MMQueueData *info,
+                                GError **error)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+    const guint8 *chunk;
+    gsize chunk_len;
+    int status;
+
+    if (!command_next_chunk (self, info, &chunk, &chunk_len, error))
+        return FALSE;
+
+    errno = 0;
+    status = write (priv->fd, chunk, chunk_len);
+    return command_chunk_written (self, info, status, errno, error);
+}
+
 static void
 mm_serial_port_set_cached_reply (MMSerialPort *self,
                                  const GByteArray *command,
@@ -523,6 +611,70 @@ mm_serial_port_get_cached_reply (MMSerialPort *self, GByteArray *command)
     return (const GByteArray *) g_hash_table_lookup (MM_SERIAL_PORT_GET_PRIVATE (self)->reply_cache, command);
 }
 
+/*****************************************************************************/
+/* Response buffer */
+
+/* GByteArray grows its storage in powers of two */
+static guint
+byte_array_alloc_size (guint len)
+{
+    guint size = 16;
+
+    while (size < len)
+        size <<= 1;
+    return size;
+}
+
+static void
+response_new (MMSerialPortPrivate *priv)
+{
+    guint size;
+
+    size = priv->low_memory ? RESPONSE_BUF_SIZE_LOW_MEMORY : RESPONSE_BUF_SIZE;
+    priv->response = g_byte_array_sized_new (size);
+    priv->response_alloc = byte_array_alloc_size (size);
+}
+
+static void
+response_append (MMSerialPortPrivate *priv,
+                 const guint8 *data,
+                 guint len)
+{
+    g_byte_array_append (priv->response, data, len);
+    priv->response_alloc = MAX (priv->response_alloc,
+                                byte_array_alloc_size (priv->response->len));
+}
+
+/* Removes @len bytes from the start of the response buffer */
+static void
+response_flush (MMSerialPort *self,
+                guint len)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+
+    if (!len)
+        return;
+
+    g_byte_array_remove_range (priv->response, 0, len);
+    if (MM_SERIAL_PORT_GET_CLASS (self)->response_flushed)
+        MM_SERIAL_PORT_GET_CLASS (self)->response_flushed (self);
+}
+
+static void
+response_shrink_if_idle (MMSerialPort *self)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+
+    if (!priv->low_memory ||
+        priv->response->len > 0 ||
+        !g_queue_is_empty (priv->queue) ||
+        priv->response_alloc <= byte_array_alloc_size (RESPONSE_BUF_SIZE_LOW_MEMORY))
+        return;
+
+    g_byte_array_free (priv->response, TRUE);
+    response_new (priv);
+}
+
 static void
 mm_serial_port_schedule_queue_process (MMSerialPort *self, guint timeout_ms)
 {
@@ -538,6 +690,13 @@ mm_serial_port_schedule_queue_process (MMSerialPort *self, guint timeout_ms)
         return;
     }
 
+#if defined WITH_IO_THREAD
+    if (priv->io_write_job) {
+        /* The worker is writing the current command */
+        return;
+    }
+#endif
+
     if (timeout_ms)
         priv->queue_id = g_timeout_add (timeout_ms, mm_serial_port_queue_process, self);
     else
@@ -557,6 +716,147 @@ real_handle_response (MMSerialPort *self,
     return response->len;
 }
 
+static gsize
+queue_data_handle_response (MMSerialPort *self,
+                            MMQueueData *info,
+                            GByteArray *response,
+                            GError *error)
+{
+    gsize consumed = response->len;
+    GSList *l;
+
+    if (info->callback) {
+        g_warn_if_fail (MM_SERIAL_PORT_GET_CLASS (self)->handle_response != NULL);
+        consumed = MM_SERIAL_PORT_GET_CLASS (self)->handle_response (self,
+                                                                     response,
+                                                                     error,
+                                                                     info->callback,
+                                                                     info->user_data);
+    }
+
+    /* Merged commands get their own copy of the same reply */
+    for (l = info->merged; l; l = g_slist_next (l)) {
+        MMQueueCallback *merged = l->data;
+        GByteArray *copy;
+
+        copy = g_byte_array_sized_new (consumed);
+        g_byte_array_append (copy, response->data, consumed);
+        MM_SERIAL_PORT_GET_CLASS (self)->handle_response (self,
+                                                          copy,
+                                                          error,
+                                                          merged->callback,
+                                                          merged->user_data);
+        g_byte_array_free (copy, TRUE);
+    }
+
+    return consumed;
+}
+
+static void
+queue_callback_free (MMQueueCallback *merged)
+{
+    g_slice_free (MMQueueCallback, merged);
+}
+
+static void
+queue_data_free (MMQueueData *info)
+{
+    g_slist_free_full (info->merged, (GDestroyNotify)queue_callback_free);
+    g_clear_object (&info->cancellable);
+    g_byte_array_free (info->command, TRUE);
+    g_slice_free (MMQueueData, info);
+}
+
+static gint
+queue_data_get_rank (MMSerialPortPrivate *priv,
+                     MMQueueData *info,
+                     gint64 now)
+{
+    guint64 periods;
+
+    if (!priv->aging_period)
+        return (gint)info->priority;
+
+    /* One class up for each aging period waited */
+    periods = (guint64)(now - info->queued_time) / priv->aging_period;
+    return (gint)info->priority - (gint)MIN (periods, (guint64)info->priority);
+}
+
+/* Moves the command to send next to the head of the queue */
+static void
+queue_select_next (MMSerialPortPrivate *priv)
+{
+    GList *head;
+    GList *best;
+    GList *l;
+    gint best_rank;
+    gint64 now;
+
+    /* Nothing to choose from, or already sending the head */
+    head = priv->queue->head;
+    if (!head || !head->next || ((MMQueueData *)head->data)->started)
+        return;
+
+    /* First in wins within the same rank */
+    now = g_get_monotonic_time ();
+    best = head;
+    best_rank = queue_data_get_rank (priv, head->data, now);
+    for (l = head->next; l && best_rank > MM_SERIAL_PORT_PRIORITY_INTERACTIVE; l = g_list_next (l)) {
+        gint rank;
+
+        rank = queue_data_get_rank (priv, l->data, now);
+        if (rank < best_rank) {
+            best = l;
+            best_rank = rank;
+        }
+    }
+
+    if (best != head) {
+        g_queue_unlink (priv->queue, best);
+        g_queue_push_head_link (priv->queue, best);
+    }
+}
+
+static void
+queue_data_trace (MMSerialPort *self,
+                  MMQueueData *info,
+                  const GError *error)
+{
+    gchar *name;
+    gchar *detail;
+    guint len;
+    guint i;
+
+    if (!info->sent_time)
+        return;
+
+    /* AT commands are shown as they are, binary ones just by size */
+    len = info->command->len;
+    while (len > 0 && (info->command->data[len - 1] == '\r' ||
+                       info->command->data[len - 1] == '\n'))
+        len--;
+    for (i = 0; i < len; i++) {
+        if (!g_ascii_isprint (info->command->data[i]))
+            break;
+    }
+    if (len > 0 && i == len)
+        name = g_strndup ((const gchar *) info->command->data, len);
+    else
+        name = g_strdup_printf ("%u-byte command", info->command->len);
+
+    detail = g_strdup_printf ("%s, queued for %.3fs",
+                              error ? error->message : "replied",
+                              (info->sent_time - info->queued_time) / (gdouble) G_USEC_PER_SEC);
+
+    mm_trace_span ("serial",
+                   mm_port_get_device (MM_PORT (self)),
+                   info->sent_time,
+                   name,
+                   detail);
+    g_free (detail);
+    g_free (name);
+}
+
 static void
 mm_serial_port_got_response (MMSerialPort *self, GError *error)
 {
@@ -565,7 +865,7 @@ mm_serial_port_got_response (MMSerialPort *self, GError *error)
     gsize consumed = priv->response->len;
 
     if (priv->timeout_id) {
-        g_source_remove (priv->timeout_id);
+        mm_timer_wheel_remove (priv->timeout_id);
         priv->timeout_id = 0;
     }
 
@@ -583,27 +883,21 @@ mm_serial_port_got_response (MMSerialPort *self, GError *error)
         if (info->cached && !error)
             mm_serial_port_set_cached_reply (self, info->command, priv->response);
 
-        if (info->callback) {
-            g_warn_if_fail (MM_SERIAL_PORT_GET_CLASS (self)->handle_response != NULL);
-            consumed = MM_SERIAL_PORT_GET_CLASS (self)->handle_response (self,
-                                                                         priv->response,
-                                                                         error,
-                                                                         info->callback,
-                                                                         info->user_data);
-        }
-
-        g_clear_object (&info->cancellable);
-        g_byte_array_free (info->command, TRUE);
-        g_slice_free (MMQueueData, info);
+        queue_data_trace (self, info, error);
+        consumed = queue_data_handle_response (self, info, priv->response, error);
+        queue_data_free (info);
     }
 
     if (error)
         g_error_free (error);
 
-    if (consumed)
-        g_byte_array_remove_range (priv->response, 0, consumed);
+    /* If nobody was waiting for the reply (e.g. it came after a timeout),
+     * the whole buffer is dropped */
+    response_flush (self, consumed);
     if (!g_queue_is_empty (priv->queue))
         mm_serial_port_schedule_queue_process (self, 0);
+    else
+        response_shrink_if_idle (self);
 }
 
 static gboolean
@@ -654,6 +948,50 @@ serial_port_response_wait_cancelled (GCancellable *cancellable,
     mm_serial_port_got_response (self, error);
 }
 
+/* Called once a chunk of the command at the head of the queue is written */
+static void
+mm_serial_port_command_sent (MMSerialPort *self,
+                             MMQueueData *info)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+
+    if (!info->done) {
+        /* Schedule the next byte of the command to be sent */
+        mm_serial_port_schedule_queue_process (self, priv->send_delay / 1000);
+        return;
+    }
+
+    /* setup the cancellable so that we can stop waiting for a response */
+    if (info->cancellable) {
+        priv->cancellable = g_object_ref (info->cancellable);
+        priv->cancellable_id = (g_cancellable_connect (
+                                    info->cancellable,
+                                    (GCallback) serial_port_response_wait_cancelled,
+                                    self,
+                                    NULL));
+        if (!priv->cancellable_id) {
+            GError *error;
+
+            error = g_error_new (MM_CORE_ERROR,
+                                 MM_CORE_ERROR_CANCELLED,
+                                 "Won't wait for the reply");
+            mm_serial_port_got_response (self, error);
+            return;
+        }
+    }
+
+    /* If the command is finished being sent, schedule the timeout */
+    priv->timeout_id = mm_timer_wheel_add_seconds (info->timeout,
+                                                   MM_TIMER_WHEEL_COALESCE_NONE,
+                                                   mm_serial_port_timed_out,
+                                                   self);
+
+#if defined WITH_IO_THREAD
+    /* Process whatever the worker read while we were sending */
+    io_thread_resume_dispatch (self);
+#endif
+}
+
 static gboolean
 mm_serial_port_queue_process (gpointer data)
 {
@@ -664,6 +1002,7 @@ mm_serial_port_queue_process (gpointer data)
 
     priv->queue_id = 0;
 
+    queue_select_next (priv);
     info = (MMQueueData *) g_queue_peek_head (priv->queue);
     if (!info)
         return FALSE;
@@ -679,43 +1018,33 @@ mm_serial_port_queue_process (gpointer data)
                          "reply, cleaning up %u bytes",
                          mm_port_get_device (MM_PORT (self)),
                          priv->response->len);
-                g_byte_array_set_size (priv->response, 0);
+                response_flush (self, priv->response->len);
             }
 
-            g_byte_array_append (priv->response, cached->data, cached->len);
+            response_append (priv, cached->data, cached->len);
             mm_serial_port_got_response (self, NULL);
             return FALSE;
         }
     }
 
-    if (mm_serial_port_process_command (self, info, &error)) {
-        if (info->done) {
-            /* setup the cancellable so that we can stop waiting for a response */
-            if (info->cancellable) {
-                priv->cancellable = g_object_ref (info->cancellable);
-                priv->cancellable_id = (g_cancellable_connect (
-                                            info->cancellable,
-                                            (GCallback) serial_port_response_wait_cancelled,
-                                            self,
-                                            NULL));
-                if (!priv->cancellable_id) {
-                    error = g_error_new (MM_CORE_ERROR,
-                                         MM_CORE_ERROR_CANCELLED,
-                                         "Won't wait for the reply");
-                    mm_serial_port_got_response (self, error);
-                    return FALSE;
-                }
-            }
+#if defined WITH_IO_THREAD
+    if (priv->io_thread) {
+        const guint8 *chunk;
+        gsize chunk_len;
+
+        /* Written by the worker, which then calls
+         * mm_serial_port_command_sent() */
+        if (!command_next_chunk (self, info, &chunk, &chunk_len, &error))
+            mm_serial_port_got_response (self, error);
+        else
+            io_thread_write (self, chunk, chunk_len);
+        return FALSE;
+    }
+#endif
 
-            /* If the command is finished being sent, schedule the timeout */
-            priv->timeout_id = g_timeout_add_seconds (info->timeout,
-                                                      mm_serial_port_timed_out,
-                                                      self);
-        } else {
-            /* Schedule the next byte of the command to be sent */
-            mm_serial_port_schedule_queue_process (self, priv->send_delay / 1000);
-        }
-    } else
+    if (mm_serial_port_process_command (self, info, &error))
+        mm_serial_port_command_sent (self, info);
+    else
         mm_serial_port_got_response (self, error);
 
     return FALSE;
@@ -733,6 +1062,33 @@ parse_response (MMSerialPort *self,
     return MM_SERIAL_PORT_GET_CLASS (self)->parse_response (self, response, error);
 }
 
+static void
+process_incoming (MMSerialPort *self,
+                  const char *buf,
+                  gsize len)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+    GError *err = NULL;
+
+    serial_debug (self, "<--", buf, len);
+    response_append (priv, (const guint8 *) buf, len);
+
+    /* Make sure the response doesn't grow too long */
+    if ((priv->response->len > SERIAL_BUF_SIZE) && priv->spew_control) {
+        /* Notify listeners and then trim the buffer */
+        g_signal_emit (self, signals[BUFFER_FULL], 0, priv->response);
+        response_flush (self, SERIAL_BUF_SIZE / 2);
+    }
+
+    if (parse_response (self, priv->response, &err)) {
+        /* Reset number of consecutive timeouts only here */
+        priv->n_consecutive_timeouts = 0;
+        mm_serial_port_got_response (self, err);
+    } else
+        /* Unsolicited messages may have been the only thing in the buffer */
+        response_shrink_if_idle (self);
+}
+
 static gboolean
 data_available (GIOChannel *source,
                 GIOCondition condition,
@@ -750,15 +1106,13 @@ data_available (GIOChannel *source,
         device = mm_port_get_device (MM_PORT (self));
         mm_dbg ("(%s) unexpected port hangup!", device);
 
-        if (priv->response->len)
-            g_byte_array_remove_range (priv->response, 0, priv->response->len);
+        response_flush (self, priv->response->len);
         mm_serial_port_close_force (self);
         return FALSE;
     }
 
     if (condition & G_IO_ERR) {
-        if (priv->response->len)
-            g_byte_array_remove_range (priv->response, 0, priv->response->len);
+        response_flush (self, priv->response->len);
         return TRUE;
     }
 
@@ -786,27 +1140,419 @@ data_available (GIOChannel *source,
             break;
 
         g_assert (bytes_read > 0);
-        serial_debug (self, "<--", buf, bytes_read);
-        g_byte_array_append (priv->response, (const guint8 *) buf, bytes_read);
-
-        /* Make sure the response doesn't grow too long */
-        if ((priv->response->len > SERIAL_BUF_SIZE) && priv->spew_control) {
-            /* Notify listeners and then trim the buffer */
-            g_signal_emit (self, signals[BUFFER_FULL], 0, priv->response);
-            g_byte_array_remove_range (priv->response, 0, (SERIAL_BUF_SIZE / 2));
-        }
-
-        if (parse_response (self, priv->response, &err)) {
-            /* Reset number of consecutive timeouts only here */
-            priv->n_consecutive_timeouts = 0;
-            mm_serial_port_got_response (self, err);
-        }
+        process_incoming (self, buf, bytes_read);
     } while (   (bytes_read == SERIAL_BUF_SIZE || status == G_IO_STATUS_AGAIN)
              && (priv->watch_id > 0));
 
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Worker I/O thread
+ *
+ * When enabled, the calls which may block in the driver are done in a
+ * dedicated thread running its own GMainContext, so that they don't delay the
+ * main context: reading, writing commands, changing the port speed when
+ * flashing, and restoring the port settings and closing it. Incoming data is
+ * accumulated and handed over in batches to the main context, where the
+ * response parsing and the command queue are processed as usual (parsers may
+ * trigger URC handlers, which are not thread-safe).
+ */
+
+#if defined WITH_IO_THREAD
+
+/* Reading stops while this much data is waiting for the main context */
+#define IO_PENDING_MAX (4 * SERIAL_BUF_SIZE)
+
+static void io_thread_watch (MMSerialPort *self);
+
+/* Runs @func once in @context (NULL for the main one) */
+static void
+io_thread_post (GMainContext *context,
+                GSourceFunc func,
+                gpointer data)
+{
+    GSource *source;
+
+    source = g_idle_source_new ();
+    g_source_set_priority (source, G_PRIORITY_DEFAULT);
+    g_source_set_callback (source, func, data, NULL);
+    g_source_attach (source, context);
+    g_source_unref (source);
+}
+
+static gboolean
+io_thread_dispatch (MMSerialPort *self)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+    GByteArray *pending;
+    gboolean hangup;
+    MMQueueData *info;
+    guint offset;
+
+    g_mutex_lock (&priv->io_lock);
+    g_source_unref (priv->io_dispatch);
+    priv->io_dispatch = NULL;
+    hangup = priv->io_hangup;
+    priv->io_hangup = FALSE;
+    g_mutex_unlock (&priv->io_lock);
+
+    if (hangup) {
+        mm_dbg ("(%s) unexpected port hangup!", mm_port_get_device (MM_PORT (self)));
+        response_flush (self, priv->response->len);
+        mm_serial_port_close_force (self);
+        return FALSE;
+    }
+
+    /* Don't process any input if the current command isn't done being sent
+     * yet; we'll get re-scheduled once the command is fully written */
+    info = g_queue_peek_nth (priv->queue, 0);
+    if (info && (info->started == TRUE) && (info->done == FALSE))
+        return FALSE;
+
+    g_mutex_lock (&priv->io_lock);
+    pending = priv->io_pending;
+    priv->io_pending = g_byte_array_sized_new (SERIAL_BUF_SIZE);
+    /* Room again, read more */
+    if (priv->io_paused) {
+        priv->io_paused = FALSE;
+        io_thread_watch (self);
+    }
+    g_mutex_unlock (&priv->io_lock);
+
+    /* Feed the parser in the same chunk sizes used by the non-threaded
+     * reader, stop if the port gets closed in between */
+    for (offset = 0; offset < pending->len && priv->io_thread; offset += SERIAL_BUF_SIZE)
+        process_incoming (self,
+                          (const char *) &pending->data[offset],
+                          MIN (SERIAL_BUF_SIZE, pending->len - offset));
+
+    g_byte_array_unref (pending);
+    return FALSE;
+}
+
+/* Must be called with io_lock held */
+static void
+io_thread_schedule_dispatch (MMSerialPort *self)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+
+    if (priv->io_dispatch)
+        return;
+
+    /* Same priority as the reads done in the main context */
+    priv->io_dispatch = g_idle_source_new ();
+    g_source_set_priority (priv->io_dispatch, G_PRIORITY_DEFAULT);
+    g_source_set_callback (priv->io_dispatch,
+                           (GSourceFunc) io_thread_dispatch,
+                           g_object_ref (self),
+                           g_object_unref);
+    g_source_attach (priv->io_dispatch, NULL);
+}
+
+/* Runs in the worker thread */
+static gboolean
+io_thread_data_available (GIOChannel *source,
+                          GIOCondition condition,
+                          MMSerialPort *self)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+    char buf[SERIAL_BUF_SIZE];
+    gsize bytes_read;
+    GIOStatus status;
+
+    if (condition & G_IO_HUP) {
+        g_mutex_lock (&priv->io_lock);
+        priv->io_hangup = TRUE;
+        io_thread_schedule_dispatch (self);
+        g_mutex_unlock (&priv->io_lock);
+        return FALSE;
+    }
+
+    if (condition & G_IO_ERR)
+        return TRUE;
+
+    do {
+        g_mutex_lock (&priv->io_lock);
+        if (priv->io_pending->len >= IO_PENDING_MAX) {
+            /* Leave the rest in the kernel until the main context catches
+             * up; the watch is added back once the data is dispatched */
+            priv->io_paused = TRUE;
+            g_mutex_unlock (&priv->io_lock);
+            return FALSE;
+        }
+        g_mutex_unlock (&priv->io_lock);
+
+        bytes_read = 0;
+        status = g_io_channel_read_chars (source, buf, SERIAL_BUF_SIZE, &bytes_read, NULL);
+        if (bytes_read == 0)
+            break;
+
+        g_mutex_lock (&priv->io_lock);
+        g_byte_array_append (priv->io_pending, (const guint8 *) buf, bytes_read);
+        io_thread_schedule_dispatch (self);
+        g_mutex_unlock (&priv->io_lock);
+    } while (bytes_read == SERIAL_BUF_SIZE || status == G_IO_STATUS_AGAIN);
+
+    return TRUE;
+}
+
+/* (Re)creates the read watch in the worker context */
+static void
+io_thread_watch (MMSerialPort *self)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+
+    if (priv->io_watch) {
+        g_source_destroy (priv->io_watch);
+        g_source_unref (priv->io_watch);
+    }
+
+    priv->io_watch = g_io_create_watch (priv->channel, G_IO_IN | G_IO_ERR | G_IO_HUP);
+    g_source_set_callback (priv->io_watch,
+                           (GSourceFunc) io_thread_data_available,
+                           self,
+                           NULL);
+    g_source_attach (priv->io_watch, priv->io_context);
+}
+
+/* The thread owns a reference on the loop, as the port may be gone by the
+ * time the loop stops */
+static gpointer
+io_thread_func (GMainLoop *loop)
+{
+    GMainContext *context;
+
+    context = g_main_loop_get_context (loop);
+    g_main_context_push_thread_default (context);
+    g_main_loop_run (loop);
+    g_main_context_pop_thread_default (context);
+
+    g_main_loop_unref (loop);
+    return NULL;
+}
+
+static void
+io_thread_start (MMSerialPort *self)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+    gchar *name;
+
+    g_assert (priv->io_thread == NULL);
+
+    priv->io_pending = g_byte_array_sized_new (SERIAL_BUF_SIZE);
+    priv->io_context = g_main_context_new ();
+    priv->io_loop = g_main_loop_new (priv->io_context, FALSE);
+    io_thread_watch (self);
+
+    name = g_strdup_printf ("mm-io-%s", mm_port_get_device (MM_PORT (self)));
+    priv->io_thread = g_thread_new (name,
+                                    (GThreadFunc) io_thread_func,
+                                    g_main_loop_ref (priv->io_loop));
+    g_free (name);
+}
+
+/* Runs in the worker thread */
+static gboolean
+io_thread_sync_reached (MMSerialPortPrivate *priv)
+{
+    g_mutex_lock (&priv->io_lock);
+    priv->io_synced = TRUE;
+    g_cond_signal (&priv->io_cond);
+    g_mutex_unlock (&priv->io_lock);
+    return FALSE;
+}
+
+/* Waits for the worker to be done with whatever it was running, so that it
+ * no longer uses the port. All calls made by the worker are non-blocking
+ * except for the final close(), so this is quick. */
+static void
+io_thread_sync (MMSerialPort *self)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+
+    g_mutex_lock (&priv->io_lock);
+    priv->io_synced = FALSE;
+    io_thread_post (priv->io_context, (GSourceFunc) io_thread_sync_reached, priv);
+    while (!priv->io_synced)
+        g_cond_wait (&priv->io_cond, &priv->io_lock);
+    g_mutex_unlock (&priv->io_lock);
+}
+
+typedef struct {
+    gchar *device;
+    GThread *thread;
+    GMainLoop *loop;
+    int fd;
+    struct termios old_t;
+    gint64 elapsed;
+} IoCloseJob;
+
+/* Runs in the main context, once the worker is gone */
+static gboolean
+io_close_job_done (IoCloseJob *job)
+{
+    g_thread_join (job->thread);
+
+    mm_info ("(%s) serial port closed", job->device);
+
+    /* Some ports don't respond to data and when close is called
+     * the serial layer waits up to 30 second (closing_wait) for
+     * that data to send before giving up and returning from close().
+     * Log that.  See GNOME bug #630670 for more details.
+     */
+    if (job->elapsed > 7 * G_USEC_PER_SEC)
+        mm_warn ("(%s): close blocked by driver for more than 7 seconds!", job->device);
+
+    g_free (job->device);
+    g_slice_free (IoCloseJob, job);
+    return FALSE;
+}
+
+/* Runs in the worker thread, as its last job */
+static gboolean
+io_close_job_run (IoCloseJob *job)
+{
+    gint64 start;
+
+    start = g_get_monotonic_time ();
+    tcsetattr (job->fd, TCSANOW, &job->old_t);
+    tcflush (job->fd, TCIOFLUSH);
+    close (job->fd);
+    job->elapsed = g_get_monotonic_time () - start;
+
+    g_main_loop_quit (job->loop);
+    g_main_loop_unref (job->loop);
+    io_thread_post (NULL, (GSourceFunc) io_close_job_done, job);
+    return FALSE;
+}
+
+/* Stops the worker and leaves it closing the port file descriptor */
+static void
+io_thread_stop (MMSerialPort *self)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+    IoCloseJob *job;
+
+    g_assert (priv->io_thread != NULL);
+
+    g_source_destroy (priv->io_watch);
+    g_source_unref (priv->io_watch);
+    priv->io_watch = NULL;
+
+    io_thread_sync (self);
+
+    /* Replies of the requests still in the worker are ignored */
+    priv->io_write_job = NULL;
+    priv->io_flash_job = NULL;
+
+    job = g_slice_new0 (IoCloseJob);
+    job->device = g_strdup (mm_port_get_device (MM_PORT (self)));
+    job->thread = priv->io_thread;
+    job->loop = priv->io_loop;
+    job->fd = priv->fd;
+    job->old_t = priv->old_t;
+    io_thread_post (priv->io_context, (GSourceFunc) io_close_job_run, job);
+
+    priv->io_thread = NULL;
+    priv->io_loop = NULL;
+    g_main_context_unref (priv->io_context);
+    priv->io_context = NULL;
+    priv->fd = -1;
+
+    /* The worker no longer uses the port, no need to lock any more */
+    if (priv->io_dispatch) {
+        g_source_destroy (priv->io_dispatch);
+        g_source_unref (priv->io_dispatch);
+        priv->io_dispatch = NULL;
+    }
+    g_byte_array_unref (priv->io_pending);
+    priv->io_pending = NULL;
+    priv->io_hangup = FALSE;
+    priv->io_paused = FALSE;
+}
+
+static void
+io_thread_resume_dispatch (MMSerialPort *self)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+
+    if (!priv->io_thread)
+        return;
+
+    g_mutex_lock (&priv->io_lock);
+    if (priv->io_pending->len > 0)
+        io_thread_schedule_dispatch (self);
+    g_mutex_unlock (&priv->io_lock);
+}
+
+typedef struct {
+    MMSerialPort *self;
+    int fd;
+    GByteArray *data;
+    int status;
+    int errsv;
+} IoWriteJob;
+
+/* Runs in the main context */
+static gboolean
+io_write_job_done (IoWriteJob *job)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (job->self);
+
+    /* Ignore it if the port got closed meanwhile */
+    if (priv->io_write_job == job) {
+        MMQueueData *info;
+        GError *error = NULL;
+
+        priv->io_write_job = NULL;
+        info = g_queue_peek_head (priv->queue);
+        g_assert (info);
+        if (command_chunk_written (job->self, info, job->status, job->errsv, &error))
+            mm_serial_port_command_sent (job->self, info);
+        else
+            mm_serial_port_got_response (job->self, error);
+    }
+
+    g_byte_array_unref (job->data);
+    g_object_unref (job->self);
+    g_slice_free (IoWriteJob, job);
+    return FALSE;
+}
+
+/* Runs in the worker thread */
+static gboolean
+io_write_job_run (IoWriteJob *job)
+{
+    errno = 0;
+    job->status = write (job->fd, job->data->data, job->data->len);
+    job->errsv = errno;
+    io_thread_post (NULL, (GSourceFunc) io_write_job_done, job);
+    return FALSE;
+}
+
+static void
+io_thread_write (MMSerialPort *self,
+                 const guint8 *data,
+                 gsize len)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+    IoWriteJob *job;
+
+    g_assert (priv->io_write_job == NULL);
+
+    job = g_slice_new0 (IoWriteJob);
+    job->self = g_object_ref (self);
+    job->fd = priv->fd;
+    job->data = g_byte_array_sized_new (len);
+    g_byte_array_append (job->data, data, len);
+
+    priv->io_write_job = job;
+    io_thread_post (priv->io_context, (GSourceFunc) io_write_job_run, job);
+}
+
+#endif /* WITH_IO_THREAD */
+
 static void
 port_connected (MMSerialPort *self, GParamSpec *pspec, gpointer user_data)
 {
@@ -914,6 +1660,12 @@ mm_serial_port_open (MMSerialPort *self, GError **error)
 
     priv->channel = g_io_channel_unix_new (priv->fd);
     g_io_channel_set_encoding (priv->channel, NULL, NULL);
+#if defined WITH_IO_THREAD
+    if (priv->io_thread_enabled) {
+        mm_dbg ("(%s) reading from port in a worker thread", device);
+        io_thread_start (self);
+    } else
+#endif
     priv->watch_id = g_io_add_watch (priv->channel,
                                      G_IO_IN | G_IO_ERR | G_IO_HUP,
                                      data_available, self);
@@ -995,66 +1747,72 @@ mm_serial_port_close (MMSerialPort *self)
             }
         }
 
-        g_get_current_time (&tv_start);
-
-        if (priv->channel) {
-            g_source_remove (priv->watch_id);
-            priv->watch_id = 0;
-            g_io_channel_shutdown (priv->channel, TRUE, NULL);
+#if defined WITH_IO_THREAD
+        if (priv->io_thread) {
+            /* The worker restores the port settings and closes it, so that
+             * a driver blocking in close() doesn't block us */
+            io_thread_stop (self);
             g_io_channel_unref (priv->channel);
             priv->channel = NULL;
-        }
+        } else
+#endif
+        {
+            g_get_current_time (&tv_start);
 
-        tcsetattr (priv->fd, TCSANOW, &priv->old_t);
-        tcflush (priv->fd, TCIOFLUSH);
-        close (priv->fd);
-        priv->fd = -1;
+            if (priv->channel) {
+                if (priv->watch_id) {
+                    g_source_remove (priv->watch_id);
+                    priv->watch_id = 0;
+                }
+                g_io_channel_shutdown (priv->channel, TRUE, NULL);
+                g_io_channel_unref (priv->channel);
+                priv->channel = NULL;
+            }
 
-        g_get_current_time (&tv_end);
+            tcsetattr (priv->fd, TCSANOW, &priv->old_t);
+            tcflush (priv->fd, TCIOFLUSH);
+            close (priv->fd);
+            priv->fd = -1;
 
-        mm_info ("(%s) serial port closed", device);
+            g_get_current_time (&tv_end);
 
-        /* Some ports don't respond to data and when close is called
-         * the serial layer waits up to 30 second (closing_wait) for
-         * that data to send before giving up and returning from close().
-         * Log that.  See GNOME bug #630670 for more details.
-         */
-        if (tv_end.tv_sec - tv_start.tv_sec > 7)
-            mm_warn ("(%s): close blocked by driver for more than 7 seconds!", device);
+            mm_info ("(%s) serial port closed", device);
+
+            /* Some ports don't respond to data and when close is called
+             * the serial layer waits up to 30 second (closing_wait) for
+             * that data to send before giving up and returning from close().
+             * Log that.  See GNOME bug #630670 for more details.
+             */
+            if (tv_end.tv_sec - tv_start.tv_sec > 7)
+                mm_warn ("(%s): close blocked by driver for more than 7 seconds!", device);
+        }
     }
 
     /* Clear the command queue */
     for (i = 0; i < g_queue_get_length (priv->queue); i++) {
         MMQueueData *item = g_queue_peek_nth (priv->queue, i);
 
-        if (item->callback) {
+        if (item->callback || item->merged) {
             GError *error;
             GByteArray *response;
 
-            g_warn_if_fail (MM_SERIAL_PORT_GET_CLASS (self)->handle_response != NULL);
             error = g_error_new_literal (MM_SERIAL_ERROR,
                                          MM_SERIAL_ERROR_SEND_FAILED,
                                          "Serial port is now closed");
             response = g_byte_array_sized_new (1);
             g_byte_array_append (response, (const guint8 *) "\0", 1);
 
-            MM_SERIAL_PORT_GET_CLASS (self)->handle_response (self,
-                                                              response,
-                                                              error,
-                                                              item->callback,
-                                                              item->user_data);
+            queue_data_handle_response (self, item, response, error);
             g_error_free (error);
             g_byte_array_free (response, TRUE);
         }
 
-        g_clear_object (&item->cancellable);
-        g_byte_array_free (item->command, TRUE);
-        g_slice_free (MMQueueData, item);
+        queue_data_free (item);
     }
     g_queue_clear (priv->queue);
 
     if (priv->timeout_id) {
-        g_source_remove (priv->timeout_id);
+        mm_timer_wheel_remove (priv->timeout_id);
         priv->timeout_id = 0;
     }
 
@@ -1099,11 +1857,46 @@ mm_serial_port_close_force (MMSerialPort *self)
     g_signal_emit (self, signals[FORCED_CLOSE], 0);
 }
 
+static gboolean
+merge_queued_command (MMSerialPort *self,
+                      GByteArray *command,
+                      gboolean cached,
+                      GCancellable *cancellable,
+                      MMSerialResponseFn callback,
+                      gpointer user_data)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+    GList *l;
+
+    /* Look for the same background command, not sent yet */
+    for (l = priv->queue->head; l; l = g_list_next (l)) {
+        MMQueueData *info = l->data;
+        MMQueueCallback *merged;
+
+        if (info->started ||
+            info->priority != MM_SERIAL_PORT_PRIORITY_BACKGROUND ||
+            info->cached != cached ||
+            info->cancellable != cancellable ||
+            info->command->len != command->len ||
+            memcmp (info->command->data, command->data, command->len) != 0)
+            continue;
+
+        merged = g_slice_new (MMQueueCallback);
+        merged->callback = (GCallback) callback;
+        merged->user_data = user_data;
+        info->merged = g_slist_append (info->merged, merged);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
 static void
 internal_queue_command (MMSerialPort *self,
                         GByteArray *command,
                         gboolean take_command,
                         gboolean cached,
+                        MMSerialPortPriority priority,
                         guint32 timeout_seconds,
                         GCancellable *cancellable,
                         MMSerialResponseFn callback,
@@ -1125,6 +1918,15 @@ internal_queue_command (MMSerialPort *self,
         return;
     }
 
+    /* A background command already pending answers this one as well */
+    if (priority == MM_SERIAL_PORT_PRIORITY_BACKGROUND &&
+        callback &&
+        merge_queued_command (self, command, cached, cancellable, callback, user_data)) {
+        if (take_command)
+            g_byte_array_free (command, TRUE);
+        return;
+    }
+
     info = g_slice_new0 (MMQueueData);
     if (take_command)
         info->command = command;
@@ -1140,6 +1942,8 @@ internal_queue_command (MMSerialPort *self,
         info->eagain_count = 1000;
 
     info->cached = cached;
+    info->priority = priority;
+    info->queued_time = g_get_monotonic_time ();
     info->timeout = timeout_seconds;
     info->cancellable = (cancellable ? g_object_ref (cancellable) : NULL);
     info->callback = (GCallback) callback;
@@ -1164,7 +1968,7 @@ mm_serial_port_queue_command (MMSerialPort *self,
                               MMSerialResponseFn callback,
                               gpointer user_data)
 {
-    internal_queue_command (self, command, take_command, FALSE, timeout_seconds, cancellable, callback, user_data);
+    internal_queue_command (self, command, take_command, FALSE, MM_SERIAL_PORT_PRIORITY_INTERACTIVE, timeout_seconds, cancellable, callback, user_data);
 }
 
 void
@@ -1176,16 +1980,30 @@ mm_serial_port_queue_command_cached (MMSerialPort *self,
                                      MMSerialResponseFn callback,
                                      gpointer user_data)
 {
-    internal_queue_command (self, command, take_command, TRUE, timeout_seconds, cancellable, callback, user_data);
+    internal_queue_command (self, command, take_command, TRUE, MM_SERIAL_PORT_PRIORITY_INTERACTIVE, timeout_seconds, cancellable, callback, user_data);
+}
+
+void
+mm_serial_port_queue_command_full (MMSerialPort *self,
+                                   GByteArray *command,
+                                   gboolean take_command,
+                                   gboolean cached,
+                                   MMSerialPortPriority priority,
+                                   guint32 timeout_seconds,
+                                   GCancellable *cancellable,
+                                   MMSerialResponseFn callback,
+                                   gpointer user_data)
+{
+    internal_queue_command (self, command, take_command, cached, priority, timeout_seconds, cancellable, callback, user_data);
 }
 
 static gboolean
-get_speed (MMSerialPort *self, speed_t *speed, GError **error)
+get_speed (int fd, speed_t *speed, GError **error)
 {
     struct termios options;
 
     memset (&options, 0, sizeof (struct termios));
-    if (tcgetattr (MM_SERIAL_PORT_GET_PRIVATE (self)->fd, &options) != 0) {
+    if (tcgetattr (fd, &options) != 0) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_FAILED,
@@ -1198,16 +2016,14 @@ get_speed (MMSerialPort *self, speed_t *speed, GError **error)
     return TRUE;
 }
 
+/* May be called from the worker thread, so it doesn't use the port */
 static gboolean
-set_speed (MMSerialPort *self, speed_t speed, GError **error)
+set_speed (int fd, gboolean rts_cts, speed_t speed, GError **error)
 {
-    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
     struct termios options;
-    int fd, count = 4;
+    int count = 4;
     gboolean success = FALSE;
 
-    fd = MM_SERIAL_PORT_GET_PRIVATE (self)->fd;
-
     memset (&options, 0, sizeof (struct termios));
     if (tcgetattr (fd, &options) != 0) {
         g_set_error (error,
@@ -1223,7 +2039,7 @@ set_speed (MMSerialPort *self, speed_t speed, GError **error)
     options.c_cflag |= (CLOCAL | CREAD);
 
     /* Configure flow control as well here */
-    if (priv->rts_cts)
+    if (rts_cts)
         options.c_cflag |= (CRTSCTS);
 
     while (count-- > 0) {
@@ -1261,10 +2077,116 @@ set_speed (MMSerialPort *self, speed_t speed, GError **error)
 typedef struct {
     MMSerialPort *port;
     speed_t current_speed;
+    guint32 flash_time;
+    gboolean ignore_errors;
     MMSerialFlashFn callback;
     gpointer user_data;
 } FlashInfo;
 
+static gboolean flash_do (gpointer data);
+
+/* Drops the speed to B0, after saving the current one */
+static gboolean
+flash_start (int fd,
+             gboolean rts_cts,
+             FlashInfo *info,
+             GError **error)
+{
+    GError *inner_error = NULL;
+
+    /* Grab current speed so we can reset it after flashing */
+    if (!get_speed (fd, &info->current_speed, &inner_error) && !info->ignore_errors) {
+        g_propagate_error (error, inner_error);
+        return FALSE;
+    }
+    g_clear_error (&inner_error);
+
+    if (!set_speed (fd, rts_cts, B0, &inner_error) && !info->ignore_errors) {
+        g_propagate_error (error, inner_error);
+        return FALSE;
+    }
+    g_clear_error (&inner_error);
+
+    return TRUE;
+}
+
+static void
+flash_complete (FlashInfo *info,
+                GError *error)
+{
+    info->callback (info->port, error, info->user_data);
+    g_slice_free (FlashInfo, info);
+}
+
+#if defined WITH_IO_THREAD
+
+typedef struct {
+    MMSerialPort *self;
+    FlashInfo *info;
+    int fd;
+    gboolean rts_cts;
+    /* Whether starting the flash, or restoring the speed after it */
+    gboolean starting;
+    GError *error;
+} IoFlashJob;
+
+/* Runs in the main context */
+static gboolean
+io_flash_job_done (IoFlashJob *job)
+{
+    FlashInfo *info = job->info;
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (job->self);
+
+    if (priv->io_flash_job != job) {
+        /* Cancelled, or port closed */
+        g_slice_free (FlashInfo, info);
+    } else {
+        priv->io_flash_job = NULL;
+        if (job->starting && !job->error)
+            priv->flash_id = g_timeout_add (info->flash_time, flash_do, info);
+        else
+            flash_complete (info, job->error);
+    }
+
+    g_object_unref (job->self);
+    g_clear_error (&job->error);
+    g_slice_free (IoFlashJob, job);
+    return FALSE;
+}
+
+/* Runs in the worker thread */
+static gboolean
+io_flash_job_run (IoFlashJob *job)
+{
+    if (job->starting)
+        flash_start (job->fd, job->rts_cts, job->info, &job->error);
+    else
+        set_speed (job->fd, job->rts_cts, job->info->current_speed, &job->error);
+
+    io_thread_post (NULL, (GSourceFunc) io_flash_job_done, job);
+    return FALSE;
+}
+
+static void
+io_thread_flash (FlashInfo *info,
+                 gboolean starting)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (info->port);
+    IoFlashJob *job;
+
+    job = g_slice_new0 (IoFlashJob);
+    job->self = g_object_ref (info->port);
+    job->info = info;
+    job->fd = priv->fd;
+    job->rts_cts = priv->rts_cts;
+    job->starting = starting;
+
+    priv->io_flash_job = job;
+    io_thread_post (priv->io_context, (GSourceFunc) io_flash_job_run, job);
+}
+
+#endif /* WITH_IO_THREAD */
+
 static gboolean
 flash_do (gpointer data)
 {
@@ -1276,7 +2198,13 @@ flash_do (gpointer data)
 
     if (priv->flash_ok) {
         if (info->current_speed) {
-            if (!set_speed (info->port, info->current_speed, &error))
+#if defined WITH_IO_THREAD
+            if (priv->io_thread) {
+                io_thread_flash (info, FALSE);
+                return FALSE;
+            }
+#endif
+            if (!set_speed (priv->fd, priv->rts_cts, info->current_speed, &error))
                 g_assert (error);
         } else {
             error = g_error_new_literal (MM_SERIAL_ERROR,
@@ -1285,9 +2213,8 @@ flash_do (gpointer data)
         }
     }
 
-    info->callback (info->port, error, info->user_data);
+    flash_complete (info, error);
     g_clear_error (&error);
-    g_slice_free (FlashInfo, info);
     return FALSE;
 }
 
@@ -1301,7 +2228,6 @@ mm_serial_port_flash (MMSerialPort *self,
     FlashInfo *info = NULL;
     MMSerialPortPrivate *priv;
     GError *error = NULL;
-    gboolean success;
 
     g_return_val_if_fail (MM_IS_SERIAL_PORT (self), FALSE);
     g_return_val_if_fail (callback != NULL, FALSE);
@@ -1315,7 +2241,11 @@ mm_serial_port_flash (MMSerialPort *self,
         goto error;
     }
 
-    if (priv->flash_id > 0) {
+    if (priv->flash_id > 0
+#if defined WITH_IO_THREAD
+        || priv->io_flash_job
+#endif
+        ) {
         error = g_error_new_literal (MM_CORE_ERROR,
                                      MM_CORE_ERROR_IN_PROGRESS,
                                      "Modem is already being flashed.");
@@ -1324,20 +2254,20 @@ mm_serial_port_flash (MMSerialPort *self,
 
     info = g_slice_new0 (FlashInfo);
     info->port = self;
+    info->flash_time = flash_time;
+    info->ignore_errors = ignore_errors;
     info->callback = callback;
     info->user_data = user_data;
 
     if (priv->flash_ok) {
-        /* Grab current speed so we can reset it after flashing */
-        success = get_speed (self, &info->current_speed, &error);
-        if (!success && !ignore_errors)
-            goto error;
-        g_clear_error (&error);
-
-        success = set_speed (self, B0, &error);
-        if (!success && !ignore_errors)
+#if defined WITH_IO_THREAD
+        if (priv->io_thread) {
+            io_thread_flash (info, TRUE);
+            return TRUE;
+        }
+#endif
+        if (!flash_start (priv->fd, priv->rts_cts, info, &error))
             goto error;
-        g_clear_error (&error);
 
         priv->flash_id = g_timeout_add (flash_time, flash_do, info);
     } else
@@ -1366,6 +2296,11 @@ mm_serial_port_flash_cancel (MMSerialPort *self)
         g_source_remove (priv->flash_id);
         priv->flash_id = 0;
     }
+
+#if defined WITH_IO_THREAD
+    /* Its reply will be ignored */
+    priv->io_flash_job = NULL;
+#endif
 }
 
 gboolean
@@ -1376,6 +2311,60 @@ mm_serial_port_get_flash_ok (MMSerialPort *self)
     return MM_SERIAL_PORT_GET_PRIVATE (self)->flash_ok;
 }
 
+guint
+mm_serial_port_get_queue_length (MMSerialPort *self)
+{
+    g_return_val_if_fail (MM_IS_SERIAL_PORT (self), 0);
+
+    return g_queue_get_length (MM_SERIAL_PORT_GET_PRIVATE (self)->queue);
+}
+
+static gsize
+real_get_memory_usage (MMSerialPort *self)
+{
+    MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (self);
+    GTypeQuery query;
+    GHashTableIter iter;
+    GByteArray *command;
+    GByteArray *reply;
+    GList *l;
+    gsize usage;
+
+    g_type_query (G_OBJECT_TYPE (self), &query);
+    usage = query.instance_size + sizeof (MMSerialPortPrivate);
+
+    usage += sizeof (GByteArray) + priv->response_alloc;
+
+#if defined WITH_IO_THREAD
+    /* Data handed over from the worker thread */
+    g_mutex_lock (&priv->io_lock);
+    if (priv->io_pending)
+        usage += sizeof (GByteArray) + byte_array_alloc_size (MAX (priv->io_pending->len, SERIAL_BUF_SIZE));
+    g_mutex_unlock (&priv->io_lock);
+#endif
+
+    for (l = priv->queue->head; l; l = g_list_next (l)) {
+        MMQueueData *info = l->data;
+
+        usage += sizeof (MMQueueData) + sizeof (GByteArray) + info->command->len;
+        usage += g_slist_length (info->merged) * sizeof (MMQueueCallback);
+    }
+
+    g_hash_table_iter_init (&iter, priv->reply_cache);
+    while (g_hash_table_iter_next (&iter, (gpointer *)&command, (gpointer *)&reply))
+        usage += 2 * sizeof (GByteArray) + command->len + reply->len;
+
+    return usage;
+}
+
+gsize
+mm_serial_port_get_memory_usage (MMSerialPort *self)
+{
+    g_return_val_if_fail (MM_IS_SERIAL_PORT (self), 0);
+
+    return MM_SERIAL_PORT_GET_CLASS (self)->get_memory_usage (self);
+}
+
 /*****************************************************************************/
 
 MMSerialPort *
@@ -1443,9 +2432,15 @@ mm_serial_port_init (MMSerialPort *self)
     priv->parity = 'n';
     priv->stopbits = 1;
     priv->send_delay = 1000;
+    priv->aging_period = MM_SERIAL_PORT_PRIORITY_AGING_SEC * G_USEC_PER_SEC;
 
     priv->queue = g_queue_new ();
-    priv->response = g_byte_array_sized_new (500);
+    response_new (priv);
+
+#if defined WITH_IO_THREAD
+    g_mutex_init (&priv->io_lock);
+    g_cond_init (&priv->io_cond);
+#endif
 }
 
 static void
@@ -1486,6 +2481,20 @@ set_property (GObject *object, guint prop_id,
     case PROP_FLASH_OK:
         priv->flash_ok = g_value_get_boolean (value);
         break;
+    case PROP_IO_THREAD:
+        priv->io_thread_enabled = g_value_get_boolean (value);
+#if !defined WITH_IO_THREAD
+        if (priv->io_thread_enabled)
+            mm_warn ("Serial port worker threads not supported, need GLib >= 2.32");
+#endif
+        break;
+    case PROP_LOW_MEMORY:
+        priv->low_memory = g_value_get_boolean (value);
+        response_shrink_if_idle (MM_SERIAL_PORT (object));
+        break;
+    case PROP_AGING_PERIOD:
+        priv->aging_period = g_value_get_uint64 (value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -1530,6 +2539,15 @@ get_property (GObject *object, guint prop_id,
     case PROP_FLASH_OK:
         g_value_set_boolean (value, priv->flash_ok);
         break;
+    case PROP_IO_THREAD:
+        g_value_set_boolean (value, priv->io_thread_enabled);
+        break;
+    case PROP_LOW_MEMORY:
+        g_value_set_boolean (value, priv->low_memory);
+        break;
+    case PROP_AGING_PERIOD:
+        g_value_set_uint64 (value, priv->aging_period);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -1542,7 +2560,7 @@ dispose (GObject *object)
     MMSerialPortPrivate *priv = MM_SERIAL_PORT_GET_PRIVATE (object);
 
     if (priv->timeout_id) {
-        g_source_remove (priv->timeout_id);
+        mm_timer_wheel_remove (priv->timeout_id);
         priv->timeout_id = 0;
     }
 
@@ -1563,6 +2581,11 @@ finalize (GObject *object)
     g_byte_array_free (priv->response, TRUE);
     g_queue_free (priv->queue);
 
+#if defined WITH_IO_THREAD
+    g_mutex_clear (&priv->io_lock);
+    g_cond_clear (&priv->io_cond);
+#endif
+
     G_OBJECT_CLASS (mm_serial_port_parent_class)->finalize (object);
 }
 
@@ -1581,6 +2604,7 @@ mm_serial_port_class_init (MMSerialPortClass *klass)
 
     klass->config_fd = real_config_fd;
     klass->handle_response = real_handle_response;
+    klass->get_memory_usage = real_get_memory_usage;
 
     /* Properties */
     g_object_class_install_property
@@ -1656,6 +2680,35 @@ mm_serial_port_class_init (MMSerialPortClass *klass)
                                TRUE,
                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT));
 
+    g_object_class_install_property
+        (object_class, PROP_IO_THREAD,
+         g_param_spec_boolean (MM_SERIAL_PORT_IO_THREAD,
+                               "IoThread",
+                               "Do the blocking port I/O in a dedicated worker thread; "
+                               "applied when the port is opened.",
+                               FALSE,
+                               G_PARAM_READWRITE));
+
+    g_object_class_install_property
+        (object_class, PROP_LOW_MEMORY,
+         g_param_spec_boolean (MM_SERIAL_PORT_LOW_MEMORY,
+                               "LowMemory",
+                               "Keep the response buffer small, shrinking it "
+                               "back whenever the port is idle.",
+                               FALSE,
+                               G_PARAM_READWRITE));
+
+    g_object_class_install_property
+        (object_class, PROP_AGING_PERIOD,
+         g_param_spec_uint64 (MM_SERIAL_PORT_AGING_PERIOD,
+                              "AgingPeriod",
+                              "Time in microseconds a queued command waits "
+                              "before being bumped one priority class up; "
+                              "0 disables aging",
+                              0, G_MAXUINT64,
+                              MM_SERIAL_PORT_PRIORITY_AGING_SEC * G_USEC_PER_SEC,
+                              G_PARAM_READWRITE));
+
     /* Signals */
     signals[BUFFER_FULL] =
         g_signal_new ("buffer-full",
@@ -39,6 +39,9 @@
 #define MM_SERIAL_PORT_FD           "fd" /* Construct-only */
 #define MM_SERIAL_PORT_SPEW_CONTROL "spew-control" /* Construct-only */
 #define MM_SERIAL_PORT_FLASH_OK     "flash-ok" /* Construct-only */
+#define MM_SERIAL_PORT_IO_THREAD    "io-thread"
+#define MM_SERIAL_PORT_LOW_MEMORY   "low-memory"
+#define MM_SERIAL_PORT_AGING_PERIOD "aging-period"
 
 typedef struct _MMSerialPort MMSerialPort;
 typedef struct _MMSerialPortClass MMSerialPortClass;
@@ -52,6 +55,17 @@ typedef void (*MMSerialResponseFn)     (MMSerialPort *port,
                                         GError *error,
                                         gpointer user_data);
 
+/* Order in which queued commands are sent. Commands waiting for longer than
+ * the aging period (MM_SERIAL_PORT_PRIORITY_AGING_SEC unless the port's
+ * "aging-period" says otherwise) are bumped one class up for each period
+ * waited, so that background commands are never starved. */
+typedef enum {
+    MM_SERIAL_PORT_PRIORITY_INTERACTIVE, /* The default */
+    MM_SERIAL_PORT_PRIORITY_BACKGROUND   /* Polls; identical pending ones are merged */
+} MMSerialPortPriority;
+
+#define MM_SERIAL_PORT_PRIORITY_AGING_SEC 10
+
 
 struct _MMSerialPort {
     MMPort parent;
@@ -87,6 +101,12 @@ struct _MMSerialPortClass {
                                    GCallback callback,
                                    gpointer callback_data);
 
+    /* Called whenever data is removed from the start of the response buffer,
+     * be it a handled reply, a reply nobody waits for, or a flush, so that
+     * subclasses keeping parser state about the buffer contents can reset it.
+     */
+    void     (*response_flushed)  (MMSerialPort *self);
+
     /* Called to configure the serial port after it's opened.  On error, should
      * return FALSE and set 'error' as appropriate.
      */
@@ -97,6 +117,12 @@ struct _MMSerialPortClass {
                                    const char *buf,
                                    gsize len);
 
+    /* Returns an estimate of the heap memory used by the port, including
+     * buffers, queued commands and cached replies. Subclasses chain up
+     * and add their own data.
+     */
+    gsize (*get_memory_usage)     (MMSerialPort *self);
+
     /* Signals */
     void (*buffer_full)           (MMSerialPort *port, const GByteArray *buffer);
     void (*timed_out)             (MMSerialPort *port, guint n_consecutive_replies);
@@ -128,6 +154,12 @@ void     mm_serial_port_flash_cancel      (MMSerialPort *self);
 
 gboolean mm_serial_port_get_flash_ok      (MMSerialPort *self);
 
+/* Commands waiting to be sent, including the one being sent */
+guint    mm_serial_port_get_queue_length  (MMSerialPort *self);
+
+/* Estimated heap memory used by the port, in bytes */
+gsize    mm_serial_port_get_memory_usage  (MMSerialPort *self);
+
 void     mm_serial_port_queue_command     (MMSerialPort *self,
                                            GByteArray *command,
                                            gboolean take_command,
@@ -144,4 +176,14 @@ void     mm_serial_port_queue_command_cached (MMSerialPort *self,
                                               MMSerialResponseFn callback,
                                               gpointer user_data);
 
+void     mm_serial_port_queue_command_full (MMSerialPort *self,
+                                            GByteArray *command,
+                                            gboolean take_command,
+                                            gboolean cached,
+                                            MMSerialPortPriority priority,
+                                            guint32 timeout_seconds,
+                                            GCancellable *cancellable,
+                                            MMSerialResponseFn callback,
+                                            gpointer user_data);
+
 #endif /* MM_SERIAL_PORT_H */
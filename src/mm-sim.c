@@ -1406,6 +1406,86 @@ load_operator_name (MMSim *self,
                                    load_operator_name));
 }
 
+/*****************************************************************************/
+/* SIM data cache */
+
+/* What gets read from the SIM during initialization, kept by SIM identifier
+ * (ICCID) so that it isn't read again when the same SIM shows up after the
+ * modem gets reset or power cycled. */
+typedef struct {
+    gchar *imsi;
+    gchar *operator_identifier;
+    gchar *operator_name;
+} SimCacheEntry;
+
+#define SIM_CACHE_MAX_ENTRIES 32
+
+static GHashTable *sim_cache;
+
+static void
+sim_cache_entry_free (SimCacheEntry *entry)
+{
+    g_free (entry->imsi);
+    g_free (entry->operator_identifier);
+    g_free (entry->operator_name);
+    g_slice_free (SimCacheEntry, entry);
+}
+
+static void
+sim_cache_load (MMSim *self)
+{
+    SimCacheEntry *entry;
+    const gchar *iccid;
+
+    iccid = mm_gdbus_sim_get_sim_identifier (MM_GDBUS_SIM (self));
+    if (!iccid || !sim_cache)
+        return;
+
+    entry = g_hash_table_lookup (sim_cache, iccid);
+    if (!entry)
+        return;
+
+    mm_dbg ("loading SIM data from cache...");
+    if (!mm_gdbus_sim_get_imsi (MM_GDBUS_SIM (self)))
+        mm_gdbus_sim_set_imsi (MM_GDBUS_SIM (self), entry->imsi);
+    if (!mm_gdbus_sim_get_operator_identifier (MM_GDBUS_SIM (self)))
+        mm_gdbus_sim_set_operator_identifier (MM_GDBUS_SIM (self), entry->operator_identifier);
+    if (!mm_gdbus_sim_get_operator_name (MM_GDBUS_SIM (self)))
+        mm_gdbus_sim_set_operator_name (MM_GDBUS_SIM (self), entry->operator_name);
+}
+
+static void
+sim_cache_store (MMSim *self)
+{
+    SimCacheEntry *entry;
+    const gchar *iccid;
+    const gchar *imsi;
+
+    /* Without IMSI the SIM wasn't properly read; try again next time. Other
+     * missing fields are re-read on every cache hit. */
+    iccid = mm_gdbus_sim_get_sim_identifier (MM_GDBUS_SIM (self));
+    imsi = mm_gdbus_sim_get_imsi (MM_GDBUS_SIM (self));
+    if (!iccid || !imsi)
+        return;
+
+    if (G_UNLIKELY (!sim_cache))
+        sim_cache = g_hash_table_new_full (g_str_hash,
+                                           g_str_equal,
+                                           g_free,
+                                           (GDestroyNotify)sim_cache_entry_free);
+
+    /* Plenty for the SIMs a single host sees; just start over if full */
+    if (g_hash_table_size (sim_cache) >= SIM_CACHE_MAX_ENTRIES &&
+        !g_hash_table_lookup (sim_cache, iccid))
+        g_hash_table_remove_all (sim_cache);
+
+    entry = g_slice_new (SimCacheEntry);
+    entry->imsi = g_strdup (imsi);
+    entry->operator_identifier = g_strdup (mm_gdbus_sim_get_operator_identifier (MM_GDBUS_SIM (self)));
+    entry->operator_name = g_strdup (mm_gdbus_sim_get_operator_name (MM_GDBUS_SIM (self)));
+    g_hash_table_replace (sim_cache, g_strdup (iccid), entry);
+}
+
 /*****************************************************************************/
 
 typedef struct _InitAsyncContext InitAsyncContext;
@@ -1414,9 +1494,9 @@ static void interface_initialization_step (InitAsyncContext *ctx);
 typedef enum {
     INITIALIZATION_STEP_FIRST,
     INITIALIZATION_STEP_SIM_IDENTIFIER,
-    INITIALIZATION_STEP_IMSI,
-    INITIALIZATION_STEP_OPERATOR_ID,
-    INITIALIZATION_STEP_OPERATOR_NAME,
+    INITIALIZATION_STEP_CACHE_LOOKUP,
+    INITIALIZATION_STEP_SIM_DATA,
+    INITIALIZATION_STEP_CACHE_STORE,
     INITIALIZATION_STEP_LAST
 } InitializationStep;
 
@@ -1426,6 +1506,7 @@ struct _InitAsyncContext {
     MMSim *self;
     InitializationStep step;
     guint sim_identifier_tries;
+    guint pending_loads;
 };
 
 static void
@@ -1501,8 +1582,22 @@ load_sim_identifier_ready (MMSim *self,
     interface_initialization_step (ctx);
 }
 
+static void
+sim_data_load_done (InitAsyncContext *ctx)
+{
+    g_assert (ctx->pending_loads > 0);
+    if (--ctx->pending_loads > 0)
+        return;
+
+    /* Go on to next step */
+    ctx->step++;
+    interface_initialization_step (ctx);
+}
+
+static void load_operator_identifier_if_needed (InitAsyncContext *ctx);
+
 #undef STR_REPLY_READY_FN
-#define STR_REPLY_READY_FN(NAME,DISPLAY)                                \
+#define STR_REPLY_READY_FN(NAME,DISPLAY,NEXT)                           \
     static void                                                         \
     load_##NAME##_ready (MMSim *self,                                   \
                          GAsyncResult *res,                             \
@@ -1520,14 +1615,29 @@ load_sim_identifier_ready (MMSim *self,
             g_error_free (error);                                       \
         }                                                               \
                                                                         \
-        /* Go on to next step */                                        \
-        ctx->step++;                                                    \
-        interface_initialization_step (ctx);                            \
+        NEXT (ctx);                                                     \
     }
 
-STR_REPLY_READY_FN (imsi, "IMSI")
-STR_REPLY_READY_FN (operator_identifier, "Operator identifier")
-STR_REPLY_READY_FN (operator_name, "Operator name")
+STR_REPLY_READY_FN (imsi, "IMSI", load_operator_identifier_if_needed)
+STR_REPLY_READY_FN (operator_identifier, "Operator identifier", sim_data_load_done)
+STR_REPLY_READY_FN (operator_name, "Operator name", sim_data_load_done)
+
+static void
+load_operator_identifier_if_needed (InitAsyncContext *ctx)
+{
+    /* Operator ID is built from the IMSI, so it's loaded right after it */
+    if (mm_gdbus_sim_get_operator_identifier (MM_GDBUS_SIM (ctx->self)) == NULL &&
+        MM_SIM_GET_CLASS (ctx->self)->load_operator_identifier &&
+        MM_SIM_GET_CLASS (ctx->self)->load_operator_identifier_finish) {
+        MM_SIM_GET_CLASS (ctx->self)->load_operator_identifier (
+            ctx->self,
+            (GAsyncReadyCallback)load_operator_identifier_ready,
+            ctx);
+        return;
+    }
+
+    sim_data_load_done (ctx);
+}
 
 static void
 interface_initialization_step (InitAsyncContext *ctx)
@@ -1553,51 +1663,48 @@ interface_initialization_step (InitAsyncContext *ctx)
         /* Fall down to next step */
         ctx->step++;
 
-    case INITIALIZATION_STEP_IMSI:
-        /* IMSI is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_sim_get_imsi (MM_GDBUS_SIM (ctx->self)) == NULL &&
-            MM_SIM_GET_CLASS (ctx->self)->load_imsi &&
-            MM_SIM_GET_CLASS (ctx->self)->load_imsi_finish) {
-            MM_SIM_GET_CLASS (ctx->self)->load_imsi (
-                ctx->self,
-                (GAsyncReadyCallback)load_imsi_ready,
-                ctx);
-            return;
-        }
+    case INITIALIZATION_STEP_CACHE_LOOKUP:
+        /* Same SIM as seen before? Then we already know what's in it. The
+         * entry may lack some fields (e.g. the operator name failed to load
+         * last time), so the next step still reads whatever is missing. */
+        sim_cache_load (ctx->self);
         /* Fall down to next step */
         ctx->step++;
 
-    case INITIALIZATION_STEP_OPERATOR_ID:
-        /* Operator ID is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_sim_get_operator_identifier (MM_GDBUS_SIM (ctx->self)) == NULL &&
-            MM_SIM_GET_CLASS (ctx->self)->load_operator_identifier &&
-            MM_SIM_GET_CLASS (ctx->self)->load_operator_identifier_finish) {
-            MM_SIM_GET_CLASS (ctx->self)->load_operator_identifier (
-                ctx->self,
-                (GAsyncReadyCallback)load_operator_identifier_ready,
-                ctx);
-            return;
-        }
-        /* Fall down to next step */
-        ctx->step++;
+    case INITIALIZATION_STEP_SIM_DATA: {
+        gboolean load_operator_name;
 
-    case INITIALIZATION_STEP_OPERATOR_NAME:
-        /* Operator Name is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_sim_get_operator_name (MM_GDBUS_SIM (ctx->self)) == NULL &&
-            MM_SIM_GET_CLASS (ctx->self)->load_operator_name &&
-            MM_SIM_GET_CLASS (ctx->self)->load_operator_name_finish) {
+        /* IMSI, Operator ID and Operator Name are meant to be loaded only
+         * once during the whole lifetime of the modem. Therefore, if we
+         * already have them loaded, don't try to load them again.
+         *
+         * Operator Name doesn't depend on the others, so it's loaded at
+         * the same time as IMSI and Operator ID. */
+        load_operator_name = (mm_gdbus_sim_get_operator_name (MM_GDBUS_SIM (ctx->self)) == NULL &&
+                              MM_SIM_GET_CLASS (ctx->self)->load_operator_name &&
+                              MM_SIM_GET_CLASS (ctx->self)->load_operator_name_finish);
+        ctx->pending_loads = (load_operator_name ? 2 : 1);
+
+        if (load_operator_name)
             MM_SIM_GET_CLASS (ctx->self)->load_operator_name (
                 ctx->self,
                 (GAsyncReadyCallback)load_operator_name_ready,
                 ctx);
-            return;
-        }
+
+        if (mm_gdbus_sim_get_imsi (MM_GDBUS_SIM (ctx->self)) == NULL &&
+            MM_SIM_GET_CLASS (ctx->self)->load_imsi &&
+            MM_SIM_GET_CLASS (ctx->self)->load_imsi_finish)
+            MM_SIM_GET_CLASS (ctx->self)->load_imsi (
+                ctx->self,
+                (GAsyncReadyCallback)load_imsi_ready,
+                ctx);
+        else
+            load_operator_identifier_if_needed (ctx);
+        return;
+    }
+
+    case INITIALIZATION_STEP_CACHE_STORE:
+        sim_cache_store (ctx->self);
         /* Fall down to next step */
         ctx->step++;
 
@@ -1633,6 +1740,7 @@ common_init_async (GAsyncInitable *initable,
                         NULL);
     ctx->step = INITIALIZATION_STEP_FIRST;
     ctx->sim_identifier_tries = 0;
+    ctx->pending_loads = 0;
 
     interface_initialization_step (ctx);
 }
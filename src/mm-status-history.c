@@ -0,0 +1,133 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include "mm-status-history.h"
+
+struct _MMStatusHistory {
+    /* Generation of the last change of each object, keyed by path */
+    GHashTable *updated;
+    /* Removed objects, keyed by path, with the removal generation */
+    GHashTable *removed;
+    guint max_removed;
+    /* Generation counter, bumped on every change */
+    guint64 generation;
+    /* Changes older than this generation are no longer known */
+    guint64 oldest_known;
+};
+
+MMStatusHistory *
+mm_status_history_new (guint64 base,
+                       guint max_removed)
+{
+    MMStatusHistory *self;
+
+    /* Random epoch in the upper half, so that generations of different
+     * instances don't overlap */
+    if (!base)
+        base = ((guint64) g_random_int_range (1, G_MAXINT32)) << 32;
+
+    self = g_slice_new0 (MMStatusHistory);
+    self->updated = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    self->removed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    self->max_removed = max_removed;
+    self->generation = base;
+    self->oldest_known = base;
+    return self;
+}
+
+void
+mm_status_history_free (MMStatusHistory *self)
+{
+    g_hash_table_destroy (self->updated);
+    g_hash_table_destroy (self->removed);
+    g_slice_free (MMStatusHistory, self);
+}
+
+guint64
+mm_status_history_get_generation (MMStatusHistory *self)
+{
+    return self->generation;
+}
+
+void
+mm_status_history_update (MMStatusHistory *self,
+                          const gchar *path)
+{
+    self->generation++;
+    g_hash_table_remove (self->removed, path);
+    g_hash_table_replace (self->updated,
+                          g_strdup (path),
+                          g_memdup (&self->generation, sizeof (guint64)));
+}
+
+void
+mm_status_history_remove (MMStatusHistory *self,
+                          const gchar *path)
+{
+    if (!g_hash_table_remove (self->updated, path))
+        return;
+
+    /* Forget about all removals if too many of them; clients asking for
+     * changes since before this point will get a complete list */
+    if (g_hash_table_size (self->removed) >= self->max_removed) {
+        g_hash_table_remove_all (self->removed);
+        self->oldest_known = self->generation;
+    }
+
+    self->generation++;
+    g_hash_table_insert (self->removed,
+                         g_strdup (path),
+                         g_memdup (&self->generation, sizeof (guint64)));
+}
+
+static GPtrArray *
+paths_since (GHashTable *table,
+             guint64 since)
+{
+    GPtrArray *paths;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    paths = g_ptr_array_new_with_free_func (g_free);
+    g_hash_table_iter_init (&iter, table);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        if (*((guint64 *) value) > since)
+            g_ptr_array_add (paths, g_strdup ((const gchar *) key));
+    }
+    return paths;
+}
+
+gboolean
+mm_status_history_get_changes (MMStatusHistory *self,
+                               guint64 since,
+                               GPtrArray **changed,
+                               GPtrArray **removed)
+{
+    gboolean complete;
+
+    /* Generation of another instance, or changes no longer tracked */
+    complete = (since > self->generation ||
+                since < self->oldest_known);
+
+    if (complete) {
+        *changed = paths_since (self->updated, 0);
+        *removed = g_ptr_array_new_with_free_func (g_free);
+    } else {
+        *changed = paths_since (self->updated, since);
+        *removed = paths_since (self->removed, since);
+    }
+
+    return complete;
+}
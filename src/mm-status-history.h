@@ -0,0 +1,56 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#ifndef MM_STATUS_HISTORY_H
+#define MM_STATUS_HISTORY_H
+
+#include <glib.h>
+
+/* Tracks which objects, keyed by path, were updated or removed after a given
+ * generation, so that clients can ask for the changes since their last
+ * query.
+ *
+ * Generations start at a random base on every instance, so that a generation
+ * given by a previous instance (e.g. before a daemon restart) falls out of
+ * the known range and gets a complete list instead of a wrong delta.
+ */
+
+typedef struct _MMStatusHistory MMStatusHistory;
+
+/* A @base of 0 picks a random one. At most @max_removed removals are
+ * remembered; changes since before the oldest forgotten one are no longer
+ * known. */
+MMStatusHistory *mm_status_history_new  (guint64 base,
+                                         guint max_removed);
+void             mm_status_history_free (MMStatusHistory *self);
+
+guint64  mm_status_history_get_generation (MMStatusHistory *self);
+
+/* Object added or changed */
+void     mm_status_history_update         (MMStatusHistory *self,
+                                           const gchar *path);
+void     mm_status_history_remove         (MMStatusHistory *self,
+                                           const gchar *path);
+
+/* Paths of the objects updated and removed after @since, as arrays of
+ * strings owned by the caller. Returns TRUE if @since is not a known
+ * generation, in which case @changed holds every object and @removed is
+ * empty. */
+gboolean mm_status_history_get_changes    (MMStatusHistory *self,
+                                           guint64 since,
+                                           GPtrArray **changed,
+                                           GPtrArray **removed);
+
+#endif /* MM_STATUS_HISTORY_H */
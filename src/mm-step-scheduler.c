@@ -0,0 +1,302 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include "mm-step-scheduler.h"
+#include "mm-log.h"
+#include "mm-trace.h"
+
+struct _MMStepScheduler {
+    gchar *name;
+    const MMStepInfo *steps;
+    guint n_steps;
+    gpointer user_data;
+
+    guint slots[MM_STEP_PORT_LAST];
+    guint busy[MM_STEP_PORT_LAST];
+    MMStepPort port_map[MM_STEP_PORT_LAST];
+
+    /* MM_STEP() masks */
+    guint64 launched;
+    guint64 running;
+    guint64 done;
+
+    gint64 start_time;
+    gint64 *step_start_time;
+
+    /* Concurrent steps are traced in separate lanes, so that they don't
+     * overlap in the timeline */
+    gchar *trace_track;
+    guint *step_lane;
+    guint64 lanes;
+
+    gboolean aborted;
+    gboolean dispatching;
+    gboolean redispatch;
+
+    GCancellable *cancellable;
+    MMStepSchedulerDoneFn callback;
+    gpointer callback_data;
+};
+
+MMStepScheduler *
+mm_step_scheduler_new (const gchar *name,
+                       const MMStepInfo *steps,
+                       guint n_steps,
+                       gpointer user_data)
+{
+    MMStepScheduler *self;
+    guint i;
+
+    g_return_val_if_fail (n_steps > 0 && n_steps <= 64, NULL);
+
+    for (i = 0; i < n_steps; i++) {
+        /* Only depend on previous steps, so that there are no cycles */
+        g_return_val_if_fail ((steps[i].depends & ~(MM_STEP (i) - 1)) == 0, NULL);
+        g_return_val_if_fail (steps[i].run != NULL, NULL);
+        g_return_val_if_fail (steps[i].port < MM_STEP_PORT_LAST, NULL);
+    }
+
+    self = g_slice_new0 (MMStepScheduler);
+    self->name = g_strdup (name);
+    self->steps = steps;
+    self->n_steps = n_steps;
+    self->user_data = user_data;
+    self->step_start_time = g_new0 (gint64, n_steps);
+    self->step_lane = g_new0 (guint, n_steps);
+
+    for (i = 0; i < MM_STEP_PORT_LAST; i++) {
+        self->slots[i] = 1;
+        self->port_map[i] = i;
+    }
+
+    return self;
+}
+
+void
+mm_step_scheduler_free (MMStepScheduler *self)
+{
+    g_return_if_fail (self != NULL);
+
+    g_warn_if_fail (self->running == 0);
+    if (self->cancellable)
+        g_object_unref (self->cancellable);
+    g_free (self->step_start_time);
+    g_free (self->step_lane);
+    g_free (self->trace_track);
+    g_free (self->name);
+    g_slice_free (MMStepScheduler, self);
+}
+
+void
+mm_step_scheduler_set_port_slots (MMStepScheduler *self,
+                                  MMStepPort port,
+                                  guint slots)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (port < MM_STEP_PORT_LAST);
+
+    /* Steps using a port which isn't there will just fail by themselves */
+    self->slots[port] = MAX (slots, 1);
+}
+
+void
+mm_step_scheduler_remap_port (MMStepScheduler *self,
+                              MMStepPort from,
+                              MMStepPort to)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (from != MM_STEP_PORT_NONE && from < MM_STEP_PORT_LAST);
+    g_return_if_fail (to < MM_STEP_PORT_LAST);
+    g_return_if_fail (self->launched == 0);
+
+    self->port_map[from] = to;
+}
+
+void
+mm_step_scheduler_set_trace_track (MMStepScheduler *self,
+                                   const gchar *track)
+{
+    g_return_if_fail (self != NULL);
+
+    g_free (self->trace_track);
+    self->trace_track = g_strdup (track);
+}
+
+gboolean
+mm_step_scheduler_is_aborted (MMStepScheduler *self)
+{
+    g_return_val_if_fail (self != NULL, TRUE);
+
+    return self->aborted;
+}
+
+gdouble
+mm_step_scheduler_get_elapsed (MMStepScheduler *self)
+{
+    g_return_val_if_fail (self != NULL, 0.0);
+
+    return (g_get_monotonic_time () - self->start_time) / (gdouble) G_USEC_PER_SEC;
+}
+
+static MMStepPort
+step_port (MMStepScheduler *self,
+           guint step)
+{
+    return self->port_map[self->steps[step].port];
+}
+
+static gboolean
+step_can_launch (MMStepScheduler *self,
+                 guint step)
+{
+    const MMStepInfo *info = &self->steps[step];
+    MMStepPort port;
+
+    if (self->launched & MM_STEP (step))
+        return FALSE;
+    if ((self->done & info->depends) != info->depends)
+        return FALSE;
+    port = step_port (self, step);
+    if (port != MM_STEP_PORT_NONE &&
+        self->busy[port] >= self->slots[port])
+        return FALSE;
+    return TRUE;
+}
+
+static void
+dispatch (MMStepScheduler *self)
+{
+    guint64 all;
+    guint i;
+
+    /* Steps may finish while being launched; the outer loop takes care of
+     * launching the ones depending on them */
+    if (self->dispatching) {
+        self->redispatch = TRUE;
+        return;
+    }
+
+    self->dispatching = TRUE;
+    do {
+        self->redispatch = FALSE;
+
+        if (self->cancellable && g_cancellable_is_cancelled (self->cancellable))
+            self->aborted = TRUE;
+
+        for (i = 0; i < self->n_steps && !self->aborted; i++) {
+            const MMStepInfo *info = &self->steps[i];
+            MMStepPort port;
+            guint lane;
+
+            if (!step_can_launch (self, i))
+                continue;
+
+            self->launched |= MM_STEP (i);
+            self->running |= MM_STEP (i);
+            port = step_port (self, i);
+            if (port != MM_STEP_PORT_NONE)
+                self->busy[port]++;
+            self->step_start_time[i] = g_get_monotonic_time ();
+            /* At most 64 steps, so there's always a free lane */
+            lane = 0;
+            while (self->lanes & MM_STEP (lane))
+                lane++;
+            self->lanes |= MM_STEP (lane);
+            self->step_lane[i] = lane;
+            info->run (self, i, self->user_data);
+        }
+    } while (self->redispatch && !self->aborted);
+    self->dispatching = FALSE;
+
+    if (self->running)
+        return;
+
+    all = (self->n_steps == 64 ? G_MAXUINT64 : MM_STEP (self->n_steps) - 1);
+    if (self->done != all)
+        self->aborted = TRUE;
+
+    mm_dbg ("(%s) %s in %.3fs",
+            self->name,
+            self->aborted ? "aborted" : "finished",
+            mm_step_scheduler_get_elapsed (self));
+
+    /* Last thing to do, the scheduler may get freed */
+    self->callback (self, self->callback_data);
+}
+
+void
+mm_step_scheduler_run (MMStepScheduler *self,
+                       GCancellable *cancellable,
+                       MMStepSchedulerDoneFn callback,
+                       gpointer user_data)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (callback != NULL);
+    g_return_if_fail (self->launched == 0);
+
+    if (cancellable)
+        self->cancellable = g_object_ref (cancellable);
+    self->callback = callback;
+    self->callback_data = user_data;
+    self->start_time = g_get_monotonic_time ();
+
+    dispatch (self);
+}
+
+void
+mm_step_scheduler_step_done (MMStepScheduler *self,
+                             guint step)
+{
+    const MMStepInfo *info;
+    MMStepPort port;
+
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (step < self->n_steps);
+    g_return_if_fail (self->running & MM_STEP (step));
+
+    info = &self->steps[step];
+    self->running &= ~MM_STEP (step);
+    self->done |= MM_STEP (step);
+    port = step_port (self, step);
+    if (port != MM_STEP_PORT_NONE)
+        self->busy[port]--;
+    self->lanes &= ~MM_STEP (self->step_lane[step]);
+
+    if (mm_trace_enabled ()) {
+        gchar *track;
+
+        track = g_strdup_printf ("%s: %s #%u",
+                                 self->trace_track ? self->trace_track : "steps",
+                                 self->name,
+                                 self->step_lane[step]);
+        mm_trace_span ("step", track, self->step_start_time[step], info->name, NULL);
+        g_free (track);
+    }
+
+    mm_dbg ("(%s) step '%s' done in %.3fs",
+            self->name,
+            info->name,
+            (g_get_monotonic_time () - self->step_start_time[step]) / (gdouble) G_USEC_PER_SEC);
+
+    dispatch (self);
+}
+
+void
+mm_step_scheduler_abort (MMStepScheduler *self)
+{
+    g_return_if_fail (self != NULL);
+
+    self->aborted = TRUE;
+}
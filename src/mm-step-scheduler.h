@@ -0,0 +1,101 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#ifndef MM_STEP_SCHEDULER_H
+#define MM_STEP_SCHEDULER_H
+
+#include <glib.h>
+#include <gio/gio.h>
+
+/* Runs a table of asynchronous steps, launching each one as soon as the
+ * steps it depends on are done and the kind of port it talks to has a free
+ * slot. Independent steps therefore run concurrently, up to one per port.
+ *
+ * A step may only depend on steps listed before it in the table, so the
+ * table order is always a valid sequential order. At most 64 steps.
+ */
+
+/* Kind of port a step sends requests to */
+typedef enum {
+    MM_STEP_PORT_NONE, /* Local work only; never waits for a slot */
+    MM_STEP_PORT_AT,
+    MM_STEP_PORT_QCDM,
+    MM_STEP_PORT_QMI,
+    MM_STEP_PORT_LAST
+} MMStepPort;
+
+#define MM_STEP(step) (G_GUINT64_CONSTANT (1) << (step))
+
+typedef struct _MMStepScheduler MMStepScheduler;
+
+/* Launches the step; mm_step_scheduler_step_done() must be called once it
+ * finishes, which may be right away */
+typedef void (* MMStepRunFn) (MMStepScheduler *scheduler,
+                              guint step,
+                              gpointer user_data);
+
+/* Called once all steps are done, or once the running ones finish after the
+ * scheduler got aborted or cancelled. The scheduler may be freed here. */
+typedef void (* MMStepSchedulerDoneFn) (MMStepScheduler *scheduler,
+                                        gpointer user_data);
+
+typedef struct {
+    const gchar *name;
+    MMStepRunFn run;
+    guint64 depends; /* MM_STEP() mask of steps which must be done before */
+    MMStepPort port;
+} MMStepInfo;
+
+MMStepScheduler *mm_step_scheduler_new (const gchar *name,
+                                        const MMStepInfo *steps,
+                                        guint n_steps,
+                                        gpointer user_data);
+void             mm_step_scheduler_free (MMStepScheduler *self);
+
+/* Number of steps which may talk to the given kind of port at the same time;
+ * defaults to 1 */
+void     mm_step_scheduler_set_port_slots (MMStepScheduler *self,
+                                           MMStepPort port,
+                                           guint slots);
+
+/* Steps declared for port 'from' talk to port 'to' instead, e.g. when the
+ * modem implements the loaders over QMI rather than AT. Must be called
+ * before running. */
+void     mm_step_scheduler_remap_port     (MMStepScheduler *self,
+                                           MMStepPort from,
+                                           MMStepPort to);
+
+void     mm_step_scheduler_run            (MMStepScheduler *self,
+                                           GCancellable *cancellable,
+                                           MMStepSchedulerDoneFn callback,
+                                           gpointer user_data);
+void     mm_step_scheduler_step_done      (MMStepScheduler *self,
+                                           guint step);
+
+/* No new steps are launched after this */
+void     mm_step_scheduler_abort          (MMStepScheduler *self);
+
+/* Steps are recorded in the timeline (see mm-trace.h) under this track
+ * name, usually the modem device */
+void     mm_step_scheduler_set_trace_track (MMStepScheduler *self,
+                                            const gchar *track);
+
+/* Whether some steps were not run, due to abort or cancellation */
+gboolean mm_step_scheduler_is_aborted     (MMStepScheduler *self);
+
+/* Seconds since mm_step_scheduler_run() */
+gdouble  mm_step_scheduler_get_elapsed    (MMStepScheduler *self);
+
+#endif /* MM_STEP_SCHEDULER_H */
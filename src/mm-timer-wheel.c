@@ -0,0 +1,436 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <string.h>
+
+#include "mm-timer-wheel.h"
+
+/* Three levels of 64 slots each: level 0 has 1s slots (64s range), level 1
+ * has 64s slots (~68min range) and level 2 has 4096s slots (~72h range).
+ * Anything further away is parked in the last level 2 slot and re-evaluated
+ * when that slot gets cascaded. */
+#define WHEEL_LEVELS    3
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS     (1 << WHEEL_SLOT_BITS)
+#define WHEEL_SLOT_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_RANGE(level) ((guint64)1 << (WHEEL_SLOT_BITS * ((level) + 1)))
+#define WHEEL_INDEX(tick, level) \
+    ((guint)(((tick) >> (WHEEL_SLOT_BITS * (level))) & WHEEL_SLOT_MASK))
+
+typedef struct {
+    guint id;
+    guint interval;
+    guint coalesce_window;
+    GSourceFunc function;
+    gpointer data;
+
+    /* Absolute expiration, in monotonic seconds */
+    guint64 expires;
+
+    /* List where the timer is currently linked */
+    GList **head;
+    GList *link;
+
+    gboolean dispatching;
+    gboolean removed;
+} Timer;
+
+typedef struct {
+    GList *slots[WHEEL_LEVELS][WHEEL_SLOTS];
+    GList *expired;
+
+    /* Next tick to process */
+    guint64 current;
+
+    GHashTable *timers;
+    guint last_id;
+
+    guint source_id;
+    guint64 armed_tick;
+
+    guint64 n_wakeups;
+    guint64 n_dispatched;
+} Wheel;
+
+static Wheel *wheel;
+
+static gboolean wheel_dispatch (gpointer unused);
+
+/*****************************************************************************/
+
+static guint64
+now_usec (void)
+{
+    return (guint64) g_get_monotonic_time ();
+}
+
+static guint64
+now_tick (void)
+{
+    return now_usec () / G_USEC_PER_SEC;
+}
+
+static void
+timer_unlink (Timer *timer)
+{
+    if (timer->head) {
+        *timer->head = g_list_delete_link (*timer->head, timer->link);
+        timer->head = NULL;
+        timer->link = NULL;
+    }
+}
+
+static void
+timer_link (Timer *timer,
+            GList **head)
+{
+    g_assert (timer->head == NULL);
+
+    *head = g_list_prepend (*head, timer);
+    timer->head = head;
+    timer->link = *head;
+}
+
+static void
+wheel_insert (Timer *timer)
+{
+    guint64 expires;
+    guint64 delta;
+    guint level;
+
+    /* Never schedule in the past */
+    if (timer->expires < wheel->current)
+        timer->expires = wheel->current;
+
+    expires = timer->expires;
+    delta = expires - wheel->current;
+
+    for (level = 0; level < WHEEL_LEVELS - 1; level++) {
+        if (delta < WHEEL_RANGE (level))
+            break;
+    }
+
+    /* Too far in the future, park it at the end of the last level */
+    if (delta >= WHEEL_RANGE (WHEEL_LEVELS - 1))
+        expires = wheel->current + WHEEL_RANGE (WHEEL_LEVELS - 1) - 1;
+
+    timer_link (timer, &wheel->slots[level][WHEEL_INDEX (expires, level)]);
+}
+
+static void
+wheel_cascade (guint level,
+               guint idx)
+{
+    GList *list;
+
+    list = wheel->slots[level][idx];
+    wheel->slots[level][idx] = NULL;
+
+    while (list) {
+        Timer *timer = list->data;
+
+        list = g_list_delete_link (list, list);
+        timer->head = NULL;
+        timer->link = NULL;
+        wheel_insert (timer);
+    }
+}
+
+static guint64
+compute_expiration (guint interval,
+                    guint coalesce_window)
+{
+    guint64 expires;
+
+    /* Round up, so that timers never fire before the requested interval */
+    expires = (now_usec () + ((guint64)interval * G_USEC_PER_SEC) + G_USEC_PER_SEC - 1) / G_USEC_PER_SEC;
+
+    /* Align to the coalescing window, so that timers from different modems
+     * share the same wakeup */
+    if (coalesce_window > 1)
+        expires = ((expires + coalesce_window - 1) / coalesce_window) * coalesce_window;
+
+    return expires;
+}
+
+/*****************************************************************************/
+
+static gboolean
+find_next_tick (guint64 *next)
+{
+    guint64 tick;
+    guint64 boundary;
+    guint64 best = G_MAXUINT64;
+    guint i;
+    guint level;
+
+    /* Level 0 holds timers expiring in the next 64 ticks, each slot having a
+     * single expiration value */
+    for (i = 0, tick = wheel->current; i < WHEEL_SLOTS; i++, tick++) {
+        if (wheel->slots[0][WHEEL_INDEX (tick, 0)]) {
+            best = tick;
+            break;
+        }
+    }
+
+    /* Upper levels need a wakeup when their next non-empty slot cascades */
+    for (level = 1; level < WHEEL_LEVELS; level++) {
+        guint64 step = WHEEL_RANGE (level - 1);
+
+        boundary = (wheel->current + step - 1) & ~(step - 1);
+        for (i = 0; i < WHEEL_SLOTS && boundary < best; i++, boundary += step) {
+            if (wheel->slots[level][WHEEL_INDEX (boundary, level)]) {
+                best = boundary;
+                break;
+            }
+        }
+    }
+
+    if (best == G_MAXUINT64)
+        return FALSE;
+
+    *next = best;
+    return TRUE;
+}
+
+static void
+wheel_arm (void)
+{
+    guint64 next;
+    guint64 now;
+    guint64 delay_ms;
+
+    if (!find_next_tick (&next)) {
+        if (wheel->source_id) {
+            g_source_remove (wheel->source_id);
+            wheel->source_id = 0;
+        }
+        return;
+    }
+
+    /* Already armed early enough */
+    if (wheel->source_id && wheel->armed_tick <= next)
+        return;
+
+    if (wheel->source_id)
+        g_source_remove (wheel->source_id);
+
+    now = now_usec ();
+    delay_ms = (next * G_USEC_PER_SEC > now) ? ((next * G_USEC_PER_SEC - now + 999) / 1000) : 0;
+
+    wheel->armed_tick = next;
+    wheel->source_id = g_timeout_add ((guint) MIN (delay_ms, G_MAXUINT), wheel_dispatch, NULL);
+}
+
+static void
+timer_free (Timer *timer)
+{
+    g_slice_free (Timer, timer);
+}
+
+static void
+process_tick (void)
+{
+    guint64 tick = wheel->current;
+
+    /* Cascade upper levels when lower levels wrap. This must happen while
+     * 'current' is still this tick, so that timers expiring right now land
+     * in the slot drained below, and the ones expiring a full level 0 turn
+     * later don't. */
+    if (WHEEL_INDEX (tick, 0) == 0) {
+        if (WHEEL_INDEX (tick, 1) == 0)
+            wheel_cascade (2, WHEEL_INDEX (tick, 2));
+        wheel_cascade (1, WHEEL_INDEX (tick, 1));
+    }
+
+    /* Move all expired timers out of the wheel before running any callback,
+     * so that callbacks can safely add or remove timers */
+    g_warn_if_fail (wheel->expired == NULL);
+    while (wheel->slots[0][WHEEL_INDEX (tick, 0)]) {
+        Timer *timer = wheel->slots[0][WHEEL_INDEX (tick, 0)]->data;
+
+        timer_unlink (timer);
+        timer_link (timer, &wheel->expired);
+    }
+
+    /* Timers added from now on are relative to the next tick */
+    wheel->current = tick + 1;
+
+    while (wheel->expired) {
+        Timer *timer = wheel->expired->data;
+        gboolean again;
+
+        timer_unlink (timer);
+
+        timer->dispatching = TRUE;
+        again = timer->function (timer->data);
+        timer->dispatching = FALSE;
+        wheel->n_dispatched++;
+
+        /* Removed while dispatching */
+        if (timer->removed) {
+            timer_free (timer);
+            continue;
+        }
+
+        if (!again) {
+            g_hash_table_remove (wheel->timers, GUINT_TO_POINTER (timer->id));
+            timer_free (timer);
+            continue;
+        }
+
+        timer->expires = compute_expiration (timer->interval, timer->coalesce_window);
+        wheel_insert (timer);
+    }
+}
+
+static gboolean
+wheel_dispatch (gpointer unused)
+{
+    guint64 now;
+
+    wheel->source_id = 0;
+    wheel->n_wakeups++;
+
+    now = now_tick ();
+    while (wheel->current <= now) {
+        /* Nothing left to run, just jump ahead */
+        if (g_hash_table_size (wheel->timers) == 0) {
+            wheel->current = now + 1;
+            break;
+        }
+
+        process_tick ();
+    }
+
+    wheel_arm ();
+    return FALSE;
+}
+
+static void
+wheel_init (void)
+{
+    if (G_LIKELY (wheel))
+        return;
+
+    wheel = g_new0 (Wheel, 1);
+    wheel->timers = g_hash_table_new (g_direct_hash, g_direct_equal);
+    wheel->current = now_tick ();
+}
+
+/*****************************************************************************/
+
+guint
+mm_timer_wheel_add_seconds (guint interval,
+                            guint coalesce_window,
+                            GSourceFunc function,
+                            gpointer data)
+{
+    Timer *timer;
+
+    g_return_val_if_fail (function != NULL, 0);
+
+    wheel_init ();
+
+    /* If the wheel was idle, catch up before inserting */
+    if (g_hash_table_size (wheel->timers) == 0)
+        wheel->current = MAX (wheel->current, now_tick ());
+
+    timer = g_slice_new0 (Timer);
+    timer->interval = interval;
+    timer->coalesce_window = coalesce_window;
+    timer->function = function;
+    timer->data = data;
+    timer->expires = compute_expiration (interval, coalesce_window);
+
+    do {
+        timer->id = ++wheel->last_id;
+    } while (timer->id == 0 ||
+             g_hash_table_lookup (wheel->timers, GUINT_TO_POINTER (timer->id)));
+
+    g_hash_table_insert (wheel->timers, GUINT_TO_POINTER (timer->id), timer);
+    wheel_insert (timer);
+    wheel_arm ();
+
+    return timer->id;
+}
+
+gboolean
+mm_timer_wheel_remove (guint id)
+{
+    Timer *timer;
+
+    g_return_val_if_fail (id > 0, FALSE);
+
+    if (!wheel)
+        return FALSE;
+
+    timer = g_hash_table_lookup (wheel->timers, GUINT_TO_POINTER (id));
+    if (!timer)
+        return FALSE;
+
+    g_hash_table_remove (wheel->timers, GUINT_TO_POINTER (id));
+
+    /* Freed once the callback returns */
+    if (timer->dispatching) {
+        timer->removed = TRUE;
+        return TRUE;
+    }
+
+    timer_unlink (timer);
+    timer_free (timer);
+
+    /* No need to re-arm; a spurious wakeup will just find nothing to do */
+    return TRUE;
+}
+
+void
+mm_timer_wheel_get_stats (guint *n_timers,
+                          guint64 *n_wakeups,
+                          guint64 *n_dispatched)
+{
+    if (n_timers)
+        *n_timers = wheel ? g_hash_table_size (wheel->timers) : 0;
+    if (n_wakeups)
+        *n_wakeups = wheel ? wheel->n_wakeups : 0;
+    if (n_dispatched)
+        *n_dispatched = wheel ? wheel->n_dispatched : 0;
+}
+
+void
+mm_timer_wheel_shutdown (void)
+{
+    GHashTableIter iter;
+    gpointer value;
+
+    if (!wheel)
+        return;
+
+    if (wheel->source_id)
+        g_source_remove (wheel->source_id);
+
+    g_hash_table_iter_init (&iter, wheel->timers);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        Timer *timer = value;
+
+        timer_unlink (timer);
+        if (!timer->dispatching)
+            timer_free (timer);
+    }
+
+    g_hash_table_destroy (wheel->timers);
+    g_free (wheel);
+    wheel = NULL;
+}
@@ -0,0 +1,53 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#ifndef MM_TIMER_WHEEL_H
+#define MM_TIMER_WHEEL_H
+
+#include <glib.h>
+
+/* Process-wide scheduler for second-granularity timeouts. All timers live in
+ * a hierarchical timer wheel driven by a single GSource, which is only armed
+ * for the next tick that actually has work to do.
+ *
+ * Timers given a coalescing window get their expiration rounded up to the
+ * next multiple of that window (in monotonic seconds), so that periodic work
+ * scheduled by different modems ends up firing in the same tick.
+ *
+ * Callbacks follow GSourceFunc semantics: return TRUE to get the timer
+ * rescheduled with the same interval, FALSE to get it removed.
+ */
+
+/* Default window used for periodic modem checks (signal quality, access
+ * technologies, registration...) */
+#define MM_TIMER_WHEEL_PERIODIC_COALESCE_SEC 5
+
+/* No coalescing, timer expires in the first tick after the given interval */
+#define MM_TIMER_WHEEL_COALESCE_NONE 0
+
+guint    mm_timer_wheel_add_seconds (guint interval,
+                                     guint coalesce_window,
+                                     GSourceFunc function,
+                                     gpointer data);
+
+gboolean mm_timer_wheel_remove      (guint id);
+
+void     mm_timer_wheel_get_stats   (guint *n_timers,
+                                     guint64 *n_wakeups,
+                                     guint64 *n_dispatched);
+
+void     mm_timer_wheel_shutdown    (void);
+
+#endif /* MM_TIMER_WHEEL_H */
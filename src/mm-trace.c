@@ -0,0 +1,282 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include "mm-trace.h"
+
+typedef struct {
+    gint64 start;
+    gint64 duration; /* -1 for instant events */
+    const gchar *category;
+    guint track;
+    gchar *name;
+    gchar *detail;
+} TraceEvent;
+
+G_LOCK_DEFINE_STATIC (trace);
+
+/* Ring buffer; once full, the oldest event gets overwritten */
+static TraceEvent *events;
+static guint max_events;
+static guint n_events;
+static guint next_event;
+
+/* Track names, indexed by track id - 1. Ports and devices come and go, so
+ * the number of tracks is bounded; once full, new ones share the last one. */
+#define MAX_TRACKS 256
+#define OVERFLOW_TRACK "Other"
+static GPtrArray *tracks;
+static GHashTable *track_ids;
+
+static gint64 origin;
+
+void
+mm_trace_init (guint max)
+{
+    g_return_if_fail (max > 0);
+
+    G_LOCK (trace);
+    if (!events) {
+        events = g_new0 (TraceEvent, max);
+        max_events = max;
+        tracks = g_ptr_array_new_with_free_func (g_free);
+        track_ids = g_hash_table_new (g_str_hash, g_str_equal);
+        origin = g_get_monotonic_time ();
+    }
+    G_UNLOCK (trace);
+}
+
+void
+mm_trace_shutdown (void)
+{
+    guint i;
+
+    G_LOCK (trace);
+    if (events) {
+        for (i = 0; i < max_events; i++) {
+            g_free (events[i].name);
+            g_free (events[i].detail);
+        }
+        g_free (events);
+        events = NULL;
+        max_events = n_events = next_event = 0;
+
+        /* Keys are owned by the array */
+        g_hash_table_destroy (track_ids);
+        track_ids = NULL;
+        g_ptr_array_unref (tracks);
+        tracks = NULL;
+    }
+    G_UNLOCK (trace);
+}
+
+gboolean
+mm_trace_enabled (void)
+{
+    return events != NULL;
+}
+
+gint64
+mm_trace_begin (void)
+{
+    return events ? g_get_monotonic_time () : 0;
+}
+
+/* Must be called with the lock held */
+static guint
+track_get_id (const gchar *track)
+{
+    gchar *name;
+    guint id;
+
+    if (!track)
+        track = "ModemManager";
+
+    id = GPOINTER_TO_UINT (g_hash_table_lookup (track_ids, track));
+    if (id)
+        return id;
+
+    if (tracks->len >= MAX_TRACKS - 1) {
+        track = OVERFLOW_TRACK;
+        id = GPOINTER_TO_UINT (g_hash_table_lookup (track_ids, track));
+        if (id)
+            return id;
+    }
+
+    name = g_strdup (track);
+    g_ptr_array_add (tracks, name);
+    id = tracks->len;
+    g_hash_table_insert (track_ids, name, GUINT_TO_POINTER (id));
+    return id;
+}
+
+static void
+trace_add (const gchar *category,
+           const gchar *track,
+           gint64 start,
+           gint64 duration,
+           const gchar *name,
+           const gchar *detail)
+{
+    TraceEvent *event;
+
+    G_LOCK (trace);
+    if (!events) {
+        G_UNLOCK (trace);
+        return;
+    }
+
+    event = &events[next_event];
+    g_free (event->name);
+    g_free (event->detail);
+
+    event->start = start;
+    event->duration = duration;
+    event->category = category;
+    event->track = track_get_id (track);
+    event->name = g_strdup (name);
+    event->detail = g_strdup (detail);
+
+    next_event = (next_event + 1) % max_events;
+    if (n_events < max_events)
+        n_events++;
+    G_UNLOCK (trace);
+}
+
+void
+mm_trace_span (const gchar *category,
+               const gchar *track,
+               gint64 start,
+               const gchar *name,
+               const gchar *detail)
+{
+    if (!events || !start)
+        return;
+
+    trace_add (category, track, start, g_get_monotonic_time () - start, name, detail);
+}
+
+void
+mm_trace_instant (const gchar *category,
+                  const gchar *track,
+                  const gchar *name,
+                  const gchar *detail)
+{
+    if (!events)
+        return;
+
+    trace_add (category, track, g_get_monotonic_time (), -1, name, detail);
+}
+
+/*****************************************************************************/
+
+static void
+json_append_string (GString *json,
+                    const gchar *str)
+{
+    gboolean valid;
+    const gchar *p;
+
+    /* AT commands and responses may hold anything; keep non-UTF-8 bytes from
+     * breaking the whole file */
+    valid = g_utf8_validate (str, -1, NULL);
+
+    g_string_append_c (json, '"');
+    for (p = str; *p; p++) {
+        guchar c = (guchar) *p;
+
+        if (c == '"' || c == '\\')
+            g_string_append_printf (json, "\\%c", c);
+        else if (c < 0x20)
+            g_string_append_printf (json, "\\u%04x", c);
+        else if (c >= 0x80 && !valid)
+            g_string_append_c (json, '?');
+        else
+            g_string_append_c (json, c);
+    }
+    g_string_append_c (json, '"');
+}
+
+gchar *
+mm_trace_to_json (void)
+{
+    GString *json;
+    guint pid;
+    guint i;
+
+    json = g_string_new ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    pid = (guint) getpid ();
+
+    G_LOCK (trace);
+    if (events) {
+        /* Track names first */
+        for (i = 0; i < tracks->len; i++) {
+            g_string_append_printf (json,
+                                    "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":",
+                                    i ? "," : "",
+                                    pid,
+                                    i + 1);
+            json_append_string (json, g_ptr_array_index (tracks, i));
+            g_string_append (json, "}}");
+        }
+
+        /* Then events, oldest first */
+        for (i = 0; i < n_events; i++) {
+            const TraceEvent *event;
+
+            event = &events[(next_event + max_events - n_events + i) % max_events];
+
+            g_string_append (json, ",{\"name\":");
+            json_append_string (json, event->name);
+            g_string_append_printf (json,
+                                    ",\"cat\":\"%s\",\"pid\":%u,\"tid\":%u,\"ts\":%" G_GINT64_FORMAT,
+                                    event->category,
+                                    pid,
+                                    event->track,
+                                    event->start - origin);
+            if (event->duration >= 0)
+                g_string_append_printf (json,
+                                        ",\"ph\":\"X\",\"dur\":%" G_GINT64_FORMAT,
+                                        event->duration);
+            else
+                g_string_append (json, ",\"ph\":\"i\",\"s\":\"t\"");
+            if (event->detail) {
+                g_string_append (json, ",\"args\":{\"detail\":");
+                json_append_string (json, event->detail);
+                g_string_append_c (json, '}');
+            }
+            g_string_append_c (json, '}');
+        }
+    }
+    G_UNLOCK (trace);
+
+    g_string_append (json, "]}\n");
+    return g_string_free (json, FALSE);
+}
+
+gboolean
+mm_trace_write (const gchar *path,
+                GError **error)
+{
+    gchar *json;
+    gboolean success;
+
+    json = mm_trace_to_json ();
+    success = g_file_set_contents (path, json, -1, error);
+    g_free (json);
+    return success;
+}
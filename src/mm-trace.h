@@ -0,0 +1,60 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#ifndef MM_TRACE_H
+#define MM_TRACE_H
+
+#include <glib.h>
+
+/* Timeline of what the daemon spends its time on, kept in a ring buffer of
+ * the last events and exported in the Chrome trace event JSON format, which
+ * chrome://tracing and the Perfetto UI load directly.
+ *
+ * Each event goes to a named track (a port, a modem device...), shown as a
+ * separate row. Spans on the same track are expected not to overlap.
+ *
+ * Tracing is disabled unless mm_trace_init() is called; all the calls below
+ * are then cheap no-ops. Safe to use from any thread.
+ */
+
+#define MM_TRACE_DEFAULT_MAX_EVENTS 16384
+
+void     mm_trace_init     (guint max_events);
+void     mm_trace_shutdown (void);
+gboolean mm_trace_enabled  (void);
+
+/* Start time of a span, to be given to mm_trace_span() once it's done;
+ * 0 if not tracing */
+gint64   mm_trace_begin    (void);
+
+/* Records a span from @start until now. @category must be a static
+ * string; @detail may be NULL. Ignored if @start is 0. */
+void     mm_trace_span     (const gchar *category,
+                            const gchar *track,
+                            gint64 start,
+                            const gchar *name,
+                            const gchar *detail);
+
+/* Records an event without duration */
+void     mm_trace_instant  (const gchar *category,
+                            const gchar *track,
+                            const gchar *name,
+                            const gchar *detail);
+
+gchar   *mm_trace_to_json  (void);
+gboolean mm_trace_write    (const gchar *path,
+                            GError **error);
+
+#endif /* MM_TRACE_H */
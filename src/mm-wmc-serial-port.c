@@ -0,0 +1,386 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+
+#include <ModemManager.h>
+#include <mm-errors-types.h>
+
+#include "mm-wmc-serial-port.h"
+#include "libwmc/src/com.h"
+#include "libwmc/src/utils.h"
+#include "libwmc/src/errors.h"
+#include "mm-log.h"
+
+G_DEFINE_TYPE (MMWmcSerialPort, mm_wmc_serial_port, MM_TYPE_SERIAL_PORT)
+
+#define MM_WMC_SERIAL_PORT_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), MM_TYPE_WMC_SERIAL_PORT, MMWmcSerialPortPrivate))
+
+enum {
+    PROP_0,
+    PROP_UML290,
+    LAST_PROP
+};
+
+typedef struct {
+    gboolean uml290;
+
+    /* Decapsulated contents of the last frame; reused for every frame */
+    GByteArray *frame;
+} MMWmcSerialPortPrivate;
+
+/*****************************************************************************/
+
+/* Decapsulates the frame at the start of 'response' into priv->frame.
+ * Returns FALSE if more data is needed; otherwise sets 'used' to the amount
+ * of data to discard and 'valid' to whether a frame was found.
+ */
+static gboolean
+decapsulate (MMWmcSerialPortPrivate *priv,
+             GByteArray *response,
+             gsize *out_used,
+             gboolean *out_valid)
+{
+    wmcbool more = FALSE;
+    wmcbool success;
+    size_t used = 0, decap_len = 0;
+
+    /* Unescaped data is never longer than the escaped data */
+    g_byte_array_set_size (priv->frame, MAX (response->len, 1));
+    success = wmc_decapsulate ((const char *) response->data,
+                               response->len,
+                               (char *) priv->frame->data,
+                               priv->frame->len,
+                               &decap_len,
+                               &used,
+                               &more,
+                               priv->uml290);
+    priv->frame->len = decap_len;
+
+    if (success && more)
+        return FALSE;
+
+    *out_used = used;
+    *out_valid = success;
+    return TRUE;
+}
+
+static gboolean
+parse_response (MMSerialPort *port, GByteArray *response, GError **error)
+{
+    MMWmcSerialPortPrivate *priv = MM_WMC_SERIAL_PORT_GET_PRIVATE (port);
+    gsize used;
+    gboolean valid;
+
+    /* Nothing to do until the frame's trailing control char shows up */
+    if (!memchr (response->data, DIAG_CONTROL_CHAR, response->len))
+        return FALSE;
+
+    return decapsulate (priv, response, &used, &valid);
+}
+
+static gsize
+handle_response (MMSerialPort *port,
+                 GByteArray *response,
+                 GError *error,
+                 GCallback callback,
+                 gpointer callback_data)
+{
+    MMWmcSerialPortPrivate *priv = MM_WMC_SERIAL_PORT_GET_PRIVATE (port);
+    MMWmcSerialResponseFn response_callback = (MMWmcSerialResponseFn) callback;
+    GByteArray *decapsulated = NULL;
+    GError *wmc_error = NULL;
+    gsize used = 0;
+    gboolean valid = FALSE;
+
+    if (error)
+        goto callback;
+
+    if (!decapsulate (priv, response, &used, &valid)) {
+        g_set_error_literal (&wmc_error,
+                             MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                             "Incomplete WMC packet.");
+        /* Discard the unparsable data */
+        used = response->len;
+    } else if (!valid || priv->frame->len == 0) {
+        g_set_error_literal (&wmc_error,
+                             MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                             "Failed to decapsulate WMC packet.");
+        if (!used)
+            used = response->len;
+    } else
+        decapsulated = priv->frame;
+
+callback:
+    response_callback (MM_WMC_SERIAL_PORT (port),
+                       decapsulated,
+                       wmc_error ? wmc_error : error,
+                       callback_data);
+    g_clear_error (&wmc_error);
+
+    return used;
+}
+
+/*****************************************************************************/
+
+static GByteArray *
+encapsulate (MMWmcSerialPort *self, GByteArray *command)
+{
+    MMWmcSerialPortPrivate *priv = MM_WMC_SERIAL_PORT_GET_PRIVATE (self);
+    GByteArray *encap;
+    char *raw;
+    gsize raw_len, encap_len;
+
+    /* Room for the CRC and trailer, which get added in place */
+    raw_len = command->len + 3;
+    raw = g_malloc (raw_len);
+    memcpy (raw, command->data, command->len);
+
+    /* Worst case: everything escaped, plus the AT*WMC= prefix */
+    encap_len = (command->len + 3) * 3 + 16;
+    encap = g_byte_array_sized_new (encap_len);
+    encap->len = wmc_encapsulate (raw,
+                                  command->len,
+                                  raw_len,
+                                  (char *) encap->data,
+                                  encap_len,
+                                  priv->uml290);
+    g_free (raw);
+
+    if (encap->len == 0) {
+        g_byte_array_unref (encap);
+        return NULL;
+    }
+    return encap;
+}
+
+static void
+queue_command (MMWmcSerialPort *self,
+               GByteArray *command,
+               gboolean cached,
+               guint32 timeout_seconds,
+               GCancellable *cancellable,
+               MMWmcSerialResponseFn callback,
+               gpointer user_data)
+{
+    GByteArray *encap;
+
+    encap = encapsulate (self, command);
+    g_byte_array_unref (command);
+    if (!encap) {
+        GError *error;
+
+        error = g_error_new_literal (MM_CORE_ERROR,
+                                     MM_CORE_ERROR_FAILED,
+                                     "Failed to encapsulate WMC command.");
+        callback (self, NULL, error, user_data);
+        g_error_free (error);
+        return;
+    }
+
+    if (cached)
+        mm_serial_port_queue_command_cached (MM_SERIAL_PORT (self),
+                                             encap,
+                                             TRUE,
+                                             timeout_seconds,
+                                             cancellable,
+                                             (MMSerialResponseFn) callback,
+                                             user_data);
+    else
+        mm_serial_port_queue_command (MM_SERIAL_PORT (self),
+                                      encap,
+                                      TRUE,
+                                      timeout_seconds,
+                                      cancellable,
+                                      (MMSerialResponseFn) callback,
+                                      user_data);
+}
+
+void
+mm_wmc_serial_port_queue_command (MMWmcSerialPort *self,
+                                  GByteArray *command,
+                                  guint32 timeout_seconds,
+                                  GCancellable *cancellable,
+                                  MMWmcSerialResponseFn callback,
+                                  gpointer user_data)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (MM_IS_WMC_SERIAL_PORT (self));
+    g_return_if_fail (command != NULL);
+
+    queue_command (self, command, FALSE, timeout_seconds, cancellable, callback, user_data);
+}
+
+void
+mm_wmc_serial_port_queue_command_cached (MMWmcSerialPort *self,
+                                         GByteArray *command,
+                                         guint32 timeout_seconds,
+                                         GCancellable *cancellable,
+                                         MMWmcSerialResponseFn callback,
+                                         gpointer user_data)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (MM_IS_WMC_SERIAL_PORT (self));
+    g_return_if_fail (command != NULL);
+
+    queue_command (self, command, TRUE, timeout_seconds, cancellable, callback, user_data);
+}
+
+static void
+debug_log (MMSerialPort *port, const char *prefix, const char *buf, gsize len)
+{
+    static GString *debug = NULL;
+    const char *s = buf;
+
+    if (!debug)
+        debug = g_string_sized_new (512);
+
+    g_string_append (debug, prefix);
+
+    while (len--)
+        g_string_append_printf (debug, " %02x", (guint8) (*s++ & 0xFF));
+
+    mm_dbg ("(%s): %s", mm_port_get_device (MM_PORT (port)), debug->str);
+    g_string_truncate (debug, 0);
+}
+
+/*****************************************************************************/
+
+static gboolean
+config_fd (MMSerialPort *port, int fd, GError **error)
+{
+    int err;
+
+    err = wmc_port_setup (fd);
+    if (err != WMC_SUCCESS) {
+        g_set_error (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_OPEN_FAILED,
+                     "Failed to open WMC port: %d", err);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+MMWmcSerialPort *
+mm_wmc_serial_port_new (const char *name)
+{
+    return MM_WMC_SERIAL_PORT (g_object_new (MM_TYPE_WMC_SERIAL_PORT,
+                                             MM_PORT_DEVICE, name,
+                                             MM_PORT_SUBSYS, MM_PORT_SUBSYS_TTY,
+                                             MM_PORT_TYPE, MM_PORT_TYPE_WMC,
+                                             NULL));
+}
+
+MMWmcSerialPort *
+mm_wmc_serial_port_new_fd (int fd)
+{
+    MMWmcSerialPort *port;
+    char *name;
+
+    name = g_strdup_printf ("port%d", fd);
+    port = MM_WMC_SERIAL_PORT (g_object_new (MM_TYPE_WMC_SERIAL_PORT,
+                                             MM_PORT_DEVICE, name,
+                                             MM_PORT_SUBSYS, MM_PORT_SUBSYS_TTY,
+                                             MM_PORT_TYPE, MM_PORT_TYPE_WMC,
+                                             MM_SERIAL_PORT_FD, fd,
+                                             NULL));
+    g_free (name);
+    return port;
+}
+
+static void
+mm_wmc_serial_port_init (MMWmcSerialPort *self)
+{
+    MMWmcSerialPortPrivate *priv = MM_WMC_SERIAL_PORT_GET_PRIVATE (self);
+
+    priv->frame = g_byte_array_sized_new (512);
+}
+
+static void
+set_property (GObject *object,
+              guint prop_id,
+              const GValue *value,
+              GParamSpec *pspec)
+{
+    MMWmcSerialPortPrivate *priv = MM_WMC_SERIAL_PORT_GET_PRIVATE (object);
+
+    switch (prop_id) {
+    case PROP_UML290:
+        priv->uml290 = g_value_get_boolean (value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+get_property (GObject *object,
+              guint prop_id,
+              GValue *value,
+              GParamSpec *pspec)
+{
+    MMWmcSerialPortPrivate *priv = MM_WMC_SERIAL_PORT_GET_PRIVATE (object);
+
+    switch (prop_id) {
+    case PROP_UML290:
+        g_value_set_boolean (value, priv->uml290);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+finalize (GObject *object)
+{
+    MMWmcSerialPortPrivate *priv = MM_WMC_SERIAL_PORT_GET_PRIVATE (object);
+
+    g_byte_array_unref (priv->frame);
+
+    G_OBJECT_CLASS (mm_wmc_serial_port_parent_class)->finalize (object);
+}
+
+static void
+mm_wmc_serial_port_class_init (MMWmcSerialPortClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    MMSerialPortClass *port_class = MM_SERIAL_PORT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (MMWmcSerialPortPrivate));
+
+    /* Virtual methods */
+    object_class->set_property = set_property;
+    object_class->get_property = get_property;
+    object_class->finalize = finalize;
+
+    port_class->parse_response = parse_response;
+    port_class->handle_response = handle_response;
+    port_class->config_fd = config_fd;
+    port_class->debug_log = debug_log;
+
+    g_object_class_install_property
+        (object_class, PROP_UML290,
+         g_param_spec_boolean (MM_WMC_SERIAL_PORT_UML290,
+                               "UML290",
+                               "Whether commands use the UML290 AT*WMC= framing",
+                               FALSE,
+                               G_PARAM_READWRITE));
+}
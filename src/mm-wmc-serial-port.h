@@ -0,0 +1,75 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#ifndef MM_WMC_SERIAL_PORT_H
+#define MM_WMC_SERIAL_PORT_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "mm-serial-port.h"
+
+#define MM_TYPE_WMC_SERIAL_PORT            (mm_wmc_serial_port_get_type ())
+#define MM_WMC_SERIAL_PORT(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), MM_TYPE_WMC_SERIAL_PORT, MMWmcSerialPort))
+#define MM_WMC_SERIAL_PORT_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  MM_TYPE_WMC_SERIAL_PORT, MMWmcSerialPortClass))
+#define MM_IS_WMC_SERIAL_PORT(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), MM_TYPE_WMC_SERIAL_PORT))
+#define MM_IS_WMC_SERIAL_PORT_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  MM_TYPE_WMC_SERIAL_PORT))
+#define MM_WMC_SERIAL_PORT_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  MM_TYPE_WMC_SERIAL_PORT, MMWmcSerialPortClass))
+
+/* Whether commands are sent as "AT*WMC=<frame>\r", as the Pantech UML290
+ * wants them */
+#define MM_WMC_SERIAL_PORT_UML290 "uml290"
+
+typedef struct _MMWmcSerialPort MMWmcSerialPort;
+typedef struct _MMWmcSerialPortClass MMWmcSerialPortClass;
+
+typedef void (*MMWmcSerialResponseFn)     (MMWmcSerialPort *port,
+                                           GByteArray *response,
+                                           GError *error,
+                                           gpointer user_data);
+
+struct _MMWmcSerialPort {
+    MMSerialPort parent;
+};
+
+struct _MMWmcSerialPortClass {
+    MMSerialPortClass parent;
+};
+
+GType mm_wmc_serial_port_get_type (void);
+
+MMWmcSerialPort *mm_wmc_serial_port_new (const char *name);
+
+MMWmcSerialPort *mm_wmc_serial_port_new_fd (int fd);
+
+/* 'command' is a raw WMC command (e.g. from wmc_cmd_network_info_new()); the
+ * port takes ownership of it and does the framing itself.  The response
+ * passed to 'callback' is already decapsulated.
+ */
+void     mm_wmc_serial_port_queue_command     (MMWmcSerialPort *self,
+                                               GByteArray *command,
+                                               guint32 timeout_seconds,
+                                               GCancellable *cancellable,
+                                               MMWmcSerialResponseFn callback,
+                                               gpointer user_data);
+
+void     mm_wmc_serial_port_queue_command_cached (MMWmcSerialPort *self,
+                                                  GByteArray *command,
+                                                  guint32 timeout_seconds,
+                                                  GCancellable *cancellable,
+                                                  MMWmcSerialResponseFn callback,
+                                                  gpointer user_data);
+
+#endif /* MM_WMC_SERIAL_PORT_H */
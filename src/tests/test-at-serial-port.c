@@ -15,6 +15,10 @@
 
 #include <config.h>
 #include <string.h>
+#include <pty.h>
+#include <unistd.h>
+#include <termios.h>
+#include <fcntl.h>
 #include <glib.h>
 
 #include "mm-at-serial-port.h"
@@ -64,6 +68,680 @@ at_serial_echo_removal (void)
     }
 }
 
+/*****************************************************************************/
+/* Command queue
+ *
+ * The port talks to a fake modem on the other side of a pty, which records
+ * the commands in the order they are sent and replies to each with
+ * "<command>: 1" and OK, unless told to hold the reply.
+ */
+
+typedef struct {
+    GMainLoop *loop;
+    MMAtSerialPort *port;
+    int master;
+    GIOChannel *channel;
+    guint watch_id;
+    /* Fake modem */
+    GString *input;
+    GPtrArray *sent;
+    gboolean hold;
+    gchar *held;
+    /* Exit conditions of the main loop */
+    guint wait_sent;
+    guint n_replies;
+    guint wait_replies;
+} QueueTest;
+
+typedef struct {
+    QueueTest *t;
+    guint n_calls;
+    gsize response_len;
+    gsize memory_usage;
+} QueueCaller;
+
+/* Upper bound for any single wait in these tests */
+#define QUEUE_TEST_TIMEOUT_SEC 10
+
+/* Short aging period, so that the aging test doesn't take seconds */
+#define QUEUE_TEST_AGING_MSEC 200
+
+static void
+queue_test_check_done (QueueTest *t)
+{
+    if ((t->wait_sent && t->sent->len >= t->wait_sent) ||
+        (t->wait_replies && t->n_replies >= t->wait_replies))
+        g_main_loop_quit (t->loop);
+}
+
+static void
+modem_reply (QueueTest *t,
+             const gchar *command)
+{
+    gchar *reply;
+    gssize written;
+
+    /* Skip the AT prefix */
+    reply = g_strdup_printf ("\r\n%s: 1\r\n\r\nOK\r\n", command + 2);
+    written = write (t->master, reply, strlen (reply));
+    g_assert_cmpint (written, ==, strlen (reply));
+    g_free (reply);
+}
+
+static void
+modem_release (QueueTest *t)
+{
+    t->hold = FALSE;
+    if (t->held) {
+        modem_reply (t, t->held);
+        g_free (t->held);
+        t->held = NULL;
+    }
+}
+
+static gboolean
+modem_data_available (GIOChannel *source,
+                      GIOCondition condition,
+                      QueueTest *t)
+{
+    gchar buf[256];
+    gssize len;
+    gchar *end;
+
+    while ((len = read (t->master, buf, sizeof (buf))) > 0)
+        g_string_append_len (t->input, buf, len);
+
+    while ((end = strchr (t->input->str, '\r')) != NULL) {
+        gchar *command;
+
+        command = g_strndup (t->input->str, end - t->input->str);
+        g_string_erase (t->input, 0, end - t->input->str + 1);
+        g_ptr_array_add (t->sent, g_strdup (command));
+
+        if (t->hold) {
+            g_assert (t->held == NULL);
+            t->held = command;
+        } else {
+            modem_reply (t, command);
+            g_free (command);
+        }
+    }
+
+    queue_test_check_done (t);
+    return TRUE;
+}
+
+static gboolean
+queue_test_parse_response (gpointer user_data,
+                           GString *response,
+                           GError **error)
+{
+    gchar *ok;
+
+    ok = strstr (response->str, "\r\nOK\r\n");
+    if (!ok)
+        return FALSE;
+
+    g_string_truncate (response, ok - response->str);
+    return TRUE;
+}
+
+static gboolean
+queue_test_timed_out (QueueTest *t)
+{
+    g_assert_not_reached ();
+    return FALSE;
+}
+
+static void
+queue_test_run (QueueTest *t,
+                guint wait_sent,
+                guint wait_replies)
+{
+    guint timeout_id;
+
+    t->wait_sent = wait_sent;
+    t->wait_replies = wait_replies;
+    timeout_id = g_timeout_add_seconds (QUEUE_TEST_TIMEOUT_SEC,
+                                        (GSourceFunc) queue_test_timed_out,
+                                        t);
+    g_main_loop_run (t->loop);
+    g_source_remove (timeout_id);
+    t->wait_sent = 0;
+    t->wait_replies = 0;
+}
+
+static QueueTest *
+queue_test_new_full (gboolean io_thread)
+{
+    QueueTest *t;
+    struct termios stbuf;
+    GError *error = NULL;
+    gboolean success;
+    int slave;
+    int ret;
+
+    t = g_new0 (QueueTest, 1);
+    t->loop = g_main_loop_new (NULL, FALSE);
+    t->input = g_string_new (NULL);
+    t->sent = g_ptr_array_new_with_free_func (g_free);
+
+    ret = openpty (&t->master, &slave, NULL, NULL, NULL);
+    g_assert_cmpint (ret, ==, 0);
+
+    /* set raw mode on both sides */
+    memset (&stbuf, 0, sizeof (stbuf));
+    tcgetattr (slave, &stbuf);
+    cfmakeraw (&stbuf);
+    tcsetattr (slave, TCSANOW, &stbuf);
+    tcsetattr (t->master, TCSANOW, &stbuf);
+    fcntl (slave, F_SETFL, O_NONBLOCK);
+    fcntl (t->master, F_SETFL, O_NONBLOCK);
+
+    t->channel = g_io_channel_unix_new (t->master);
+    t->watch_id = g_io_add_watch (t->channel,
+                                  G_IO_IN,
+                                  (GIOFunc) modem_data_available,
+                                  t);
+
+    /* The port takes ownership of the slave fd */
+    t->port = MM_AT_SERIAL_PORT (g_object_new (MM_TYPE_AT_SERIAL_PORT,
+                                               MM_PORT_DEVICE, "ttyTEST0",
+                                               MM_PORT_SUBSYS, MM_PORT_SUBSYS_TTY,
+                                               MM_PORT_TYPE, MM_PORT_TYPE_AT,
+                                               MM_SERIAL_PORT_FD, slave,
+                                               MM_SERIAL_PORT_SEND_DELAY, (guint64) 0,
+                                               MM_SERIAL_PORT_IO_THREAD, io_thread,
+                                               NULL));
+    mm_at_serial_port_set_response_parser (t->port,
+                                           queue_test_parse_response,
+                                           NULL,
+                                           NULL);
+
+    success = mm_serial_port_open (MM_SERIAL_PORT (t->port), &error);
+    g_assert_no_error (error);
+    g_assert (success);
+
+    return t;
+}
+
+static QueueTest *
+queue_test_new (void)
+{
+    return queue_test_new_full (FALSE);
+}
+
+static void
+queue_test_free (QueueTest *t)
+{
+    mm_serial_port_close (MM_SERIAL_PORT (t->port));
+    g_object_unref (t->port);
+
+    g_source_remove (t->watch_id);
+    g_io_channel_unref (t->channel);
+    close (t->master);
+
+    g_free (t->held);
+    g_ptr_array_unref (t->sent);
+    g_string_free (t->input, TRUE);
+    g_main_loop_unref (t->loop);
+    g_free (t);
+}
+
+static void
+queue_test_assert_sent (QueueTest *t,
+                        const gchar **expected)
+{
+    guint i;
+
+    for (i = 0; expected[i]; i++) {
+        g_assert_cmpuint (i, <, t->sent->len);
+        g_assert_cmpstr (g_ptr_array_index (t->sent, i), ==, expected[i]);
+    }
+    g_assert_cmpuint (t->sent->len, ==, i);
+}
+
+static void
+queue_test_ready (MMAtSerialPort *port,
+                  GString *response,
+                  GError *error,
+                  QueueCaller *caller)
+{
+    g_assert_no_error (error);
+    g_assert (g_str_has_prefix (response->str, "\r\n+"));
+
+    caller->response_len = response->len;
+    caller->memory_usage = mm_serial_port_get_memory_usage (MM_SERIAL_PORT (port));
+    caller->n_calls++;
+    caller->t->n_replies++;
+    queue_test_check_done (caller->t);
+}
+
+static void
+queue_test_command (QueueTest *t,
+                    const gchar *command,
+                    MMSerialPortPriority priority,
+                    guint32 timeout_seconds,
+                    GCancellable *cancellable,
+                    QueueCaller *caller)
+{
+    caller->t = t;
+    mm_at_serial_port_queue_command_full (t->port,
+                                          command,
+                                          timeout_seconds,
+                                          FALSE,
+                                          FALSE,
+                                          priority,
+                                          cancellable,
+                                          (MMAtSerialResponseFn) queue_test_ready,
+                                          caller);
+}
+
+static void
+at_serial_queue_priority (void)
+{
+    QueueTest *t;
+    QueueCaller callers[4];
+    const gchar *expected[] = { "AT+FIRST", "AT+SECOND", "AT+BACKGROUND", "AT+LAST", NULL };
+
+    memset (callers, 0, sizeof (callers));
+    t = queue_test_new ();
+
+    /* All queued before any is sent; FIFO within the same priority */
+    queue_test_command (t, "+BACKGROUND", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, NULL, &callers[0]);
+    queue_test_command (t, "+FIRST", MM_SERIAL_PORT_PRIORITY_INTERACTIVE, 3, NULL, &callers[1]);
+    queue_test_command (t, "+SECOND", MM_SERIAL_PORT_PRIORITY_INTERACTIVE, 3, NULL, &callers[2]);
+    queue_test_command (t, "+LAST", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, NULL, &callers[3]);
+    queue_test_run (t, 0, 4);
+
+    queue_test_assert_sent (t, expected);
+
+    queue_test_free (t);
+}
+
+typedef struct {
+    QueueTest *t;
+    QueueCaller *caller;
+} AgingContext;
+
+static gboolean
+aging_queue_late_command (AgingContext *ctx)
+{
+    /* Same class as the background command after one aging period, but
+     * queued later */
+    queue_test_command (ctx->t, "+LATE", MM_SERIAL_PORT_PRIORITY_INTERACTIVE, 3, NULL, ctx->caller);
+    modem_release (ctx->t);
+    return FALSE;
+}
+
+static void
+at_serial_queue_aging (void)
+{
+    QueueTest *t;
+    QueueCaller callers[3];
+    AgingContext ctx;
+    const gchar *expected[] = { "AT+HOLD", "AT+BACKGROUND", "AT+LATE", NULL };
+
+    memset (callers, 0, sizeof (callers));
+    t = queue_test_new ();
+
+    g_object_set (t->port,
+                  MM_SERIAL_PORT_AGING_PERIOD, (guint64) QUEUE_TEST_AGING_MSEC * 1000,
+                  NULL);
+
+    /* Keep the port busy for longer than an aging period */
+    t->hold = TRUE;
+    queue_test_command (t, "+HOLD", MM_SERIAL_PORT_PRIORITY_INTERACTIVE, 3, NULL, &callers[0]);
+    queue_test_run (t, 1, 0);
+
+    queue_test_command (t, "+BACKGROUND", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, NULL, &callers[1]);
+
+    ctx.t = t;
+    ctx.caller = &callers[2];
+    g_timeout_add (QUEUE_TEST_AGING_MSEC + QUEUE_TEST_AGING_MSEC / 2,
+                   (GSourceFunc) aging_queue_late_command,
+                   &ctx);
+    queue_test_run (t, 0, 3);
+
+    queue_test_assert_sent (t, expected);
+
+    queue_test_free (t);
+}
+
+static void
+at_serial_queue_merge (void)
+{
+    QueueTest *t;
+    QueueCaller callers[4];
+    const gchar *expected[] = { "AT+CGMI", "AT+CSQ", NULL };
+    guint i;
+
+    memset (callers, 0, sizeof (callers));
+    t = queue_test_new ();
+
+    queue_test_command (t, "+CSQ", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, NULL, &callers[0]);
+    queue_test_command (t, "+CGMI", MM_SERIAL_PORT_PRIORITY_INTERACTIVE, 3, NULL, &callers[1]);
+    queue_test_command (t, "+CSQ", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, NULL, &callers[2]);
+    queue_test_command (t, "+CSQ", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, NULL, &callers[3]);
+    queue_test_run (t, 0, 4);
+
+    /* Sent once, but every caller gets the reply exactly once */
+    queue_test_assert_sent (t, expected);
+    for (i = 0; i < G_N_ELEMENTS (callers); i++)
+        g_assert_cmpuint (callers[i].n_calls, ==, 1);
+    g_assert_cmpuint (mm_serial_port_get_queue_length (MM_SERIAL_PORT (t->port)), ==, 0);
+
+    queue_test_free (t);
+}
+
+static void
+at_serial_queue_no_merge_started (void)
+{
+    QueueTest *t;
+    QueueCaller callers[2];
+    const gchar *expected[] = { "AT+CSQ", "AT+CSQ", NULL };
+
+    memset (callers, 0, sizeof (callers));
+    t = queue_test_new ();
+
+    t->hold = TRUE;
+    queue_test_command (t, "+CSQ", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, NULL, &callers[0]);
+    queue_test_run (t, 1, 0);
+
+    /* Already sent, so it gets its own */
+    queue_test_command (t, "+CSQ", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, NULL, &callers[1]);
+    modem_release (t);
+    queue_test_run (t, 0, 2);
+
+    queue_test_assert_sent (t, expected);
+    g_assert_cmpuint (callers[0].n_calls, ==, 1);
+    g_assert_cmpuint (callers[1].n_calls, ==, 1);
+
+    queue_test_free (t);
+}
+
+static void
+at_serial_queue_no_merge_cancellable (void)
+{
+    QueueTest *t;
+    QueueCaller callers[3];
+    GCancellable *cancellable1;
+    GCancellable *cancellable2;
+    const gchar *expected[] = { "AT+CSQ", "AT+CSQ", NULL };
+    guint i;
+
+    memset (callers, 0, sizeof (callers));
+    t = queue_test_new ();
+    cancellable1 = g_cancellable_new ();
+    cancellable2 = g_cancellable_new ();
+
+    queue_test_command (t, "+CSQ", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, cancellable1, &callers[0]);
+    queue_test_command (t, "+CSQ", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, cancellable2, &callers[1]);
+    queue_test_command (t, "+CSQ", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, cancellable1, &callers[2]);
+    queue_test_run (t, 0, 3);
+
+    /* The last one is merged with the first one */
+    queue_test_assert_sent (t, expected);
+    for (i = 0; i < G_N_ELEMENTS (callers); i++)
+        g_assert_cmpuint (callers[i].n_calls, ==, 1);
+
+    g_object_unref (cancellable1);
+    g_object_unref (cancellable2);
+    queue_test_free (t);
+}
+
+/*****************************************************************************/
+/* Low-memory mode */
+
+#define LOW_MEMORY_LONG_REPLY_LEN 4096
+
+static void
+at_serial_low_memory_shrink (void)
+{
+    QueueTest *t;
+    QueueCaller caller;
+    GString *reply;
+    gsize written = 0;
+    gsize idle_usage;
+
+    memset (&caller, 0, sizeof (caller));
+    t = queue_test_new ();
+    g_object_set (t->port,
+                  MM_SERIAL_PORT_LOW_MEMORY, TRUE,
+                  NULL);
+    idle_usage = mm_serial_port_get_memory_usage (MM_SERIAL_PORT (t->port));
+
+    /* A long response grows the buffer... */
+    t->hold = TRUE;
+    queue_test_command (t, "+LONG", MM_SERIAL_PORT_PRIORITY_INTERACTIVE, 10, NULL, &caller);
+    queue_test_run (t, 1, 0);
+
+    reply = g_string_new ("\r\n+LONG: ");
+    while (reply->len < LOW_MEMORY_LONG_REPLY_LEN)
+        g_string_append_c (reply, 'x');
+    g_string_append (reply, "\r\nOK\r\n");
+    while (written < reply->len) {
+        gssize ret;
+
+        ret = write (t->master, reply->str + written, reply->len - written);
+        if (ret > 0)
+            written += ret;
+        else if (!g_main_context_iteration (NULL, FALSE))
+            g_usleep (1000);
+    }
+    t->hold = FALSE;
+    g_free (t->held);
+    t->held = NULL;
+    if (!caller.n_calls)
+        queue_test_run (t, 0, 1);
+
+    g_assert_cmpuint (caller.n_calls, ==, 1);
+    g_assert_cmpuint (caller.response_len, >=, LOW_MEMORY_LONG_REPLY_LEN);
+    g_assert_cmpuint (caller.memory_usage, >=, idle_usage + LOW_MEMORY_LONG_REPLY_LEN);
+
+    /* ...and once the port is idle again, the memory is given back */
+    g_assert_cmpuint (mm_serial_port_get_memory_usage (MM_SERIAL_PORT (t->port)), ==, idle_usage);
+
+    g_string_free (reply, TRUE);
+    queue_test_free (t);
+}
+
+/*****************************************************************************/
+/* Worker I/O thread */
+
+#if GLIB_CHECK_VERSION (2,32,0)
+
+#define IO_THREAD_BIG_REPLY_LEN (64 * 1024)
+
+static void
+io_thread_flash_ready (MMSerialPort *port,
+                       GError *error,
+                       QueueTest *t)
+{
+    g_assert_no_error (error);
+    t->n_replies++;
+    g_main_loop_quit (t->loop);
+}
+
+static void
+at_serial_io_thread (void)
+{
+    QueueTest *t;
+    QueueCaller callers[3];
+    const gchar *expected[] = { "AT+FIRST", "AT+SECOND", "AT+BIG", NULL };
+    GString *reply;
+    gsize written = 0;
+    gsize usage;
+    guint tries;
+
+    memset (callers, 0, sizeof (callers));
+    t = queue_test_new_full (TRUE);
+
+    /* Commands written and replies read by the worker */
+    queue_test_command (t, "+FIRST", MM_SERIAL_PORT_PRIORITY_INTERACTIVE, 3, NULL, &callers[0]);
+    queue_test_command (t, "+SECOND", MM_SERIAL_PORT_PRIORITY_INTERACTIVE, 3, NULL, &callers[1]);
+    queue_test_run (t, 0, 2);
+    g_assert_cmpuint (callers[0].n_calls, ==, 1);
+    g_assert_cmpuint (callers[1].n_calls, ==, 1);
+
+    /* Speed changes done by the worker too */
+    t->n_replies = 0;
+    mm_serial_port_flash (MM_SERIAL_PORT (t->port),
+                          10,
+                          TRUE,
+                          (MMSerialFlashFn) io_thread_flash_ready,
+                          t);
+    g_main_loop_run (t->loop);
+    g_assert_cmpuint (t->n_replies, ==, 1);
+
+    /* A long reply while the main context is busy */
+    t->hold = TRUE;
+    queue_test_command (t, "+BIG", MM_SERIAL_PORT_PRIORITY_INTERACTIVE, 10, NULL, &callers[2]);
+    queue_test_run (t, 3, 0);
+
+    reply = g_string_new ("\r\n+BIG: ");
+    while (reply->len < IO_THREAD_BIG_REPLY_LEN)
+        g_string_append_c (reply, 'x');
+    g_string_append (reply, "\r\nOK\r\n");
+
+    usage = mm_serial_port_get_memory_usage (MM_SERIAL_PORT (t->port));
+    for (tries = 0; written < reply->len && tries < 20; tries++) {
+        gssize ret;
+
+        ret = write (t->master, reply->str + written, reply->len - written);
+        if (ret > 0)
+            written += ret;
+        else
+            g_usleep (10000);
+    }
+
+    /* Whatever the worker read is held back, up to a limit */
+    g_usleep (100000);
+    g_assert_cmpuint (mm_serial_port_get_memory_usage (MM_SERIAL_PORT (t->port)) - usage,
+                      <,
+                      IO_THREAD_BIG_REPLY_LEN / 2);
+
+    /* And the rest is read once the main context catches up */
+    while (written < reply->len) {
+        gssize ret;
+
+        ret = write (t->master, reply->str + written, reply->len - written);
+        if (ret > 0)
+            written += ret;
+        else if (!g_main_context_iteration (NULL, FALSE))
+            g_usleep (1000);
+    }
+    t->hold = FALSE;
+    g_free (t->held);
+    t->held = NULL;
+    if (!callers[2].n_calls) {
+        t->n_replies = 0;
+        queue_test_run (t, 0, 1);
+    }
+
+    g_assert_cmpuint (callers[2].n_calls, ==, 1);
+    g_assert_cmpuint (callers[2].response_len, >=, IO_THREAD_BIG_REPLY_LEN);
+    queue_test_assert_sent (t, expected);
+
+    g_string_free (reply, TRUE);
+    queue_test_free (t);
+}
+
+#endif
+
+/*****************************************************************************/
+/* Balancing commands across ports */
+
+static void
+at_serial_port_bound_commands (void)
+{
+    const gchar *bound[] = {
+        "E0", "ATE0 V1", "Z", "&C1", "+CMEE=1", "AT+CSCS=\"UCS2\"",
+        "D*99#", "+CGDATA=\"PPP\",1", "+CNMI=2,1,2,1,0", "+CREG=2",
+        "+CMGF=0", "+CMGL=4", "AT+CMGR=1", "+cmgd=3", "+CMGS=23",
+        "+CPMS=\"SM\",\"SM\",\"SM\"", "+CSCA?",
+        "+COPS?", "+COPS=3,2", "+CNUM", "+CPBR=1", "+CUSD=1,\"*100#\",15",
+        NULL
+    };
+    const gchar *unbound[] = {
+        "+CSQ", "AT+CGSN", "+CIMI", "+CPIN?", "+CGMI", "+CREG?", "+CGREG?",
+        "+CIND?", "+CGACT?", "+CFUN?", "", "AT",
+        NULL
+    };
+    guint i;
+
+    for (i = 0; bound[i]; i++) {
+        if (!mm_at_serial_port_command_is_port_bound (bound[i]))
+            g_error ("'%s' should be bound to its port", bound[i]);
+    }
+
+    for (i = 0; unbound[i]; i++) {
+        if (mm_at_serial_port_command_is_port_bound (unbound[i]))
+            g_error ("'%s' should not be bound to any port", unbound[i]);
+    }
+}
+
+static void
+at_serial_least_busy (void)
+{
+    QueueTest *t1;
+    QueueTest *t2;
+    MMAtSerialPort *closed;
+    MMAtSerialPort *ports[3];
+    QueueCaller callers[2];
+
+    memset (callers, 0, sizeof (callers));
+    t1 = queue_test_new ();
+    t2 = queue_test_new ();
+    closed = MM_AT_SERIAL_PORT (g_object_new (MM_TYPE_AT_SERIAL_PORT,
+                                              MM_PORT_DEVICE, "ttyTEST1",
+                                              MM_PORT_SUBSYS, MM_PORT_SUBSYS_TTY,
+                                              MM_PORT_TYPE, MM_PORT_TYPE_AT,
+                                              NULL));
+
+    /* Both idle; the first one wins */
+    ports[0] = t1->port;
+    ports[1] = t2->port;
+    g_assert (mm_at_serial_port_peek_least_busy (ports, 2) == t1->port);
+
+    /* The one with less commands pending wins */
+    t1->hold = TRUE;
+    queue_test_command (t1, "+CSQ", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, NULL, &callers[0]);
+    queue_test_run (t1, 1, 0);
+    g_assert (mm_at_serial_port_peek_least_busy (ports, 2) == t2->port);
+
+    /* Back to a tie */
+    t2->hold = TRUE;
+    queue_test_command (t2, "+CSQ", MM_SERIAL_PORT_PRIORITY_BACKGROUND, 3, NULL, &callers[1]);
+    queue_test_run (t2, 1, 0);
+    g_assert (mm_at_serial_port_peek_least_busy (ports, 2) == t1->port);
+
+    /* Connected ports are skipped */
+    mm_port_set_connected (MM_PORT (t1->port), TRUE);
+    g_assert (mm_at_serial_port_peek_least_busy (ports, 2) == t2->port);
+    mm_port_set_connected (MM_PORT (t1->port), FALSE);
+
+    /* NULL and closed ports are skipped */
+    ports[0] = NULL;
+    ports[1] = closed;
+    ports[2] = t2->port;
+    g_assert (mm_at_serial_port_peek_least_busy (ports, 3) == t2->port);
+    g_assert (mm_at_serial_port_peek_least_busy (ports, 2) == NULL);
+
+    modem_release (t1);
+    queue_test_run (t1, 0, 1);
+    modem_release (t2);
+    queue_test_run (t2, 0, 1);
+    g_assert_cmpuint (callers[0].n_calls, ==, 1);
+    g_assert_cmpuint (callers[1].n_calls, ==, 1);
+
+    g_object_unref (closed);
+    queue_test_free (t1);
+    queue_test_free (t2);
+}
+
+/*****************************************************************************/
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -80,6 +758,17 @@ int main (int argc, char **argv)
     g_test_init (&argc, &argv, NULL);
 
     g_test_add_func ("/ModemManager/AT-serial/echo-removal", at_serial_echo_removal);
+    g_test_add_func ("/ModemManager/AT-serial/queue/priority", at_serial_queue_priority);
+    g_test_add_func ("/ModemManager/AT-serial/queue/aging", at_serial_queue_aging);
+    g_test_add_func ("/ModemManager/AT-serial/queue/merge", at_serial_queue_merge);
+    g_test_add_func ("/ModemManager/AT-serial/queue/no-merge-started", at_serial_queue_no_merge_started);
+    g_test_add_func ("/ModemManager/AT-serial/queue/no-merge-cancellable", at_serial_queue_no_merge_cancellable);
+    g_test_add_func ("/ModemManager/AT-serial/low-memory/shrink", at_serial_low_memory_shrink);
+#if GLIB_CHECK_VERSION (2,32,0)
+    g_test_add_func ("/ModemManager/AT-serial/io-thread", at_serial_io_thread);
+#endif
+    g_test_add_func ("/ModemManager/AT-serial/balance/port-bound", at_serial_port_bound_commands);
+    g_test_add_func ("/ModemManager/AT-serial/balance/least-busy", at_serial_least_busy);
 
     return g_test_run ();
 }
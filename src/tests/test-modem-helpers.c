@@ -19,6 +19,8 @@
 #include <stdlib.h>
 
 #include "mm-modem-helpers.h"
+#include "mm-regex-cache.h"
+#include "mm-at-grammar.h"
 #include "mm-log.h"
 
 /*****************************************************************************/
@@ -444,6 +446,8 @@ test_cops_response_umts_invalid (void *f, gpointer d)
 typedef struct {
     GPtrArray *solicited_creg;
     GPtrArray *unsolicited_creg;
+    /* Replies seen by the CREG tests, reused by the fuzz and perf tests */
+    GPtrArray *replies;
 } RegTestData;
 
 static RegTestData *
@@ -454,6 +458,7 @@ reg_test_data_new (void)
     data = g_malloc0 (sizeof (RegTestData));
     data->solicited_creg = mm_3gpp_creg_regex_get (TRUE);
     data->unsolicited_creg = mm_3gpp_creg_regex_get (FALSE);
+    data->replies = g_ptr_array_new ();
     return data;
 }
 
@@ -462,6 +467,7 @@ reg_test_data_free (RegTestData *data)
 {
     mm_3gpp_creg_regex_destroy (data->solicited_creg);
     mm_3gpp_creg_regex_destroy (data->unsolicited_creg);
+    g_ptr_array_free (data->replies, TRUE);
     g_free (data);
 }
 
@@ -471,7 +477,6 @@ typedef struct {
     gulong ci;
     MMModemAccessTechnology act;
 
-    guint regex_num;
     gboolean cgreg;
 } CregResult;
 
@@ -489,7 +494,6 @@ test_creg_match (const char *test,
     gulong lac = 0, ci = 0;
     GError *error = NULL;
     gboolean success, cgreg = FALSE;
-    guint regex_num = 0;
     GPtrArray *array;
 
     g_assert (reply);
@@ -502,27 +506,22 @@ test_creg_match (const char *test,
              result->cgreg ? "G" : "",
              solicited ? "solicited" : "unsolicited");
 
+    g_ptr_array_add (data->replies, (gpointer) reply);
+
     array = solicited ? data->solicited_creg : data->unsolicited_creg;
     for (i = 0; i < array->len; i++) {
         GRegex *r = g_ptr_array_index (array, i);
 
-        if (g_regex_match (r, reply, 0, &info)) {
-            g_print ("  matched with %d\n", i);
-            regex_num = i + 1;
+        if (g_regex_match (r, reply, 0, &info))
             break;
-        }
         g_match_info_free (info);
         info = NULL;
     }
 
-    g_print ("  regex_num (%u) == result->regex_num (%u)\n",
-             regex_num,
-             result->regex_num);
-
     g_assert (info != NULL);
-    g_assert_cmpuint (regex_num, ==, result->regex_num);
 
     success = mm_3gpp_parse_creg_response (info, &state, &lac, &ci, &access_tech, &cgreg, &error);
+    g_match_info_free (info);
     g_assert (success);
     g_assert_no_error (error);
     g_assert_cmpuint (state, ==, result->state);
@@ -533,6 +532,20 @@ test_creg_match (const char *test,
              access_tech, result->act);
     g_assert_cmpuint (access_tech, ==, result->act);
     g_assert_cmpuint (cgreg, ==, result->cgreg);
+
+    /* The whole reply, without regex matching, must give the same result */
+    state = MM_MODEM_3GPP_REGISTRATION_STATE_UNKNOWN;
+    access_tech = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
+    lac = ci = 0;
+    cgreg = FALSE;
+    success = mm_3gpp_parse_creg_reply (reply, &state, &lac, &ci, &access_tech, &cgreg, &error);
+    g_assert (success);
+    g_assert_no_error (error);
+    g_assert_cmpuint (state, ==, result->state);
+    g_assert (lac == result->lac);
+    g_assert (ci == result->ci);
+    g_assert_cmpuint (access_tech, ==, result->act);
+    g_assert_cmpuint (cgreg, ==, result->cgreg);
 }
 
 static void
@@ -540,7 +553,7 @@ test_creg1_solicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "+CREG: 1,3";
-    const CregResult result = { 3, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 2, FALSE};
+    const CregResult result = { 3, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("CREG=1", TRUE, reply, data, &result);
 }
@@ -550,7 +563,7 @@ test_creg1_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CREG: 3\r\n";
-    const CregResult result = { 3, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 1, FALSE};
+    const CregResult result = { 3, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("CREG=1", FALSE, reply, data, &result);
 }
@@ -560,7 +573,7 @@ test_creg2_mercury_solicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "+CREG: 0,1,84CD,00D30173";
-    const CregResult result = { 1, 0x84cd, 0xd30173, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 4, FALSE};
+    const CregResult result = { 1, 0x84cd, 0xd30173, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("Sierra Mercury CREG=2", TRUE, reply, data, &result);
 }
@@ -570,7 +583,7 @@ test_creg2_mercury_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CREG: 1,84CD,00D30156\r\n";
-    const CregResult result = { 1, 0x84cd, 0xd30156, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 3, FALSE};
+    const CregResult result = { 1, 0x84cd, 0xd30156, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("Sierra Mercury CREG=2", FALSE, reply, data, &result);
 }
@@ -580,7 +593,7 @@ test_creg2_sek850i_solicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "+CREG: 2,1,\"CE00\",\"01CEAD8F\"";
-    const CregResult result = { 1, 0xce00, 0x01cead8f, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 4, FALSE};
+    const CregResult result = { 1, 0xce00, 0x01cead8f, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("Sony Ericsson K850i CREG=2", TRUE, reply, data, &result);
 }
@@ -590,7 +603,7 @@ test_creg2_sek850i_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CREG: 1,\"CE00\",\"00005449\"\r\n";
-    const CregResult result = { 1, 0xce00, 0x5449, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 3, FALSE};
+    const CregResult result = { 1, 0xce00, 0x5449, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("Sony Ericsson K850i CREG=2", FALSE, reply, data, &result);
 }
@@ -600,7 +613,7 @@ test_creg2_e160g_solicited_unregistered (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "+CREG: 2,0,00,0";
-    const CregResult result = { 0, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 4, FALSE};
+    const CregResult result = { 0, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("Huawei E160G unregistered CREG=2", TRUE, reply, data, &result);
 }
@@ -610,7 +623,7 @@ test_creg2_e160g_solicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "+CREG: 2,1,8BE3,2BAF";
-    const CregResult result = { 1, 0x8be3, 0x2baf, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 4, FALSE};
+    const CregResult result = { 1, 0x8be3, 0x2baf, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("Huawei E160G CREG=2", TRUE, reply, data, &result);
 }
@@ -620,7 +633,7 @@ test_creg2_e160g_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CREG: 2,8BE3,2BAF\r\n";
-    const CregResult result = { 2, 0x8be3, 0x2baf, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 3, FALSE};
+    const CregResult result = { 2, 0x8be3, 0x2baf, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("Huawei E160G CREG=2", FALSE, reply, data, &result);
 }
@@ -630,7 +643,7 @@ test_creg2_tm506_solicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "+CREG: 2,1,\"8BE3\",\"00002BAF\"";
-    const CregResult result = { 1, 0x8BE3, 0x2BAF, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 4, FALSE};
+    const CregResult result = { 1, 0x8BE3, 0x2BAF, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     /* Test leading zeros in the CI */
     test_creg_match ("Sony Ericsson TM-506 CREG=2", TRUE, reply, data, &result);
@@ -641,7 +654,7 @@ test_creg2_xu870_unsolicited_unregistered (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CREG: 2,,\r\n";
-    const CregResult result = { 2, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 3, FALSE};
+    const CregResult result = { 2, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("Novatel XU870 unregistered CREG=2", FALSE, reply, data, &result);
 }
@@ -651,7 +664,7 @@ test_creg2_iridium_solicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "+CREG:002,001,\"18d8\",\"ffff\"";
-    const CregResult result = { 1, 0x18D8, 0xFFFF, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN, 4, FALSE};
+    const CregResult result = { 1, 0x18D8, 0xFFFF, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN, FALSE };
 
     test_creg_match ("Iridium, CREG=2", TRUE, reply, data, &result);
 }
@@ -661,7 +674,7 @@ test_cgreg1_solicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "+CGREG: 1,3";
-    const CregResult result = { 3, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 2, TRUE};
+    const CregResult result = { 3, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , TRUE };
 
     test_creg_match ("CGREG=1", TRUE, reply, data, &result);
 }
@@ -671,7 +684,7 @@ test_cgreg1_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CGREG: 3\r\n";
-    const CregResult result = { 3, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 1, TRUE};
+    const CregResult result = { 3, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , TRUE };
 
     test_creg_match ("CGREG=1", FALSE, reply, data, &result);
 }
@@ -681,7 +694,7 @@ test_cgreg2_f3607gw_solicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "+CGREG: 2,1,\"8BE3\",\"00002B5D\",3";
-    const CregResult result = { 1, 0x8BE3, 0x2B5D, MM_MODEM_ACCESS_TECHNOLOGY_EDGE , 6, TRUE};
+    const CregResult result = { 1, 0x8BE3, 0x2B5D, MM_MODEM_ACCESS_TECHNOLOGY_EDGE , TRUE };
 
     test_creg_match ("Ericsson F3607gw CGREG=2", TRUE, reply, data, &result);
 }
@@ -691,7 +704,7 @@ test_cgreg2_f3607gw_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CGREG: 1,\"8BE3\",\"00002B5D\",3\r\n";
-    const CregResult result = { 1, 0x8BE3, 0x2B5D, MM_MODEM_ACCESS_TECHNOLOGY_EDGE , 5, TRUE};
+    const CregResult result = { 1, 0x8BE3, 0x2B5D, MM_MODEM_ACCESS_TECHNOLOGY_EDGE , TRUE };
 
     test_creg_match ("Ericsson F3607gw CGREG=2", FALSE, reply, data, &result);
 }
@@ -701,7 +714,7 @@ test_creg2_md400_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CREG: 2,5,\"0502\",\"0404736D\"\r\n";
-    const CregResult result = { 5, 0x0502, 0x0404736D, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , 4, FALSE};
+    const CregResult result = { 5, 0x0502, 0x0404736D, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN , FALSE };
 
     test_creg_match ("Sony-Ericsson MD400 CREG=2", FALSE, reply, data, &result);
 }
@@ -711,7 +724,7 @@ test_cgreg2_md400_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CGREG: 5,\"0502\",\"0404736D\",2\r\n";
-    const CregResult result = { 5, 0x0502, 0x0404736D, MM_MODEM_ACCESS_TECHNOLOGY_UMTS, 5, TRUE};
+    const CregResult result = { 5, 0x0502, 0x0404736D, MM_MODEM_ACCESS_TECHNOLOGY_UMTS, TRUE };
 
     test_creg_match ("Sony-Ericsson MD400 CGREG=2", FALSE, reply, data, &result);
 }
@@ -721,7 +734,7 @@ test_creg_cgreg_multi_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CREG: 5\r\n\r\n+CGREG: 0\r\n";
-    const CregResult result = { 5, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN, 1, FALSE};
+    const CregResult result = { 5, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN, FALSE };
 
     test_creg_match ("Multi CREG/CGREG", FALSE, reply, data, &result);
 }
@@ -731,7 +744,7 @@ test_creg_cgreg_multi2_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CGREG: 0\r\n\r\n+CREG: 5\r\n";
-    const CregResult result = { 0, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN, 1, TRUE};
+    const CregResult result = { 0, 0, 0, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN, TRUE };
 
     test_creg_match ("Multi CREG/CGREG #2", FALSE, reply, data, &result);
 }
@@ -741,7 +754,7 @@ test_cgreg2_x220_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CGREG: 2,1, 81ED, 1A9CEB\r\n";
-    const CregResult result = { 1, 0x81ED, 0x1A9CEB, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN, 4, TRUE};
+    const CregResult result = { 1, 0x81ED, 0x1A9CEB, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN, TRUE };
 
     /* Tests random spaces in response */
     test_creg_match ("Alcatel One-Touch X220D CGREG=2", FALSE, reply, data, &result);
@@ -752,7 +765,7 @@ test_creg2_s8500_wave_unsolicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CREG: 2,1,000B,2816, B, C2816\r\n";
-    const CregResult result = { 1, 0x000B, 0x2816, MM_MODEM_ACCESS_TECHNOLOGY_GSM, 7, FALSE};
+    const CregResult result = { 1, 0x000B, 0x2816, MM_MODEM_ACCESS_TECHNOLOGY_GSM, FALSE };
 
     test_creg_match ("Samsung Wave S8500 CREG=2", FALSE, reply, data, &result);
 }
@@ -762,7 +775,7 @@ test_creg2_gobi_weird_solicited (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CREG: 2,1,  0 5, 2715\r\n";
-    const CregResult result = { 1, 0x0000, 0x2715, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN, 4, FALSE};
+    const CregResult result = { 1, 0x0000, 0x2715, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN, FALSE };
 
     test_creg_match ("Qualcomm Gobi 1000 CREG=2", TRUE, reply, data, &result);
 }
@@ -772,11 +785,126 @@ test_cgreg2_unsolicited_with_rac (void *f, gpointer d)
 {
     RegTestData *data = (RegTestData *) d;
     const char *reply = "\r\n+CGREG: 1,\"1422\",\"00000142\",3,\"00\"\r\n";
-    const CregResult result = { 1, 0x1422, 0x0142, MM_MODEM_ACCESS_TECHNOLOGY_EDGE, 8, TRUE };
+    const CregResult result = { 1, 0x1422, 0x0142, MM_MODEM_ACCESS_TECHNOLOGY_EDGE, TRUE };
 
     test_creg_match ("CGREG=2 with RAC", FALSE, reply, data, &result);
 }
 
+static void
+test_creg_tokenize_fields (void *f, gpointer d)
+{
+    MM3gppCregFields fields;
+
+    /* Unsolicited with RAC */
+    g_assert (mm_3gpp_creg_tokenize ("\r\n+CGREG: 1,\"1422\",\"00000142\",3,\"A0\"\r\n", -1, &fields));
+    g_assert (fields.cgreg);
+    g_assert (!fields.cereg);
+    g_assert_cmpint (fields.n, ==, -1);
+    g_assert_cmpint (fields.stat, ==, 1);
+    g_assert_cmpuint (fields.lac, ==, 0x1422);
+    g_assert_cmpuint (fields.ci, ==, 0x142);
+    g_assert_cmpint (fields.act, ==, 3);
+    g_assert_cmpint (fields.rac, ==, 0xA0);
+
+    /* Solicited, with reject cause (CGREG=3); extra fields are ignored */
+    g_assert (mm_3gpp_creg_tokenize ("+CGREG: 3,3,\"1422\",\"00000142\",2,\"0F\",0,13", -1, &fields));
+    g_assert_cmpint (fields.n, ==, 3);
+    g_assert_cmpint (fields.stat, ==, 3);
+    g_assert_cmpuint (fields.lac, ==, 0x1422);
+    g_assert_cmpuint (fields.ci, ==, 0x142);
+    g_assert_cmpint (fields.act, ==, 2);
+    g_assert_cmpint (fields.rac, ==, 0x0F);
+
+    /* EPS registration, TAC in the LAC field */
+    g_assert (mm_3gpp_creg_tokenize ("\r\n+CEREG: 1,\"2B01\",\"01A2D001\",7\r\n", -1, &fields));
+    g_assert (fields.cgreg);
+    g_assert (fields.cereg);
+    g_assert_cmpint (fields.stat, ==, 1);
+    g_assert_cmpuint (fields.lac, ==, 0x2B01);
+    g_assert_cmpuint (fields.ci, ==, 0x01A2D001);
+    g_assert_cmpint (fields.act, ==, 7);
+    g_assert_cmpint (fields.rac, ==, -1);
+
+    /* Only the given length is looked at */
+    g_assert (mm_3gpp_creg_tokenize ("+CREG: 2,1,\"8BE3\",\"00002BAF\"", 8, &fields));
+    g_assert_cmpint (fields.n, ==, -1);
+    g_assert_cmpint (fields.stat, ==, 2);
+
+    /* Not registration messages */
+    g_assert (!mm_3gpp_creg_tokenize ("+CREG: ", -1, &fields));
+    g_assert (!mm_3gpp_creg_tokenize ("+CREG: ,1", -1, &fields));
+    g_assert (!mm_3gpp_creg_tokenize ("+CREG: \"1\"", -1, &fields));
+    g_assert (!mm_3gpp_creg_tokenize ("+COPS: 0,0,\"T-Mobile\"", -1, &fields));
+    g_assert (!mm_3gpp_creg_tokenize ("+CREG", -1, &fields));
+}
+
+static void
+test_creg_tokenize_fuzz (void *f, gpointer d)
+{
+    RegTestData *data = (RegTestData *) d;
+    static const gchar mutations[] = { ',', '"', ' ', '\r', '\n', '\0', '0', '9', 'F', ':' };
+    guint i;
+
+    /* Truncate and mutate the replies from the CREG tests; the tokenizer
+     * must never look past the given length nor give bogus values.  Each
+     * input lives in a buffer of exactly its length so that out of bounds
+     * reads get caught by valgrind or ASan. */
+    for (i = 0; i < data->replies->len; i++) {
+        const gchar *reply = g_ptr_array_index (data->replies, i);
+        gsize reply_len = strlen (reply);
+        gsize len, pos, m;
+
+        for (len = 0; len <= reply_len; len++) {
+            for (pos = 0; pos <= len; pos++) {
+                for (m = 0; m < (pos < len ? G_N_ELEMENTS (mutations) : 1); m++) {
+                    MM3gppCregFields fields;
+                    gchar *buf;
+
+                    buf = g_malloc (MAX (len, 1));
+                    memcpy (buf, reply, len);
+                    if (pos < len)
+                        buf[pos] = mutations[m];
+
+                    if (mm_3gpp_creg_tokenize (buf, len, &fields)) {
+                        g_assert_cmpint (fields.stat, >=, 0);
+                        g_assert_cmpuint (fields.lac, <=, 0xFFFF);
+                        g_assert_cmpuint (fields.ci, <=, 0x0FFFFFFE);
+                        g_assert_cmpint (fields.act, >=, -1);
+                        g_assert_cmpint (fields.act, <=, 7);
+                        g_assert_cmpint (fields.rac, >=, -1);
+                        g_assert_cmpint (fields.rac, <=, 0xFF);
+                    }
+                    g_free (buf);
+                }
+            }
+        }
+    }
+}
+
+static void
+test_creg_tokenize_perf (void *f, gpointer d)
+{
+    RegTestData *data = (RegTestData *) d;
+    MM3gppCregFields fields;
+    guint i, j;
+    guint n = 0;
+    gdouble elapsed;
+
+    if (!g_test_perf ())
+        return;
+
+    g_test_timer_start ();
+    for (i = 0; i < 100000; i++) {
+        for (j = 0; j < data->replies->len; j++) {
+            g_assert (mm_3gpp_creg_tokenize (g_ptr_array_index (data->replies, j), -1, &fields));
+            n++;
+        }
+    }
+    elapsed = g_test_timer_elapsed ();
+
+    g_test_minimized_result (elapsed * 1e9 / n, "registration message tokenized in %.0f ns", elapsed * 1e9 / n);
+}
+
 /*****************************************************************************/
 /* Test CSCS responses */
 
@@ -1536,6 +1664,290 @@ test_parse_cds (void *f, gpointer d)
                       "07914356060013F1065A098136395339F6219011700463802190117004638030");
 }
 
+/*****************************************************************************/
+/* Test +CTZV/+CTZE unsolicited message parsing */
+
+static void
+common_parse_ctz (const gchar *str,
+                  gboolean expected_success,
+                  gint expected_offset,
+                  gint expected_dst_offset)
+{
+    GMatchInfo *match_info;
+    GRegex *regex;
+    gchar *report;
+    gint offset = 0;
+    gint dst_offset = 0;
+    gboolean result;
+    GError *error = NULL;
+
+    regex = mm_3gpp_ctz_regex_get ();
+    g_regex_match (regex, str, 0, &match_info);
+    g_assert (g_match_info_matches (match_info));
+
+    report = g_match_info_fetch (match_info, 1);
+    g_assert (report != NULL);
+
+    result = mm_3gpp_parse_ctzv_ctze (report, &offset, &dst_offset, &error);
+    if (expected_success) {
+        g_assert_no_error (error);
+        g_assert (result);
+        g_assert_cmpint (offset, ==, expected_offset);
+        g_assert_cmpint (dst_offset, ==, expected_dst_offset);
+    } else {
+        g_assert (error != NULL);
+        g_assert (!result);
+        g_error_free (error);
+    }
+
+    g_free (report);
+    g_match_info_free (match_info);
+    g_regex_unref (regex);
+}
+
+static void
+test_parse_ctz (void *f, gpointer d)
+{
+    /* Plain and quoted quarters of an hour */
+    common_parse_ctz ("\r\n+CTZV: -20\r\n", TRUE, -300, -1);
+    common_parse_ctz ("\r\n+CTZV: \"+08\"\r\n", TRUE, 120, -1);
+    common_parse_ctz ("\r\n+CTZV: 0\r\n", TRUE, 0, -1);
+    /* With DST and time */
+    common_parse_ctz ("\r\n+CTZE: \"+04\",1,\"2012/09/19,10:51:49\"\r\n", TRUE, 60, 60);
+    common_parse_ctz ("\r\n+CTZE: -28,0\r\n", TRUE, -420, 0);
+    /* Out of range, or missing DST */
+    common_parse_ctz ("\r\n+CTZV: 99\r\n", FALSE, 0, 0);
+    common_parse_ctz ("\r\n+CTZE: 4\r\n", FALSE, 0, 0);
+    common_parse_ctz ("\r\n+CTZE: 4,3\r\n", FALSE, 0, 0);
+    common_parse_ctz ("\r\n+CTZV: abc\r\n", FALSE, 0, 0);
+}
+
+static void
+test_regex_cache (void *f, gpointer d)
+{
+    GRegex *a, *b, *c;
+    guint size;
+
+    a = mm_regex_cache_get ("\\+TEST:\\s*(\\d+)", G_REGEX_RAW, 0, NULL);
+    g_assert (a != NULL);
+    size = mm_regex_cache_get_size ();
+
+    /* Same pattern and flags give back the same compiled regex */
+    b = mm_regex_cache_get ("\\+TEST:\\s*(\\d+)", G_REGEX_RAW, 0, NULL);
+    g_assert (b == a);
+    g_assert_cmpuint (mm_regex_cache_get_size (), ==, size);
+
+    /* Different flags are a different entry */
+    c = mm_regex_cache_get ("\\+TEST:\\s*(\\d+)", G_REGEX_RAW | G_REGEX_CASELESS, 0, NULL);
+    g_assert (c != NULL);
+    g_assert (c != a);
+    g_assert_cmpuint (mm_regex_cache_get_size (), ==, size + 1);
+
+    /* Entries outlive the callers' references */
+    g_regex_unref (a);
+    g_regex_unref (b);
+    g_regex_unref (c);
+    a = mm_regex_cache_get ("\\+TEST:\\s*(\\d+)", G_REGEX_RAW, 0, NULL);
+    g_assert (a == b);
+    g_regex_unref (a);
+}
+
+/*****************************************************************************/
+/* Test AT grammar engine */
+
+typedef struct {
+    guint index;
+    MMAtSpan name;
+    MMAtRange range;
+    guint extra;
+} GrammarTuple;
+
+static const MMAtField grammar_fields[] = {
+    MM_AT_FIELD (MM_AT_FIELD_UINT,   GrammarTuple, index),
+    MM_AT_FIELD (MM_AT_FIELD_STRING, GrammarTuple, name),
+    MM_AT_FIELD (MM_AT_FIELD_RANGE,  GrammarTuple, range),
+    MM_AT_FIELD_SKIPPED,
+    MM_AT_FIELD (MM_AT_FIELD_UINT,   GrammarTuple, extra)
+};
+
+static const MMAtGrammar grammar = MM_AT_GRAMMAR (grammar_fields, GrammarTuple);
+
+static gboolean
+grammar_tuple_collect (GrammarTuple *tuple,
+                       guint n_fields,
+                       GArray *array)
+{
+    g_assert_cmpuint (n_fields, ==, G_N_ELEMENTS (grammar_fields));
+    g_array_append_vals (array, tuple, 1);
+    return TRUE;
+}
+
+static void
+test_at_grammar_tuples (void *f, gpointer d)
+{
+    /* Nested ranges, quoted separators, skipped lists and a tuple closed too
+     * early (the remaining fields come before a stray parenthesis) */
+    const gchar *reply = "+TEST: (1,\"a,(b)\",(0-5),(1,2),7), ( 2 , c ,(3,1,2),x,8),(3,\"\",4,()),9)";
+    GArray *array;
+    MMAtCursor cursor;
+    GrammarTuple tuple;
+    GrammarTuple *t;
+
+    array = g_array_new (FALSE, FALSE, sizeof (GrammarTuple));
+    mm_at_cursor_init (&cursor, reply, -1);
+    g_assert (mm_at_cursor_find (&cursor, "+TEST:"));
+    mm_at_cursor_foreach_tuple (&cursor,
+                                &grammar,
+                                &tuple,
+                                (MMAtTupleFn) grammar_tuple_collect,
+                                array);
+    g_assert_cmpuint (array->len, ==, 3);
+
+    t = &g_array_index (array, GrammarTuple, 0);
+    g_assert_cmpuint (t->index, ==, 1);
+    g_assert (mm_at_span_equal (&t->name, "a,(b)"));
+    g_assert_cmpuint (t->range.min, ==, 0);
+    g_assert_cmpuint (t->range.max, ==, 5);
+    g_assert_cmpuint (t->extra, ==, 7);
+
+    t = &g_array_index (array, GrammarTuple, 1);
+    g_assert_cmpuint (t->index, ==, 2);
+    g_assert (mm_at_span_equal (&t->name, "c"));
+    g_assert_cmpuint (t->range.min, ==, 1);
+    g_assert_cmpuint (t->range.max, ==, 3);
+    g_assert_cmpuint (t->extra, ==, 8);
+
+    t = &g_array_index (array, GrammarTuple, 2);
+    g_assert_cmpuint (t->index, ==, 3);
+    g_assert (mm_at_span_equal (&t->name, ""));
+    g_assert (mm_at_span_dup (&t->name) == NULL);
+    g_assert_cmpuint (t->range.min, ==, 4);
+    g_assert_cmpuint (t->range.max, ==, 4);
+    g_assert_cmpuint (t->extra, ==, 9);
+
+    g_array_free (array, TRUE);
+}
+
+static void
+test_at_grammar_values (void *f, gpointer d)
+{
+    MMAtCursor cursor;
+    MMAtSpan span;
+    guint value;
+    gchar buf[4];
+
+    mm_at_cursor_init (&cursor, "12,\"34\",abc , 5x,\"toolong\"\r\n99", -1);
+    g_assert (mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_UINT, &value));
+    g_assert_cmpuint (value, ==, 12);
+    g_assert (mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_UINT, &value));
+    g_assert_cmpuint (value, ==, 34);
+    /* Not a number; the cursor doesn't move */
+    g_assert (!mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_UINT, &value));
+    g_assert (mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_STRING, &span));
+    g_assert (mm_at_span_equal (&span, "abc"));
+    /* Trailing garbage after a number */
+    g_assert (!mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_UINT, &value));
+    g_assert (mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_SKIP, NULL));
+    g_assert (mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_STRING, &span));
+    g_assert (!mm_at_span_copy (&span, buf, sizeof (buf)));
+    /* Values don't run past the end of the line */
+    g_assert (mm_at_cursor_at_end (&cursor));
+    g_assert (!mm_at_cursor_parse_value (&cursor, MM_AT_FIELD_UINT, &value));
+}
+
+/*****************************************************************************/
+/* Test CMGF, CIND? and CRM responses */
+
+static void
+test_cmgf_response (void *f, gpointer d)
+{
+    static const struct {
+        const gchar *reply;
+        gboolean pdu;
+        gboolean text;
+    } tests[] = {
+        { "+CMGF: (0-1)", TRUE,  TRUE  },
+        { "+CMGF: (0,1)", TRUE,  TRUE  },
+        { "+CMGF: 0,1",   TRUE,  TRUE  },
+        { "+CMGF: (0)",   TRUE,  FALSE },
+        { "+CMGF: (1)",   FALSE, TRUE  },
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+        gboolean pdu = FALSE;
+        gboolean text = FALSE;
+        GError *error = NULL;
+
+        g_assert (mm_3gpp_parse_cmgf_test_response (tests[i].reply, &pdu, &text, &error));
+        g_assert_no_error (error);
+        g_assert_cmpint (pdu, ==, tests[i].pdu);
+        g_assert_cmpint (text, ==, tests[i].text);
+    }
+
+    g_assert (!mm_3gpp_parse_cmgf_test_response ("+CMGF: ", NULL, NULL, NULL));
+}
+
+static void
+test_cind_response_single_value (void *f, gpointer d)
+{
+    const char *reply = "+CIND: (\"call\",(0)),(\"Roam\",(0-2))";
+    static CindEntry expected[] = {
+        { "call", 0, 0 },
+        { "roam", 0, 2 }
+    };
+
+    test_cind_results ("single value", reply, &expected[0], G_N_ELEMENTS (expected));
+}
+
+static void
+test_cind_read_response (void *f, gpointer d)
+{
+    GByteArray *array;
+    GError *error = NULL;
+
+    array = mm_3gpp_parse_cind_read_response ("+CIND: 5,0,1,254", &error);
+    g_assert_no_error (error);
+    g_assert (array != NULL);
+    /* Plus the 0 element for 1-based indexes */
+    g_assert_cmpuint (array->len, ==, 5);
+    g_assert_cmpuint (array->data[1], ==, 5);
+    g_assert_cmpuint (array->data[4], ==, 254);
+    g_byte_array_unref (array);
+
+    array = mm_3gpp_parse_cind_read_response ("+CIND: 5,300", &error);
+    g_assert (array == NULL);
+    g_assert (error != NULL);
+    g_clear_error (&error);
+
+    array = mm_3gpp_parse_cind_read_response ("+CIND: ", &error);
+    g_assert (array == NULL);
+    g_assert (error != NULL);
+    g_clear_error (&error);
+}
+
+static void
+test_crm_response (void *f, gpointer d)
+{
+    MMModemCdmaRmProtocol min = MM_MODEM_CDMA_RM_PROTOCOL_UNKNOWN;
+    MMModemCdmaRmProtocol max = MM_MODEM_CDMA_RM_PROTOCOL_UNKNOWN;
+    GError *error = NULL;
+
+    g_assert (mm_cdma_parse_crm_test_response ("+CRM: (1-2)", &min, &max, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (min, ==, mm_cdma_get_rm_protocol_from_index (1, NULL));
+    g_assert_cmpint (max, ==, mm_cdma_get_rm_protocol_from_index (2, NULL));
+
+    /* RM protocol indexes start at 1 */
+    g_assert (!mm_cdma_parse_crm_test_response ("+CRM: (0-2)", &min, &max, &error));
+    g_assert (error != NULL);
+    g_clear_error (&error);
+
+    g_assert (!mm_cdma_parse_crm_test_response ("OK", &min, &max, &error));
+    g_assert (error != NULL);
+    g_clear_error (&error);
+}
+
 /*****************************************************************************/
 
 void
@@ -1616,6 +2028,10 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_cgreg2_md400_unsolicited, reg_data));
     g_test_suite_add (suite, TESTCASE (test_cgreg2_x220_unsolicited, reg_data));
     g_test_suite_add (suite, TESTCASE (test_cgreg2_unsolicited_with_rac, reg_data));
+    g_test_suite_add (suite, TESTCASE (test_creg_tokenize_fields, NULL));
+    /* These reuse the replies collected by the CREG tests above */
+    g_test_suite_add (suite, TESTCASE (test_creg_tokenize_fuzz, reg_data));
+    g_test_suite_add (suite, TESTCASE (test_creg_tokenize_perf, reg_data));
 
     g_test_suite_add (suite, TESTCASE (test_creg_cgreg_multi_unsolicited, reg_data));
     g_test_suite_add (suite, TESTCASE (test_creg_cgreg_multi2_unsolicited, reg_data));
@@ -1648,6 +2064,16 @@ int main (int argc, char **argv)
 
 
     g_test_suite_add (suite, TESTCASE (test_parse_cds, NULL));
+    g_test_suite_add (suite, TESTCASE (test_parse_ctz, NULL));
+
+    g_test_suite_add (suite, TESTCASE (test_regex_cache, NULL));
+
+    g_test_suite_add (suite, TESTCASE (test_at_grammar_tuples, NULL));
+    g_test_suite_add (suite, TESTCASE (test_at_grammar_values, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cmgf_response, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cind_response_single_value, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cind_read_response, NULL));
+    g_test_suite_add (suite, TESTCASE (test_crm_response, NULL));
 
     result = g_test_run ();
 
@@ -396,6 +396,99 @@ test_leading_frame_markers (void *f)
     g_assert (wait_for_child (d, 3));
 }
 
+static void
+qcdm_verinfo_expect_verinfo_cb (MMQcdmSerialPort *port,
+                                GByteArray *response,
+                                GError *error,
+                                gpointer user_data)
+{
+    GMainLoop *loop = user_data;
+
+    /* Must be the Version Info reply, not the frame received before */
+    g_assert_no_error (error);
+    g_assert (response != NULL);
+    g_assert_cmpuint (response->len, ==, 55);
+    g_assert_cmpint (response->data[0], ==, 0x00);
+    g_main_loop_quit (loop);
+}
+
+static gboolean
+qcdm_request_verinfo_delayed (MMQcdmSerialPort *port)
+{
+    GMainLoop *loop;
+
+    loop = g_object_get_data (G_OBJECT (port), "loop");
+    qcdm_request_verinfo (port, qcdm_verinfo_expect_verinfo_cb, loop);
+    return FALSE;
+}
+
+/* Test that a frame nobody waits for (e.g. a reply arriving after its
+ * command timed out) doesn't get reported as the reply to the next command.
+ */
+static void
+test_unexpected_frame_dropped (void *f)
+{
+    TestData *d = f;
+    char req[512];
+    gsize req_len;
+    pid_t cpid;
+    const char unexpected[] = {
+        0x0c, 0x01, 0x02, 0x03, 0x1d, 0x30, 0x7e
+    };
+    const char rsp[] = {
+        0x00, 0x41, 0x75, 0x67, 0x20, 0x31, 0x39, 0x20, 0x32, 0x30, 0x30, 0x38,
+        0x32, 0x30, 0x3a, 0x34, 0x38, 0x3a, 0x34, 0x37, 0x4f, 0x63, 0x74, 0x20,
+        0x32, 0x39, 0x20, 0x32, 0x30, 0x30, 0x37, 0x31, 0x39, 0x3a, 0x30, 0x30,
+        0x3a, 0x30, 0x30, 0x53, 0x43, 0x4e, 0x52, 0x5a, 0x2e, 0x2e, 0x2e, 0x2a,
+        0x06, 0x04, 0xb9, 0x0b, 0x02, 0x00, 0xb2, 0x19, 0xc4, 0x7e
+    };
+
+    signal (SIGCHLD, SIG_DFL);
+    cpid = fork ();
+    g_assert (cpid >= 0);
+
+    if (cpid == 0) {
+        MMQcdmSerialPort *port;
+        GMainLoop *loop;
+        gboolean success;
+        GError *error = NULL;
+
+        /* In the child */
+        g_type_init ();
+
+        loop = g_main_loop_new (NULL, FALSE);
+
+        port = mm_qcdm_serial_port_new_fd (d->slave);
+        g_assert (port);
+        g_object_set_data (G_OBJECT (port), "loop", loop);
+
+        success = mm_serial_port_open (MM_SERIAL_PORT (port), &error);
+        g_assert_no_error (error);
+        g_assert (success);
+
+        /* Let the unexpected frame arrive before sending the command */
+        g_timeout_add (500, (GSourceFunc) qcdm_request_verinfo_delayed, port);
+        g_main_loop_run (loop);
+
+        mm_serial_port_close (MM_SERIAL_PORT (port));
+        g_object_unref (port);
+        exit (0);
+    }
+    /* Parent */
+    d->child = cpid;
+
+    server_send_response (d->master, unexpected, sizeof (unexpected));
+
+    req_len = server_wait_request (d->master, req, sizeof (req));
+    g_assert (req_len == 1);
+    g_assert_cmpint (req[0], ==, 0x00);
+
+    server_send_response (d->master, rsp, sizeof (rsp));
+
+    /* We expect the child to exit normally */
+    g_assert (wait_for_child (d, 3));
+}
+
 static void
 test_pty_create (gpointer user_data)
 {
@@ -472,6 +565,7 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE_PTY (test_sierra_cns_rejected, data));
     g_test_suite_add (suite, TESTCASE_PTY (test_random_data_rejected, data));
     g_test_suite_add (suite, TESTCASE_PTY (test_leading_frame_markers, data));
+    g_test_suite_add (suite, TESTCASE_PTY (test_unexpected_frame_dropped, data));
 
     result = g_test_run ();
 
@@ -0,0 +1,163 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <glib.h>
+
+#include "mm-scan-cache.h"
+#include "mm-log.h"
+
+#define SEC(s) ((gint64) (s) * G_USEC_PER_SEC)
+
+static GVariant *
+build_result (const gchar *operator_code)
+{
+    GVariantBuilder builder;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+    g_variant_builder_open (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "operator-code", g_variant_new_string (operator_code));
+    g_variant_builder_close (&builder);
+    return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static void
+test_age (void)
+{
+    MMScanCache *cache;
+    GVariant *result;
+    GList *waiting;
+    guint age = 0;
+
+    cache = mm_scan_cache_new ();
+
+    /* Nothing scanned yet */
+    g_assert (mm_scan_cache_peek (cache, G_MAXUINT, SEC (100), &age) == NULL);
+
+    g_assert_cmpint (mm_scan_cache_start (cache, FALSE, NULL), ==, MM_SCAN_CACHE_START_NEW);
+    result = build_result ("310260");
+    waiting = mm_scan_cache_complete (cache, result, SEC (100));
+    g_assert (waiting == NULL);
+    g_variant_unref (result);
+
+    /* Fresh enough */
+    result = mm_scan_cache_peek (cache, 30, SEC (100), &age);
+    g_assert (result != NULL);
+    g_assert_cmpuint (age, ==, 0);
+    result = mm_scan_cache_peek (cache, 30, SEC (130) + G_USEC_PER_SEC / 2, &age);
+    g_assert (result != NULL);
+    g_assert_cmpuint (age, ==, 30);
+
+    /* Expired */
+    g_assert (mm_scan_cache_peek (cache, 30, SEC (131), &age) == NULL);
+    g_assert (mm_scan_cache_peek (cache, 0, SEC (101), &age) == NULL);
+
+    /* A failed scan keeps the previous results and their age */
+    g_assert_cmpint (mm_scan_cache_start (cache, FALSE, NULL), ==, MM_SCAN_CACHE_START_NEW);
+    g_assert (mm_scan_cache_peek (cache, G_MAXUINT, SEC (150), &age) == NULL);
+    waiting = mm_scan_cache_complete (cache, NULL, SEC (200));
+    g_assert (waiting == NULL);
+    result = mm_scan_cache_peek (cache, G_MAXUINT, SEC (200), &age);
+    g_assert (result != NULL);
+    g_assert_cmpuint (age, ==, 100);
+
+    /* A successful one replaces them */
+    g_assert_cmpint (mm_scan_cache_start (cache, FALSE, NULL), ==, MM_SCAN_CACHE_START_NEW);
+    result = build_result ("310410");
+    waiting = mm_scan_cache_complete (cache, result, SEC (300));
+    g_variant_unref (result);
+    result = mm_scan_cache_peek (cache, 10, SEC (305), &age);
+    g_assert (result != NULL);
+    g_assert_cmpuint (age, ==, 5);
+    g_assert (g_variant_n_children (result) == 1);
+
+    /* Dropped when no longer valid */
+    mm_scan_cache_clear (cache);
+    g_assert (mm_scan_cache_peek (cache, G_MAXUINT, SEC (305), &age) == NULL);
+
+    mm_scan_cache_free (cache);
+}
+
+static void
+test_coalesce (void)
+{
+    MMScanCache *cache;
+    GVariant *result;
+    GList *waiting;
+    gint requests[3];
+
+    cache = mm_scan_cache_new ();
+
+    /* A background scan is running... */
+    g_assert_cmpint (mm_scan_cache_start (cache, TRUE, NULL), ==, MM_SCAN_CACHE_START_NEW);
+    g_assert (mm_scan_cache_is_running (cache));
+    g_assert (mm_scan_cache_is_background (cache));
+
+    /* ...other background requests just share it... */
+    g_assert_cmpint (mm_scan_cache_start (cache, TRUE, NULL), ==, MM_SCAN_CACHE_START_JOINED);
+    g_assert (mm_scan_cache_is_background (cache));
+
+    /* ...until a foreground one arrives and the scan stops yielding */
+    g_assert_cmpint (mm_scan_cache_start (cache, FALSE, &requests[0]), ==, MM_SCAN_CACHE_START_PROMOTED);
+    g_assert (!mm_scan_cache_is_background (cache));
+    g_assert_cmpint (mm_scan_cache_start (cache, FALSE, &requests[1]), ==, MM_SCAN_CACHE_START_JOINED);
+    g_assert_cmpint (mm_scan_cache_start (cache, TRUE, &requests[2]), ==, MM_SCAN_CACHE_START_JOINED);
+    g_assert (!mm_scan_cache_is_background (cache));
+
+    /* Cached results are never given while a newer scan is running */
+    result = build_result ("310260");
+    waiting = mm_scan_cache_complete (cache, result, SEC (10));
+    g_variant_unref (result);
+
+    /* All waiting requests, in order; the background ones are not there */
+    g_assert_cmpuint (g_list_length (waiting), ==, 3);
+    g_assert (waiting->data == &requests[0]);
+    g_assert (waiting->next->data == &requests[1]);
+    g_assert (waiting->next->next->data == &requests[2]);
+    g_list_free (waiting);
+    g_assert (!mm_scan_cache_is_running (cache));
+
+    /* Requests arriving after completion need a new scan */
+    g_assert_cmpint (mm_scan_cache_start (cache, FALSE, &requests[0]), ==, MM_SCAN_CACHE_START_NEW);
+    g_assert (!mm_scan_cache_is_background (cache));
+    g_assert (mm_scan_cache_peek (cache, G_MAXUINT, SEC (10), NULL) == NULL);
+    waiting = mm_scan_cache_complete (cache, NULL, SEC (20));
+    g_assert_cmpuint (g_list_length (waiting), ==, 1);
+    g_list_free (waiting);
+
+    mm_scan_cache_free (cache);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+    /* Dummy log function */
+}
+
+int main (int argc, char **argv)
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/scan-cache/age", test_age);
+    g_test_add_func ("/ModemManager/scan-cache/coalesce", test_coalesce);
+
+    return g_test_run ();
+}
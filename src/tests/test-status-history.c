@@ -0,0 +1,208 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "mm-status-history.h"
+#include "mm-log.h"
+
+#define MODEM0 "/org/freedesktop/ModemManager1/Modem/0"
+#define MODEM1 "/org/freedesktop/ModemManager1/Modem/1"
+#define MODEM2 "/org/freedesktop/ModemManager1/Modem/2"
+
+static gint
+compare_paths (const gchar **a,
+               const gchar **b)
+{
+    return strcmp (*a, *b);
+}
+
+/* Checks the changes since the given generation against NULL-terminated
+ * lists of paths */
+static void
+assert_changes (MMStatusHistory *history,
+                guint64 since,
+                gboolean expected_complete,
+                const gchar **expected_changed,
+                const gchar **expected_removed)
+{
+    GPtrArray *changed;
+    GPtrArray *removed;
+    gboolean complete;
+    guint i;
+
+    complete = mm_status_history_get_changes (history, since, &changed, &removed);
+    g_assert_cmpint (complete, ==, expected_complete);
+
+    g_ptr_array_sort (changed, (GCompareFunc) compare_paths);
+    for (i = 0; expected_changed[i]; i++) {
+        g_assert_cmpuint (i, <, changed->len);
+        g_assert_cmpstr (g_ptr_array_index (changed, i), ==, expected_changed[i]);
+    }
+    g_assert_cmpuint (changed->len, ==, i);
+
+    g_ptr_array_sort (removed, (GCompareFunc) compare_paths);
+    for (i = 0; expected_removed[i]; i++) {
+        g_assert_cmpuint (i, <, removed->len);
+        g_assert_cmpstr (g_ptr_array_index (removed, i), ==, expected_removed[i]);
+    }
+    g_assert_cmpuint (removed->len, ==, i);
+
+    g_ptr_array_unref (changed);
+    g_ptr_array_unref (removed);
+}
+
+static void
+test_delta (void)
+{
+    MMStatusHistory *history;
+    guint64 start;
+    guint64 after_add;
+    guint64 after_update;
+    const gchar *none[] = { NULL };
+    const gchar *all[] = { MODEM0, MODEM1, NULL };
+    const gchar *only0[] = { MODEM0, NULL };
+    const gchar *only1[] = { MODEM1, NULL };
+    const gchar *only2[] = { MODEM2, NULL };
+    const gchar *added[] = { MODEM0, MODEM2, NULL };
+
+    history = mm_status_history_new (100, 8);
+    start = mm_status_history_get_generation (history);
+    g_assert_cmpuint (start, ==, 100);
+
+    mm_status_history_update (history, MODEM0);
+    mm_status_history_update (history, MODEM1);
+    after_add = mm_status_history_get_generation (history);
+    g_assert_cmpuint (after_add, >, start);
+    assert_changes (history, start, FALSE, all, none);
+    assert_changes (history, after_add, FALSE, none, none);
+
+    /* Only the updated one */
+    mm_status_history_update (history, MODEM1);
+    after_update = mm_status_history_get_generation (history);
+    assert_changes (history, after_add, FALSE, only1, none);
+
+    /* Removals of unknown objects are not changes */
+    mm_status_history_remove (history, MODEM2);
+    g_assert_cmpuint (mm_status_history_get_generation (history), ==, after_update);
+
+    mm_status_history_remove (history, MODEM0);
+    assert_changes (history, after_update, FALSE, none, only0);
+    assert_changes (history, start, FALSE, only1, only0);
+
+    /* Added back, so no longer removed */
+    mm_status_history_update (history, MODEM0);
+    assert_changes (history, after_update, FALSE, only0, none);
+
+    mm_status_history_update (history, MODEM2);
+    assert_changes (history, after_update, FALSE, added, none);
+    assert_changes (history, mm_status_history_get_generation (history) - 1, FALSE, only2, none);
+
+    mm_status_history_free (history);
+}
+
+static void
+test_restart (void)
+{
+    MMStatusHistory *previous;
+    MMStatusHistory *history;
+    guint64 since;
+    guint i;
+    const gchar *none[] = { NULL };
+    const gchar *all[] = { MODEM0, MODEM1, NULL };
+
+    /* A client got a generation from the previous instance... */
+    previous = mm_status_history_new (0, 8);
+    mm_status_history_update (previous, MODEM0);
+    since = mm_status_history_get_generation (previous);
+    mm_status_history_free (previous);
+
+    /* ...and the new one is already past that many changes */
+    history = mm_status_history_new (0, 8);
+    g_assert_cmpuint (mm_status_history_get_generation (history), !=, since);
+    for (i = 0; i < 10; i++) {
+        mm_status_history_update (history, MODEM0);
+        mm_status_history_update (history, MODEM1);
+    }
+    assert_changes (history, since, TRUE, all, none);
+
+    /* Generations before or after the known range */
+    assert_changes (history, 0, TRUE, all, none);
+    assert_changes (history, G_MAXUINT64, TRUE, all, none);
+    assert_changes (history, mm_status_history_get_generation (history), FALSE, none, none);
+
+    mm_status_history_free (history);
+
+    /* Clients never see a generation of 0 */
+    history = mm_status_history_new (0, 8);
+    g_assert_cmpuint (mm_status_history_get_generation (history), >, G_MAXUINT32);
+    mm_status_history_free (history);
+}
+
+static void
+test_expired (void)
+{
+    MMStatusHistory *history;
+    guint64 start;
+    guint64 after_first;
+    const gchar *none[] = { NULL };
+    const gchar *only0[] = { MODEM0, NULL };
+    const gchar *only1[] = { MODEM1, NULL };
+    const gchar *only2[] = { MODEM2, NULL };
+
+    /* Remember a single removal */
+    history = mm_status_history_new (100, 1);
+    mm_status_history_update (history, MODEM0);
+    mm_status_history_update (history, MODEM1);
+    mm_status_history_update (history, MODEM2);
+    start = mm_status_history_get_generation (history);
+
+    mm_status_history_remove (history, MODEM0);
+    after_first = mm_status_history_get_generation (history);
+    assert_changes (history, start, FALSE, none, only0);
+
+    /* The first removal gets forgotten, so whoever might have missed it
+     * gets the complete list */
+    mm_status_history_remove (history, MODEM1);
+    assert_changes (history, start, TRUE, only2, none);
+    assert_changes (history, after_first, FALSE, none, only1);
+
+    mm_status_history_free (history);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+    /* Dummy log function */
+}
+
+int main (int argc, char **argv)
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/status-history/delta", test_delta);
+    g_test_add_func ("/ModemManager/status-history/restart", test_restart);
+    g_test_add_func ("/ModemManager/status-history/expired", test_expired);
+
+    return g_test_run ();
+}
@@ -0,0 +1,281 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "mm-step-scheduler.h"
+#include "mm-log.h"
+
+typedef struct {
+    /* Step names in launch order */
+    GString *launched;
+    /* Steps launched and not done yet */
+    GList *running;
+    guint max_running;
+    /* Steps which finish right away */
+    guint64 sync;
+    /* Step which aborts the scheduler when run */
+    gint abort_step;
+    gboolean finished;
+    gboolean aborted;
+} TestContext;
+
+static void
+test_step_run (MMStepScheduler *scheduler,
+               guint step,
+               TestContext *ctx)
+{
+    g_string_append_printf (ctx->launched, "%u", step);
+
+    if (ctx->abort_step == (gint)step)
+        mm_step_scheduler_abort (scheduler);
+
+    if (ctx->sync & MM_STEP (step)) {
+        mm_step_scheduler_step_done (scheduler, step);
+        return;
+    }
+
+    ctx->running = g_list_append (ctx->running, GUINT_TO_POINTER (step));
+    ctx->max_running = MAX (ctx->max_running, g_list_length (ctx->running));
+}
+
+static void
+test_done (MMStepScheduler *scheduler,
+           TestContext *ctx)
+{
+    g_assert (!ctx->finished);
+    ctx->finished = TRUE;
+    ctx->aborted = mm_step_scheduler_is_aborted (scheduler);
+}
+
+static void
+test_finish_step (MMStepScheduler *scheduler,
+                  TestContext *ctx,
+                  guint step)
+{
+    g_assert (g_list_find (ctx->running, GUINT_TO_POINTER (step)));
+    ctx->running = g_list_remove (ctx->running, GUINT_TO_POINTER (step));
+    mm_step_scheduler_step_done (scheduler, step);
+}
+
+static MMStepScheduler *
+test_scheduler_new (TestContext *ctx,
+                    const MMStepInfo *steps,
+                    guint n_steps)
+{
+    memset (ctx, 0, sizeof (TestContext));
+    ctx->launched = g_string_new ("");
+    ctx->abort_step = -1;
+    return mm_step_scheduler_new ("test", steps, n_steps, ctx);
+}
+
+static void
+test_scheduler_free (MMStepScheduler *scheduler,
+                     TestContext *ctx)
+{
+    g_assert (ctx->running == NULL);
+    g_string_free (ctx->launched, TRUE);
+    mm_step_scheduler_free (scheduler);
+}
+
+/*****************************************************************************/
+
+#define RUN ((MMStepRunFn)test_step_run)
+
+static const MMStepInfo graph_steps[] = {
+    { "0", RUN, 0,                         MM_STEP_PORT_AT   },
+    { "1", RUN, 0,                         MM_STEP_PORT_AT   },
+    { "2", RUN, MM_STEP (0),               MM_STEP_PORT_NONE },
+    { "3", RUN, MM_STEP (0) | MM_STEP (1), MM_STEP_PORT_AT   },
+    { "4", RUN, MM_STEP (2) | MM_STEP (3), MM_STEP_PORT_QCDM },
+};
+
+static void
+test_graph (void)
+{
+    MMStepScheduler *scheduler;
+    TestContext ctx;
+
+    scheduler = test_scheduler_new (&ctx, graph_steps, G_N_ELEMENTS (graph_steps));
+    mm_step_scheduler_set_port_slots (scheduler, MM_STEP_PORT_AT, 2);
+    mm_step_scheduler_run (scheduler, NULL, (MMStepSchedulerDoneFn)test_done, &ctx);
+
+    /* Independent steps run at once, one per AT port */
+    g_assert_cmpstr (ctx.launched->str, ==, "01");
+
+    /* Steps only depending on 0 go on */
+    test_finish_step (scheduler, &ctx, 0);
+    g_assert_cmpstr (ctx.launched->str, ==, "012");
+
+    test_finish_step (scheduler, &ctx, 2);
+    test_finish_step (scheduler, &ctx, 1);
+    g_assert_cmpstr (ctx.launched->str, ==, "0123");
+
+    test_finish_step (scheduler, &ctx, 3);
+    g_assert_cmpstr (ctx.launched->str, ==, "01234");
+    g_assert (!ctx.finished);
+
+    test_finish_step (scheduler, &ctx, 4);
+    g_assert (ctx.finished);
+    g_assert (!ctx.aborted);
+
+    test_scheduler_free (scheduler, &ctx);
+}
+
+static void
+test_sync (void)
+{
+    MMStepScheduler *scheduler;
+    TestContext ctx;
+
+    scheduler = test_scheduler_new (&ctx, graph_steps, G_N_ELEMENTS (graph_steps));
+    ctx.sync = G_MAXUINT64;
+    mm_step_scheduler_run (scheduler, NULL, (MMStepSchedulerDoneFn)test_done, &ctx);
+
+    /* Steps finishing right away keep the table order */
+    g_assert_cmpstr (ctx.launched->str, ==, "01234");
+    g_assert (ctx.finished);
+    g_assert (!ctx.aborted);
+
+    test_scheduler_free (scheduler, &ctx);
+}
+
+static const MMStepInfo independent_steps[] = {
+    { "0", RUN, 0, MM_STEP_PORT_AT   },
+    { "1", RUN, 0, MM_STEP_PORT_AT   },
+    { "2", RUN, 0, MM_STEP_PORT_AT   },
+    { "3", RUN, 0, MM_STEP_PORT_NONE },
+    { "4", RUN, 0, MM_STEP_PORT_NONE },
+};
+
+static void
+test_slots (void)
+{
+    MMStepScheduler *scheduler;
+    TestContext ctx;
+
+    scheduler = test_scheduler_new (&ctx, independent_steps, G_N_ELEMENTS (independent_steps));
+    mm_step_scheduler_run (scheduler, NULL, (MMStepSchedulerDoneFn)test_done, &ctx);
+
+    /* A single AT port; steps not using ports don't wait */
+    g_assert_cmpstr (ctx.launched->str, ==, "034");
+    test_finish_step (scheduler, &ctx, 3);
+    test_finish_step (scheduler, &ctx, 4);
+    test_finish_step (scheduler, &ctx, 0);
+    g_assert_cmpstr (ctx.launched->str, ==, "0341");
+    test_finish_step (scheduler, &ctx, 1);
+    test_finish_step (scheduler, &ctx, 2);
+
+    g_assert (ctx.finished);
+    g_assert_cmpuint (ctx.max_running, ==, 3);
+
+    test_scheduler_free (scheduler, &ctx);
+}
+
+static void
+test_remap (void)
+{
+    MMStepScheduler *scheduler;
+    TestContext ctx;
+
+    scheduler = test_scheduler_new (&ctx, independent_steps, G_N_ELEMENTS (independent_steps));
+    mm_step_scheduler_set_port_slots (scheduler, MM_STEP_PORT_QMI, 2);
+    mm_step_scheduler_remap_port (scheduler, MM_STEP_PORT_AT, MM_STEP_PORT_QMI);
+    mm_step_scheduler_run (scheduler, NULL, (MMStepSchedulerDoneFn)test_done, &ctx);
+
+    /* AT steps take the QMI slots, not the single AT one */
+    g_assert_cmpstr (ctx.launched->str, ==, "0134");
+    test_finish_step (scheduler, &ctx, 1);
+    g_assert_cmpstr (ctx.launched->str, ==, "01342");
+    test_finish_step (scheduler, &ctx, 0);
+    test_finish_step (scheduler, &ctx, 2);
+    test_finish_step (scheduler, &ctx, 3);
+    test_finish_step (scheduler, &ctx, 4);
+
+    g_assert (ctx.finished);
+    g_assert_cmpuint (ctx.max_running, ==, 4);
+
+    test_scheduler_free (scheduler, &ctx);
+}
+
+static void
+test_abort (void)
+{
+    MMStepScheduler *scheduler;
+    TestContext ctx;
+
+    scheduler = test_scheduler_new (&ctx, graph_steps, G_N_ELEMENTS (graph_steps));
+    mm_step_scheduler_set_port_slots (scheduler, MM_STEP_PORT_AT, 2);
+    ctx.abort_step = 0;
+    mm_step_scheduler_run (scheduler, NULL, (MMStepSchedulerDoneFn)test_done, &ctx);
+
+    /* Nothing else launched after aborting, but we wait for running steps */
+    g_assert_cmpstr (ctx.launched->str, ==, "0");
+    test_finish_step (scheduler, &ctx, 0);
+    g_assert (ctx.finished);
+    g_assert (ctx.aborted);
+
+    test_scheduler_free (scheduler, &ctx);
+}
+
+static void
+test_cancel (void)
+{
+    MMStepScheduler *scheduler;
+    GCancellable *cancellable;
+    TestContext ctx;
+
+    cancellable = g_cancellable_new ();
+    scheduler = test_scheduler_new (&ctx, graph_steps, G_N_ELEMENTS (graph_steps));
+    mm_step_scheduler_run (scheduler, cancellable, (MMStepSchedulerDoneFn)test_done, &ctx);
+    g_assert_cmpstr (ctx.launched->str, ==, "0");
+
+    g_cancellable_cancel (cancellable);
+    test_finish_step (scheduler, &ctx, 0);
+    g_assert_cmpstr (ctx.launched->str, ==, "0");
+    g_assert (ctx.finished);
+    g_assert (ctx.aborted);
+
+    test_scheduler_free (scheduler, &ctx);
+    g_object_unref (cancellable);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+    /* Dummy log function */
+}
+
+int main (int argc, char **argv)
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/step-scheduler/graph", test_graph);
+    g_test_add_func ("/ModemManager/step-scheduler/sync", test_sync);
+    g_test_add_func ("/ModemManager/step-scheduler/slots", test_slots);
+    g_test_add_func ("/ModemManager/step-scheduler/remap", test_remap);
+    g_test_add_func ("/ModemManager/step-scheduler/abort", test_abort);
+    g_test_add_func ("/ModemManager/step-scheduler/cancel", test_cancel);
+
+    return g_test_run ();
+}
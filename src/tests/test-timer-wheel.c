@@ -0,0 +1,224 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <glib.h>
+
+/* The wheel is built right into the test with a fake monotonic clock, so
+ * that hours of wheel time can be walked through without waiting, and the
+ * dispatcher can be driven by hand instead of from the main loop */
+static gint64 fake_time;
+
+static gint64
+fake_monotonic_time (void)
+{
+    return fake_time;
+}
+
+#define g_get_monotonic_time fake_monotonic_time
+#include "mm-timer-wheel.c"
+#undef g_get_monotonic_time
+
+/* Sets the fake clock to the given second and runs all ticks up to it */
+static void
+advance_to (guint64 second)
+{
+    fake_time = (gint64) second * G_USEC_PER_SEC;
+    if (wheel->source_id)
+        g_source_remove (wheel->source_id);
+    wheel_dispatch (NULL);
+}
+
+typedef struct {
+    guint fired;
+    guint64 fired_at;
+    /* Timer to remove when fired */
+    guint remove_id;
+    gboolean again;
+} TestTimer;
+
+static gboolean
+test_timer_cb (TestTimer *t)
+{
+    t->fired++;
+    t->fired_at = now_tick ();
+    if (t->remove_id)
+        g_assert (mm_timer_wheel_remove (t->remove_id));
+    return t->again;
+}
+
+static guint
+test_timer_add (TestTimer *t,
+                guint interval,
+                guint coalesce_window)
+{
+    return mm_timer_wheel_add_seconds (interval,
+                                       coalesce_window,
+                                       (GSourceFunc) test_timer_cb,
+                                       t);
+}
+
+/*****************************************************************************/
+
+static void
+test_level1_boundary (void)
+{
+    TestTimer t = { 0, 0, 0, FALSE };
+
+    /* Expires right when level 1 slot 12 cascades */
+    fake_time = 700 * G_USEC_PER_SEC;
+    test_timer_add (&t, 68, MM_TIMER_WHEEL_COALESCE_NONE);
+
+    advance_to (767);
+    g_assert_cmpuint (t.fired, ==, 0);
+    advance_to (768);
+    g_assert_cmpuint (t.fired, ==, 1);
+    g_assert_cmpuint (t.fired_at, ==, 768);
+
+    mm_timer_wheel_shutdown ();
+}
+
+static void
+test_level2_boundary (void)
+{
+    TestTimer at = { 0, 0, 0, FALSE };
+    TestTimer after = { 0, 0, 0, FALSE };
+
+    /* Both in level 2 when added; one expires when level 2 slot 2 cascades,
+     * the other a full level 0 turn later */
+    fake_time = 100 * G_USEC_PER_SEC;
+    test_timer_add (&at, 8192 - 100, MM_TIMER_WHEEL_COALESCE_NONE);
+    test_timer_add (&after, 8256 - 100, MM_TIMER_WHEEL_COALESCE_NONE);
+
+    advance_to (8191);
+    g_assert_cmpuint (at.fired, ==, 0);
+    advance_to (8192);
+    g_assert_cmpuint (at.fired, ==, 1);
+    g_assert_cmpuint (at.fired_at, ==, 8192);
+    g_assert_cmpuint (after.fired, ==, 0);
+
+    advance_to (8255);
+    g_assert_cmpuint (after.fired, ==, 0);
+    advance_to (8256);
+    g_assert_cmpuint (after.fired, ==, 1);
+    g_assert_cmpuint (after.fired_at, ==, 8256);
+
+    mm_timer_wheel_shutdown ();
+}
+
+static void
+test_far_future (void)
+{
+    TestTimer t = { 0, 0, 0, FALSE };
+    guint64 expires;
+
+    /* Beyond the last level, parked and re-evaluated */
+    fake_time = 10 * G_USEC_PER_SEC;
+    expires = 10 + WHEEL_RANGE (WHEEL_LEVELS - 1) + 1000;
+    test_timer_add (&t, (guint) (expires - 10), MM_TIMER_WHEEL_COALESCE_NONE);
+
+    advance_to (expires - 1);
+    g_assert_cmpuint (t.fired, ==, 0);
+    advance_to (expires);
+    g_assert_cmpuint (t.fired, ==, 1);
+
+    mm_timer_wheel_shutdown ();
+}
+
+static void
+test_coalesce (void)
+{
+    TestTimer a = { 0, 0, 0, TRUE };
+    TestTimer b = { 0, 0, 0, FALSE };
+    guint n_timers;
+    guint64 n_dispatched;
+
+    fake_time = 1001 * G_USEC_PER_SEC;
+    test_timer_add (&a, 3, MM_TIMER_WHEEL_PERIODIC_COALESCE_SEC);
+    test_timer_add (&b, 4, MM_TIMER_WHEEL_PERIODIC_COALESCE_SEC);
+
+    /* A single wakeup for both */
+    g_assert (wheel->source_id != 0);
+    g_assert_cmpuint (wheel->armed_tick, ==, 1005);
+
+    advance_to (1005);
+    g_assert_cmpuint (a.fired, ==, 1);
+    g_assert_cmpuint (b.fired, ==, 1);
+    mm_timer_wheel_get_stats (&n_timers, NULL, &n_dispatched);
+    g_assert_cmpuint (n_timers, ==, 1);
+    g_assert_cmpuint (n_dispatched, ==, 2);
+
+    /* Rescheduled aligned to the window again */
+    g_assert_cmpuint (wheel->armed_tick, ==, 1010);
+    advance_to (1010);
+    g_assert_cmpuint (a.fired, ==, 2);
+
+    mm_timer_wheel_shutdown ();
+}
+
+static void
+test_remove_while_dispatching (void)
+{
+    TestTimer a = { 0, 0, 0, TRUE };
+    TestTimer b = { 0, 0, 0, TRUE };
+    TestTimer c = { 0, 0, 0, TRUE };
+    guint id_a;
+    guint id_b;
+    guint id_c;
+    guint n_timers;
+
+    fake_time = 50 * G_USEC_PER_SEC;
+    id_a = test_timer_add (&a, 10, MM_TIMER_WHEEL_COALESCE_NONE);
+    id_b = test_timer_add (&b, 10, MM_TIMER_WHEEL_COALESCE_NONE);
+    id_c = test_timer_add (&c, 10, MM_TIMER_WHEEL_COALESCE_NONE);
+
+    /* Whichever fires first removes the other two; the one still being
+     * dispatched is only freed once its callback returns */
+    a.remove_id = id_b;
+    b.remove_id = id_c;
+    c.remove_id = id_a;
+
+    advance_to (60);
+    g_assert_cmpuint (a.fired + b.fired + c.fired, ==, 2);
+
+    /* The survivor asked to be rescheduled and is the only one left */
+    mm_timer_wheel_get_stats (&n_timers, NULL, NULL);
+    g_assert_cmpuint (n_timers, ==, 1);
+
+    /* Removing a timer from within its own callback */
+    a.remove_id = id_a;
+    b.remove_id = id_b;
+    c.remove_id = id_c;
+    advance_to (70);
+    g_assert_cmpuint (a.fired + b.fired + c.fired, ==, 3);
+    mm_timer_wheel_get_stats (&n_timers, NULL, NULL);
+    g_assert_cmpuint (n_timers, ==, 0);
+
+    mm_timer_wheel_shutdown ();
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/timer-wheel/level1-boundary", test_level1_boundary);
+    g_test_add_func ("/ModemManager/timer-wheel/level2-boundary", test_level2_boundary);
+    g_test_add_func ("/ModemManager/timer-wheel/far-future", test_far_future);
+    g_test_add_func ("/ModemManager/timer-wheel/coalesce", test_coalesce);
+    g_test_add_func ("/ModemManager/timer-wheel/remove-while-dispatching", test_remove_while_dispatching);
+
+    return g_test_run ();
+}
@@ -0,0 +1,179 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "mm-trace.h"
+#include "mm-log.h"
+
+static guint
+count_matches (const gchar *str,
+               const gchar *needle)
+{
+    guint n = 0;
+
+    while ((str = strstr (str, needle)) != NULL) {
+        n++;
+        str += strlen (needle);
+    }
+    return n;
+}
+
+static void
+test_disabled (void)
+{
+    gchar *json;
+
+    g_assert (!mm_trace_enabled ());
+    g_assert_cmpint (mm_trace_begin (), ==, 0);
+
+    /* No-ops */
+    mm_trace_span ("test", "ttyUSB0", g_get_monotonic_time (), "AT", NULL);
+    mm_trace_instant ("test", "ttyUSB0", "AT", NULL);
+
+    json = mm_trace_to_json ();
+    g_assert_cmpstr (json, ==, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[]}\n");
+    g_free (json);
+}
+
+static void
+test_events (void)
+{
+    gint64 start;
+    gchar *json;
+
+    mm_trace_init (8);
+    g_assert (mm_trace_enabled ());
+
+    start = mm_trace_begin ();
+    g_assert_cmpint (start, >, 0);
+    mm_trace_span ("serial", "ttyUSB0", start, "AT+CGMI", "replied");
+    mm_trace_instant ("modem", "/sys/devices/usb1", "state", NULL);
+    /* Spans which started while not tracing are ignored */
+    mm_trace_span ("serial", "ttyUSB0", 0, "AT+CGMM", NULL);
+
+    json = mm_trace_to_json ();
+
+    /* One track name per track */
+    g_assert_cmpuint (count_matches (json, "\"ph\":\"M\""), ==, 2);
+    g_assert (strstr (json, "\"args\":{\"name\":\"ttyUSB0\"}") != NULL);
+    g_assert (strstr (json, "\"args\":{\"name\":\"/sys/devices/usb1\"}") != NULL);
+
+    g_assert_cmpuint (count_matches (json, "\"ph\":\"X\""), ==, 1);
+    g_assert_cmpuint (count_matches (json, "\"ph\":\"i\""), ==, 1);
+    g_assert (strstr (json, "\"name\":\"AT+CGMI\",\"cat\":\"serial\"") != NULL);
+    g_assert (strstr (json, "\"args\":{\"detail\":\"replied\"}") != NULL);
+    g_assert (strstr (json, "AT+CGMM") == NULL);
+    g_free (json);
+
+    mm_trace_shutdown ();
+    g_assert (!mm_trace_enabled ());
+}
+
+static void
+test_ring (void)
+{
+    gchar *json;
+    gchar *name;
+    guint i;
+
+    mm_trace_init (4);
+
+    for (i = 0; i < 10; i++) {
+        name = g_strdup_printf ("event%u", i);
+        mm_trace_span ("test", "track", mm_trace_begin (), name, NULL);
+        g_free (name);
+    }
+
+    /* Only the last ones are kept, oldest first */
+    json = mm_trace_to_json ();
+    g_assert_cmpuint (count_matches (json, "\"ph\":\"X\""), ==, 4);
+    g_assert (strstr (json, "\"event5\"") == NULL);
+    g_assert (strstr (json, "\"event6\"") < strstr (json, "\"event9\""));
+    g_free (json);
+
+    mm_trace_shutdown ();
+}
+
+static void
+test_escape (void)
+{
+    gchar *json;
+
+    mm_trace_init (4);
+
+    mm_trace_span ("serial", "ttyUSB0", mm_trace_begin (), "AT+COPS=1,2,\"310260\"\r", "a\\b");
+    mm_trace_span ("serial", "ttyUSB0", mm_trace_begin (), "AT\xff", NULL);
+
+    json = mm_trace_to_json ();
+    g_assert (strstr (json, "\"AT+COPS=1,2,\\\"310260\\\"\\u000d\"") != NULL);
+    g_assert (strstr (json, "\"a\\\\b\"") != NULL);
+    g_assert (strstr (json, "\"AT?\"") != NULL);
+    g_free (json);
+
+    mm_trace_shutdown ();
+}
+
+static void
+test_tracks_bounded (void)
+{
+    gchar *json;
+    gchar *track;
+    guint i;
+
+    mm_trace_init (4);
+
+    for (i = 0; i < 1000; i++) {
+        track = g_strdup_printf ("ttyUSB%u", i);
+        mm_trace_instant ("test", track, "plugged", NULL);
+        g_free (track);
+    }
+
+    json = mm_trace_to_json ();
+    g_assert_cmpuint (count_matches (json, "\"ph\":\"M\""), ==, 256);
+    g_assert (strstr (json, "\"args\":{\"name\":\"ttyUSB0\"}") != NULL);
+    g_assert (strstr (json, "\"args\":{\"name\":\"ttyUSB999\"}") == NULL);
+    g_assert (strstr (json, "\"args\":{\"name\":\"Other\"}") != NULL);
+    g_free (json);
+
+    mm_trace_shutdown ();
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+    /* Dummy log function */
+}
+
+int main (int argc, char **argv)
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/trace/disabled", test_disabled);
+    g_test_add_func ("/ModemManager/trace/events", test_events);
+    g_test_add_func ("/ModemManager/trace/ring", test_ring);
+    g_test_add_func ("/ModemManager/trace/escape", test_escape);
+    g_test_add_func ("/ModemManager/trace/tracks-bounded", test_tracks_bounded);
+
+    return g_test_run ();
+}
@@ -0,0 +1,429 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2012 Google, Inc.
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <string.h>
+#include <pty.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+
+#include <ModemManager.h>
+#include <mm-errors-types.h>
+
+#include "mm-wmc-serial-port.h"
+#include "libwmc/src/commands.h"
+#include "libwmc/src/utils.h"
+#include "libwmc/src/com.h"
+#include "libwmc/src/errors.h"
+#include "mm-log.h"
+
+typedef struct {
+    int master;
+    int slave;
+    gboolean valid;
+    pid_t child;
+} TestData;
+
+#define AT_WMC_PREFIX "AT*WMC="
+
+/* Network info responses captured from a PC5740 and a UML290 */
+static const char pc5740_rsp[] = {
+    0xc8, 0x0b, 0x17, 0x00, 0x00, 0x00, 0x06, 0x00, 0xdb, 0x07, 0x06, 0x00,
+    0x11, 0x00, 0x0d, 0x00, 0x2d, 0x00, 0x10, 0x00, 0xe4, 0x03, 0xd4, 0xfe,
+    0xff, 0xff, 0x4e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x0e, 0x92, 0x7e
+};
+
+static const char uml290_rsp[] = {
+    0xc8, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x0e, 0x00, 0xda, 0x07, 0x0c, 0x00,
+    0x14, 0x00, 0x12, 0x00, 0x19, 0x00, 0x06, 0x00, 0xc2, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x7d, 0x5d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x7d, 0x5d, 0x00, 0x00, 0x00, 0x01, 0x00,
+    0x00, 0x00, 0x01, 0x56, 0x65, 0x72, 0x69, 0x7a, 0x6f, 0x6e, 0x20, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x39,
+    0x00, 0x00, 0x00, 0x40, 0x06, 0x00, 0x00, 0x30, 0x30, 0x7e
+};
+
+static gboolean
+wait_for_child (TestData *d, guint32 timeout)
+{
+    GTimeVal start, now;
+    int status, ret;
+
+    g_get_current_time (&start);
+    do {
+        status = 0;
+        ret = waitpid (d->child, &status, WNOHANG);
+        g_get_current_time (&now);
+        if (d->child && (now.tv_sec - start.tv_sec > timeout)) {
+            /* Kill it */
+            if (g_test_verbose ())
+                g_message ("Killing running child process %d", d->child);
+            kill (d->child, SIGKILL);
+            d->child = 0;
+        }
+        if (ret == 0)
+            sleep (1);
+    } while ((ret <= 0) || (!WIFEXITED (status) && !WIFSIGNALED (status)));
+
+    d->child = 0;
+    return (WIFEXITED (status) && WEXITSTATUS (status) == 0) ? TRUE : FALSE;
+}
+
+static void
+print_buf (const char *detail, const char *buf, gsize len)
+{
+    int i = 0;
+    gboolean newline = FALSE;
+
+    g_print ("%s (%zu)  ", detail, len);
+    for (i = 0; i < len; i++) {
+        g_print ("0x%02x ", buf[i] & 0xFF);
+        if (((i + 1) % 12) == 0) {
+            g_print ("\n");
+            newline = TRUE;
+        } else
+            newline = FALSE;
+    }
+
+    if (!newline)
+        g_print ("\n");
+}
+
+static void
+server_send_response (int fd, const char *buf, gsize len)
+{
+    int status;
+    gsize i = 0;
+
+    if (g_test_verbose ())
+        print_buf (">>>", buf, len);
+
+    while (i < len) {
+        errno = 0;
+        status = write (fd, &buf[i], 1);
+        g_assert_cmpint (errno, ==, 0);
+        g_assert (status == 1);
+        i++;
+        usleep (1000);
+    }
+}
+
+/* Reads a request up to its terminator ('\r' for UML290 requests, the HDLC
+ * control char otherwise) and returns its unescaped contents, without CRC.
+ */
+static gsize
+server_wait_request (int fd, gboolean uml290, char *buf, gsize len)
+{
+    fd_set in;
+    int result;
+    struct timeval timeout = { 1, 0 };
+    char readbuf[1024];
+    ssize_t bytes_read;
+    int total = 0, retries = 0;
+    char terminator = uml290 ? 0x0D : DIAG_CONTROL_CHAR;
+    gsize decap_len = 0;
+
+    FD_ZERO (&in);
+    FD_SET (fd, &in);
+    result = select (fd + 1, &in, NULL, NULL, &timeout);
+    g_assert (result == 1);
+    g_assert (FD_ISSET (fd, &in));
+
+    do {
+        errno = 0;
+        bytes_read = read (fd, &readbuf[total], 1);
+        if ((bytes_read == 0) || (errno == EAGAIN)) {
+            /* Haven't gotten the terminator yet */
+            if (retries > 20)
+                return 0; /* 2 seconds, give up */
+
+            /* Otherwise wait a bit and try again */
+            usleep (100000);
+            retries++;
+            continue;
+        } else if (bytes_read == 1) {
+            total++;
+            if (readbuf[total - 1] == terminator)
+                break;
+        } else {
+            /* Some error occurred */
+            g_assert_not_reached ();
+        }
+    } while (total < sizeof (readbuf));
+
+    if (g_test_verbose ())
+        print_buf ("<<<", readbuf, total);
+
+    if (uml290) {
+        hdlcbool escaping = FALSE;
+        gsize prefix_len = strlen (AT_WMC_PREFIX);
+
+        g_assert_cmpint (total, >, prefix_len + 3);
+        g_assert (memcmp (readbuf, AT_WMC_PREFIX, prefix_len) == 0);
+
+        /* Frame, escaped CRC and '\r' */
+        decap_len = hdlc_unescape (readbuf + prefix_len,
+                                   total - prefix_len - 1,
+                                   buf, len, &escaping);
+        g_assert (escaping == FALSE);
+        g_assert_cmpint (decap_len, >, 2);
+        decap_len -= 2;
+    } else {
+        gboolean success;
+        gsize used = 0;
+        wmcbool more = FALSE;
+
+        success = wmc_decapsulate (readbuf, total, buf, len, &decap_len, &used, &more, FALSE);
+        g_assert (success);
+        g_assert (!more);
+    }
+
+    if (g_test_verbose ())
+        print_buf ("D<<", buf, decap_len);
+
+    return decap_len;
+}
+
+typedef void (*NetInfoCb) (MMWmcSerialPort *port,
+                           GByteArray *response,
+                           GError *error,
+                           gpointer user_data);
+
+static void
+wmc_netinfo_expect_success_cb (MMWmcSerialPort *port,
+                               GByteArray *response,
+                               GError *error,
+                               gpointer user_data)
+{
+    GMainLoop *loop = user_data;
+    WmcResult *result;
+    guint8 service = 0;
+
+    g_assert_no_error (error);
+    g_assert (response->len > 2);
+    g_assert_cmpint ((guint8) response->data[0], ==, 0xC8);
+    g_assert_cmpint ((guint8) response->data[1], ==, 0x0B);
+
+    result = wmc_cmd_network_info_result ((const char *) response->data, response->len);
+    g_assert (result);
+    g_assert_cmpint (wmc_result_get_u8 (result, WMC_CMD_NETWORK_INFO_ITEM_SERVICE, &service), ==, WMC_SUCCESS);
+    wmc_result_unref (result);
+
+    g_main_loop_quit (loop);
+}
+
+static void
+wmc_netinfo_expect_fail_cb (MMWmcSerialPort *port,
+                            GByteArray *response,
+                            GError *error,
+                            gpointer user_data)
+{
+    GMainLoop *loop = user_data;
+
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED);
+    g_main_loop_quit (loop);
+}
+
+static void
+wmc_test_child (int fd, gboolean uml290, NetInfoCb cb)
+{
+    MMWmcSerialPort *port;
+    GMainLoop *loop;
+    GByteArray *netinfo;
+    gboolean success;
+    GError *error = NULL;
+
+    /* In the child */
+    g_type_init ();
+
+    loop = g_main_loop_new (NULL, FALSE);
+
+    port = mm_wmc_serial_port_new_fd (fd);
+    g_assert (port);
+    g_object_set (port, MM_WMC_SERIAL_PORT_UML290, uml290, NULL);
+
+    success = mm_serial_port_open (MM_SERIAL_PORT (port), &error);
+    g_assert_no_error (error);
+    g_assert (success);
+
+    netinfo = g_byte_array_sized_new (10);
+    netinfo->len = wmc_cmd_network_info_new ((char *) netinfo->data, 10);
+    g_assert (netinfo->len);
+
+    mm_wmc_serial_port_queue_command (port, netinfo, 3, NULL, cb, loop);
+    g_main_loop_run (loop);
+
+    mm_serial_port_close (MM_SERIAL_PORT (port));
+    g_object_unref (port);
+}
+
+static void
+run_netinfo_test (TestData *d,
+                  gboolean uml290,
+                  const char *rsp,
+                  gsize rsp_len,
+                  NetInfoCb cb)
+{
+    char req[512];
+    gsize req_len;
+    pid_t cpid;
+
+    signal (SIGCHLD, SIG_DFL);
+    cpid = fork ();
+    g_assert (cpid >= 0);
+
+    if (cpid == 0) {
+        /* In the child */
+        wmc_test_child (d->slave, uml290, cb);
+        exit (0);
+    }
+    /* Parent */
+    d->child = cpid;
+
+    req_len = server_wait_request (d->master, uml290, req, sizeof (req));
+    g_assert_cmpint (req_len, >=, 2);
+    g_assert_cmpint ((guint8) req[0], ==, 0xC8);
+    g_assert_cmpint ((guint8) req[1], ==, 0x0B);
+
+    server_send_response (d->master, rsp, rsp_len);
+
+    /* We expect the child to exit normally */
+    g_assert (wait_for_child (d, 3));
+}
+
+/* Test that a Network Info request/response is processed correctly */
+static void
+test_netinfo (void *f)
+{
+    run_netinfo_test (f, FALSE, pc5740_rsp, sizeof (pc5740_rsp),
+                      wmc_netinfo_expect_success_cb);
+}
+
+/* Test that UML290 requests get the AT*WMC= framing and that responses with
+ * its fake CRC are accepted.
+ */
+static void
+test_netinfo_uml290 (void *f)
+{
+    run_netinfo_test (f, TRUE, uml290_rsp, sizeof (uml290_rsp),
+                      wmc_netinfo_expect_success_cb);
+}
+
+/* Test that a response with a bad CRC raises an error in the child's
+ * response handler.
+ */
+static void
+test_bad_crc_rejected (void *f)
+{
+    char rsp[sizeof (pc5740_rsp)];
+
+    memcpy (rsp, pc5740_rsp, sizeof (rsp));
+    rsp[sizeof (rsp) - 2] ^= 0x01;
+    run_netinfo_test (f, FALSE, rsp, sizeof (rsp),
+                      wmc_netinfo_expect_fail_cb);
+}
+
+static void
+test_pty_create (gpointer user_data)
+{
+    TestData *d = user_data;
+    struct termios stbuf;
+    int ret, err;
+
+    ret = openpty (&d->master, &d->slave, NULL, NULL, NULL);
+    g_assert (ret == 0);
+    d->valid = TRUE;
+
+    /* set raw mode on the slave using kernel default parameters */
+    memset (&stbuf, 0, sizeof (stbuf));
+    tcgetattr (d->slave, &stbuf);
+    tcflush (d->slave, TCIOFLUSH);
+    cfmakeraw (&stbuf);
+    tcsetattr (d->slave, TCSANOW, &stbuf);
+    fcntl (d->slave, F_SETFL, O_NONBLOCK);
+
+    fcntl (d->master, F_SETFL, O_NONBLOCK);
+    err = wmc_port_setup (d->master);
+    g_assert_cmpint (err, ==, WMC_SUCCESS);
+}
+
+static void
+test_pty_cleanup (gpointer user_data)
+{
+    TestData *d = user_data;
+
+    if (d->valid) {
+        if (d->child)
+            kill (d->child, SIGKILL);
+        if (d->master >= 0)
+            close (d->master);
+        if (d->slave >= 0)
+            close (d->slave);
+        memset (d, 0, sizeof (*d));
+    }
+}
+
+#if GLIB_CHECK_VERSION(2,25,12)
+typedef GTestFixtureFunc TCFunc;
+#else
+typedef void (*TCFunc)(void);
+#endif
+
+#define TESTCASE_PTY(t, d) g_test_create_case (#t, sizeof (*d), d, (TCFunc) test_pty_create, (TCFunc) t, (TCFunc) test_pty_cleanup)
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+    /* Dummy log function */
+}
+
+int main (int argc, char **argv)
+{
+    GTestSuite *suite;
+    gint result;
+    TestData *data = NULL;
+
+    g_test_init (&argc, &argv, NULL);
+
+    suite = g_test_get_root ();
+
+    g_test_suite_add (suite, TESTCASE_PTY (test_netinfo, data));
+    g_test_suite_add (suite, TESTCASE_PTY (test_netinfo_uml290, data));
+    g_test_suite_add (suite, TESTCASE_PTY (test_bad_crc_rejected, data));
+
+    result = g_test_run ();
+
+    return result;
+}
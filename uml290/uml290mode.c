@@ -35,6 +35,7 @@
 #include "libqcdm/src/errors.h"
 #include "libqcdm/src/commands.h"
 #include "libqcdm/src/com.h"
+#include "libqcdm/src/channel.h"
 
 static int debug = 0;
 
@@ -88,116 +89,64 @@ com_setup (const char *port)
 
 /******************************************************************/
 
-static wmcbool
-wmc_send (int fd, char *inbuf, size_t inbuf_len, size_t cmd_len)
-{
-	int status;
-	int eagain_count = 1000;
-	size_t i = 0, sendlen;
-	char sendbuf[600];
-
-	if (debug)
-		print_buf ("\nWMC:RAW>>>", inbuf, cmd_len);
-
-	/* Encapsulate the data for the device */
-	sendlen = wmc_encapsulate (inbuf, cmd_len, inbuf_len, sendbuf, sizeof (sendbuf), TRUE);
-	if (sendlen <= 0) {
-		fprintf (stderr, "E: failed to encapsulate WMC command\n");
-		return FALSE;
-	}
-
-	if (debug)
-		print_buf ("WMC:ENC>>>", sendbuf, sendlen);
-
-	while (i < sendlen) {
-		errno = 0;
-		status = write (fd, &sendbuf[i], 1);
-		if (status < 0) {
-			if (errno == EAGAIN) {
-				eagain_count--;
-				if (eagain_count <= 0)
-					return FALSE;
-			} else
-				assert (errno == 0);
-		} else
-			i++;
+typedef struct {
+	int error;
+	char *buf;
+	size_t buf_len;
+	size_t len;
+	int done;
+} Reply;
 
-		usleep (1000);
+static void
+reply_cb (QcdmChannel *channel,
+          int error,
+          const char *response,
+          size_t len,
+          void *user_data)
+{
+	Reply *reply = user_data;
+
+	reply->done = 1;
+	reply->error = error;
+	if (response) {
+		if (len > reply->buf_len)
+			len = reply->buf_len;
+		memcpy (reply->buf, response, len);
+		reply->len = len;
+
+		if (debug)
+			print_buf ("DEC<<<", response, len);
 	}
-
-	return TRUE;
 }
 
+/* Drives the channel until the request completes; returns the length of the
+ * reply, or 0 on error */
 static size_t
-wmc_wait_reply (int fd, char *buf, size_t len)
+channel_wait_reply (QcdmChannel *channel, Reply *reply)
 {
-	fd_set in;
-	int result;
-	struct timeval timeout = { 1, 0 };
-	char readbuf[2048];
-	ssize_t bytes_read;
-	int total = 0, retries = 0;
-	size_t decap_len = 0;
-
-	FD_ZERO (&in);
-	FD_SET (fd, &in);
-	result = select (fd + 1, &in, NULL, NULL, &timeout);
-	if (result != 1 || !FD_ISSET (fd, &in))
-		return 0;
+	while (!reply->done) {
+		/* On port failure the request has been failed as well */
+		if (qcdm_channel_poll (&channel, 1, -1) < 0)
+			break;
+	}
 
-	do {
-		errno = 0;
-		bytes_read = read (fd, &readbuf[total], 1);
-		if ((bytes_read == 0) || (errno == EAGAIN)) {
-			/* Haven't gotten the async control char yet */
-			if (retries > 20)
-				return 0; /* 2 seconds, give up */
-
-			/* Otherwise wait a bit and try again */
-			usleep (100000);
-			retries++;
-			continue;
-		} else if (bytes_read == 1) {
-			wmcbool more = FALSE, success;
-			size_t used = 0;
-
-			total++;
-			decap_len = 0;
-			success = wmc_decapsulate (readbuf, total, buf, len, &decap_len, &used, &more, TRUE);
-
-			if (success && !more && debug)
-				print_buf ("WMC:RAW<<<", readbuf, total);
-
-			/* Discard used data */
-			if (used > 0) {
-				total -= used;
-				memmove (readbuf, &readbuf[used], total);
-			}
-
-			if (success && !more) {
-				/* Success; we have a packet */
-				break;
-			}
-		} else {
-			/* Some error occurred */
-			return 0;
-		}
-	} while (total < sizeof (readbuf));
+	return (reply->done && reply->error == 0) ? reply->len : 0;
+}
 
-	if (debug)
-		print_buf ("WMC:DEC<<<", buf, decap_len);
+#define REPLY_TIMEOUT_MSECS 3000
 
-	return decap_len;
-}
+/******************************************************************/
 
 static int
 wmc_set_global_mode (const char *port, u_int8_t mode)
 {
 	int fd, err;
-	char buf[1024];
+	char buf[1024], encbuf[1024];
 	size_t len;
 	WmcResult *result;
 	size_t reply_len;
+	QcdmChannel *channel = NULL;
+	Reply reply = { 0, buf, sizeof (buf), 0, 0 };
 
 	fd = com_setup (port);
 	if (fd < 0)
@@ -209,18 +158,38 @@ wmc_set_global_mode (const char *port, u_int8_t mode)
 		goto error;
 	}
 
+	channel = wmc_channel_new (fd, TRUE, &err);
+	if (!channel) {
+		fprintf (stderr, "E: failed to set up WMC channel on %s: %d\n", port, err);
+		goto error;
+	}
+
 	len = wmc_cmd_set_global_mode_new (buf, sizeof (buf), mode);
 	assert (len);
 
+	if (debug)
+		print_buf ("\nWMC:RAW>>>", buf, len);
+
+	/* Encapsulate the data for the device */
+	len = wmc_encapsulate (buf, len, sizeof (buf), encbuf, sizeof (encbuf), TRUE);
+	if (len <= 0) {
+		fprintf (stderr, "E: failed to encapsulate WMC command\n");
+		goto error;
+	}
+
+	if (debug)
+		print_buf ("WMC:ENC>>>", encbuf, len);
+
 	/* Send the command */
-	if (!wmc_send (fd, buf, sizeof (buf), len)) {
-		fprintf (stderr, "E: failed to send WMC global mode command\n");
+	err = wmc_channel_submit (channel, encbuf, len, REPLY_TIMEOUT_MSECS, reply_cb, &reply);
+	if (err < 0) {
+		fprintf (stderr, "E: failed to send WMC global mode command: %d\n", err);
 		goto error;
 	}
 
-	reply_len = wmc_wait_reply (fd, buf, sizeof (buf));
+	reply_len = channel_wait_reply (channel, &reply);
 	if (!reply_len) {
-		fprintf (stderr, "E: failed to receive global mode command reply\n");
+		fprintf (stderr, "E: failed to receive global mode command reply: %d\n", reply.error);
 		goto error;
 	}
 
@@ -232,137 +201,80 @@ wmc_set_global_mode (const char *port, u_int8_t mode)
 	}
 	wmc_result_unref (result);
 
+	qcdm_channel_free (channel);
 	close (fd);
 	return 0;
 
 error:
+	if (channel)
+		qcdm_channel_free (channel);
 	close (fd);
 	return -1;
 }
 
 /******************************************************************/
 
-static qcdmbool
-qcdm_send (int fd, char *buf, size_t len)
+/* Sends an already encapsulated DM command and waits for its reply */
+static size_t
+qcdm_request (const char *port, const char *cmd, size_t cmd_len, char *buf, size_t buf_len)
 {
-	int status;
-	int eagain_count = 1000;
-	size_t i = 0;
+	int fd, err;
+	QcdmChannel *channel;
+	Reply reply = { 0, buf, buf_len, 0, 0 };
+	size_t reply_len = 0;
 
-	if (debug)
-		print_buf ("DM:ENC>>>", buf, len);
-
-	while (i < len) {
-		errno = 0;
-		status = write (fd, &buf[i], 1);
-		if (status < 0) {
-			if (errno == EAGAIN) {
-				eagain_count--;
-				if (eagain_count <= 0)
-					return FALSE;
-			} else
-				assert (errno == 0);
-		} else
-			i++;
+	fd = com_setup (port);
+	if (fd < 0)
+		return 0;
 
-		usleep (1000);
+	err = qcdm_port_setup (fd);
+	if (err != QCDM_SUCCESS) {
+		fprintf (stderr, "E: failed to set up DM port %s: %d\n", port, err);
+		goto out;
 	}
 
-	return TRUE;
-}
-
-static size_t
-qcdm_wait_reply (int fd, char *buf, size_t len)
-{
-	fd_set in;
-	int result;
-	struct timeval timeout = { 1, 0 };
-	char readbuf[1024];
-	ssize_t bytes_read;
-	int total = 0, retries = 0;
-	size_t decap_len = 0;
-
-	FD_ZERO (&in);
-	FD_SET (fd, &in);
-	result = select (fd + 1, &in, NULL, NULL, &timeout);
-	if (result != 1 || !FD_ISSET (fd, &in))
-		return 0;
-
-	do {
-		errno = 0;
-		bytes_read = read (fd, &readbuf[total], 1);
-		if ((bytes_read == 0) || (errno == EAGAIN)) {
-			/* Haven't gotten the async control char yet */
-			if (retries > 20)
-				return 0; /* 2 seconds, give up */
-
-			/* Otherwise wait a bit and try again */
-			usleep (100000);
-			retries++;
-			continue;
-		} else if (bytes_read == 1) {
-			qcdmbool more = FALSE;
-			qcdmbool success;
-			size_t used = 0;
-
-			total++;
-			decap_len = 0;
-			success = dm_decapsulate_buffer (readbuf, total, buf, len, &decap_len, &used, &more);
-
-			/* Discard used data */
-			if (used > 0) {
-				total -= used;
-				memmove (readbuf, &readbuf[used], total);
-			}
-
-			if (success && !more) {
-				/* Success; we have a packet */
-				break;
-			}
-		} else {
-			/* Some error occurred */
-			return 0;
-		}
-	} while (total < sizeof (readbuf));
+	channel = qcdm_channel_new (fd, &err);
+	if (!channel) {
+		fprintf (stderr, "E: failed to set up DM channel on %s: %d\n", port, err);
+		goto out;
+	}
 
 	if (debug)
-		print_buf ("QCDM:DEC<<", buf, decap_len);
+		print_buf ("DM:ENC>>>", cmd, cmd_len);
+
+	err = qcdm_channel_submit (channel, cmd, cmd_len, NULL, 0, REPLY_TIMEOUT_MSECS, reply_cb, &reply);
+	if (err < 0)
+		fprintf (stderr, "E: failed to send DM command: %d\n", err);
+	else {
+		reply_len = channel_wait_reply (channel, &reply);
+		if (!reply_len)
+			fprintf (stderr, "E: failed to receive DM command reply: %d\n", reply.error);
+	}
 
-	return decap_len;
+	qcdm_channel_free (channel);
+
+out:
+	close (fd);
+	return reply_len;
 }
 
 static int
 qcdm_set_hdr_pref (const char *port, u_int8_t hdrpref)
 {
-	int fd, err;
+	int err;
 	char buf[512];
 	size_t len;
 	QcdmResult *result;
 	size_t reply_len;
 
-	fd = com_setup (port);
-	if (fd < 0)
-		return -1;
-
-	err = qcdm_port_setup (fd);
-	if (err != QCDM_SUCCESS) {
-		fprintf (stderr, "E: failed to set up DM port %s: %d\n", port, err);
-		goto error;
-	}
-
 	len = qcdm_cmd_nv_set_hdr_rev_pref_new (buf, sizeof (buf), hdrpref);
 	assert (len);
 
-	/* Send the command */
-	if (!qcdm_send (fd, buf, len)) {
-		fprintf (stderr, "E: failed to send QCDM HDR pref command\n");
-		goto error;
-	}
-
-	reply_len = qcdm_wait_reply (fd, buf, sizeof (buf));
+	/* The command is copied when sent, so the reply can reuse the buffer */
+	reply_len = qcdm_request (port, buf, len, buf, sizeof (buf));
 	if (!reply_len) {
-		fprintf (stderr, "E: failed to receive HDR pref command reply\n");
-		goto error;
+		fprintf (stderr, "E: failed to run HDR pref command\n");
+		return -1;
 	}
 
 	/* Parse the response into a result structure */
@@ -370,50 +282,29 @@ qcdm_set_hdr_pref (const char *port, u_int8_t hdrpref)
 	result = qcdm_cmd_nv_set_hdr_rev_pref_result (buf, reply_len, &err);
 	if (!result) {
 		fprintf (stderr, "E: failed to parse HDR pref command reply: %d\n", err);
-		goto error;
+		return -1;
 	}
 
 	qcdm_result_unref (result);
-	close (fd);
 	return 0;
-
-error:
-	close (fd);
-	return -1;
 }
 
 static int
 qcdm_set_mode (const char *port, u_int8_t mode)
 {
-	int fd, err;
+	int err;
 	char buf[512];
 	size_t len;
 	QcdmResult *result;
 	size_t reply_len;
 
-	fd = com_setup (port);
-	if (fd < 0)
-		return -1;
-
-	err = qcdm_port_setup (fd);
-	if (err != QCDM_SUCCESS) {
-		fprintf (stderr, "E: failed to set up DM port %s: %d\n", port, err);
-		goto error;
-	}
-
 	len = qcdm_cmd_control_new (buf, sizeof (buf), mode);
 	assert (len);
 
-	/* Send the command */
-	if (!qcdm_send (fd, buf, len)) {
-		fprintf (stderr, "E: failed to send QCDM Control command\n");
-		goto error;
-	}
-
-	reply_len = qcdm_wait_reply (fd, buf, sizeof (buf));
+	reply_len = qcdm_request (port, buf, len, buf, sizeof (buf));
 	if (!reply_len) {
-		fprintf (stderr, "E: failed to receive Control command reply\n");
-		goto error;
+		fprintf (stderr, "E: failed to run Control command\n");
+		return -1;
 	}
 
 	/* Parse the response into a result structure */
@@ -421,16 +312,11 @@ qcdm_set_mode (const char *port, u_int8_t mode)
 	result = qcdm_cmd_control_result (buf, reply_len, &err);
 	if (!result) {
 		fprintf (stderr, "E: failed to parse Control command reply: %d\n", err);
-		goto error;
+		return -1;
 	}
 
 	qcdm_result_unref (result);
-	close (fd);
 	return 0;
-
-error:
-	close (fd);
-	return -1;
 }
 
 /******************************************************************/